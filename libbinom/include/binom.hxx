@@ -8,5 +8,12 @@
 #include "variables/list.hxx"
 #include "variables/map.hxx"
 #include "variables/multi_map.hxx"
+#include "variables/hash_map.hxx"
+#include "variables/view.hxx"
+#include "variables/file_storage.hxx"
+#include "variables/mapped_storage.hxx"
+#include "variables/persistent_map.hxx"
+#include "variables/persistent_array.hxx"
+#include "utils/atomic_version.hxx"
 
 #endif // BINOM_HXX
@@ -2,14 +2,16 @@
 #define AVL_TREE_HXX
 
 #include "../variables/key_value.hxx"
+#include "../utils/slab_allocator.hxx"
 #include <functional>
+#include <vector>
 
 namespace binom::priv {
 
 using namespace type_alias;
 
 class AVLTree {
-  template<typename ValueType>
+  template<typename ValueType, template<typename> class NodeAllocator>
   friend class ValueStoringAVLTree;
 public:
 
@@ -25,6 +27,7 @@ public:
   private:
     friend class AVLTree;
     i64 depth = 1;
+    size_t subtree_size = 1; ///< Count of nodes in subtree of node including itself
     AVLNode* left = nullptr;
     AVLNode* right = nullptr;
     AVLNode* parent;
@@ -146,24 +149,64 @@ private:
   AVLNode* rotateRight(AVLNode* y);
   AVLNode* rotateLeft(AVLNode* x);
 
+  static size_t subtreeSize(AVLNode* node) noexcept;
+
   static i64 getBalance(AVLNode* node);
+  //! Updates depths and subtree sizes from node up to root, rotating unbalanced nodes
+  void balance(AVLNode* node);
 
   static AVLNode* minKeyNode(AVLNode* node) noexcept;
   AVLNode* minKeyNode() const noexcept;
   static AVLNode* maxKeyNode(AVLNode* node) noexcept;
   AVLNode* maxKeyNode() const noexcept;
 
+  //! Links nodes around middle one recursively, returns root of built subtree
+  static AVLNode* buildBalanced(AVLNode* const* nodes, size_t count, AVLNode* parent) noexcept;
+
+  //! Links tree, middle node and subtree of right root, whose keys go in this order,
+  //! middle node is placed on edge of higher part at depth of lower one and path to it is balanced
+  void joinByNode(AVLNode* middle, AVLNode* right);
+  //! Joins subtree of other root, whose keys are higher than keys of tree
+  void append(AVLNode* other_root);
+  //! Distributes nodes of subtree to trees of nodes with keys lower than key and of other ones
+  static void splitNode(AVLNode* node, KeyValue& key, AVLTree& lower, AVLTree& upper);
+
 public:
 
+  AVLTree() = default;
+  AVLTree(AVLTree&& other) noexcept : root(other.root) {other.root = nullptr;}
+
   inline bool isEmpty() const noexcept {return !root;}
 
   AVLNode* insert(AVLNode* new_node);
 
+  //! Builds perfectly balanced tree from count nodes in ascending key order
+  //! without key comparisons and rotations, tree must be empty
+  void bulkLoad(AVLNode* const* nodes, size_t count) noexcept;
+  //! Same as bulkLoad, but checks in one pass that keys are strictly ascending, tree isn't changed if they aren't
+  //! and binom_key_unique_error or invalid_data is returned
+  err::Error bulkLoadChecked(AVLNode* const* nodes, size_t count);
+
   [[nodiscard]] AVLNode* extract(KeyValue key);
   AVLNode* extract(AVLNode* node);
 
   AVLNode* get(KeyValue key) const;
 
+  //! Node of index in key order or nullptr, O(log n) by subtree sizes
+  AVLNode* select(size_t index) const noexcept;
+  //! Count of keys lower than key
+  size_t rank(KeyValue key) const;
+  //! Count of keys from first up to but not including last
+  size_t countRange(KeyValue first, KeyValue last) const;
+
+  //! Moves nodes with keys not lower than key to returned tree, O(log n)
+  AVLTree split(KeyValue key);
+  //! Moves all nodes of other tree to this one if all their keys are higher or all are lower than keys of this tree,
+  //! O(log n), returns false and leaves trees unchanged otherwise
+  bool join(AVLTree& other);
+  //! Removes nodes with keys from first up to but not including last by split and join, returns their count
+  size_t eraseRange(KeyValue first, KeyValue last, std::function<void(AVLNode* deletable_element)> destructor = [](AVLNode* n){delete n;});
+
   Iterator begin() noexcept;
   Iterator end() noexcept;
 
@@ -186,10 +229,16 @@ public:
 
 };
 
-template <typename ValueType>
+/**
+ * @brief AVL tree owning nodes with values
+ *
+ * Nodes are allocated by NodeAllocator, by default from slabs of tree,
+ * so clear() and destruction free whole slabs instead of each node.
+ */
+template <typename ValueType, template<typename> class NodeAllocator = slab_allocator::Allocator>
 class ValueStoringAVLTree {
 public:
-  struct ValueStoringAVLNode;
+  class ValueStoringAVLNode;
 private:
   AVLTree avl_tree;
 
@@ -325,19 +374,100 @@ public:
   typedef const Iterator ConstIterator;
   typedef const ReverseIterator ConstReverseIterator;
 
-  inline void clear() { return avl_tree.clear([](AVLTree::AVLNode* node){delete convert(node);}); }
+private:
+  typedef std::allocator_traits<NodeAllocator<ValueStoringAVLNode>> AllocatorTraits;
+  NodeAllocator<ValueStoringAVLNode> node_allocator;
+
+  template<typename Generator>
+  std::vector<AVLTree::AVLNode*> createNodes(size_t count, Generator& generator) {
+    clear();
+    std::vector<AVLTree::AVLNode*> nodes;
+    nodes.reserve(count);
+    try {
+      for(size_t i = 0; i < count; ++i) {
+        auto [key, value] = generator();
+        nodes.push_back(convert(createNode(std::move(key), std::move(value))));
+      }
+    } catch(...) {
+      for(AVLTree::AVLNode* node : nodes) destroyNode(convert(node));
+      throw;
+    }
+    return nodes;
+  }
+
+public:
+  ValueStoringAVLTree() = default;
+  ValueStoringAVLTree(const ValueStoringAVLTree&) = delete;
   ~ValueStoringAVLTree() { clear(); }
 
+  inline void clear() {
+    if constexpr (requires { node_allocator.release(); }) {
+      // Slabs are freed at once after destruction of nodes
+      avl_tree.clear([](AVLTree::AVLNode* node){ convert(node)->~ValueStoringAVLNode(); });
+      node_allocator.release();
+    } else avl_tree.clear([this](AVLTree::AVLNode* node){ destroyNode(convert(node)); });
+  }
+
+  //! Replaces tree by count nodes of generator() results (std::pair<KeyValue, ValueType>) in ascending key order
+  template<typename Generator>
+  void bulkLoad(size_t count, Generator generator) {
+    std::vector<AVLTree::AVLNode*> nodes = createNodes(count, generator);
+    avl_tree.bulkLoad(nodes.data(), nodes.size());
+  }
+
+  //! Same as bulkLoad, but leaves tree empty and returns error of AVLTree::bulkLoadChecked if keys aren't strictly ascending
+  template<typename Generator>
+  err::Error bulkLoadChecked(size_t count, Generator generator) {
+    std::vector<AVLTree::AVLNode*> nodes = createNodes(count, generator);
+    err::Error error = avl_tree.bulkLoadChecked(nodes.data(), nodes.size());
+    if(error) for(AVLTree::AVLNode* node : nodes) destroyNode(convert(node));
+    return error;
+  }
+
+  //! Node for insert(ValueStoringAVLNode&), extracted nodes are destroyed by destroyNode
+  inline ValueStoringAVLNode* createNode(KeyValue key, ValueType value) {
+    ValueStoringAVLNode* node = AllocatorTraits::allocate(node_allocator, 1);
+    return new(node) ValueStoringAVLNode(std::move(key), std::move(value));
+  }
+
+  inline void destroyNode(ValueStoringAVLNode* node) {
+    node->~ValueStoringAVLNode();
+    AllocatorTraits::deallocate(node_allocator, node, 1);
+  }
+
   inline bool isEmpty() const noexcept {return avl_tree.isEmpty();}
 
   inline ValueStoringAVLNode* insert(ValueStoringAVLNode& new_node) {return convert(avl_tree.insert(&convert(new_node)));}
-  inline ValueStoringAVLNode* insert(KeyValue key, ValueType value) {return convert(avl_tree.insert(convert(new ValueStoringAVLNode(std::move(key), std::move(value)))));}
+  inline ValueStoringAVLNode* insert(KeyValue key, ValueType value) {
+    ValueStoringAVLNode* node = createNode(std::move(key), std::move(value));
+    if(ValueStoringAVLNode* result = convert(avl_tree.insert(convert(node))); result) return result;
+    destroyNode(node);
+    return nullptr;
+  }
 
   [[nodiscard]] inline ValueStoringAVLNode* extract(KeyValue key) {return &convert(*avl_tree.extract(std::move(key)));}
   inline ValueStoringAVLNode* extract(ValueStoringAVLNode* node) {return &convert(*avl_tree.extract(&convert(node)));}
 
   inline ValueStoringAVLNode* get(KeyValue key) const {return &convert(*avl_tree.get(std::move(key)));}
 
+  inline ValueStoringAVLNode* select(size_t index) const noexcept {return convert(avl_tree.select(index));}
+  inline size_t rank(KeyValue key) const {return avl_tree.rank(std::move(key));}
+  inline size_t countRange(KeyValue first, KeyValue last) const {return avl_tree.countRange(std::move(first), std::move(last));}
+
+  //! Moves all nodes of other tree to this one if all their keys are higher or all are lower than keys of this tree,
+  //! slabs of other tree go with its nodes
+  bool join(ValueStoringAVLTree& other) {
+    if constexpr (requires { node_allocator.reserveMerge(other.node_allocator); }) node_allocator.reserveMerge(other.node_allocator);
+    if(!avl_tree.join(other.avl_tree)) return false;
+    if constexpr (requires { node_allocator.merge(other.node_allocator); }) node_allocator.merge(other.node_allocator);
+    return true;
+  }
+
+  //! Destroys nodes with keys from first up to but not including last, returns their count
+  inline size_t eraseRange(KeyValue first, KeyValue last) {
+    return avl_tree.eraseRange(std::move(first), std::move(last), [this](AVLTree::AVLNode* node){ destroyNode(convert(node)); });
+  }
+
   inline Iterator begin() noexcept {return avl_tree.begin();}
   inline Iterator end() noexcept {return avl_tree.end();}
 
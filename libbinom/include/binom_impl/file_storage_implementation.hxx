@@ -1,6 +1,11 @@
 #ifndef FILE_STORAGE_IMPLEMENTATION_HXX
 #define FILE_STORAGE_IMPLEMENTATION_HXX
 
-// TODO
+#include "file_storage_implementation/buffer_pool.hxx"
+#include "file_storage_implementation/paged_file.hxx"
+#include "file_storage_implementation/node_stream.hxx"
+#include "file_storage_implementation/write_ahead_log.hxx"
+#include "file_storage_implementation/file_storage_impl.hxx"
+#include "file_storage_implementation/mapped_file.hxx"
 
 #endif // FILE_STORAGE_IMPLEMENTATION_HXX
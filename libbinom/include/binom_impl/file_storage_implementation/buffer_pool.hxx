@@ -0,0 +1,131 @@
+#ifndef BUFFER_POOL_HXX
+#define BUFFER_POOL_HXX
+
+#include "../types.hxx"
+
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace binom {
+
+enum class CacheEvictionPolicy : ui8 {
+  clock,  ///< Second chance: evicts first unreferenced page after clock hand
+  lru_k   ///< Evicts page with the oldest K-th most recent access (K = 2), scan resistant
+};
+
+//! Statistics of file storage page cache
+struct CacheStatistics {
+  size_t hit_count = 0;
+  size_t miss_count = 0;
+  size_t eviction_count = 0;
+  size_t write_back_count = 0;   ///< Dirty pages written to file
+  size_t spill_count = 0;        ///< Dirty pages moved to spill file in no-steal mode
+  size_t peak_frame_count = 0;   ///< Max count of cached pages
+
+  inline f64 getHitRatio() const noexcept {return hit_count + miss_count ? f64(hit_count) / f64(hit_count + miss_count) : 0;}
+};
+
+constexpr size_t default_cache_size = 16 * 1024 * 1024;
+
+}
+
+namespace binom::priv {
+
+class PagedFile;
+typedef ui64 PageIndex;
+
+/**
+ * @brief Write-back cache of PagedFile pages limited by memory budget
+ *
+ * Pinned pages are never evicted. In no-steal mode dirty pages aren't written to file
+ * before flush(): when all unpinned frames are dirty, the least recently used one
+ * is spilled to temporary file and is read back on next access, so dirty pages
+ * don't grow pool over the budget. If all frames are pinned, pool grows over the budget
+ * and shrinks back on following evictions.
+ */
+class BufferPool {
+public:
+  static constexpr size_t min_frame_count = 8;
+  static constexpr size_t lru_k = 2;
+
+private:
+  struct Frame {
+    PageIndex page = 0;
+    ui32 pin_count = 0;
+    bool is_used = false;
+    bool is_dirty = false;
+    bool is_referenced = false;
+    ui64 access_history[lru_k] = {}; ///< Access ticks, most recent first
+    std::unique_ptr<byte[]> data;
+  };
+
+  PagedFile& file;
+  const size_t page_size;
+  const size_t frame_limit;
+  const CacheEvictionPolicy policy;
+  bool is_no_steal = false;
+
+  std::mutex mtx;
+  std::vector<Frame> frames;
+  std::unordered_map<PageIndex, size_t> page_table;
+  size_t clock_hand = 0;
+  ui64 access_tick = 0;
+  CacheStatistics statistics;
+
+  //! Spill file of dirty pages evicted in no-steal mode, created on first spill
+  std::unique_ptr<FILE, int(*)(FILE*)> spill_file{nullptr, &std::fclose};
+  std::unordered_map<PageIndex, ui64> spilled_pages; ///< Page -> slot in spill file
+  std::vector<ui64> free_spill_slots;
+  ui64 spill_slot_count = 0;
+
+  size_t findVictim();
+  size_t findClockVictim();
+  size_t findLruKVictim();
+  //! Least recently used unpinned dirty frame for no-steal mode
+  size_t findSpillVictim();
+  inline bool isEvictable(const Frame& frame) const noexcept {return !frame.pin_count && !(is_no_steal && frame.is_dirty);}
+  void writeBack(Frame& frame);
+  void spill(Frame& frame);
+  //! Reads spilled page to frame data and frees its slot
+  void unspill(std::unordered_map<PageIndex, ui64>::iterator it, byte* to);
+  void readSpillSlot(ui64 slot, byte* to);
+  void releaseSpillSlot(std::unordered_map<PageIndex, ui64>::iterator it);
+  //! Calls callback for cached and spilled dirty pages in order of page index
+  void visitDirty(const std::function<void(PageIndex page, const byte* data)>& callback);
+  void access(Frame& frame);
+  //! Returns frame with page, loads page from file if load is true
+  Frame& fetch(PageIndex page, bool load = true);
+
+public:
+  BufferPool(PagedFile& file, size_t page_size, size_t memory_budget, CacheEvictionPolicy policy);
+  BufferPool(const BufferPool&) = delete;
+  BufferPool(BufferPool&&) = delete;
+
+  void read(PageIndex page, size_t offset, void* to, size_t size);
+  void write(PageIndex page, size_t offset, const void* from, size_t size);
+
+  void pin(PageIndex page);
+  void unpin(PageIndex page);
+  //! Drops cached page without writing it back (page is freed)
+  void discard(PageIndex page);
+  //! Writes all dirty pages including spilled ones to file
+  void flush();
+  //! Calls callback for each dirty page in order of page index
+  void forEachDirty(const std::function<void(PageIndex page, const byte* data)>& callback);
+
+  //! Dirty pages aren't written to file until flush() (for write-ahead logging)
+  void setNoSteal(bool is_no_steal);
+  inline size_t getFrameLimit() const noexcept {return frame_limit;}
+  //! Pool is grown over the budget or dirty pages fill it and are spilled, flush() is due
+  bool isOverBudget();
+  CacheStatistics getStatistics();
+  void resetStatistics();
+};
+
+}
+
+#endif // BUFFER_POOL_HXX
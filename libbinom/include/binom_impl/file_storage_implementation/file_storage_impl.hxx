@@ -0,0 +1,134 @@
+#ifndef FILE_STORAGE_IMPL_HXX
+#define FILE_STORAGE_IMPL_HXX
+
+#include "node_stream.hxx"
+#include "map_tree.hxx"
+#include "write_ahead_log.hxx"
+#include "../../variables/view.hxx"
+#include "../../utils/shared_recursive_mutex_wrapper.hxx"
+
+#include <shared_mutex>
+#include <utility>
+
+namespace binom::priv {
+
+/**
+ * @brief Node encodings of BinOM data in PagedFile
+ *
+ * Every node except numbers and null is referenced by FileResourceIndex::index.page:
+ *   number       - value is stored inline in FileResourceIndex::index
+ *   bit_array    - NodeStream, payload: bits, aux: bit count
+ *   buffer_array - NodeStream, payload: elements
+ *   array, list  - NodeStream, payload: FileResourceIndex[element count]
+ *   map,multimap - MapTree of (key FileResourceIndex, value FileResourceIndex) in key order
+ *   hash_map     - same as map, keys are unique
+ * Map keys except numbers and null are NodeStreams with comparable encoding of KeyValue as payload,
+ * so map lookup compares stored bytes of O(log n) keys by memcmp.
+ * Keys are decoded only when they are returned, buffer keys with -0.0 are restored as +0.0.
+ * Map elements are addressed by position in key order, it's changed by insert and remove before it.
+ *
+ * Every node with pages gets generation when it's created (PagedFile::nextGeneration),
+ * so handle can check that its node wasn't removed and its pages reused by other node.
+ *
+ * If journal is enabled, every public modification is logged as logical record after
+ * it is applied to cached pages. Page allocation is deterministic, so replaying records
+ * over last checkpoint reproduces the same pages.
+ */
+class FileStorageImplementation {
+public:
+  typedef MapTree::Entry MapEntry;
+
+  enum class LogRecordType : ui8 {
+    set_root,
+    buffer_insert,
+    buffer_remove,
+    array_insert,
+    array_remove,
+    map_insert,
+    map_remove,
+    map_rename
+  };
+
+private:
+  WriteAheadLog journal;
+  PagedFile file;
+  std::shared_mutex mtx;
+  bool is_replaying = false;
+
+  inline bool isLogged() const noexcept {return journal.isEnabled() && !is_replaying;}
+  //! Appends record to journal, makes checkpoint if journal or dirty pages exceed limits
+  void log(const std::vector<byte>& record);
+  void logRemove(LogRecordType type, FileResourceIndex index, size_t at, size_t count);
+  void replay(const byte* data, size_t size);
+
+  void loadNode(FileResourceIndex index, std::vector<byte>& buffer);
+  NodeStream getStream(FileResourceIndex index, VarTypeClass type_class);
+  MapTree getMapTree(FileResourceIndex index);
+  FileResourceIndex storeKey(const KeyValue& key);
+  KeyValue loadKey(FileResourceIndex index);
+  //! Appends key in the same node encoding as loadNode
+  void loadKeyNode(FileResourceIndex index, std::vector<byte>& buffer);
+  //! Compares stored key with encoding of other key, buffer is reused between calls of one search
+  KeyValue::CompareResult compareKey(FileResourceIndex index, const std::vector<byte>& key_encoding, std::vector<byte>& buffer);
+  //! First position with key not lower (upper_bound == false) or higher (upper_bound == true) than given
+  size_t searchKey(const MapTree& tree, const std::vector<byte>& key_encoding, bool upper_bound);
+  //! True if element exists at position and has key of encoding
+  bool isKeyAt(const MapTree& tree, size_t position, const std::vector<byte>& key_encoding);
+
+public:
+  FileStorageImplementation(const std::string& path, ui32 page_size = PagedFile::default_page_size,
+                            size_t cache_size = default_cache_size, CacheEvictionPolicy policy = CacheEvictionPolicy::clock,
+                            JournalConfig journal_config = JournalConfig());
+  ~FileStorageImplementation();
+
+  inline SharedRecursiveLock getLock(MtxLockType lock_type) const noexcept {return SharedRecursiveLock(&mtx, lock_type);}
+  inline PagedFile& getFile() noexcept {return file;}
+  inline WriteAheadLog& getJournal() noexcept {return journal;}
+
+  //! Makes logged modifications durable according to journal mode, call without lock
+  inline void commit() {journal.commit();}
+  //! Writes all modifications to data file
+  void checkpoint();
+
+  FileResourceIndex store(const View& view);
+  Variable load(FileResourceIndex index);
+  //! Frees all pages of node and its elements
+  void destroy(FileResourceIndex index);
+  //! Generation of node, 0 for numbers and null which are stored inline
+  ui64 getGeneration(FileResourceIndex index);
+  //! False if node was removed, even if its first page is reused by other node
+  bool isAlive(FileResourceIndex index, ui64 generation);
+
+  //! Replaces root node and destroys previous one
+  void setRoot(const View& view);
+  inline FileResourceIndex getRoot() const noexcept {return file.getRoot();}
+
+  size_t getElementCount(FileResourceIndex index);
+
+  // Bit array & buffer array
+  void readBuffer(FileResourceIndex index, size_t at, void* to, size_t count);
+  void insertBuffer(FileResourceIndex index, size_t at, const void* data, size_t count);
+  void removeBuffer(FileResourceIndex index, size_t at, size_t count);
+
+  // Array & list
+  FileResourceIndex getElement(FileResourceIndex index, size_t at);
+  void insertElement(FileResourceIndex index, size_t at, const View& view);
+  void removeElements(FileResourceIndex index, size_t at, size_t count);
+
+  // Map & multimap
+  MapEntry getMapEntry(FileResourceIndex index, size_t at);
+  KeyValue getMapKey(FileResourceIndex index, size_t at);
+  //! Index of first element with given key or element count if not found
+  size_t findKey(FileResourceIndex index, const KeyValue& key);
+  //! Range of elements with given key
+  std::pair<size_t, size_t> findKeyRange(FileResourceIndex index, const KeyValue& key);
+  //! Returns position of inserted element
+  size_t insertMapElement(FileResourceIndex index, const KeyValue& key, const View& value);
+  void removeMapElements(FileResourceIndex index, size_t at, size_t count);
+  //! Rekeys all elements with old_key without touching their values, returns count of renamed elements
+  size_t renameMapElements(FileResourceIndex index, const KeyValue& old_key, const KeyValue& new_key);
+};
+
+}
+
+#endif // FILE_STORAGE_IMPL_HXX
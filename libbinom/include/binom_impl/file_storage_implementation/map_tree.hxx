@@ -0,0 +1,105 @@
+#ifndef MAP_TREE_HXX
+#define MAP_TREE_HXX
+
+#include "paged_file.hxx"
+#include "../../variables/key_value.hxx"
+
+#include <functional>
+#include <optional>
+#include <vector>
+
+namespace binom::priv {
+
+/**
+ * @brief Order statistic B+tree of map elements stored in PagedFile
+ *
+ * Every tree node is one page: | NodeHeader | entries |
+ * Leaves hold Entry[entry_count] in key order, inner nodes hold ChildEntry[entry_count],
+ * where every child is counted with elements of its subtree.
+ * Element is addressed by its position in key order, positional access, insert and remove
+ * descend by element counts of subtrees, so they cost O(log n) page accesses.
+ * Inner nodes don't keep separator keys: child is chosen by first key of its subtree,
+ * so stored key nodes are owned only by leaf entries.
+ * Root page never changes, on root split its entries move to new child page,
+ * so map is identified by its root page like other nodes by first directory page.
+ * Nodes emptied by removal are freed, underfull nodes aren't merged.
+ */
+class MapTree {
+public:
+  struct Entry {
+    FileResourceIndex key;
+    FileResourceIndex value;
+  };
+
+  struct NodeHeader {
+    VarType type = VarType::null;   ///< Type of map in all nodes
+    ui8 is_leaf = true;
+    byte reserved[2] = {};
+    ui32 entry_count = 0;
+    ui64 element_count = 0;         ///< Elements in subtree
+    ui64 generation = 0;            ///< Only in root page, see PagedFile::nextGeneration
+  };
+
+  //! Result of comparison of stored key with searched one
+  typedef std::function<KeyValue::CompareResult(FileResourceIndex key)> KeyCompare;
+
+private:
+  struct ChildEntry {
+    PageIndex page;
+    ui64 element_count;
+  };
+
+  PagedFile* file;
+  PageIndex root_page;
+  NodeHeader root_header;
+
+  inline size_t getLeafCapacity() const noexcept {return (file->getPageSize() - sizeof(NodeHeader)) / sizeof(Entry);}
+  inline size_t getInnerCapacity() const noexcept {return (file->getPageSize() - sizeof(NodeHeader)) / sizeof(ChildEntry);}
+
+  NodeHeader readHeader(PageIndex page) const;
+  template<typename T>
+  std::vector<T> readEntries(PageIndex page, const NodeHeader& header) const;
+  //! Writes header and header.entry_count entries
+  template<typename T>
+  void writeNode(PageIndex page, const NodeHeader& header, const T* entries);
+  //! Writes entries to node, if they don't fit its capacity right half is moved to new node and returned
+  template<typename T>
+  std::optional<ChildEntry> writeSplit(PageIndex page, NodeHeader header, const std::vector<T>& entries, size_t capacity);
+  //! Spreads entries over new nodes of at most capacity entries
+  template<typename T>
+  std::vector<ChildEntry> buildLevel(const std::vector<T>& entries, size_t capacity);
+
+  FileResourceIndex getFirstKey(PageIndex page) const;
+  //! Returns right half of node if it's split
+  std::optional<ChildEntry> insert(PageIndex page, ui64 position, const Entry& entry);
+  Entry remove(PageIndex page, ui64 position, bool& is_emptied);
+  void forEach(PageIndex page, const std::function<void(const Entry&)>& callback) const;
+  void destroy(PageIndex page);
+
+  MapTree(PagedFile& file, PageIndex root_page, const NodeHeader& root_header) noexcept
+    : file(&file), root_page(root_page), root_header(root_header) {}
+
+public:
+  //! Stores entries in key order
+  static MapTree create(PagedFile& file, VarType type, const std::vector<Entry>& entries);
+  MapTree(PagedFile& file, PageIndex root_page);
+
+  inline PageIndex getRootPage() const noexcept {return root_page;}
+  inline VarType getType() const noexcept {return root_header.type;}
+  inline ui64 getGeneration() const noexcept {return root_header.generation;}
+  inline ui64 getElementCount() const noexcept {return root_header.element_count;}
+
+  Entry get(ui64 position) const;
+  //! First position with key not lower (upper_bound == false) or higher (upper_bound == true) than searched
+  ui64 search(const KeyCompare& compare, bool upper_bound) const;
+  void insert(ui64 position, const Entry& entry);
+  Entry remove(ui64 position);
+  //! Calls callback for every entry in key order
+  void forEach(const std::function<void(const Entry&)>& callback) const;
+  //! Frees all pages of tree, nodes of keys and values aren't touched
+  void destroy();
+};
+
+}
+
+#endif // MAP_TREE_HXX
@@ -0,0 +1,58 @@
+#ifndef MAPPED_FILE_HXX
+#define MAPPED_FILE_HXX
+
+#include "../resource_control.hxx"
+#include "../../variables/view.hxx"
+
+#include <atomic>
+#include <string>
+
+namespace binom::priv {
+
+/**
+ * @brief Read-only memory mapping of file with indexed BinOM data (Variable::serialize() output)
+ *
+ * Nodes are referenced by FileResourceIndex with offset of node in file, numbers are stored inline.
+ * Link created from such index materializes node on first access: containers are decoded
+ * one level deep, their elements become lazy links too, so untouched subtrees use no heap.
+ * Mapping is reference counted by owner and lazy links and is unmapped after last release.
+ */
+class MappedFile {
+  const byte* data = nullptr;
+  size_t size = 0;
+  std::atomic_uint64_t link_counter = 1;
+  std::atomic_size_t materialized_count = 0;
+  std::atomic_size_t error_count = 0;
+
+  MappedFile(const std::string& path);
+  ~MappedFile();
+
+  bool verifyNode(const View& view) const;
+
+public:
+  MappedFile(const MappedFile&) = delete;
+  MappedFile(MappedFile&&) = delete;
+
+  //! Maps file, only header and root node bounds are checked
+  static MappedFile* open(const std::string& path);
+  void acquire() noexcept;
+  void release() noexcept;
+
+  inline size_t getSize() const noexcept {return size;}
+  inline size_t getMaterializedCount() const noexcept {return materialized_count;}
+  //! Count of failed materializations
+  inline size_t getErrorCount() const noexcept {return error_count;}
+
+  View getRootView() const;
+  View getView(ui64 offset) const;
+  FileResourceIndex getIndex(const View& view) const;
+
+  //! Decodes container node one level deep, throws invalid_data if node or its elements are corrupted
+  Link materialize(FileResourceIndex index);
+  //! Checks encoding of all nodes
+  bool verify() const;
+};
+
+}
+
+#endif // MAPPED_FILE_HXX
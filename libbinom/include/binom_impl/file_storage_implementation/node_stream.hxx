@@ -0,0 +1,88 @@
+#ifndef NODE_STREAM_HXX
+#define NODE_STREAM_HXX
+
+#include "paged_file.hxx"
+
+#include <vector>
+
+namespace binom::priv {
+
+/**
+ * @brief Random access byte stream of node stored in PagedFile
+ *
+ * Node is identified by its first directory page, which never changes.
+ * Directory page: | DirectoryHeader | data page indexes |
+ * Directory pages are chained by next_directory, data pages hold raw payload.
+ * First directory page is pinned in cache for stream lifetime, streams are created
+ * only under lock of FileStorageImplementation, so node stays resident while locked.
+ */
+class NodeStream {
+public:
+  struct DirectoryHeader {
+    VarType type = VarType::null;   ///< Only in first directory page
+    byte reserved[3] = {};
+    ui32 page_count = 0;            ///< Data pages listed in this directory page
+    ui64 size = 0;                  ///< Payload size, only in first directory page
+    PageIndex next_directory = 0;
+    ui64 aux = 0;                   ///< Type specific field, only in first directory page
+    ui64 generation = 0;            ///< Only in first directory page, see PagedFile::nextGeneration
+  };
+
+private:
+  PagedFile* file;
+  PageIndex first_page;
+  DirectoryHeader header;
+  std::vector<PageIndex> directory_pages;
+
+  inline size_t getDirectoryCapacity() const noexcept {return (file->getPageSize() - sizeof(DirectoryHeader)) / sizeof(PageIndex);}
+  inline ui64 getDataPageCount() const noexcept {return (header.size + file->getPageSize() - 1) / file->getPageSize();}
+  inline size_t getEntryOffset(ui64 data_page) const noexcept {return sizeof(DirectoryHeader) + (data_page % getDirectoryCapacity()) * sizeof(PageIndex);}
+
+  void loadDirectory(size_t directory_index);
+  PageIndex getDataPage(ui64 data_page);
+  void writeHeader();
+  void addDataPage();
+  void removeDataPage();
+
+  NodeStream(PagedFile& file, PageIndex first_page, DirectoryHeader header);
+
+public:
+  static NodeStream create(PagedFile& file, VarType type);
+  NodeStream(PagedFile& file, PageIndex first_page);
+  NodeStream(const NodeStream& other);
+  NodeStream(NodeStream&& other) noexcept;
+  ~NodeStream();
+
+  NodeStream& operator=(const NodeStream& other);
+  NodeStream& operator=(NodeStream&& other) noexcept;
+
+  inline PageIndex getFirstPage() const noexcept {return first_page;}
+  inline VarType getType() const noexcept {return header.type;}
+  inline ui64 getSize() const noexcept {return header.size;}
+  inline ui64 getAux() const noexcept {return header.aux;}
+  inline ui64 getGeneration() const noexcept {return header.generation;}
+  void setAux(ui64 aux);
+
+  void read(ui64 offset, void* to, size_t size);
+  //! Extends stream if data is written after its end
+  void write(ui64 offset, const void* from, size_t size);
+  //! Moves tail of stream forward and writes data at offset
+  void insert(ui64 offset, const void* from, size_t size);
+  //! Removes size bytes at offset and moves tail of stream back
+  void remove(ui64 offset, size_t size);
+  void resize(ui64 size);
+  //! Frees all pages of stream
+  void destroy();
+
+  template<typename T>
+  requires std::is_trivially_copyable_v<T>
+  T read(ui64 offset) {T value; read(offset, &value, sizeof(T)); return value;}
+
+  template<typename T>
+  requires std::is_trivially_copyable_v<T>
+  void write(ui64 offset, T value) {write(offset, &value, sizeof(T));}
+};
+
+}
+
+#endif // NODE_STREAM_HXX
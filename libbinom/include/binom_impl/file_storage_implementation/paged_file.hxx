@@ -0,0 +1,111 @@
+#ifndef PAGED_FILE_HXX
+#define PAGED_FILE_HXX
+
+#include "buffer_pool.hxx"
+#include "../resource_control.hxx"
+#include "../../utils/err.hxx"
+
+#include <string>
+
+namespace binom::priv {
+
+/**
+ * @brief File of fixed-size pages with free-space map
+ *
+ * Page 0 - file header
+ * Pages are grouped by page_size * 8, every group starts with free-space map page
+ * (bit per page of group, 1 - page is used). Group 0 map is stored in page 1.
+ * Page access goes through BufferPool, file header is written directly.
+ * In journaled mode dirty pages and header are written only by sync(),
+ * see WriteAheadLog.
+ */
+class PagedFile {
+public:
+  static constexpr ui32 default_page_size = 4096;
+  static constexpr ui32 min_page_size = 512;
+
+  struct Header {
+    byte magic[4] = {'B', 'O', 'M', 'F'};
+    ui32 version = 2;
+    ui32 page_size = default_page_size;
+    ui32 reserved = 0;
+    ui64 page_count = 0;
+    FileResourceIndex root;
+    ui64 generation = 0;            ///< Last generation given to node, see nextGeneration
+  };
+
+private:
+  int file_descriptor = -1;
+  Header header;
+  ui64 free_group_hint = 0;
+  std::unique_ptr<BufferPool> pool;
+  bool is_journaled = false;
+  bool is_header_dirty = false;
+
+  inline ui64 getPagesPerGroup() const noexcept {return ui64(header.page_size) * 8;}
+  inline PageIndex getFreeSpaceMapPage(ui64 group) const noexcept {return group ? group * getPagesPerGroup() : 1;}
+  bool isServicePage(PageIndex page) const noexcept;
+
+  void readRaw(ui64 position, void* to, size_t size) const;
+  void writeRaw(ui64 position, const void* from, size_t size);
+  void writeHeader();
+  void initGroup(ui64 group);
+  void markPage(PageIndex page, bool is_used);
+
+  friend class BufferPool;
+public:
+  PagedFile(const std::string& path, ui32 page_size = default_page_size,
+            size_t cache_size = default_cache_size, CacheEvictionPolicy policy = CacheEvictionPolicy::clock,
+            bool is_journaled = false);
+  PagedFile(const PagedFile&) = delete;
+  PagedFile(PagedFile&&) = delete;
+  ~PagedFile();
+
+  inline ui32 getPageSize() const noexcept {return header.page_size;}
+  inline ui64 getPageCount() const noexcept {return header.page_count;}
+  inline int getFileDescriptor() const noexcept {return file_descriptor;}
+  inline const Header& getHeader() const noexcept {return header;}
+
+  void read(PageIndex page, size_t offset, void* to, size_t size) const;
+  void write(PageIndex page, size_t offset, const void* from, size_t size);
+
+  template<typename T>
+  requires std::is_trivially_copyable_v<T>
+  T read(PageIndex page, size_t offset) const {T value; read(page, offset, &value, sizeof(T)); return value;}
+
+  template<typename T>
+  requires std::is_trivially_copyable_v<T>
+  void write(PageIndex page, size_t offset, T value) {write(page, offset, &value, sizeof(T));}
+
+  //! Returns zero-filled page
+  PageIndex allocatePage();
+  void freePage(PageIndex page);
+  bool isPageUsed(PageIndex page) const;
+  size_t getUsedPageCount() const;
+
+  inline FileResourceIndex getRoot() const noexcept {return header.root;}
+  void setRoot(FileResourceIndex root);
+
+  //! Unique stamp of new node. Node keeps it in its first page, so handle of removed node
+  //! isn't mistaken for other node reusing that page. Header is written with pages by sync()
+  ui64 nextGeneration() noexcept;
+
+  //! Pinned page stays in cache until unpinned
+  inline void pin(PageIndex page) {pool->pin(page);}
+  inline void unpin(PageIndex page) {pool->unpin(page);}
+  inline CacheStatistics getCacheStatistics() const {return pool->getStatistics();}
+  inline void resetCacheStatistics() {pool->resetStatistics();}
+  inline size_t getCacheFrameLimit() const noexcept {return pool->getFrameLimit();}
+  inline bool isCacheOverBudget() const {return pool->isOverBudget();}
+
+  void setJournaled(bool is_journaled);
+  inline bool isJournaled() const noexcept {return is_journaled;}
+  inline void forEachDirtyPage(const std::function<void(PageIndex page, const byte* data)>& callback) {pool->forEachDirty(callback);}
+
+  //! Writes cached pages and flushes file to disk
+  void sync();
+};
+
+}
+
+#endif // PAGED_FILE_HXX
@@ -0,0 +1,140 @@
+#ifndef WRITE_AHEAD_LOG_HXX
+#define WRITE_AHEAD_LOG_HXX
+
+#include "paged_file.hxx"
+
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace binom {
+
+enum class JournalMode : ui8 {
+  off,          ///< No journal, dirty pages are written in place on cache eviction
+  synchronous,  ///< Modification is durable when call returns, concurrent commits share one fsync
+  batched       ///< Journal is synced every batch_size records or batch_delay, records younger than batch_delay may be lost on crash
+};
+
+struct JournalConfig {
+  JournalMode mode = JournalMode::off;
+  size_t batch_size = 1024;                   ///< Records per fsync in batched mode
+  std::chrono::milliseconds batch_delay{10};  ///< Max age of unsynced record in batched mode, kept by background flush
+  size_t checkpoint_size = 64 * 1024 * 1024;  ///< Journal size which triggers checkpoint
+};
+
+}
+
+namespace binom::priv {
+
+/**
+ * @brief Write-ahead log of PagedFile modifications
+ *
+ * Journal: | 'B' 'O' 'M' 'J' | version : ui32 | records |
+ * Record:  | size : ui32 | crc32 : ui32 | lsn : ui64 | type : RecordType | payload : size - 1 bytes |
+ *
+ * Logical records describe modifications of storage, their payload is opaque for journal.
+ * While journal is enabled data file is changed only by checkpoint:
+ *  1. journal is synced
+ *  2. dirty pages and file header are appended as file_image records
+ *     between checkpoint_begin and checkpoint_end, journal is synced
+ *  3. pages are written in place, data file is synced
+ *  4. journal is truncated
+ * On open complete checkpoint images are written to data file again (step 3 could be torn),
+ * otherwise logical records after last checkpoint are replayed over data file.
+ * Torn or corrupted tail of journal is ignored.
+ */
+class WriteAheadLog {
+public:
+  enum class RecordType : ui8 {
+    logical,
+    checkpoint_begin,
+    file_image,       ///< | file offset : ui64 | data |
+    checkpoint_end
+  };
+
+  struct RecordHeader {
+    ui32 size;
+    ui32 checksum;
+    ui64 lsn;
+  };
+
+  static constexpr byte magic[4] = {'B', 'O', 'M', 'J'};
+  static constexpr ui32 version = 1;
+  static constexpr size_t file_header_size = sizeof(magic) + sizeof(version);
+
+private:
+  std::string path;
+  JournalConfig config;
+  int file_descriptor = -1;
+  std::vector<ui64> replay_positions;  ///< Logical records to replay after open
+
+  std::mutex mtx;
+  std::condition_variable flush_cv;
+  std::vector<byte> buffer;            ///< Appended, but not written records
+  size_t buffered_record_count = 0;
+  std::chrono::steady_clock::time_point first_buffered_time;
+  ui64 file_size = 0;
+  ui64 last_lsn = 0;
+  ui64 durable_lsn = 0;
+  bool is_flushing = false;
+  size_t sync_count = 0;
+
+  //! Batched mode flushes records when the oldest of them gets batch_delay old, even if no commit follows them
+  std::thread flusher;
+  std::condition_variable flusher_cv;
+  bool is_flusher_stopped = false;
+  //! Error of background flush, it's thrown by next commit or flush
+  std::exception_ptr flusher_error;
+
+  void appendRecord(std::vector<byte>& to, RecordType type, const void* data, size_t size, const void* extra = nullptr, size_t extra_size = 0);
+  bool readRecord(ui64& position, RecordHeader& header, std::vector<byte>& payload) const;
+  void recover(const std::string& data_path);
+  void writeFile(const void* data, size_t size, ui64 position);
+  void syncFile();
+  void reset();
+  //! Writes records up to lsn, becomes leader of group commit or waits for current one
+  void flushTo(std::unique_lock<std::mutex>& lk, ui64 lsn);
+  void runFlusher();
+  void stopFlusher();
+  void throwFlusherError();
+
+public:
+  //! Opens journal and restores data file from complete checkpoint if there is one
+  WriteAheadLog(const std::string& path, const std::string& data_path, JournalConfig config);
+  WriteAheadLog(const WriteAheadLog&) = delete;
+  WriteAheadLog(WriteAheadLog&&) = delete;
+  ~WriteAheadLog();
+
+  inline bool isEnabled() const noexcept {return config.mode != JournalMode::off;}
+  inline bool isOpen() const noexcept {return file_descriptor >= 0;}
+  inline bool isRecoveryRequired() const noexcept {return !replay_positions.empty();}
+  inline const JournalConfig& getConfig() const noexcept {return config;}
+
+  //! Calls callback for each logical record which wasn't checkpointed before close
+  void replay(const std::function<void(const byte* data, size_t size)>& callback);
+
+  //! Buffers logical record, returns its lsn
+  ui64 append(const std::vector<byte>& payload);
+  //! Makes appended records durable according to journal mode
+  void commit();
+  //! Writes and syncs all appended records
+  void flush();
+  //! Journal size including buffered records
+  ui64 getSize();
+  //! Count of journal fsync calls
+  size_t getSyncCount();
+
+  //! Writes dirty pages of file through journal into file and truncates journal
+  void checkpoint(PagedFile& file);
+  //! Removes journal file after checkpoint, used when journal was opened only for recovery
+  void remove();
+};
+
+}
+
+#endif // WRITE_AHEAD_LOG_HXX
@@ -2,6 +2,7 @@
 #define MULTI_AVL_TREE_HXX
 
 #include "../variables/key_value.hxx"
+#include "../utils/slab_allocator.hxx"
 #include <new>
 #include <functional>
 
@@ -38,6 +39,7 @@ private:
   private:
     friend class MultiAVLTree;
     i64 depth = 1;
+    size_t subtree_size = 0; ///< Count of elements of all key nodes in subtree
     AVLKeyNode* left = nullptr;
     AVLKeyNode* right = nullptr;
     AVLKeyNode* parent = nullptr;
@@ -137,6 +139,10 @@ private:
 
     void pushBack(AVLNode* node);
     void pushFront(AVLNode* node);
+    //! Links elements of other key node after elements of this one, linear in their count
+    void takeElements(AVLKeyNode& other) noexcept;
+    //! Puts new_node in place of node among elements, node is left unlinked
+    void replace(AVLNode& node, AVLNode& new_node) noexcept;
     AVLNode& extract(Iterator it);
 
     size_t getElementCount() const noexcept;
@@ -322,6 +328,11 @@ private:
   friend class AVLKeyNode;
 
   AVLKeyNode* root = nullptr;
+  //! Key nodes are owned by tree, so they are allocated from its slabs
+  slab_allocator::SlabPool key_node_pool{sizeof(AVLKeyNode), alignof(AVLKeyNode)};
+
+  AVLKeyNode* createKeyNode(KeyValue key, AVLKeyNode* parent = nullptr);
+  void destroyKeyNode(AVLKeyNode* key_node) noexcept;
 
   static i64 max(i64 a, i64 b) noexcept;
   static i64 depth(AVLKeyNode* node) noexcept;
@@ -330,7 +341,11 @@ private:
 
   AVLKeyNode* rotateLeft(AVLKeyNode* x);
 
+  static size_t subtreeSize(AVLKeyNode* node) noexcept;
+
   static i64 getBalance(AVLKeyNode* node);
+  //! Updates depths and element counts from node up to root, rotating unbalanced nodes
+  void balance(AVLKeyNode* node);
 
   static AVLKeyNode* minKeyNode(AVLKeyNode* node) noexcept;
 
@@ -341,6 +356,17 @@ private:
 
   AVLKeyNode* maxKeyNode() const noexcept;
 
+  static AVLKeyNode* buildBalanced(AVLKeyNode* const* key_nodes, size_t count, AVLKeyNode* parent) noexcept;
+
+  //! Removes key node from tree without destruction and balances tree
+  void unlinkKeyNode(AVLKeyNode* key_node);
+  //! Same as AVLTree::joinByNode
+  void joinByNode(AVLKeyNode* middle, AVLKeyNode* right);
+  //! Joins subtree of other root, whose keys are higher than keys of tree
+  void append(AVLKeyNode* other_root);
+  static void splitNode(AVLKeyNode* key_node, KeyValue& key, MultiAVLTree& lower, MultiAVLTree& upper);
+  void destroyKeyNodes(AVLKeyNode* key_node, std::function<void(AVLNode* deletable_element)>& destructor) noexcept;
+
 public:
 
   struct NodePair {
@@ -348,16 +374,36 @@ public:
     AVLNode* node;
   };
 
+  //! Element of bulkLoad input
+  struct KeyNodePair {
+    KeyValue key;
+    AVLNode* node;
+  };
+
   enum class NewNodePosition : i8 {front = -1, back = 1};
 
+  MultiAVLTree() = default;
+  MultiAVLTree(MultiAVLTree&& other) noexcept;
+
   bool isEmpty() const noexcept;
+  //! Count of all elements, O(1) by element count of root subtree
+  size_t getSize() const noexcept;
 
   NodePair insert(KeyValue key, AVLNode* new_node, NewNodePosition position = NewNodePosition::back);
 
+  //! Builds perfectly balanced tree of key nodes from count elements in ascending key order without rotations,
+  //! nodes of equal adjacent keys go to one key node in input order, keys are moved from elements, tree must be empty
+  void bulkLoad(KeyNodePair* elements, size_t count);
+  //! Same as bulkLoad, but checks in one pass that keys are ascending, tree isn't changed and invalid_data is returned if they aren't
+  err::Error bulkLoadChecked(KeyNodePair* elements, size_t count);
+
   AVLNode* extract(Iterator it);
 
   AVLNode* extract(ReverseIterator r_it);
 
+  //! Puts new_node in place of element of iterator, element is left unlinked, returns iterator to new_node
+  Iterator replace(Iterator it, AVLNode* new_node);
+
   bool removeKey(KeyValue key, std::function<void(AVLNode* deletable_element)> destructor = [](AVLNode* n){delete n;});
 
   Iterator find(KeyValue key) const;
@@ -368,6 +414,23 @@ public:
 
   ReverseIterator rfindLast(KeyValue key) const;
 
+  //! Element of index in key order, O(log n) by element counts of subtrees plus steps among elements of its key
+  Iterator select(size_t index) const;
+  //! Count of elements with keys lower than key
+  size_t rank(KeyValue key) const;
+  //! Count of elements with keys from first up to but not including last
+  size_t countRange(KeyValue first, KeyValue last) const;
+
+  //! Moves elements with keys not lower than key to returned tree in O(log n),
+  //! key nodes stay in place and pool of returned tree shares slabs of this one
+  MultiAVLTree split(KeyValue key);
+  //! Moves all elements of other tree to this one if all their keys aren't lower or all aren't higher than keys of this tree,
+  //! O(log n) plus merge of key node pools, elements of key equal in both trees are linked to key node of lower tree
+  //! after its elements, which is linear in their count, returns false and leaves trees unchanged otherwise
+  bool join(MultiAVLTree& other);
+  //! Removes elements with keys from first up to but not including last by split and join, returns their count
+  size_t eraseRange(KeyValue first, KeyValue last, std::function<void(AVLNode* deletable_element)> destructor = [](AVLNode* n){delete n;});
+
   Iterator begin() noexcept;
   Iterator end() noexcept;
 
@@ -7,5 +7,6 @@
 #include "ram_storage_implementation/list_impl.hxx"
 #include "ram_storage_implementation/map_impl.hxx"
 #include "ram_storage_implementation/multi_map_impl.hxx"
+#include "ram_storage_implementation/hash_map_impl.hxx"
 
 #endif // RAM_STORAGE_IMPLEMENTATION_H
@@ -3,6 +3,8 @@
 
 #include "../../variables/variable.hxx"
 
+#include <vector>
+
 namespace binom::priv {
 
 class ArrayImplementation {
@@ -16,9 +18,14 @@ private:
   size_t capacity;
 
   ArrayImplementation(const literals::arr& value_list);
+  ArrayImplementation(size_t reserved_count);
   ArrayImplementation(const ArrayImplementation& other);
 
+  //! Block size for count elements, rounded by util_functions::getNearestPow2
   static size_t calculateCapacity(size_t count) noexcept;
+  //! Blocks are malloc'ed, so growth can relocate elements bitwise by realloc
+  static void* allocate(size_t capacity);
+  static void reallocate(ArrayImplementation*& implementation, size_t capacity);
 
   static Iterator increaseSize(ArrayImplementation*& implementation, size_t count);
   static void reduceSize(ArrayImplementation*& implementation, size_t count);
@@ -27,22 +34,45 @@ private:
 public:
 
   static ArrayImplementation* create(const literals::arr& value_list);
+
+  //! Creates array of count elements, each element is constructed in place from generator() result
+  template<typename Generator>
+  static ArrayImplementation* create(size_t count, Generator generator) {
+    ArrayImplementation* implementation = new(allocate(calculateCapacity(count))) ArrayImplementation(count);
+    try {
+      for(Variable* it = implementation->getData(), *end = it + count; it != end; ++it) {
+        new(it) Variable(generator());
+        ++implementation->count;
+      }
+    } catch(...) {
+      delete implementation;
+      throw;
+    }
+    return implementation;
+  }
+
   static ArrayImplementation* copy(const ArrayImplementation* other);
 
   size_t getElementCount() const noexcept;
   size_t getCapacity() const noexcept;
+  //! Count of elements, which fit in allocated block
+  size_t getElementCapacity() const noexcept;
   size_t getSize() const noexcept;
 
+  //! Grows allocated block to fit at least count elements
+  static void reserve(ArrayImplementation*& implementation, size_t count);
+  static void shrinkToFit(ArrayImplementation*& implementation);
+
   Variable* getData() const;
 
   static Variable pushBack(ArrayImplementation*& implementation, Variable variable);
-  static Iterator pushBack(ArrayImplementation*& implementation, const literals::arr variable_list);
+  static Iterator pushBack(ArrayImplementation*& implementation, std::vector<Variable> clones);
 
   static Variable pushFront(ArrayImplementation*& implementation, Variable variable);
-  static Iterator pushFront(ArrayImplementation*& implementation, const literals::arr& variable_list);
+  static Iterator pushFront(ArrayImplementation*& implementation, std::vector<Variable> clones);
 
   static Variable insert(ArrayImplementation*& implementation, size_t at, Variable variable);
-  static Iterator insert(ArrayImplementation*& implementation, size_t at, const literals::arr& variable_list);
+  static Iterator insert(ArrayImplementation*& implementation, size_t at, std::vector<Variable> clones);
 
   static void popBack(ArrayImplementation*& implementation, size_t count = 1);
   static void popFront(ArrayImplementation*& implementation, size_t count = 1);
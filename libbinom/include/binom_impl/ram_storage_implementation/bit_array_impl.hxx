@@ -10,17 +10,27 @@ class BitArrayImplementation {
   size_t capacity = 0;
 
   BitArrayImplementation(const literals::bitarr& bit_array_data);
+  BitArrayImplementation(size_t bit_count);
   BitArrayImplementation(const BitArrayImplementation& other);
 
-  static BitIterator increaseSize(BitArrayImplementation*& implementation, size_t bit_count);
+  //! Blocks are malloc'ed, so growth relocates data by realloc
+  static void* allocate(size_t capacity);
+  static void reallocate(BitArrayImplementation*& implementation, size_t capacity);
+
   static void reduceSize(BitArrayImplementation*& implementation, size_t bit_count);
   static BitIterator insertBits(priv::BitArrayImplementation*& implementation, size_t at, size_t count);
 public:
   static BitArrayImplementation* create(const literals::bitarr& bit_array_data);
-//  static BitArrayImplementation* create()
+  //! Creates bit array of bit_count bits with uninitialized data
+  static BitArrayImplementation* create(size_t bit_count);
+  //! Creates bit array of bit_count bits set to 0
+  static BitArrayImplementation* createZeroed(size_t bit_count);
   static BitArrayImplementation* copy(const BitArrayImplementation* other);
+  //! Appends bit_count bits with uninitialized data, returns iterator to first of them
+  static BitIterator increaseSize(BitArrayImplementation*& implementation, size_t bit_count);
 
   static size_t calculateByteSize(size_t bit_count) noexcept;
+  //! Block size for bit_count bits, rounded by util_functions::getNearestPow2
   static size_t calculateCapacity(size_t bit_count) noexcept;
 
   static BitValueRef pushBack(BitArrayImplementation*& implementation, bool value);
@@ -37,9 +47,13 @@ public:
   static void removeBits(BitArrayImplementation*& implementation, size_t at, size_t count);
   static void clear(BitArrayImplementation*& implementation);
 
+  //! Grows allocated block to fit at least bit_count bits
+  static void reserve(BitArrayImplementation*& implementation, size_t bit_count);
   static void shrinkToFit(BitArrayImplementation*& implementation);
 
   size_t getCapacity() const noexcept;
+  //! Count of bits, which fit in allocated block
+  size_t getBitCapacity() const noexcept;
   size_t getBitSize() const noexcept;
   size_t getByteSize() const noexcept;
   Bits* getData() const noexcept;
@@ -6,30 +6,43 @@
 #include "../../utils/reverse_iterator.hxx"
 #include "../../variables/generic_value.hxx"
 
+#include <bit>
+
 namespace binom::priv {
 
+/**
+ * @brief Buffer array data: size fields followed by raw data in one malloc'ed block
+ *
+ * Byte buffers of up to inline_capacity bytes (and empty buffers) aren't allocated:
+ * they are kept in BufferArrayStorage of the variable, like numbers are kept in ResourceData.
+ * So buffer is accessed only by static functions taking reference to its storage.
+ * Storage is read and changed as plain value under lock of its owner, buffer is moved to heap
+ * when it outgrows storage, and storage is released only by destroy.
+ */
 class BufferArrayImplementation {
   size_t size = 0;
   size_t capacity = 0;
 
-  template<typename T>
-  requires std::is_arithmetic_v<T>
-  BufferArrayImplementation(const std::initializer_list<T>& value_list)
-    : size(value_list.size() * sizeof(T)), capacity(calculateCapacity(size)) { std::memcpy(getData(), value_list.begin(), size); }
-
-  template<typename CharT>
-  requires std::is_arithmetic_v<CharT> &&
-  (sizeof(CharT) == 1 || sizeof(CharT) == 2 || sizeof(CharT) == 4 || sizeof(CharT) == 8)
-  BufferArrayImplementation(const std::basic_string_view<CharT>& string_view)
-    : size(string_view.size() * sizeof(CharT)), capacity(calculateCapacity(size)) { std::memcpy(getData(), string_view.data(), size); }
-
+  BufferArrayImplementation(size_t size) : size(size), capacity(calculateCapacity(size)) {}
   BufferArrayImplementation(const BufferArrayImplementation& other);
+  //! Block size for size bytes of data, rounded by util_functions::getNearestPow2
   static size_t calculateCapacity(size_t size) noexcept;
+  //! Blocks are malloc'ed, so growth relocates data by realloc
+  static void* allocate(size_t capacity);
+  //! Relocates block to capacity, inline buffer is moved to heap
+  static void reallocate(BufferArrayStorage& storage, size_t capacity);
+
+  //! Set in header of inline buffer, pointer to heap block is aligned so it's clear there
+  static constexpr ui8 inline_tag = 1;
+
+  static inline bool fitsInline(VarBitWidth type, size_t size) noexcept {
+    return std::endian::native == std::endian::little && size <= inline_capacity && (type == VarBitWidth::byte || !size);
+  }
+  static BufferArrayStorage createInline(size_t size) noexcept;
+  static void setSize(BufferArrayStorage& storage, size_t size) noexcept;
 
-  static void* increaseSize(BufferArrayImplementation*& implementation, VarBitWidth type, size_t count);
-  static void reduceSize(BufferArrayImplementation*& implementation, VarBitWidth type, size_t count);
-  static void shrinkToFit(BufferArrayImplementation*& implementation);
-  static void* insertBlock(BufferArrayImplementation*& implementation, VarBitWidth type, size_t at, size_t count);
+  static void reduceSize(BufferArrayStorage& storage, VarBitWidth type, size_t count);
+  static void* insertBlock(BufferArrayStorage& storage, VarBitWidth type, size_t at, size_t count);
 
   template<typename T>
   static constexpr VarNumberType determineNumberType() {
@@ -91,94 +104,116 @@ class BufferArrayImplementation {
       set(type, shiftToNextAndGetCurrent(bit_width, memory_block), &value);
   }
 
-  void* get(VarBitWidth type, size_t at) const;
+  static void* get(const BufferArrayStorage& storage, VarBitWidth type, size_t at) noexcept;
+
+  //! Blocks are malloc'ed, so they are released only by destroy
+  void operator delete(void* ptr) = delete;
 
 public:
+  //! Max size of buffer stored in place
+  static constexpr size_t inline_capacity = sizeof(BufferArrayStorage::InlineBuffer::data);
+
+  static inline bool isInline(const BufferArrayStorage& storage) noexcept {return storage.inline_buffer.header & inline_tag;}
+
   template<typename T>
   requires std::is_arithmetic_v<T>
-  static BufferArrayImplementation* create(const std::initializer_list<T>& value_list) {
-    return new(new byte[ calculateCapacity(value_list.size() * sizeof(T)) ])
-           BufferArrayImplementation(value_list);
+  static BufferArrayStorage create(const std::initializer_list<T>& value_list) {
+    BufferArrayStorage storage = create(VarBitWidth(sizeof(T)), value_list.size());
+    std::memcpy(getData(storage), value_list.begin(), value_list.size() * sizeof(T));
+    return storage;
   }
 
   template<typename CharT>
   requires std::is_arithmetic_v<CharT> &&
   (sizeof(CharT) == 1 || sizeof(CharT) == 2 || sizeof(CharT) == 4 || sizeof(CharT) == 8)
-  static BufferArrayImplementation* create(const std::basic_string_view<CharT>& string_view) {
-    return new(new byte[ calculateCapacity(string_view.size() * sizeof(CharT)) ])
-           BufferArrayImplementation(string_view);
+  static BufferArrayStorage create(const std::basic_string_view<CharT>& string_view) {
+    BufferArrayStorage storage = create(VarBitWidth(sizeof(CharT)), string_view.size());
+    if(!string_view.empty()) std::memcpy(getData(storage), string_view.data(), string_view.size() * sizeof(CharT));
+    return storage;
   }
 
-  static BufferArrayImplementation* copy(const BufferArrayImplementation* other);
+  //! Creates buffer of count elements with uninitialized data
+  static BufferArrayStorage create(VarBitWidth type, size_t count);
+  //! Creates buffer of count elements with all bits of data set to 0
+  static BufferArrayStorage createZeroed(VarBitWidth type, size_t count);
+  static BufferArrayStorage copy(const BufferArrayStorage& other);
+  //! Frees heap block of buffer and leaves storage empty
+  static void destroy(BufferArrayStorage& storage) noexcept;
+  //! Appends count elements with uninitialized data, returns pointer to first of them
+  static void* increaseSize(BufferArrayStorage& storage, VarBitWidth type, size_t count);
 
   template<typename T>
   requires extended_type_traits::is_crtp_base_of_v<arithmetic::ArithmeticTypeBase, T> || extended_type_traits::is_arithmetic_without_cvref_v<T>
-  static GenericValueRef pushBack(BufferArrayImplementation*& implementation, ValType type, T value) noexcept {
+  static GenericValueRef pushBack(BufferArrayStorage& storage, ValType type, T value) noexcept {
     VarBitWidth bit_width = toBitWidth(type);
-    void* data = increaseSize(implementation, bit_width, 1);
+    void* data = increaseSize(storage, bit_width, 1);
     set(type, data, value);
     return GenericValueRef(type, data);
   }
 
   template<typename T>
   requires extended_type_traits::is_crtp_base_of_v<arithmetic::ArithmeticTypeBase, T> || extended_type_traits::is_arithmetic_without_cvref_v<T>
-  static GenericValueIterator pushBack(BufferArrayImplementation*& implementation, ValType type, const std::initializer_list<T>& value_list) {
+  static GenericValueIterator pushBack(BufferArrayStorage& storage, ValType type, const std::initializer_list<T>& value_list) {
     VarBitWidth bit_width = toBitWidth(type);
-    void* data = increaseSize(implementation, bit_width, value_list.size());
+    void* data = increaseSize(storage, bit_width, value_list.size());
     setRange(type, data, value_list);
     return GenericValueIterator(type, data);
   }
 
   template<typename T>
-  static GenericValueRef pushFront(BufferArrayImplementation*& implementation, ValType type, T value) noexcept {return insert<T>(implementation, type, 0, value);}
+  static GenericValueRef pushFront(BufferArrayStorage& storage, ValType type, T value) noexcept {return insert<T>(storage, type, 0, value);}
   template<typename T>
-  static GenericValueIterator pushFront(BufferArrayImplementation*& implementation, ValType type, std::initializer_list<T> value_list) {return insert<T>(implementation, type, 0, value_list);}
+  static GenericValueIterator pushFront(BufferArrayStorage& storage, ValType type, std::initializer_list<T> value_list) {return insert<T>(storage, type, 0, value_list);}
 
   template<typename T>
   requires extended_type_traits::is_crtp_base_of_v<arithmetic::ArithmeticTypeBase, T> || extended_type_traits::is_arithmetic_without_cvref_v<T>
-  static GenericValueRef insert(BufferArrayImplementation*& implementation, ValType type, size_t at, T value) noexcept {
+  static GenericValueRef insert(BufferArrayStorage& storage, ValType type, size_t at, T value) noexcept {
     VarBitWidth bit_width = toBitWidth(type);
-    void* data = insertBlock(implementation, bit_width, at, 1);
+    void* data = insertBlock(storage, bit_width, at, 1);
     set(type, data, value);
     return GenericValueRef(type, data);
   }
 
   template<typename T>
   requires extended_type_traits::is_crtp_base_of_v<arithmetic::ArithmeticTypeBase, T> || extended_type_traits::is_arithmetic_without_cvref_v<T>
-  static GenericValueIterator insert(BufferArrayImplementation*& implementation, ValType type, size_t at, const std::initializer_list<T>& value_list) {
+  static GenericValueIterator insert(BufferArrayStorage& storage, ValType type, size_t at, const std::initializer_list<T>& value_list) {
     VarBitWidth bit_width = toBitWidth(type);
-    void* data = insertBlock(implementation, bit_width, at, 1);
+    void* data = insertBlock(storage, bit_width, at, value_list.size());
     setRange(type, data, value_list);
     return GenericValueIterator(type, data);
   }
 
-  static void popBack(BufferArrayImplementation*& implementation, VarBitWidth type, size_t count);
-  static void popFront(BufferArrayImplementation*& implementation, VarBitWidth type, size_t count);
-  static void remove(BufferArrayImplementation*& implementation, VarBitWidth type, size_t at, size_t count);
-  static void clear(BufferArrayImplementation*& implementation, VarBitWidth type);
-
-  void* getData() const;
-
-  template<typename T>
-  inline T* getDataAs() const {return const_cast<T*>(reinterpret_cast<const T*>(this + 1));}
-
-  size_t getSize() const noexcept;
-  size_t getElementCount(VarBitWidth type) const noexcept;
-  size_t getCapacity() const noexcept;
-
-  GenericValueRef get(ValType type, size_t at);
-  const GenericValueRef get(ValType type, size_t at) const;
-
-  GenericValueIterator begin(ValType type);
-  GenericValueIterator end(ValType type);
-  const GenericValueIterator begin(ValType type) const;
-  const GenericValueIterator end(ValType type) const;
-  ReverseGenericValueIterator rbegin(ValType type);
-  ReverseGenericValueIterator rend(ValType type);
-  const ReverseGenericValueIterator rbegin(ValType type) const;
-  const ReverseGenericValueIterator rend(ValType type) const;
+  static void popBack(BufferArrayStorage& storage, VarBitWidth type, size_t count);
+  static void popFront(BufferArrayStorage& storage, VarBitWidth type, size_t count);
+  static void remove(BufferArrayStorage& storage, VarBitWidth type, size_t at, size_t count);
+  static void clear(BufferArrayStorage& storage, VarBitWidth type);
+
+  //! Data of inline buffer is in storage, so it must be storage of variable, not a temporary copy
+  static byte* getData(const BufferArrayStorage& storage) noexcept;
+  static byte* getData(BufferArrayStorage&& storage) = delete;
+
+  static size_t getSize(const BufferArrayStorage& storage) noexcept;
+  static size_t getElementCount(const BufferArrayStorage& storage, VarBitWidth type) noexcept;
+  //! Size of allocated block including size fields, size of storage for inline buffer
+  static size_t getCapacity(const BufferArrayStorage& storage) noexcept;
+  //! Count of elements, which fit in allocated block
+  static size_t getElementCapacity(const BufferArrayStorage& storage, VarBitWidth type) noexcept;
+
+  //! Grows allocated block to fit at least count elements
+  static void reserve(BufferArrayStorage& storage, VarBitWidth type, size_t count);
+  static void shrinkToFit(BufferArrayStorage& storage);
+
+  static GenericValueRef get(const BufferArrayStorage& storage, ValType type, size_t at) noexcept;
+  static GenericValueIterator begin(const BufferArrayStorage& storage, ValType type) noexcept;
+  static GenericValueIterator end(const BufferArrayStorage& storage, ValType type) noexcept;
+  static ReverseGenericValueIterator rbegin(const BufferArrayStorage& storage, ValType type) noexcept;
+  static ReverseGenericValueIterator rend(const BufferArrayStorage& storage, ValType type) noexcept;
+  static GenericValueRef get(BufferArrayStorage&& storage, ValType type, size_t at) = delete;
+  static GenericValueIterator begin(BufferArrayStorage&& storage, ValType type) = delete;
+  static GenericValueIterator end(BufferArrayStorage&& storage, ValType type) = delete;
+  static ReverseGenericValueIterator rbegin(BufferArrayStorage&& storage, ValType type) = delete;
+  static ReverseGenericValueIterator rend(BufferArrayStorage&& storage, ValType type) = delete;
 
-  void operator delete(void* ptr);
 };
 
 
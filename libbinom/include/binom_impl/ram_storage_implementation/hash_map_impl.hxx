@@ -0,0 +1,128 @@
+#ifndef HASH_MAP_IMPL_HXX
+#define HASH_MAP_IMPL_HXX
+
+#include <vector>
+#include "../../utils/pseudo_pointer.hxx"
+#include "../../variables/key_value.hxx"
+#include "../../variables/variable.hxx"
+
+namespace binom::priv {
+
+/**
+ * @brief Open addressing hash table of key-variable pairs with unique keys
+ *
+ * Swiss table layout: each slot has control byte with 7 bits of key hash,
+ * slots are probed by groups of group_size control bytes which are matched as one word,
+ * so key is compared only with elements of matching control bytes.
+ * Elements are unordered and relocated by rehash,
+ * so insertion invalidates iterators and named variables of elements.
+ */
+class HashMapImplementation {
+public:
+  using NamedVariable = MapNodeRef;
+  static constexpr size_t group_size = 8;
+
+private:
+  ui8* controls = nullptr;
+  KeyValue* keys = nullptr;
+  Variable* variables = nullptr;
+  size_t capacity = 0;
+  size_t element_count = 0;
+  size_t growth_left = 0; ///< Count of empty slots which can be filled before rehash
+
+  static constexpr size_t npos = size_t(-1);
+
+  NamedVariable getNamedVariable(size_t index) const noexcept;
+  size_t findIndex(KeyValue& key, size_t hash) const noexcept;
+  //! Index of empty or deleted slot for key with hash, key must be absent in map
+  size_t findInsertIndex(size_t hash) const noexcept;
+  size_t insertElement(KeyValue& key, Variable& variable, size_t hash);
+  void eraseElement(size_t index);
+  void rehash(size_t new_capacity);
+  size_t nextFullIndex(size_t index) const noexcept;
+
+public:
+  class Iterator {
+    HashMapImplementation* map;
+    size_t index;
+    friend class HashMapImplementation;
+  public:
+    Iterator(HashMapImplementation* map = nullptr, size_t index = 0) noexcept : map(map), index(index) {}
+    Iterator(const Iterator& other) noexcept = default;
+    Iterator& operator=(const Iterator& other) noexcept = default;
+    Iterator& operator++() noexcept;
+    Iterator operator++(int) noexcept;
+    bool operator==(const Iterator& other) const noexcept {return map == other.map && index == other.index;}
+    bool operator!=(const Iterator& other) const noexcept {return !(self == other);}
+    NamedVariable operator*();
+    pseudo_ptr::PseudoPointer<NamedVariable> operator->();
+    const NamedVariable operator*() const;
+    pseudo_ptr::PseudoPointer<const NamedVariable> operator->() const;
+    static Iterator nullit() noexcept {return Iterator();}
+  };
+
+  class ConstIterator {
+    const HashMapImplementation* map;
+    size_t index;
+    friend class HashMapImplementation;
+  public:
+    ConstIterator(const HashMapImplementation* map = nullptr, size_t index = 0) noexcept : map(map), index(index) {}
+    ConstIterator(const Iterator& other) noexcept : map(other.map), index(other.index) {}
+    ConstIterator(const ConstIterator& other) noexcept = default;
+    ConstIterator& operator=(const ConstIterator& other) noexcept = default;
+    ConstIterator& operator++() noexcept;
+    ConstIterator operator++(int) noexcept;
+    bool operator==(const ConstIterator& other) const noexcept {return map == other.map && index == other.index;}
+    bool operator!=(const ConstIterator& other) const noexcept {return !(self == other);}
+    const NamedVariable operator*() const;
+    pseudo_ptr::PseudoPointer<const NamedVariable> operator->() const;
+    //! Direct access to element without NamedVariable wrapping
+    const KeyValue& getKey() const noexcept;
+    const Variable& getVariable() const noexcept;
+    static ConstIterator nullit() noexcept {return ConstIterator();}
+  };
+
+  HashMapImplementation() = default;
+  HashMapImplementation(const literals::hashmap& map);
+  HashMapImplementation(const HashMapImplementation& other);
+  HashMapImplementation(HashMapImplementation&& other);
+  ~HashMapImplementation();
+
+  bool isEmpty() const noexcept;
+  size_t getSize() const noexcept;
+  size_t getCapacity() const noexcept;
+  bool contains(KeyValue value) const noexcept;
+
+  //! Rehashes table so count elements can be inserted without rehash
+  void reserve(size_t count);
+
+  err::ProgressReport<NamedVariable> insert(KeyValue key, Variable variable);
+
+  err::Error remove(KeyValue key);
+
+  NamedVariable getOrInsertNamedVariable(KeyValue key);
+
+  Variable getVariable(KeyValue key) const;
+
+  Iterator find(KeyValue key);
+  ConstIterator find(KeyValue key) const;
+
+  //! Iterators of elements in key order, serialization writes hash map like key-sorted map
+  std::vector<ConstIterator> getKeyOrder() const;
+
+  void clear();
+
+  Iterator begin() noexcept;
+  Iterator end() noexcept;
+
+  ConstIterator begin() const noexcept;
+  ConstIterator end() const noexcept;
+
+  ConstIterator cbegin() const noexcept;
+  ConstIterator cend() const noexcept;
+
+};
+
+}
+
+#endif // HASH_MAP_IMPL_HXX
@@ -1,67 +1,215 @@
 #ifndef MAP_IMPL_HXX
 #define MAP_IMPL_HXX
 
-#include <map>
 #include "../../utils/pseudo_pointer.hxx"
+#include "../../utils/slab_allocator.hxx"
 #include "../../variables/key_value.hxx"
 #include "../../variables/variable.hxx"
 
 namespace binom::priv {
 
+/**
+ * @brief B+-tree of key-variable pairs with unique keys
+ *
+ * Elements are allocated from slabs of map and keep the only copy of their keys in leaves.
+ * Leaves keep contiguous arrays of comparable prefixes of element keys (KeyValue::getComparablePrefix),
+ * which are searched in place, and arrays of pointers to elements in the same order, so search dereferences
+ * only elements with prefix of searched key, iteration goes through leaves sequentially
+ * and map with up to node_capacity elements is single leaf. Inner nodes keep copies of separator keys.
+ * Inner nodes keep element counts of child subtrees, so element of index and rank of key are found in O(log n).
+ * Only key prefixes and pointers are moved within tree by insertion and removal, and split shares slabs
+ * between maps instead of moving elements, so iterators and named variables of element are valid until it is removed.
+ * Shared slabs are kept while any of maps sharing them is alive, so map left by released part of split
+ * moves its elements to own slabs by split, join or shrinkToFit if they take less than quarter of its blocks,
+ * which invalidates its iterators and named variables.
+ */
 class MapImplementation {
 public:
-  typedef std::map<KeyValue, Variable> VariableMap;
   using NamedVariable = MapNodeRef;
+  static constexpr size_t node_capacity = 32;
 
-  class Iterator : public VariableMap::iterator {
+private:
+  struct Node;
+  struct Leaf;
+  struct InnerNode;
+  struct Path;
+  //! Leaf and index of element pointer in it
+  struct Position;
+
+  struct Element {
+    KeyValue key;
+    Variable variable;
+    //! Leaf which points to element, it's updated when element pointer goes to other leaf
+    Leaf* leaf = nullptr;
+    Element(KeyValue& key, Variable& variable) : key(std::move(key)), variable(variable.move()) {}
+  };
+
+  //! Iterators keep index of element in its leaf, which is checked before search of element in leaf,
+  //! so iteration doesn't search elements until leaf is changed
+  static void stepForward(Element*& element, size_t& index) noexcept;
+  static void stepBackward(Element*& element, size_t& index) noexcept;
+  static NamedVariable getNamedVariable(Element* element) noexcept;
+
+public:
+  class Iterator {
+    Element* element;
+    size_t index;
+    friend class MapImplementation;
   public:
-    Iterator(VariableMap::iterator map_it);
-    Iterator(const Iterator& other);
-    Iterator(Iterator&& other);
+    Iterator(Element* element = nullptr, size_t index = 0) noexcept : element(element), index(index) {}
+    Iterator(const Iterator& other) noexcept = default;
+    Iterator& operator=(const Iterator& other) noexcept = default;
+    Iterator& operator++() noexcept;
+    Iterator operator++(int) noexcept;
+    bool operator==(const Iterator& other) const noexcept {return element == other.element;}
+    bool operator!=(const Iterator& other) const noexcept {return !(self == other);}
     NamedVariable operator*();
     pseudo_ptr::PseudoPointer<NamedVariable> operator->();
     const NamedVariable operator*() const;
     pseudo_ptr::PseudoPointer<const NamedVariable> operator->() const;
-    static Iterator nullit() noexcept {return  VariableMap::iterator(nullptr);}
+    static Iterator nullit() noexcept {return Iterator();}
   };
 
-  class ReverseIterator : public VariableMap::reverse_iterator {
+  class ReverseIterator {
+    Element* element;
+    size_t index;
+    friend class MapImplementation;
   public:
-    ReverseIterator(VariableMap::reverse_iterator map_rit);
-    ReverseIterator(const ReverseIterator& other);
-    ReverseIterator(ReverseIterator&& other);
+    ReverseIterator(Element* element = nullptr, size_t index = 0) noexcept : element(element), index(index) {}
+    ReverseIterator(const ReverseIterator& other) noexcept = default;
+    ReverseIterator& operator=(const ReverseIterator& other) noexcept = default;
+    ReverseIterator& operator++() noexcept;
+    ReverseIterator operator++(int) noexcept;
+    bool operator==(const ReverseIterator& other) const noexcept {return element == other.element;}
+    bool operator!=(const ReverseIterator& other) const noexcept {return !(self == other);}
     NamedVariable operator*();
     pseudo_ptr::PseudoPointer<NamedVariable> operator->();
     const NamedVariable operator*() const;
     pseudo_ptr::PseudoPointer<const NamedVariable> operator->() const;
-    static ReverseIterator nullit() noexcept {return  VariableMap::reverse_iterator(Iterator::nullit());}
+    static ReverseIterator nullit() noexcept {return ReverseIterator();}
   };
 
-  class ConstIterator : public VariableMap::const_iterator {
+  class ConstIterator {
+    Element* element;
+    size_t index;
+    friend class MapImplementation;
   public:
-    ConstIterator(VariableMap::const_iterator map_it);
-    ConstIterator(const ConstIterator& other);
-    ConstIterator(ConstIterator&& other);
+    ConstIterator(Element* element = nullptr, size_t index = 0) noexcept : element(element), index(index) {}
+    ConstIterator(const Iterator& other) noexcept : element(other.element), index(other.index) {}
+    ConstIterator(const ConstIterator& other) noexcept = default;
+    ConstIterator& operator=(const ConstIterator& other) noexcept = default;
+    ConstIterator& operator++() noexcept;
+    ConstIterator operator++(int) noexcept;
+    bool operator==(const ConstIterator& other) const noexcept {return element == other.element;}
+    bool operator!=(const ConstIterator& other) const noexcept {return !(self == other);}
     const NamedVariable operator*() const;
     pseudo_ptr::PseudoPointer<const NamedVariable> operator->() const;
-    static ConstIterator nullit() noexcept {return  VariableMap::const_iterator(nullptr);}
+    //! Direct access to element without NamedVariable wrapping
+    const KeyValue& getKey() const noexcept;
+    const Variable& getVariable() const noexcept;
+    static ConstIterator nullit() noexcept {return ConstIterator();}
   };
 
-  class ConstReverseIterator : public VariableMap::const_reverse_iterator {
+  class ConstReverseIterator {
+    Element* element;
+    size_t index;
+    friend class MapImplementation;
   public:
-    ConstReverseIterator(VariableMap::const_reverse_iterator map_rit);
-    ConstReverseIterator(const ConstReverseIterator& other);
-    ConstReverseIterator(ConstReverseIterator&& other);
+    ConstReverseIterator(Element* element = nullptr, size_t index = 0) noexcept : element(element), index(index) {}
+    ConstReverseIterator(const ReverseIterator& other) noexcept : element(other.element), index(other.index) {}
+    ConstReverseIterator(const ConstReverseIterator& other) noexcept = default;
+    ConstReverseIterator& operator=(const ConstReverseIterator& other) noexcept = default;
+    ConstReverseIterator& operator++() noexcept;
+    ConstReverseIterator operator++(int) noexcept;
+    bool operator==(const ConstReverseIterator& other) const noexcept {return element == other.element;}
+    bool operator!=(const ConstReverseIterator& other) const noexcept {return !(self == other);}
     const NamedVariable operator*() const;
     pseudo_ptr::PseudoPointer<const NamedVariable> operator->() const;
-    static ConstReverseIterator nullit() noexcept {return  VariableMap::const_reverse_iterator(ConstIterator::nullit());}
+    static ConstReverseIterator nullit() noexcept {return ConstReverseIterator();}
   };
 
 private:
-  VariableMap storage;
+  Node* root = nullptr;
+  size_t height = 0; ///< Count of inner node levels, root is leaf if 0
+  size_t element_count = 0;
+  Leaf* first_leaf = nullptr;
+  Leaf* last_leaf = nullptr;
+  //! Elements are allocated from slabs of map, which are freed at once on clear and destruction
+  slab_allocator::SlabPool element_pool{sizeof(Element), alignof(Element)};
+
+  Element* createElement(KeyValue& key, Variable& variable);
+  void destroyElement(Element* element) noexcept;
+
+  //! Position of element with key, leaf is nullptr if there is no such key
+  Position findElement(KeyValue& key) const noexcept;
+  //! Position of first key which isn't lower than key, fills path of inner nodes to its leaf
+  Position descend(Path& path, KeyValue& key) const noexcept;
+  static bool isKeyAt(Position position, KeyValue& key) noexcept;
+  //! Links element at position given by descend, its key must be absent in map
+  void insertElement(Path& path, Position position, Element* element);
+  //! Inserts new_node right after child of path at depth, which has node_size elements now, splits full parents
+  //! up to new root, element counts of path children above are increased by added_count
+  void insertNode(Path& path, size_t depth, KeyValue& separator, size_t node_size,
+                  Node* new_node, size_t new_node_size, size_t added_count);
+  //! Unlinks element at position given by descend and returns it
+  Element* removeElement(Path& path, Position position);
+  //! Merges or evens node of depth with sibling, goes up while merges leave parents underfull
+  void rebalance(Path& path, size_t depth);
+  //! Copies subtree of level (0 for leaf) linking copied leaves after last_leaf
+  Node* copyNode(const Node* node, size_t level);
+  //! Destroys nodes of subtree, its elements are destroyed separately
+  static void destroyNode(Node* node, size_t level) noexcept;
+
+  //! Appends element after all elements of leaves during bulk load, creates next leaf if is_new_leaf
+  void appendBulkElement(KeyValue& key, Variable& variable, bool is_new_leaf);
+  //! Error if key isn't higher than last appended key
+  err::Error checkBulkKey(KeyValue& key) const noexcept;
+  //! Builds inner levels over loaded leaves and sets root
+  void buildInnerLevels();
+  //! Destroys loaded leaves and elements after failure of bulk load
+  void abortBulkLoad() noexcept;
+
+  //! Makes node of level with size elements root of empty map, unlinks its edge leaves from leaves of other maps
+  void setRoot(Node* node, size_t level, size_t size) noexcept;
+  //! Moves children from first up to but not including last of inner node of level to empty map
+  void takeChildren(InnerNode* node, size_t first, size_t last, size_t level);
+  //! Moves elements of other map, which are higher than all elements of this one, to its end
+  void append(MapImplementation& other);
+  //! Moves elements with keys not lower than key to empty upper map, elements stay in slabs of this map
+  void splitTree(KeyValue& key, MapImplementation& upper);
+  //! Swaps trees, elements stay in slabs of their pools
+  void swap(MapImplementation& other) noexcept;
+
+  template<typename Generator>
+  err::Error bulkLoadImpl(size_t count, Generator& generator, bool is_checked) {
+    clear();
+    if(!count) return err::ErrorType::no_error;
+    // Elements are spread evenly, so each leaf of multi-leaf tree is at least half full
+    const size_t leaf_count = count / node_capacity + (count % node_capacity != 0);
+    try {
+      for(size_t leaf_index = 0; leaf_index < leaf_count; ++leaf_index) {
+        const size_t leaf_size = count / leaf_count + (leaf_index < count % leaf_count);
+        for(size_t i = 0; i < leaf_size; ++i) {
+          auto [key, variable] = generator();
+          if(is_checked)
+            if(err::Error error = checkBulkKey(key); error) {
+              abortBulkLoad();
+              return error;
+            }
+          appendBulkElement(key, variable, !i);
+        }
+      }
+      buildInnerLevels();
+    } catch(...) {
+      abortBulkLoad();
+      throw;
+    }
+    return err::ErrorType::no_error;
+  }
 
 public:
 
+  MapImplementation() = default;
   MapImplementation(const literals::map& map);
   MapImplementation(const MapImplementation& other);
   MapImplementation(MapImplementation&& other);
@@ -72,6 +220,17 @@ public:
   bool contains(KeyValue value) const noexcept;
 
   err::ProgressReport<NamedVariable> insert(KeyValue key, Variable variable);
+  //! Amortized O(1) if hint is end and key is greater than all keys of map
+  err::ProgressReport<NamedVariable> insert(ConstIterator hint, KeyValue key, Variable variable);
+
+  //! Replaces elements by count results of generator() (std::pair<KeyValue, Variable>) in ascending key order,
+  //! leaves are filled in order and inner levels are built over them in O(n) without key comparisons
+  template<typename Generator>
+  void bulkLoad(size_t count, Generator generator) {bulkLoadImpl(count, generator, false);}
+  //! Same as bulkLoad, but each key is checked to be higher than previous one in the same pass,
+  //! on misordered key map is left empty and binom_key_unique_error or invalid_data is returned
+  template<typename Generator>
+  err::Error bulkLoadChecked(size_t count, Generator generator) {return bulkLoadImpl(count, generator, true);}
 
   err::Error remove(KeyValue key);
 
@@ -86,6 +245,26 @@ public:
   ConstIterator find(KeyValue key) const;
   ConstReverseIterator rfind(KeyValue key) const;
 
+  //! Element of index in key order or end
+  Iterator select(size_t index) const noexcept;
+  //! Count of keys lower than key
+  size_t rank(KeyValue key) const noexcept;
+  //! Count of keys from first up to but not including last
+  size_t countRange(KeyValue first, KeyValue last) const noexcept;
+
+  //! Moves elements with keys not lower than key to upper map, O(log n) by cut of path to key and joins of cut parts.
+  //! Elements stay in place and slabs are shared by both maps, so they are freed when both maps are cleared
+  void split(KeyValue key, MapImplementation& upper);
+  //! Moves all elements of other map to this one if all their keys are higher or all are lower than keys of this map,
+  //! lower tree becomes subtree on edge of higher one in O(log n) and slabs of other map are taken with its elements,
+  //! returns invalid_data and leaves maps unchanged otherwise
+  err::Error join(MapImplementation& other);
+  //! Removes elements with keys from first up to but not including last, returns their count
+  size_t eraseRange(KeyValue first, KeyValue last);
+  //! Moves elements to own slabs in O(n) if they take less than quarter of blocks of slabs
+  //! and maps which shared them are released, so memory of released part of split is freed
+  void shrinkToFit();
+
   void clear();
 
   Iterator begin() noexcept;
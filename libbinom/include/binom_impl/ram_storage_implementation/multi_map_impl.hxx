@@ -1,27 +1,52 @@
 #ifndef MULTIMAP_IMPL_HXX
 #define MULTIMAP_IMPL_HXX
 
-//#include "../multi_avl_tree.hxx"
-//#include "../../variables/variable.hxx"
-//#include "../../utils/pseudo_pointer.hxx"
-#include <map>
+#include <vector>
+#include "../multi_avl_tree.hxx"
 #include "../../utils/pseudo_pointer.hxx"
+#include "../../utils/slab_allocator.hxx"
 #include "../../variables/key_value.hxx"
 #include "../../variables/variable.hxx"
 
 namespace binom::priv {
 
+/**
+ * @brief MultiAVLTree of variables, elements with equal keys are kept in one key node in insertion order
+ *
+ * Key nodes keep element counts of their subtrees, so element of index and rank of key are found in O(log n).
+ * Elements aren't relocated by changes of other elements, so iterators and named variables
+ * of element are valid until it is removed, split shares slabs between multimaps instead of moving elements.
+ * Multimap left by released part of split moves its elements to own slabs as MapImplementation::shrinkToFit does.
+ */
 class MultiMapImplementation {
-
 public:
-  typedef std::multimap<KeyValue, Variable> VariableMultiMap;
   using NamedVariable = MapNodeRef;
+  using NewNodePosition = MultiAVLTree::NewNodePosition;
 
-  class Iterator : public VariableMultiMap::iterator {
+private:
+  //! Key is stored once by key node of tree for all its elements
+  struct Element : public MultiAVLTree::AVLNode {
+    Variable variable;
+    Element(Variable& variable) : variable(variable.move()) {}
+  };
+
+  static NamedVariable getNamedVariable(const MultiAVLTree::Iterator& it) noexcept;
+  static NamedVariable getNamedVariable(const MultiAVLTree::ReverseIterator& it) noexcept;
+
+public:
+  class Iterator {
+    MultiAVLTree::Iterator iterator;
+    friend class MultiMapImplementation;
   public:
-    Iterator(VariableMultiMap::iterator map_it);
-    Iterator(const Iterator& other);
-    Iterator(Iterator&& other);
+    Iterator(MultiAVLTree::Iterator iterator) : iterator(iterator) {}
+    Iterator(const Iterator& other) = default;
+    Iterator& operator=(const Iterator& other) = default;
+    Iterator& operator++();
+    Iterator operator++(int);
+    Iterator& operator--();
+    Iterator operator--(int);
+    bool operator==(const Iterator& other) const noexcept {return iterator == other.iterator;}
+    bool operator!=(const Iterator& other) const noexcept {return !(self == other);}
     NamedVariable operator*();
     pseudo_ptr::PseudoPointer<NamedVariable> operator->();
     const NamedVariable operator*() const;
@@ -29,11 +54,19 @@ public:
     static Iterator nullit() noexcept;
   };
 
-  class ReverseIterator : public VariableMultiMap::reverse_iterator {
+  class ReverseIterator {
+    MultiAVLTree::ReverseIterator iterator;
+    friend class MultiMapImplementation;
   public:
-    ReverseIterator(VariableMultiMap::reverse_iterator map_rit);
-    ReverseIterator(const ReverseIterator& other);
-    ReverseIterator(ReverseIterator&& other);
+    ReverseIterator(MultiAVLTree::ReverseIterator iterator) : iterator(iterator) {}
+    ReverseIterator(const ReverseIterator& other) = default;
+    ReverseIterator& operator=(const ReverseIterator& other) = default;
+    ReverseIterator& operator++();
+    ReverseIterator operator++(int);
+    ReverseIterator& operator--();
+    ReverseIterator operator--(int);
+    bool operator==(const ReverseIterator& other) const noexcept {return iterator == other.iterator;}
+    bool operator!=(const ReverseIterator& other) const noexcept {return !(self == other);}
     NamedVariable operator*();
     pseudo_ptr::PseudoPointer<NamedVariable> operator->();
     const NamedVariable operator*() const;
@@ -41,36 +74,64 @@ public:
     static ReverseIterator nullit() noexcept;
   };
 
-  class ConstIterator : public VariableMultiMap::const_iterator {
+  class ConstIterator {
+    MultiAVLTree::Iterator iterator;
+    friend class MultiMapImplementation;
   public:
-    ConstIterator(VariableMultiMap::const_iterator map_it);
-    ConstIterator(const ConstIterator& other);
-    ConstIterator(ConstIterator&& other);
+    ConstIterator(MultiAVLTree::Iterator iterator) : iterator(iterator) {}
+    ConstIterator(const Iterator& other) : iterator(other.iterator) {}
+    ConstIterator(const ConstIterator& other) = default;
+    ConstIterator& operator=(const ConstIterator& other) = default;
+    ConstIterator& operator++();
+    ConstIterator operator++(int);
+    ConstIterator& operator--();
+    ConstIterator operator--(int);
+    bool operator==(const ConstIterator& other) const noexcept {return iterator == other.iterator;}
+    bool operator!=(const ConstIterator& other) const noexcept {return !(self == other);}
     const NamedVariable operator*() const;
     pseudo_ptr::PseudoPointer<const NamedVariable> operator->() const;
+    //! Direct access to element without NamedVariable wrapping
+    const KeyValue& getKey() const noexcept;
+    const Variable& getVariable() const noexcept;
     static ConstIterator nullit() noexcept;
   };
 
-  class ConstReverseIterator : public VariableMultiMap::const_reverse_iterator {
+  class ConstReverseIterator {
+    MultiAVLTree::ReverseIterator iterator;
+    friend class MultiMapImplementation;
   public:
-    ConstReverseIterator(VariableMultiMap::const_reverse_iterator map_rit);
-    ConstReverseIterator(const ConstReverseIterator& other);
-    ConstReverseIterator(ConstReverseIterator&& other);
+    ConstReverseIterator(MultiAVLTree::ReverseIterator iterator) : iterator(iterator) {}
+    ConstReverseIterator(const ReverseIterator& other) : iterator(other.iterator) {}
+    ConstReverseIterator(const ConstReverseIterator& other) = default;
+    ConstReverseIterator& operator=(const ConstReverseIterator& other) = default;
+    ConstReverseIterator& operator++();
+    ConstReverseIterator operator++(int);
+    ConstReverseIterator& operator--();
+    ConstReverseIterator operator--(int);
+    bool operator==(const ConstReverseIterator& other) const noexcept {return iterator == other.iterator;}
+    bool operator!=(const ConstReverseIterator& other) const noexcept {return !(self == other);}
     const NamedVariable operator*() const;
     pseudo_ptr::PseudoPointer<const NamedVariable> operator->() const;
     static ConstReverseIterator nullit() noexcept;
   };
 
 private:
-  VariableMultiMap storage;
+  MultiAVLTree storage;
+  //! Elements are allocated from slabs of multimap, which are freed at once on clear and destruction
+  slab_allocator::SlabPool element_pool{sizeof(Element), alignof(Element)};
 
-public:
-  using NewNodePosition = MultiAVLTree::NewNodePosition;
+  Element* createElement(Variable& variable);
+  void destroyElement(MultiAVLTree::AVLNode* node) noexcept;
+  //! Destroys elements of bulk load input, which aren't linked to tree
+  void abortBulkLoad(std::vector<MultiAVLTree::KeyNodePair>& elements) noexcept;
 
+public:
+  MultiMapImplementation() = default;
   MultiMapImplementation(const literals::multimap& map, NewNodePosition pos = NewNodePosition::back);
+  //! Copies of elements are linked into tree by bulk load in O(n)
   MultiMapImplementation(const MultiMapImplementation& other);
   MultiMapImplementation(MultiMapImplementation&& other);
-  ~MultiMapImplementation() = default;
+  ~MultiMapImplementation();
 
   bool isEmpty() const noexcept;
   size_t getSize() const noexcept;
@@ -78,6 +139,30 @@ public:
 
   NamedVariable insert(KeyValue key, Variable variable, NewNodePosition position = NewNodePosition::back);
 
+  //! Replaces elements by count results of generator() (std::pair<KeyValue, Variable>) in ascending key order,
+  //! elements of equal keys keep their order, tree of key nodes is built by MultiAVLTree::bulkLoadChecked in O(n),
+  //! on descending key multimap is left empty and invalid_data is returned
+  template<typename Generator>
+  err::Error bulkLoadChecked(size_t count, Generator generator) {
+    clear();
+    std::vector<MultiAVLTree::KeyNodePair> elements;
+    try {
+      for(size_t i = 0; i < count; ++i) {
+        auto [key, variable] = generator();
+        elements.push_back({std::move(key), nullptr});
+        elements.back().node = createElement(variable);
+      }
+    } catch(...) {
+      abortBulkLoad(elements);
+      throw;
+    }
+    if(err::Error error = storage.bulkLoadChecked(elements.data(), elements.size()); error) {
+      abortBulkLoad(elements);
+      return error;
+    }
+    return err::ErrorType::no_error;
+  }
+
   void remove(Iterator it);
   void remove(ReverseIterator it);
   size_t removeAll(KeyValue key);
@@ -100,6 +185,29 @@ public:
   ConstIterator findLast(KeyValue key) const;
   ConstReverseIterator rfindLast(KeyValue key) const;
 
+  //! Element of index in key order or end, O(log n) by element counts of key node subtrees
+  //! plus steps among elements of its key
+  Iterator select(size_t index);
+  ConstIterator select(size_t index) const;
+  //! Count of elements with keys lower than key, O(log n)
+  size_t rank(KeyValue key) const;
+  //! Count of elements with keys from first up to but not including last, O(log n)
+  size_t countRange(KeyValue first, KeyValue last) const;
+
+  //! Moves elements with keys not lower than key to upper multimap, tree is split in O(log n) by MultiAVLTree::split.
+  //! Elements stay in place and slabs are shared by both multimaps, so they are freed when both multimaps are cleared
+  void split(KeyValue key, MultiMapImplementation& upper);
+  //! Moves all elements of other multimap to this one if all their keys aren't lower or all aren't higher than keys of this one,
+  //! trees are joined by MultiAVLTree::join and slabs of other multimap are taken with its elements,
+  //! returns invalid_data and leaves multimaps unchanged otherwise
+  err::Error join(MultiMapImplementation& other);
+  //! Removes elements with keys from first up to but not including last, returns their count,
+  //! O(log n) by split and join of tree plus destruction of elements
+  size_t eraseRange(KeyValue first, KeyValue last);
+  //! Rebuilds multimap with its key nodes in own slabs in O(n) if elements take less than quarter
+  //! of blocks of slabs and multimaps which shared them are released
+  void shrinkToFit();
+
   void clear();
 
   Iterator begin() noexcept;
@@ -122,8 +230,6 @@ public:
 
 };
 
-/**/
-
 }
 
 #endif // MULTIMAP_IMPL_HXX
@@ -228,7 +228,7 @@ public:
 
   Error insert(literals::table::RowLiteral row_data) {
     RowHeader& row_header = self.row_list.emplace_back();
-    row_header.self_iterator = self.row_list.rbegin().base();
+    row_header.self_iterator = std::prev(self.row_list.end());
 
     for(auto& cell_data : row_data) {
 
@@ -6,6 +6,8 @@
 #include "../utils/shared_recursive_mutex_wrapper.hxx"
 
 #include <atomic>
+#include <limits>
+#include <mutex>
 
 namespace binom::priv {
 
@@ -27,11 +29,12 @@ struct ResourceData {
     f64   f64_val;
 
     BitArrayImplementation*         bit_array_implementation;
-    BufferArrayImplementation*      buffer_array_implementation;
+    BufferArrayStorage              buffer_array_storage;
     ArrayImplementation*            array_implementation;
     ListImplementation*             list_implementation;
     MapImplementation*              map_implementation;
     MultiMapImplementation*         multi_map_implementation;
+    HashMapImplementation*          hash_map_implementation;
 
     template<typename T> T* asPointerAt() const noexcept { return reinterpret_cast<T*>(pointer);}
   };
@@ -42,22 +45,81 @@ struct ResourceData {
 
 // File storage resource
 struct FileResourceIndex {
-  // Union of binom::file_storage::<TypeClass>Implementation (inherit from Base<TypeClass>Implementation)
-  union Index {/*TODO*/};
+  // Numbers are stored inline, other types reference first directory page of node
+  // in paged file or offset of node in mapped file
+  union Index {
+    ui64 page = 0;
+    ui64 offset;
+
+    bool  bool_val;
+    ui8   ui8_val;
+    ui16  ui16_val;
+    ui32  ui32_val;
+    ui64  ui64_val;
+    i8    i8_val;
+    i16   i16_val;
+    i32   i32_val;
+    i64   i64_val;
+    f32   f32_val;
+    f64   f64_val;
+  };
   VarType type = VarType::null;
   Index index;
 };
 
+struct SharedResource;
+
+/**
+ * @brief CloneSource - implementation shared by copy-on-write clones
+ *
+ * Clones of source resource are created without implementation and copy
+ * it on first access, elements are cloned same way, so only accessed path is copied.
+ * Source keeps its implementation and is read in place until it's unique locked or gives out
+ * links, references or iterators to its elements (Link::getElementLinkLock, Link::getElementAccessLock),
+ * then pending clones get snapshot of it.
+ * Container which gave out mutable references or iterators to its elements may be changed through them
+ * later bypassing its lock, so it's copied right away instead of lazy clone until its next change,
+ * which invalidates them.
+ *
+ * Limits:
+ * - Pending clone has no implementation to read, so it's copied on first access, not first change.
+ */
+struct CloneSource {
+  std::mutex mtx;
+  SharedResource* source;       ///< Untouched resource or nullptr if snapshot was taken
+  ResourceData snapshot;        ///< Implementation state for pending clones after source was touched
+  size_t pending_count = 0;     ///< Clones without implementation
+
+  CloneSource(SharedResource* source) noexcept : source(source) {}
+  ~CloneSource();
+};
+
 struct SharedResource {
   ResourceData resource_data;
+  //! Set until node is materialized from mapped file, resource_data.data holds node offset meanwhile
+  std::atomic<MappedFile*> mapped_file = nullptr;
+  //! Set while resource is untouched source of clones or clone without implementation
+  std::atomic<CloneSource*> clone_source = nullptr;
+  //! Set while mutable references or iterators given out by container are valid, see Link::getElementAccessLock
+  std::atomic_bool has_element_references = false;
 
   std::atomic_uint64_t link_counter = 1;
+#ifndef BINOM_SINGLE_THREAD
+  //! Incremented by each access which may change elements of container: unique lock or giving out of elements
+  std::atomic_uint64_t access_count = 0;
+  //! Access count at which elements of container were last found exclusive, see Link::isExclusiveSubtree
+  std::atomic_uint64_t exclusive_access_count = std::numeric_limits<ui64>::max();
+  //! Odd while resource is unique locked, changed by each write of resource_data
+  std::atomic_uint64_t version = 0;
   std::shared_mutex mtx;
+#endif
 
   bool isExist() noexcept;
   void destroy();
 
   SharedResource(ResourceData resource_data);
+  SharedResource(MappedFile* mapped_file, FileResourceIndex index);
+  SharedResource(CloneSource* clone_source, VarType type);
   ~SharedResource();
 };
 
@@ -65,22 +127,54 @@ class Link {
   SharedResource* resource = nullptr;
 
   friend class binom::Variable;
-  std::shared_mutex& getMutex() {return resource->mtx;}
+#ifndef BINOM_SINGLE_THREAD
+  std::shared_mutex& getMutex() const {return resource->mtx;}
+  std::atomic_uint64_t& getVersion() const {return resource->version;}
+#endif
+  Link(SharedResource* resource) noexcept : resource(resource) {}
+  void materializeClone() const;
+  Link cloneLazy() const;
+  //! Checks that elements of container are referenced only by it, so they can't be changed bypassing it.
+  //! Containers which weren't changed or gave out elements since their last check are skipped,
+  //! so only accessed paths are walked (single-threaded build doesn't count accesses and walks all)
+  static bool isExclusiveSubtree(const ResourceData& resource_data) noexcept;
 
 public:
   Link(ResourceData resource_data) noexcept;
+  //! Lazy link to node of mapped file
+  Link(MappedFile* mapped_file, FileResourceIndex index) noexcept;
   Link(Link&& other) noexcept;
   Link(const Link& other) noexcept;
   ~Link();
 
-  void overwriteWithResourceCopy(ResourceData& resource_data);
+  void overwriteWithResourceCopy(const Link& other);
+  //! Containers are cloned lazily: clone copies implementation of source on first access
   static Link cloneResource(priv::Link resource_link) noexcept;
   ui64 getLinkCount() const noexcept;
+  //! Resource is source or pending clone which shares its implementation with other clones
+  bool isCloneShared() const noexcept;
+
+  //! Materializes lazy resource, throws invalid_data if node of mapped file is corrupted (it stays not materialized)
+  void materialize() const;
 
+  //! Materializes node of mapped file and with unique lock copies implementation for pending clones,
+  //! lock is empty if resource doesn't exist, its node is corrupted or copy failed.
+  //! Change of container invalidates references and iterators to its elements given out before
   OptionalSharedRecursiveLock getLock(MtxLockType lock_type) const noexcept;
+  //! Shared lock of container which gives out links or read-only references and iterators to its elements.
+  //! Elements may be changed through links bypassing container, so such access is treated as unique lock
+  //! by copy-on-write clones: it's counted and pending clones take snapshot of container
+  OptionalSharedRecursiveLock getElementLinkLock() const noexcept;
+  //! Shared lock of container which gives out mutable references or iterators to its elements.
+  //! Unlike links they aren't counted, so container is also marked to be copied right away by later clones
+  //! until its next change
+  OptionalSharedRecursiveLock getElementAccessLock() const noexcept;
+  //! Materializes lazy resource, nullptr if resource doesn't exist or its materialization failed
   ResourceData* operator*() const noexcept;
   ResourceData* operator->() const noexcept;
   VarType getType() const noexcept;
+  //! Consistent copy of resource data read without lock, data of not number resources isn't meant for dereference
+  ResourceData readOptimistic() const noexcept;
 };
 
 }
@@ -0,0 +1,275 @@
+#ifndef SERIALIZATION_HXX
+#define SERIALIZATION_HXX
+
+#include "types.hxx"
+#include "../utils/extended_cxx.hxx"
+#include "../utils/err.hxx"
+
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+/*
+ * BinOM binary format
+ *
+ * Header: | 'B' 'O' 'M' | version : ui8 | flags : ui8 |
+ * Node:   | type : VarType | payload |
+ *
+ * Payloads (all integers are little-endian):
+ *   null         - empty
+ *   number       - value with size of the type bit width
+ *   bit_array    - | bit count : ui64 | bits : ceil(bit count / 8) bytes |
+ *   buffer_array - | element count : ui64 | elements : element count * bit width bytes |
+ *   array, list  - | element count : ui64 | [index] | element nodes |
+ *   map,multimap - | element count : ui64 | [index] | (key node, value node) pairs in key order |
+ *   hash_map     - same as map, unordered elements are sorted by key on write
+ *
+ * Index (only if FormatFlags::indexed is set):
+ *   | body size : ui64 | element offsets : element count * ui64 |
+ *   Offsets are relative to the start of the body (first byte after index),
+ *   so containers can be skipped or randomly accessed without decoding.
+ *
+ * Streams are written without index, so encoder never has to seek back
+ * and memory use is bounded by the chunk size.
+ */
+
+namespace binom {
+
+//! Statistics of streaming serialization/deserialization
+struct StreamStatistics {
+  size_t byte_count = 0;        ///< Bytes written to sink or consumed from source
+  size_t peak_buffer_size = 0;  ///< Maximum bytes held in chunk buffer at once
+  f64 duration = 0;             ///< Seconds
+
+  inline f64 getBytesPerSecond() const noexcept {return duration > 0 ? f64(byte_count) / duration : 0;}
+};
+
+}
+
+namespace binom::priv::serialization {
+
+static_assert(std::endian::native == std::endian::little, "BinOM binary format is little-endian only");
+
+constexpr byte format_magic[3] = {'B', 'O', 'M'};
+constexpr ui8 format_version = 1;
+
+enum class FormatFlags : ui8 {
+  none    = 0x00,
+  indexed = 0x01
+};
+
+struct Header {
+  byte magic[3] = {format_magic[0], format_magic[1], format_magic[2]};
+  ui8 version = format_version;
+  FormatFlags flags = FormatFlags::none;
+};
+static_assert(sizeof(Header) == 5);
+
+constexpr size_t default_stream_chunk_size = 64 * 1024;
+constexpr size_t container_header_size = sizeof(VarType) + sizeof(ui64);
+//! Containers are decoded recursively, so deeper input is rejected as invalid_data instead of overflowing the stack
+constexpr size_t max_nesting_depth = 1024;
+constexpr size_t getContainerIndexSize(size_t element_count) noexcept {return sizeof(ui64) + element_count * sizeof(ui64);}
+
+//! Writes nodes into continuous memory, fills container index by backpatching
+class MemoryWriter {
+  std::vector<byte>& buffer;
+public:
+  static constexpr bool is_indexed = true;
+
+  MemoryWriter(std::vector<byte>& buffer) : buffer(buffer) {}
+
+  inline void reserve(size_t size) {buffer.reserve(buffer.size() + size);}
+  inline size_t getPosition() const noexcept {return buffer.size();}
+
+  inline void write(const void* data, size_t size) {
+    buffer.insert(buffer.end(), reinterpret_cast<const byte*>(data), reinterpret_cast<const byte*>(data) + size);
+  }
+
+  template<typename T>
+  requires std::is_trivially_copyable_v<T>
+  inline void write(T value) {write(&value, sizeof(T));}
+
+  //! Reserves place for data which will be written later by patch()
+  inline size_t allocate(size_t size) {
+    size_t position = buffer.size();
+    buffer.resize(position + size);
+    return position;
+  }
+
+  template<typename T>
+  requires std::is_trivially_copyable_v<T>
+  inline void patch(size_t position, T value) noexcept {std::memcpy(buffer.data() + position, &value, sizeof(T));}
+};
+
+//! Reads nodes from continuous memory
+class MemoryReader {
+  const byte* it;
+  const byte* end;
+public:
+  MemoryReader(const byte* data, size_t size) : it(data), end(data + size) {}
+
+  inline size_t getRemaining() const noexcept {return end - it;}
+  //! Bytes known to be readable, decoders don't allocate further ahead of read data
+  inline size_t getAvailable() const noexcept {return getRemaining();}
+
+  inline const byte* take(size_t size) {
+    if(size > getRemaining()) throw err::Error(err::ErrorType::invalid_data);
+    const byte* data = it;
+    it += size;
+    return data;
+  }
+
+  inline void read(void* to, size_t size) {std::memcpy(to, take(size), size);}
+  inline void skip(size_t size) {take(size);}
+
+  template<typename T>
+  requires std::is_trivially_copyable_v<T>
+  inline T read() {
+    T value;
+    read(&value, sizeof(T));
+    return value;
+  }
+};
+
+//! Writes nodes into chunk buffer and flushes full chunks to Sink
+//! Sink should provide: void write(const byte* data, size_t size)
+template<typename Sink>
+class StreamWriter {
+  Sink& sink;
+  std::unique_ptr<byte[]> buffer;
+  size_t chunk_size;
+  size_t size = 0;
+  StreamStatistics statistics;
+  std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+  void writeToSink(const byte* data, size_t size) {
+    sink.write(data, size);
+    statistics.byte_count += size;
+  }
+
+public:
+  static constexpr bool is_indexed = false;
+
+  StreamWriter(Sink& sink, size_t chunk_size = default_stream_chunk_size)
+    : sink(sink), buffer(new byte[chunk_size ? chunk_size : 1]), chunk_size(chunk_size ? chunk_size : 1) {}
+
+  inline void reserve(size_t) noexcept {}
+
+  void write(const void* data, size_t size) {
+    if(self.size + size > chunk_size) flush();
+    if(size >= chunk_size) return writeToSink(reinterpret_cast<const byte*>(data), size); // Bypass buffer
+    std::memcpy(buffer.get() + self.size, data, size);
+    self.size += size;
+    if(self.size > statistics.peak_buffer_size) statistics.peak_buffer_size = self.size;
+  }
+
+  template<typename T>
+  requires std::is_trivially_copyable_v<T>
+  inline void write(T value) {write(&value, sizeof(T));}
+
+  void flush() {
+    if(!size) return;
+    writeToSink(buffer.get(), size);
+    size = 0;
+  }
+
+  StreamStatistics finish() {
+    flush();
+    statistics.duration = std::chrono::duration<f64>(std::chrono::steady_clock::now() - start_time).count();
+    return statistics;
+  }
+};
+
+//! Pulls nodes from std::istream by chunks
+class StreamReader {
+  std::istream& is;
+  std::unique_ptr<byte[]> buffer;
+  size_t chunk_size;
+  size_t position = 0;
+  size_t size = 0;
+  StreamStatistics statistics;
+  std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+  inline size_t readFromStream(byte* to, size_t size) {
+    is.read(reinterpret_cast<char*>(to), size);
+    return is.gcount();
+  }
+
+  inline size_t getBuffered() const noexcept {return size - position;}
+
+  size_t takeBuffered(byte* to, size_t size) {
+    if(size > getBuffered()) size = getBuffered();
+    if(to) std::memcpy(to, buffer.get() + position, size);
+    position += size;
+    return size;
+  }
+
+  void fill() {
+    position = 0;
+    size = readFromStream(buffer.get(), chunk_size);
+    if(size > statistics.peak_buffer_size) statistics.peak_buffer_size = size;
+  }
+
+public:
+  StreamReader(std::istream& is, size_t chunk_size = default_stream_chunk_size)
+    : is(is), buffer(new byte[chunk_size ? chunk_size : 1]), chunk_size(chunk_size ? chunk_size : 1) {}
+
+  //! Size of stream is unknown, so length fields can't be checked against it and reads are bounded by end of stream only
+  inline size_t getRemaining() const noexcept {return std::numeric_limits<size_t>::max();}
+  //! Data beyond one chunk isn't known to exist, so decoders grow storage by chunk-sized pieces as data arrives
+  inline size_t getAvailable() const noexcept {return chunk_size;}
+
+  //! If to is nullptr data will be skipped
+  void read(void* to, size_t size) {
+    byte* it = reinterpret_cast<byte*>(to);
+    size_t readed = takeBuffered(it, size);
+    statistics.byte_count += readed;
+    size -= readed;
+    if(it) it += readed;
+
+    while(size) {
+      if(size >= chunk_size && it) { // Bypass buffer
+        if(readFromStream(it, size) != size) throw err::Error(err::ErrorType::invalid_data);
+        statistics.byte_count += size;
+        return;
+      }
+      fill();
+      if(!getBuffered()) throw err::Error(err::ErrorType::invalid_data);
+      readed = takeBuffered(it, size);
+      statistics.byte_count += readed;
+      size -= readed;
+      if(it) it += readed;
+    }
+  }
+
+  inline void skip(size_t size) {read(nullptr, size);}
+
+  template<typename T>
+  requires std::is_trivially_copyable_v<T>
+  inline T read() {
+    T value;
+    read(&value, sizeof(T));
+    return value;
+  }
+
+  //! Returns read-ahead bytes back to seekable stream
+  StreamStatistics finish() {
+    if(is.eof()) is.clear();
+    if(getBuffered()) {
+      is.seekg(-std::streamoff(getBuffered()), std::ios::cur);
+      position = size;
+    }
+    statistics.duration = std::chrono::duration<f64>(std::chrono::steady_clock::now() - start_time).count();
+    return statistics;
+  }
+};
+
+}
+
+#endif // SERIALIZATION_HXX
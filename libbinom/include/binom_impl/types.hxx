@@ -76,6 +76,7 @@ enum class VarType : ui8 {
   map                     = 0x1A, ///< Associative heterogeneous container with key-sorted
   multimap                = 0x1B, ///< Associative heterogeneous container with key-sorted
   table                   = 0x1C, ///< Multiple key-sorted associative heterogeneous container
+  hash_map                = 0x1D, ///< Associative heterogeneous container with hash-indexed unique keys
 
 // Compile-time defined C-like data types
 
@@ -199,6 +200,7 @@ enum class VarTypeClass : ui8 {
   map                     = 0x07,
   multimap                = 0x08,
   table                   = 0x09,
+  hash_map                = 0x0A,
 
   invalid_type            = int(VarType::invalid_type)
 };
@@ -337,6 +339,8 @@ constexpr inline VarTypeClass toTypeClass(VarType type) noexcept {
 
   case VarType::table: return VarTypeClass::table;
 
+  case VarType::hash_map: return VarTypeClass::hash_map;
+
   case VarType::separator:
   case VarType::invalid_type:
   default:
@@ -681,6 +685,7 @@ class Link;
 class SharedResource;
 class ResourceData;
 class FileResourceIndex;
+class MappedFile;
 
 class BitArrayImplementation;
 class BufferArrayImplementation;
@@ -688,9 +693,27 @@ class ArrayImplementation;
 class ListImplementation;
 class MapImplementation;
 class MultiMapImplementation;
+class HashMapImplementation;
 class TableImplementation;
 class KeyValueImplementation;
 
+/**
+ * @brief Buffer array in data word of its owner: pointer to heap block or short byte buffer in place
+ *
+ * Header of inline buffer holds its size and tag bit, which is clear in aligned pointer to heap block
+ * (little-endian only). Storage is handled only by BufferArrayImplementation.
+ */
+union BufferArrayStorage {
+  struct InlineBuffer {
+    ui8 header;
+    byte data[sizeof(void*) - 1];
+  };
+
+  BufferArrayImplementation* implementation;
+  InlineBuffer inline_buffer;
+};
+static_assert(sizeof(BufferArrayStorage) == sizeof(void*));
+
 }
 
 class Variable;
@@ -702,9 +725,23 @@ class Array;
 class List;
 class Map;
 class MultiMap;
+class HashMap;
 class Table;
 class KeyValue;
 
+class View;
+class ViewBufferArray;
+class ViewArray;
+class ViewMap;
+
+class FileStorage;
+class FileVariable;
+class FileBufferArray;
+class FileArray;
+class FileMap;
+
+class MappedStorage;
+
 class NamedVariable;
 class MapNodeRef;
 
@@ -715,6 +752,7 @@ struct ArrayLiteral             : public heritable_initializer_list::HeritableIn
 struct ListLiteral              : public heritable_initializer_list::HeritableInitializerList<const Variable>      {using HeritableInitializerList::HeritableInitializerList;};
 struct MapLiteral               : public heritable_initializer_list::HeritableInitializerList<const NamedVariable> {using HeritableInitializerList::HeritableInitializerList;};
 struct MultiMapLiteral          : public heritable_initializer_list::HeritableInitializerList<const NamedVariable> {using HeritableInitializerList::HeritableInitializerList;};
+struct HashMapLiteral           : public heritable_initializer_list::HeritableInitializerList<const NamedVariable> {using HeritableInitializerList::HeritableInitializerList;};
 struct ColumnDescriptor;
 struct TableDescriptor;
 struct TableLiteral;
@@ -736,6 +774,7 @@ typedef priv::ArrayLiteral                      arr;
 typedef priv::ListLiteral                       list;
 typedef priv::MapLiteral                        map;
 typedef priv::MultiMapLiteral                   multimap;
+typedef priv::HashMapLiteral                    hashmap;
 typedef priv::TableLiteral                      table;
 
 }
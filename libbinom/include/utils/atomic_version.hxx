@@ -0,0 +1,58 @@
+#ifndef ATOMIC_VERSION_HXX
+#define ATOMIC_VERSION_HXX
+
+#include "type_aliases.hxx"
+#include "epoch_reclamation.hxx"
+
+#include <atomic>
+#include <utility>
+
+namespace atomic_version {
+
+/**
+ * @brief AtomicVersion - holder of current version of immutable value
+ *
+ * Writer publishes new version by store() or update(), readers take copy of current
+ * version by load() and keep reading it without locks while newer versions are published.
+ * Replaced versions are deleted by epoch reclamation when no load() can access them.
+ * Value type is expected to be cheap to copy (persistent containers share their nodes).
+ */
+template<typename T>
+class AtomicVersion {
+  std::atomic<T*> current;
+
+public:
+  AtomicVersion(T version = T()) : current(new T(std::move(version))) {}
+  AtomicVersion(const AtomicVersion&) = delete;
+  AtomicVersion(AtomicVersion&&) = delete;
+  ~AtomicVersion() {delete current.load(std::memory_order_acquire);}
+
+  T load() const {
+    epoch_reclamation::Guard guard;
+    return *current.load(std::memory_order_acquire);
+  }
+
+  void store(T version) {
+    T* old_version = current.exchange(new T(std::move(version)), std::memory_order_acq_rel);
+    epoch_reclamation::retire(old_version);
+  }
+
+  //! Publishes change(current version), change is repeated if other writer published version meanwhile
+  template<typename F>
+  T update(F change) {
+    epoch_reclamation::Guard guard;
+    T* expected = current.load(std::memory_order_acquire);
+    forever {
+      T* desired = new T(change(std::as_const(*expected)));
+      if(current.compare_exchange_weak(expected, desired, std::memory_order_acq_rel, std::memory_order_acquire)) {
+        epoch_reclamation::retire(expected);
+        return *desired;
+      }
+      delete desired;
+    }
+  }
+};
+
+}
+
+#endif // ATOMIC_VERSION_HXX
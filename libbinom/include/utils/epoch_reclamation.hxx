@@ -0,0 +1,209 @@
+#ifndef EPOCH_RECLAMATION_HXX
+#define EPOCH_RECLAMATION_HXX
+
+#include "type_aliases.hxx"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+namespace epoch_reclamation {
+using namespace type_alias;
+
+/**
+ * Epoch-based reclamation of objects shared between threads
+ *
+ * Thread which may access shared object without owning it is pinned (pin()/unpin() or Guard).
+ * Object retired by its last owner is stamped with global epoch and deleted only when
+ * no thread stays pinned since that epoch, so pinned threads never touch freed memory.
+ * Pinning is one atomic exchange on thread record, retiring is push to thread-local list.
+ */
+
+struct Retired {
+  ui64 epoch;
+  void* pointer;
+  void (*deleter)(void*);
+};
+
+struct ThreadRecord {
+  std::atomic_uint64_t epoch = 0; ///< Epoch of pin or 0 if thread isn't pinned
+  std::atomic_bool is_used = false;
+  ThreadRecord* next = nullptr;
+};
+
+constexpr size_t collect_threshold = 64;
+
+inline std::atomic<ThreadRecord*> thread_records = nullptr; // Records are never freed, only reused
+inline std::atomic_uint64_t global_epoch = 1;
+
+//! Objects left by exited threads
+struct Orphans {
+  std::mutex mtx;
+  std::vector<Retired> objects;
+
+  //! Never destroyed: objects may be retired by destructors of static variables
+  static Orphans& get() {static Orphans* orphans = new Orphans(); return *orphans;}
+};
+
+inline ui64 getMinPinnedEpoch() noexcept {
+  ui64 min_epoch = std::numeric_limits<ui64>::max();
+  for(ThreadRecord* record = thread_records.load(std::memory_order_acquire); record; record = record->next)
+    if(const ui64 epoch = record->epoch.load(std::memory_order_seq_cst); epoch && epoch < min_epoch) min_epoch = epoch;
+  return min_epoch;
+}
+
+//! Deletes objects retired before min_epoch, objects retired by deleters are added to list
+inline size_t deleteRetired(std::vector<Retired>& list, ui64 min_epoch) {
+  auto first_freeable = std::partition(list.begin(), list.end(), [min_epoch](const Retired& object) {return object.epoch >= min_epoch;});
+  if(first_freeable == list.end()) return 0;
+  std::vector<Retired> freeable(first_freeable, list.end());
+  list.erase(first_freeable, list.end());
+  for(const Retired& object : freeable) object.deleter(object.pointer);
+  return freeable.size();
+}
+
+// Trivial thread-local variables don't need initialization guard on access
+inline thread_local ThreadRecord* thread_record = nullptr;
+inline thread_local size_t pin_count = 0;
+
+class ThreadState {
+  bool is_collecting = false;
+  std::vector<Retired> retired;
+  //! Pinned thread can't delete objects retired by itself, so threshold grows with list and collection stays amortized O(1)
+  size_t collect_size = collect_threshold;
+
+public:
+  static inline thread_local bool is_destroyed = false;
+
+  //! Takes free record or creates new one, record is released by destructor
+  void acquireRecord() {
+    for(ThreadRecord* it = thread_records.load(std::memory_order_acquire); it; it = it->next) {
+      bool is_used = false;
+      if(it->is_used.compare_exchange_strong(is_used, true)) {
+        thread_record = it;
+        return;
+      }
+    }
+    ThreadRecord* record = new ThreadRecord();
+    record->is_used = true;
+    record->next = thread_records.load(std::memory_order_relaxed);
+    while(!thread_records.compare_exchange_weak(record->next, record, std::memory_order_release, std::memory_order_relaxed));
+    thread_record = record;
+  }
+
+  ThreadState() = default;
+  ThreadState(const ThreadState&) = delete;
+  ThreadState(ThreadState&&) = delete;
+
+  ~ThreadState() {
+    collect();
+    if(!retired.empty()) {
+      Orphans& orphans = Orphans::get();
+      std::lock_guard lk(orphans.mtx);
+      orphans.objects.insert(orphans.objects.end(), retired.begin(), retired.end());
+    }
+    if(thread_record) {
+      thread_record->epoch.store(0, std::memory_order_release);
+      thread_record->is_used.store(false, std::memory_order_release);
+      thread_record = nullptr;
+    }
+    is_destroyed = true;
+  }
+
+  void retire(void* pointer, void (*deleter)(void*)) {
+    // Threads pinned later can't reach retired object, so it's deleted right away when no thread is pinned
+    if(!is_collecting && getMinPinnedEpoch() == std::numeric_limits<ui64>::max()) {
+      const size_t retired_count = retired.size();
+      // Members retired by deleter are queued and deleted by collect, so nested objects don't recurse
+      is_collecting = true;
+      deleter(pointer);
+      is_collecting = false;
+      if(retired.size() > retired_count) collect();
+      return;
+    }
+    retired.push_back(Retired{global_epoch.load(std::memory_order_seq_cst), pointer, deleter});
+    if(retired.size() >= collect_size && !is_collecting) {
+      collect();
+      collect_size = std::max(collect_threshold, retired.size() * 2);
+    }
+  }
+
+  //! Returns count of deleted objects
+  size_t collect() {
+    if(is_collecting) return 0;
+    is_collecting = true;
+    size_t deleted_count = 0;
+    // Deleted objects retire their members, following passes delete them until nothing more can be deleted
+    while(const size_t pass_deleted_count = collectPass()) deleted_count += pass_deleted_count;
+    is_collecting = false;
+    return deleted_count;
+  }
+
+  inline size_t getRetiredCount() const noexcept {return retired.size();}
+
+private:
+  size_t collectPass() {
+    global_epoch.fetch_add(1, std::memory_order_seq_cst);
+    const ui64 min_epoch = getMinPinnedEpoch();
+    size_t deleted_count = deleteRetired(retired, min_epoch);
+
+    Orphans& orphans = Orphans::get();
+    std::vector<Retired> orphan_objects;
+    if(std::unique_lock lk(orphans.mtx, std::try_to_lock); lk) orphan_objects.swap(orphans.objects);
+    if(!orphan_objects.empty()) {
+      deleted_count += deleteRetired(orphan_objects, min_epoch);
+      retired.insert(retired.end(), orphan_objects.begin(), orphan_objects.end());
+    }
+    return deleted_count;
+  }
+};
+
+inline thread_local ThreadState thread_state;
+
+inline void pin() {
+  if(pin_count++) return;
+  if(!thread_record) {
+    if(ThreadState::is_destroyed) return; // Exiting thread can't be pinned, retire() checks all records itself
+    thread_state.acquireRecord();
+  }
+  // Exchange orders pin before following reads of shared objects
+  thread_record->epoch.exchange(global_epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+}
+
+inline void unpin() noexcept {
+  if(!--pin_count && thread_record) thread_record->epoch.store(0, std::memory_order_release);
+}
+
+//! Deletes object by deleter when no thread can access it
+inline void retire(void* pointer, void (*deleter)(void*)) {
+  if(!ThreadState::is_destroyed) return thread_state.retire(pointer, deleter);
+  // Thread is exiting (destructors of static and thread-local variables)
+  if(getMinPinnedEpoch() == std::numeric_limits<ui64>::max()) return deleter(pointer);
+  Orphans& orphans = Orphans::get();
+  std::lock_guard lk(orphans.mtx);
+  orphans.objects.push_back(Retired{global_epoch.load(std::memory_order_seq_cst), pointer, deleter});
+}
+
+template<typename T>
+inline void retire(T* pointer) {retire(pointer, [](void* pointer) {delete static_cast<T*>(pointer);});}
+
+//! Deletes retired objects of this thread which can't be accessed anymore
+inline size_t collect() {return ThreadState::is_destroyed ? 0 : thread_state.collect();}
+
+//! Count of objects retired by this thread and not deleted yet
+inline size_t getRetiredCount() noexcept {return ThreadState::is_destroyed ? 0 : thread_state.getRetiredCount();}
+
+//! RAII pin of current thread
+class Guard {
+public:
+  Guard() {pin();}
+  Guard(const Guard&) = delete;
+  Guard(Guard&&) = delete;
+  ~Guard() {unpin();}
+};
+
+}
+
+#endif // EPOCH_RECLAMATION_HXX
@@ -15,6 +15,8 @@ enum class ErrorType : ui8 {
   any,
   out_of_range,
   file_open_error,
+  file_read_error,
+  file_write_error,
   invalid_data,
   null_ponter_dereference,
 
@@ -48,6 +50,8 @@ inline const char* Error::what() const noexcept {
   case ErrorType::no_error: return                  "";
   case ErrorType::out_of_range: return              "Out of range";
   case ErrorType::file_open_error: return           "File open error";
+  case ErrorType::file_read_error: return           "File read error";
+  case ErrorType::file_write_error: return          "File write error";
   case ErrorType::invalid_data: return              "Invalid data";
   case ErrorType::null_ponter_dereference: return   "Trying to dereference null-pointer";
 
@@ -38,6 +38,15 @@ union ArithmeticData {
 /// Enable operators where required copy constructor
 class EnableCopyableArithmetic {};
 
+/// Default writer of changing operators, data is changed in place
+class ArithmeticDataWriter {
+  ArithmeticData& data;
+public:
+  ArithmeticDataWriter(ArithmeticData& data) noexcept : data(data) {}
+  ArithmeticDataWriter(const ArithmeticDataWriter&) = delete;
+  ArithmeticData& get() noexcept {return data;}
+};
+
 //////////////////////
 
 /// Overloading of all arithmetic operators, and adding some util methods
@@ -49,6 +58,12 @@ class ArithmeticTypeBase {
 
   inline ArithmeticData& getArithmeticData() {return downcast().getArithmeticDataImpl();}
   inline const ArithmeticData& getArithmeticData() const {return downcast().getArithmeticDataImpl();}
+  //! Writer of driven type is used if it has getArithmeticDataWriterImpl(), e.g. to change copy of data and store it at once
+  inline auto getArithmeticDataWriter() noexcept {
+    if constexpr (requires(ArithmeticTypeDriven& driven) {driven.getArithmeticDataWriterImpl();})
+      return downcast().getArithmeticDataWriterImpl();
+    else return ArithmeticDataWriter(getArithmeticData());
+  }
 
 public:
 
@@ -98,6 +113,9 @@ public:
   requires std::is_arithmetic_v<T> || is_crtp_base_of_v<ArithmeticTypeBase, T>
   operator T() const noexcept {
     if constexpr (std::is_arithmetic_v<T>) {
+      // Driven type may provide copy of value read without lock
+      if constexpr (requires {downcast().getValueImpl();})
+        return static_cast<T>(downcast().getValueImpl());
       auto lk = downcast().getLock(MtxLockType::shared_locked);
       if(!downcast().checkLock(lk)) return false;
       switch (getValType()) {
@@ -147,7 +165,7 @@ public:
         switch (value.getNumberType()) {
         case VarNumberType::unsigned_integer: return ui64(self) == ui64(value);
         case VarNumberType::signed_integer: return i64(value) >= 0 ? ui64(self) == ui64(value) : false;
-        case VarNumberType::float_point: return f64(value) >= 0 ? ui64(self) == f64(value) : false;
+        case VarNumberType::float_point: return f64(self) == f64(value);
         default:
         case VarNumberType::invalid_type: return false;
         }
@@ -155,14 +173,14 @@ public:
         switch (value.getNumberType()) {
         case VarNumberType::unsigned_integer: return i64(self) >= 0 ? ui64(self) == ui64(value) : false;
         case VarNumberType::signed_integer: return i64(self) == i64(value);
-        case VarNumberType::float_point: return i64(self) == f64(value);
+        case VarNumberType::float_point: return f64(self) == f64(value);
         default:
         case VarNumberType::invalid_type: return false;
         }
       case VarNumberType::float_point:
         switch (value.getNumberType()) {
-        case VarNumberType::unsigned_integer: return f64(self) >= 0 ? ui64(self) == f64(value) : false;
-        case VarNumberType::signed_integer: return f64(self) == ui64(value);
+        case VarNumberType::unsigned_integer: return f64(self) == f64(value);
+        case VarNumberType::signed_integer: return f64(self) == f64(value);
         case VarNumberType::float_point: return f64(self) == f64(value);
         default:
         case VarNumberType::invalid_type: return false;
@@ -176,17 +194,17 @@ public:
       switch (getNumberType()) {
       case VarNumberType::unsigned_integer: return ui64(self) == value;
       case VarNumberType::signed_integer: return i64(self) >= 0 ? ui64(self) == value : false;
-      case VarNumberType::float_point: return f64(self) >= 0 ? f64(self) > value : false;
+      case VarNumberType::float_point: return f64(self) == value;
       case VarNumberType::invalid_type: default: return false;
       }
     } else if constexpr (is_signed_without_cvref_v<T>) {
       auto lk = downcast().getLock(MtxLockType::shared_locked);
       if(!downcast().checkLock(lk)) return false;
       switch (getNumberType()) {
-      case VarNumberType::unsigned_integer: return value >= 0 ? ui64(self) == value : false;
+      case VarNumberType::unsigned_integer: return value >= 0 ? ui64(self) == ui64(value) : false;
       case VarNumberType::signed_integer: return i64(self) == value;
       case VarNumberType::float_point: return f64(self) == value;
-      case VarNumberType::invalid_type: return false;
+      case VarNumberType::invalid_type: default: return false;
       }
     }
   }
@@ -204,8 +222,8 @@ public:
       case VarNumberType::unsigned_integer:
         switch (value.getNumberType()) {
         case VarNumberType::unsigned_integer: return ui64(self) > ui64(value);
-        case VarNumberType::signed_integer: return i64(value) >= 0 ? ui64(self) > ui64(value) : false;
-        case VarNumberType::float_point: return f64(value) >= 0 ? ui64(self) > f64(value) : false;
+        case VarNumberType::signed_integer: return i64(value) >= 0 ? ui64(self) > ui64(value) : true;
+        case VarNumberType::float_point: return f64(self) > f64(value);
         default:
         case VarNumberType::invalid_type: return false;
         }
@@ -213,14 +231,14 @@ public:
         switch (value.getNumberType()) {
         case VarNumberType::unsigned_integer: return i64(self) >= 0 ? ui64(self) > ui64(value) : false;
         case VarNumberType::signed_integer: return i64(self) > i64(value);
-        case VarNumberType::float_point: return i64(self) > f64(value);
+        case VarNumberType::float_point: return f64(self) > f64(value);
         default:
         case VarNumberType::invalid_type: return false;
         }
       case VarNumberType::float_point:
         switch (value.getNumberType()) {
-        case VarNumberType::unsigned_integer: return f64(self) >= 0 ? ui64(self) > f64(value) : false;
-        case VarNumberType::signed_integer: return f64(self) > ui64(value);
+        case VarNumberType::unsigned_integer: return f64(self) > f64(value);
+        case VarNumberType::signed_integer: return f64(self) > f64(value);
         case VarNumberType::float_point: return f64(self) > f64(value);
         default:
         case VarNumberType::invalid_type: return false;
@@ -241,8 +259,8 @@ public:
       auto lk = downcast().getLock(MtxLockType::shared_locked);
       if(!downcast().checkLock(lk)) return false;
       switch (getNumberType()) {
-      case VarNumberType::unsigned_integer: return value >= 0 ? ui64(self) > value : false;
-      case VarNumberType::signed_integer: return ui64(self) > value;
+      case VarNumberType::unsigned_integer: return value >= 0 ? ui64(self) > ui64(value) : true;
+      case VarNumberType::signed_integer: return i64(self) > value;
       case VarNumberType::float_point: return f64(self) > value;
       case VarNumberType::invalid_type:default: return false;
       }
@@ -259,8 +277,8 @@ public:
       case VarNumberType::unsigned_integer:
         switch (value.getNumberType()) {
         case VarNumberType::unsigned_integer: return ui64(self) >= ui64(value);
-        case VarNumberType::signed_integer: return i64(value) >= 0 ? ui64(self) >= ui64(value) : false;
-        case VarNumberType::float_point: return f64(value) >= 0 ? ui64(self) >= f64(value) : false;
+        case VarNumberType::signed_integer: return i64(value) >= 0 ? ui64(self) >= ui64(value) : true;
+        case VarNumberType::float_point: return f64(self) >= f64(value);
         default:
         case VarNumberType::invalid_type: return false;
         }
@@ -268,14 +286,14 @@ public:
         switch (value.getNumberType()) {
         case VarNumberType::unsigned_integer: return i64(self) >= 0 ? ui64(self) >= ui64(value) : false;
         case VarNumberType::signed_integer: return i64(self) >= i64(value);
-        case VarNumberType::float_point: return i64(self) >= f64(value);
+        case VarNumberType::float_point: return f64(self) >= f64(value);
         default:
         case VarNumberType::invalid_type: return false;
         }
       case VarNumberType::float_point:
         switch (value.getNumberType()) {
-        case VarNumberType::unsigned_integer: return f64(self) >= 0 ? ui64(self) >= f64(value) : false;
-        case VarNumberType::signed_integer: return f64(self) >= ui64(value);
+        case VarNumberType::unsigned_integer: return f64(self) >= f64(value);
+        case VarNumberType::signed_integer: return f64(self) >= f64(value);
         case VarNumberType::float_point: return f64(self) >= f64(value);
         default:
         case VarNumberType::invalid_type: return false;
@@ -296,8 +314,8 @@ public:
       auto lk = downcast().getLock(MtxLockType::shared_locked);
       if(!downcast().checkLock(lk)) return false;
       switch (getNumberType()) {
-      case VarNumberType::unsigned_integer: return value >= 0 ? ui64(self) >= value : false;
-      case VarNumberType::signed_integer: return ui64(self) >= value;
+      case VarNumberType::unsigned_integer: return value >= 0 ? ui64(self) >= ui64(value) : true;
+      case VarNumberType::signed_integer: return i64(self) >= value;
       case VarNumberType::float_point: return f64(self) >= value;
       case VarNumberType::invalid_type:default: return false;
       }
@@ -331,41 +349,42 @@ public:
       case ValType::invalid_type:default: return downcast();
        }
     } else if constexpr(is_arithmetic_without_cvref_v<T>) {
-      auto lk = downcast().getLock(MtxLockType::shared_locked);
+      auto lk = downcast().getLock(MtxLockType::unique_locked);
       if(!downcast().checkLock(lk)) return downcast();
+      auto writer = getArithmeticDataWriter();
       switch (getValType()) {
       case ValType::boolean:
-        getArithmeticData().bool_val = static_cast<bool>(value);
+        writer.get().bool_val = static_cast<bool>(value);
       break;
       case ValType::ui8:
-        getArithmeticData().ui8_val = static_cast<ui8>(value);
+        writer.get().ui8_val = static_cast<ui8>(value);
       break;
       case ValType::si8:
-        getArithmeticData().i8_val = static_cast<i8>(value);
+        writer.get().i8_val = static_cast<i8>(value);
       break;
       case ValType::ui16:
-        getArithmeticData().ui16_val = static_cast<ui16>(value);
+        writer.get().ui16_val = static_cast<ui16>(value);
       break;
       case ValType::si16:
-        getArithmeticData().i16_val = static_cast<i16>(value);
+        writer.get().i16_val = static_cast<i16>(value);
       break;
       case ValType::ui32:
-        getArithmeticData().ui32_val = static_cast<ui32>(value);
+        writer.get().ui32_val = static_cast<ui32>(value);
       break;
       case ValType::si32:
-        getArithmeticData().i32_val = static_cast<i32>(value);
+        writer.get().i32_val = static_cast<i32>(value);
       break;
       case ValType::f32:
-        getArithmeticData().f32_val = static_cast<f32>(value);
+        writer.get().f32_val = static_cast<f32>(value);
       break;
       case ValType::ui64:
-        getArithmeticData().ui64_val = static_cast<ui64>(value);
+        writer.get().ui64_val = static_cast<ui64>(value);
       break;
       case ValType::si64:
-        getArithmeticData().i64_val = static_cast<i64>(value);
+        writer.get().i64_val = static_cast<i64>(value);
       break;
       case ValType::f64:
-        getArithmeticData().f64_val = static_cast<f64>(value);
+        writer.get().f64_val = static_cast<f64>(value);
       break;
       case ValType::invalid_type:default:
       break;
@@ -397,18 +416,19 @@ public:
     } else if constexpr(is_arithmetic_without_cvref_v<T>) {
       auto lk = downcast().getLock(MtxLockType::unique_locked);
       if(!downcast().checkLock(lk)) return downcast();
+      auto writer = getArithmeticDataWriter();
       switch (getValType()) {
-      case ValType::boolean: getArithmeticData().bool_val += value; break;
-      case ValType::ui8:     getArithmeticData().ui8_val += value; break;
-      case ValType::si8:     getArithmeticData().i8_val += value; break;
-      case ValType::ui16:    getArithmeticData().ui16_val += value; break;
-      case ValType::si16:    getArithmeticData().i16_val += value; break;
-      case ValType::ui32:    getArithmeticData().ui32_val += value; break;
-      case ValType::si32:    getArithmeticData().i32_val += value; break;
-      case ValType::f32:     getArithmeticData().f32_val += value; break;
-      case ValType::ui64:    getArithmeticData().ui64_val += value; break;
-      case ValType::si64:    getArithmeticData().i64_val += value; break;
-      case ValType::f64:     getArithmeticData().f64_val += value; break;
+      case ValType::boolean: writer.get().bool_val += value; break;
+      case ValType::ui8:     writer.get().ui8_val += value; break;
+      case ValType::si8:     writer.get().i8_val += value; break;
+      case ValType::ui16:    writer.get().ui16_val += value; break;
+      case ValType::si16:    writer.get().i16_val += value; break;
+      case ValType::ui32:    writer.get().ui32_val += value; break;
+      case ValType::si32:    writer.get().i32_val += value; break;
+      case ValType::f32:     writer.get().f32_val += value; break;
+      case ValType::ui64:    writer.get().ui64_val += value; break;
+      case ValType::si64:    writer.get().i64_val += value; break;
+      case ValType::f64:     writer.get().f64_val += value; break;
       case ValType::invalid_type:default: break;
       }
       return downcast();
@@ -438,18 +458,19 @@ public:
     } else if constexpr(is_arithmetic_without_cvref_v<T>) {
       auto lk = downcast().getLock(MtxLockType::unique_locked);
       if(!downcast().checkLock(lk)) return downcast();
+      auto writer = getArithmeticDataWriter();
       switch (getValType()) {
-      case ValType::boolean: getArithmeticData().bool_val -= value; break;
-      case ValType::ui8:     getArithmeticData().ui8_val -= value; break;
-      case ValType::si8:     getArithmeticData().i8_val -= value; break;
-      case ValType::ui16:    getArithmeticData().ui16_val -= value; break;
-      case ValType::si16:    getArithmeticData().i16_val -= value; break;
-      case ValType::ui32:    getArithmeticData().ui32_val -= value; break;
-      case ValType::si32:    getArithmeticData().i32_val -= value; break;
-      case ValType::f32:     getArithmeticData().f32_val -= value; break;
-      case ValType::ui64:    getArithmeticData().ui64_val -= value; break;
-      case ValType::si64:    getArithmeticData().i64_val -= value; break;
-      case ValType::f64:     getArithmeticData().f64_val -= value; break;
+      case ValType::boolean: writer.get().bool_val -= value; break;
+      case ValType::ui8:     writer.get().ui8_val -= value; break;
+      case ValType::si8:     writer.get().i8_val -= value; break;
+      case ValType::ui16:    writer.get().ui16_val -= value; break;
+      case ValType::si16:    writer.get().i16_val -= value; break;
+      case ValType::ui32:    writer.get().ui32_val -= value; break;
+      case ValType::si32:    writer.get().i32_val -= value; break;
+      case ValType::f32:     writer.get().f32_val -= value; break;
+      case ValType::ui64:    writer.get().ui64_val -= value; break;
+      case ValType::si64:    writer.get().i64_val -= value; break;
+      case ValType::f64:     writer.get().f64_val -= value; break;
       case ValType::invalid_type:default: break;
       }
       return downcast();
@@ -479,18 +500,19 @@ public:
     } else if constexpr(is_arithmetic_without_cvref_v<T>) {
       auto lk = downcast().getLock(MtxLockType::unique_locked);
       if(!downcast().checkLock(lk)) return downcast();
+      auto writer = getArithmeticDataWriter();
       switch (getValType()) {
-      case ValType::boolean: getArithmeticData().bool_val = getArithmeticData().bool_val && value; break;
-      case ValType::ui8:     getArithmeticData().ui8_val *= value; break;
-      case ValType::si8:     getArithmeticData().i8_val *= value; break;
-      case ValType::ui16:    getArithmeticData().ui16_val *= value; break;
-      case ValType::si16:    getArithmeticData().i16_val *= value; break;
-      case ValType::ui32:    getArithmeticData().ui32_val *= value; break;
-      case ValType::si32:    getArithmeticData().i32_val *= value; break;
-      case ValType::f32:     getArithmeticData().f32_val *= value; break;
-      case ValType::ui64:    getArithmeticData().ui64_val *= value; break;
-      case ValType::si64:    getArithmeticData().i64_val *= value; break;
-      case ValType::f64:     getArithmeticData().f64_val *= value; break;
+      case ValType::boolean: writer.get().bool_val = writer.get().bool_val && value; break;
+      case ValType::ui8:     writer.get().ui8_val *= value; break;
+      case ValType::si8:     writer.get().i8_val *= value; break;
+      case ValType::ui16:    writer.get().ui16_val *= value; break;
+      case ValType::si16:    writer.get().i16_val *= value; break;
+      case ValType::ui32:    writer.get().ui32_val *= value; break;
+      case ValType::si32:    writer.get().i32_val *= value; break;
+      case ValType::f32:     writer.get().f32_val *= value; break;
+      case ValType::ui64:    writer.get().ui64_val *= value; break;
+      case ValType::si64:    writer.get().i64_val *= value; break;
+      case ValType::f64:     writer.get().f64_val *= value; break;
       case ValType::invalid_type:default: break;
       }
       return downcast();
@@ -521,18 +543,19 @@ public:
       auto lk = downcast().getLock(MtxLockType::unique_locked);
       if(!downcast().checkLock(lk)) return downcast();
       if(!value) return downcast();
+      auto writer = getArithmeticDataWriter();
       switch (getValType()) {
-      case ValType::boolean: getArithmeticData().bool_val /= value; break;
-      case ValType::ui8:     getArithmeticData().ui8_val /= value; break;
-      case ValType::si8:     getArithmeticData().i8_val /= value; break;
-      case ValType::ui16:    getArithmeticData().ui16_val /= value; break;
-      case ValType::si16:    getArithmeticData().i16_val /= value; break;
-      case ValType::ui32:    getArithmeticData().ui32_val /= value; break;
-      case ValType::si32:    getArithmeticData().i32_val /= value; break;
-      case ValType::f32:     getArithmeticData().f32_val /= value; break;
-      case ValType::ui64:    getArithmeticData().ui64_val /= value; break;
-      case ValType::si64:    getArithmeticData().i64_val /= value; break;
-      case ValType::f64:     getArithmeticData().f64_val /= value; break;
+      case ValType::boolean: writer.get().bool_val /= value; break;
+      case ValType::ui8:     writer.get().ui8_val /= value; break;
+      case ValType::si8:     writer.get().i8_val /= value; break;
+      case ValType::ui16:    writer.get().ui16_val /= value; break;
+      case ValType::si16:    writer.get().i16_val /= value; break;
+      case ValType::ui32:    writer.get().ui32_val /= value; break;
+      case ValType::si32:    writer.get().i32_val /= value; break;
+      case ValType::f32:     writer.get().f32_val /= value; break;
+      case ValType::ui64:    writer.get().ui64_val /= value; break;
+      case ValType::si64:    writer.get().i64_val /= value; break;
+      case ValType::f64:     writer.get().f64_val /= value; break;
       case ValType::invalid_type:default: break;
       }
       return downcast();
@@ -563,18 +586,19 @@ public:
       auto lk = downcast().getLock(MtxLockType::unique_locked);
       if(!downcast().checkLock(lk)) return downcast();
       if(!value) return downcast();
+      auto writer = getArithmeticDataWriter();
       switch (getValType()) {
-      case ValType::boolean: getArithmeticData().bool_val %= value; break;
-      case ValType::ui8:     getArithmeticData().ui8_val %= value; break;
-      case ValType::si8:     getArithmeticData().i8_val %= value; break;
-      case ValType::ui16:    getArithmeticData().ui16_val %= value; break;
-      case ValType::si16:    getArithmeticData().i16_val %= value; break;
-      case ValType::ui32:    getArithmeticData().ui32_val %= value; break;
-      case ValType::si32:    getArithmeticData().i32_val %= value; break;
-      case ValType::f32:     getArithmeticData().f32_val = i64(std::round(getArithmeticData().f32_val)) % value; break;
-      case ValType::ui64:    getArithmeticData().ui64_val %= value; break;
-      case ValType::si64:    getArithmeticData().i64_val %= value; break;
-      case ValType::f64:     getArithmeticData().f64_val = i64(std::round(getArithmeticData().f64_val)) % value; break;
+      case ValType::boolean: writer.get().bool_val %= value; break;
+      case ValType::ui8:     writer.get().ui8_val %= value; break;
+      case ValType::si8:     writer.get().i8_val %= value; break;
+      case ValType::ui16:    writer.get().ui16_val %= value; break;
+      case ValType::si16:    writer.get().i16_val %= value; break;
+      case ValType::ui32:    writer.get().ui32_val %= value; break;
+      case ValType::si32:    writer.get().i32_val %= value; break;
+      case ValType::f32:     writer.get().f32_val = i64(std::round(writer.get().f32_val)) % value; break;
+      case ValType::ui64:    writer.get().ui64_val %= value; break;
+      case ValType::si64:    writer.get().i64_val %= value; break;
+      case ValType::f64:     writer.get().f64_val = i64(std::round(writer.get().f64_val)) % value; break;
       case ValType::invalid_type:default: break;
       }
       return downcast();
@@ -582,18 +606,19 @@ public:
       auto lk = downcast().getLock(MtxLockType::unique_locked);
       if(!downcast().checkLock(lk)) return downcast();
       if(!value) return downcast();
+      auto writer = getArithmeticDataWriter();
       switch (getValType()) {
-      case ValType::boolean: getArithmeticData().bool_val %= i64(std::round(value)); break;
-      case ValType::ui8:     getArithmeticData().ui8_val %= i64(std::round(value)); break;
-      case ValType::si8:     getArithmeticData().i8_val %= i64(std::round(value)); break;
-      case ValType::ui16:    getArithmeticData().ui16_val %= i64(std::round(value)); break;
-      case ValType::si16:    getArithmeticData().i16_val %= i64(std::round(value)); break;
-      case ValType::ui32:    getArithmeticData().ui32_val %= i64(std::round(value)); break;
-      case ValType::si32:    getArithmeticData().i32_val %= i64(std::round(value)); break;
-      case ValType::f32:     getArithmeticData().f32_val = i64(std::round(getArithmeticData().f32_val)) % i64(std::round(value)); break;
-      case ValType::ui64:    getArithmeticData().ui64_val %= i64(std::round(value)); break;
-      case ValType::si64:    getArithmeticData().i64_val %= i64(std::round(value)); break;
-      case ValType::f64:     getArithmeticData().f64_val = i64(std::round(getArithmeticData().f64_val)) % i64(std::round(value)); break;
+      case ValType::boolean: writer.get().bool_val %= i64(std::round(value)); break;
+      case ValType::ui8:     writer.get().ui8_val %= i64(std::round(value)); break;
+      case ValType::si8:     writer.get().i8_val %= i64(std::round(value)); break;
+      case ValType::ui16:    writer.get().ui16_val %= i64(std::round(value)); break;
+      case ValType::si16:    writer.get().i16_val %= i64(std::round(value)); break;
+      case ValType::ui32:    writer.get().ui32_val %= i64(std::round(value)); break;
+      case ValType::si32:    writer.get().i32_val %= i64(std::round(value)); break;
+      case ValType::f32:     writer.get().f32_val = i64(std::round(writer.get().f32_val)) % i64(std::round(value)); break;
+      case ValType::ui64:    writer.get().ui64_val %= i64(std::round(value)); break;
+      case ValType::si64:    writer.get().i64_val %= i64(std::round(value)); break;
+      case ValType::f64:     writer.get().f64_val = i64(std::round(writer.get().f64_val)) % i64(std::round(value)); break;
       case ValType::invalid_type:default: break;
       }
       return downcast();
@@ -623,18 +648,19 @@ public:
     } else if constexpr(is_arithmetic_without_cvref_v<T>) {
       auto lk = downcast().getLock(MtxLockType::unique_locked);
       if(!downcast().checkLock(lk)) return downcast();
+      auto writer = getArithmeticDataWriter();
       switch (getValType()) {
-      case ValType::boolean: getArithmeticData().bool_val &= value; break;
-      case ValType::ui8:     getArithmeticData().ui8_val &= value; break;
-      case ValType::si8:     getArithmeticData().i8_val &= value; break;
-      case ValType::ui16:    getArithmeticData().ui16_val &= value; break;
-      case ValType::si16:    getArithmeticData().i16_val &= value; break;
-      case ValType::ui32:    getArithmeticData().ui32_val &= value; break;
-      case ValType::si32:    getArithmeticData().i32_val &= value; break;
-      case ValType::f32:     getArithmeticData().f32_val &= value; break;
-      case ValType::ui64:    getArithmeticData().ui64_val &= value; break;
-      case ValType::si64:    getArithmeticData().i64_val &= value; break;
-      case ValType::f64:     getArithmeticData().f64_val &= value; break;
+      case ValType::boolean: writer.get().bool_val &= value; break;
+      case ValType::ui8:     writer.get().ui8_val &= value; break;
+      case ValType::si8:     writer.get().i8_val &= value; break;
+      case ValType::ui16:    writer.get().ui16_val &= value; break;
+      case ValType::si16:    writer.get().i16_val &= value; break;
+      case ValType::ui32:    writer.get().ui32_val &= value; break;
+      case ValType::si32:    writer.get().i32_val &= value; break;
+      case ValType::f32:     writer.get().f32_val &= value; break;
+      case ValType::ui64:    writer.get().ui64_val &= value; break;
+      case ValType::si64:    writer.get().i64_val &= value; break;
+      case ValType::f64:     writer.get().f64_val &= value; break;
       case ValType::invalid_type:default: break;
       }
       return downcast();
@@ -664,18 +690,19 @@ public:
     } else if constexpr(is_arithmetic_without_cvref_v<T>) {
       auto lk = downcast().getLock(MtxLockType::unique_locked);
       if(!downcast().checkLock(lk)) return downcast();
+      auto writer = getArithmeticDataWriter();
       switch (getValType()) {
-      case ValType::boolean: getArithmeticData().bool_val |= value; break;
-      case ValType::ui8:     getArithmeticData().ui8_val |= value; break;
-      case ValType::si8:     getArithmeticData().i8_val |= value; break;
-      case ValType::ui16:    getArithmeticData().ui16_val |= value; break;
-      case ValType::si16:    getArithmeticData().i16_val |= value; break;
-      case ValType::ui32:    getArithmeticData().ui32_val |= value; break;
-      case ValType::si32:    getArithmeticData().i32_val |= value; break;
-      case ValType::f32:     getArithmeticData().f32_val |= value; break;
-      case ValType::ui64:    getArithmeticData().ui64_val |= value; break;
-      case ValType::si64:    getArithmeticData().i64_val |= value; break;
-      case ValType::f64:     getArithmeticData().f64_val |= value; break;
+      case ValType::boolean: writer.get().bool_val |= value; break;
+      case ValType::ui8:     writer.get().ui8_val |= value; break;
+      case ValType::si8:     writer.get().i8_val |= value; break;
+      case ValType::ui16:    writer.get().ui16_val |= value; break;
+      case ValType::si16:    writer.get().i16_val |= value; break;
+      case ValType::ui32:    writer.get().ui32_val |= value; break;
+      case ValType::si32:    writer.get().i32_val |= value; break;
+      case ValType::f32:     writer.get().f32_val |= value; break;
+      case ValType::ui64:    writer.get().ui64_val |= value; break;
+      case ValType::si64:    writer.get().i64_val |= value; break;
+      case ValType::f64:     writer.get().f64_val |= value; break;
       case ValType::invalid_type:default: break;
       }
       return downcast();
@@ -705,18 +732,19 @@ public:
     } else if constexpr(is_arithmetic_without_cvref_v<T>) {
       auto lk = downcast().getLock(MtxLockType::unique_locked);
       if(!downcast().checkLock(lk)) return downcast();
+      auto writer = getArithmeticDataWriter();
       switch (getValType()) {
-      case ValType::boolean: getArithmeticData().bool_val ^= value; break;
-      case ValType::ui8:     getArithmeticData().ui8_val ^= value; break;
-      case ValType::si8:     getArithmeticData().i8_val ^= value; break;
-      case ValType::ui16:    getArithmeticData().ui16_val ^= value; break;
-      case ValType::si16:    getArithmeticData().i16_val ^= value; break;
-      case ValType::ui32:    getArithmeticData().ui32_val ^= value; break;
-      case ValType::si32:    getArithmeticData().i32_val ^= value; break;
-      case ValType::f32:     getArithmeticData().f32_val ^= value; break;
-      case ValType::ui64:    getArithmeticData().ui64_val ^= value; break;
-      case ValType::si64:    getArithmeticData().i64_val ^= value; break;
-      case ValType::f64:     getArithmeticData().f64_val ^= value; break;
+      case ValType::boolean: writer.get().bool_val ^= value; break;
+      case ValType::ui8:     writer.get().ui8_val ^= value; break;
+      case ValType::si8:     writer.get().i8_val ^= value; break;
+      case ValType::ui16:    writer.get().ui16_val ^= value; break;
+      case ValType::si16:    writer.get().i16_val ^= value; break;
+      case ValType::ui32:    writer.get().ui32_val ^= value; break;
+      case ValType::si32:    writer.get().i32_val ^= value; break;
+      case ValType::f32:     writer.get().f32_val ^= value; break;
+      case ValType::ui64:    writer.get().ui64_val ^= value; break;
+      case ValType::si64:    writer.get().i64_val ^= value; break;
+      case ValType::f64:     writer.get().f64_val ^= value; break;
       case ValType::invalid_type:default: break;
       }
       return downcast();
@@ -746,18 +774,19 @@ public:
     } else if constexpr(is_arithmetic_without_cvref_v<T>) {
       auto lk = downcast().getLock(MtxLockType::unique_locked);
       if(!downcast().checkLock(lk)) return downcast();
+      auto writer = getArithmeticDataWriter();
       switch (getValType()) {
-      case ValType::boolean: getArithmeticData().bool_val <<= value; break;
-      case ValType::ui8:     getArithmeticData().ui8_val <<= value; break;
-      case ValType::si8:     getArithmeticData().i8_val <<= value; break;
-      case ValType::ui16:    getArithmeticData().ui16_val <<= value; break;
-      case ValType::si16:    getArithmeticData().i16_val <<= value; break;
-      case ValType::ui32:    getArithmeticData().ui32_val <<= value; break;
-      case ValType::si32:    getArithmeticData().i32_val <<= value; break;
-      case ValType::f32:     getArithmeticData().f32_val <<= value; break;
-      case ValType::ui64:    getArithmeticData().ui64_val <<= value; break;
-      case ValType::si64:    getArithmeticData().i64_val <<= value; break;
-      case ValType::f64:     getArithmeticData().f64_val <<= value; break;
+      case ValType::boolean: writer.get().bool_val <<= value; break;
+      case ValType::ui8:     writer.get().ui8_val <<= value; break;
+      case ValType::si8:     writer.get().i8_val <<= value; break;
+      case ValType::ui16:    writer.get().ui16_val <<= value; break;
+      case ValType::si16:    writer.get().i16_val <<= value; break;
+      case ValType::ui32:    writer.get().ui32_val <<= value; break;
+      case ValType::si32:    writer.get().i32_val <<= value; break;
+      case ValType::f32:     writer.get().f32_val <<= value; break;
+      case ValType::ui64:    writer.get().ui64_val <<= value; break;
+      case ValType::si64:    writer.get().i64_val <<= value; break;
+      case ValType::f64:     writer.get().f64_val <<= value; break;
       case ValType::invalid_type:default: break;
       }
       return downcast();
@@ -787,18 +816,19 @@ public:
     } else if constexpr(is_arithmetic_without_cvref_v<T>) {
       auto lk = downcast().getLock(MtxLockType::unique_locked);
       if(!downcast().checkLock(lk)) return downcast();
+      auto writer = getArithmeticDataWriter();
       switch (getValType()) {
-      case ValType::boolean: getArithmeticData().bool_val >>= value; break;
-      case ValType::ui8:     getArithmeticData().ui8_val >>= value; break;
-      case ValType::si8:     getArithmeticData().i8_val >>= value; break;
-      case ValType::ui16:    getArithmeticData().ui16_val >>= value; break;
-      case ValType::si16:    getArithmeticData().i16_val >>= value; break;
-      case ValType::ui32:    getArithmeticData().ui32_val >>= value; break;
-      case ValType::si32:    getArithmeticData().i32_val >>= value; break;
-      case ValType::f32:     getArithmeticData().f32_val >>= value; break;
-      case ValType::ui64:    getArithmeticData().ui64_val >>= value; break;
-      case ValType::si64:    getArithmeticData().i64_val >>= value; break;
-      case ValType::f64:     getArithmeticData().f64_val >>= value; break;
+      case ValType::boolean: writer.get().bool_val >>= value; break;
+      case ValType::ui8:     writer.get().ui8_val >>= value; break;
+      case ValType::si8:     writer.get().i8_val >>= value; break;
+      case ValType::ui16:    writer.get().ui16_val >>= value; break;
+      case ValType::si16:    writer.get().i16_val >>= value; break;
+      case ValType::ui32:    writer.get().ui32_val >>= value; break;
+      case ValType::si32:    writer.get().i32_val >>= value; break;
+      case ValType::f32:     writer.get().f32_val >>= value; break;
+      case ValType::ui64:    writer.get().ui64_val >>= value; break;
+      case ValType::si64:    writer.get().i64_val >>= value; break;
+      case ValType::f64:     writer.get().f64_val >>= value; break;
       case ValType::invalid_type:default: break;
       }
       return downcast();
@@ -808,18 +838,19 @@ public:
   ArithmeticTypeDriven& operator++() noexcept {
     auto lk = downcast().getLock(MtxLockType::unique_locked);
     if(!downcast().checkLock(lk)) return downcast();
+    auto writer = getArithmeticDataWriter();
     switch (getValType()) {
     case ValType::boolean:
-    case ValType::ui8: ++getArithmeticData().ui8_val; break;
-    case ValType::si8: ++getArithmeticData().i8_val; break;
-    case ValType::ui16: ++getArithmeticData().ui16_val; break;
-    case ValType::si16: ++getArithmeticData().i16_val; break;
-    case ValType::ui32: ++getArithmeticData().ui32_val; break;
-    case ValType::si32: ++getArithmeticData().i32_val; break;
-    case ValType::f32: ++getArithmeticData().f32_val; break;
-    case ValType::ui64: ++getArithmeticData().ui64_val; break;
-    case ValType::si64: ++getArithmeticData().i64_val; break;
-    case ValType::f64: ++getArithmeticData().f64_val; break;
+    case ValType::ui8: ++writer.get().ui8_val; break;
+    case ValType::si8: ++writer.get().i8_val; break;
+    case ValType::ui16: ++writer.get().ui16_val; break;
+    case ValType::si16: ++writer.get().i16_val; break;
+    case ValType::ui32: ++writer.get().ui32_val; break;
+    case ValType::si32: ++writer.get().i32_val; break;
+    case ValType::f32: ++writer.get().f32_val; break;
+    case ValType::ui64: ++writer.get().ui64_val; break;
+    case ValType::si64: ++writer.get().i64_val; break;
+    case ValType::f64: ++writer.get().f64_val; break;
     case ValType::invalid_type:
     default: break;
     }
@@ -829,18 +860,19 @@ public:
   ArithmeticTypeDriven& operator--() noexcept {
     auto lk = downcast().getLock(MtxLockType::unique_locked);
     if(!downcast().checkLock(lk)) return downcast();
+    auto writer = getArithmeticDataWriter();
     switch (getValType()) {
     case ValType::boolean:
-    case ValType::ui8: --getArithmeticData().ui8_val; break;
-    case ValType::si8: --getArithmeticData().i8_val; break;
-    case ValType::ui16: --getArithmeticData().ui16_val; break;
-    case ValType::si16: --getArithmeticData().i16_val; break;
-    case ValType::ui32: --getArithmeticData().ui32_val; break;
-    case ValType::si32: --getArithmeticData().i32_val; break;
-    case ValType::f32: --getArithmeticData().f32_val; break;
-    case ValType::ui64: --getArithmeticData().ui64_val; break;
-    case ValType::si64: --getArithmeticData().i64_val; break;
-    case ValType::f64: --getArithmeticData().f64_val; break;
+    case ValType::ui8: --writer.get().ui8_val; break;
+    case ValType::si8: --writer.get().i8_val; break;
+    case ValType::ui16: --writer.get().ui16_val; break;
+    case ValType::si16: --writer.get().i16_val; break;
+    case ValType::ui32: --writer.get().ui32_val; break;
+    case ValType::si32: --writer.get().i32_val; break;
+    case ValType::f32: --writer.get().f32_val; break;
+    case ValType::ui64: --writer.get().ui64_val; break;
+    case ValType::si64: --writer.get().i64_val; break;
+    case ValType::f64: --writer.get().f64_val; break;
     case ValType::invalid_type:
     default: break;
     }
@@ -1034,6 +1066,12 @@ class CastableArithmeticTypeBase {
   inline void setType(ValType type) noexcept {downcast().setTypeImpl(type);}
   inline void reallocate(ValType type) noexcept {downcast().reallocateImpl(type);}
   inline ArithmeticData& getArithmeticData() noexcept {return downcast().getArithmeticDataImpl();}
+  //! Writer of driven type is used if it has getArithmeticDataWriterImpl(), e.g. to change copy of data and store it at once
+  inline auto getArithmeticDataWriter() noexcept {
+    if constexpr (requires(ArithmeticTypeDriven& driven) {driven.getArithmeticDataWriterImpl();})
+      return downcast().getArithmeticDataWriterImpl();
+    else return ArithmeticDataWriter(getArithmeticData());
+  }
 
 protected:
   void reallocateImpl([[maybe_unused]] ValType type) noexcept {}
@@ -1045,179 +1083,180 @@ public:
     auto lk = downcast().getLock(MtxLockType::unique_locked);
     if(!downcast().checkLock(lk)) return downcast();
     reallocate(new_type);
+    auto writer = getArithmeticDataWriter();
     switch (downcast().getValType()) {
     case binom::ValType::boolean:
       switch (new_type) {
       case binom::ValType::boolean: return downcast();
-      case binom::ValType::ui8: getArithmeticData().ui8_val = static_cast<ui8>(getArithmeticData().bool_val); break;
-      case binom::ValType::si8: getArithmeticData().i16_val = static_cast<i8>(getArithmeticData().bool_val); break;
-      case binom::ValType::ui16: getArithmeticData().ui16_val = static_cast<ui16>(getArithmeticData().bool_val); break;
-      case binom::ValType::si16: getArithmeticData().i16_val = static_cast<i16>(getArithmeticData().bool_val); break;
-      case binom::ValType::ui32: getArithmeticData().ui32_val = static_cast<ui32>(getArithmeticData().bool_val); break;
-      case binom::ValType::si32: getArithmeticData().i32_val = static_cast<i32>(getArithmeticData().bool_val); break;
-      case binom::ValType::f32: getArithmeticData().f32_val = static_cast<f32>(getArithmeticData().bool_val); break;
-      case binom::ValType::ui64: getArithmeticData().ui64_val = static_cast<ui64>(getArithmeticData().bool_val); break;
-      case binom::ValType::si64: getArithmeticData().i64_val = static_cast<i64>(getArithmeticData().bool_val); break;
-      case binom::ValType::f64: getArithmeticData().f64_val = static_cast<f64>(getArithmeticData().bool_val); break;
+      case binom::ValType::ui8: writer.get().ui8_val = static_cast<ui8>(writer.get().bool_val); break;
+      case binom::ValType::si8: writer.get().i16_val = static_cast<i8>(writer.get().bool_val); break;
+      case binom::ValType::ui16: writer.get().ui16_val = static_cast<ui16>(writer.get().bool_val); break;
+      case binom::ValType::si16: writer.get().i16_val = static_cast<i16>(writer.get().bool_val); break;
+      case binom::ValType::ui32: writer.get().ui32_val = static_cast<ui32>(writer.get().bool_val); break;
+      case binom::ValType::si32: writer.get().i32_val = static_cast<i32>(writer.get().bool_val); break;
+      case binom::ValType::f32: writer.get().f32_val = static_cast<f32>(writer.get().bool_val); break;
+      case binom::ValType::ui64: writer.get().ui64_val = static_cast<ui64>(writer.get().bool_val); break;
+      case binom::ValType::si64: writer.get().i64_val = static_cast<i64>(writer.get().bool_val); break;
+      case binom::ValType::f64: writer.get().f64_val = static_cast<f64>(writer.get().bool_val); break;
       case binom::ValType::invalid_type:default: return downcast();
       }
     break;
     case binom::ValType::ui8:
       switch (new_type) {
-      case binom::ValType::boolean: getArithmeticData().bool_val = static_cast<bool>(getArithmeticData().ui8_val); break;
+      case binom::ValType::boolean: writer.get().bool_val = static_cast<bool>(writer.get().ui8_val); break;
       case binom::ValType::ui8: return downcast();
-      case binom::ValType::si8: getArithmeticData().i16_val = static_cast<i8>(getArithmeticData().ui8_val); break;
-      case binom::ValType::ui16: getArithmeticData().ui16_val = static_cast<ui16>(getArithmeticData().ui8_val); break;
-      case binom::ValType::si16: getArithmeticData().i16_val = static_cast<i16>(getArithmeticData().ui8_val); break;
-      case binom::ValType::ui32: getArithmeticData().ui32_val = static_cast<ui32>(getArithmeticData().ui8_val); break;
-      case binom::ValType::si32: getArithmeticData().i32_val = static_cast<i32>(getArithmeticData().ui8_val); break;
-      case binom::ValType::f32: getArithmeticData().f32_val = static_cast<f32>(getArithmeticData().ui8_val); break;
-      case binom::ValType::ui64: getArithmeticData().ui64_val = static_cast<ui64>(getArithmeticData().ui8_val); break;
-      case binom::ValType::si64: getArithmeticData().i64_val = static_cast<i64>(getArithmeticData().ui8_val); break;
-      case binom::ValType::f64: getArithmeticData().f64_val = static_cast<f64>(getArithmeticData().ui8_val); break;
+      case binom::ValType::si8: writer.get().i16_val = static_cast<i8>(writer.get().ui8_val); break;
+      case binom::ValType::ui16: writer.get().ui16_val = static_cast<ui16>(writer.get().ui8_val); break;
+      case binom::ValType::si16: writer.get().i16_val = static_cast<i16>(writer.get().ui8_val); break;
+      case binom::ValType::ui32: writer.get().ui32_val = static_cast<ui32>(writer.get().ui8_val); break;
+      case binom::ValType::si32: writer.get().i32_val = static_cast<i32>(writer.get().ui8_val); break;
+      case binom::ValType::f32: writer.get().f32_val = static_cast<f32>(writer.get().ui8_val); break;
+      case binom::ValType::ui64: writer.get().ui64_val = static_cast<ui64>(writer.get().ui8_val); break;
+      case binom::ValType::si64: writer.get().i64_val = static_cast<i64>(writer.get().ui8_val); break;
+      case binom::ValType::f64: writer.get().f64_val = static_cast<f64>(writer.get().ui8_val); break;
       case binom::ValType::invalid_type:default: return downcast();
       }
     break;
     case binom::ValType::si8:
       switch (new_type) {
-      case binom::ValType::boolean: getArithmeticData().bool_val = static_cast<bool>(getArithmeticData().ui8_val);  break;
-      case binom::ValType::ui8: getArithmeticData().ui8_val = static_cast<ui8>(getArithmeticData().ui8_val); break;
+      case binom::ValType::boolean: writer.get().bool_val = static_cast<bool>(writer.get().ui8_val);  break;
+      case binom::ValType::ui8: writer.get().ui8_val = static_cast<ui8>(writer.get().ui8_val); break;
       case binom::ValType::si8: return downcast();
-      case binom::ValType::ui16: getArithmeticData().ui16_val = static_cast<ui16>(getArithmeticData().ui8_val); break;
-      case binom::ValType::si16: getArithmeticData().i16_val = static_cast<i16>(getArithmeticData().ui8_val); break;
-      case binom::ValType::ui32: getArithmeticData().ui32_val = static_cast<ui32>(getArithmeticData().ui8_val); break;
-      case binom::ValType::si32: getArithmeticData().i32_val = static_cast<i32>(getArithmeticData().ui8_val); break;
-      case binom::ValType::f32: getArithmeticData().f32_val = static_cast<f32>(getArithmeticData().ui8_val); break;
-      case binom::ValType::ui64: getArithmeticData().ui64_val = static_cast<ui64>(getArithmeticData().ui8_val); break;
-      case binom::ValType::si64: getArithmeticData().i64_val = static_cast<i64>(getArithmeticData().ui8_val); break;
-      case binom::ValType::f64: getArithmeticData().f64_val = static_cast<f64>(getArithmeticData().ui8_val); break;
+      case binom::ValType::ui16: writer.get().ui16_val = static_cast<ui16>(writer.get().ui8_val); break;
+      case binom::ValType::si16: writer.get().i16_val = static_cast<i16>(writer.get().ui8_val); break;
+      case binom::ValType::ui32: writer.get().ui32_val = static_cast<ui32>(writer.get().ui8_val); break;
+      case binom::ValType::si32: writer.get().i32_val = static_cast<i32>(writer.get().ui8_val); break;
+      case binom::ValType::f32: writer.get().f32_val = static_cast<f32>(writer.get().ui8_val); break;
+      case binom::ValType::ui64: writer.get().ui64_val = static_cast<ui64>(writer.get().ui8_val); break;
+      case binom::ValType::si64: writer.get().i64_val = static_cast<i64>(writer.get().ui8_val); break;
+      case binom::ValType::f64: writer.get().f64_val = static_cast<f64>(writer.get().ui8_val); break;
       case binom::ValType::invalid_type:default: return downcast();
       }
     break;
     case binom::ValType::ui16:
       switch (new_type) {
-      case binom::ValType::boolean: getArithmeticData().bool_val = static_cast<bool>(getArithmeticData().ui8_val); break;
-      case binom::ValType::ui8: getArithmeticData().ui8_val = static_cast<ui8>(getArithmeticData().ui8_val); break;
-      case binom::ValType::si8: getArithmeticData().i16_val = static_cast<i8>(getArithmeticData().ui8_val); break;
+      case binom::ValType::boolean: writer.get().bool_val = static_cast<bool>(writer.get().ui8_val); break;
+      case binom::ValType::ui8: writer.get().ui8_val = static_cast<ui8>(writer.get().ui8_val); break;
+      case binom::ValType::si8: writer.get().i16_val = static_cast<i8>(writer.get().ui8_val); break;
       case binom::ValType::ui16: return downcast();
-      case binom::ValType::si16: getArithmeticData().i16_val = static_cast<i16>(getArithmeticData().ui8_val); break;
-      case binom::ValType::ui32: getArithmeticData().ui32_val = static_cast<ui32>(getArithmeticData().ui8_val); break;
-      case binom::ValType::si32: getArithmeticData().i32_val = static_cast<i32>(getArithmeticData().ui8_val); break;
-      case binom::ValType::f32: getArithmeticData().f32_val = static_cast<f32>(getArithmeticData().ui8_val); break;
-      case binom::ValType::ui64: getArithmeticData().ui64_val = static_cast<ui64>(getArithmeticData().ui8_val); break;
-      case binom::ValType::si64: getArithmeticData().i64_val = static_cast<i64>(getArithmeticData().ui8_val); break;
-      case binom::ValType::f64: getArithmeticData().f64_val = static_cast<f64>(getArithmeticData().ui8_val); break;
+      case binom::ValType::si16: writer.get().i16_val = static_cast<i16>(writer.get().ui8_val); break;
+      case binom::ValType::ui32: writer.get().ui32_val = static_cast<ui32>(writer.get().ui8_val); break;
+      case binom::ValType::si32: writer.get().i32_val = static_cast<i32>(writer.get().ui8_val); break;
+      case binom::ValType::f32: writer.get().f32_val = static_cast<f32>(writer.get().ui8_val); break;
+      case binom::ValType::ui64: writer.get().ui64_val = static_cast<ui64>(writer.get().ui8_val); break;
+      case binom::ValType::si64: writer.get().i64_val = static_cast<i64>(writer.get().ui8_val); break;
+      case binom::ValType::f64: writer.get().f64_val = static_cast<f64>(writer.get().ui8_val); break;
       case binom::ValType::invalid_type:default: return downcast();
       }
     break;
     case binom::ValType::si16:
       switch (new_type) {
-      case binom::ValType::boolean: getArithmeticData().bool_val = static_cast<bool>(getArithmeticData().ui8_val); break;
-      case binom::ValType::ui8: getArithmeticData().ui8_val = static_cast<ui8>(getArithmeticData().ui8_val); break;
-      case binom::ValType::si8: getArithmeticData().i16_val = static_cast<i8>(getArithmeticData().ui8_val); break;
-      case binom::ValType::ui16: getArithmeticData().ui16_val = static_cast<ui16>(getArithmeticData().ui8_val); break;
+      case binom::ValType::boolean: writer.get().bool_val = static_cast<bool>(writer.get().ui8_val); break;
+      case binom::ValType::ui8: writer.get().ui8_val = static_cast<ui8>(writer.get().ui8_val); break;
+      case binom::ValType::si8: writer.get().i16_val = static_cast<i8>(writer.get().ui8_val); break;
+      case binom::ValType::ui16: writer.get().ui16_val = static_cast<ui16>(writer.get().ui8_val); break;
       case binom::ValType::si16: return downcast();
-      case binom::ValType::ui32: getArithmeticData().ui32_val = static_cast<ui32>(getArithmeticData().ui8_val); break;
-      case binom::ValType::si32: getArithmeticData().i32_val = static_cast<i32>(getArithmeticData().ui8_val); break;
-      case binom::ValType::f32: getArithmeticData().f32_val = static_cast<f32>(getArithmeticData().ui8_val); break;
-      case binom::ValType::ui64: getArithmeticData().ui64_val = static_cast<ui64>(getArithmeticData().ui8_val); break;
-      case binom::ValType::si64: getArithmeticData().i64_val = static_cast<i64>(getArithmeticData().ui8_val); break;
-      case binom::ValType::f64: getArithmeticData().f64_val = static_cast<f64>(getArithmeticData().ui8_val); break;
+      case binom::ValType::ui32: writer.get().ui32_val = static_cast<ui32>(writer.get().ui8_val); break;
+      case binom::ValType::si32: writer.get().i32_val = static_cast<i32>(writer.get().ui8_val); break;
+      case binom::ValType::f32: writer.get().f32_val = static_cast<f32>(writer.get().ui8_val); break;
+      case binom::ValType::ui64: writer.get().ui64_val = static_cast<ui64>(writer.get().ui8_val); break;
+      case binom::ValType::si64: writer.get().i64_val = static_cast<i64>(writer.get().ui8_val); break;
+      case binom::ValType::f64: writer.get().f64_val = static_cast<f64>(writer.get().ui8_val); break;
       case binom::ValType::invalid_type:default: return downcast();
       }
     break;
     case binom::ValType::ui32:
       switch (new_type) {
-      case binom::ValType::boolean: getArithmeticData().bool_val = static_cast<bool>(getArithmeticData().ui8_val); break;
-      case binom::ValType::ui8: getArithmeticData().ui8_val = static_cast<ui8>(getArithmeticData().ui8_val); break;
-      case binom::ValType::si8: getArithmeticData().i16_val = static_cast<i8>(getArithmeticData().ui8_val); break;
-      case binom::ValType::ui16: getArithmeticData().ui16_val = static_cast<ui16>(getArithmeticData().ui8_val); break;
-      case binom::ValType::si16: getArithmeticData().i16_val = static_cast<i16>(getArithmeticData().ui8_val); break;
+      case binom::ValType::boolean: writer.get().bool_val = static_cast<bool>(writer.get().ui8_val); break;
+      case binom::ValType::ui8: writer.get().ui8_val = static_cast<ui8>(writer.get().ui8_val); break;
+      case binom::ValType::si8: writer.get().i16_val = static_cast<i8>(writer.get().ui8_val); break;
+      case binom::ValType::ui16: writer.get().ui16_val = static_cast<ui16>(writer.get().ui8_val); break;
+      case binom::ValType::si16: writer.get().i16_val = static_cast<i16>(writer.get().ui8_val); break;
       case binom::ValType::ui32: return downcast();
-      case binom::ValType::si32: getArithmeticData().i32_val = static_cast<i32>(getArithmeticData().ui8_val); break;
-      case binom::ValType::f32: getArithmeticData().f32_val = static_cast<f32>(getArithmeticData().ui8_val); break;
-      case binom::ValType::ui64: getArithmeticData().ui64_val = static_cast<ui64>(getArithmeticData().ui8_val); break;
-      case binom::ValType::si64: getArithmeticData().i64_val = static_cast<i64>(getArithmeticData().ui8_val); break;
-      case binom::ValType::f64: getArithmeticData().f64_val = static_cast<f64>(getArithmeticData().ui8_val); break;
+      case binom::ValType::si32: writer.get().i32_val = static_cast<i32>(writer.get().ui8_val); break;
+      case binom::ValType::f32: writer.get().f32_val = static_cast<f32>(writer.get().ui8_val); break;
+      case binom::ValType::ui64: writer.get().ui64_val = static_cast<ui64>(writer.get().ui8_val); break;
+      case binom::ValType::si64: writer.get().i64_val = static_cast<i64>(writer.get().ui8_val); break;
+      case binom::ValType::f64: writer.get().f64_val = static_cast<f64>(writer.get().ui8_val); break;
       case binom::ValType::invalid_type:default: return downcast();
       }
     break;
     case binom::ValType::si32:
       switch (new_type) {
-      case binom::ValType::boolean: getArithmeticData().bool_val = static_cast<bool>(getArithmeticData().ui8_val); break;
-      case binom::ValType::ui8: getArithmeticData().ui8_val = static_cast<ui8>(getArithmeticData().ui8_val); break;
-      case binom::ValType::si8: getArithmeticData().i16_val = static_cast<i8>(getArithmeticData().ui8_val); break;
-      case binom::ValType::ui16: getArithmeticData().ui16_val = static_cast<ui16>(getArithmeticData().ui8_val); break;
-      case binom::ValType::si16: getArithmeticData().i16_val = static_cast<i16>(getArithmeticData().ui8_val); break;
-      case binom::ValType::ui32: getArithmeticData().ui32_val = static_cast<ui32>(getArithmeticData().ui8_val); break;
+      case binom::ValType::boolean: writer.get().bool_val = static_cast<bool>(writer.get().ui8_val); break;
+      case binom::ValType::ui8: writer.get().ui8_val = static_cast<ui8>(writer.get().ui8_val); break;
+      case binom::ValType::si8: writer.get().i16_val = static_cast<i8>(writer.get().ui8_val); break;
+      case binom::ValType::ui16: writer.get().ui16_val = static_cast<ui16>(writer.get().ui8_val); break;
+      case binom::ValType::si16: writer.get().i16_val = static_cast<i16>(writer.get().ui8_val); break;
+      case binom::ValType::ui32: writer.get().ui32_val = static_cast<ui32>(writer.get().ui8_val); break;
       case binom::ValType::si32: return downcast();
-      case binom::ValType::f32: getArithmeticData().f32_val = static_cast<f32>(getArithmeticData().ui8_val); break;
-      case binom::ValType::ui64: getArithmeticData().ui64_val = static_cast<ui64>(getArithmeticData().ui8_val); break;
-      case binom::ValType::si64: getArithmeticData().i64_val = static_cast<i64>(getArithmeticData().ui8_val); break;
-      case binom::ValType::f64: getArithmeticData().f64_val = static_cast<f64>(getArithmeticData().ui8_val); break;
+      case binom::ValType::f32: writer.get().f32_val = static_cast<f32>(writer.get().ui8_val); break;
+      case binom::ValType::ui64: writer.get().ui64_val = static_cast<ui64>(writer.get().ui8_val); break;
+      case binom::ValType::si64: writer.get().i64_val = static_cast<i64>(writer.get().ui8_val); break;
+      case binom::ValType::f64: writer.get().f64_val = static_cast<f64>(writer.get().ui8_val); break;
       case binom::ValType::invalid_type:default: return downcast();
       }
     break;
     case binom::ValType::f32:
       switch (new_type) {
-      case binom::ValType::boolean: getArithmeticData().bool_val = static_cast<bool>(getArithmeticData().ui8_val); break;
-      case binom::ValType::ui8: getArithmeticData().ui8_val = static_cast<ui8>(getArithmeticData().ui8_val); break;
-      case binom::ValType::si8: getArithmeticData().i16_val = static_cast<i8>(getArithmeticData().ui8_val); break;
-      case binom::ValType::ui16: getArithmeticData().ui16_val = static_cast<ui16>(getArithmeticData().ui8_val); break;
-      case binom::ValType::si16: getArithmeticData().i16_val = static_cast<i16>(getArithmeticData().ui8_val); break;
-      case binom::ValType::ui32: getArithmeticData().ui32_val = static_cast<ui32>(getArithmeticData().ui8_val); break;
-      case binom::ValType::si32: getArithmeticData().i32_val = static_cast<i32>(getArithmeticData().ui8_val); break;
+      case binom::ValType::boolean: writer.get().bool_val = static_cast<bool>(writer.get().ui8_val); break;
+      case binom::ValType::ui8: writer.get().ui8_val = static_cast<ui8>(writer.get().ui8_val); break;
+      case binom::ValType::si8: writer.get().i16_val = static_cast<i8>(writer.get().ui8_val); break;
+      case binom::ValType::ui16: writer.get().ui16_val = static_cast<ui16>(writer.get().ui8_val); break;
+      case binom::ValType::si16: writer.get().i16_val = static_cast<i16>(writer.get().ui8_val); break;
+      case binom::ValType::ui32: writer.get().ui32_val = static_cast<ui32>(writer.get().ui8_val); break;
+      case binom::ValType::si32: writer.get().i32_val = static_cast<i32>(writer.get().ui8_val); break;
       case binom::ValType::f32: return downcast();
-      case binom::ValType::ui64: getArithmeticData().ui64_val = static_cast<ui64>(getArithmeticData().ui8_val); break;
-      case binom::ValType::si64: getArithmeticData().i64_val = static_cast<i64>(getArithmeticData().ui8_val); break;
-      case binom::ValType::f64: getArithmeticData().f64_val = static_cast<f64>(getArithmeticData().ui8_val); break;
+      case binom::ValType::ui64: writer.get().ui64_val = static_cast<ui64>(writer.get().ui8_val); break;
+      case binom::ValType::si64: writer.get().i64_val = static_cast<i64>(writer.get().ui8_val); break;
+      case binom::ValType::f64: writer.get().f64_val = static_cast<f64>(writer.get().ui8_val); break;
       case binom::ValType::invalid_type:default: return downcast();
       }
     break;
     case binom::ValType::ui64:
       switch (new_type) {
-      case binom::ValType::boolean: getArithmeticData().bool_val = static_cast<bool>(getArithmeticData().ui8_val); break;
-      case binom::ValType::ui8: getArithmeticData().ui8_val = static_cast<ui8>(getArithmeticData().ui8_val); break;
-      case binom::ValType::si8: getArithmeticData().i16_val = static_cast<i8>(getArithmeticData().ui8_val); break;
-      case binom::ValType::ui16: getArithmeticData().ui16_val = static_cast<ui16>(getArithmeticData().ui8_val); break;
-      case binom::ValType::si16: getArithmeticData().i16_val = static_cast<i16>(getArithmeticData().ui8_val); break;
-      case binom::ValType::ui32: getArithmeticData().ui32_val = static_cast<ui32>(getArithmeticData().ui8_val); break;
-      case binom::ValType::si32: getArithmeticData().i32_val = static_cast<i32>(getArithmeticData().ui8_val); break;
-      case binom::ValType::f32: getArithmeticData().f32_val = static_cast<f32>(getArithmeticData().ui8_val); break;
+      case binom::ValType::boolean: writer.get().bool_val = static_cast<bool>(writer.get().ui8_val); break;
+      case binom::ValType::ui8: writer.get().ui8_val = static_cast<ui8>(writer.get().ui8_val); break;
+      case binom::ValType::si8: writer.get().i16_val = static_cast<i8>(writer.get().ui8_val); break;
+      case binom::ValType::ui16: writer.get().ui16_val = static_cast<ui16>(writer.get().ui8_val); break;
+      case binom::ValType::si16: writer.get().i16_val = static_cast<i16>(writer.get().ui8_val); break;
+      case binom::ValType::ui32: writer.get().ui32_val = static_cast<ui32>(writer.get().ui8_val); break;
+      case binom::ValType::si32: writer.get().i32_val = static_cast<i32>(writer.get().ui8_val); break;
+      case binom::ValType::f32: writer.get().f32_val = static_cast<f32>(writer.get().ui8_val); break;
       case binom::ValType::ui64: return downcast();
-      case binom::ValType::si64: getArithmeticData().i64_val = static_cast<i64>(getArithmeticData().ui8_val); break;
-      case binom::ValType::f64: getArithmeticData().f64_val = static_cast<f64>(getArithmeticData().ui8_val); break;
+      case binom::ValType::si64: writer.get().i64_val = static_cast<i64>(writer.get().ui8_val); break;
+      case binom::ValType::f64: writer.get().f64_val = static_cast<f64>(writer.get().ui8_val); break;
       case binom::ValType::invalid_type:default: return downcast();
       }
     break;
     case binom::ValType::si64:
       switch (new_type) {
-      case binom::ValType::boolean: getArithmeticData().bool_val = static_cast<bool>(getArithmeticData().ui8_val); break;
-      case binom::ValType::ui8: getArithmeticData().ui8_val = static_cast<ui8>(getArithmeticData().ui8_val); break;
-      case binom::ValType::si8: getArithmeticData().i16_val = static_cast<i8>(getArithmeticData().ui8_val); break;
-      case binom::ValType::ui16: getArithmeticData().ui16_val = static_cast<ui16>(getArithmeticData().ui8_val); break;
-      case binom::ValType::si16: getArithmeticData().i16_val = static_cast<i16>(getArithmeticData().ui8_val); break;
-      case binom::ValType::ui32: getArithmeticData().ui32_val = static_cast<ui32>(getArithmeticData().ui8_val); break;
-      case binom::ValType::si32: getArithmeticData().i32_val = static_cast<i32>(getArithmeticData().ui8_val); break;
-      case binom::ValType::f32: getArithmeticData().f32_val = static_cast<f32>(getArithmeticData().ui8_val); break;
-      case binom::ValType::ui64: getArithmeticData().ui64_val = static_cast<ui64>(getArithmeticData().ui8_val); break;
+      case binom::ValType::boolean: writer.get().bool_val = static_cast<bool>(writer.get().ui8_val); break;
+      case binom::ValType::ui8: writer.get().ui8_val = static_cast<ui8>(writer.get().ui8_val); break;
+      case binom::ValType::si8: writer.get().i16_val = static_cast<i8>(writer.get().ui8_val); break;
+      case binom::ValType::ui16: writer.get().ui16_val = static_cast<ui16>(writer.get().ui8_val); break;
+      case binom::ValType::si16: writer.get().i16_val = static_cast<i16>(writer.get().ui8_val); break;
+      case binom::ValType::ui32: writer.get().ui32_val = static_cast<ui32>(writer.get().ui8_val); break;
+      case binom::ValType::si32: writer.get().i32_val = static_cast<i32>(writer.get().ui8_val); break;
+      case binom::ValType::f32: writer.get().f32_val = static_cast<f32>(writer.get().ui8_val); break;
+      case binom::ValType::ui64: writer.get().ui64_val = static_cast<ui64>(writer.get().ui8_val); break;
       case binom::ValType::si64: return downcast();
-      case binom::ValType::f64: getArithmeticData().f64_val = static_cast<f64>(getArithmeticData().ui8_val); break;
+      case binom::ValType::f64: writer.get().f64_val = static_cast<f64>(writer.get().ui8_val); break;
       case binom::ValType::invalid_type:default: return downcast();
       }
     break;
     case binom::ValType::f64:
       switch (new_type) {
-      case binom::ValType::boolean: getArithmeticData().bool_val = static_cast<bool>(getArithmeticData().ui8_val); break;
-      case binom::ValType::ui8: getArithmeticData().ui8_val = static_cast<ui8>(getArithmeticData().ui8_val); break;
-      case binom::ValType::si8: getArithmeticData().i16_val = static_cast<i8>(getArithmeticData().ui8_val); break;
-      case binom::ValType::ui16: getArithmeticData().ui16_val = static_cast<ui16>(getArithmeticData().ui8_val); break;
-      case binom::ValType::si16: getArithmeticData().i16_val = static_cast<i16>(getArithmeticData().ui8_val); break;
-      case binom::ValType::ui32: getArithmeticData().ui32_val = static_cast<ui32>(getArithmeticData().ui8_val); break;
-      case binom::ValType::si32: getArithmeticData().i32_val = static_cast<i32>(getArithmeticData().ui8_val); break;
-      case binom::ValType::f32: getArithmeticData().f32_val = static_cast<f32>(getArithmeticData().ui8_val); break;
-      case binom::ValType::ui64: getArithmeticData().ui64_val = static_cast<ui64>(getArithmeticData().ui8_val); break;
-      case binom::ValType::si64: getArithmeticData().i64_val = static_cast<i64>(getArithmeticData().ui8_val); break;
+      case binom::ValType::boolean: writer.get().bool_val = static_cast<bool>(writer.get().ui8_val); break;
+      case binom::ValType::ui8: writer.get().ui8_val = static_cast<ui8>(writer.get().ui8_val); break;
+      case binom::ValType::si8: writer.get().i16_val = static_cast<i8>(writer.get().ui8_val); break;
+      case binom::ValType::ui16: writer.get().ui16_val = static_cast<ui16>(writer.get().ui8_val); break;
+      case binom::ValType::si16: writer.get().i16_val = static_cast<i16>(writer.get().ui8_val); break;
+      case binom::ValType::ui32: writer.get().ui32_val = static_cast<ui32>(writer.get().ui8_val); break;
+      case binom::ValType::si32: writer.get().i32_val = static_cast<i32>(writer.get().ui8_val); break;
+      case binom::ValType::f32: writer.get().f32_val = static_cast<f32>(writer.get().ui8_val); break;
+      case binom::ValType::ui64: writer.get().ui64_val = static_cast<ui64>(writer.get().ui8_val); break;
+      case binom::ValType::si64: writer.get().i64_val = static_cast<i64>(writer.get().ui8_val); break;
       case binom::ValType::f64: return downcast();
       case binom::ValType::invalid_type:default: return downcast();
       }
@@ -3,8 +3,12 @@
 
 #include "type_aliases.hxx"
 #include "reverse_iterator.hxx"
+#include "epoch_reclamation.hxx"
+#include <atomic>
+#include <cassert>
 #include <shared_mutex>
 #include <map>
+#include <vector>
 #include <optional>
 
 namespace shared_recursive_mtx {
@@ -24,6 +28,89 @@ struct Counters {
   ui64 unique_lock_counter = 0;
 };
 
+struct LockState {
+  std::shared_mutex* mtx = nullptr;
+  //! Optional version of data guarded by mutex, it's odd while mutex is unique locked.
+  //! Bound when state is created and kept until it's erased, so each bump to odd is paired with bump to even
+  std::atomic_uint64_t* version = nullptr;
+  Counters counters;
+};
+
+/**
+ * @brief LockStateTable - per-thread registry of mutex lock states
+ *
+ * Thread rarely holds more than a few mutexes at once, so states are kept
+ * in fixed array searched linearly without hashing or heap allocation.
+ * States which don't fit the array are kept in fallback map.
+ * Address of state doesn't change while it's in table.
+ * Thread is pinned for epoch reclamation while table isn't empty,
+ * so resources locked by thread aren't freed by other threads.
+ */
+class LockStateTable {
+public:
+  static constexpr size_t capacity = 16;
+
+private:
+  static inline thread_local std::map<std::shared_mutex*, LockState> fallback_states;
+
+  LockState states[capacity];
+  size_t used_count = 0;      ///< States after used_count are free
+  size_t state_count = 0;     ///< Occupied states in array
+  size_t fallback_count = 0;
+
+  inline bool isInArray(const LockState* state) const noexcept {return state >= states && state < states + capacity;}
+
+public:
+  /**
+   * @brief Returns state of mutex with incremented wrapper count, creates state if there is no one
+   * @param version - version of data guarded by mutex, bound only to created state.
+   * Nested acquire may pass nullptr or the same version, other version is a bug of caller
+   */
+  LockState* acquire(std::shared_mutex* mtx, std::atomic_uint64_t* version = nullptr) noexcept {
+    LockState* free_state = nullptr;
+    for(LockState* it = states, *end = states + used_count; it != end; ++it) {
+      if(it->mtx == mtx) {
+        assert(!version || it->version == version);
+        ++it->counters.wrapper_count;
+        return it;
+      } else if(!it->mtx && !free_state) free_state = it;
+    }
+
+    if(fallback_count) {
+      if(auto it = fallback_states.find(mtx); it != fallback_states.cend()) {
+        assert(!version || it->second.version == version);
+        ++it->second.counters.wrapper_count;
+        return &it->second;
+      }
+    }
+
+    if(!size()) epoch_reclamation::pin();
+    if(!free_state && used_count < capacity) free_state = states + used_count++;
+    if(free_state) {
+      *free_state = LockState{mtx, version, Counters{}};
+      ++state_count;
+      return free_state;
+    }
+
+    ++fallback_count;
+    return &fallback_states.emplace(mtx, LockState{mtx, version, Counters{}}).first->second;
+  }
+
+  void erase(LockState* state) noexcept {
+    if(isInArray(state)) {
+      state->mtx = nullptr;
+      --state_count;
+      while(used_count && !states[used_count - 1].mtx) --used_count;
+    } else {
+      fallback_states.erase(state->mtx);
+      --fallback_count;
+    }
+    if(!size()) epoch_reclamation::unpin();
+  }
+
+  size_t size() const noexcept {return state_count + fallback_count;}
+};
+
 /**
  * @brief SMRecursiveWrapper - std::shared_mutex wrapper for recusive locking
  *
@@ -34,27 +121,34 @@ struct Counters {
  * unlockShared() shared_lock => unlock;
  */
 class SharedRecursiveMutexWrapper {
-  static inline thread_local std::map<std::shared_mutex*, Counters> counter_storage;
-  std::map<std::shared_mutex*, Counters>::iterator mtx_data = counter_storage.end();
-
-  static std::map<std::shared_mutex*, Counters>::iterator createCountersRef(const std::shared_mutex* mtx) noexcept {
-    if(!mtx) return counter_storage.end();
-    auto it = counter_storage.find(const_cast<std::shared_mutex*>(mtx));
-    if(it == counter_storage.cend())
-      return counter_storage.emplace(std::make_pair(const_cast<std::shared_mutex*>(mtx), Counters{})).first;
-    ++it->second.wrapper_count;
-    return it;
+  static inline thread_local LockStateTable lock_states;
+  LockState* mtx_data = nullptr;
+
+  static LockState* createCountersRef(const std::shared_mutex* mtx, std::atomic_uint64_t* version = nullptr) noexcept {
+    if(!mtx) return nullptr;
+    return lock_states.acquire(const_cast<std::shared_mutex*>(mtx), version);
   }
 
-  static void deleteCounterRef(std::map<std::shared_mutex*, Counters>::iterator it) noexcept {
-    if(it != counter_storage.cend()) {
-      if(!--it->second.wrapper_count) {
-        if(it->second.unique_lock_counter) it->first->unlock();
-        if(it->second.shared_lock_counter) it->first->unlock_shared();
-        counter_storage.erase(it);
-      }
+  // Version is bumped to odd after unique lock and back to even before unlock,
+  // so optimistic readers can detect concurrent write
+  static void beginWrite(LockState* state) noexcept {
+    if(!state->version) return;
+    state->version->fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+
+  static void endWrite(LockState* state) noexcept {
+    if(state->version) state->version->fetch_add(1, std::memory_order_release);
+  }
+
+  static void deleteCounterRef(LockState* state) noexcept {
+    if(!state || --state->counters.wrapper_count) return;
+    if(state->counters.unique_lock_counter) {
+      endWrite(state);
+      state->mtx->unlock();
     }
-    it = counter_storage.end();
+    if(state->counters.shared_lock_counter) state->mtx->unlock_shared();
+    lock_states.erase(state);
   }
 
   friend class RSMLocker;
@@ -73,8 +167,22 @@ public:
     }
   }
 
+  //! Wrapper of mutex which bumps version of guarded data on each unique lock and unlock
+  SharedRecursiveMutexWrapper(
+      const std::shared_mutex* mtx,
+      std::atomic_uint64_t* version,
+      MtxLockType lock_type = MtxLockType::unlocked) noexcept
+    : mtx_data(createCountersRef(mtx, version)) {
+    if(!mtx) std::terminate();
+    switch (lock_type) {
+    case MtxLockType::unlocked: return;
+    case MtxLockType::shared_locked: lockShared(); return;
+    case MtxLockType::unique_locked: lock(); return;
+    }
+  }
+
   SharedRecursiveMutexWrapper(const SharedRecursiveMutexWrapper& other, MtxLockType lock_type = MtxLockType::unlocked) noexcept
-    : SharedRecursiveMutexWrapper(other.mtx_data->first) {
+    : SharedRecursiveMutexWrapper(other.mtx_data->mtx) {
     switch (lock_type) {
     case MtxLockType::unlocked: return;
     case MtxLockType::shared_locked: lockShared(); return;
@@ -84,7 +192,7 @@ public:
 
   SharedRecursiveMutexWrapper(SharedRecursiveMutexWrapper&& other, MtxLockType lock_type = MtxLockType::unlocked) noexcept
     : mtx_data(other.mtx_data) {
-    other.mtx_data = counter_storage.end();
+    other.mtx_data = nullptr;
     switch (lock_type) {
     case MtxLockType::unlocked: return;
     case MtxLockType::shared_locked: lockShared(); return;
@@ -96,37 +204,39 @@ public:
 
   SharedRecursiveMutexWrapper(SharedRecursiveLock&& lock, MtxLockType lock_type = MtxLockType::unlocked);
 
-  ~SharedRecursiveMutexWrapper() { deleteCounterRef(mtx_data); mtx_data = counter_storage.end(); }
+  ~SharedRecursiveMutexWrapper() { deleteCounterRef(mtx_data); mtx_data = nullptr; }
 
-  static ui64 getWrappedMutexCount() noexcept {return counter_storage.size();}
+  static ui64 getWrappedMutexCount() noexcept {return lock_states.size();}
 
-  ui64 getUniqueLockCount() const noexcept {return mtx_data->second.unique_lock_counter;}
+  ui64 getUniqueLockCount() const noexcept {return mtx_data->counters.unique_lock_counter;}
 
-  ui64 getSheredLockCount() const noexcept {return mtx_data->second.shared_lock_counter;}
+  ui64 getSheredLockCount() const noexcept {return mtx_data->counters.shared_lock_counter;}
 
-  ui64 getThisMutexWrapperCount() const noexcept {return mtx_data->second.wrapper_count;}
+  ui64 getThisMutexWrapperCount() const noexcept {return mtx_data->counters.wrapper_count;}
 
-  std::shared_mutex& getSharedMutex() const noexcept {return *mtx_data->first;}
+  std::shared_mutex& getSharedMutex() const noexcept {return *mtx_data->mtx;}
 
   MtxLockType getLockType() const noexcept {
-    if(mtx_data->second.unique_lock_counter) return MtxLockType::unique_locked;
-    if(mtx_data->second.shared_lock_counter) return MtxLockType::shared_locked;
+    if(mtx_data->counters.unique_lock_counter) return MtxLockType::unique_locked;
+    if(mtx_data->counters.shared_lock_counter) return MtxLockType::shared_locked;
     return MtxLockType::unlocked;
   }
 
   void lock() noexcept {
     switch (getLockType()) {
     case MtxLockType::unlocked:
-      mtx_data->first->lock();
-      ++mtx_data->second.unique_lock_counter;
+      mtx_data->mtx->lock();
+      beginWrite(mtx_data);
+      ++mtx_data->counters.unique_lock_counter;
     return;
     case MtxLockType::shared_locked:
-      mtx_data->first->unlock_shared();
-      mtx_data->first->lock();
-      ++mtx_data->second.unique_lock_counter;
+      mtx_data->mtx->unlock_shared();
+      mtx_data->mtx->lock();
+      beginWrite(mtx_data);
+      ++mtx_data->counters.unique_lock_counter;
     return;
     case MtxLockType::unique_locked:
-      ++mtx_data->second.unique_lock_counter;
+      ++mtx_data->counters.unique_lock_counter;
     return;
     }
   }
@@ -134,14 +244,14 @@ public:
   void lockShared() noexcept {
     switch (getLockType()) {
     case MtxLockType::unlocked:
-      mtx_data->first->lock_shared();
-      ++mtx_data->second.shared_lock_counter;
+      mtx_data->mtx->lock_shared();
+      ++mtx_data->counters.shared_lock_counter;
     return;
     case MtxLockType::shared_locked:
-      ++mtx_data->second.shared_lock_counter;
+      ++mtx_data->counters.shared_lock_counter;
     return;
     case MtxLockType::unique_locked:
-      ++mtx_data->second.shared_lock_counter;
+      ++mtx_data->counters.shared_lock_counter;
     return;
     }
   }
@@ -151,14 +261,15 @@ public:
     case MtxLockType::unlocked:
     case MtxLockType::shared_locked: return;
     case MtxLockType::unique_locked:
-      if(!--mtx_data->second.unique_lock_counter) {
-        if(mtx_data->second.shared_lock_counter) {
+      if(!--mtx_data->counters.unique_lock_counter) {
+        endWrite(mtx_data);
+        if(mtx_data->counters.shared_lock_counter) {
 
           // "A prior unlock() operation on the same mutex synchronizes-with (as defined in std::memory_order) this operation."
           // - (C) [https://en.cppreference.com/w/cpp/thread/shared_mutex/lock_shared] 3.04.2022
-          mtx_data->first->unlock(); mtx_data->first->lock_shared();
+          mtx_data->mtx->unlock(); mtx_data->mtx->lock_shared();
 
-        } else mtx_data->first->unlock();
+        } else mtx_data->mtx->unlock();
       }
     return;
     }
@@ -168,10 +279,10 @@ public:
     switch (getLockType()) {
     case MtxLockType::unlocked: return;
     case MtxLockType::shared_locked:
-      if(!--mtx_data->second.shared_lock_counter) mtx_data->first->unlock_shared();
+      if(!--mtx_data->counters.shared_lock_counter) mtx_data->mtx->unlock_shared();
     return;
     case MtxLockType::unique_locked:
-      if(mtx_data->second.shared_lock_counter) --mtx_data->second.shared_lock_counter;
+      if(mtx_data->counters.shared_lock_counter) --mtx_data->counters.shared_lock_counter;
     return;
     }
   }
@@ -209,6 +320,9 @@ public:
   SharedRecursiveLock(const std::shared_mutex* mtx, MtxLockType lock_type)
     : SharedRecursiveMutexWrapper(const_cast<std::shared_mutex*>(mtx), lock_type), lock_type(lock_type) {}
 
+  SharedRecursiveLock(const std::shared_mutex* mtx, std::atomic_uint64_t* version, MtxLockType lock_type)
+    : SharedRecursiveMutexWrapper(const_cast<std::shared_mutex*>(mtx), version, lock_type), lock_type(lock_type) {}
+
   SharedRecursiveLock(const SharedRecursiveMutexWrapper& other, MtxLockType lock_type = MtxLockType::unlocked)
     : SharedRecursiveMutexWrapper(other, lock_type),
       lock_type(lock_type) {}
@@ -242,49 +356,60 @@ inline SharedRecursiveMutexWrapper::SharedRecursiveMutexWrapper(const SharedRecu
 inline SharedRecursiveMutexWrapper::SharedRecursiveMutexWrapper(SharedRecursiveLock&& lock, MtxLockType lock_type)
   : SharedRecursiveMutexWrapper(dynamic_cast<SharedRecursiveMutexWrapper&&>(lock), lock_type) {}
 
-//class TransactionLock {
-//  std::set<std::shared_mutex*> mtx_set;
-//  MtxLockType lock_type = MtxLockType::unique_locked;
-
-
-//public:
-//  TransactionLock(std::set<std::shared_mutex*> mtx_set, MtxLockType lock_type = MtxLockType::unique_locked)
-//    : mtx_set(std::move(mtx_set)), lock_type(lock_type) {
-//    switch (lock_type) {
-//    case shared_recursive_mtx::MtxLockType::unlocked: return;
-//    case shared_recursive_mtx::MtxLockType::shared_locked:
-//      for(SharedRecursiveMutexWrapper mtx_wr : self.mtx_set)
-//        mtx_wr.lockShared();
-//    break;
-//    case shared_recursive_mtx::MtxLockType::unique_locked:
-//      for(SharedRecursiveMutexWrapper mtx_wr : self.mtx_set)
-//        mtx_wr.lock();
-//    return;
-//    }
-//  }
-
-//  TransactionLock(TransactionLock&& other)
-//    : mtx_set(std::move(other.mtx_set)), lock_type(other.lock_type) {
-//    other.lock_type = MtxLockType::unlocked;
-//  }
-
-//  ~TransactionLock(){
-//    if(lock_type != MtxLockType::unlocked)
-//      for(SharedRecursiveMutexWrapper mtx_wr : reverse_iterator::ReverseRange(mtx_set))
-//        mtx_wr.unlock();
-//  }
-
-//};
+/**
+ * @brief TransactionLock - RAII lock of mutex set
+ *
+ * Mutexes are locked in order of their addresses, so transactions
+ * over intersecting mutex sets can't deadlock each other.
+ */
+class TransactionLock {
+public:
+  //! Mutexes with optional versions of data guarded by them, ordered by address
+  typedef std::map<std::shared_mutex*, std::atomic_uint64_t*> MutexSet;
+
+private:
+  std::vector<SharedRecursiveLock> locks;
+  MtxLockType lock_type;
+
+public:
+  TransactionLock(const MutexSet& mtx_set, MtxLockType lock_type = MtxLockType::unique_locked)
+    : lock_type(lock_type) {
+    if(lock_type == MtxLockType::unlocked) return;
+    // Reserved, so locks are never relocated
+    locks.reserve(mtx_set.size());
+    for(const auto& [mtx, version] : mtx_set)
+      locks.emplace_back(mtx, version, lock_type);
+  }
+
+  TransactionLock(TransactionLock&& other) noexcept
+    : locks(std::move(other.locks)), lock_type(other.lock_type) {
+    other.lock_type = MtxLockType::unlocked;
+  }
+
+  TransactionLock(const TransactionLock&) = delete;
+
+  ~TransactionLock() {
+    while(!locks.empty()) locks.pop_back();
+  }
+
+  MtxLockType getLockType() const noexcept {return lock_type;}
+  size_t getMutexCount() const noexcept {return locks.size();}
+};
 
 
 /// Use it in case we DON'T need multithreading
 class OptionalLockPlaceholder {
+  bool is_locked = false;
 public:
-  OptionalLockPlaceholder([[maybe_unused]] std::shared_mutex* mtx, [[maybe_unused]] MtxLockType lock_type) {}
-  OptionalLockPlaceholder([[maybe_unused]] const OptionalLockPlaceholder& other, [[maybe_unused]] MtxLockType lock_type = MtxLockType::unlocked) {}
-  OptionalLockPlaceholder([[maybe_unused]] OptionalLockPlaceholder&& other, [[maybe_unused]] MtxLockType lock_type = MtxLockType::unlocked) {}
-  constexpr operator bool() const noexcept {return true;}
-  constexpr bool has_value() const noexcept {return true;}
+  //! Placeholder of lock which can't be taken
+  constexpr OptionalLockPlaceholder() noexcept = default;
+  constexpr OptionalLockPlaceholder([[maybe_unused]] std::shared_mutex* mtx, [[maybe_unused]] MtxLockType lock_type) noexcept : is_locked(true) {}
+  constexpr OptionalLockPlaceholder(const OptionalLockPlaceholder& other, [[maybe_unused]] MtxLockType lock_type = MtxLockType::unlocked) noexcept : is_locked(other.is_locked) {}
+  constexpr OptionalLockPlaceholder(OptionalLockPlaceholder&& other, [[maybe_unused]] MtxLockType lock_type = MtxLockType::unlocked) noexcept : is_locked(other.is_locked) {}
+  //! Non-trivial like destructor of real lock, so scope-only locks aren't reported as unused
+  constexpr ~OptionalLockPlaceholder() {}
+  constexpr operator bool() const noexcept {return is_locked;}
+  constexpr bool has_value() const noexcept {return is_locked;}
 };
 
 }
@@ -292,7 +417,12 @@ public:
 namespace binom {
 using shared_recursive_mtx::MtxLockType;
 using shared_recursive_mtx::SharedRecursiveLock;
+#ifdef BINOM_SINGLE_THREAD
+// Variables are accessed by one thread only, see THREAD_POLICY in makefile
+typedef shared_recursive_mtx::OptionalLockPlaceholder OptionalSharedRecursiveLock;
+#else
 typedef std::optional<shared_recursive_mtx::SharedRecursiveLock> OptionalSharedRecursiveLock;
+#endif
 }
 
 #endif // SHARED_RECURSIVE_MUTEX_WRAPPER_HXX
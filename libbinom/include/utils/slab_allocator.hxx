@@ -0,0 +1,282 @@
+#ifndef SLAB_ALLOCATOR_HXX
+#define SLAB_ALLOCATOR_HXX
+
+#include "type_aliases.hxx"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace slab_allocator {
+using namespace type_alias;
+
+/**
+ * Pool of equally sized blocks carved from slabs
+ *
+ * Freed blocks are kept in intrusive free list and reused by next allocations.
+ * Slabs are returned to system only by release() or destruction of pool,
+ * so container dropping all its nodes makes one deallocation per slab instead of one per node.
+ * Slab capacity doubles up to max_slab_block_count, so small containers don't waste memory.
+ * Slabs can be shared by pools, then each pool keeps its own free blocks and slabs are freed
+ * when the last pool sharing them is released. Slabs are kept whole while any pool shares them,
+ * so blocks of objects of released pools stay unused until owner moves its objects to new pool
+ * (see MapImplementation::shrinkToFit), hasReleasedShares() and getBlockCount() tell when it's worth it.
+ */
+class SlabPool {
+  struct Slab {Slab* next;};
+  struct FreeBlock {FreeBlock* next;};
+
+  //! Slabs owned together by pools which share them
+  class SharedSlabs {
+    Slab* slabs;
+  public:
+    const size_t block_count;
+    SharedSlabs(Slab* slabs, size_t block_count) noexcept : slabs(slabs), block_count(block_count) {}
+    SharedSlabs(const SharedSlabs&) = delete;
+    SharedSlabs& operator=(const SharedSlabs&) = delete;
+    ~SharedSlabs() {freeSlabs(slabs);}
+  };
+
+  static constexpr size_t first_slab_block_count = 8;
+  static constexpr size_t max_slab_block_count = 1024;
+  static constexpr size_t slab_header_size = alignof(std::max_align_t);
+  static_assert(sizeof(Slab) <= slab_header_size);
+
+  size_t element_size = 0;
+  size_t block_size = 0;
+  size_t slab_block_count = first_slab_block_count;
+  //! Count of blocks in slabs owned by this pool only
+  size_t owned_block_count = 0;
+  Slab* slabs = nullptr;
+  FreeBlock* free_blocks = nullptr;
+  byte* slab_position = nullptr;
+  byte* slab_end = nullptr;
+  //! Slabs shared with other pools, shared_ptr counts owners atomically, so pools may be released by different threads
+  std::vector<std::shared_ptr<SharedSlabs>> shared_slabs;
+
+  static void freeSlabs(Slab* slabs) noexcept {
+    while(slabs) {
+      Slab* next = slabs->next;
+      ::operator delete(slabs);
+      slabs = next;
+    }
+  }
+
+  void addSlab() {
+    Slab* slab = static_cast<Slab*>(::operator new(slab_header_size + slab_block_count * block_size));
+    slab->next = slabs;
+    slabs = slab;
+    slab_position = reinterpret_cast<byte*>(slab) + slab_header_size;
+    slab_end = slab_position + slab_block_count * block_size;
+    owned_block_count += slab_block_count;
+    if(slab_block_count < max_slab_block_count) slab_block_count *= 2;
+  }
+
+public:
+  SlabPool() = default;
+  SlabPool(size_t element_size, size_t element_alignment = alignof(std::max_align_t)) noexcept {
+    initialize(element_size, element_alignment);
+  }
+  SlabPool(const SlabPool&) = delete;
+  SlabPool(SlabPool&& other) noexcept
+    : element_size(other.element_size), block_size(other.block_size), slab_block_count(other.slab_block_count),
+      owned_block_count(other.owned_block_count), slabs(other.slabs), free_blocks(other.free_blocks),
+      slab_position(other.slab_position), slab_end(other.slab_end), shared_slabs(std::move(other.shared_slabs)) {
+    other.slabs = nullptr;
+    other.release();
+  }
+  ~SlabPool() {release();}
+
+  SlabPool& operator=(const SlabPool&) = delete;
+
+  //! Sets size of blocks, pool must not have allocated blocks
+  void initialize(size_t size, size_t alignment = alignof(std::max_align_t)) noexcept {
+    element_size = size;
+    if(size < sizeof(FreeBlock)) size = sizeof(FreeBlock);
+    if(alignment < alignof(FreeBlock)) alignment = alignof(FreeBlock);
+    block_size = (size + alignment - 1) / alignment * alignment;
+  }
+
+  //! Size passed to initialize, 0 if pool isn't initialized
+  size_t getElementSize() const noexcept {return element_size;}
+
+  //! Count of blocks in slabs kept by pool, including slabs shared with other pools
+  size_t getBlockCount() const noexcept {
+    size_t block_count = owned_block_count;
+    for(const std::shared_ptr<SharedSlabs>& shared : shared_slabs) block_count += shared->block_count;
+    return block_count;
+  }
+
+  bool isShared() const noexcept {return !shared_slabs.empty();}
+
+  //! True if other pools sharing some slabs with this one are released, so blocks of their objects are unused
+  bool hasReleasedShares() const noexcept {
+    return std::any_of(shared_slabs.begin(), shared_slabs.end(),
+                       [](const std::shared_ptr<SharedSlabs>& shared) {return shared.use_count() == 1;});
+  }
+
+  void* allocate() {
+    if(free_blocks) {
+      FreeBlock* block = free_blocks;
+      free_blocks = block->next;
+      return block;
+    }
+    if(slab_position == slab_end) addSlab();
+    void* block = slab_position;
+    slab_position += block_size;
+    return block;
+  }
+
+  void deallocate(void* block) noexcept {
+    FreeBlock* free_block = static_cast<FreeBlock*>(block);
+    free_block->next = free_blocks;
+    free_blocks = free_block;
+  }
+
+  //! Reserves place for shared slabs of other pool, so next merge with it doesn't allocate
+  void reserveMerge(const SlabPool& other) {shared_slabs.reserve(shared_slabs.size() + other.shared_slabs.size());}
+
+  //! Takes slabs and free blocks of other pool with the same block size, so blocks of other pool
+  //! can be deallocated to this one, other pool is left empty.
+  //! Allocates only if both pools have shared slabs, which are kept once, and reserveMerge wasn't called
+  void merge(SlabPool& other) {
+    if(this == &other) return;
+    if(!block_size) {
+      element_size = other.element_size;
+      block_size = other.block_size;
+    }
+    if(!other.shared_slabs.empty()) {
+      shared_slabs.insert(shared_slabs.end(), other.shared_slabs.begin(), other.shared_slabs.end());
+      std::sort(shared_slabs.begin(), shared_slabs.end());
+      shared_slabs.erase(std::unique(shared_slabs.begin(), shared_slabs.end()), shared_slabs.end());
+      other.shared_slabs.clear();
+    }
+    // Unused rest of current slab of other pool is kept as free blocks
+    for(; other.slab_position != other.slab_end; other.slab_position += block_size) other.deallocate(other.slab_position);
+    if(other.slabs) {
+      Slab* last_slab = other.slabs;
+      while(last_slab->next) last_slab = last_slab->next;
+      last_slab->next = slabs;
+      slabs = other.slabs;
+    }
+    owned_block_count += other.owned_block_count;
+    other.owned_block_count = 0;
+    if(other.free_blocks) {
+      FreeBlock* last_block = other.free_blocks;
+      while(last_block->next) last_block = last_block->next;
+      last_block->next = free_blocks;
+      free_blocks = other.free_blocks;
+    }
+    other.slabs = nullptr;
+    other.free_blocks = nullptr;
+    other.slab_position = other.slab_end = nullptr;
+  }
+
+  //! Other pool becomes co-owner of slabs of this one, so blocks of this pool can be deallocated to other one
+  //! without move of their objects. Free blocks and rest of current slab stay with this pool,
+  //! slabs are freed when both pools are released. Linear in count of slab sets shared before
+  void share(SlabPool& other) {
+    if(this == &other) return;
+    if(!other.block_size) {
+      other.element_size = element_size;
+      other.block_size = block_size;
+    }
+    shared_slabs.reserve(shared_slabs.size() + 1);
+    other.shared_slabs.reserve(other.shared_slabs.size() + shared_slabs.size() + 1);
+    if(slabs) {
+      shared_slabs.push_back(std::make_shared<SharedSlabs>(slabs, owned_block_count));
+      slabs = nullptr;
+      owned_block_count = 0;
+    }
+    other.shared_slabs.insert(other.shared_slabs.end(), shared_slabs.begin(), shared_slabs.end());
+  }
+
+  void swap(SlabPool& other) noexcept {
+    std::swap(element_size, other.element_size);
+    std::swap(block_size, other.block_size);
+    std::swap(slab_block_count, other.slab_block_count);
+    std::swap(owned_block_count, other.owned_block_count);
+    std::swap(slabs, other.slabs);
+    std::swap(free_blocks, other.free_blocks);
+    std::swap(slab_position, other.slab_position);
+    std::swap(slab_end, other.slab_end);
+    shared_slabs.swap(other.shared_slabs);
+  }
+
+  //! Frees all slabs at once, objects in blocks have to be destroyed before
+  void release() noexcept {
+    freeSlabs(slabs);
+    slabs = nullptr;
+    owned_block_count = 0;
+    shared_slabs.clear();
+    free_blocks = nullptr;
+    slab_position = slab_end = nullptr;
+    slab_block_count = first_slab_block_count;
+  }
+
+};
+
+/**
+ * Standard allocator of single objects from shared SlabPool
+ *
+ * Copies and rebinds of allocator share pool, but container copy gets new pool.
+ * Allocations of arrays and of types with another size go to operator new.
+ */
+template<typename T>
+class Allocator {
+  std::shared_ptr<SlabPool> pool;
+  template<typename U> friend class Allocator;
+  static_assert(alignof(T) <= alignof(std::max_align_t));
+
+public:
+  typedef T value_type;
+  typedef std::true_type propagate_on_container_move_assignment;
+  typedef std::true_type propagate_on_container_swap;
+  typedef std::false_type is_always_equal;
+
+  Allocator() : pool(std::make_shared<SlabPool>()) {}
+  Allocator(const Allocator& other) noexcept = default;
+  template<typename U>
+  Allocator(const Allocator<U>& other) noexcept : pool(other.pool) {}
+
+  Allocator& operator=(const Allocator& other) noexcept = default;
+
+  Allocator select_on_container_copy_construction() const {return Allocator();}
+
+  T* allocate(size_t count) {
+    if(count == 1) {
+      if(!pool->getElementSize()) pool->initialize(sizeof(T), alignof(T));
+      if(pool->getElementSize() == sizeof(T)) return static_cast<T*>(pool->allocate());
+    }
+    return static_cast<T*>(::operator new(count * sizeof(T)));
+  }
+
+  void deallocate(T* pointer, size_t count) noexcept {
+    if(count == 1 && pool->getElementSize() == sizeof(T)) pool->deallocate(pointer);
+    else ::operator delete(pointer);
+  }
+
+  //! Frees all slabs of pool at once, all objects allocated by pool have to be destroyed before
+  void release() noexcept {pool->release();}
+
+  //! Makes next merge with other allocator non-throwing, so it can follow changes which can't be undone
+  void reserveMerge(const Allocator& other) {pool->reserveMerge(*other.pool);}
+
+  //! Takes slabs of pool of other allocator, so objects allocated by other allocator can be deallocated by this one,
+  //! may allocate if both pools have shared slabs and reserveMerge wasn't called
+  void merge(Allocator& other) {pool->merge(*other.pool);}
+
+  template<typename U>
+  bool operator==(const Allocator<U>& other) const noexcept {return pool == other.pool;}
+  template<typename U>
+  bool operator!=(const Allocator<U>& other) const noexcept {return pool != other.pool;}
+
+};
+
+}
+
+#endif // SLAB_ALLOCATOR_HXX
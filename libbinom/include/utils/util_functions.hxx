@@ -49,6 +49,8 @@ void doRightShift(T* arr, size_t size, size_t shift) noexcept {
   std::fill(arr + limit + 1, arr + size, static_cast<T>(0));
 }
 
+//! Block sizes of growable arrays are rounded up by it, so block size at least doubles on each
+//! reallocation: appending n elements relocates O(n) bytes in total and is amortized O(1)
 constexpr size_t getNearestPow2(size_t num) noexcept {
   num--;
   num |= num >> 1;
@@ -14,6 +14,7 @@ class Array : public Variable {
   operator List& () = delete;
   operator Map& () = delete;
   operator MultiMap& () = delete;
+  operator HashMap& () = delete;
 
   Number& toNumber() = delete;
   BitArray& toBitArray() = delete;
@@ -22,6 +23,7 @@ class Array : public Variable {
   List& toList() = delete;
   Map& toMap() = delete;
   MultiMap& toMultiMap() = delete;
+  HashMap& toHashMap() = delete;
 
   operator const Number& () const = delete;
   operator const BitArray& () const = delete;
@@ -29,6 +31,7 @@ class Array : public Variable {
   operator const List& () const = delete;
   operator const Map& () const = delete;
   operator const MultiMap& () const = delete;
+  operator const HashMap& () const = delete;
 
   const Number& toNumber() const = delete;
   const BitArray& toBitArray() const = delete;
@@ -37,6 +40,7 @@ class Array : public Variable {
   const List& toList() const = delete;
   const Map& toMap() const = delete;
   const MultiMap& toMultiMap() const = delete;
+  const HashMap& toHashMap() const = delete;
 
   Variable& operator=(const Variable& other) = delete;
   Variable& operator=(Variable&& other) = delete;
@@ -60,13 +64,21 @@ public:
   Array(const Array& other) noexcept;
   Array(const Array&& other) noexcept;
 
+  //! Creates array of count null elements
+  static Array nulls(size_t count);
+
   Array move() noexcept;
   const Array move() const noexcept;
 
   size_t getElementCount() const noexcept;
   size_t getCapacity() const noexcept;
+  //! Count of elements, which fit in allocated memory without reallocation
+  size_t getElementCapacity() const noexcept;
   size_t getSize() const noexcept;
 
+  void reserve(size_t count);
+  void shrinkToFit();
+
   Variable pushBack(Variable variable);
   Iterator pushBack(const literals::arr variable_list);
 
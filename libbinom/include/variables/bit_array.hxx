@@ -13,6 +13,7 @@ class BitArray : public Variable {
   operator List& () = delete;
   operator Map& () = delete;
   operator MultiMap& () = delete;
+  operator HashMap& () = delete;
 
   Number& toNumber() = delete;
   BitArray& toBitArray() = delete;
@@ -21,6 +22,7 @@ class BitArray : public Variable {
   List& toList() = delete;
   Map& toMap() = delete;
   MultiMap& toMultiMap() = delete;
+  HashMap& toHashMap() = delete;
 
   operator const Number& () const = delete;
   operator const BufferArray& () const = delete;
@@ -28,6 +30,7 @@ class BitArray : public Variable {
   operator const List& () const = delete;
   operator const Map& () const = delete;
   operator const MultiMap& () const = delete;
+  operator const HashMap& () const = delete;
 
   const Number& toNumber() const = delete;
   const BitArray& toBitArray() const = delete;
@@ -36,6 +39,7 @@ class BitArray : public Variable {
   const List& toList() const = delete;
   const Map& toMap() const = delete;
   const MultiMap& toMultiMap() const = delete;
+  const HashMap& toHashMap() const = delete;
 
   Variable& operator=(const Variable& other) = delete;
   Variable& operator=(Variable&& other) = delete;
@@ -63,12 +67,20 @@ public:
   BitArray(const BitArray& other) noexcept;
   BitArray(const BitArray&& other) noexcept;
 
+  //! Creates bit array of bit_count bits set to 0
+  static BitArray zeroed(size_t bit_count);
+
   BitArray move() noexcept;
   const BitArray move() const noexcept;
 
   size_t getElementCount() const noexcept;
   size_t getSize() const noexcept;
   size_t getCapacity() const noexcept;
+  //! Count of bits, which fit in allocated memory without reallocation
+  size_t getElementCapacity() const noexcept;
+
+  void reserve(size_t bit_count);
+  void shrinkToFit();
 
   ValueRef operator[] (size_t index);
   const ValueRef operator[] (size_t index) const;
@@ -13,6 +13,7 @@ class BufferArray : public Variable {
   operator List& () = delete;
   operator Map& () = delete;
   operator MultiMap& () = delete;
+  operator HashMap& () = delete;
 
   Number& toNumber() = delete;
   BitArray& toBitArray() = delete;
@@ -21,6 +22,7 @@ class BufferArray : public Variable {
   List& toList() = delete;
   Map& toMap() = delete;
   MultiMap& toMultiMap() = delete;
+  HashMap& toHashMap() = delete;
 
   operator const Number& () const = delete;
   operator const BitArray& () const = delete;
@@ -28,6 +30,7 @@ class BufferArray : public Variable {
   operator const List& () const = delete;
   operator const Map& () const = delete;
   operator const MultiMap& () const = delete;
+  operator const HashMap& () const = delete;
 
   const Number& toNumber() const = delete;
   const BitArray& toBitArray() const = delete;
@@ -36,6 +39,7 @@ class BufferArray : public Variable {
   const List& toList() const = delete;
   const Map& toMap() const = delete;
   const MultiMap& toMultiMap() const = delete;
+  const HashMap& toHashMap() const = delete;
 
   Variable& operator=(const Variable& other) = delete;
   Variable& operator=(Variable&& other) = delete;
@@ -43,7 +47,7 @@ class BufferArray : public Variable {
   Variable& changeLink(const Variable& other) = delete;
   Variable& changeLink(Variable&& other) = delete;
 
-  priv::BufferArrayImplementation*& getData() const noexcept;
+  priv::BufferArrayStorage& getData() const noexcept;
 
   BufferArray(priv::Link&& link);
 
@@ -73,12 +77,20 @@ public:
   BufferArray(const BufferArray& other) noexcept;
   BufferArray(const BufferArray&& other) noexcept;
 
+  //! Creates buffer array of type with count zero elements
+  static BufferArray zeroed(VarType type, size_t count);
+
   BufferArray move() noexcept;
   const BufferArray move() const noexcept;
 
   size_t getElementCount() const noexcept;
   size_t getSize() const noexcept;
   size_t getCapacity() const noexcept;
+  //! Count of elements, which fit in allocated memory without reallocation
+  size_t getElementCapacity() const noexcept;
+
+  void reserve(size_t count);
+  void shrinkToFit();
 
   ValueRef operator[](size_t index) noexcept;
   const ValueRef operator[](size_t index) const noexcept;
@@ -0,0 +1,150 @@
+#ifndef FILE_STORAGE_HXX
+#define FILE_STORAGE_HXX
+
+#include "variable.hxx"
+#include "generic_value.hxx"
+#include "key_value.hxx"
+#include "../binom_impl/file_storage_implementation.hxx"
+
+#include <memory>
+
+namespace binom {
+
+/**
+ * @brief Handle of node stored in FileStorage
+ *
+ * Only the node index is held in memory, data is read from file on access.
+ * Handle becomes invalid when its node is removed from storage
+ * (by removing element of parent container or by FileStorage::setRoot):
+ * container handle remembers generation of its node, so access through it throws
+ * binom_resource_not_available even if node pages are reused by new node.
+ */
+class FileVariable {
+protected:
+  std::shared_ptr<priv::FileStorageImplementation> storage;
+  priv::FileResourceIndex index;
+  ui64 generation = 0;
+
+  //! Must be called under storage lock
+  FileVariable(std::shared_ptr<priv::FileStorageImplementation> storage, priv::FileResourceIndex index);
+
+  //! Throws binom_resource_not_available if node was removed
+  SharedRecursiveLock getLock(MtxLockType lock_type) const;
+
+  friend class FileStorage;
+  friend class FileArray;
+  friend class FileMap;
+public:
+  FileVariable() noexcept = default;
+  FileVariable(const FileVariable& other) noexcept = default;
+  FileVariable& operator=(const FileVariable& other) noexcept = default;
+
+  //! False for empty handle and handle of removed node
+  bool isValid() const noexcept;
+  inline explicit operator bool() const noexcept {return isValid();}
+
+  inline VarType getType() const noexcept {return index.type;}
+  inline VarTypeClass getTypeClass() const noexcept {return toTypeClass(index.type);}
+  inline ValType getValType() const noexcept {return toValueType(index.type);}
+  inline VarBitWidth getBitWidth() const noexcept {return toBitWidth(index.type);}
+  size_t getElementCount() const;
+
+  GenericValue toNumber() const;
+  FileBufferArray toBufferArray() const;
+  FileArray toArray() const;
+  FileMap toMap() const;
+
+  //! Loads node into memory
+  Variable toVariable() const;
+};
+
+class FileBufferArray : public FileVariable {
+  FileBufferArray(const FileVariable& variable);
+  friend class FileVariable;
+public:
+  //! Reads count elements starting from at
+  void read(size_t at, void* to, size_t count) const;
+  GenericValue operator[](size_t index) const;
+
+  void insert(size_t at, const void* data, size_t count);
+  void pushBack(const void* data, size_t count);
+  void remove(size_t at, size_t count = 1);
+};
+
+//! Array or list stored in file
+class FileArray : public FileVariable {
+  FileArray(const FileVariable& variable);
+  friend class FileVariable;
+public:
+  FileVariable operator[](size_t index) const;
+
+  void insert(size_t at, const Variable& variable);
+  void pushBack(const Variable& variable);
+  void remove(size_t at, size_t count = 1);
+};
+
+/**
+ * @brief Map or multimap stored in file, elements are sorted by key
+ *
+ * Element index is its position in key order, so it shifts on insert or remove of lower keys,
+ * while value handles stay bound to their nodes.
+ */
+class FileMap : public FileVariable {
+  FileMap(const FileVariable& variable);
+  friend class FileVariable;
+public:
+  KeyValue getKey(size_t index) const;
+  FileVariable getValue(size_t index) const;
+
+  //! Index of (first) element with given key or getElementCount() if not found
+  size_t find(const KeyValue& key) const;
+  bool contains(const KeyValue& key) const;
+  //! Value of (first) element with given key or invalid handle if not found
+  FileVariable operator[](const KeyValue& key) const;
+
+  //! Throws binom_key_unique_error if map already contains key
+  FileVariable insert(const KeyValue& key, const Variable& variable);
+  //! Removes all elements with given key, returns count of removed elements
+  size_t remove(const KeyValue& key);
+  //! Moves elements with old key to new key, returns count of renamed elements
+  size_t rename(const KeyValue& old_key, const KeyValue& new_key);
+};
+
+/**
+ * @brief Disk-backed BinOM storage
+ *
+ * Stores one root Variable in paged file, containers are modified in place
+ * page by page, so memory use doesn't depend on size of stored data.
+ * Pages are cached in memory up to cache_size bytes.
+ * With journal enabled storage survives crashes: modifications are logged
+ * to "<path>.wal" and replayed on next open.
+ */
+class FileStorage {
+  std::shared_ptr<priv::FileStorageImplementation> storage;
+public:
+  //! Opens existing storage file or creates new one, page_size is used only for new file
+  FileStorage(const std::string& path, ui32 page_size = priv::PagedFile::default_page_size,
+              size_t cache_size = default_cache_size, CacheEvictionPolicy policy = CacheEvictionPolicy::clock,
+              JournalConfig journal_config = JournalConfig());
+
+  FileVariable getRoot() const;
+  //! Replaces stored data, all previously obtained handles become invalid
+  FileVariable setRoot(const Variable& variable);
+
+  //! Makes all logged modifications durable without checkpoint
+  void commit();
+  //! Writes all modifications to data file and flushes it to disk (checkpoint)
+  void sync();
+
+  size_t getPageSize() const noexcept;
+  size_t getPageCount() const noexcept;
+  size_t getUsedPageCount() const;
+
+  CacheStatistics getCacheStatistics() const;
+  void resetCacheStatistics();
+  size_t getJournalSyncCount() const;
+};
+
+}
+
+#endif // FILE_STORAGE_HXX
@@ -33,6 +33,10 @@ class GenericValue :
   friend class Number;
   friend class GenericValueRef;
   friend class KeyValue;
+  friend class View;
+  friend class ViewMap;
+  friend class FileVariable;
+  friend class FileBufferArray;
 
   GenericValue(ValType type, arithmetic::ArithmeticData data);
 
@@ -87,6 +91,7 @@ class GenericValueRef :
   friend class Number;
   friend class BufferArray;
   friend class priv::BufferArrayImplementation;
+  friend class ViewBufferArray;
 
   GenericValueRef(ValType value_type, void* ptr);
 public:
@@ -121,6 +126,8 @@ class GenericValueIterator {
 
   friend class BufferArray;
   friend class priv::BufferArrayImplementation;
+  friend class ViewBufferArray;
+  friend class KeyValue;
 
   GenericValueIterator(ValType value_type, void* ptr);
 public:
@@ -0,0 +1,105 @@
+#ifndef HASH_MAP_HXX
+#define HASH_MAP_HXX
+
+#include "named_variable.hxx"
+
+namespace binom {
+
+//! Map with unordered elements and lookup by key hash
+class HashMap : public Variable {
+  operator Number& () = delete;
+  operator BitArray& () = delete;
+  operator BufferArray& () = delete;
+  operator Array& () = delete;
+  operator List& () = delete;
+  operator Map& () = delete;
+  operator MultiMap& () = delete;
+
+  Number& toNumber() = delete;
+  BitArray& toBitArray() = delete;
+  BufferArray& toBufferArray() = delete;
+  Array& toArray() = delete;
+  List& toList() = delete;
+  Map& toMap() = delete;
+  MultiMap& toMultiMap() = delete;
+  HashMap& toHashMap() = delete;
+
+  operator const Number& () const = delete;
+  operator const BitArray& () const = delete;
+  operator const BufferArray& () const = delete;
+  operator const Array& () const = delete;
+  operator const List& () const = delete;
+  operator const Map& () const = delete;
+  operator const MultiMap& () const = delete;
+
+  const Number& toNumber() const = delete;
+  const BitArray& toBitArray() const = delete;
+  const BufferArray& toBufferArray() const = delete;
+  const Array& toArray() const = delete;
+  const List& toList() const = delete;
+  const Map& toMap() const = delete;
+  const MultiMap& toMultiMap() const = delete;
+  const HashMap& toHashMap() const = delete;
+
+  Variable& operator=(const Variable& other) = delete;
+  Variable& operator=(Variable&& other) = delete;
+
+  Variable& changeLink(const Variable& other) = delete;
+  Variable& changeLink(Variable&& other) = delete;
+
+  priv::HashMapImplementation* getData();
+  const priv::HashMapImplementation* getData() const;
+
+  friend class Variable;
+  HashMap(priv::Link&& link);
+
+public:
+  using NamedVariable = binom::priv::HashMapImplementation::NamedVariable;
+  typedef priv::HashMapImplementation::Iterator      Iterator;
+  typedef priv::HashMapImplementation::ConstIterator ConstIterator;
+
+  HashMap();
+  HashMap(literals::hashmap element_list);
+  HashMap(const HashMap& other);
+  HashMap(HashMap&& other);
+
+  HashMap move() noexcept;
+  const HashMap move() const noexcept;
+
+  bool isEmpty() const noexcept;
+  size_t getElementCount() const noexcept;
+  bool contains(KeyValue value) const noexcept;
+
+  void clear();
+  void reserve(size_t count);
+  err::ProgressReport<NamedVariable> insert(KeyValue key, Variable variable);
+  err::Error remove(KeyValue key);
+
+  Variable getVariable(KeyValue key);
+  const Variable getVariable(KeyValue key) const;
+  Variable operator[] (KeyValue key);
+  const Variable operator[] (KeyValue key) const;
+
+  Iterator find(KeyValue key);
+  ConstIterator find(KeyValue key) const;
+
+  Iterator begin();
+  Iterator end();
+
+  ConstIterator begin() const noexcept;
+  ConstIterator end() const noexcept;
+
+  ConstIterator cbegin() const noexcept;
+  ConstIterator cend() const noexcept;
+
+  HashMap& operator=(const HashMap& other);
+  HashMap& operator=(HashMap&& other);
+
+  HashMap& changeLink(const HashMap& other);
+  HashMap& changeLink(HashMap&& other);
+
+};
+
+}
+
+#endif // HASH_MAP_HXX
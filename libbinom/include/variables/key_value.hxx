@@ -4,8 +4,14 @@
 #include "../binom_impl/types.hxx"
 #include "generic_value.hxx"
 
+#include <vector>
+
 namespace binom {
 
+namespace priv {
+struct InternedKey;
+}
+
 class KeyValue {
 public:
 
@@ -17,6 +23,8 @@ public:
 
 private:
 
+  //! Buffer array data of up to inline_capacity bytes is kept in key without allocation
+  static constexpr size_t inline_capacity = 16;
 
   union Data {
     void* pointer = nullptr;
@@ -34,12 +42,25 @@ private:
     f64   f64_val;
 
     priv::BitArrayImplementation* bit_array_implementation;
-    priv::BufferArrayImplementation* buffer_array_implementation;
+    priv::BufferArrayStorage buffer_array_storage;
+    priv::InternedKey* interned_key;
+    byte inline_data[inline_capacity];
   };
 
   VarKeyType type = VarKeyType::null;
+  bool is_inline = false;
+  bool is_interned = false;
+  ui8 inline_size = 0;
   Data data;
 
+  //! Sets up storage of size bytes for buffer array data and returns it for filling
+  void* allocateBuffer(size_t size);
+  const byte* getBufferData() const noexcept;
+  size_t getBufferSize() const noexcept;
+
+  friend class Variable;
+  friend class ViewMap;
+
 public:
 
   KeyValue() = default;
@@ -101,7 +122,30 @@ public:
   size_t getElementCount() const noexcept;
   size_t getElementSize() const noexcept;
 
+  //! Moves buffer array data to global table, so equal interned keys share one immutable copy
+  //! and are compared by pointer. Short keys are kept inline and stay unchanged
+  KeyValue& intern();
+  bool isInterned() const noexcept;
+  //! Count of distinct buffers in interning table
+  static size_t getInternedCount();
+
+  //! Numbers of all types are compared by exact value, NaN follows all other numbers and equals itself,
+  //! keys of equal values are ordered by type
   CompareResult getCompare(KeyValue& other) const;
+  //! Bytes ordered by memcmp exactly as keys by getCompare, for external consumers like on-disk indexes.
+  //! Each number takes 10 bytes, so RAM containers compare keys directly instead of caching their encodings
+  std::vector<byte> getComparableEncoding() const;
+  //! Appends encoding to buffer, so search with one key reuses its allocation
+  void appendComparableEncoding(std::vector<byte>& encoding) const;
+  //! First bytes of normalized key for search in RAM containers: lower prefix means lower key by getCompare,
+  //! keys with equal prefixes have to be compared by getCompare. Elements of buffer arrays take one byte each,
+  //! so prefixes of strings of ASCII characters keep up to 7 of them
+  ui64 getComparablePrefix() const noexcept;
+  //! Key of encoding, throws invalid_data for malformed encoding.
+  //! Zeros and NaNs are encoded as one value each, so they are restored as +0.0 and quiet NaN
+  static KeyValue fromComparableEncoding(const byte* encoding, size_t size);
+  //! Equal keys have equal hashes
+  size_t getHash() const noexcept;
   inline bool operator == (KeyValue value) const {return getCompare(value) == CompareResult::equal;}
   inline bool operator != (KeyValue value) const {return getCompare(value) != CompareResult::equal;}
   inline bool operator < (KeyValue value) const {return getCompare(value) == CompareResult::lower;}
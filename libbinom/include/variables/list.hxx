@@ -13,6 +13,7 @@ class List : public Variable {
   operator Array& () = delete;
   operator Map& () = delete;
   operator MultiMap& () = delete;
+  operator HashMap& () = delete;
 
   Number& toNumber() = delete;
   BitArray& toBitArray() = delete;
@@ -21,6 +22,7 @@ class List : public Variable {
   List& toList() = delete;
   Map& toMap() = delete;
   MultiMap& toMultiMap() = delete;
+  HashMap& toHashMap() = delete;
 
   operator const Number& () const = delete;
   operator const BitArray& () const = delete;
@@ -28,6 +30,7 @@ class List : public Variable {
   operator const Array& () const = delete;
   operator const Map& () const = delete;
   operator const MultiMap& () const = delete;
+  operator const HashMap& () const = delete;
 
   const Number& toNumber() const = delete;
   const BitArray& toBitArray() const = delete;
@@ -35,6 +38,7 @@ class List : public Variable {
   const Array& toArray() const = delete;
   const Map& toMap() const = delete;
   const MultiMap& toMultiMap() const = delete;
+  const HashMap& toHashMap() const = delete;
 
   Variable& operator=(const Variable& other) = delete;
   Variable& operator=(Variable&& other) = delete;
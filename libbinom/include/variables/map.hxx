@@ -5,6 +5,9 @@
 
 namespace binom {
 
+//! Iterators and element references of map stay valid until element is removed as with std::map,
+//! split leaves elements in place. Map left by released part of split moves its elements
+//! by split, join or shrinkToFit if they take less than quarter of its memory, which invalidates them
 class Map : public Variable {
   operator Number& () = delete;
   operator BitArray& () = delete;
@@ -12,6 +15,7 @@ class Map : public Variable {
   operator Array& () = delete;
   operator List& () = delete;
   operator MultiMap& () = delete;
+  operator HashMap& () = delete;
 
   Number& toNumber() = delete;
   BitArray& toBitArray() = delete;
@@ -20,6 +24,7 @@ class Map : public Variable {
   List& toList() = delete;
   Map& toMap() = delete;
   MultiMap& toMultiMap() = delete;
+  HashMap& toHashMap() = delete;
 
   operator const Number& () const = delete;
   operator const BitArray& () const = delete;
@@ -27,6 +32,7 @@ class Map : public Variable {
   operator const Array& () const = delete;
   operator const List& () const = delete;
   operator const MultiMap& () const = delete;
+  operator const HashMap& () const = delete;
 
   const Number& toNumber() const = delete;
   const BitArray& toBitArray() const = delete;
@@ -35,6 +41,7 @@ class Map : public Variable {
   const List& toList() const = delete;
   const Map& toMap() const = delete;
   const MultiMap& toMultiMap() const = delete;
+  const HashMap& toHashMap() const = delete;
 
   Variable& operator=(const Variable& other) = delete;
   Variable& operator=(Variable&& other) = delete;
@@ -82,6 +89,25 @@ public:
   ConstIterator find(KeyValue key) const;
   ConstReverseIterator rfind(KeyValue key) const;
 
+  //! Element of index in key order or end, O(log n)
+  Iterator select(size_t index);
+  ConstIterator select(size_t index) const;
+  //! Count of keys lower than key, O(log n)
+  size_t rank(KeyValue key) const;
+  //! Count of keys from first up to but not including last, O(log n)
+  size_t countRange(KeyValue first, KeyValue last) const;
+
+  //! Moves elements with keys not lower than key to returned map, O(log n),
+  //! both maps share memory of elements until both are released
+  Map split(KeyValue key);
+  //! Moves all elements of other map to this one if all their keys are higher or all are lower than keys of this map,
+  //! O(log n), returns invalid_data and leaves maps unchanged otherwise
+  err::Error join(Map& other);
+  //! Removes elements with keys from first up to but not including last, returns their count, O(log n) plus their destruction
+  size_t eraseRange(KeyValue first, KeyValue last);
+  //! Moves elements to own memory in O(n) if released part of split left them less than quarter of it
+  void shrinkToFit();
+
   Iterator begin();
   Iterator end();
 
@@ -0,0 +1,53 @@
+#ifndef MAPPED_STORAGE_HXX
+#define MAPPED_STORAGE_HXX
+
+#include "variable.hxx"
+#include "view.hxx"
+#include "../binom_impl/file_storage_implementation/mapped_file.hxx"
+
+#include <string>
+
+namespace binom {
+
+/**
+ * @brief Read-only storage memory mapped from file written by MappedStorage::write
+ *
+ * Opening maps the file without reading it. Nodes of root variable are materialized
+ * from mapping on first access, untouched subtrees cost no heap.
+ * Changes of root variable aren't written back to file, use write() to save them.
+ * Mapping is unmapped when storage and all not materialized nodes are destroyed.
+ * Corrupted node can't be materialized, it's reported unavailable like destroyed variable
+ * and materialize() throws invalid_data for it.
+ */
+class MappedStorage {
+  priv::MappedFile* file = nullptr;
+  Variable root;
+
+public:
+  MappedStorage(const std::string& path);
+  MappedStorage(const MappedStorage& other) noexcept;
+  MappedStorage(MappedStorage&& other) noexcept;
+  ~MappedStorage();
+
+  //! Reference to lazily materialized root variable
+  Variable getRoot() noexcept;
+  //! Zero-copy view of file data, valid while storage exists
+  View getView() const;
+
+  size_t getFileSize() const noexcept;
+  //! Count of container nodes decoded from mapping
+  size_t getMaterializedNodeCount() const noexcept;
+  //! Count of failed materializations of corrupted nodes
+  size_t getErrorCount() const noexcept;
+  //! Checks encoding of whole file (reads all of it)
+  bool verify() const;
+  //! Materializes node of mapped file, throws invalid_data if it's corrupted
+  static void materialize(const Variable& node);
+
+  //! Writes variable in indexed format, file is replaced atomically
+  static void write(const std::string& path, const Variable& variable);
+};
+
+}
+
+#endif // MAPPED_STORAGE_HXX
@@ -12,6 +12,7 @@ class MultiMap : public Variable {
   operator Array& () = delete;
   operator List& () = delete;
   operator Map& () = delete;
+  operator HashMap& () = delete;
 
   Number& toNumber() = delete;
   BitArray& toBitArray() = delete;
@@ -19,6 +20,7 @@ class MultiMap : public Variable {
   Array& toArray() = delete;
   List& toList() = delete;
   Map& toMap() = delete;
+  HashMap& toHashMap() = delete;
 
   operator const Number& () const = delete;
   operator const BitArray& () const = delete;
@@ -26,6 +28,7 @@ class MultiMap : public Variable {
   operator const Array& () const = delete;
   operator const List& () const = delete;
   operator const Map& () const = delete;
+  operator const HashMap& () const = delete;
 
   const Number& toNumber() const = delete;
   const BitArray& toBitArray() const = delete;
@@ -33,6 +36,7 @@ class MultiMap : public Variable {
   const Array& toArray() const = delete;
   const List& toList() const = delete;
   const Map& toMap() const = delete;
+  const HashMap& toHashMap() const = delete;
 
   Variable& operator=(const Variable& other) = delete;
   Variable& operator=(Variable&& other) = delete;
@@ -65,6 +69,7 @@ public:
   size_t getElementCount() const noexcept;
   bool contains(KeyValue key) const noexcept;
 
+  //! As with Map, variable passed by move() is inserted as reference to it and copy is inserted otherwise
   err::ProgressReport<NamedVariable> insert(KeyValue key, Variable variable, NewNodePosition position = NewNodePosition::back);
   Error remove(Iterator it);
   Error remove(ReverseIterator it);
@@ -85,6 +90,25 @@ public:
   ConstIterator findLast(KeyValue key) const;
   ConstReverseIterator rfindLast(KeyValue key) const;
 
+  //! Element of index in key order or end, O(log n) by element counts of subtrees of multimap tree
+  Iterator select(size_t index);
+  ConstIterator select(size_t index) const;
+  //! Count of elements with keys lower than key, O(log n)
+  size_t rank(KeyValue key) const;
+  //! Count of elements with keys from first up to but not including last, O(log n)
+  size_t countRange(KeyValue first, KeyValue last) const;
+
+  //! Moves elements with keys not lower than key to returned multimap, O(log n),
+  //! both multimaps share memory of elements until both are released
+  MultiMap split(KeyValue key);
+  //! Moves all elements of other multimap to this one if all their keys aren't lower or all aren't higher than keys of this one,
+  //! O(log n) plus count of elements with key equal in both multimaps, returns invalid_data and leaves multimaps unchanged otherwise
+  err::Error join(MultiMap& other);
+  //! Removes elements with keys from first up to but not including last, returns their count, O(log n) plus their destruction
+  size_t eraseRange(KeyValue first, KeyValue last);
+  //! Moves elements to own memory in O(n) if released part of split left them less than quarter of it
+  void shrinkToFit();
+
   Iterator operator[](KeyValue key) noexcept;
   ConstIterator operator[](KeyValue key) const noexcept;
 
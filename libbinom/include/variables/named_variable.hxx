@@ -56,26 +56,28 @@ public:
     : key(std::move(other.getKeyRef())), variable(std::move(other.getVariableRef())) {}
 };
 
+//! Refers to element inside of container storage, elements of HashMap move on insert and remove,
+//! so reference to them is valid only until elements of hash map are changed, its key and variable are kept instead
 class MapNodeRef : public priv::NamedVariableBase<MapNodeRef> {
   template<typename Driven>
   friend class priv::NamedVariableBase;
   friend class priv::MapImplementation;
   friend class priv::MultiMapImplementation;
+  friend class priv::HashMapImplementation;
   typedef std::pair<const KeyValue, Variable> KeyVariablePair;
 
-  KeyVariablePair& pair;
+  const KeyValue& key;
+  Variable& variable;
 
-  inline Variable& getVariableRef() noexcept {return pair.second;}
-  inline const Variable& getVariableRef() const noexcept {return pair.second;}
-  inline const KeyValue& getKeyRef() const noexcept {return pair.first;}
+  inline Variable& getVariableRef() noexcept {return variable;}
+  inline const Variable& getVariableRef() const noexcept {return variable;}
+  inline const KeyValue& getKeyRef() const noexcept {return key;}
 
-  friend class priv::MapImplementation;
-  friend class priv::MapImplementation::Iterator;
-  friend class priv::MapImplementation::ReverseIterator;
-  MapNodeRef(const KeyVariablePair& pair) : pair(const_cast<KeyVariablePair&>(pair)) {}
+  MapNodeRef(const KeyValue& key, Variable& variable) : key(key), variable(variable) {}
+  MapNodeRef(const KeyVariablePair& pair) : key(pair.first), variable(const_cast<Variable&>(pair.second)) {}
 public:
-  MapNodeRef(const MapNodeRef& other) : pair(const_cast<KeyVariablePair&>(other.pair)) {}
-  MapNodeRef(MapNodeRef& other) : pair(other.pair) {}
+  MapNodeRef(const MapNodeRef& other) : key(other.key), variable(other.variable) {}
+  MapNodeRef(MapNodeRef& other) : key(other.key), variable(other.variable) {}
 };
 
 }
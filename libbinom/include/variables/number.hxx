@@ -19,6 +19,7 @@ class Number :
   operator List& () = delete;
   operator Map& () = delete;
   operator MultiMap& () = delete;
+  operator HashMap& () = delete;
 
   Number& toNumber() = delete;
   BitArray& toBitArray() = delete;
@@ -27,6 +28,7 @@ class Number :
   List& toList() = delete;
   Map& toMap() = delete;
   MultiMap& toMultiMap() = delete;
+  HashMap& toHashMap() = delete;
 
   operator const BitArray& () const = delete;
   operator const BufferArray& () const = delete;
@@ -34,6 +36,7 @@ class Number :
   operator const List& () const = delete;
   operator const Map& () const = delete;
   operator const MultiMap& () const = delete;
+  operator const HashMap& () const = delete;
 
   const Number& toNumber() const = delete;
   const BitArray& toBitArray() const = delete;
@@ -42,6 +45,7 @@ class Number :
   const List& toList() const = delete;
   const Map& toMap() const = delete;
   const MultiMap& toMultiMap() const = delete;
+  const HashMap& toHashMap() const = delete;
 
   Variable& operator=(const Variable& other) = delete;
   Variable& operator=(Variable&& other) = delete;
@@ -50,8 +54,22 @@ class Number :
   Variable& changeLink(Variable&& other) = delete;
 
 
+  //! Changing operators work on copy of value, which is stored at once for optimistic readers
+  class DataWriter {
+    ui64& value;
+    arithmetic::ArithmeticData data;
+  public:
+    DataWriter(ui64& value) noexcept;
+    DataWriter(const DataWriter&) = delete;
+    ~DataWriter();
+    arithmetic::ArithmeticData& get() noexcept {return data;}
+  };
+
   arithmetic::ArithmeticData& getArithmeticDataImpl() const;
+  DataWriter getArithmeticDataWriterImpl() const;
   ValType getValTypeImpl() const;
+  //! Copy of value read without lock
+  GenericValue getValueImpl() const noexcept;
 
   static bool checkLock(const OptionalSharedRecursiveLock& lock) noexcept;
 
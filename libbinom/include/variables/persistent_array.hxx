@@ -0,0 +1,80 @@
+#ifndef PERSISTENT_ARRAY_HXX
+#define PERSISTENT_ARRAY_HXX
+
+#include "variable.hxx"
+
+namespace binom {
+namespace priv {struct PersistentArrayNode;}
+
+/**
+ * @brief Immutable heterogeneous array
+ *
+ * Elements are kept in leaves of 32-way trie, each change returns new version
+ * which shares unchanged nodes with old one and copies only path to changed leaf
+ * (O(log32 n), at most 7 nodes for 2^32 elements).
+ * Versions are never changed, so any thread can read version it holds without locks,
+ * copy of version is one atomic increment. Use atomic_version::AtomicVersion
+ * to publish versions from writer to readers.
+ * Elements are cloned on insertion and must not be changed through returned references.
+ */
+class PersistentArray {
+public:
+  static constexpr size_t node_bit_count = 5;
+  static constexpr size_t node_capacity = 1 << node_bit_count;
+
+private:
+  priv::PersistentArrayNode* root = nullptr;
+  size_t element_count = 0;
+  size_t shift = 0; ///< Bit shift of index for root level, leaf level has 0
+
+  PersistentArray(priv::PersistentArrayNode* root, size_t element_count, size_t shift) noexcept
+    : root(root), element_count(element_count), shift(shift) {}
+  const Variable* getLeaf(size_t index) const noexcept;
+
+public:
+  class ConstIterator {
+    const PersistentArray* array = nullptr;
+    const Variable* leaf = nullptr;
+    size_t index = 0;
+    friend class PersistentArray;
+    ConstIterator(const PersistentArray* array, size_t index) noexcept;
+  public:
+    ConstIterator() = default;
+    ConstIterator& operator++() noexcept;
+    const Variable& operator*() const noexcept;
+    const Variable* operator->() const noexcept;
+    bool operator==(const ConstIterator& other) const noexcept;
+    bool operator!=(const ConstIterator& other) const noexcept;
+  };
+
+  PersistentArray() noexcept = default;
+  PersistentArray(const literals::arr& array);
+  PersistentArray(const PersistentArray& other) noexcept;
+  PersistentArray(PersistentArray&& other) noexcept;
+  ~PersistentArray();
+
+  PersistentArray& operator=(const PersistentArray& other) noexcept;
+  PersistentArray& operator=(PersistentArray&& other) noexcept;
+
+  bool isEmpty() const noexcept;
+  size_t getElementCount() const noexcept;
+  //! Element lives while this version exists, throws err::ErrorType::out_of_range
+  const Variable& operator[](size_t index) const;
+
+  //! Version with element appended
+  PersistentArray pushBack(const Variable& value) const;
+  //! Version without last element
+  PersistentArray popBack() const;
+  //! Version with replaced element, throws err::ErrorType::out_of_range
+  PersistentArray set(size_t index, const Variable& value) const;
+
+  ConstIterator begin() const noexcept;
+  ConstIterator end() const noexcept;
+
+  //! Mutable array with copies of elements of this version
+  Variable toVariable() const;
+};
+
+}
+
+#endif // PERSISTENT_ARRAY_HXX
@@ -0,0 +1,74 @@
+#ifndef PERSISTENT_MAP_HXX
+#define PERSISTENT_MAP_HXX
+
+#include "variable.hxx"
+#include "key_value.hxx"
+
+#include <utility>
+#include <vector>
+
+namespace binom {
+namespace priv {struct PersistentMapNode;}
+
+/**
+ * @brief Immutable key-sorted map with unique keys
+ *
+ * Each change returns new version which shares unchanged nodes with old one,
+ * change copies only path from root to changed node (balanced tree, O(log n)).
+ * Versions are never changed, so any thread can read version it holds without locks,
+ * copy of version is one atomic increment. Use atomic_version::AtomicVersion
+ * to publish versions from writer to readers.
+ * Values are cloned on insertion and must not be changed through returned references.
+ */
+class PersistentMap {
+  priv::PersistentMapNode* root = nullptr;
+
+  PersistentMap(priv::PersistentMapNode* root) noexcept : root(root) {}
+
+public:
+  typedef std::pair<const KeyValue&, const Variable&> ElementRef;
+
+  class ConstIterator {
+    std::vector<const priv::PersistentMapNode*> path; ///< Nodes with not visited right subtree, top is current
+    friend class PersistentMap;
+    ConstIterator(const priv::PersistentMapNode* root);
+  public:
+    ConstIterator() = default;
+    ConstIterator& operator++();
+    ElementRef operator*() const;
+    const KeyValue& getKey() const;
+    const Variable& getVariable() const;
+    bool operator==(const ConstIterator& other) const noexcept;
+    bool operator!=(const ConstIterator& other) const noexcept;
+  };
+
+  PersistentMap() noexcept = default;
+  PersistentMap(const literals::map& map);
+  PersistentMap(const PersistentMap& other) noexcept;
+  PersistentMap(PersistentMap&& other) noexcept;
+  ~PersistentMap();
+
+  PersistentMap& operator=(const PersistentMap& other) noexcept;
+  PersistentMap& operator=(PersistentMap&& other) noexcept;
+
+  bool isEmpty() const noexcept;
+  size_t getElementCount() const noexcept;
+  bool contains(KeyValue key) const;
+  //! Pointer to value of key or nullptr, value lives while this version exists
+  const Variable* find(KeyValue key) const;
+
+  //! Version with key inserted or its value replaced
+  PersistentMap set(KeyValue key, const Variable& value) const;
+  //! Version without key
+  PersistentMap remove(KeyValue key) const;
+
+  ConstIterator begin() const;
+  ConstIterator end() const noexcept;
+
+  //! Mutable map with copies of values of this version
+  Variable toVariable() const;
+};
+
+}
+
+#endif // PERSISTENT_MAP_HXX
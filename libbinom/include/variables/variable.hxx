@@ -3,8 +3,11 @@
 
 #include "../binom_impl/resource_control.hxx"
 #include "../binom_impl/multi_avl_tree.hxx"
+#include "../binom_impl/serialization.hxx"
 #include "generic_value.hxx"
 
+#include <functional>
+
 namespace binom {
 
 class Variable {
@@ -14,23 +17,38 @@ protected:
 
   Link resource_link;
 
+#ifndef BINOM_SINGLE_THREAD
   std::shared_mutex& getMutex() {return resource_link.getMutex();}
+#endif
 
   Variable(ResourceData data);
   Variable(Link&& link);
 
-//  static void serializeImpl(const Variable& variable, std::vector<byte>& buffer);
-//  static void serializeImpl(const Number& number, std::vector<byte>& buffer);
-//  static void serializeImpl(const BitArray& bit_array, std::vector<byte>& buffer);
-//  static void serializeImpl(const BufferArray& buffer_array, std::vector<byte>& buffer);
-//  static void serializeImpl(const Array& array, std::vector<byte>& buffer);
-//  static void serializeImpl(const List& dl_list, std::vector<byte>& buffer);
-//  static void serializeImpl(const Map& map, std::vector<byte>& buffer);
-//  static void serializeImpl(const Table& bit_array, std::vector<byte>& buffer);
+  //! Lock for giving out links or read-only references and iterators to elements, see priv::Link::getElementLinkLock
+  OptionalSharedRecursiveLock getElementLinkLock() const noexcept;
+  //! Lock for giving out mutable references or iterators to elements, see priv::Link::getElementAccessLock
+  OptionalSharedRecursiveLock getElementAccessLock() const noexcept;
+
+  static size_t getSerializedSizeImpl(const Variable& variable);
+  static size_t getSerializedSizeImpl(const KeyValue& key);
+  template<typename Writer>
+  static void serializeImpl(const Variable& variable, Writer& writer);
+  template<typename Writer>
+  static void serializeImpl(const KeyValue& key, Writer& writer);
+  template<typename Reader>
+  static Variable deserializeImpl(Reader& reader, bool is_indexed, size_t depth = 0);
+  template<typename Reader>
+  static KeyValue deserializeKeyImpl(Reader& reader);
+
+  friend class View;
+  friend class ViewMap;
+  friend class MappedStorage;
+  friend class priv::MappedFile;
+  friend class priv::Link;
 
 public:
   using NewNodePosition = binom::priv::MultiAVLTree::NewNodePosition;
-//  using TransactionLock = shared_recursive_mtx::TransactionLock;
+  using TransactionLock = shared_recursive_mtx::TransactionLock;
 
   // Null
   Variable() noexcept;
@@ -86,6 +104,9 @@ public:
   // MultiMap
   Variable(const literals::multimap multimap, NewNodePosition pos = NewNodePosition::back);
 
+  // HashMap
+  Variable(const literals::hashmap hashmap);
+
   // Move & Copy
   Variable(Variable&& other) noexcept;
   Variable(const Variable& other) noexcept;
@@ -95,7 +116,9 @@ public:
 
   OptionalSharedRecursiveLock getLock(MtxLockType lock_type) const noexcept;
 
-//  static TransactionLock makeTransaction(std::list<Variable&> variables, MtxLockType lock_type = MtxLockType::unique_locked);
+  //! Locks resources of all variables at once, nested locks of them taken by this thread are recursive
+  static TransactionLock makeTransaction(std::initializer_list<std::reference_wrapper<const Variable>> variables,
+                                         MtxLockType lock_type = MtxLockType::unique_locked);
 
   // Properties
   bool isResourceExist() const noexcept;
@@ -116,6 +139,7 @@ public:
   operator List& ();
   operator Map& ();
   operator MultiMap& ();
+  operator HashMap& ();
 
   operator const Number& () const;
   operator const BitArray& () const;
@@ -124,6 +148,7 @@ public:
   operator const List& () const;
   operator const Map& () const;
   operator const MultiMap& () const;
+  operator const HashMap& () const;
 
   // Downcast methods
   Number& toNumber();
@@ -133,6 +158,7 @@ public:
   List& toList();
   Map& toMap();
   MultiMap& toMultiMap();
+  HashMap& toHashMap();
 
   const Number& toNumber() const;
   const BitArray& toBitArray() const;
@@ -141,6 +167,7 @@ public:
   const List& toList() const;
   const Map& toMap() const;
   const MultiMap& toMultiMap() const;
+  const HashMap& toHashMap() const;
 
   Variable& operator=(const Variable& other);
   Variable& operator=(Variable&& other);
@@ -149,7 +176,14 @@ public:
   Variable& changeLink(Variable&& other);
 
   std::vector<byte> serialize() const;
-  void serializeToStraem(std::ostream& os) const;
+  StreamStatistics serializeToStraem(std::ostream& os, size_t chunk_size = priv::serialization::default_stream_chunk_size) const;
+  StreamStatistics serializeToFile(int file_descriptor, size_t chunk_size = priv::serialization::default_stream_chunk_size) const;
+
+  static Variable deserialize(const std::vector<byte>& buffer);
+  static Variable deserialize(const byte* data, size_t size);
+  static Variable deserializeFromStream(std::istream& is,
+                                        StreamStatistics* statistics = nullptr,
+                                        size_t chunk_size = priv::serialization::default_stream_chunk_size);
 
   inline Variable& upcast() {return self;}
   inline const Variable& upcast() const {return self;}
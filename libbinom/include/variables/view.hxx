@@ -0,0 +1,128 @@
+#ifndef VIEW_HXX
+#define VIEW_HXX
+
+#include "variable.hxx"
+#include "generic_value.hxx"
+#include "key_value.hxx"
+
+namespace binom {
+
+/**
+ * @brief Read-only view of indexed serialized data (Variable::serialize() output)
+ *
+ * Interprets buffer in place: no Variable, Link or SharedResource is created
+ * until toVariable() is called. Buffer must outlive all views over it.
+ * Invalid view (isValid() == false) is returned for missing elements.
+ */
+class View {
+protected:
+  const byte* node = nullptr;
+  const byte* buffer_end = nullptr;
+
+  View(const byte* node, const byte* buffer_end);
+
+  size_t getNodeSize() const;
+  ui64 readUi64(size_t offset) const;
+  const byte* getContainerBody() const;
+  View getContainerElement(size_t index) const;
+
+  friend class ViewArray;
+  friend class ViewMap;
+  friend class priv::MappedFile;
+public:
+  View() noexcept = default;
+  View(const std::vector<byte>& buffer);
+  View(const byte* data, size_t size);
+  View(const View& other) noexcept = default;
+  View& operator=(const View& other) noexcept = default;
+
+  inline bool isValid() const noexcept {return node;}
+  inline explicit operator bool() const noexcept {return node;}
+
+  VarType getType() const noexcept;
+  VarTypeClass getTypeClass() const noexcept;
+  ValType getValType() const noexcept;
+  VarBitWidth getBitWidth() const noexcept;
+  size_t getElementCount() const;
+
+  //! Encoded data of node
+  inline const byte* getDataPointer() const noexcept {return node;}
+  inline size_t getDataSize() const {return getNodeSize();}
+
+  GenericValue toNumber() const;
+  ViewBufferArray toBufferArray() const;
+  ViewArray toArray() const;
+  ViewMap toMap() const;
+
+  //! Decodes node into Variable tree
+  Variable toVariable() const;
+};
+
+class ViewBufferArray : public View {
+  ViewBufferArray(View view);
+  friend class View;
+public:
+  typedef const GenericValueIterator ConstIterator;
+
+  size_t getElementCount() const;
+  //! Raw element data, may be unaligned
+  const void* getData() const;
+  template<typename T>
+  const T* getDataAs() const {return reinterpret_cast<const T*>(getData());}
+
+  const GenericValueRef operator[](size_t index) const;
+
+  ConstIterator begin() const;
+  ConstIterator end() const;
+};
+
+//! View of array or list
+class ViewArray : public View {
+  ViewArray(View view);
+  friend class View;
+public:
+  class Iterator {
+    const ViewArray* array;
+    size_t index;
+    friend class ViewArray;
+    Iterator(const ViewArray* array, size_t index) : array(array), index(index) {}
+  public:
+    inline View operator*() const {return (*array)[index];}
+    inline Iterator& operator++() noexcept {++index; return self;}
+    inline Iterator operator++(int) noexcept {Iterator tmp = self; ++index; return tmp;}
+    inline bool operator==(const Iterator& other) const noexcept {return index == other.index;}
+    inline bool operator!=(const Iterator& other) const noexcept {return index != other.index;}
+  };
+
+  size_t getElementCount() const;
+  View operator[](size_t index) const;
+
+  Iterator begin() const;
+  Iterator end() const;
+};
+
+//! View of map or multimap, key lookup is binary search over encoded keys
+class ViewMap : public View {
+  ViewMap(View view);
+  friend class View;
+
+  static KeyValue::CompareResult compareKey(const View& encoded_key, const KeyValue& key);
+public:
+  size_t getElementCount() const;
+
+  View getKey(size_t index) const;
+  View getValue(size_t index) const;
+
+  //! Index of first element with key not lower than given
+  size_t lowerBound(const KeyValue& key) const;
+  //! Index of element with given key or getElementCount() if not found
+  size_t find(const KeyValue& key) const;
+  bool contains(const KeyValue& key) const;
+
+  //! Value of (first) element with given key or invalid view if not found
+  View operator[](const KeyValue& key) const;
+};
+
+}
+
+#endif // VIEW_HXX
@@ -16,6 +16,7 @@ void AVLNode::swapPosition(AVLNode& other, AVLTree& avl_tree) {
     std::swap(left, other.left);
     std::swap(right, other.right);
     std::swap(depth, other.depth);
+    std::swap(subtree_size, other.subtree_size);
 
   } elif (parent == &other) {
     parent = other.parent;
@@ -30,6 +31,7 @@ void AVLNode::swapPosition(AVLNode& other, AVLTree& avl_tree) {
       std::swap(left, other.left);
     }
     std::swap(depth, other.depth);
+    std::swap(subtree_size, other.subtree_size);
 
   } else {
     other.parent = parent;
@@ -75,6 +77,7 @@ AVLNode::AVLNode(KeyValue key, AVLNode* parent) : parent(parent), key(std::move(
 
 AVLNode::AVLNode(AVLNode& other)
   : depth(other.depth),
+    subtree_size(other.subtree_size),
     left(other.left),
     right(other.right),
     parent(other.parent),
@@ -82,6 +85,7 @@ AVLNode::AVLNode(AVLNode& other)
 
 AVLNode::AVLNode(AVLNode&& other)
   : depth(other.depth),
+    subtree_size(other.subtree_size),
     left(other.left),
     right(other.right),
     parent(other.parent),
@@ -128,6 +132,8 @@ AVLNode* AVLTree::rotateRight(AVLNode* y) {
 
   y->depth = max(depth(y->left), depth(y->right)) + 1;
   x->depth = max(depth(x->left), depth(x->right)) + 1;
+  y->subtree_size = 1 + subtreeSize(y->left) + subtreeSize(y->right);
+  x->subtree_size = 1 + subtreeSize(x->left) + subtreeSize(x->right);
 
   // Update parent poionters
   x->parent = y->parent;
@@ -150,8 +156,10 @@ AVLNode* AVLTree::rotateLeft(AVLNode* x) {
   y->left = x;
   x->right = T2;
 
-  y->depth = max(depth(y->left), depth(y->right)) + 1;
   x->depth = max(depth(x->left), depth(x->right)) + 1;
+  y->depth = max(depth(y->left), depth(y->right)) + 1;
+  x->subtree_size = 1 + subtreeSize(x->left) + subtreeSize(x->right);
+  y->subtree_size = 1 + subtreeSize(y->left) + subtreeSize(y->right);
 
   // Update parent poionters
   y->parent = x->parent;
@@ -166,8 +174,34 @@ AVLNode* AVLTree::rotateLeft(AVLNode* x) {
   return y;
 }
 
+size_t AVLTree::subtreeSize(AVLNode* node) noexcept {return node ? node->subtree_size : 0;}
+
 i64 AVLTree::getBalance(AVLNode* node) { return node ? depth(node->left) - depth(node->right) : 0; }
 
+void AVLTree::balance(AVLNode* node) {
+  // Depths and subtree sizes are recomputed on the whole path, rotations fix sizes of rotated nodes
+  while(node) {
+    node->depth = 1 + max(depth(node->left), depth(node->right));
+    node->subtree_size = 1 + subtreeSize(node->left) + subtreeSize(node->right);
+
+    i64 balance = getBalance(node);
+
+    if (balance > 1 && getBalance(node->left) >= 0) {
+      rotateRight(node);
+    } elif (balance > 1  && getBalance(node->left) < 0) {
+      rotateLeft(node->left);
+      rotateRight(node);
+    } elif (balance < -1 && getBalance(node->right) <= 0) {
+      rotateLeft(node);
+    } elif (balance < -1 && getBalance(node->right) > 0) {
+      rotateRight(node->right);
+      rotateLeft(node);
+    }
+
+    node = node->parent;
+  }
+}
+
 AVLNode* AVLTree::minKeyNode(AVLNode* node) noexcept {
   if(!node) return nullptr;
   while(node->left) node = node->left;
@@ -185,6 +219,9 @@ AVLNode* AVLTree::maxKeyNode(AVLNode* node) noexcept {
 AVLNode* AVLTree::maxKeyNode() const noexcept {return maxKeyNode(root);}
 
 AVLNode* AVLTree::insert(AVLNode* new_node) {
+  // Node may be extracted from other tree
+  new_node->depth = 1;
+  new_node->subtree_size = 1;
   AVLNode* node = root;
   if(!node) return root = new_node;
 
@@ -199,27 +236,93 @@ AVLNode* AVLTree::insert(AVLNode* new_node) {
     } else return nullptr;
   }
 
-  while(node) { // Balancing
-    node->depth = 1 + max(depth(node->left), depth(node->right));
+  balance(node);
 
-    i64 balance = getBalance(node);
+  return new_node;
+}
 
-    if (balance > 1 && getBalance(root->left) >= 0) {
-      rotateRight(node);
-    } elif (balance > 1  && getBalance(root->left) < 0) {
-      rotateLeft(node->left);
-      rotateRight(node);
-    } elif (balance < -1 && getBalance(node->right) <= 0) {
-      rotateLeft(node);
-    } elif (balance < -1 && getBalance(node->right) > 0) {
-      rotateRight(node->right);
-      rotateLeft(node);
+AVLNode* AVLTree::buildBalanced(AVLNode* const* nodes, size_t count, AVLNode* parent) noexcept {
+  if(!count) return nullptr;
+  const size_t middle = count / 2;
+  AVLNode* node = nodes[middle];
+  node->parent = parent;
+  node->left = buildBalanced(nodes, middle, node);
+  node->right = buildBalanced(nodes + middle + 1, count - middle - 1, node);
+  node->depth = 1 + max(depth(node->left), depth(node->right));
+  node->subtree_size = count;
+  return node;
+}
+
+void AVLTree::bulkLoad(AVLNode* const* nodes, size_t count) noexcept {root = buildBalanced(nodes, count, nullptr);}
+
+binom::err::Error AVLTree::bulkLoadChecked(AVLNode* const* nodes, size_t count) {
+  for(size_t i = 1; i < count; ++i)
+    switch(nodes[i - 1]->key.getCompare(nodes[i]->key)) {
+    case KeyValue::lower: continue;
+    case KeyValue::equal: return err::ErrorType::binom_key_unique_error;
+    default: return err::ErrorType::invalid_data;
     }
+  bulkLoad(nodes, count);
+  return err::ErrorType::no_error;
+}
 
-    node = node->parent;
+void AVLTree::joinByNode(AVLNode* middle, AVLNode* right) {
+  if(root) root->parent = nullptr;
+  if(right) right->parent = nullptr;
+  AVLNode* parent = nullptr;
+  if(depth(root) >= depth(right)) {
+    // Right edge of tree is descended to node, which is at most one level higher than right subtree
+    AVLNode* node = root;
+    while(depth(node) > depth(right) + 1) {parent = node; node = node->right;}
+    middle->left = node;
+    middle->right = right;
+    if(parent) parent->right = middle;
+    else root = middle;
+    if(node) node->parent = middle;
+    if(right) right->parent = middle;
+  } else {
+    AVLNode* left = root;
+    AVLNode* node = root = right;
+    while(depth(node) > depth(left) + 1) {parent = node; node = node->left;}
+    middle->left = left;
+    middle->right = node;
+    if(parent) parent->left = middle;
+    else root = middle;
+    if(left) left->parent = middle;
+    if(node) node->parent = middle;
   }
+  middle->parent = parent;
+  balance(middle);
+}
 
-  return new_node;
+void AVLTree::append(AVLNode* other_root) {
+  if(!other_root) return;
+  if(!root) {
+    root = other_root;
+    root->parent = nullptr;
+    return;
+  }
+  AVLNode* middle = extract(maxKeyNode());
+  joinByNode(middle, other_root);
+}
+
+void AVLTree::splitNode(AVLNode* node, KeyValue& key, AVLTree& lower, AVLTree& upper) {
+  if(!node) return;
+  AVLNode* left = node->left;
+  AVLNode* right = node->right;
+  node->left = node->right = nullptr;
+  if(node->key.getCompare(key) == KeyValue::lower) {
+    // Node with left subtree goes before lower part of right subtree
+    splitNode(right, key, lower, upper);
+    AVLTree left_tree;
+    left_tree.root = left;
+    left_tree.joinByNode(node, lower.root);
+    lower.root = left_tree.root;
+    left_tree.root = nullptr;
+  } else {
+    splitNode(left, key, lower, upper);
+    upper.joinByNode(node, right);
+  }
 }
 
 AVLNode* AVLTree::extract(KeyValue key) {
@@ -263,26 +366,7 @@ AVLNode* AVLTree::extract(KeyValue key) {
     }
   }
 
-  while(node) { // Balancing
-
-    node->depth = 1 + max(depth(node->left), depth(node->right));
-
-    i64 balance = getBalance(node);
-
-    if (balance > 1 && getBalance(root->left) >= 0) {
-      rotateRight(node);
-    } elif (balance > 1  && getBalance(root->left) < 0) {
-      rotateLeft(node->left);
-      rotateRight(node);
-    } elif (balance < -1 && getBalance(node->right) <= 0) {
-      rotateLeft(node);
-    } elif (balance < -1 && getBalance(node->right) > 0) {
-      rotateRight(node->right);
-      rotateLeft(node);
-    }
-
-    node = node->parent;
-  }
+  balance(node);
 
   return result;
 }
@@ -293,7 +377,7 @@ AVLNode* AVLTree::extract(AVLNode* node) {
     AVLNode* tmp = node->left ? node->left : node->right;
     if(!tmp) { // If node hasn't child
       tmp = node;
-      node = nullptr;
+      node = node->parent;
       tmp->unpin(self);
       result = tmp;
     } else { // If node has 1 child
@@ -314,26 +398,7 @@ AVLNode* AVLTree::extract(AVLNode* node) {
     continue;
   }
 
-  while(node) { // Balancing
-
-    node->depth = 1 + max(depth(node->left), depth(node->right));
-
-    i64 balance = getBalance(node);
-
-    if (balance > 1 && getBalance(root->left) >= 0) {
-      rotateRight(node);
-    } elif (balance > 1  && getBalance(root->left) < 0) {
-      rotateLeft(node->left);
-      rotateRight(node);
-    } elif (balance < -1 && getBalance(node->right) <= 0) {
-      rotateLeft(node);
-    } elif (balance < -1 && getBalance(node->right) > 0) {
-      rotateRight(node->right);
-      rotateLeft(node);
-    }
-
-    node = node->parent;
-  }
+  balance(node);
 
   return result;
 }
@@ -347,11 +412,74 @@ AVLNode* AVLTree::get(KeyValue key) const {
     // Searching key...
     auto cmp = key.getCompare(node->key);
     if(cmp == KeyValue::lower) {node = node->left; continue;}
-    elif(cmp == KeyValue::highter) {node = node->left; continue;}
+    elif(cmp == KeyValue::highter) {node = node->right; continue;}
     else return node; // Node is finded
   }
 }
 
+AVLNode* AVLTree::select(size_t index) const noexcept {
+  AVLNode* node = root;
+  while(node) {
+    const size_t left_size = subtreeSize(node->left);
+    if(index < left_size) node = node->left;
+    elif(index == left_size) return node;
+    else {
+      index -= left_size + 1;
+      node = node->right;
+    }
+  }
+  return nullptr;
+}
+
+size_t AVLTree::rank(KeyValue key) const {
+  size_t result = 0;
+  AVLNode* node = root;
+  while(node) {
+    if(key.getCompare(node->key) == KeyValue::highter) {
+      result += subtreeSize(node->left) + 1;
+      node = node->right;
+    } else node = node->left;
+  }
+  return result;
+}
+
+size_t AVLTree::countRange(KeyValue first, KeyValue last) const {
+  const size_t first_rank = rank(std::move(first)), last_rank = rank(std::move(last));
+  return last_rank > first_rank ? last_rank - first_rank : 0;
+}
+
+AVLTree AVLTree::split(KeyValue key) {
+  AVLTree lower, upper;
+  splitNode(root, key, lower, upper);
+  root = lower.root;
+  lower.root = nullptr;
+  return upper;
+}
+
+bool AVLTree::join(AVLTree& other) {
+  if(this == &other) return !root;
+  if(!other.root) return true;
+  if(root && maxKeyNode()->key.getCompare(minKeyNode(other.root)->key) != KeyValue::lower) {
+    if(maxKeyNode(other.root)->key.getCompare(minKeyNode()->key) != KeyValue::lower) return false;
+    // Other tree is lower, so this tree is joined to it
+    other.append(root);
+    root = other.root;
+  } else append(other.root);
+  other.root = nullptr;
+  return true;
+}
+
+size_t AVLTree::eraseRange(KeyValue first, KeyValue last, std::function<void(AVLNode*)> destructor) {
+  if(first.getCompare(last) != KeyValue::lower) return 0;
+  AVLTree middle = split(std::move(first));
+  AVLTree upper = middle.split(std::move(last));
+  const size_t count = subtreeSize(middle.root);
+  middle.clear(std::move(destructor));
+  append(upper.root);
+  upper.root = nullptr;
+  return count;
+}
+
 AVLTree::Iterator AVLTree::begin() noexcept {return minKeyNode();}
 
 AVLTree::Iterator AVLTree::end() noexcept {return nullptr;}
@@ -0,0 +1,278 @@
+#include "libbinom/include/binom_impl/file_storage_implementation/buffer_pool.hxx"
+#include "libbinom/include/binom_impl/file_storage_implementation/paged_file.hxx"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+using namespace binom;
+using namespace binom::priv;
+
+BufferPool::BufferPool(PagedFile& file, size_t page_size, size_t memory_budget, CacheEvictionPolicy policy)
+  : file(file), page_size(page_size), frame_limit(std::max(memory_budget / page_size, min_frame_count)), policy(policy) {
+  frames.reserve(frame_limit);
+}
+
+void BufferPool::access(Frame& frame) {
+  frame.is_referenced = true;
+  std::move_backward(frame.access_history, frame.access_history + lru_k - 1, frame.access_history + lru_k);
+  frame.access_history[0] = ++access_tick;
+}
+
+void BufferPool::writeBack(Frame& frame) {
+  file.writeRaw(frame.page * page_size, frame.data.get(), page_size);
+  frame.is_dirty = false;
+  ++statistics.write_back_count;
+}
+
+void BufferPool::spill(Frame& frame) {
+  if(!spill_file && !(spill_file.reset(std::tmpfile()), spill_file))
+    throw err::Error(err::ErrorType::file_open_error);
+  ui64 slot;
+  if(free_spill_slots.empty()) slot = spill_slot_count++;
+  else {
+    slot = free_spill_slots.back();
+    free_spill_slots.pop_back();
+  }
+  const byte* it = frame.data.get();
+  for(size_t size = page_size, position = slot * page_size; size;) {
+    const ssize_t written = ::pwrite(::fileno(spill_file.get()), it, size, position);
+    if(written < 0) {
+      if(errno == EINTR) continue;
+      free_spill_slots.push_back(slot);
+      throw err::Error(err::ErrorType::file_write_error);
+    }
+    it += written;
+    position += written;
+    size -= written;
+  }
+  spilled_pages.emplace(frame.page, slot);
+  frame.is_dirty = false;
+  ++statistics.spill_count;
+}
+
+void BufferPool::readSpillSlot(ui64 slot, byte* to) {
+  for(size_t size = page_size, position = slot * page_size; size;) {
+    const ssize_t readed = ::pread(::fileno(spill_file.get()), to, size, position);
+    if(readed < 0) {
+      if(errno == EINTR) continue;
+      throw err::Error(err::ErrorType::file_read_error);
+    }
+    if(!readed) throw err::Error(err::ErrorType::invalid_data);
+    to += readed;
+    position += readed;
+    size -= readed;
+  }
+}
+
+void BufferPool::releaseSpillSlot(std::unordered_map<PageIndex, ui64>::iterator it) {
+  free_spill_slots.push_back(it->second);
+  spilled_pages.erase(it);
+}
+
+void BufferPool::unspill(std::unordered_map<PageIndex, ui64>::iterator it, byte* to) {
+  readSpillSlot(it->second, to);
+  releaseSpillSlot(it);
+}
+
+size_t BufferPool::findClockVictim() {
+  // Two turns: first one clears reference bits
+  for(size_t step = 0, count = frames.size() * 2; step < count; ++step) {
+    const size_t index = clock_hand;
+    clock_hand = (clock_hand + 1) % frames.size();
+    Frame& frame = frames[index];
+    if(!isEvictable(frame)) continue;
+    if(frame.is_used && frame.is_referenced) {
+      frame.is_referenced = false;
+      continue;
+    }
+    return index;
+  }
+  return frames.size();
+}
+
+size_t BufferPool::findLruKVictim() {
+  size_t victim = frames.size();
+  for(size_t index = 0; index < frames.size(); ++index) {
+    const Frame& frame = frames[index];
+    if(!isEvictable(frame)) continue;
+    if(!frame.is_used) return index;
+    if(victim == frames.size()) {victim = index; continue;}
+    // Pages with less than K accesses have infinite backward K-distance
+    const Frame& current = frames[victim];
+    if(frame.access_history[lru_k - 1] < current.access_history[lru_k - 1] ||
+       (frame.access_history[lru_k - 1] == current.access_history[lru_k - 1] &&
+        frame.access_history[0] < current.access_history[0]))
+      victim = index;
+  }
+  return victim;
+}
+
+size_t BufferPool::findSpillVictim() {
+  size_t victim = frames.size();
+  for(size_t index = 0; index < frames.size(); ++index) {
+    const Frame& frame = frames[index];
+    if(frame.pin_count || !frame.is_used) continue;
+    if(victim == frames.size() || frame.access_history[0] < frames[victim].access_history[0]) victim = index;
+  }
+  return victim;
+}
+
+size_t BufferPool::findVictim() {
+  if(frames.size() < frame_limit) {
+    frames.emplace_back().data.reset(new byte[page_size]);
+    statistics.peak_frame_count = std::max(statistics.peak_frame_count, frames.size());
+    return frames.size() - 1;
+  }
+
+  size_t victim = policy == CacheEvictionPolicy::clock ? findClockVictim() : findLruKVictim();
+  // Clean pages are evicted first, then dirty pages are spilled
+  if(victim == frames.size() && is_no_steal) victim = findSpillVictim();
+  if(victim == frames.size()) {
+    // All frames are pinned
+    frames.emplace_back().data.reset(new byte[page_size]);
+    statistics.peak_frame_count = std::max(statistics.peak_frame_count, frames.size());
+    return frames.size() - 1;
+  }
+
+  Frame& frame = frames[victim];
+  if(frame.is_used) {
+    if(frame.is_dirty) is_no_steal ? spill(frame) : writeBack(frame);
+    page_table.erase(frame.page);
+    frame.is_used = false;
+    ++statistics.eviction_count;
+  }
+
+  // Shrink pool grown over budget
+  if(frames.size() > frame_limit && victim != frames.size() - 1 && isEvictable(frames.back())) {
+    Frame& last = frames.back();
+    if(last.is_used) {
+      if(last.is_dirty) writeBack(last);
+      page_table.erase(last.page);
+    }
+    frames.pop_back();
+    if(clock_hand >= frames.size()) clock_hand = 0;
+  }
+  return victim;
+}
+
+BufferPool::Frame& BufferPool::fetch(PageIndex page, bool load) {
+  if(auto it = page_table.find(page); it != page_table.cend()) {
+    ++statistics.hit_count;
+    Frame& frame = frames[it->second];
+    access(frame);
+    return frame;
+  }
+
+  ++statistics.miss_count;
+  const size_t index = findVictim();
+  Frame& frame = frames[index];
+  frame.is_dirty = false;
+  if(auto it = spilled_pages.find(page); it != spilled_pages.cend()) {
+    if(load) unspill(it, frame.data.get());
+    else releaseSpillSlot(it);
+    frame.is_dirty = true;
+  } elif(load) file.readRaw(page * page_size, frame.data.get(), page_size);
+  frame.page = page;
+  frame.is_used = true;
+  frame.pin_count = 0;
+  std::fill(std::begin(frame.access_history), std::end(frame.access_history), 0);
+  access(frame);
+  page_table.emplace(page, index);
+  return frame;
+}
+
+void BufferPool::read(PageIndex page, size_t offset, void* to, size_t size) {
+  std::lock_guard lk(mtx);
+  std::memcpy(to, fetch(page).data.get() + offset, size);
+}
+
+void BufferPool::write(PageIndex page, size_t offset, const void* from, size_t size) {
+  std::lock_guard lk(mtx);
+  Frame& frame = fetch(page, offset || size != page_size);
+  std::memcpy(frame.data.get() + offset, from, size);
+  frame.is_dirty = true;
+}
+
+void BufferPool::pin(PageIndex page) {
+  std::lock_guard lk(mtx);
+  ++fetch(page).pin_count;
+}
+
+void BufferPool::unpin(PageIndex page) {
+  std::lock_guard lk(mtx);
+  if(auto it = page_table.find(page); it != page_table.cend() && frames[it->second].pin_count)
+    --frames[it->second].pin_count;
+}
+
+void BufferPool::discard(PageIndex page) {
+  std::lock_guard lk(mtx);
+  if(auto it = spilled_pages.find(page); it != spilled_pages.cend()) releaseSpillSlot(it);
+  auto it = page_table.find(page);
+  if(it == page_table.cend()) return;
+  Frame& frame = frames[it->second];
+  frame.is_used = false;
+  frame.is_dirty = false;
+  frame.pin_count = 0;
+  page_table.erase(it);
+}
+
+void BufferPool::visitDirty(const std::function<void(PageIndex, const byte*)>& callback) {
+  // Spilled pages have no frame
+  std::vector<std::pair<PageIndex, const Frame*>> dirty_pages;
+  dirty_pages.reserve(spilled_pages.size());
+  for(const Frame& frame : frames)
+    if(frame.is_used && frame.is_dirty) dirty_pages.emplace_back(frame.page, &frame);
+  for(const auto& [page, slot] : spilled_pages) dirty_pages.emplace_back(page, nullptr);
+  // Sequential write order
+  std::sort(dirty_pages.begin(), dirty_pages.end(), [](const auto& first, const auto& second) {return first.first < second.first;});
+
+  std::unique_ptr<byte[]> spilled_data;
+  for(const auto& [page, frame] : dirty_pages) {
+    if(frame) {
+      callback(page, frame->data.get());
+      continue;
+    }
+    if(!spilled_data) spilled_data.reset(new byte[page_size]);
+    readSpillSlot(spilled_pages.at(page), spilled_data.get());
+    callback(page, spilled_data.get());
+  }
+}
+
+void BufferPool::flush() {
+  std::lock_guard lk(mtx);
+  visitDirty([this](PageIndex page, const byte* data) {
+    file.writeRaw(page * page_size, data, page_size);
+    ++statistics.write_back_count;
+  });
+  for(Frame& frame : frames) frame.is_dirty = false;
+  spilled_pages.clear();
+  free_spill_slots.clear();
+  spill_slot_count = 0;
+}
+
+void BufferPool::forEachDirty(const std::function<void(PageIndex, const byte*)>& callback) {
+  std::lock_guard lk(mtx);
+  visitDirty(callback);
+}
+
+void BufferPool::setNoSteal(bool is_no_steal) {
+  std::lock_guard lk(mtx);
+  self.is_no_steal = is_no_steal;
+}
+
+bool BufferPool::isOverBudget() {
+  std::lock_guard lk(mtx);
+  return frames.size() > frame_limit || !spilled_pages.empty();
+}
+
+CacheStatistics BufferPool::getStatistics() {
+  std::lock_guard lk(mtx);
+  return statistics;
+}
+
+void BufferPool::resetStatistics() {
+  std::lock_guard lk(mtx);
+  statistics = CacheStatistics();
+}
@@ -0,0 +1,587 @@
+#include "libbinom/include/binom_impl/file_storage_implementation/file_storage_impl.hxx"
+#include "libbinom/include/binom_impl/serialization.hxx"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace binom;
+using namespace binom::priv;
+using namespace binom::priv::serialization;
+
+namespace {
+
+//! Data is copied after buffer is resized, range insert of few bytes is misread by -Wstringop-overflow
+inline void append(std::vector<byte>& buffer, const void* data, size_t size) {
+  if(!size) return;
+  const size_t position = buffer.size();
+  buffer.resize(position + size);
+  std::memcpy(buffer.data() + position, data, size);
+}
+
+template<typename T>
+requires std::is_trivially_copyable_v<T>
+inline void append(std::vector<byte>& buffer, T value) {append(buffer, &value, sizeof(T));}
+
+//! Appends view as standalone indexed buffer with size prefix
+void append(std::vector<byte>& buffer, const View& view) {
+  append(buffer, ui64(sizeof(Header) + view.getDataSize()));
+  append(buffer, Header{.flags = FormatFlags::indexed});
+  append(buffer, view.getDataPointer(), view.getDataSize());
+}
+
+View readView(MemoryReader& reader) {
+  const ui64 size = reader.read<ui64>();
+  return View(reader.take(size), size);
+}
+
+inline bool isArrayTypeClass(VarTypeClass type_class) noexcept {return type_class == VarTypeClass::array || type_class == VarTypeClass::list;}
+inline bool isMapTypeClass(VarTypeClass type_class) noexcept {
+  return type_class == VarTypeClass::map || type_class == VarTypeClass::multimap || type_class == VarTypeClass::hash_map;
+}
+
+}
+
+FileStorageImplementation::FileStorageImplementation(const std::string& path, ui32 page_size,
+                                                     size_t cache_size, CacheEvictionPolicy policy,
+                                                     JournalConfig journal_config)
+  : journal(path + ".wal", path, journal_config),
+    file(path, page_size, cache_size, policy, true) {
+  if(journal.isRecoveryRequired()) {
+    is_replaying = true;
+    journal.replay([this](const byte* data, size_t size) {replay(data, size);});
+    is_replaying = false;
+    journal.checkpoint(file);
+  }
+  if(!journal.isEnabled()) {
+    // Journal was opened only for recovery
+    journal.remove();
+    file.setJournaled(false);
+  }
+}
+
+FileStorageImplementation::~FileStorageImplementation() {
+  try { if(journal.isEnabled()) journal.checkpoint(file); } catch(...) {}
+}
+
+void FileStorageImplementation::checkpoint() {
+  if(journal.isEnabled()) journal.checkpoint(file);
+  else file.sync();
+}
+
+void FileStorageImplementation::logRemove(LogRecordType type, FileResourceIndex index, size_t at, size_t count) {
+  if(!isLogged()) return;
+  std::vector<byte> record;
+  append(record, type);
+  append(record, index);
+  append(record, ui64(at));
+  append(record, ui64(count));
+  log(record);
+}
+
+void FileStorageImplementation::log(const std::vector<byte>& record) {
+  journal.append(record);
+  if(journal.getSize() >= journal.getConfig().checkpoint_size || file.isCacheOverBudget()) journal.checkpoint(file);
+}
+
+void FileStorageImplementation::replay(const byte* data, size_t size) {
+  MemoryReader reader(data, size);
+  const LogRecordType type = reader.read<LogRecordType>();
+  if(type == LogRecordType::set_root) return setRoot(readView(reader));
+  const FileResourceIndex index = reader.read<FileResourceIndex>();
+
+  switch (type) {
+  case LogRecordType::buffer_insert: {
+    const ui64 at = reader.read<ui64>(), count = reader.read<ui64>();
+    return insertBuffer(index, at, reader.take(count * size_t(toBitWidth(index.type))), count);
+  }
+  case LogRecordType::buffer_remove: {
+    const ui64 at = reader.read<ui64>(), count = reader.read<ui64>();
+    return removeBuffer(index, at, count);
+  }
+  case LogRecordType::array_insert: {
+    const ui64 at = reader.read<ui64>();
+    return insertElement(index, at, readView(reader));
+  }
+  case LogRecordType::array_remove: {
+    const ui64 at = reader.read<ui64>(), count = reader.read<ui64>();
+    return removeElements(index, at, count);
+  }
+  case LogRecordType::map_insert: {
+    const KeyValue key = readView(reader).toVariable();
+    insertMapElement(index, key, readView(reader));
+  } return;
+  case LogRecordType::map_remove: {
+    const ui64 at = reader.read<ui64>(), count = reader.read<ui64>();
+    return removeMapElements(index, at, count);
+  }
+  case LogRecordType::map_rename: {
+    const KeyValue old_key = readView(reader).toVariable();
+    const KeyValue new_key = readView(reader).toVariable();
+    renameMapElements(index, old_key, new_key);
+  } return;
+  case LogRecordType::set_root:
+  default: throw err::Error(err::ErrorType::invalid_data);
+  }
+}
+
+NodeStream FileStorageImplementation::getStream(FileResourceIndex index, VarTypeClass type_class) {
+  const VarTypeClass index_type_class = toTypeClass(index.type);
+  if(index_type_class != type_class && !(isArrayTypeClass(index_type_class) && isArrayTypeClass(type_class)))
+    throw err::Error(err::ErrorType::binom_invalid_type);
+  NodeStream stream(file, index.index.page);
+  if(stream.getType() != index.type) throw err::Error(err::ErrorType::invalid_data);
+  return stream;
+}
+
+MapTree FileStorageImplementation::getMapTree(FileResourceIndex index) {
+  if(!isMapTypeClass(toTypeClass(index.type))) throw err::Error(err::ErrorType::binom_invalid_type);
+  MapTree tree(file, index.index.page);
+  if(tree.getType() != index.type) throw err::Error(err::ErrorType::invalid_data);
+  return tree;
+}
+
+FileResourceIndex FileStorageImplementation::store(const View& view) {
+  FileResourceIndex index{.type = view.getType()};
+  const byte* data = view.getDataPointer();
+
+  switch (toTypeClass(index.type)) {
+  case VarTypeClass::null: return index;
+
+  case VarTypeClass::number:
+    std::memcpy(&index.index, data + sizeof(VarType), size_t(toBitWidth(index.type)));
+  return index;
+
+  case VarTypeClass::bit_array:
+  case VarTypeClass::buffer_array: {
+    NodeStream stream = NodeStream::create(file, index.type);
+    stream.write(0, data + container_header_size, view.getDataSize() - container_header_size);
+    if(index.type == VarTypeClass::bit_array) stream.setAux(view.getElementCount());
+    index.index.page = stream.getFirstPage();
+  } return index;
+
+  case VarTypeClass::array:
+  case VarTypeClass::list: {
+    std::vector<FileResourceIndex> elements;
+    elements.reserve(view.getElementCount());
+    for(View element : view.toArray()) elements.push_back(store(element));
+    NodeStream stream = NodeStream::create(file, index.type);
+    stream.write(0, elements.data(), elements.size() * sizeof(FileResourceIndex));
+    index.index.page = stream.getFirstPage();
+  } return index;
+
+  case VarTypeClass::map:
+  case VarTypeClass::multimap:
+  case VarTypeClass::hash_map: {
+    ViewMap map = view.toMap();
+    std::vector<MapEntry> elements;
+    elements.reserve(map.getElementCount());
+    for(size_t i = 0, count = map.getElementCount(); i < count; ++i)
+      elements.push_back(MapEntry{.key = storeKey(map.getKey(i).toVariable()), .value = store(map.getValue(i))});
+    index.index.page = MapTree::create(file, index.type, elements).getRootPage();
+  } return index;
+
+  case VarTypeClass::table:
+  case VarTypeClass::invalid_type:
+  default:
+  throw err::Error(err::ErrorType::binom_invalid_type);
+  }
+}
+
+void FileStorageImplementation::loadNode(FileResourceIndex index, std::vector<byte>& buffer) {
+  append(buffer, index.type);
+  switch (toTypeClass(index.type)) {
+  case VarTypeClass::null: return;
+
+  case VarTypeClass::number: {
+    const byte* data = reinterpret_cast<const byte*>(&index.index);
+    buffer.insert(buffer.end(), data, data + size_t(toBitWidth(index.type)));
+  } return;
+
+  case VarTypeClass::bit_array:
+  case VarTypeClass::buffer_array: {
+    NodeStream stream = getStream(index, toTypeClass(index.type));
+    append(buffer, ui64(index.type == VarTypeClass::bit_array
+                        ? stream.getAux()
+                        : stream.getSize() / size_t(toBitWidth(index.type))));
+    const size_t position = buffer.size();
+    buffer.resize(position + stream.getSize());
+    stream.read(0, buffer.data() + position, stream.getSize());
+  } return;
+
+  case VarTypeClass::array:
+  case VarTypeClass::list: {
+    NodeStream stream = getStream(index, VarTypeClass::array);
+    std::vector<FileResourceIndex> elements(stream.getSize() / sizeof(FileResourceIndex));
+    stream.read(0, elements.data(), elements.size() * sizeof(FileResourceIndex));
+    append(buffer, ui64(elements.size()));
+    for(const FileResourceIndex& element : elements) loadNode(element, buffer);
+  } return;
+
+  case VarTypeClass::map:
+  case VarTypeClass::multimap:
+  case VarTypeClass::hash_map: {
+    const MapTree tree = getMapTree(index);
+    append(buffer, ui64(tree.getElementCount()));
+    tree.forEach([this, &buffer](const MapEntry& element) {
+      loadKeyNode(element.key, buffer);
+      loadNode(element.value, buffer);
+    });
+  } return;
+
+  case VarTypeClass::table:
+  case VarTypeClass::invalid_type:
+  default:
+  throw err::Error(err::ErrorType::invalid_data);
+  }
+}
+
+Variable FileStorageImplementation::load(FileResourceIndex index) {
+  std::vector<byte> buffer;
+  append(buffer, Header{.flags = FormatFlags::none});
+  loadNode(index, buffer);
+  return Variable::deserialize(buffer);
+}
+
+void FileStorageImplementation::destroy(FileResourceIndex index) {
+  switch (toTypeClass(index.type)) {
+  case VarTypeClass::null:
+  case VarTypeClass::number: return;
+
+  case VarTypeClass::bit_array:
+  case VarTypeClass::buffer_array:
+    getStream(index, toTypeClass(index.type)).destroy();
+  return;
+
+  case VarTypeClass::array:
+  case VarTypeClass::list: {
+    NodeStream stream = getStream(index, VarTypeClass::array);
+    std::vector<FileResourceIndex> elements(stream.getSize() / sizeof(FileResourceIndex));
+    stream.read(0, elements.data(), elements.size() * sizeof(FileResourceIndex));
+    for(const FileResourceIndex& element : elements) destroy(element);
+    stream.destroy();
+  } return;
+
+  case VarTypeClass::map:
+  case VarTypeClass::multimap:
+  case VarTypeClass::hash_map: {
+    MapTree tree = getMapTree(index);
+    tree.forEach([this](const MapEntry& element) {
+      destroy(element.key);
+      destroy(element.value);
+    });
+    tree.destroy();
+  } return;
+
+  case VarTypeClass::table:
+  case VarTypeClass::invalid_type:
+  default:
+  throw err::Error(err::ErrorType::invalid_data);
+  }
+}
+
+ui64 FileStorageImplementation::getGeneration(FileResourceIndex index) {
+  switch (toTypeClass(index.type)) {
+  case VarTypeClass::bit_array:
+  case VarTypeClass::buffer_array: return getStream(index, toTypeClass(index.type)).getGeneration();
+  case VarTypeClass::array:
+  case VarTypeClass::list: return getStream(index, VarTypeClass::array).getGeneration();
+  case VarTypeClass::map:
+  case VarTypeClass::multimap:
+  case VarTypeClass::hash_map: return getMapTree(index).getGeneration();
+  default: return 0;
+  }
+}
+
+bool FileStorageImplementation::isAlive(FileResourceIndex index, ui64 generation) {
+  if(!generation) return true;
+  if(!file.isPageUsed(index.index.page)) return false;
+  // Reused page may hold anything, so header which doesn't match node type is just other node
+  try { return getGeneration(index) == generation; }
+  catch(const err::Error& error) {
+    if(error.code() != err::ErrorType::invalid_data) throw;
+    return false;
+  }
+}
+
+void FileStorageImplementation::setRoot(const View& view) {
+  const FileResourceIndex old_root = file.getRoot();
+  file.setRoot(store(view));
+  destroy(old_root);
+  if(!isLogged()) return;
+  std::vector<byte> record;
+  append(record, LogRecordType::set_root);
+  append(record, view);
+  log(record);
+}
+
+size_t FileStorageImplementation::getElementCount(FileResourceIndex index) {
+  switch (toTypeClass(index.type)) {
+  case VarTypeClass::null: return 0;
+  case VarTypeClass::number: return 1;
+  case VarTypeClass::bit_array: return getStream(index, VarTypeClass::bit_array).getAux();
+  case VarTypeClass::buffer_array: return getStream(index, VarTypeClass::buffer_array).getSize() / size_t(toBitWidth(index.type));
+  case VarTypeClass::array:
+  case VarTypeClass::list: return getStream(index, VarTypeClass::array).getSize() / sizeof(FileResourceIndex);
+  case VarTypeClass::map:
+  case VarTypeClass::multimap:
+  case VarTypeClass::hash_map: return getMapTree(index).getElementCount();
+  case VarTypeClass::table:
+  case VarTypeClass::invalid_type:
+  default: return 0;
+  }
+}
+
+// Buffer array
+
+void FileStorageImplementation::readBuffer(FileResourceIndex index, size_t at, void* to, size_t count) {
+  NodeStream stream = getStream(index, VarTypeClass::buffer_array);
+  const size_t element_size = size_t(toBitWidth(index.type));
+  if(at > stream.getSize() / element_size || count > stream.getSize() / element_size - at)
+    throw err::Error(err::ErrorType::out_of_range);
+  stream.read(at * element_size, to, count * element_size);
+}
+
+void FileStorageImplementation::insertBuffer(FileResourceIndex index, size_t at, const void* data, size_t count) {
+  NodeStream stream = getStream(index, VarTypeClass::buffer_array);
+  const size_t element_size = size_t(toBitWidth(index.type));
+  if(at > stream.getSize() / element_size) throw err::Error(err::ErrorType::out_of_range);
+  stream.insert(at * element_size, data, count * element_size);
+  if(!isLogged()) return;
+  std::vector<byte> record;
+  append(record, LogRecordType::buffer_insert);
+  append(record, index);
+  append(record, ui64(at));
+  append(record, ui64(count));
+  append(record, data, count * element_size);
+  log(record);
+}
+
+void FileStorageImplementation::removeBuffer(FileResourceIndex index, size_t at, size_t count) {
+  NodeStream stream = getStream(index, VarTypeClass::buffer_array);
+  const size_t element_size = size_t(toBitWidth(index.type));
+  if(at > stream.getSize() / element_size || count > stream.getSize() / element_size - at)
+    throw err::Error(err::ErrorType::out_of_range);
+  stream.remove(at * element_size, count * element_size);
+  logRemove(LogRecordType::buffer_remove, index, at, count);
+}
+
+// Array
+
+FileResourceIndex FileStorageImplementation::getElement(FileResourceIndex index, size_t at) {
+  NodeStream stream = getStream(index, VarTypeClass::array);
+  if(at >= stream.getSize() / sizeof(FileResourceIndex)) throw err::Error(err::ErrorType::out_of_range);
+  return stream.read<FileResourceIndex>(at * sizeof(FileResourceIndex));
+}
+
+void FileStorageImplementation::insertElement(FileResourceIndex index, size_t at, const View& view) {
+  NodeStream stream = getStream(index, VarTypeClass::array);
+  if(at > stream.getSize() / sizeof(FileResourceIndex)) throw err::Error(err::ErrorType::out_of_range);
+  const FileResourceIndex element = store(view);
+  stream.insert(at * sizeof(FileResourceIndex), &element, sizeof(FileResourceIndex));
+  if(!isLogged()) return;
+  std::vector<byte> record;
+  append(record, LogRecordType::array_insert);
+  append(record, index);
+  append(record, ui64(at));
+  append(record, view);
+  log(record);
+}
+
+void FileStorageImplementation::removeElements(FileResourceIndex index, size_t at, size_t count) {
+  NodeStream stream = getStream(index, VarTypeClass::array);
+  const size_t element_count = stream.getSize() / sizeof(FileResourceIndex);
+  if(at > element_count || count > element_count - at) throw err::Error(err::ErrorType::out_of_range);
+  std::vector<FileResourceIndex> elements(count);
+  stream.read(at * sizeof(FileResourceIndex), elements.data(), count * sizeof(FileResourceIndex));
+  stream.remove(at * sizeof(FileResourceIndex), count * sizeof(FileResourceIndex));
+  for(const FileResourceIndex& element : elements) destroy(element);
+  logRemove(LogRecordType::array_remove, index, at, count);
+}
+
+// Map
+
+FileResourceIndex FileStorageImplementation::storeKey(const KeyValue& key) {
+  switch (key.getTypeClass()) {
+  case VarTypeClass::null:
+  case VarTypeClass::number: {
+    const std::vector<byte> key_data = key.toVariable().serialize();
+    return store(View(key_data));
+  }
+
+  case VarTypeClass::bit_array:
+  case VarTypeClass::buffer_array: {
+    std::vector<byte> encoding;
+    key.appendComparableEncoding(encoding);
+    NodeStream stream = NodeStream::create(file, key.getVarType());
+    stream.write(0, encoding.data(), encoding.size());
+    FileResourceIndex index{.type = key.getVarType()};
+    index.index.page = stream.getFirstPage();
+    return index;
+  }
+
+  default: throw err::Error(err::ErrorType::binom_invalid_type);
+  }
+}
+
+KeyValue FileStorageImplementation::loadKey(FileResourceIndex index) {
+  switch (index.type) {
+  case VarType::null: return KeyValue();
+  case VarType::boolean: return index.index.bool_val;
+  case VarType::ui8: return index.index.ui8_val;
+  case VarType::si8: return index.index.i8_val;
+  case VarType::ui16: return index.index.ui16_val;
+  case VarType::si16: return index.index.i16_val;
+  case VarType::ui32: return index.index.ui32_val;
+  case VarType::si32: return index.index.i32_val;
+  case VarType::f32: return index.index.f32_val;
+  case VarType::ui64: return index.index.ui64_val;
+  case VarType::si64: return index.index.i64_val;
+  case VarType::f64: return index.index.f64_val;
+  default: break;
+  }
+
+  switch (toTypeClass(index.type)) {
+  case VarTypeClass::bit_array:
+  case VarTypeClass::buffer_array: {
+    NodeStream stream = getStream(index, toTypeClass(index.type));
+    std::vector<byte> encoding(stream.getSize());
+    stream.read(0, encoding.data(), encoding.size());
+    return KeyValue::fromComparableEncoding(encoding.data(), encoding.size());
+  }
+
+  default: throw err::Error(err::ErrorType::invalid_data);
+  }
+}
+
+void FileStorageImplementation::loadKeyNode(FileResourceIndex index, std::vector<byte>& buffer) {
+  switch (toTypeClass(index.type)) {
+  case VarTypeClass::bit_array:
+  case VarTypeClass::buffer_array: {
+    const std::vector<byte> key_data = loadKey(index).toVariable().serialize();
+    buffer.insert(buffer.end(), key_data.begin() + sizeof(Header), key_data.end());
+  } return;
+  default: loadNode(index, buffer);
+  }
+}
+
+KeyValue::CompareResult FileStorageImplementation::compareKey(FileResourceIndex index,
+                                                              const std::vector<byte>& key_encoding,
+                                                              std::vector<byte>& buffer) {
+  buffer.clear();
+  switch (toTypeClass(index.type)) {
+  case VarTypeClass::null:
+  case VarTypeClass::number: loadKey(index).appendComparableEncoding(buffer); break;
+
+  case VarTypeClass::bit_array:
+  case VarTypeClass::buffer_array: {
+    NodeStream stream = getStream(index, toTypeClass(index.type));
+    // Stored key is longer than other key if their common bytes are equal, so one more byte decides order
+    buffer.resize(std::min<size_t>(stream.getSize(), key_encoding.size() + 1));
+    stream.read(0, buffer.data(), buffer.size());
+  } break;
+
+  default: throw err::Error(err::ErrorType::invalid_data);
+  }
+
+  const size_t common_size = std::min(buffer.size(), key_encoding.size());
+  if(const int result = common_size ? std::memcmp(buffer.data(), key_encoding.data(), common_size) : 0)
+    return result > 0 ? KeyValue::CompareResult::highter : KeyValue::CompareResult::lower;
+  if(buffer.size() == key_encoding.size()) return KeyValue::CompareResult::equal;
+  return buffer.size() > key_encoding.size() ? KeyValue::CompareResult::highter : KeyValue::CompareResult::lower;
+}
+
+size_t FileStorageImplementation::searchKey(const MapTree& tree, const std::vector<byte>& key_encoding, bool upper_bound) {
+  std::vector<byte> buffer;
+  return tree.search([this, &key_encoding, &buffer](FileResourceIndex key) {return compareKey(key, key_encoding, buffer);}, upper_bound);
+}
+
+bool FileStorageImplementation::isKeyAt(const MapTree& tree, size_t position, const std::vector<byte>& key_encoding) {
+  if(position >= tree.getElementCount()) return false;
+  std::vector<byte> buffer;
+  return compareKey(tree.get(position).key, key_encoding, buffer) == KeyValue::CompareResult::equal;
+}
+
+FileStorageImplementation::MapEntry FileStorageImplementation::getMapEntry(FileResourceIndex index, size_t at) {
+  return getMapTree(index).get(at);
+}
+
+KeyValue FileStorageImplementation::getMapKey(FileResourceIndex index, size_t at) {return loadKey(getMapEntry(index, at).key);}
+
+size_t FileStorageImplementation::findKey(FileResourceIndex index, const KeyValue& key) {
+  const MapTree tree = getMapTree(index);
+  const std::vector<byte> key_encoding = key.getComparableEncoding();
+  const size_t position = searchKey(tree, key_encoding, false);
+  if(isKeyAt(tree, position, key_encoding)) return position;
+  return tree.getElementCount();
+}
+
+std::pair<size_t, size_t> FileStorageImplementation::findKeyRange(FileResourceIndex index, const KeyValue& key) {
+  const MapTree tree = getMapTree(index);
+  const std::vector<byte> key_encoding = key.getComparableEncoding();
+  return {searchKey(tree, key_encoding, false), searchKey(tree, key_encoding, true)};
+}
+
+size_t FileStorageImplementation::insertMapElement(FileResourceIndex index, const KeyValue& key, const View& value) {
+  MapTree tree = getMapTree(index);
+  const std::vector<byte> key_encoding = key.getComparableEncoding();
+  size_t position;
+  if(index.type != VarType::multimap) {
+    position = searchKey(tree, key_encoding, false);
+    if(isKeyAt(tree, position, key_encoding)) throw err::Error(err::ErrorType::binom_key_unique_error);
+  } else position = searchKey(tree, key_encoding, true);
+
+  tree.insert(position, MapEntry{.key = storeKey(key), .value = store(value)});
+  if(isLogged()) {
+    std::vector<byte> record;
+    append(record, LogRecordType::map_insert);
+    append(record, index);
+    append(record, View(key.toVariable().serialize()));
+    append(record, value);
+    log(record);
+  }
+  return position;
+}
+
+void FileStorageImplementation::removeMapElements(FileResourceIndex index, size_t at, size_t count) {
+  MapTree tree = getMapTree(index);
+  const size_t element_count = tree.getElementCount();
+  if(at > element_count || count > element_count - at) throw err::Error(err::ErrorType::out_of_range);
+  std::vector<MapEntry> elements;
+  elements.reserve(count);
+  while(elements.size() < count) elements.push_back(tree.remove(at));
+  for(const MapEntry& element : elements) {
+    destroy(element.key);
+    destroy(element.value);
+  }
+  logRemove(LogRecordType::map_remove, index, at, count);
+}
+
+size_t FileStorageImplementation::renameMapElements(FileResourceIndex index, const KeyValue& old_key, const KeyValue& new_key) {
+  MapTree tree = getMapTree(index);
+  const std::vector<byte> old_key_encoding = old_key.getComparableEncoding();
+  const std::vector<byte> new_key_encoding = new_key.getComparableEncoding();
+  const size_t first = searchKey(tree, old_key_encoding, false), last = searchKey(tree, old_key_encoding, true);
+  if(first == last || old_key_encoding == new_key_encoding) return last - first;
+  if(index.type != VarType::multimap && isKeyAt(tree, searchKey(tree, new_key_encoding, false), new_key_encoding))
+    throw err::Error(err::ErrorType::binom_key_unique_error);
+
+  std::vector<MapEntry> elements;
+  elements.reserve(last - first);
+  while(elements.size() < last - first) elements.push_back(tree.remove(first));
+
+  const size_t position = searchKey(tree, new_key_encoding, true);
+  for(MapEntry& element : elements) {
+    destroy(element.key);
+    element.key = storeKey(new_key);
+  }
+  for(size_t i = 0; i < elements.size(); ++i) tree.insert(position + i, elements[i]);
+  if(isLogged()) {
+    std::vector<byte> record;
+    append(record, LogRecordType::map_rename);
+    append(record, index);
+    append(record, View(old_key.toVariable().serialize()));
+    append(record, View(new_key.toVariable().serialize()));
+    log(record);
+  }
+  return elements.size();
+}
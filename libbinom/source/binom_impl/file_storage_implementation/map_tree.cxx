@@ -0,0 +1,291 @@
+#include "libbinom/include/binom_impl/file_storage_implementation/map_tree.hxx"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+using namespace binom;
+using namespace binom::priv;
+
+namespace {
+
+template<typename T>
+ui64 countElements(const T* entries, size_t count) noexcept {
+  if constexpr (std::is_same_v<T, MapTree::Entry>) return count;
+  else {
+    ui64 element_count = 0;
+    for(const T* it = entries, *end = entries + count; it != end; ++it) element_count += it->element_count;
+    return element_count;
+  }
+}
+
+//! Index of child containing position, position is made relative to it.
+//! Position at the end of child is allowed for insert
+template<typename T>
+size_t findChild(const std::vector<T>& children, ui64& position, bool is_end_allowed) {
+  for(size_t i = 0; i < children.size(); ++i) {
+    if(position < children[i].element_count || (is_end_allowed && position == children[i].element_count)) return i;
+    position -= children[i].element_count;
+  }
+  throw err::Error(err::ErrorType::invalid_data);
+}
+
+}
+
+MapTree::MapTree(PagedFile& file, PageIndex root_page)
+  : MapTree(file, root_page, file.read<NodeHeader>(root_page, 0)) {
+  if(root_header.entry_count > (root_header.is_leaf ? getLeafCapacity() : getInnerCapacity()))
+    throw err::Error(err::ErrorType::invalid_data);
+}
+
+MapTree::NodeHeader MapTree::readHeader(PageIndex page) const {
+  const NodeHeader header = file->read<NodeHeader>(page, 0);
+  if(header.type != root_header.type || header.entry_count > (header.is_leaf ? getLeafCapacity() : getInnerCapacity()))
+    throw err::Error(err::ErrorType::invalid_data);
+  return header;
+}
+
+template<typename T>
+std::vector<T> MapTree::readEntries(PageIndex page, const NodeHeader& header) const {
+  std::vector<T> entries(header.entry_count);
+  if(!entries.empty()) file->read(page, sizeof(NodeHeader), entries.data(), entries.size() * sizeof(T));
+  return entries;
+}
+
+template<typename T>
+void MapTree::writeNode(PageIndex page, const NodeHeader& header, const T* entries) {
+  file->write(page, 0, header);
+  if(header.entry_count) file->write(page, sizeof(NodeHeader), entries, header.entry_count * sizeof(T));
+}
+
+template<typename T>
+std::optional<MapTree::ChildEntry> MapTree::writeSplit(PageIndex page, NodeHeader header, const std::vector<T>& entries, size_t capacity) {
+  const size_t left_count = entries.size() <= capacity ? entries.size() : entries.size() / 2;
+  header.entry_count = ui32(left_count);
+  header.element_count = countElements(entries.data(), left_count);
+  writeNode(page, header, entries.data());
+  if(left_count == entries.size()) return std::nullopt;
+
+  const NodeHeader right_header{
+    .type = header.type,
+    .is_leaf = header.is_leaf,
+    .entry_count = ui32(entries.size() - left_count),
+    .element_count = countElements(entries.data() + left_count, entries.size() - left_count)
+  };
+  const PageIndex right_page = file->allocatePage();
+  writeNode(right_page, right_header, entries.data() + left_count);
+  return ChildEntry{right_page, right_header.element_count};
+}
+
+template<typename T>
+std::vector<MapTree::ChildEntry> MapTree::buildLevel(const std::vector<T>& entries, size_t capacity) {
+  // Entries are spread evenly, so nodes are at least half full
+  const size_t node_count = (entries.size() + capacity - 1) / capacity;
+  std::vector<ChildEntry> nodes;
+  nodes.reserve(node_count);
+  for(size_t i = 0, first = 0; i < node_count; ++i) {
+    const size_t count = entries.size() / node_count + (i < entries.size() % node_count);
+    const NodeHeader header{
+      .type = root_header.type,
+      .is_leaf = std::is_same_v<T, Entry>,
+      .entry_count = ui32(count),
+      .element_count = countElements(entries.data() + first, count)
+    };
+    const PageIndex page = file->allocatePage();
+    writeNode(page, header, entries.data() + first);
+    nodes.push_back(ChildEntry{page, header.element_count});
+    first += count;
+  }
+  return nodes;
+}
+
+MapTree MapTree::create(PagedFile& file, VarType type, const std::vector<Entry>& entries) {
+  MapTree tree(file, 0, NodeHeader{.type = type, .element_count = entries.size()});
+  if(entries.size() <= tree.getLeafCapacity()) {
+    tree.root_header.entry_count = ui32(entries.size());
+    tree.root_header.generation = file.nextGeneration();
+    tree.root_page = file.allocatePage();
+    tree.writeNode(tree.root_page, tree.root_header, entries.data());
+    return tree;
+  }
+
+  // Levels are built bottom-up, root is allocated last
+  std::vector<ChildEntry> level = tree.buildLevel(entries, tree.getLeafCapacity());
+  while(level.size() > tree.getInnerCapacity()) level = tree.buildLevel(level, tree.getInnerCapacity());
+  tree.root_header.is_leaf = false;
+  tree.root_header.entry_count = ui32(level.size());
+  tree.root_header.generation = file.nextGeneration();
+  tree.root_page = file.allocatePage();
+  tree.writeNode(tree.root_page, tree.root_header, level.data());
+  return tree;
+}
+
+FileResourceIndex MapTree::getFirstKey(PageIndex page) const {
+  NodeHeader header = readHeader(page);
+  while(!header.is_leaf) {
+    if(!header.entry_count) throw err::Error(err::ErrorType::invalid_data);
+    page = file->read<ChildEntry>(page, sizeof(NodeHeader)).page;
+    header = readHeader(page);
+  }
+  if(!header.entry_count) throw err::Error(err::ErrorType::invalid_data);
+  return file->read<Entry>(page, sizeof(NodeHeader)).key;
+}
+
+MapTree::Entry MapTree::get(ui64 position) const {
+  if(position >= root_header.element_count) throw err::Error(err::ErrorType::out_of_range);
+  PageIndex page = root_page;
+  for(NodeHeader header = root_header; !header.is_leaf; header = readHeader(page)) {
+    const std::vector<ChildEntry> children = readEntries<ChildEntry>(page, header);
+    page = children[findChild(children, position, false)].page;
+  }
+  if(position >= readHeader(page).entry_count) throw err::Error(err::ErrorType::invalid_data);
+  return file->read<Entry>(page, sizeof(NodeHeader) + position * sizeof(Entry));
+}
+
+ui64 MapTree::search(const KeyCompare& compare, bool upper_bound) const {
+  // Stored key precedes searched position
+  auto isBefore = [&compare, upper_bound](FileResourceIndex key) {
+    const KeyValue::CompareResult result = compare(key);
+    return result == KeyValue::CompareResult::lower || (upper_bound && result == KeyValue::CompareResult::equal);
+  };
+
+  ui64 position = 0;
+  PageIndex page = root_page;
+  for(NodeHeader header = root_header;; header = readHeader(page)) {
+    if(header.is_leaf) {
+      const std::vector<Entry> entries = readEntries<Entry>(page, header);
+      return position + (std::partition_point(entries.cbegin(), entries.cend(),
+                                              [&isBefore](const Entry& entry) {return isBefore(entry.key);}) - entries.cbegin());
+    }
+
+    const std::vector<ChildEntry> children = readEntries<ChildEntry>(page, header);
+    if(children.empty()) throw err::Error(err::ErrorType::invalid_data);
+    // Searched position is in the last child starting before it or at the end of that child
+    const size_t child = std::partition_point(children.cbegin() + 1, children.cend(), [this, &isBefore](const ChildEntry& child) {
+      return isBefore(getFirstKey(child.page));
+    }) - children.cbegin() - 1;
+    position += countElements(children.data(), child);
+    page = children[child].page;
+  }
+}
+
+std::optional<MapTree::ChildEntry> MapTree::insert(PageIndex page, ui64 position, const Entry& entry) {
+  const NodeHeader header = readHeader(page);
+  if(header.is_leaf) {
+    std::vector<Entry> entries = readEntries<Entry>(page, header);
+    if(position > entries.size()) throw err::Error(err::ErrorType::invalid_data);
+    entries.insert(entries.begin() + position, entry);
+    return writeSplit(page, header, entries, getLeafCapacity());
+  }
+
+  std::vector<ChildEntry> children = readEntries<ChildEntry>(page, header);
+  const size_t child = findChild(children, position, true);
+  const std::optional<ChildEntry> right = insert(children[child].page, position, entry);
+  ++children[child].element_count;
+  if(right) {
+    children[child].element_count -= right->element_count;
+    children.insert(children.begin() + child + 1, *right);
+  }
+  return writeSplit(page, header, children, getInnerCapacity());
+}
+
+void MapTree::insert(ui64 position, const Entry& entry) {
+  if(position > root_header.element_count) throw err::Error(err::ErrorType::out_of_range);
+  const std::optional<ChildEntry> right = insert(root_page, position, entry);
+  NodeHeader header = readHeader(root_page);
+  if(right) {
+    // Left half of root moves to new page, so root page stays in place
+    const size_t page_size = file->getPageSize();
+    std::unique_ptr<byte[]> data(new byte[page_size]);
+    file->read(root_page, 0, data.get(), page_size);
+    const PageIndex left_page = file->allocatePage();
+    file->write(left_page, 0, data.get(), page_size);
+    file->write(left_page, offsetof(NodeHeader, generation), ui64(0));
+
+    const ChildEntry children[] = {{left_page, header.element_count}, *right};
+    header.is_leaf = false;
+    header.entry_count = 2;
+    header.element_count += right->element_count;
+    writeNode(root_page, header, children);
+  }
+  root_header = header;
+}
+
+MapTree::Entry MapTree::remove(PageIndex page, ui64 position, bool& is_emptied) {
+  NodeHeader header = readHeader(page);
+  Entry entry;
+  if(header.is_leaf) {
+    std::vector<Entry> entries = readEntries<Entry>(page, header);
+    if(position >= entries.size()) throw err::Error(err::ErrorType::invalid_data);
+    entry = entries[position];
+    entries.erase(entries.begin() + position);
+    header.entry_count = ui32(entries.size());
+    header.element_count = entries.size();
+    writeNode(page, header, entries.data());
+  } else {
+    std::vector<ChildEntry> children = readEntries<ChildEntry>(page, header);
+    const size_t child = findChild(children, position, false);
+    bool is_child_emptied = false;
+    entry = remove(children[child].page, position, is_child_emptied);
+    if(is_child_emptied) {
+      file->freePage(children[child].page);
+      children.erase(children.begin() + child);
+    } else --children[child].element_count;
+    header.entry_count = ui32(children.size());
+    header.element_count = countElements(children.data(), children.size());
+    writeNode(page, header, children.data());
+  }
+  is_emptied = !header.entry_count;
+  return entry;
+}
+
+MapTree::Entry MapTree::remove(ui64 position) {
+  if(position >= root_header.element_count) throw err::Error(err::ErrorType::out_of_range);
+  bool is_emptied = false;
+  const Entry entry = remove(root_page, position, is_emptied);
+  NodeHeader header = readHeader(root_page);
+
+  // Root with single child is replaced by it, so tree height shrinks with map
+  const size_t page_size = file->getPageSize();
+  std::unique_ptr<byte[]> data;
+  while(!header.is_leaf && header.entry_count == 1) {
+    const PageIndex child = file->read<ChildEntry>(root_page, sizeof(NodeHeader)).page;
+    if(!data) data.reset(new byte[page_size]);
+    file->read(child, 0, data.get(), page_size);
+    file->write(root_page, 0, data.get(), page_size);
+    file->write(root_page, offsetof(NodeHeader, generation), root_header.generation);
+    file->freePage(child);
+    header = readHeader(root_page);
+  }
+  if(!header.is_leaf && !header.entry_count) {
+    header.is_leaf = true;
+    writeNode<Entry>(root_page, header, nullptr);
+  }
+  root_header = header;
+  return entry;
+}
+
+void MapTree::forEach(PageIndex page, const std::function<void(const Entry&)>& callback) const {
+  const NodeHeader header = readHeader(page);
+  if(header.is_leaf) {
+    for(const Entry& entry : readEntries<Entry>(page, header)) callback(entry);
+    return;
+  }
+  for(const ChildEntry& child : readEntries<ChildEntry>(page, header)) forEach(child.page, callback);
+}
+
+void MapTree::forEach(const std::function<void(const Entry&)>& callback) const {forEach(root_page, callback);}
+
+void MapTree::destroy(PageIndex page) {
+  const NodeHeader header = readHeader(page);
+  if(!header.is_leaf)
+    for(const ChildEntry& child : readEntries<ChildEntry>(page, header)) destroy(child.page);
+  file->freePage(page);
+}
+
+void MapTree::destroy() {
+  destroy(root_page);
+  root_page = 0;
+  root_header = NodeHeader{.type = root_header.type};
+}
@@ -0,0 +1,217 @@
+#include "libbinom/include/binom_impl/file_storage_implementation/mapped_file.hxx"
+#include "libbinom/include/binom_impl/ram_storage_implementation.hxx"
+#include "libbinom/include/variables/map.hxx"
+#include "libbinom/include/variables/multi_map.hxx"
+
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace binom;
+using namespace binom::priv;
+using namespace binom::priv::serialization;
+
+MappedFile::MappedFile(const std::string& path) {
+  const int file_descriptor = ::open(path.c_str(), O_RDONLY);
+  if(file_descriptor < 0) throw err::Error(err::ErrorType::file_open_error);
+
+  struct stat file_stat;
+  if(::fstat(file_descriptor, &file_stat)) {
+    ::close(file_descriptor);
+    throw err::Error(err::ErrorType::file_open_error);
+  }
+
+  size = file_stat.st_size;
+  if(size) {
+    void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+    if(mapping == MAP_FAILED) {
+      ::close(file_descriptor);
+      throw err::Error(err::ErrorType::file_open_error);
+    }
+    data = reinterpret_cast<const byte*>(mapping);
+    // Nodes are touched in order of access paths, not sequentially
+    ::madvise(mapping, size, MADV_RANDOM);
+  }
+  // Mapping stays valid after descriptor is closed
+  ::close(file_descriptor);
+
+  try {
+    getRootView();
+  } catch(...) {
+    if(data) ::munmap(const_cast<byte*>(data), size);
+    throw;
+  }
+}
+
+MappedFile::~MappedFile() {
+  if(data) ::munmap(const_cast<byte*>(data), size);
+}
+
+MappedFile* MappedFile::open(const std::string& path) {return new MappedFile(path);}
+
+void MappedFile::acquire() noexcept {++link_counter;}
+
+void MappedFile::release() noexcept {
+  if(!--link_counter) delete this;
+}
+
+View MappedFile::getRootView() const {return View(data, size);}
+
+View MappedFile::getView(ui64 offset) const {
+  if(offset >= size) throw err::Error(err::ErrorType::invalid_data);
+  return View(data + offset, data + size);
+}
+
+FileResourceIndex MappedFile::getIndex(const View& view) const {
+  FileResourceIndex index{.type = view.getType()};
+  if(view.node + view.getNodeSize() > view.buffer_end) throw err::Error(err::ErrorType::invalid_data);
+  switch (toTypeClass(index.type)) {
+  case VarTypeClass::null: return index;
+  case VarTypeClass::number:
+    std::memcpy(&index.index, view.node + sizeof(VarType), size_t(toBitWidth(index.type)));
+  return index;
+  default:
+    index.index.offset = view.node - data;
+  return index;
+  }
+}
+
+Link MappedFile::materialize(FileResourceIndex index) {
+  ++materialized_count;
+  const VarType type = index.type;
+
+  auto decodeKey = [](const View& key) {
+    const size_t node_size = key.getNodeSize();
+    if(node_size > size_t(key.buffer_end - key.node)) throw err::Error(err::ErrorType::invalid_data);
+    MemoryReader reader(key.node, node_size);
+    return Variable::deserializeKeyImpl(reader);
+  };
+
+  try {
+    const View view = getView(index.index.offset);
+    if(view.getType() != type || view.getNodeSize() > size_t(view.buffer_end - view.node))
+      throw err::Error(err::ErrorType::invalid_data);
+
+    switch (toTypeClass(type)) {
+    case VarTypeClass::bit_array: {
+      BitArrayImplementation* implementation = BitArrayImplementation::create(view.getElementCount());
+      std::memcpy(implementation->getDataAs<byte>(), view.node + container_header_size, implementation->getByteSize());
+    return ResourceData{type, {.bit_array_implementation = implementation}};
+    }
+
+    case VarTypeClass::buffer_array: {
+      const ViewBufferArray buffer_array = view.toBufferArray();
+      const size_t element_count = buffer_array.getElementCount();
+      ResourceData resource_data{type, {.buffer_array_storage = BufferArrayImplementation::create(view.getBitWidth(), element_count)}};
+      std::memcpy(BufferArrayImplementation::getData(resource_data.data.buffer_array_storage), buffer_array.getData(), element_count * size_t(view.getBitWidth()));
+    return resource_data;
+    }
+
+    case VarTypeClass::array: {
+      const ViewArray array = view.toArray();
+      size_t element_index = 0;
+      return ResourceData{type, {.array_implementation =
+        ArrayImplementation::create(array.getElementCount(), [this, &array, &element_index]() {
+          return Variable(Link(this, getIndex(array[element_index++])));
+        })
+      }};
+    }
+
+    case VarTypeClass::list: {
+      const ViewArray array = view.toArray();
+      ListImplementation* implementation = new ListImplementation();
+      Variable variable(ResourceData{type, {.list_implementation = implementation}});
+      for(const View element : array)
+        implementation->insert(implementation->end(), Variable(Link(this, getIndex(element))));
+      return std::move(variable.resource_link);
+    }
+
+    case VarTypeClass::map: {
+      const ViewMap map = view.toMap();
+      MapImplementation* implementation = new MapImplementation();
+      Variable variable(ResourceData{type, {.map_implementation = implementation}});
+      size_t index = 0;
+      if(implementation->bulkLoadChecked(map.getElementCount(), [&]() {
+           const size_t i = index++;
+           return std::pair<KeyValue, Variable>(decodeKey(map.getKey(i)), Variable(Link(this, getIndex(map.getValue(i)))));
+         }))
+        throw err::Error(err::ErrorType::invalid_data);
+      return std::move(variable.resource_link);
+    }
+
+    case VarTypeClass::multimap: {
+      const ViewMap map = view.toMap();
+      MultiMapImplementation* implementation = new MultiMapImplementation();
+      Variable variable(ResourceData{type, {.multi_map_implementation = implementation}});
+      size_t index = 0;
+      if(implementation->bulkLoadChecked(map.getElementCount(), [&]() {
+           const size_t i = index++;
+           return std::pair<KeyValue, Variable>(decodeKey(map.getKey(i)), Variable(Link(this, getIndex(map.getValue(i)))));
+         }))
+        throw err::Error(err::ErrorType::invalid_data);
+      return std::move(variable.resource_link);
+    }
+
+    case VarTypeClass::hash_map: {
+      const ViewMap map = view.toMap();
+      HashMapImplementation* implementation = new HashMapImplementation();
+      Variable variable(ResourceData{type, {.hash_map_implementation = implementation}});
+      implementation->reserve(map.getElementCount());
+      for(size_t i = 0, count = map.getElementCount(); i < count; ++i)
+        if(implementation->insert(decodeKey(map.getKey(i)), Variable(Link(this, getIndex(map.getValue(i))))))
+          throw err::Error(err::ErrorType::invalid_data);
+      return std::move(variable.resource_link);
+    }
+
+    default: throw err::Error(err::ErrorType::invalid_data);
+    }
+  } catch(const err::Error&) {
+    ++error_count;
+    throw;
+  }
+}
+
+bool MappedFile::verifyNode(const View& view) const {
+  if(view.getNodeSize() > size_t(view.buffer_end - view.node)) return false;
+  switch (view.getTypeClass()) {
+  case VarTypeClass::null:
+  case VarTypeClass::number:
+  case VarTypeClass::bit_array:
+  case VarTypeClass::buffer_array: return true;
+
+  case VarTypeClass::array:
+  case VarTypeClass::list:
+    for(const View element : view.toArray())
+      if(!verifyNode(element)) return false;
+  return true;
+
+  case VarTypeClass::map:
+  case VarTypeClass::multimap:
+  case VarTypeClass::hash_map: {
+    const ViewMap map = view.toMap();
+    for(size_t i = 0, count = map.getElementCount(); i < count; ++i) {
+      const View key = map.getKey(i);
+      switch (key.getTypeClass()) {
+      case VarTypeClass::null:
+      case VarTypeClass::number:
+      case VarTypeClass::bit_array:
+      case VarTypeClass::buffer_array: break;
+      default: return false;
+      }
+      if(!verifyNode(key) || !verifyNode(map.getValue(i))) return false;
+    }
+  } return true;
+
+  default: return false;
+  }
+}
+
+bool MappedFile::verify() const {
+  try {
+    return verifyNode(getRootView());
+  } catch(const err::Error&) {
+    return false;
+  }
+}
@@ -0,0 +1,181 @@
+#include "libbinom/include/binom_impl/file_storage_implementation/node_stream.hxx"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+
+using namespace binom;
+using namespace binom::priv;
+
+NodeStream::NodeStream(PagedFile& file, PageIndex first_page, DirectoryHeader header)
+  : file(&file), first_page(first_page), header(header), directory_pages{first_page} {file.pin(first_page);}
+
+NodeStream::NodeStream(PagedFile& file, PageIndex first_page)
+  : NodeStream(file, first_page, file.read<DirectoryHeader>(first_page, 0)) {}
+
+NodeStream::NodeStream(const NodeStream& other)
+  : file(other.file), first_page(other.first_page), header(other.header), directory_pages(other.directory_pages) {
+  if(first_page) file->pin(first_page);
+}
+
+NodeStream::NodeStream(NodeStream&& other) noexcept
+  : file(other.file), first_page(other.first_page), header(other.header), directory_pages(std::move(other.directory_pages)) {
+  other.first_page = 0;
+}
+
+NodeStream::~NodeStream() {
+  if(first_page) file->unpin(first_page);
+}
+
+NodeStream& NodeStream::operator=(const NodeStream& other) {
+  if(this == &other) return self;
+  return self = NodeStream(other);
+}
+
+NodeStream& NodeStream::operator=(NodeStream&& other) noexcept {
+  if(this == &other) return self;
+  if(first_page) file->unpin(first_page);
+  file = other.file;
+  first_page = other.first_page;
+  header = other.header;
+  directory_pages = std::move(other.directory_pages);
+  other.first_page = 0;
+  return self;
+}
+
+NodeStream NodeStream::create(PagedFile& file, VarType type) {
+  const DirectoryHeader header{.type = type, .generation = file.nextGeneration()};
+  const PageIndex page = file.allocatePage();
+  file.write(page, 0, header);
+  return NodeStream(file, page, header);
+}
+
+void NodeStream::loadDirectory(size_t directory_index) {
+  while(directory_pages.size() <= directory_index) {
+    const PageIndex next = directory_pages.size() == 1
+                           ? header.next_directory
+                           : file->read<PageIndex>(directory_pages.back(), offsetof(DirectoryHeader, next_directory));
+    if(!next) throw err::Error(err::ErrorType::invalid_data);
+    directory_pages.push_back(next);
+  }
+}
+
+PageIndex NodeStream::getDataPage(ui64 data_page) {
+  const size_t directory_index = data_page / getDirectoryCapacity();
+  loadDirectory(directory_index);
+  return file->read<PageIndex>(directory_pages[directory_index], getEntryOffset(data_page));
+}
+
+void NodeStream::writeHeader() {file->write(first_page, 0, header);}
+
+void NodeStream::addDataPage() {
+  const ui64 data_page = getDataPageCount();
+  const size_t directory_index = data_page / getDirectoryCapacity();
+
+  if(directory_index && data_page % getDirectoryCapacity() == 0) {
+    loadDirectory(directory_index - 1);
+    const PageIndex directory = file->allocatePage();
+    file->write(directory, 0, DirectoryHeader());
+    if(directory_index == 1) header.next_directory = directory;
+    else file->write<PageIndex>(directory_pages.back(), offsetof(DirectoryHeader, next_directory), directory);
+    directory_pages.push_back(directory);
+  } else loadDirectory(directory_index);
+
+  const PageIndex page = file->allocatePage();
+  file->write<PageIndex>(directory_pages[directory_index], getEntryOffset(data_page), page);
+  if(directory_index) file->write<ui32>(directory_pages[directory_index], offsetof(DirectoryHeader, page_count), data_page % getDirectoryCapacity() + 1);
+  else ++header.page_count;
+  header.size = (data_page + 1) * file->getPageSize();
+}
+
+void NodeStream::removeDataPage() {
+  const ui64 data_page = getDataPageCount() - 1;
+  const size_t directory_index = data_page / getDirectoryCapacity();
+
+  file->freePage(getDataPage(data_page));
+  if(directory_index) file->write<ui32>(directory_pages[directory_index], offsetof(DirectoryHeader, page_count), data_page % getDirectoryCapacity());
+  else --header.page_count;
+
+  if(directory_index && data_page % getDirectoryCapacity() == 0) {
+    file->freePage(directory_pages[directory_index]);
+    directory_pages.pop_back();
+    if(directory_index == 1) header.next_directory = 0;
+    else file->write<PageIndex>(directory_pages.back(), offsetof(DirectoryHeader, next_directory), PageIndex(0));
+  }
+  header.size = data_page * file->getPageSize();
+}
+
+void NodeStream::setAux(ui64 aux) {
+  header.aux = aux;
+  writeHeader();
+}
+
+void NodeStream::read(ui64 offset, void* to, size_t size) {
+  if(offset > header.size || size > header.size - offset) throw err::Error(err::ErrorType::invalid_data);
+  byte* it = reinterpret_cast<byte*>(to);
+  const size_t page_size = file->getPageSize();
+  while(size) {
+    const size_t in_page_offset = offset % page_size;
+    const size_t chunk_size = std::min(size, page_size - in_page_offset);
+    file->read(getDataPage(offset / page_size), in_page_offset, it, chunk_size);
+    it += chunk_size;
+    offset += chunk_size;
+    size -= chunk_size;
+  }
+}
+
+void NodeStream::write(ui64 offset, const void* from, size_t size) {
+  if(offset + size > header.size) resize(offset + size);
+  const byte* it = reinterpret_cast<const byte*>(from);
+  const size_t page_size = file->getPageSize();
+  while(size) {
+    const size_t in_page_offset = offset % page_size;
+    const size_t chunk_size = std::min(size, page_size - in_page_offset);
+    file->write(getDataPage(offset / page_size), in_page_offset, it, chunk_size);
+    it += chunk_size;
+    offset += chunk_size;
+    size -= chunk_size;
+  }
+}
+
+void NodeStream::insert(ui64 offset, const void* from, size_t size) {
+  if(offset > header.size) throw err::Error(err::ErrorType::out_of_range);
+  ui64 tail_size = header.size - offset;
+  resize(header.size + size);
+  std::unique_ptr<byte[]> buffer(new byte[file->getPageSize()]);
+  while(tail_size) {
+    const size_t chunk_size = std::min<ui64>(tail_size, file->getPageSize());
+    tail_size -= chunk_size;
+    read(offset + tail_size, buffer.get(), chunk_size);
+    write(offset + tail_size + size, buffer.get(), chunk_size);
+  }
+  write(offset, from, size);
+}
+
+void NodeStream::remove(ui64 offset, size_t size) {
+  if(offset > header.size || size > header.size - offset) throw err::Error(err::ErrorType::out_of_range);
+  std::unique_ptr<byte[]> buffer(new byte[file->getPageSize()]);
+  for(ui64 position = offset + size; position < header.size;) {
+    const size_t chunk_size = std::min<ui64>(header.size - position, file->getPageSize());
+    read(position, buffer.get(), chunk_size);
+    write(position - size, buffer.get(), chunk_size);
+    position += chunk_size;
+  }
+  resize(header.size - size);
+}
+
+void NodeStream::resize(ui64 size) {
+  const size_t page_size = file->getPageSize();
+  const ui64 data_page_count = (size + page_size - 1) / page_size;
+  while(getDataPageCount() < data_page_count) addDataPage();
+  while(getDataPageCount() > data_page_count) removeDataPage();
+  header.size = size;
+  writeHeader();
+}
+
+void NodeStream::destroy() {
+  resize(0);
+  file->unpin(first_page);
+  file->freePage(first_page);
+  first_page = 0;
+}
@@ -0,0 +1,206 @@
+#include "libbinom/include/binom_impl/file_storage_implementation/paged_file.hxx"
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace binom;
+using namespace binom::priv;
+
+PagedFile::PagedFile(const std::string& path, ui32 page_size, size_t cache_size, CacheEvictionPolicy policy, bool is_journaled) {
+  file_descriptor = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+  if(file_descriptor < 0) throw err::Error(err::ErrorType::file_open_error);
+
+  struct stat file_stat;
+  if(::fstat(file_descriptor, &file_stat)) {
+    ::close(file_descriptor);
+    throw err::Error(err::ErrorType::file_open_error);
+  }
+
+  if(!file_stat.st_size) {
+    if(page_size < min_page_size || (page_size & (page_size - 1))) page_size = default_page_size;
+    header.page_size = page_size;
+    header.page_count = 1;
+    writeHeader();
+    initGroup(0);
+    pool.reset(new BufferPool(self, header.page_size, cache_size, policy));
+    setJournaled(is_journaled);
+    return;
+  }
+
+  try {
+    readRaw(0, &header, sizeof(Header));
+  } catch(...) {
+    ::close(file_descriptor);
+    throw;
+  }
+  if(std::memcmp(header.magic, Header().magic, sizeof(header.magic)) || header.version != Header().version ||
+     header.page_size < min_page_size || (header.page_size & (header.page_size - 1)) ||
+     ui64(file_stat.st_size) < header.page_count * header.page_size) {
+    ::close(file_descriptor);
+    throw err::Error(err::ErrorType::invalid_data);
+  }
+  pool.reset(new BufferPool(self, header.page_size, cache_size, policy));
+  setJournaled(is_journaled);
+}
+
+PagedFile::~PagedFile() {
+  // Journaled file is written only by checkpoint
+  try { if(pool && !is_journaled) sync(); } catch(...) {}
+  if(file_descriptor >= 0) ::close(file_descriptor);
+}
+
+bool PagedFile::isServicePage(PageIndex page) const noexcept {
+  return page == 0 || page == 1 || page % getPagesPerGroup() == 0;
+}
+
+void PagedFile::readRaw(ui64 position, void* to, size_t size) const {
+  byte* it = reinterpret_cast<byte*>(to);
+  while(size) {
+    const ssize_t readed = ::pread(file_descriptor, it, size, position);
+    if(readed < 0) {
+      if(errno == EINTR) continue;
+      throw err::Error(err::ErrorType::file_read_error);
+    }
+    if(!readed) throw err::Error(err::ErrorType::invalid_data);
+    it += readed;
+    position += readed;
+    size -= readed;
+  }
+}
+
+void PagedFile::writeRaw(ui64 position, const void* from, size_t size) {
+  const byte* it = reinterpret_cast<const byte*>(from);
+  while(size) {
+    const ssize_t written = ::pwrite(file_descriptor, it, size, position);
+    if(written < 0) {
+      if(errno == EINTR) continue;
+      throw err::Error(err::ErrorType::file_write_error);
+    }
+    it += written;
+    position += written;
+    size -= written;
+  }
+}
+
+void PagedFile::writeHeader() {
+  if(is_journaled) is_header_dirty = true;
+  else writeRaw(0, &header, sizeof(Header));
+}
+
+void PagedFile::setJournaled(bool is_journaled) {
+  self.is_journaled = is_journaled;
+  pool->setNoSteal(is_journaled);
+}
+
+void PagedFile::initGroup(ui64 group) {
+  const PageIndex map_page = getFreeSpaceMapPage(group);
+  std::unique_ptr<byte[]> page_data(new byte[header.page_size]());
+  page_data[0] = group ? 0x01 : 0x03; // Map page itself (and file header for group 0)
+  writeRaw(map_page * header.page_size, page_data.get(), header.page_size);
+  header.page_count = map_page + 1;
+  writeHeader();
+}
+
+void PagedFile::markPage(PageIndex page, bool is_used) {
+  const ui64 group = page / getPagesPerGroup();
+  const ui64 bit_index = page % getPagesPerGroup();
+  const PageIndex map_page = getFreeSpaceMapPage(group);
+  byte bits = read<byte>(map_page, bit_index / 8);
+  if(is_used) bits |= byte(1 << (bit_index % 8));
+  else bits &= byte(~(1 << (bit_index % 8)));
+  write<byte>(map_page, bit_index / 8, bits);
+}
+
+void PagedFile::read(PageIndex page, size_t offset, void* to, size_t size) const {
+  if(page >= header.page_count || offset > header.page_size || size > header.page_size - offset)
+    throw err::Error(err::ErrorType::invalid_data);
+  pool->read(page, offset, to, size);
+}
+
+void PagedFile::write(PageIndex page, size_t offset, const void* from, size_t size) {
+  if(page >= header.page_count || offset > header.page_size || size > header.page_size - offset)
+    throw err::Error(err::ErrorType::invalid_data);
+  pool->write(page, offset, from, size);
+}
+
+PageIndex PagedFile::allocatePage() {
+  const ui64 pages_per_group = getPagesPerGroup();
+  const ui64 group_count = (header.page_count + pages_per_group - 1) / pages_per_group;
+  std::unique_ptr<byte[]> bitmap(new byte[header.page_size]);
+
+  for(ui64 group = free_group_hint; group < group_count; ++group) {
+    const ui64 group_page_count = std::min(pages_per_group, header.page_count - group * pages_per_group);
+    read(getFreeSpaceMapPage(group), 0, bitmap.get(), header.page_size);
+    for(ui64 byte_index = 0; byte_index * 8 < group_page_count; ++byte_index) {
+      if(bitmap[byte_index] == 0xFF) continue;
+      for(ui8 bit = 0; bit < 8 && byte_index * 8 + bit < group_page_count; ++bit) {
+        if(bitmap[byte_index] & (1 << bit)) continue;
+        const PageIndex page = group * pages_per_group + byte_index * 8 + bit;
+        write<byte>(getFreeSpaceMapPage(group), byte_index, byte(bitmap[byte_index] | (1 << bit)));
+        std::memset(bitmap.get(), 0, header.page_size);
+        write(page, 0, bitmap.get(), header.page_size);
+        free_group_hint = group;
+        return page;
+      }
+    }
+  }
+
+  // No free pages - extend file
+  if(header.page_count % pages_per_group == 0) initGroup(header.page_count / pages_per_group);
+  const PageIndex page = header.page_count++;
+  std::memset(bitmap.get(), 0, header.page_size);
+  writeRaw(page * header.page_size, bitmap.get(), header.page_size);
+  writeHeader();
+  markPage(page, true);
+  free_group_hint = page / pages_per_group;
+  return page;
+}
+
+void PagedFile::freePage(PageIndex page) {
+  if(page >= header.page_count || isServicePage(page)) throw err::Error(err::ErrorType::invalid_data);
+  markPage(page, false);
+  pool->discard(page);
+  if(page / getPagesPerGroup() < free_group_hint) free_group_hint = page / getPagesPerGroup();
+}
+
+bool PagedFile::isPageUsed(PageIndex page) const {
+  if(page >= header.page_count) return false;
+  const ui64 bit_index = page % getPagesPerGroup();
+  return read<byte>(getFreeSpaceMapPage(page / getPagesPerGroup()), bit_index / 8) & (1 << (bit_index % 8));
+}
+
+size_t PagedFile::getUsedPageCount() const {
+  const ui64 pages_per_group = getPagesPerGroup();
+  std::unique_ptr<byte[]> bitmap(new byte[header.page_size]);
+  size_t count = 0;
+  for(ui64 group = 0; group * pages_per_group < header.page_count; ++group) {
+    read(getFreeSpaceMapPage(group), 0, bitmap.get(), header.page_size);
+    for(size_t i = 0; i < header.page_size; ++i) count += std::popcount(ui8(bitmap[i]));
+  }
+  return count;
+}
+
+void PagedFile::setRoot(FileResourceIndex root) {
+  header.root = root;
+  writeHeader();
+}
+
+ui64 PagedFile::nextGeneration() noexcept {
+  is_header_dirty = true;
+  return ++header.generation;
+}
+
+void PagedFile::sync() {
+  pool->flush();
+  if(is_header_dirty) {
+    writeRaw(0, &header, sizeof(Header));
+    is_header_dirty = false;
+  }
+  if(::fsync(file_descriptor)) throw err::Error(err::ErrorType::file_write_error);
+}
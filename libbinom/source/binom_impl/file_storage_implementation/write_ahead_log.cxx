@@ -0,0 +1,347 @@
+#include "libbinom/include/binom_impl/file_storage_implementation/write_ahead_log.hxx"
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace binom;
+using namespace binom::priv;
+
+namespace {
+
+constexpr std::array<ui32, 256> crc32_table = []() {
+  std::array<ui32, 256> table{};
+  for(ui32 i = 0; i < 256; ++i) {
+    ui32 crc = i;
+    for(int bit = 0; bit < 8; ++bit) crc = crc & 1 ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+    table[i] = crc;
+  }
+  return table;
+}();
+
+//! Continues crc32 calculation, start with crc = 0
+ui32 crc32(ui32 crc, const void* data, size_t size) noexcept {
+  const byte* it = reinterpret_cast<const byte*>(data);
+  crc = ~crc;
+  for(const byte* end = it + size; it != end; ++it) crc = crc32_table[(crc ^ *it) & 0xFF] ^ (crc >> 8);
+  return ~crc;
+}
+
+bool readAt(int file_descriptor, void* to, size_t size, ui64 position) {
+  byte* it = reinterpret_cast<byte*>(to);
+  while(size) {
+    const ssize_t readed = ::pread(file_descriptor, it, size, position);
+    if(readed < 0) {
+      if(errno == EINTR) continue;
+      throw err::Error(err::ErrorType::file_read_error);
+    }
+    if(!readed) return false;
+    it += readed;
+    position += readed;
+    size -= readed;
+  }
+  return true;
+}
+
+void writeAt(int file_descriptor, const void* from, size_t size, ui64 position) {
+  const byte* it = reinterpret_cast<const byte*>(from);
+  while(size) {
+    const ssize_t written = ::pwrite(file_descriptor, it, size, position);
+    if(written < 0) {
+      if(errno == EINTR) continue;
+      throw err::Error(err::ErrorType::file_write_error);
+    }
+    it += written;
+    position += written;
+    size -= written;
+  }
+}
+
+}
+
+WriteAheadLog::WriteAheadLog(const std::string& path, const std::string& data_path, JournalConfig config)
+  : path(path), config(config) {
+  struct stat file_stat;
+  const bool is_exists = !::stat(path.c_str(), &file_stat);
+  if(!is_exists && !isEnabled()) return;
+
+  file_descriptor = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+  if(file_descriptor < 0) throw err::Error(err::ErrorType::file_open_error);
+
+  try {
+    if(is_exists && ui64(file_stat.st_size) >= file_header_size) {
+      byte header[file_header_size];
+      readAt(file_descriptor, header, file_header_size, 0);
+      if(std::memcmp(header, magic, sizeof(magic)) || std::memcmp(header + sizeof(magic), &version, sizeof(version)))
+        throw err::Error(err::ErrorType::invalid_data);
+      file_size = file_stat.st_size;
+      recover(data_path);
+    } else reset();
+    if(config.mode == JournalMode::batched) flusher = std::thread([this]() {runFlusher();});
+  } catch(...) {
+    ::close(file_descriptor);
+    throw;
+  }
+}
+
+WriteAheadLog::~WriteAheadLog() {
+  stopFlusher();
+  if(file_descriptor >= 0) ::close(file_descriptor);
+}
+
+void WriteAheadLog::runFlusher() {
+  std::unique_lock lk(mtx);
+  while(!is_flusher_stopped) {
+    if(!buffered_record_count) {
+      flusher_cv.wait(lk);
+      continue;
+    }
+    const auto deadline = first_buffered_time + config.batch_delay;
+    if(std::chrono::steady_clock::now() < deadline) {
+      flusher_cv.wait_until(lk, deadline);
+      continue;
+    }
+    try {
+      flushTo(lk, last_lsn);
+    } catch(...) {
+      flusher_error = std::current_exception();
+      // Retry after the error is reported
+      flusher_cv.wait(lk, [this]() {return !flusher_error || is_flusher_stopped;});
+    }
+  }
+}
+
+void WriteAheadLog::stopFlusher() {
+  if(!flusher.joinable()) return;
+  {
+    std::lock_guard lk(mtx);
+    is_flusher_stopped = true;
+  }
+  flusher_cv.notify_one();
+  flusher.join();
+}
+
+void WriteAheadLog::throwFlusherError() {
+  if(!flusher_error) return;
+  flusher_cv.notify_one();
+  std::rethrow_exception(std::exchange(flusher_error, nullptr));
+}
+
+void WriteAheadLog::appendRecord(std::vector<byte>& to, RecordType type, const void* data, size_t size, const void* extra, size_t extra_size) {
+  RecordHeader header{.size = ui32(sizeof(RecordType) + size + extra_size), .checksum = 0, .lsn = ++last_lsn};
+  header.checksum = crc32(crc32(crc32(crc32(0, &header.lsn, sizeof(header.lsn)), &type, sizeof(type)), data, size), extra, extra_size);
+  const size_t position = to.size();
+  to.resize(position + sizeof(RecordHeader) + header.size);
+  byte* it = to.data() + position;
+  std::memcpy(it, &header, sizeof(RecordHeader));
+  it += sizeof(RecordHeader);
+  *it++ = byte(type);
+  if(size) std::memcpy(it, data, size);
+  if(extra_size) std::memcpy(it + size, extra, extra_size);
+}
+
+bool WriteAheadLog::readRecord(ui64& position, RecordHeader& header, std::vector<byte>& payload) const {
+  if(file_size - position < sizeof(RecordHeader) || !readAt(file_descriptor, &header, sizeof(RecordHeader), position))
+    return false;
+  if(!header.size || header.size > file_size - position - sizeof(RecordHeader)) return false;
+  payload.resize(header.size);
+  if(!readAt(file_descriptor, payload.data(), payload.size(), position + sizeof(RecordHeader))) return false;
+  if(crc32(crc32(0, &header.lsn, sizeof(header.lsn)), payload.data(), payload.size()) != header.checksum) return false;
+  position += sizeof(RecordHeader) + header.size;
+  return true;
+}
+
+void WriteAheadLog::recover(const std::string& data_path) {
+  RecordHeader header;
+  std::vector<byte> payload;
+  std::vector<ui64> logical_positions;
+  ui64 checkpoint_position = 0, complete_checkpoint_position = 0;
+  bool is_checkpoint_complete = false;
+
+  ui64 position = file_header_size;
+  for(ui64 record_position = position; readRecord(position, header, payload); record_position = position) {
+    last_lsn = header.lsn;
+    switch (RecordType(payload[0])) {
+    case RecordType::logical: logical_positions.push_back(record_position); break;
+    case RecordType::checkpoint_begin: checkpoint_position = record_position; break;
+    case RecordType::file_image: break;
+    case RecordType::checkpoint_end:
+      complete_checkpoint_position = checkpoint_position;
+      is_checkpoint_complete = true;
+      logical_positions.clear();
+    break;
+    default: throw err::Error(err::ErrorType::invalid_data);
+    }
+  }
+  // Drop torn tail, new records are appended after last valid one
+  file_size = position;
+  durable_lsn = last_lsn;
+
+  if(is_checkpoint_complete) {
+    const int data_file_descriptor = ::open(data_path.c_str(), O_RDWR | O_CREAT, 0644);
+    if(data_file_descriptor < 0) throw err::Error(err::ErrorType::file_open_error);
+    try {
+      position = complete_checkpoint_position;
+      while(readRecord(position, header, payload) && RecordType(payload[0]) != RecordType::checkpoint_end) {
+        if(RecordType(payload[0]) != RecordType::file_image) continue;
+        ui64 offset;
+        std::memcpy(&offset, payload.data() + sizeof(RecordType), sizeof(offset));
+        writeAt(data_file_descriptor, payload.data() + sizeof(RecordType) + sizeof(offset),
+                payload.size() - sizeof(RecordType) - sizeof(offset), offset);
+      }
+      if(::fsync(data_file_descriptor)) throw err::Error(err::ErrorType::file_write_error);
+    } catch(...) {
+      ::close(data_file_descriptor);
+      throw;
+    }
+    ::close(data_file_descriptor);
+  }
+
+  replay_positions = std::move(logical_positions);
+  if(replay_positions.empty()) reset();
+  elif(::ftruncate(file_descriptor, file_size)) throw err::Error(err::ErrorType::file_write_error);
+}
+
+void WriteAheadLog::writeFile(const void* data, size_t size, ui64 position) {writeAt(file_descriptor, data, size, position);}
+
+void WriteAheadLog::syncFile() {
+  if(::fdatasync(file_descriptor)) throw err::Error(err::ErrorType::file_write_error);
+}
+
+void WriteAheadLog::reset() {
+  byte header[file_header_size];
+  std::memcpy(header, magic, sizeof(magic));
+  std::memcpy(header + sizeof(magic), &version, sizeof(version));
+  writeFile(header, file_header_size, 0);
+  if(::ftruncate(file_descriptor, file_header_size)) throw err::Error(err::ErrorType::file_write_error);
+  syncFile();
+  ++sync_count;
+  file_size = file_header_size;
+  replay_positions.clear();
+}
+
+void WriteAheadLog::replay(const std::function<void(const byte*, size_t)>& callback) {
+  RecordHeader header;
+  std::vector<byte> payload;
+  for(ui64 position : replay_positions) {
+    if(!readRecord(position, header, payload)) throw err::Error(err::ErrorType::invalid_data);
+    callback(payload.data() + sizeof(RecordType), payload.size() - sizeof(RecordType));
+  }
+}
+
+ui64 WriteAheadLog::append(const std::vector<byte>& payload) {
+  std::lock_guard lk(mtx);
+  appendRecord(buffer, RecordType::logical, payload.data(), payload.size());
+  if(!buffered_record_count++) {
+    first_buffered_time = std::chrono::steady_clock::now();
+    flusher_cv.notify_one();
+  }
+  return last_lsn;
+}
+
+void WriteAheadLog::flushTo(std::unique_lock<std::mutex>& lk, ui64 lsn) {
+  while(durable_lsn < lsn) {
+    if(is_flushing) {
+      flush_cv.wait(lk);
+      continue;
+    }
+
+    // Leader writes records of all waiting committers with one fsync
+    is_flushing = true;
+    std::vector<byte> data;
+    data.swap(buffer);
+    buffered_record_count = 0;
+    const ui64 target_lsn = last_lsn, position = file_size;
+
+    lk.unlock();
+    try {
+      writeFile(data.data(), data.size(), position);
+      syncFile();
+    } catch(...) {
+      lk.lock();
+      is_flushing = false;
+      flush_cv.notify_all();
+      throw;
+    }
+    lk.lock();
+
+    file_size = position + data.size();
+    durable_lsn = target_lsn;
+    ++sync_count;
+    is_flushing = false;
+    flush_cv.notify_all();
+  }
+}
+
+void WriteAheadLog::commit() {
+  if(!isEnabled()) return;
+  std::unique_lock lk(mtx);
+  throwFlusherError();
+  switch (config.mode) {
+  case JournalMode::synchronous: flushTo(lk, last_lsn); return;
+  case JournalMode::batched:
+    if(buffered_record_count >= config.batch_size ||
+       (buffered_record_count && std::chrono::steady_clock::now() - first_buffered_time >= config.batch_delay))
+      flushTo(lk, last_lsn);
+  return;
+  case JournalMode::off: return;
+  }
+}
+
+void WriteAheadLog::flush() {
+  std::unique_lock lk(mtx);
+  throwFlusherError();
+  flushTo(lk, last_lsn);
+}
+
+ui64 WriteAheadLog::getSize() {
+  std::lock_guard lk(mtx);
+  return file_size + buffer.size();
+}
+
+size_t WriteAheadLog::getSyncCount() {
+  std::lock_guard lk(mtx);
+  return sync_count;
+}
+
+void WriteAheadLog::checkpoint(PagedFile& file) {
+  std::unique_lock lk(mtx);
+  flushTo(lk, last_lsn);
+
+  if(file_size != file_header_size || !replay_positions.empty()) {
+    constexpr size_t chunk_size = 1024 * 1024;
+    std::vector<byte> data;
+    appendRecord(data, RecordType::checkpoint_begin, nullptr, 0);
+    file.forEachDirtyPage([this, &data, &file](PageIndex page, const byte* page_data) {
+      const ui64 offset = page * file.getPageSize();
+      appendRecord(data, RecordType::file_image, &offset, sizeof(offset), page_data, file.getPageSize());
+      if(data.size() < chunk_size) return;
+      writeFile(data.data(), data.size(), file_size);
+      file_size += data.size();
+      data.clear();
+    });
+    const ui64 header_offset = 0;
+    appendRecord(data, RecordType::file_image, &header_offset, sizeof(header_offset), &file.getHeader(), sizeof(PagedFile::Header));
+    appendRecord(data, RecordType::checkpoint_end, nullptr, 0);
+    writeFile(data.data(), data.size(), file_size);
+    file_size += data.size();
+    syncFile();
+    ++sync_count;
+  }
+
+  file.sync();
+  reset();
+  durable_lsn = last_lsn;
+}
+
+void WriteAheadLog::remove() {
+  if(file_descriptor < 0) return;
+  stopFlusher();
+  ::close(file_descriptor);
+  file_descriptor = -1;
+  ::unlink(path.c_str());
+}
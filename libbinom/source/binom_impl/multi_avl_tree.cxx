@@ -1,5 +1,7 @@
 #include "libbinom/include/binom_impl/multi_avl_tree.hxx"
 
+#include <vector>
+
 using namespace binom;
 using namespace binom::priv;
 
@@ -14,6 +16,7 @@ void MultiAVLTree::AVLKeyNode::swapPosition(AVLKeyNode& other, MultiAVLTree& avl
     std::swap(left, other.left);
     std::swap(right, other.right);
     std::swap(depth, other.depth);
+    std::swap(subtree_size, other.subtree_size);
 
   } elif (parent == &other) {
     parent = other.parent;
@@ -28,6 +31,7 @@ void MultiAVLTree::AVLKeyNode::swapPosition(AVLKeyNode& other, MultiAVLTree& avl
       std::swap(left, other.left);
     }
     std::swap(depth, other.depth);
+    std::swap(subtree_size, other.subtree_size);
 
   } else {
     other.parent = parent;
@@ -73,6 +77,7 @@ MultiAVLTree::AVLKeyNode::AVLKeyNode(KeyValue key, AVLKeyNode* parent)
 
 MultiAVLTree::AVLKeyNode::AVLKeyNode(AVLKeyNode& other)
   : depth(other.depth),
+    subtree_size(other.subtree_size),
     left(other.left),
     right(other.right),
     parent(other.parent),
@@ -80,10 +85,19 @@ MultiAVLTree::AVLKeyNode::AVLKeyNode(AVLKeyNode& other)
 
 MultiAVLTree::AVLKeyNode::AVLKeyNode(AVLKeyNode&& other)
   : depth(other.depth),
+    subtree_size(other.subtree_size),
     left(other.left),
     right(other.right),
     parent(other.parent),
-    key(std::move(other.key)) {}
+    key(std::move(other.key)),
+    size(other.size),
+    first(other.first),
+    last(other.last) {
+  // Elements are taken with their list
+  for(AVLNode* node = first; node; node = node->next) node->key_node = this;
+  other.size = 0;
+  other.first = other.last = nullptr;
+}
 
 MultiAVLTree::AVLKeyNode& MultiAVLTree::AVLKeyNode::operator=(AVLKeyNode other) { this->~AVLKeyNode(); return *new(this) AVLKeyNode(std::move(other)); }
 
@@ -113,6 +127,32 @@ void MultiAVLTree::AVLKeyNode::pushFront(AVLNode* node) {
   ++size;
 }
 
+void MultiAVLTree::AVLKeyNode::takeElements(AVLKeyNode& other) noexcept {
+  if(!other.first) return;
+  for(AVLNode* node = other.first; node; node = node->next) node->key_node = this;
+  if(last) {
+    last->next = other.first;
+    other.first->prev = last;
+  } else first = other.first;
+  last = other.last;
+  size += other.size;
+  other.size = 0;
+  other.first = other.last = nullptr;
+}
+
+void MultiAVLTree::AVLKeyNode::replace(AVLNode& node, AVLNode& new_node) noexcept {
+  new_node.key_node = this;
+  new_node.next = node.next;
+  new_node.prev = node.prev;
+  if(node.next) node.next->prev = &new_node;
+  else last = &new_node;
+  if(node.prev) node.prev->next = &new_node;
+  else first = &new_node;
+  node.key_node = nullptr;
+  node.next = nullptr;
+  node.prev = nullptr;
+}
+
 MultiAVLTree::AVLNode& MultiAVLTree::AVLKeyNode::extract(Iterator it) {
   AVLNode& node = *it;
   if(node.next) {node.next->prev = node.prev;}
@@ -284,6 +324,8 @@ MultiAVLTree::AVLKeyNode* MultiAVLTree::rotateRight(AVLKeyNode* y) {
 
   y->depth = max(depth(y->left), depth(y->right)) + 1;
   x->depth = max(depth(x->left), depth(x->right)) + 1;
+  y->subtree_size = y->size + subtreeSize(y->left) + subtreeSize(y->right);
+  x->subtree_size = x->size + subtreeSize(x->left) + subtreeSize(x->right);
 
   // Update parent poionters
   x->parent = y->parent;
@@ -306,8 +348,10 @@ MultiAVLTree::AVLKeyNode* MultiAVLTree::rotateLeft(AVLKeyNode* x) {
   y->left = x;
   x->right = T2;
 
-  y->depth = max(depth(y->left), depth(y->right)) + 1;
   x->depth = max(depth(x->left), depth(x->right)) + 1;
+  y->depth = max(depth(y->left), depth(y->right)) + 1;
+  x->subtree_size = x->size + subtreeSize(x->left) + subtreeSize(x->right);
+  y->subtree_size = y->size + subtreeSize(y->left) + subtreeSize(y->right);
 
   // Update parent poionters
   y->parent = x->parent;
@@ -322,8 +366,34 @@ MultiAVLTree::AVLKeyNode* MultiAVLTree::rotateLeft(AVLKeyNode* x) {
   return y;
 }
 
+size_t MultiAVLTree::subtreeSize(AVLKeyNode* node) noexcept {return node ? node->subtree_size : 0;}
+
 i64 MultiAVLTree::getBalance(AVLKeyNode* node) { return node ? depth(node->left) - depth(node->right) : 0; }
 
+void MultiAVLTree::balance(AVLKeyNode* node) {
+  // Depths and element counts are recomputed on the whole path, rotations fix counts of rotated nodes
+  while(node) {
+    node->depth = 1 + max(depth(node->left), depth(node->right));
+    node->subtree_size = node->size + subtreeSize(node->left) + subtreeSize(node->right);
+
+    i64 balance = getBalance(node);
+
+    if (balance > 1 && getBalance(node->left) >= 0) {
+      rotateRight(node);
+    } elif (balance > 1  && getBalance(node->left) < 0) {
+      rotateLeft(node->left);
+      rotateRight(node);
+    } elif (balance < -1 && getBalance(node->right) <= 0) {
+      rotateLeft(node);
+    } elif (balance < -1 && getBalance(node->right) > 0) {
+      rotateRight(node->right);
+      rotateLeft(node);
+    }
+
+    node = node->parent;
+  }
+}
+
 MultiAVLTree::AVLKeyNode* MultiAVLTree::minKeyNode(AVLKeyNode* node) noexcept {
   if(!node) return nullptr;
   while(node->left) node = node->left;
@@ -340,14 +410,159 @@ MultiAVLTree::AVLKeyNode* MultiAVLTree::maxKeyNode(AVLKeyNode* node) noexcept {
 
 MultiAVLTree::AVLKeyNode* MultiAVLTree::maxKeyNode() const noexcept {return maxKeyNode(root);}
 
+MultiAVLTree::AVLKeyNode* MultiAVLTree::createKeyNode(KeyValue key, AVLKeyNode* parent) {
+  return new(key_node_pool.allocate()) AVLKeyNode(std::move(key), parent);
+}
+
+void MultiAVLTree::destroyKeyNode(AVLKeyNode* key_node) noexcept {
+  key_node->~AVLKeyNode();
+  key_node_pool.deallocate(key_node);
+}
+
 bool MultiAVLTree::isEmpty() const noexcept {return !root;}
 
+size_t MultiAVLTree::getSize() const noexcept {return subtreeSize(root);}
+
+MultiAVLTree::AVLKeyNode* MultiAVLTree::buildBalanced(AVLKeyNode* const* key_nodes, size_t count, AVLKeyNode* parent) noexcept {
+  if(!count) return nullptr;
+  const size_t middle = count / 2;
+  AVLKeyNode* key_node = key_nodes[middle];
+  key_node->parent = parent;
+  key_node->left = buildBalanced(key_nodes, middle, key_node);
+  key_node->right = buildBalanced(key_nodes + middle + 1, count - middle - 1, key_node);
+  key_node->depth = 1 + max(depth(key_node->left), depth(key_node->right));
+  key_node->subtree_size = key_node->size + subtreeSize(key_node->left) + subtreeSize(key_node->right);
+  return key_node;
+}
+
+void MultiAVLTree::bulkLoad(KeyNodePair* elements, size_t count) {
+  // Adjacent keys are only tested for equality to group them, key nodes are linked without search
+  std::vector<AVLKeyNode*> key_nodes;
+  key_nodes.reserve(count);
+  for(size_t i = 0; i < count; ++i) {
+    if(key_nodes.empty() || key_nodes.back()->key.getCompare(elements[i].key) != KeyValue::equal)
+      key_nodes.push_back(createKeyNode(std::move(elements[i].key)));
+    key_nodes.back()->pushBack(elements[i].node);
+  }
+  root = buildBalanced(key_nodes.data(), key_nodes.size(), nullptr);
+}
+
+binom::err::Error MultiAVLTree::bulkLoadChecked(KeyNodePair* elements, size_t count) {
+  for(size_t i = 1; i < count; ++i)
+    if(elements[i - 1].key.getCompare(elements[i].key) == KeyValue::highter) return err::ErrorType::invalid_data;
+  bulkLoad(elements, count);
+  return err::ErrorType::no_error;
+}
+
+void MultiAVLTree::unlinkKeyNode(AVLKeyNode* key_node) {
+  AVLKeyNode* node = key_node;
+  forever if(!node->left || !node->right) {
+    AVLKeyNode* tmp = node->left ? node->left : node->right;
+    if(!tmp) { // If node hasn't child
+      tmp = node;
+      node = node->parent;
+      tmp->unpin(self);
+    } else { // If node has 1 child
+      node->swapPosition(*tmp, self);
+      node->unpin(self);
+      node = tmp; // For balancing
+    }
+    break;
+  } else { // If node has 2 childs (Test it!!!)
+
+    // Change the position of the node
+    // to be deleted whith the position
+    // of the leftmost node in th right branch
+
+    AVLKeyNode* tmp = minKeyNode(node->right);
+    node->swapPosition(*tmp, self);
+    continue;
+  }
+
+  balance(node);
+}
+
+void MultiAVLTree::joinByNode(AVLKeyNode* middle, AVLKeyNode* right) {
+  if(root) root->parent = nullptr;
+  if(right) right->parent = nullptr;
+  AVLKeyNode* parent = nullptr;
+  if(depth(root) >= depth(right)) {
+    AVLKeyNode* node = root;
+    while(depth(node) > depth(right) + 1) {parent = node; node = node->right;}
+    middle->left = node;
+    middle->right = right;
+    if(parent) parent->right = middle;
+    else root = middle;
+    if(node) node->parent = middle;
+    if(right) right->parent = middle;
+  } else {
+    AVLKeyNode* left = root;
+    AVLKeyNode* node = root = right;
+    while(depth(node) > depth(left) + 1) {parent = node; node = node->left;}
+    middle->left = left;
+    middle->right = node;
+    if(parent) parent->left = middle;
+    else root = middle;
+    if(left) left->parent = middle;
+    if(node) node->parent = middle;
+  }
+  middle->parent = parent;
+  balance(middle);
+}
+
+void MultiAVLTree::append(AVLKeyNode* other_root) {
+  if(!other_root) return;
+  if(!root) {
+    root = other_root;
+    root->parent = nullptr;
+    return;
+  }
+  AVLKeyNode* middle = maxKeyNode();
+  unlinkKeyNode(middle);
+  joinByNode(middle, other_root);
+}
+
+void MultiAVLTree::splitNode(AVLKeyNode* key_node, KeyValue& key, MultiAVLTree& lower, MultiAVLTree& upper) {
+  if(!key_node) return;
+  AVLKeyNode* left = key_node->left;
+  AVLKeyNode* right = key_node->right;
+  key_node->left = key_node->right = nullptr;
+  if(key_node->key.getCompare(key) == KeyValue::lower) {
+    splitNode(right, key, lower, upper);
+    MultiAVLTree left_tree;
+    left_tree.root = left;
+    left_tree.joinByNode(key_node, lower.root);
+    lower.root = left_tree.root;
+  } else {
+    splitNode(left, key, lower, upper);
+    upper.joinByNode(key_node, right);
+  }
+}
+
+void MultiAVLTree::destroyKeyNodes(AVLKeyNode* key_node, std::function<void(AVLNode*)>& destructor) noexcept {
+  if(!key_node) return;
+  destroyKeyNodes(key_node->left, destructor);
+  destroyKeyNodes(key_node->right, destructor);
+  for(auto it = key_node->begin(), end = key_node->end(); it != end;) {
+    AVLNode* node = &*it;
+    ++it;
+    destructor(node);
+  }
+  destroyKeyNode(key_node);
+}
+
+MultiAVLTree::MultiAVLTree(MultiAVLTree&& other) noexcept
+  : root(other.root), key_node_pool(std::move(other.key_node_pool)) {
+  other.root = nullptr;
+}
+
 MultiAVLTree::NodePair MultiAVLTree::insert(KeyValue key, AVLNode* new_node, NewNodePosition position) {
   AVLKeyNode* node = root;
   NodePair result{.node = new_node};
   if(!node) {
-    root = new AVLKeyNode(std::move(key));
+    root = createKeyNode(std::move(key));
     root->pushBack(new_node);
+    root->subtree_size = 1;
     return {root, new_node};
   }
 
@@ -356,7 +571,7 @@ MultiAVLTree::NodePair MultiAVLTree::insert(KeyValue key, AVLNode* new_node, New
     if(cmp == KeyValue::lower) {
       if(node->left) { node = node->left; continue; }
       else {
-        node->left = new AVLKeyNode(std::move(key), node);
+        node->left = createKeyNode(std::move(key), node);
         node->left->pushBack(new_node);
         result.key_node = node->left;
         break;
@@ -364,7 +579,7 @@ MultiAVLTree::NodePair MultiAVLTree::insert(KeyValue key, AVLNode* new_node, New
     } elif(cmp == KeyValue::highter) {
       if(node->right) { node = node->right; continue; }
       else {
-        node->right = new AVLKeyNode(std::move(key), node);
+        node->right = createKeyNode(std::move(key), node);
         node->right->pushBack(new_node);
         result.key_node = node->right;
         break;
@@ -378,29 +593,12 @@ MultiAVLTree::NodePair MultiAVLTree::insert(KeyValue key, AVLNode* new_node, New
         node->pushBack(new_node);
       break;
       }
+      for(AVLKeyNode* key_node = node; key_node; key_node = key_node->parent) ++key_node->subtree_size;
       return {node, new_node};
     }
   }
 
-  while(node) { // Balancing
-    node->depth = 1 + max(depth(node->left), depth(node->right));
-
-    i64 balance = getBalance(node);
-
-    if (balance > 1 && getBalance(root->left) >= 0) {
-      rotateRight(node);
-    } elif (balance > 1  && getBalance(root->left) < 0) {
-      rotateLeft(node->left);
-      rotateRight(node);
-    } elif (balance < -1 && getBalance(node->right) <= 0) {
-      rotateLeft(node);
-    } elif (balance < -1 && getBalance(node->right) > 0) {
-      rotateRight(node->right);
-      rotateLeft(node);
-    }
-
-    node = node->parent;
-  }
+  balance(result.key_node);
 
   return result;
 }
@@ -409,59 +607,23 @@ MultiAVLTree::AVLNode* MultiAVLTree::extract(Iterator it) {
   auto& key_node = it.getKeyNode();
   auto iterator = it.getKeyNodeIterator();
   auto& result = key_node.extract(iterator);
-  if(key_node.getElementCount()) return &result;
-
-  AVLKeyNode* node = &key_node;
-  forever if(!node->left || !node->right) {
-    AVLKeyNode* tmp = node->left ? node->left : node->right;
-    if(!tmp) { // If node hasn't child
-      tmp = node;
-      node = nullptr;
-      tmp->unpin(self);
-    } else { // If node has 1 child
-      node->swapPosition(*tmp, self);
-      node->unpin(self);
-      node = tmp; // For balancing
-    }
-    break;
-  } else { // If node has 2 childs (Test it!!!)
-
-    // Change the position of the node
-    // to be deleted whith the position
-    // of the leftmost node in th right branch
-
-    AVLKeyNode* tmp = minKeyNode(node->right);
-    node->swapPosition(*tmp, self);
-    continue;
+  if(key_node.getElementCount()) {
+    for(AVLKeyNode* node = &key_node; node; node = node->parent) --node->subtree_size;
+    return &result;
   }
 
-  while(node) { // Balancing
-
-    node->depth = 1 + max(depth(node->left), depth(node->right));
-
-    i64 balance = getBalance(node);
-
-    if (balance > 1 && getBalance(root->left) >= 0) {
-      rotateRight(node);
-    } elif (balance > 1  && getBalance(root->left) < 0) {
-      rotateLeft(node->left);
-      rotateRight(node);
-    } elif (balance < -1 && getBalance(node->right) <= 0) {
-      rotateLeft(node);
-    } elif (balance < -1 && getBalance(node->right) > 0) {
-      rotateRight(node->right);
-      rotateLeft(node);
-    }
-
-    node = node->parent;
-  }
-
-  delete &key_node;
+  unlinkKeyNode(&key_node);
+  destroyKeyNode(&key_node);
   return &result;
 }
 
 MultiAVLTree::AVLNode* MultiAVLTree::extract(ReverseIterator r_it) {return extract(Iterator(r_it));}
 
+MultiAVLTree::Iterator MultiAVLTree::replace(Iterator it, AVLNode* new_node) {
+  it.getKeyNode().replace(*it, *new_node);
+  return Iterator(AVLKeyNode::Iterator(new_node));
+}
+
 bool MultiAVLTree::removeKey(KeyValue key, std::function<void (AVLNode*)> destructor) {
   AVLKeyNode* node = root;
 
@@ -471,7 +633,7 @@ bool MultiAVLTree::removeKey(KeyValue key, std::function<void (AVLNode*)> destru
 
     auto cmp = key.getCompare(node->key);
     if(cmp == KeyValue::lower) {node = node->left; continue;}
-    elif(cmp == KeyValue::highter) {node = node->left; continue;}
+    elif(cmp == KeyValue::highter) {node = node->right; continue;}
     else break;
   }
 
@@ -481,55 +643,99 @@ bool MultiAVLTree::removeKey(KeyValue key, std::function<void (AVLNode*)> destru
   for(auto it = node->begin(), end = node->end(); it != end; destructor(&*it++));
 
   // Extract key-node
-  forever if(!node->left || !node->right) {
-    AVLKeyNode* tmp = node->left ? node->left : node->right;
-    if(!tmp) { // If node hasn't child
-      tmp = node;
-      node = nullptr;
-      tmp->unpin(self);
-    } else { // If node has 1 child
-      node->swapPosition(*tmp, self);
-      node->unpin(self);
-      node = tmp; // For balancing
-    }
-    break;
-  } else { // If node has 2 childs (Test it!!!)
+  unlinkKeyNode(deletable_node);
 
-    // Change the position of the node
-    // to be deleted whith the position
-    // of the leftmost node in th right branch
+  // Delete key-node
+  destroyKeyNode(deletable_node);
+  return true;
+}
 
-    AVLKeyNode* tmp = minKeyNode(node->right);
-    node->swapPosition(*tmp, self);
-    continue;
+MultiAVLTree::Iterator MultiAVLTree::select(size_t index) const {
+  AVLKeyNode* key_node = root;
+  while(key_node) {
+    const size_t left_size = subtreeSize(key_node->left);
+    if(index < left_size) key_node = key_node->left;
+    elif(index - left_size < key_node->size) {
+      AVLKeyNode::Iterator it = key_node->begin();
+      for(index -= left_size; index; --index) ++it;
+      return it;
+    } else {
+      index -= left_size + key_node->size;
+      key_node = key_node->right;
+    }
   }
+  return nullptr;
+}
 
-  while(node) { // Balancing
-
-    node->depth = 1 + max(depth(node->left), depth(node->right));
+size_t MultiAVLTree::rank(KeyValue key) const {
+  size_t result = 0;
+  AVLKeyNode* key_node = root;
+  while(key_node) {
+    if(key.getCompare(key_node->key) == KeyValue::highter) {
+      result += subtreeSize(key_node->left) + key_node->size;
+      key_node = key_node->right;
+    } else key_node = key_node->left;
+  }
+  return result;
+}
 
-    i64 balance = getBalance(node);
+size_t MultiAVLTree::countRange(KeyValue first, KeyValue last) const {
+  const size_t first_rank = rank(std::move(first)), last_rank = rank(std::move(last));
+  return last_rank > first_rank ? last_rank - first_rank : 0;
+}
 
-    if (balance > 1 && getBalance(root->left) >= 0) {
-      rotateRight(node);
-    } elif (balance > 1  && getBalance(root->left) < 0) {
-      rotateLeft(node->left);
-      rotateRight(node);
-    } elif (balance < -1 && getBalance(node->right) <= 0) {
-      rotateLeft(node);
-    } elif (balance < -1 && getBalance(node->right) > 0) {
-      rotateRight(node->right);
-      rotateLeft(node);
-    }
+MultiAVLTree MultiAVLTree::split(KeyValue key) {
+  MultiAVLTree lower, upper;
+  splitNode(root, key, lower, upper);
+  root = lower.root;
+  lower.root = nullptr;
+  // Key nodes of both parts stay in pool of this tree, which shares its slabs with upper tree
+  key_node_pool.share(upper.key_node_pool);
+  return upper;
+}
 
-    node = node->parent;
+bool MultiAVLTree::join(MultiAVLTree& other) {
+  if(this == &other) return !root;
+  if(!other.root) return true;
+  MultiAVLTree* lower = this;
+  MultiAVLTree* upper = &other;
+  if(root && maxKeyNode()->key.getCompare(minKeyNode(other.root)->key) == KeyValue::highter) {
+    if(maxKeyNode(other.root)->key.getCompare(minKeyNode()->key) == KeyValue::highter) return false;
+    std::swap(lower, upper);
   }
-
-  // Delete key-node
-  delete deletable_node;
+  // Trees are changed only after the last allocation
+  key_node_pool.reserveMerge(other.key_node_pool);
+  if(AVLKeyNode* lower_max = lower->maxKeyNode(), * upper_min = upper->minKeyNode();
+     lower_max && lower_max->key.getCompare(upper_min->key) == KeyValue::equal) {
+    // Key node of upper tree is emptied, so it is removed before join
+    const size_t count = upper_min->getElementCount();
+    lower_max->takeElements(*upper_min);
+    for(AVLKeyNode* key_node = lower_max; key_node; key_node = key_node->parent) key_node->subtree_size += count;
+    upper->unlinkKeyNode(upper_min);
+    upper->destroyKeyNode(upper_min);
+  }
+  lower->append(upper->root);
+  root = lower->root;
+  other.root = nullptr;
+  key_node_pool.merge(other.key_node_pool);
   return true;
 }
 
+size_t MultiAVLTree::eraseRange(KeyValue first, KeyValue last, std::function<void(AVLNode*)> destructor) {
+  if(first.getCompare(last) != KeyValue::lower) return 0;
+  // Parts stay in pool of this tree
+  MultiAVLTree lower, middle, upper;
+  splitNode(root, first, lower, middle);
+  AVLKeyNode* middle_root = middle.root;
+  middle.root = nullptr;
+  splitNode(middle_root, last, middle, upper);
+  const size_t count = subtreeSize(middle.root);
+  destroyKeyNodes(middle.root, destructor);
+  root = lower.root;
+  append(upper.root);
+  return count;
+}
+
 MultiAVLTree::Iterator MultiAVLTree::find(KeyValue key) const {
   AVLKeyNode* key_node = root;
   forever {
@@ -537,7 +743,7 @@ MultiAVLTree::Iterator MultiAVLTree::find(KeyValue key) const {
 
     auto cmp = key.getCompare(key_node->key);
     if(cmp == KeyValue::lower) {key_node = key_node->left; continue;}
-    elif(cmp == KeyValue::highter) {key_node = key_node->left; continue;}
+    elif(cmp == KeyValue::highter) {key_node = key_node->right; continue;}
     else return Iterator(key_node); // Node is finded
   }
 }
@@ -549,7 +755,7 @@ MultiAVLTree::Iterator MultiAVLTree::findLast(KeyValue key) const {
 
     auto cmp = key.getCompare(key_node->key);
     if(cmp == KeyValue::lower) {key_node = key_node->left; continue;}
-    elif(cmp == KeyValue::highter) {key_node = key_node->left; continue;}
+    elif(cmp == KeyValue::highter) {key_node = key_node->right; continue;}
     else return Iterator(key_node->rbegin()); // Node is finded
   }
 }
@@ -561,7 +767,7 @@ MultiAVLTree::ReverseIterator MultiAVLTree::rfind(KeyValue key) const {
 
     auto cmp = key.getCompare(key_node->key);
     if(cmp == KeyValue::lower) {key_node = key_node->left; continue;}
-    elif(cmp == KeyValue::highter) {key_node = key_node->left; continue;}
+    elif(cmp == KeyValue::highter) {key_node = key_node->right; continue;}
     else return Iterator(key_node); // Node is finded
   }
 }
@@ -573,7 +779,7 @@ MultiAVLTree::ReverseIterator MultiAVLTree::rfindLast(KeyValue key) const {
 
     auto cmp = key.getCompare(key_node->key);
     if(cmp == KeyValue::lower) {key_node = key_node->left; continue;}
-    elif(cmp == KeyValue::highter) {key_node = key_node->left; continue;}
+    elif(cmp == KeyValue::highter) {key_node = key_node->right; continue;}
     else return Iterator(key_node->rbegin()); // Node is finded
   }
 }
@@ -623,9 +829,11 @@ void MultiAVLTree::clear(std::function<void (AVLNode*)> destructor) {
       destructor(node);
     }
 
-    delete last;
+    last->~AVLKeyNode();
   }
   root = nullptr;
+  // All key nodes are destroyed, so their slabs are freed at once
+  key_node_pool.release();
 }
 
 
@@ -1,11 +1,15 @@
 #include "libbinom/include/binom_impl/ram_storage_implementation/array_impl.hxx"
 #include "libbinom/include/utils/util_functions.hxx"
 
+#include <cstdlib>
+#include <limits>
+#include <new>
+#include <vector>
+
 using namespace binom;
 using namespace binom::priv;
 using namespace binom::literals;
 
-
 ArrayImplementation::ArrayImplementation(const arr& value_list)
   : count(value_list.getSize()), capacity(calculateCapacity(count)) {
   auto it = begin();
@@ -13,6 +17,9 @@ ArrayImplementation::ArrayImplementation(const arr& value_list)
     new(it++) Variable(value);
 }
 
+ArrayImplementation::ArrayImplementation(size_t reserved_count)
+  : count(0), capacity(calculateCapacity(reserved_count)) {}
+
 ArrayImplementation::ArrayImplementation(const ArrayImplementation& other)
   : count(other.count), capacity(other.capacity) {
   auto it = begin();
@@ -24,19 +31,47 @@ size_t ArrayImplementation::calculateCapacity(size_t count) noexcept {
   return util_functions::getNearestPow2(sizeof(ArrayImplementation) + count * sizeof(Link));
 }
 
+void* ArrayImplementation::allocate(size_t capacity) {
+  if(void* memory = std::malloc(capacity)) return memory;
+  throw std::bad_alloc();
+}
+
+void ArrayImplementation::reallocate(ArrayImplementation*& implementation, size_t capacity) {
+  static_assert(std::is_trivially_destructible_v<ArrayImplementation>);
+  // Header is plain size fields and elements only hold pointers to their resources,
+  // so block is relocated bitwise without touching link counters of resources
+  void* memory = std::realloc(static_cast<void*>(implementation), capacity);
+  if(!memory) throw std::bad_alloc();
+  implementation = reinterpret_cast<ArrayImplementation*>(memory);
+  implementation->capacity = capacity;
+}
+
 ArrayImplementation* ArrayImplementation::create(const literals::arr& value_list) {
-  return new(new byte[calculateCapacity(value_list.getSize())]) ArrayImplementation(value_list);
+  return new(allocate(calculateCapacity(value_list.getSize()))) ArrayImplementation(value_list);
 }
 
 ArrayImplementation* ArrayImplementation::copy(const ArrayImplementation* other) {
-  return new(new byte[other->capacity]) ArrayImplementation(*other);
+  return new(allocate(other->capacity)) ArrayImplementation(*other);
 }
 
 size_t ArrayImplementation::getElementCount() const noexcept {return count;}
 size_t ArrayImplementation::getCapacity() const noexcept {return capacity;}
 
+size_t ArrayImplementation::getElementCapacity() const noexcept {return (capacity - sizeof(ArrayImplementation)) / sizeof(Link);}
+
 size_t ArrayImplementation::getSize() const noexcept {return count * sizeof (Link);}
 
+void ArrayImplementation::reserve(ArrayImplementation*& implementation, size_t count) {
+  if(count > (std::numeric_limits<size_t>::max() - sizeof(ArrayImplementation)) / sizeof(Link)) throw std::bad_alloc();
+  const size_t capacity = sizeof(ArrayImplementation) + count * sizeof(Link);
+  if(capacity > implementation->capacity) reallocate(implementation, capacity);
+}
+
+void ArrayImplementation::shrinkToFit(ArrayImplementation*& implementation) {
+  const size_t capacity = sizeof(ArrayImplementation) + implementation->count * sizeof(Link);
+  if(capacity < implementation->capacity) reallocate(implementation, capacity);
+}
+
 Variable* ArrayImplementation::getData() const { return reinterpret_cast<Variable*>(const_cast<ArrayImplementation*>(this + 1)); }
 
 Variable ArrayImplementation::pushBack(ArrayImplementation*& implementation, Variable variable) {
@@ -45,11 +80,11 @@ Variable ArrayImplementation::pushBack(ArrayImplementation*& implementation, Var
   return allocated_memory->move();
 }
 
-ArrayImplementation::Iterator ArrayImplementation::pushBack(ArrayImplementation*& implementation, const literals::arr variable_list) {
-  auto allocated_memory = increaseSize(implementation, variable_list.getSize());
+ArrayImplementation::Iterator ArrayImplementation::pushBack(ArrayImplementation*& implementation, std::vector<Variable> clones) {
+  auto allocated_memory = increaseSize(implementation, clones.size());
   auto it = allocated_memory;
-  for(const auto& variable : variable_list)
-    new(it++) Variable(std::move(variable));
+  for(Variable& variable : clones)
+    new(it++) Variable(variable.move());
   return allocated_memory;
 }
 
@@ -59,11 +94,11 @@ Variable ArrayImplementation::pushFront(ArrayImplementation*& implementation, Va
   return allocated_memory->move();
 }
 
-ArrayImplementation::Iterator ArrayImplementation::pushFront(ArrayImplementation*& implementation, const literals::arr& variable_list) {
-  auto allocated_memory = insert(implementation, 0, variable_list.getSize());
+ArrayImplementation::Iterator ArrayImplementation::pushFront(ArrayImplementation*& implementation, std::vector<Variable> clones) {
+  auto allocated_memory = insert(implementation, 0, clones.size());
   auto it = allocated_memory;
-  for(const auto& variable : variable_list)
-    new(it++) Variable(std::move(variable));
+  for(Variable& variable : clones)
+    new(it++) Variable(variable.move());
   return allocated_memory;
 }
 
@@ -73,27 +108,20 @@ Variable ArrayImplementation::insert(ArrayImplementation*& implementation, size_
   return allocated_memory->move();
 }
 
-ArrayImplementation::Iterator ArrayImplementation::insert(ArrayImplementation*& implementation, size_t at, const literals::arr& variable_list) {
-  auto allocated_memory = insert(implementation, at, variable_list.getSize());
+ArrayImplementation::Iterator ArrayImplementation::insert(ArrayImplementation*& implementation, size_t at, std::vector<Variable> clones) {
+  auto allocated_memory = insert(implementation, at, clones.size());
   auto it = allocated_memory;
-  for(const auto& variable : variable_list)
-    new(it++) Variable(std::move(variable));
+  for(Variable& variable : clones)
+    new(it++) Variable(variable.move());
   return allocated_memory;
 }
 
 ArrayImplementation::Iterator ArrayImplementation::increaseSize(ArrayImplementation*& implementation, size_t count) {
-  const size_t new_count = implementation->count + count;
   const size_t old_count = implementation->count;
-  const size_t new_capacity = calculateCapacity(new_count);
-  if(new_capacity == implementation->capacity) {
-    ArrayImplementation* new_implementation = new(new byte[ new_capacity ]) ArrayImplementation(*implementation);
-    new_implementation->count = new_count;
-    new_implementation->capacity = new_capacity;
-    delete implementation;
-    implementation = new_implementation;
-  } else {
-    implementation->count = new_count;
-  }
+  const size_t new_count = old_count + count;
+  if(sizeof(ArrayImplementation) + new_count * sizeof(Link) > implementation->capacity)
+    reallocate(implementation, calculateCapacity(new_count));
+  implementation->count = new_count;
   return implementation->getData() + old_count;
 }
 
@@ -113,7 +141,7 @@ void ArrayImplementation::popBack(ArrayImplementation*& implementation, size_t c
              end = implementation->end(); it != end; ++it)
       it->~Variable();
   else
-    for(auto element : *implementation) element.~Variable();
+    for(Variable& element : *implementation) element.~Variable();
   reduceSize(implementation, count);
 }
 
@@ -123,7 +151,7 @@ ArrayImplementation::Iterator ArrayImplementation::insert(ArrayImplementation*&
   size_t old_count = implementation->count;
   if(at >= old_count) return increaseSize(implementation, count);
   increaseSize(implementation, count);
-  memmove(implementation->getData() + at + count,
+  memmove(static_cast<void*>(implementation->getData() + at + count),
           implementation->getData() + at,
           (old_count - at) * sizeof (Link));
   return implementation->getData() + at;
@@ -138,13 +166,13 @@ void ArrayImplementation::remove(ArrayImplementation*& implementation, size_t at
       it != end; ++it) it->~Variable();
 
   size_t old_count = implementation->count;
-  memmove(implementation->getData() + at,
+  memmove(static_cast<void*>(implementation->getData() + at),
           implementation->getData() + at + count,
           (old_count - at - count) * sizeof (Link));
   return reduceSize(implementation, count);
 }
 
-void ArrayImplementation::clear(ArrayImplementation*& implementation) {popBack(implementation, implementation->getSize());}
+void ArrayImplementation::clear(ArrayImplementation*& implementation) {popBack(implementation, implementation->count);}
 
 Variable ArrayImplementation::operator[](size_t index) {
   if(index < getElementCount())
@@ -162,6 +190,6 @@ ArrayImplementation::ConstReverseIterator ArrayImplementation::crbegin() const {
 ArrayImplementation::ConstReverseIterator ArrayImplementation::crend() const {return ArrayImplementation::ReverseIterator(getData() - 1);}
 
 void ArrayImplementation::operator delete(void* ptr) {
-  for(auto element : *reinterpret_cast<ArrayImplementation*>(ptr)) element.~Variable();
-  return ::delete [] reinterpret_cast<byte*>(ptr);
+  for(Variable& element : *reinterpret_cast<ArrayImplementation*>(ptr)) element.~Variable();
+  return std::free(ptr);
 }
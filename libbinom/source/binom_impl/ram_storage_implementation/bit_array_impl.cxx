@@ -1,6 +1,9 @@
 #include "libbinom/include/binom_impl/ram_storage_implementation/bit_array_impl.hxx"
 #include "libbinom/include/utils/util_functions.hxx"
 #include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <new>
 
 using namespace binom;
 using namespace binom::priv;
@@ -14,17 +17,44 @@ BitArrayImplementation::BitArrayImplementation(const literals::bitarr& bit_array
     (*it) = *data_it;
 }
 
+BitArrayImplementation::BitArrayImplementation(size_t bit_count)
+  : bit_size(bit_count), capacity(calculateCapacity(bit_count)) {}
+
 BitArrayImplementation::BitArrayImplementation(const BitArrayImplementation& other)
   : bit_size(other.bit_size), capacity(other.capacity) {
   memcpy(getData(), other.getData(), getByteSize());
 }
 
+void* BitArrayImplementation::allocate(size_t capacity) {
+  if(void* memory = std::malloc(capacity)) return memory;
+  throw std::bad_alloc();
+}
+
+void BitArrayImplementation::reallocate(BitArrayImplementation*& implementation, size_t capacity) {
+  static_assert(std::is_trivially_destructible_v<BitArrayImplementation>);
+  // Header is plain size fields followed by raw bits, so block is relocated bitwise
+  void* memory = std::realloc(static_cast<void*>(implementation), capacity);
+  if(!memory) throw std::bad_alloc();
+  implementation = reinterpret_cast<BitArrayImplementation*>(memory);
+  implementation->capacity = capacity;
+}
+
 BitArrayImplementation* BitArrayImplementation::create(const literals::bitarr& bit_array_data) {
-  return new(new byte[ calculateCapacity(bit_array_data.size()) ]) BitArrayImplementation(bit_array_data);
+  return new(allocate(calculateCapacity(bit_array_data.size()))) BitArrayImplementation(bit_array_data);
+}
+
+BitArrayImplementation* BitArrayImplementation::create(size_t bit_count) {
+  return new(allocate(calculateCapacity(bit_count))) BitArrayImplementation(bit_count);
+}
+
+BitArrayImplementation* BitArrayImplementation::createZeroed(size_t bit_count) {
+  BitArrayImplementation* implementation = create(bit_count);
+  std::memset(implementation->getDataAs<byte>(), 0, implementation->getByteSize());
+  return implementation;
 }
 
 BitArrayImplementation* BitArrayImplementation::copy(const BitArrayImplementation* other) {
-  return new(new byte[ other->capacity ]) BitArrayImplementation(*other);
+  return new(allocate(other->capacity)) BitArrayImplementation(*other);
 }
 
 size_t BitArrayImplementation::calculateByteSize(size_t bit_count) noexcept {
@@ -32,21 +62,12 @@ size_t BitArrayImplementation::calculateByteSize(size_t bit_count) noexcept {
 }
 
 BitIterator BitArrayImplementation::increaseSize(BitArrayImplementation*& implementation, size_t bit_count) {
-  const size_t new_bit_size = implementation->bit_size + bit_count;
-  const size_t new_capacity = calculateCapacity(new_bit_size);
-  if(implementation->capacity != new_capacity) {
-    const size_t old_bit_size = implementation->bit_size;
-    BitArrayImplementation* old_pointer = implementation;
-    implementation = new(new byte[ sizeof(BitArrayImplementation) + new_capacity ]) BitArrayImplementation(*old_pointer);
-    implementation->bit_size = new_bit_size;
-    implementation->capacity = new_capacity;
-    delete old_pointer;
-    return implementation->getData()[old_bit_size / 8].getItearatorAt(old_bit_size % 8);
-  } else {
-    BitIterator it = implementation->end();
-    implementation->bit_size = new_bit_size;
-    return it;
-  }
+  const size_t old_bit_size = implementation->bit_size;
+  const size_t new_bit_size = old_bit_size + bit_count;
+  if(sizeof(BitArrayImplementation) + calculateByteSize(new_bit_size) > implementation->capacity)
+    reallocate(implementation, calculateCapacity(new_bit_size));
+  implementation->bit_size = new_bit_size;
+  return implementation->getData()[old_bit_size / 8].getItearatorAt(old_bit_size % 8);
 }
 
 void BitArrayImplementation::reduceSize(BitArrayImplementation*& implementation, size_t bit_count) {
@@ -173,12 +194,15 @@ void BitArrayImplementation::clear(BitArrayImplementation*& implementation) {
   shrinkToFit(implementation);
 }
 
+void BitArrayImplementation::reserve(BitArrayImplementation*& implementation, size_t bit_count) {
+  if(calculateByteSize(bit_count) > std::numeric_limits<size_t>::max() - sizeof(BitArrayImplementation)) throw std::bad_alloc();
+  const size_t capacity = sizeof(BitArrayImplementation) + calculateByteSize(bit_count);
+  if(capacity > implementation->capacity) reallocate(implementation, capacity);
+}
+
 void BitArrayImplementation::shrinkToFit(BitArrayImplementation*& implementation) {
-  if(implementation->getByteSize() == implementation->capacity) return;
-  implementation->capacity = sizeof(BitArrayImplementation) + implementation->getByteSize();
-  BitArrayImplementation* old_pointer = implementation;
-  implementation = new(new byte[ sizeof(BitArrayImplementation) + implementation->capacity ]) BitArrayImplementation(*old_pointer);
-  delete old_pointer;
+  const size_t capacity = sizeof(BitArrayImplementation) + implementation->getByteSize();
+  if(capacity < implementation->capacity) reallocate(implementation, capacity);
 }
 
 size_t BitArrayImplementation::calculateCapacity(size_t bit_count) noexcept {
@@ -237,6 +261,8 @@ void BitArrayImplementation::popFront(BitArrayImplementation*& implementation, s
 
 size_t BitArrayImplementation::getCapacity() const noexcept {return capacity;}
 
+size_t BitArrayImplementation::getBitCapacity() const noexcept {return (capacity - sizeof(BitArrayImplementation)) * 8;}
+
 size_t BitArrayImplementation::getBitSize() const noexcept {return bit_size;}
 
 size_t BitArrayImplementation::getByteSize() const noexcept {return calculateByteSize(bit_size);}
@@ -249,7 +275,7 @@ const void* BitArrayImplementation::getDataPointer() const noexcept {
   return this + 1;
 }
 
-void BitArrayImplementation::operator delete(void* ptr) {return ::delete [] reinterpret_cast<byte*>(ptr);}
+void BitArrayImplementation::operator delete(void* ptr) {return std::free(ptr);}
 
 BitValueRef BitArrayImplementation::operator[](size_t index) const noexcept {return getData()[index / 8][index % 8];}
 
@@ -1,6 +1,10 @@
 #include "libbinom/include/binom_impl/ram_storage_implementation/buffer_array_impl.hxx"
 #include "libbinom/include/utils/util_functions.hxx"
 
+#include <cstdlib>
+#include <limits>
+#include <new>
+
 using namespace binom;
 using namespace binom::priv;
 using namespace binom::literals;
@@ -8,125 +12,184 @@ using namespace binom::literals;
 
 BufferArrayImplementation::BufferArrayImplementation(const BufferArrayImplementation& other)
   : size(other.size), capacity(other.capacity) {
-  memcpy(getData(), other.getData(), size);
+  memcpy(static_cast<void*>(this + 1), static_cast<const void*>(&other + 1), size);
 }
 
 size_t BufferArrayImplementation::calculateCapacity(size_t size) noexcept {
   return util_functions::getNearestPow2(sizeof(BufferArrayImplementation) + size);
 }
 
-BufferArrayImplementation* BufferArrayImplementation::copy(const BufferArrayImplementation* other) {
-  return new(new byte[ sizeof(BufferArrayImplementation) + other->capacity ]) BufferArrayImplementation(*other);
+void* BufferArrayImplementation::allocate(size_t capacity) {
+  if(void* memory = std::malloc(capacity)) return memory;
+  throw std::bad_alloc();
 }
 
-void BufferArrayImplementation::popBack(BufferArrayImplementation*& implementation, VarBitWidth type, size_t count) {
-  return remove(implementation, type, implementation->size - count, count);
+void BufferArrayImplementation::reallocate(BufferArrayStorage& storage, size_t capacity) {
+  static_assert(std::is_trivially_destructible_v<BufferArrayImplementation>);
+  if(isInline(storage)) {
+    const size_t size = getSize(storage);
+    BufferArrayImplementation* moved = new(allocate(capacity)) BufferArrayImplementation(size);
+    std::memcpy(static_cast<void*>(moved + 1), storage.inline_buffer.data, size);
+    moved->capacity = capacity;
+    storage = {.implementation = moved};
+    return;
+  }
+  // Header is plain size fields followed by raw data, so block is relocated bitwise
+  void* memory = std::realloc(static_cast<void*>(storage.implementation), capacity);
+  if(!memory) throw std::bad_alloc();
+  storage.implementation = reinterpret_cast<BufferArrayImplementation*>(memory);
+  storage.implementation->capacity = capacity;
 }
 
-void BufferArrayImplementation::popFront(BufferArrayImplementation*& implementation, VarBitWidth type, size_t count) {
-  return remove(implementation, type, 0, count);
+BufferArrayStorage BufferArrayImplementation::createInline(size_t size) noexcept {
+  return {.inline_buffer = {.header = ui8(size << 1 | inline_tag), .data = {}}};
 }
 
-void* BufferArrayImplementation::getData() const { return const_cast<void*>(reinterpret_cast<const void*>(this + 1)); }
+void BufferArrayImplementation::setSize(BufferArrayStorage& storage, size_t size) noexcept {
+  if(isInline(storage)) storage.inline_buffer.header = ui8(size << 1 | inline_tag);
+  else storage.implementation->size = size;
+}
 
-size_t BufferArrayImplementation::getSize() const noexcept {return size;}
+BufferArrayStorage BufferArrayImplementation::create(VarBitWidth type, size_t count) {
+  const size_t size = count * size_t(type);
+  if(fitsInline(type, size)) return createInline(size);
+  return {.implementation = new(allocate(calculateCapacity(size))) BufferArrayImplementation(size)};
+}
 
-size_t BufferArrayImplementation::getElementCount(VarBitWidth type) const noexcept {return size_t(std::ceil(llf_t(size)/ size_t(type)));}
+BufferArrayStorage BufferArrayImplementation::createZeroed(VarBitWidth type, size_t count) {
+  BufferArrayStorage storage = create(type, count);
+  std::memset(getData(storage), 0, getSize(storage));
+  return storage;
+}
 
-size_t BufferArrayImplementation::getCapacity() const noexcept {return capacity;}
+BufferArrayStorage BufferArrayImplementation::copy(const BufferArrayStorage& other) {
+  // Inline buffer is copied with storage
+  if(isInline(other)) return other;
+  return {.implementation = new(allocate(other.implementation->capacity)) BufferArrayImplementation(*other.implementation)};
+}
 
-void* BufferArrayImplementation::increaseSize(BufferArrayImplementation*& implementation, VarBitWidth type, size_t count) {
-  const size_t new_size = implementation->size + count * size_t(type);
-  const size_t old_size = implementation->size;
-  const size_t new_capacity = calculateCapacity(new_size);
-  if(new_capacity == implementation->capacity) {
-    BufferArrayImplementation* new_implementation = new(new byte[ new_capacity ]) BufferArrayImplementation(*implementation);
-    new_implementation->size = new_size;
-    new_implementation->capacity = new_capacity;
-    delete implementation;
-    implementation = new_implementation;
-  } else {
-    implementation->size = new_size;
-  }
-  return implementation->getDataAs<byte>() + old_size;
+void BufferArrayImplementation::destroy(BufferArrayStorage& storage) noexcept {
+  if(!isInline(storage)) std::free(static_cast<void*>(storage.implementation));
+  storage = createInline(0);
+}
+
+void BufferArrayImplementation::popBack(BufferArrayStorage& storage, VarBitWidth type, size_t count) {
+  const size_t element_count = getElementCount(storage, type);
+  return remove(storage, type, count < element_count ? element_count - count : 0, count);
+}
+
+void BufferArrayImplementation::popFront(BufferArrayStorage& storage, VarBitWidth type, size_t count) {
+  return remove(storage, type, 0, count);
+}
+
+byte* BufferArrayImplementation::getData(const BufferArrayStorage& storage) noexcept {
+  if(isInline(storage)) return const_cast<byte*>(storage.inline_buffer.data);
+  return reinterpret_cast<byte*>(storage.implementation + 1);
+}
+
+size_t BufferArrayImplementation::getSize(const BufferArrayStorage& storage) noexcept {
+  if(isInline(storage)) return storage.inline_buffer.header >> 1;
+  return storage.implementation->size;
+}
+
+size_t BufferArrayImplementation::getElementCount(const BufferArrayStorage& storage, VarBitWidth type) noexcept {
+  return size_t(std::ceil(llf_t(getSize(storage))/ size_t(type)));
+}
+
+size_t BufferArrayImplementation::getCapacity(const BufferArrayStorage& storage) noexcept {
+  if(isInline(storage)) return sizeof(storage);
+  return storage.implementation->capacity;
 }
 
-void BufferArrayImplementation::reduceSize(BufferArrayImplementation*& implementation, VarBitWidth type, size_t count) {
+size_t BufferArrayImplementation::getElementCapacity(const BufferArrayStorage& storage, VarBitWidth type) noexcept {
+  if(isInline(storage)) return type == VarBitWidth::byte ? inline_capacity : 0;
+  return (storage.implementation->capacity - sizeof(BufferArrayImplementation)) / size_t(type);
+}
+
+void* BufferArrayImplementation::increaseSize(BufferArrayStorage& storage, VarBitWidth type, size_t count) {
+  const size_t old_size = getSize(storage);
+  const size_t new_size = old_size + count * size_t(type);
+  // Inline buffer moves to heap block once it overflows
+  if(isInline(storage) ? !fitsInline(type, new_size)
+                       : sizeof(BufferArrayImplementation) + new_size > storage.implementation->capacity)
+    reallocate(storage, calculateCapacity(new_size));
+  setSize(storage, new_size);
+  return getData(storage) + old_size;
+}
+
+void BufferArrayImplementation::reduceSize(BufferArrayStorage& storage, VarBitWidth type, size_t count) {
   const size_t size = count * size_t(type);
-  if(size <= implementation->size) {
-    implementation->size -= size;
-    return;
-  } else {
-    implementation->size = 0;
-    return;
-  }
+  const size_t old_size = getSize(storage);
+  setSize(storage, size <= old_size ? old_size - size : 0);
 }
 
-void BufferArrayImplementation::shrinkToFit(BufferArrayImplementation*& implementation) {
-  if(implementation->size == implementation->capacity) return;
-  implementation->capacity = sizeof(BufferArrayImplementation) + implementation->size;
-  BufferArrayImplementation* old_implementation = implementation;
-  implementation = new(new byte[ implementation->capacity ]) BufferArrayImplementation(*old_implementation);
-  delete old_implementation;
+void BufferArrayImplementation::reserve(BufferArrayStorage& storage, VarBitWidth type, size_t count) {
+  if(count > (std::numeric_limits<size_t>::max() - sizeof(BufferArrayImplementation)) / size_t(type)) throw std::bad_alloc();
+  if(count <= getElementCapacity(storage, type)) return;
+  reallocate(storage, sizeof(BufferArrayImplementation) + count * size_t(type));
 }
 
-void* BufferArrayImplementation::insertBlock(BufferArrayImplementation*& implementation, VarBitWidth type, size_t at, size_t count) {
-  size_t old_size = implementation->size;
+void BufferArrayImplementation::shrinkToFit(BufferArrayStorage& storage) {
+  if(isInline(storage)) return;
+  const size_t capacity = sizeof(BufferArrayImplementation) + storage.implementation->size;
+  if(capacity < storage.implementation->capacity) reallocate(storage, capacity);
+}
+
+void* BufferArrayImplementation::insertBlock(BufferArrayStorage& storage, VarBitWidth type, size_t at, size_t count) {
+  size_t old_size = getSize(storage);
   size_t from = at * size_t(type);
-  if(from >= old_size) return increaseSize(implementation, type, count);
-  increaseSize(implementation, type, count);
-  memmove(implementation->getDataAs<byte>() + from + count * size_t(type),
-          implementation->getDataAs<byte>() + from,
+  if(from >= old_size) return increaseSize(storage, type, count);
+  increaseSize(storage, type, count);
+  memmove(getData(storage) + from + count * size_t(type),
+          getData(storage) + from,
           old_size - from);
-  return implementation->getDataAs<byte>() + from;
+  return getData(storage) + from;
 }
 
-void BufferArrayImplementation::remove(BufferArrayImplementation*& implementation, VarBitWidth type, size_t at, size_t count) {
+void BufferArrayImplementation::remove(BufferArrayStorage& storage, VarBitWidth type, size_t at, size_t count) {
   size_t rm_size = count * size_t(type);
   size_t from = at * size_t(type);
-  if(from >= implementation->size) return;
-  if(from + rm_size >= implementation->size)
-    return reduceSize(implementation, VarBitWidth::byte, implementation->size - from);
-  size_t old_size = implementation->size;
-  memmove(implementation->getDataAs<byte>() + from,
-          implementation->getDataAs<byte>() + from + rm_size,
+  size_t old_size = getSize(storage);
+  if(from >= old_size) return;
+  if(from + rm_size >= old_size)
+    return reduceSize(storage, VarBitWidth::byte, old_size - from);
+  memmove(getData(storage) + from,
+          getData(storage) + from + rm_size,
           old_size - from - rm_size);
-  return reduceSize(implementation, type, count);
+  return reduceSize(storage, type, count);
 }
 
-void BufferArrayImplementation::clear(BufferArrayImplementation*& implementation, VarBitWidth type) {
-  return remove(implementation, type, 0, implementation->size);
+void BufferArrayImplementation::clear(BufferArrayStorage& storage, VarBitWidth type) {
+  return remove(storage, type, 0, getSize(storage));
 }
 
-void* BufferArrayImplementation::get(VarBitWidth type, size_t at) const {
+void* BufferArrayImplementation::get(const BufferArrayStorage& storage, VarBitWidth type, size_t at) noexcept {
   switch (type) {
-  case VarBitWidth::byte: return getDataAs<byte>() + at;
-  case VarBitWidth::word: return getDataAs<word>() + at;
-  case VarBitWidth::dword: return getDataAs<dword>() + at;
-  case VarBitWidth::qword: return getDataAs<qword>() + at;
+  case VarBitWidth::byte: return reinterpret_cast<byte*>(getData(storage)) + at;
+  case VarBitWidth::word: return reinterpret_cast<word*>(getData(storage)) + at;
+  case VarBitWidth::dword: return reinterpret_cast<dword*>(getData(storage)) + at;
+  case VarBitWidth::qword: return reinterpret_cast<qword*>(getData(storage)) + at;
   case VarBitWidth::invalid_type:
   default: return nullptr;
   }
 }
 
-GenericValueRef BufferArrayImplementation::get(ValType type, size_t at) {return GenericValueRef(type, get(toBitWidth(type), at));}
-
-const GenericValueRef BufferArrayImplementation::get(ValType type, size_t at) const {return GenericValueRef(type, get(toBitWidth(type), at));}
-
-GenericValueIterator BufferArrayImplementation::begin(ValType type) {return GenericValueIterator(type, getData());}
-
-GenericValueIterator BufferArrayImplementation::end(ValType type) {return GenericValueIterator(type, getDataAs<byte>() + getElementCount(toBitWidth(type)) * size_t(toBitWidth(type)));}
-
-const GenericValueIterator BufferArrayImplementation::begin(ValType type) const {return GenericValueIterator(type, getData());}
-
-const GenericValueIterator BufferArrayImplementation::end(ValType type) const {return GenericValueIterator(type, getDataAs<byte>() + getElementCount(toBitWidth(type)) * size_t(toBitWidth(type)));}
-
-ReverseGenericValueIterator BufferArrayImplementation::rbegin(ValType type) {return ReverseGenericValueIterator(type, getDataAs<byte>() + (i64(getElementCount(toBitWidth(type))) - 1) * size_t(toBitWidth(type)));}
+GenericValueRef BufferArrayImplementation::get(const BufferArrayStorage& storage, ValType type, size_t at) noexcept {
+  return GenericValueRef(type, get(storage, toBitWidth(type), at));
+}
 
-ReverseGenericValueIterator BufferArrayImplementation::rend(ValType type) {return ReverseGenericValueIterator(type, getDataAs<byte>() - size_t(toBitWidth(type)));}
+GenericValueIterator BufferArrayImplementation::begin(const BufferArrayStorage& storage, ValType type) noexcept {
+  return GenericValueIterator(type, getData(storage));
+}
 
-const ReverseGenericValueIterator BufferArrayImplementation::rbegin(ValType type) const {return ReverseGenericValueIterator(type, getDataAs<byte>() + (i64(getElementCount(toBitWidth(type))) - 1) * size_t(toBitWidth(type)));}
+GenericValueIterator BufferArrayImplementation::end(const BufferArrayStorage& storage, ValType type) noexcept {
+  return GenericValueIterator(type, getData(storage) + getElementCount(storage, toBitWidth(type)) * size_t(toBitWidth(type)));
+}
 
-const ReverseGenericValueIterator BufferArrayImplementation::rend(ValType type) const {return ReverseGenericValueIterator(type, getDataAs<byte>() - size_t(toBitWidth(type)));}
+ReverseGenericValueIterator BufferArrayImplementation::rbegin(const BufferArrayStorage& storage, ValType type) noexcept {
+  return ReverseGenericValueIterator(type, getData(storage) + (i64(getElementCount(storage, toBitWidth(type))) - 1) * size_t(toBitWidth(type)));
+}
 
-void BufferArrayImplementation::operator delete(void* ptr) {return ::delete [] reinterpret_cast<byte*>(ptr);}
+ReverseGenericValueIterator BufferArrayImplementation::rend(const BufferArrayStorage& storage, ValType type) noexcept {
+  return ReverseGenericValueIterator(type, getData(storage) - size_t(toBitWidth(type)));
+}
@@ -0,0 +1,289 @@
+#include "libbinom/include/binom_impl/ram_storage_implementation/hash_map_impl.hxx"
+#include "libbinom/include/variables/named_variable.hxx"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <limits>
+#include <new>
+
+using namespace binom;
+using namespace binom::priv;
+using namespace binom::literals;
+
+namespace {
+
+constexpr size_t group_size = HashMapImplementation::group_size;
+//! Bytes of key, variable and control byte of one slot
+constexpr size_t slot_size = sizeof(KeyValue) + sizeof(Variable) + sizeof(ui8);
+
+// Control byte of full slot is 7 bits of key hash, empty and deleted slots have highest bit set
+constexpr ui8 empty_control = 0x80;
+constexpr ui8 deleted_control = 0xFE;
+constexpr ui64 lsbs = 0x0101010101010101ull;
+constexpr ui64 msbs = 0x8080808080808080ull;
+
+static_assert(group_size == sizeof(ui64));
+
+inline bool isFull(ui8 control) noexcept {return !(control & empty_control);}
+inline ui8 getControl(size_t hash) noexcept {return hash & 0x7F;}
+//! Maximal element count is 7/8 of capacity, so probing always reaches empty slot
+inline size_t getMaxLoad(size_t capacity) noexcept {return capacity - capacity / 8;}
+
+//! Control bytes of group in one word, byte of slot i is byte i of word
+inline ui64 loadGroup(const ui8* controls) noexcept {
+  ui64 group;
+  std::memcpy(&group, controls, sizeof(ui64));
+  if constexpr (std::endian::native == std::endian::big) group = __builtin_bswap64(group);
+  return group;
+}
+
+//! Highest bits of bytes equal to control are set, bytes after matched one may be matched falsely
+inline ui64 matchControl(ui64 group, ui8 control) noexcept {
+  const ui64 difference = group ^ (lsbs * control);
+  return (difference - lsbs) & ~difference & msbs;
+}
+
+inline ui64 matchEmpty(ui64 group) noexcept {return group & ~(group << 6) & msbs;}
+
+inline ui64 matchEmptyOrDeleted(ui64 group) noexcept {return group & msbs;}
+
+inline size_t getFirstMatch(ui64 match) noexcept {return std::countr_zero(match) / 8;}
+
+}
+
+HashMapImplementation::NamedVariable HashMapImplementation::getNamedVariable(size_t index) const noexcept {
+  return NamedVariable(keys[index], variables[index]);
+}
+
+size_t HashMapImplementation::findIndex(KeyValue& key, size_t hash) const noexcept {
+  if(!capacity) return npos;
+  const size_t group_mask = capacity / group_size - 1;
+  const ui8 control = getControl(hash);
+  // Triangular probing visits each group once
+  for(size_t group_index = (hash >> 7) & group_mask, step = 0;; group_index = (group_index + ++step) & group_mask) {
+    const ui64 group = loadGroup(controls + group_index * group_size);
+    for(ui64 match = matchControl(group, control); match; match &= match - 1) {
+      const size_t index = group_index * group_size + getFirstMatch(match);
+      if(keys[index].getCompare(key) == KeyValue::equal) return index;
+    }
+    if(matchEmpty(group)) return npos;
+  }
+}
+
+size_t HashMapImplementation::findInsertIndex(size_t hash) const noexcept {
+  const size_t group_mask = capacity / group_size - 1;
+  for(size_t group_index = (hash >> 7) & group_mask, step = 0;; group_index = (group_index + ++step) & group_mask)
+    if(const ui64 match = matchEmptyOrDeleted(loadGroup(controls + group_index * group_size)); match)
+      return group_index * group_size + getFirstMatch(match);
+}
+
+size_t HashMapImplementation::insertElement(KeyValue& key, Variable& variable, size_t hash) {
+  size_t index = capacity ? findInsertIndex(hash) : npos;
+  if(index == npos || (!growth_left && controls[index] == empty_control)) {
+    // Table which is mostly filled by deleted slots is cleaned up without growth
+    rehash(!capacity ? group_size
+           : element_count * 2 >= getMaxLoad(capacity) ? capacity * 2
+           : capacity);
+    index = findInsertIndex(hash);
+  }
+  if(controls[index] == empty_control) --growth_left;
+  controls[index] = getControl(hash);
+  new(keys + index) KeyValue(std::move(key));
+  new(variables + index) Variable(variable.move());
+  ++element_count;
+  return index;
+}
+
+void HashMapImplementation::eraseElement(size_t index) {
+  keys[index].~KeyValue();
+  variables[index].~Variable();
+  --element_count;
+  // Probing stops at group with empty slot, so slot of such group can become empty without breaking probe sequences
+  if(matchEmpty(loadGroup(controls + index / group_size * group_size))) {
+    controls[index] = empty_control;
+    ++growth_left;
+  } else controls[index] = deleted_control;
+}
+
+void HashMapImplementation::rehash(size_t new_capacity) {
+  ui8* old_controls = controls;
+  KeyValue* old_keys = keys;
+  Variable* old_variables = variables;
+  const size_t old_capacity = capacity;
+
+  // Keys, variables and control bytes are placed in one block
+  byte* block = new byte[new_capacity * slot_size];
+  keys = reinterpret_cast<KeyValue*>(block);
+  variables = reinterpret_cast<Variable*>(block + new_capacity * sizeof(KeyValue));
+  controls = reinterpret_cast<ui8*>(block + new_capacity * (sizeof(KeyValue) + sizeof(Variable)));
+  capacity = new_capacity;
+  std::memset(controls, empty_control, capacity);
+
+  // Keys and variables don't reference themselves, so they are relocated bitwise
+  for(size_t i = 0; i < old_capacity; ++i) {
+    if(!isFull(old_controls[i])) continue;
+    const size_t hash = old_keys[i].getHash();
+    const size_t index = findInsertIndex(hash);
+    controls[index] = getControl(hash);
+    std::memcpy(static_cast<void*>(keys + index), static_cast<const void*>(old_keys + i), sizeof(KeyValue));
+    std::memcpy(static_cast<void*>(variables + index), static_cast<const void*>(old_variables + i), sizeof(Variable));
+  }
+  growth_left = getMaxLoad(capacity) - element_count;
+  delete[] reinterpret_cast<byte*>(old_keys);
+}
+
+size_t HashMapImplementation::nextFullIndex(size_t index) const noexcept {
+  while(index < capacity && !isFull(controls[index])) ++index;
+  return index;
+}
+
+HashMapImplementation::HashMapImplementation(const literals::hashmap& map) {
+  reserve(map.end() - map.begin());
+  for(auto& element : map) insert(std::move(element.getKey()), element.getVariable().move());
+}
+
+HashMapImplementation::HashMapImplementation(const HashMapImplementation& other) {
+  if(!other.element_count) return;
+  // Layout of other table is kept, so elements are copied without rehash
+  rehash(other.capacity);
+  std::memcpy(controls, other.controls, capacity);
+  for(size_t i = 0; i < capacity; ++i) {
+    if(!isFull(controls[i])) continue;
+    new(keys + i) KeyValue(other.keys[i]);
+    new(variables + i) Variable(other.variables[i]);
+  }
+  element_count = other.element_count;
+  growth_left = other.growth_left;
+}
+
+HashMapImplementation::HashMapImplementation(HashMapImplementation&& other)
+  : controls(other.controls), keys(other.keys), variables(other.variables),
+    capacity(other.capacity), element_count(other.element_count), growth_left(other.growth_left) {
+  other.controls = nullptr;
+  other.keys = nullptr;
+  other.variables = nullptr;
+  other.capacity = other.element_count = other.growth_left = 0;
+}
+
+HashMapImplementation::~HashMapImplementation() { clear(); }
+
+bool HashMapImplementation::isEmpty() const noexcept {return !element_count;}
+
+size_t HashMapImplementation::getSize() const noexcept {return element_count;}
+
+size_t HashMapImplementation::getCapacity() const noexcept {return getMaxLoad(capacity);}
+
+bool HashMapImplementation::contains(KeyValue value) const noexcept {return findIndex(value, value.getHash()) != npos;}
+
+void HashMapImplementation::reserve(size_t count) {
+  // Capacity is power of two and block of the largest one must be addressable
+  if(count > getMaxLoad(std::bit_floor(std::numeric_limits<size_t>::max() / slot_size))) throw std::bad_alloc();
+  size_t new_capacity = group_size;
+  while(getMaxLoad(new_capacity) < count) new_capacity *= 2;
+  if(new_capacity > capacity) rehash(new_capacity);
+}
+
+err::ProgressReport<HashMapImplementation::NamedVariable> HashMapImplementation::insert(KeyValue key, Variable variable) {
+  const size_t hash = key.getHash();
+  if(findIndex(key, hash) != npos) return err::ErrorType::binom_key_unique_error;
+  return getNamedVariable(insertElement(key, variable, hash));
+}
+
+binom::err::Error HashMapImplementation::remove(KeyValue key) {
+  const size_t index = findIndex(key, key.getHash());
+  if(index == npos) return ErrorType::binom_out_of_range;
+  eraseElement(index);
+  return ErrorType::no_error;
+}
+
+HashMapImplementation::NamedVariable HashMapImplementation::getOrInsertNamedVariable(KeyValue key) {
+  const size_t hash = key.getHash();
+  size_t index = findIndex(key, hash);
+  if(index == npos) {
+    Variable variable = nullptr;
+    index = insertElement(key, variable, hash);
+  }
+  return getNamedVariable(index);
+}
+
+binom::Variable HashMapImplementation::getVariable(KeyValue key) const {
+  const size_t index = findIndex(key, key.getHash());
+  if(index == npos) return nullptr;
+  return variables[index].move();
+}
+
+HashMapImplementation::Iterator HashMapImplementation::find(KeyValue key) {
+  const size_t index = findIndex(key, key.getHash());
+  return Iterator(this, index == npos ? capacity : index);
+}
+
+HashMapImplementation::ConstIterator HashMapImplementation::find(KeyValue key) const {
+  const size_t index = findIndex(key, key.getHash());
+  return ConstIterator(this, index == npos ? capacity : index);
+}
+
+std::vector<HashMapImplementation::ConstIterator> HashMapImplementation::getKeyOrder() const {
+  std::vector<ConstIterator> order;
+  order.reserve(element_count);
+  for(ConstIterator it = cbegin(), end = cend(); it != end; ++it) order.push_back(it);
+  std::sort(order.begin(), order.end(), [](const ConstIterator& first, const ConstIterator& second) {
+    return first.getKey().getCompare(const_cast<KeyValue&>(second.getKey())) == KeyValue::lower;
+  });
+  return order;
+}
+
+void HashMapImplementation::clear() {
+  for(size_t i = 0; i < capacity; ++i) {
+    if(!isFull(controls[i])) continue;
+    keys[i].~KeyValue();
+    variables[i].~Variable();
+  }
+  delete[] reinterpret_cast<byte*>(keys);
+  controls = nullptr;
+  keys = nullptr;
+  variables = nullptr;
+  capacity = element_count = growth_left = 0;
+}
+
+HashMapImplementation::Iterator HashMapImplementation::begin() noexcept {return Iterator(this, nextFullIndex(0));}
+
+HashMapImplementation::Iterator HashMapImplementation::end() noexcept {return Iterator(this, capacity);}
+
+HashMapImplementation::ConstIterator HashMapImplementation::begin() const noexcept {return cbegin();}
+
+HashMapImplementation::ConstIterator HashMapImplementation::end() const noexcept {return cend();}
+
+HashMapImplementation::ConstIterator HashMapImplementation::cbegin() const noexcept {return ConstIterator(this, nextFullIndex(0));}
+
+HashMapImplementation::ConstIterator HashMapImplementation::cend() const noexcept {return ConstIterator(this, capacity);}
+
+
+
+
+HashMapImplementation::Iterator& HashMapImplementation::Iterator::operator++() noexcept {index = map->nextFullIndex(index + 1); return self;}
+
+HashMapImplementation::Iterator HashMapImplementation::Iterator::operator++(int) noexcept {Iterator tmp = self; ++self; return tmp;}
+
+HashMapImplementation::NamedVariable HashMapImplementation::Iterator::operator*() {return map->getNamedVariable(index);}
+
+pseudo_ptr::PseudoPointer<HashMapImplementation::NamedVariable> HashMapImplementation::Iterator::operator->() {return *self;}
+
+const HashMapImplementation::NamedVariable HashMapImplementation::Iterator::operator*() const {return map->getNamedVariable(index);}
+
+pseudo_ptr::PseudoPointer<const HashMapImplementation::NamedVariable> HashMapImplementation::Iterator::operator->() const {return *self;}
+
+
+
+
+HashMapImplementation::ConstIterator& HashMapImplementation::ConstIterator::operator++() noexcept {index = map->nextFullIndex(index + 1); return self;}
+
+HashMapImplementation::ConstIterator HashMapImplementation::ConstIterator::operator++(int) noexcept {ConstIterator tmp = self; ++self; return tmp;}
+
+const HashMapImplementation::NamedVariable HashMapImplementation::ConstIterator::operator*() const {return map->getNamedVariable(index);}
+
+pseudo_ptr::PseudoPointer<const HashMapImplementation::NamedVariable> HashMapImplementation::ConstIterator::operator->() const {return *self;}
+
+const KeyValue& HashMapImplementation::ConstIterator::getKey() const noexcept {return map->keys[index];}
+
+const Variable& HashMapImplementation::ConstIterator::getVariable() const noexcept {return map->variables[index];}
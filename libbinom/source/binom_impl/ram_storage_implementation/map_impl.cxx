@@ -1,78 +1,880 @@
 #include "libbinom/include/binom_impl/ram_storage_implementation/map_impl.hxx"
 #include "libbinom/include/variables/named_variable.hxx"
 
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
 using namespace binom;
 using namespace binom::priv;
 using namespace binom::literals;
 
+namespace {
+
+constexpr size_t node_capacity = MapImplementation::node_capacity;
+constexpr size_t min_node_fill = node_capacity / 2;
+
+//! Keys and element pointers don't reference themselves, so they are relocated bitwise (as in ArrayImplementation)
+template<typename T>
+void relocate(T* destination, T* source, size_t count) noexcept {
+  memmove(static_cast<void*>(destination), static_cast<const void*>(source), count * sizeof(T));
+}
+
+//! Index of first key which is higher than key
+size_t upperBound(const KeyValue* keys, size_t count, KeyValue& key) {
+  size_t first = 0;
+  while(count) {
+    const size_t half = count / 2;
+    if(keys[first + half].getCompare(key) != KeyValue::highter) {
+      first += half + 1;
+      count -= half + 1;
+    } else count = half;
+  }
+  return first;
+}
+
+}
+
+struct MapImplementation::Node {};
+
+struct MapImplementation::Leaf : public Node {
+  size_t element_count = 0;
+  Leaf* prev = nullptr;
+  Leaf* next = nullptr;
+  //! Comparable prefixes of element keys, contiguous so search in leaf touches only elements with prefix of searched key
+  ui64 key_prefixes[node_capacity];
+  //! Elements in order of keys, they don't move while their pointers move between leaves
+  Element* elements[node_capacity];
+
+  KeyValue& getKey(size_t index) const noexcept {return elements[index]->key;}
+
+  //! Index of first key which isn't lower than key
+  size_t lowerBound(KeyValue& key) const {
+    const ui64 key_prefix = key.getComparablePrefix();
+    size_t first = 0, count = element_count;
+    while(count) {
+      const size_t half = count / 2;
+      if(key_prefixes[first + half] < key_prefix ||
+         (key_prefixes[first + half] == key_prefix && getKey(first + half).getCompare(key) == KeyValue::lower)) {
+        first += half + 1;
+        count -= half + 1;
+      } else count = half;
+    }
+    return first;
+  }
+
+  //! Index of element, which is checked at hint before search
+  size_t indexOf(const Element* element, size_t hint) const noexcept {
+    if(hint < element_count && elements[hint] == element) return hint;
+    return std::find(elements, elements + element_count, element) - elements;
+  }
+
+  //! Elements from first up to but not including last are linked to this leaf
+  void adopt(size_t first, size_t last) noexcept {
+    for(; first < last; ++first) elements[first]->leaf = this;
+  }
+
+  //! Moves count key prefixes and elements from index of source to index of destination
+  static void move(Leaf* destination, size_t destination_index, Leaf* source, size_t source_index, size_t count) noexcept {
+    relocate(destination->key_prefixes + destination_index, source->key_prefixes + source_index, count);
+    relocate(destination->elements + destination_index, source->elements + source_index, count);
+  }
+
+  void insert(size_t index, Element* element) noexcept {
+    move(this, index + 1, this, index, element_count - index);
+    key_prefixes[index] = element->key.getComparablePrefix();
+    elements[index] = element;
+    element->leaf = this;
+    ++element_count;
+  }
+
+  //! Unlinks element, which is destroyed by map
+  void erase(size_t index) noexcept {
+    --element_count;
+    move(this, index, this, index + 1, element_count - index);
+  }
+
+  //! Unlinks all elements, which are destroyed by map
+  void eraseAll() noexcept {element_count = 0;}
+
+  //! Moves elements from index to end into empty right leaf
+  void split(size_t index, Leaf* right) noexcept {
+    right->element_count = element_count - index;
+    move(right, 0, this, index, right->element_count);
+    right->adopt(0, right->element_count);
+    element_count = index;
+  }
+
+  //! Takes all elements of right sibling if they fit, else evens element counts; returns true if right is empty
+  bool balance(Leaf* right, KeyValue& separator) {
+    const size_t total_count = element_count + right->element_count;
+    if(total_count <= node_capacity) {
+      move(this, element_count, right, 0, right->element_count);
+      adopt(element_count, total_count);
+      element_count = total_count;
+      right->element_count = 0;
+      return true;
+    }
+    const size_t left_count = total_count / 2;
+    if(element_count < left_count) {
+      const size_t count = left_count - element_count;
+      move(this, element_count, right, 0, count);
+      adopt(element_count, left_count);
+      right->element_count -= count;
+      move(right, 0, right, count, right->element_count);
+    } else {
+      const size_t count = element_count - left_count;
+      move(right, count, right, 0, right->element_count);
+      move(right, 0, this, left_count, count);
+      right->adopt(0, count);
+      right->element_count += count;
+    }
+    element_count = left_count;
+    separator = right->getKey(0);
+    return false;
+  }
+};
+
+struct MapImplementation::InnerNode : public Node {
+  size_t child_count = 0;
+  //! Key i is lower than or equal to all keys of child i + 1 and higher than all keys of child i
+  alignas(KeyValue) byte key_data[sizeof(KeyValue) * (node_capacity - 1)];
+  Node* children[node_capacity];
+  //! Element counts of child subtrees for access by index
+  size_t child_sizes[node_capacity];
+
+  KeyValue* getKeys() noexcept {return reinterpret_cast<KeyValue*>(key_data);}
+  const KeyValue* getKeys() const noexcept {return reinterpret_cast<const KeyValue*>(key_data);}
+
+  size_t getElementCount() const noexcept {
+    size_t count = 0;
+    for(size_t i = 0; i < child_count; ++i) count += child_sizes[i];
+    return count;
+  }
+
+  //! Inserts child right after child of index with separator between them
+  void insertChild(size_t index, KeyValue& separator, Node* child, size_t child_size) {
+    const size_t tail_count = child_count - index - 1;
+    relocate(getKeys() + index + 1, getKeys() + index, tail_count);
+    relocate(children + index + 2, children + index + 1, tail_count);
+    relocate(child_sizes + index + 2, child_sizes + index + 1, tail_count);
+    new(getKeys() + index) KeyValue(std::move(separator));
+    children[index + 1] = child;
+    child_sizes[index + 1] = child_size;
+    ++child_count;
+  }
+
+  //! Removes child of index (not first) with separator before it
+  void removeChild(size_t index) {
+    getKeys()[index - 1].~KeyValue();
+    const size_t tail_count = child_count - index - 1;
+    relocate(getKeys() + index - 1, getKeys() + index, tail_count);
+    relocate(children + index, children + index + 1, tail_count);
+    relocate(child_sizes + index, child_sizes + index + 1, tail_count);
+    --child_count;
+  }
+
+  //! Moves upper half of children into empty right node, returns separator between nodes
+  KeyValue split(InnerNode* right) {
+    const size_t left_count = node_capacity / 2;
+    right->child_count = child_count - left_count;
+    relocate(right->children, children + left_count, right->child_count);
+    relocate(right->child_sizes, child_sizes + left_count, right->child_count);
+    relocate(right->getKeys(), getKeys() + left_count, right->child_count - 1);
+    KeyValue separator(std::move(getKeys()[left_count - 1]));
+    getKeys()[left_count - 1].~KeyValue();
+    child_count = left_count;
+    return separator;
+  }
+
+  //! Same as Leaf::balance, separator of parent goes through it
+  bool balance(InnerNode* right, KeyValue& separator) {
+    const size_t total_count = child_count + right->child_count;
+    KeyValue* keys = getKeys();
+    KeyValue* right_keys = right->getKeys();
+    if(total_count <= node_capacity) {
+      new(keys + child_count - 1) KeyValue(std::move(separator));
+      relocate(keys + child_count, right_keys, right->child_count - 1);
+      relocate(children + child_count, right->children, right->child_count);
+      relocate(child_sizes + child_count, right->child_sizes, right->child_count);
+      child_count = total_count;
+      right->child_count = 0;
+      return true;
+    }
+    const size_t left_count = total_count / 2;
+    if(child_count == left_count) return false;
+    if(child_count < left_count) {
+      const size_t count = left_count - child_count;
+      new(keys + child_count - 1) KeyValue(std::move(separator));
+      relocate(keys + child_count, right_keys, count - 1);
+      relocate(children + child_count, right->children, count);
+      relocate(child_sizes + child_count, right->child_sizes, count);
+      separator = std::move(right_keys[count - 1]);
+      right_keys[count - 1].~KeyValue();
+      relocate(right_keys, right_keys + count, right->child_count - count - 1);
+      relocate(right->children, right->children + count, right->child_count - count);
+      relocate(right->child_sizes, right->child_sizes + count, right->child_count - count);
+      right->child_count -= count;
+    } else {
+      const size_t count = child_count - left_count;
+      relocate(right_keys + count, right_keys, right->child_count - 1);
+      relocate(right->children + count, right->children, right->child_count);
+      relocate(right->child_sizes + count, right->child_sizes, right->child_count);
+      new(right_keys + count - 1) KeyValue(std::move(separator));
+      relocate(right_keys, keys + left_count, count - 1);
+      relocate(right->children, children + left_count, count);
+      relocate(right->child_sizes, child_sizes + left_count, count);
+      separator = std::move(keys[left_count - 1]);
+      keys[left_count - 1].~KeyValue();
+      right->child_count += count;
+    }
+    child_count = left_count;
+    return false;
+  }
+};
+
+struct MapImplementation::Path {
+  //! Non-root inner nodes have at least min_node_fill children, so height is far below this limit
+  static constexpr size_t max_height = 32;
+  InnerNode* nodes[max_height];
+  size_t child_indexes[max_height];
+};
+
+struct MapImplementation::Position {
+  Leaf* leaf = nullptr;
+  size_t index = 0;
+  //! Element at position or nullptr, which is end of iteration
+  Element* getElement() const noexcept {return leaf ? leaf->elements[index] : nullptr;}
+};
+
+void MapImplementation::stepForward(Element*& element, size_t& index) noexcept {
+  Leaf* leaf = element->leaf;
+  index = leaf->indexOf(element, index) + 1;
+  if(index == leaf->element_count) {
+    leaf = leaf->next;
+    index = 0;
+  }
+  element = leaf ? leaf->elements[index] : nullptr;
+}
+
+void MapImplementation::stepBackward(Element*& element, size_t& index) noexcept {
+  Leaf* leaf = element->leaf;
+  index = leaf->indexOf(element, index);
+  if(index) { element = leaf->elements[--index]; return; }
+  leaf = leaf->prev;
+  index = leaf ? leaf->element_count - 1 : 0;
+  element = leaf ? leaf->elements[index] : nullptr;
+}
+
+MapImplementation::NamedVariable MapImplementation::getNamedVariable(Element* element) noexcept {
+  return NamedVariable(element->key, element->variable);
+}
+
+MapImplementation::Element* MapImplementation::createElement(KeyValue& key, Variable& variable) {
+  return new(element_pool.allocate()) Element(key, variable);
+}
+
+void MapImplementation::destroyElement(Element* element) noexcept {
+  element->~Element();
+  element_pool.deallocate(element);
+}
+
+MapImplementation::Position MapImplementation::findElement(KeyValue& key) const noexcept {
+  if(!root) return Position();
+  Node* node = root;
+  for(size_t level = height; level; --level) {
+    InnerNode* inner = static_cast<InnerNode*>(node);
+    node = inner->children[upperBound(inner->getKeys(), inner->child_count - 1, key)];
+  }
+  Leaf* leaf = static_cast<Leaf*>(node);
+  const Position position{leaf, leaf->lowerBound(key)};
+  return isKeyAt(position, key) ? position : Position();
+}
+
+MapImplementation::Position MapImplementation::descend(Path& path, KeyValue& key) const noexcept {
+  if(!root) return Position();
+  Node* node = root;
+  for(size_t depth = 0; depth < height; ++depth) {
+    InnerNode* inner = static_cast<InnerNode*>(node);
+    path.nodes[depth] = inner;
+    path.child_indexes[depth] = upperBound(inner->getKeys(), inner->child_count - 1, key);
+    node = inner->children[path.child_indexes[depth]];
+  }
+  Leaf* leaf = static_cast<Leaf*>(node);
+  return Position{leaf, leaf->lowerBound(key)};
+}
+
+bool MapImplementation::isKeyAt(Position position, KeyValue& key) noexcept {
+  return position.leaf && position.index < position.leaf->element_count &&
+         position.leaf->getKey(position.index).getCompare(key) == KeyValue::equal;
+}
+
+void MapImplementation::insertElement(Path& path, Position position, Element* element) {
+  ++element_count;
+  Leaf* leaf = position.leaf;
+  if(!leaf) {
+    leaf = new Leaf();
+    root = first_leaf = last_leaf = leaf;
+  }
+  if(leaf->element_count < node_capacity) {
+    leaf->insert(position.index, element);
+    for(size_t depth = 0; depth < height; ++depth) ++path.nodes[depth]->child_sizes[path.child_indexes[depth]];
+    return;
+  }
+
+  // Leaf filled in key order is left full, so sorted insertion doesn't produce half-empty leaves
+  const size_t split_index = leaf == last_leaf && position.index == node_capacity ? node_capacity : node_capacity / 2;
+  Leaf* right = new Leaf();
+  leaf->split(split_index, right);
+  right->prev = leaf;
+  right->next = leaf->next;
+  if(leaf->next) leaf->next->prev = right;
+  else last_leaf = right;
+  leaf->next = right;
+
+  if(position.index <= split_index && split_index != node_capacity) leaf->insert(position.index, element);
+  else right->insert(position.index - split_index, element);
+
+  KeyValue separator = right->getKey(0);
+  insertNode(path, height, separator, leaf->element_count, right, right->element_count, 1);
+}
+
+void MapImplementation::insertNode(Path& path, size_t depth, KeyValue& separator, size_t node_size,
+                                   Node* new_node, size_t new_node_size, size_t added_count) {
+  // Split goes up while parents are full
+  while(depth--) {
+    InnerNode* parent = path.nodes[depth];
+    const size_t child_index = path.child_indexes[depth];
+    parent->child_sizes[child_index] = node_size;
+    if(parent->child_count < node_capacity) {
+      parent->insertChild(child_index, separator, new_node, new_node_size);
+      while(depth--) path.nodes[depth]->child_sizes[path.child_indexes[depth]] += added_count;
+      return;
+    }
+    InnerNode* parent_right = new InnerNode();
+    KeyValue parent_separator = parent->split(parent_right);
+    if(child_index < parent->child_count) parent->insertChild(child_index, separator, new_node, new_node_size);
+    else parent_right->insertChild(child_index - parent->child_count, separator, new_node, new_node_size);
+    separator = std::move(parent_separator);
+    new_node = parent_right;
+    node_size = parent->getElementCount();
+    new_node_size = parent_right->getElementCount();
+  }
+
+  InnerNode* new_root = new InnerNode();
+  new_root->child_count = 2;
+  new_root->children[0] = root;
+  new_root->children[1] = new_node;
+  new_root->child_sizes[0] = node_size;
+  new_root->child_sizes[1] = new_node_size;
+  new(new_root->getKeys()) KeyValue(std::move(separator));
+  root = new_root;
+  ++height;
+}
+
+MapImplementation::Element* MapImplementation::removeElement(Path& path, Position position) {
+  --element_count;
+  Leaf* leaf = position.leaf;
+  Element* element = leaf->elements[position.index];
+  leaf->erase(position.index);
+  for(size_t depth = 0; depth < height; ++depth) --path.nodes[depth]->child_sizes[path.child_indexes[depth]];
+  if(leaf->element_count >= min_node_fill) return element;
+  if(height) rebalance(path, height);
+  elif(!leaf->element_count) {
+    delete leaf;
+    root = first_leaf = last_leaf = nullptr;
+  }
+  return element;
+}
+
+void MapImplementation::rebalance(Path& path, size_t depth) {
+  for(; depth; --depth) {
+    InnerNode* parent = path.nodes[depth - 1];
+    // Node is balanced with left sibling or with right one if it is first child
+    const size_t left_index = path.child_indexes[depth - 1] ? path.child_indexes[depth - 1] - 1 : 0;
+    KeyValue& separator = parent->getKeys()[left_index];
+    if(depth == height) {
+      Leaf* left = static_cast<Leaf*>(parent->children[left_index]);
+      Leaf* right = static_cast<Leaf*>(parent->children[left_index + 1]);
+      const bool is_merged = left->balance(right, separator);
+      parent->child_sizes[left_index] = left->element_count;
+      parent->child_sizes[left_index + 1] = right->element_count;
+      if(!is_merged) return;
+      left->next = right->next;
+      if(right->next) right->next->prev = left;
+      else last_leaf = left;
+      delete right;
+    } else {
+      InnerNode* left = static_cast<InnerNode*>(parent->children[left_index]);
+      InnerNode* right = static_cast<InnerNode*>(parent->children[left_index + 1]);
+      const bool is_merged = left->balance(right, separator);
+      parent->child_sizes[left_index] = left->getElementCount();
+      parent->child_sizes[left_index + 1] = right->getElementCount();
+      if(!is_merged) return;
+      delete right;
+    }
+    parent->removeChild(left_index + 1);
+    if(parent->child_count >= min_node_fill) return;
+  }
+
+  InnerNode* old_root = static_cast<InnerNode*>(root);
+  if(old_root->child_count > 1) return;
+  root = old_root->children[0];
+  --height;
+  delete old_root;
+}
+
+MapImplementation::Node* MapImplementation::copyNode(const Node* node, size_t level) {
+  if(!level) {
+    const Leaf* leaf = static_cast<const Leaf*>(node);
+    Leaf* copy = new Leaf();
+    copy->prev = last_leaf;
+    if(last_leaf) last_leaf->next = copy;
+    else first_leaf = copy;
+    last_leaf = copy;
+    for(size_t i = 0; i < leaf->element_count; ++i) {
+      const Element* element = leaf->elements[i];
+      KeyValue key(element->key);
+      Variable variable(element->variable);
+      copy->insert(i, createElement(key, variable));
+    }
+    return copy;
+  }
+  const InnerNode* inner = static_cast<const InnerNode*>(node);
+  InnerNode* copy = new InnerNode();
+  copy->child_count = inner->child_count;
+  std::copy_n(inner->child_sizes, inner->child_count, copy->child_sizes);
+  for(size_t i = 0; i < inner->child_count - 1; ++i) new(copy->getKeys() + i) KeyValue(inner->getKeys()[i]);
+  for(size_t i = 0; i < inner->child_count; ++i) copy->children[i] = copyNode(inner->children[i], level - 1);
+  return copy;
+}
+
+void MapImplementation::destroyNode(Node* node, size_t level) noexcept {
+  if(!level) {
+    delete static_cast<Leaf*>(node);
+    return;
+  }
+  InnerNode* inner = static_cast<InnerNode*>(node);
+  for(size_t i = 0; i < inner->child_count - 1; ++i) inner->getKeys()[i].~KeyValue();
+  for(size_t i = 0; i < inner->child_count; ++i) destroyNode(inner->children[i], level - 1);
+  delete inner;
+}
+
+void MapImplementation::appendBulkElement(KeyValue& key, Variable& variable, bool is_new_leaf) {
+  if(is_new_leaf) {
+    Leaf* leaf = new Leaf();
+    leaf->prev = last_leaf;
+    if(last_leaf) last_leaf->next = leaf;
+    else first_leaf = leaf;
+    last_leaf = leaf;
+  }
+  last_leaf->insert(last_leaf->element_count, createElement(key, variable));
+  ++element_count;
+}
+
+binom::err::Error MapImplementation::checkBulkKey(KeyValue& key) const noexcept {
+  if(!last_leaf) return ErrorType::no_error;
+  switch(last_leaf->getKey(last_leaf->element_count - 1).getCompare(key)) {
+  case KeyValue::lower: return ErrorType::no_error;
+  case KeyValue::equal: return ErrorType::binom_key_unique_error;
+  default: return ErrorType::invalid_data;
+  }
+}
+
+void MapImplementation::buildInnerLevels() {
+  // Nodes of current level with lowest keys of their subtrees, which become separators of next level
+  struct LevelNode {
+    Node* node;
+    const KeyValue* lowest_key;
+    size_t size;
+  };
+  std::vector<LevelNode> nodes;
+  for(Leaf* leaf = first_leaf; leaf; leaf = leaf->next) nodes.push_back({leaf, &leaf->getKey(0), leaf->element_count});
+  height = 0;
+  while(nodes.size() > 1) {
+    const size_t node_count = (nodes.size() + node_capacity - 1) / node_capacity;
+    size_t child_index = 0;
+    for(size_t node_index = 0; node_index < node_count; ++node_index) {
+      const size_t child_count = nodes.size() / node_count + (node_index < nodes.size() % node_count);
+      InnerNode* inner = new InnerNode();
+      LevelNode level_node{inner, nodes[child_index].lowest_key, 0};
+      for(; inner->child_count < child_count; ++inner->child_count, ++child_index) {
+        if(inner->child_count) new(inner->getKeys() + inner->child_count - 1) KeyValue(*nodes[child_index].lowest_key);
+        inner->children[inner->child_count] = nodes[child_index].node;
+        inner->child_sizes[inner->child_count] = nodes[child_index].size;
+        level_node.size += nodes[child_index].size;
+      }
+      nodes[node_index] = level_node;
+    }
+    nodes.resize(node_count);
+    ++height;
+  }
+  root = nodes.empty() ? nullptr : nodes.front().node;
+}
+
+void MapImplementation::abortBulkLoad() noexcept {
+  while(first_leaf) {
+    Leaf* next = first_leaf->next;
+    for(size_t i = 0; i < first_leaf->element_count; ++i) first_leaf->elements[i]->~Element();
+    delete first_leaf;
+    first_leaf = next;
+  }
+  height = 0;
+  element_count = 0;
+  last_leaf = nullptr;
+  element_pool.release();
+}
+
+void MapImplementation::setRoot(Node* node, size_t level, size_t size) noexcept {
+  root = node;
+  height = level;
+  element_count = size;
+  Node* first = node;
+  Node* last = node;
+  for(; level; --level) {
+    first = static_cast<InnerNode*>(first)->children[0];
+    InnerNode* inner = static_cast<InnerNode*>(last);
+    last = inner->children[inner->child_count - 1];
+  }
+  first_leaf = static_cast<Leaf*>(first);
+  last_leaf = static_cast<Leaf*>(last);
+  first_leaf->prev = nullptr;
+  last_leaf->next = nullptr;
+}
+
+void MapImplementation::takeChildren(InnerNode* node, size_t first, size_t last, size_t level) {
+  const size_t count = last - first;
+  if(!count) return;
+  size_t size = 0;
+  for(size_t i = first; i < last; ++i) size += node->child_sizes[i];
+  // Single child is taken as root of lower level, since root has at least two children
+  if(count == 1) return setRoot(node->children[first], level - 1, size);
+  InnerNode* inner = new InnerNode();
+  inner->child_count = count;
+  relocate(inner->getKeys(), node->getKeys() + first, count - 1);
+  relocate(inner->children, node->children + first, count);
+  relocate(inner->child_sizes, node->child_sizes + first, count);
+  setRoot(inner, level, size);
+}
+
+void MapImplementation::append(MapImplementation& other) {
+  if(!other.root) return;
+  if(!root) return swap(other);
+
+  // Lowest key of other map separates it from this map
+  KeyValue separator = other.first_leaf->getKey(0);
+  last_leaf->next = other.first_leaf;
+  other.first_leaf->prev = last_leaf;
+  last_leaf = other.last_leaf;
+  Node* left_root = root;
+  Node* right_root = other.root;
+  const size_t left_height = height, right_height = other.height;
+  const size_t left_count = element_count, right_count = other.element_count;
+  other.root = nullptr;
+  other.height = 0;
+  other.element_count = 0;
+  other.first_leaf = other.last_leaf = nullptr;
+
+  // Root of lower tree becomes sibling of node of its level on facing edge of higher tree
+  const bool is_left_higher = left_height >= right_height;
+  root = is_left_higher ? left_root : right_root;
+  height = is_left_higher ? left_height : right_height;
+  element_count = left_count + right_count;
+  const size_t lower_height = is_left_higher ? right_height : left_height;
+  size_t depth = height - lower_height;
+  Path path;
+  Node* node = root;
+  size_t node_size = is_left_higher ? left_count : right_count;
+  for(size_t i = 0; i < depth; ++i) {
+    InnerNode* inner = static_cast<InnerNode*>(node);
+    path.nodes[i] = inner;
+    path.child_indexes[i] = is_left_higher ? inner->child_count - 1 : 0;
+    node = inner->children[path.child_indexes[i]];
+    node_size = inner->child_sizes[path.child_indexes[i]];
+  }
+  if(is_left_higher) insertNode(path, depth, separator, node_size, right_root, right_count, right_count);
+  else {
+    // Left root takes place of first node, which is inserted after it
+    path.nodes[depth - 1]->children[0] = left_root;
+    insertNode(path, depth, separator, left_count, node, node_size, left_count);
+  }
+
+  // Former roots may be underfull, joined one is at the same level on the same edge after splits of its parents
+  depth = height - lower_height;
+  node = root;
+  for(size_t i = 0; i < depth; ++i) {
+    InnerNode* inner = static_cast<InnerNode*>(node);
+    path.nodes[i] = inner;
+    path.child_indexes[i] = is_left_higher ? inner->child_count - 1 : 0;
+    node = inner->children[path.child_indexes[i]];
+  }
+  auto is_underfull = [lower_height](Node* child) {
+    return lower_height ? static_cast<InnerNode*>(child)->child_count < min_node_fill
+                        : static_cast<Leaf*>(child)->element_count < min_node_fill;
+  };
+  InnerNode* parent = path.nodes[depth - 1];
+  if(is_underfull(parent->children[0]) || is_underfull(parent->children[parent->child_count - 1])) rebalance(path, depth);
+}
+
+void MapImplementation::splitTree(KeyValue& key, MapImplementation& upper) {
+  Path path;
+  const Position position = descend(path, key);
+  const size_t tree_height = height;
+  root = nullptr;
+  height = 0;
+  element_count = 0;
+  first_leaf = last_leaf = nullptr;
+
+  Leaf* leaf = position.leaf;
+  if(position.index == leaf->element_count) setRoot(leaf, 0, leaf->element_count);
+  elif(!position.index) upper.setRoot(leaf, 0, leaf->element_count);
+  else {
+    Leaf* upper_leaf = new Leaf();
+    leaf->split(position.index, upper_leaf);
+    setRoot(leaf, 0, leaf->element_count);
+    upper.setRoot(upper_leaf, 0, upper_leaf->element_count);
+  }
+
+  // Siblings of path are joined to parts from bottom, each join costs difference of heights, so split is O(log n)
+  for(size_t depth = tree_height; depth--;) {
+    InnerNode* node = path.nodes[depth];
+    const size_t child_index = path.child_indexes[depth], level = tree_height - depth;
+    MapImplementation lower_siblings, upper_siblings;
+    lower_siblings.takeChildren(node, 0, child_index, level);
+    upper_siblings.takeChildren(node, child_index + 1, node->child_count, level);
+    // Separators around cut child aren't taken
+    if(child_index) node->getKeys()[child_index - 1].~KeyValue();
+    if(child_index + 1 < node->child_count) node->getKeys()[child_index].~KeyValue();
+    delete node;
+    lower_siblings.append(self);
+    swap(lower_siblings);
+    upper.append(upper_siblings);
+  }
+}
+
+void MapImplementation::swap(MapImplementation& other) noexcept {
+  std::swap(root, other.root);
+  std::swap(height, other.height);
+  std::swap(element_count, other.element_count);
+  std::swap(first_leaf, other.first_leaf);
+  std::swap(last_leaf, other.last_leaf);
+}
+
 MapImplementation::MapImplementation(const literals::map& map) { for(auto& element : map) insert(std::move(element.getKey()), element.getVariable().move()); }
 
-MapImplementation::MapImplementation(const MapImplementation& other) : storage(other.storage) {}
+MapImplementation::MapImplementation(const MapImplementation& other) : height(other.height), element_count(other.element_count) {
+  if(other.root) root = copyNode(other.root, height);
+}
 
-MapImplementation::MapImplementation(MapImplementation&& other) : storage(std::move(other.storage)) {}
+MapImplementation::MapImplementation(MapImplementation&& other)
+  : root(other.root), height(other.height), element_count(other.element_count),
+    first_leaf(other.first_leaf), last_leaf(other.last_leaf), element_pool(std::move(other.element_pool)) {
+  other.root = nullptr;
+  other.height = 0;
+  other.element_count = 0;
+  other.first_leaf = other.last_leaf = nullptr;
+}
 
 MapImplementation::~MapImplementation() { clear(); }
 
-bool MapImplementation::isEmpty() const noexcept {return !storage.size();}
+bool MapImplementation::isEmpty() const noexcept {return !element_count;}
 
-size_t MapImplementation::getSize() const noexcept {return storage.size();}
+size_t MapImplementation::getSize() const noexcept {return element_count;}
 
-bool MapImplementation::contains(KeyValue value) const noexcept {return storage.contains(value);}
+bool MapImplementation::contains(KeyValue value) const noexcept {return findElement(value).leaf;}
 
 err::ProgressReport<MapImplementation::NamedVariable> MapImplementation::insert(KeyValue key, Variable variable) {
-  auto insert_result = storage.emplace(std::move(key), variable.move());
-  if(insert_result.second) return MapImplementation::NamedVariable(*insert_result.first);
-  return err::ErrorType::binom_key_unique_error;
+  Path path;
+  const Position position = descend(path, key);
+  if(isKeyAt(position, key)) return err::ErrorType::binom_key_unique_error;
+  Element* element = createElement(key, variable);
+  insertElement(path, position, element);
+  return getNamedVariable(element);
+}
+
+err::ProgressReport<MapImplementation::NamedVariable> MapImplementation::insert(ConstIterator hint, KeyValue key, Variable variable) {
+  if(hint != cend() || !last_leaf || last_leaf->getKey(last_leaf->element_count - 1).getCompare(key) != KeyValue::lower)
+    return insert(std::move(key), variable.move());
+  // Key goes after last element, path to it is rightmost without key comparisons
+  Path path;
+  Node* node = root;
+  for(size_t depth = 0; depth < height; ++depth) {
+    InnerNode* inner = static_cast<InnerNode*>(node);
+    path.nodes[depth] = inner;
+    path.child_indexes[depth] = inner->child_count - 1;
+    node = inner->children[inner->child_count - 1];
+  }
+  Element* element = createElement(key, variable);
+  insertElement(path, Position{last_leaf, last_leaf->element_count}, element);
+  return getNamedVariable(element);
 }
 
 binom::err::Error MapImplementation::remove(KeyValue key) {
-  if(storage.erase(std::move(key))) return ErrorType::no_error;
-  else return ErrorType::binom_out_of_range;
+  Path path;
+  const Position position = descend(path, key);
+  if(!isKeyAt(position, key)) return ErrorType::binom_out_of_range;
+  destroyElement(removeElement(path, position));
+  return ErrorType::no_error;
 }
 
 err::ProgressReport<MapImplementation::NamedVariable> MapImplementation::rename(KeyValue old_key, KeyValue new_key) {
-  auto element = storage.extract(old_key);
-  if(element.empty()) return ErrorType::binom_out_of_range;
-  element.key() = new_key;
-  auto insert_result = storage.insert(std::move(element));
-  if(insert_result.inserted) return NamedVariable(*insert_result.position);
-  insert_result.node.key() = old_key;
-  insert_result = storage.insert(std::move(insert_result.node));
-  if(insert_result.inserted) return {ErrorType::binom_key_unique_error, NamedVariable(*insert_result.position)};
-  return ErrorType::binom_key_unique_error;
+  Path path;
+  const Position old_position = descend(path, old_key);
+  if(!isKeyAt(old_position, old_key)) return ErrorType::binom_out_of_range;
+  Element* element = old_position.getElement();
+  if(old_key.getCompare(new_key) == KeyValue::equal) return getNamedVariable(element);
+  if(findElement(new_key).leaf) return {ErrorType::binom_key_unique_error, getNamedVariable(element)};
+  // Element is relinked under new key, so its variable stays in place
+  removeElement(path, old_position);
+  element->key = std::move(new_key);
+  insertElement(path, descend(path, element->key), element);
+  return getNamedVariable(element);
 }
 
 MapImplementation::NamedVariable MapImplementation::getOrInsertNamedVariable(KeyValue key) {
-  auto it = storage.find(key);
-  if(it == storage.cend())
-    return *storage.emplace(std::move(key), nullptr).first;
-  return *it;
+  Path path;
+  const Position position = descend(path, key);
+  if(isKeyAt(position, key)) return getNamedVariable(position.getElement());
+  Variable variable = nullptr;
+  Element* element = createElement(key, variable);
+  insertElement(path, position, element);
+  return getNamedVariable(element);
 }
 
 binom::Variable MapImplementation::getVariable(KeyValue key) const {
-  auto it = storage.find(key);
-  if(it == storage.cend())
-    return nullptr;
-  return it->second.move();
+  const Position position = findElement(key);
+  if(!position.leaf) return nullptr;
+  return position.getElement()->variable.move();
+}
+
+MapImplementation::Iterator MapImplementation::find(KeyValue key) {
+  const Position position = findElement(key);
+  return Iterator(position.getElement(), position.index);
+}
+
+MapImplementation::ReverseIterator MapImplementation::rfind(KeyValue key) {
+  const Position position = findElement(key);
+  return ReverseIterator(position.getElement(), position.index);
 }
 
-MapImplementation::Iterator MapImplementation::find(KeyValue key) {return storage.find(std::move(key));}
+MapImplementation::ConstIterator MapImplementation::find(KeyValue key) const {
+  const Position position = findElement(key);
+  return ConstIterator(position.getElement(), position.index);
+}
 
-MapImplementation::ReverseIterator MapImplementation::rfind(KeyValue key) {return std::reverse_iterator(storage.find(std::move(key)));}
+MapImplementation::ConstReverseIterator MapImplementation::rfind(KeyValue key) const {
+  const Position position = findElement(key);
+  return ConstReverseIterator(position.getElement(), position.index);
+}
 
-MapImplementation::ConstIterator MapImplementation::find(KeyValue key) const {return storage.find(std::move(key));}
+MapImplementation::Iterator MapImplementation::select(size_t index) const noexcept {
+  if(index >= element_count) return Iterator();
+  Node* node = root;
+  for(size_t level = height; level; --level) {
+    InnerNode* inner = static_cast<InnerNode*>(node);
+    size_t child_index = 0;
+    for(; index >= inner->child_sizes[child_index]; ++child_index) index -= inner->child_sizes[child_index];
+    node = inner->children[child_index];
+  }
+  return Iterator(static_cast<Leaf*>(node)->elements[index], index);
+}
 
-MapImplementation::ConstReverseIterator MapImplementation::rfind(KeyValue key) const {return std::reverse_iterator(storage.find(std::move(key)));}
+size_t MapImplementation::rank(KeyValue key) const noexcept {
+  if(!root) return 0;
+  size_t result = 0;
+  Node* node = root;
+  for(size_t level = height; level; --level) {
+    InnerNode* inner = static_cast<InnerNode*>(node);
+    const size_t child_index = upperBound(inner->getKeys(), inner->child_count - 1, key);
+    for(size_t i = 0; i < child_index; ++i) result += inner->child_sizes[i];
+    node = inner->children[child_index];
+  }
+  Leaf* leaf = static_cast<Leaf*>(node);
+  return result + leaf->lowerBound(key);
+}
 
-void MapImplementation::clear() {storage.clear();}
+size_t MapImplementation::countRange(KeyValue first, KeyValue last) const noexcept {
+  const size_t first_rank = rank(std::move(first)), last_rank = rank(std::move(last));
+  return last_rank > first_rank ? last_rank - first_rank : 0;
+}
 
-MapImplementation::Iterator MapImplementation::begin() noexcept {return storage.begin();}
+void MapImplementation::split(KeyValue key, MapImplementation& upper) {
+  upper.clear();
+  if(!root || &upper == this) return;
+  splitTree(key, upper);
+  // Elements of both parts stay in slabs of this map, which are shared with upper one
+  element_pool.share(upper.element_pool);
+  shrinkToFit();
+}
 
-MapImplementation::Iterator MapImplementation::end() noexcept {return storage.end();}
+binom::err::Error MapImplementation::join(MapImplementation& other) {
+  if(&other == this) return isEmpty() ? ErrorType::no_error : ErrorType::invalid_data;
+  if(!other.root) return ErrorType::no_error;
+  element_pool.reserveMerge(other.element_pool);
+  if(root && last_leaf->getKey(last_leaf->element_count - 1).getCompare(other.first_leaf->getKey(0)) != KeyValue::lower) {
+    if(other.last_leaf->getKey(other.last_leaf->element_count - 1).getCompare(first_leaf->getKey(0)) != KeyValue::lower)
+      return ErrorType::invalid_data;
+    other.append(self);
+    swap(other);
+  } else append(other);
+  element_pool.merge(other.element_pool);
+  shrinkToFit();
+  return ErrorType::no_error;
+}
 
-MapImplementation::ReverseIterator MapImplementation::rbegin() noexcept {return storage.rbegin();}
+size_t MapImplementation::eraseRange(KeyValue first, KeyValue last) {
+  if(first.getCompare(last) != KeyValue::lower || !root) return 0;
+  MapImplementation middle, upper;
+  splitTree(first, middle);
+  if(middle.root) middle.splitTree(last, upper);
+  // Elements of middle map are in slabs of this one
+  const size_t count = middle.element_count;
+  for(Leaf* leaf = middle.first_leaf; leaf; leaf = leaf->next) {
+    for(size_t i = 0; i < leaf->element_count; ++i) destroyElement(leaf->elements[i]);
+    leaf->eraseAll();
+  }
+  middle.clear();
+  append(upper);
+  return count;
+}
 
-MapImplementation::ReverseIterator MapImplementation::rend() noexcept {return storage.rend();}
+void MapImplementation::shrinkToFit() {
+  // Slabs shared with alive maps are kept anyway, blocks of their elements are just unused by this map
+  if(!element_pool.hasReleasedShares() || element_count * 4 >= element_pool.getBlockCount()) return;
+  MapImplementation compacted;
+  Iterator it = begin();
+  // Keys are copied, so map is unchanged if rebuild throws
+  compacted.bulkLoad(element_count, [&it]() {
+    Element* element = it.element;
+    ++it;
+    return std::pair<KeyValue, Variable>(element->key, element->variable.move());
+  });
+  clear();
+  swap(compacted);
+  element_pool.swap(compacted.element_pool);
+}
+
+void MapImplementation::clear() {
+  for(Leaf* leaf = first_leaf; leaf; leaf = leaf->next)
+    for(size_t i = 0; i < leaf->element_count; ++i) leaf->elements[i]->~Element();
+  if(root) destroyNode(root, height);
+  root = nullptr;
+  height = 0;
+  element_count = 0;
+  first_leaf = last_leaf = nullptr;
+  // All elements are destroyed, so their slabs are freed at once
+  element_pool.release();
+}
+
+MapImplementation::Iterator MapImplementation::begin() noexcept {return first_leaf ? Iterator(first_leaf->elements[0], 0) : Iterator();}
+
+MapImplementation::Iterator MapImplementation::end() noexcept {return Iterator();}
+
+MapImplementation::ReverseIterator MapImplementation::rbegin() noexcept {
+  return last_leaf ? ReverseIterator(last_leaf->elements[last_leaf->element_count - 1], last_leaf->element_count - 1) : ReverseIterator();
+}
+
+MapImplementation::ReverseIterator MapImplementation::rend() noexcept {return ReverseIterator();}
 
 MapImplementation::ConstIterator MapImplementation::begin() const noexcept {return cbegin();}
 
@@ -82,70 +884,68 @@ MapImplementation::ConstReverseIterator MapImplementation::rbegin() const noexce
 
 MapImplementation::ConstReverseIterator MapImplementation::rend() const noexcept {return crend();}
 
-MapImplementation::ConstIterator MapImplementation::cbegin() const noexcept {return storage.cbegin();}
+MapImplementation::ConstIterator MapImplementation::cbegin() const noexcept {return first_leaf ? ConstIterator(first_leaf->elements[0], 0) : ConstIterator();}
 
-MapImplementation::ConstIterator MapImplementation::cend() const noexcept {return storage.cend();}
+MapImplementation::ConstIterator MapImplementation::cend() const noexcept {return ConstIterator();}
 
-MapImplementation::ConstReverseIterator MapImplementation::crbegin() const noexcept {return storage.crbegin();}
-
-MapImplementation::ConstReverseIterator MapImplementation::crend() const noexcept {return storage.crend();}
+MapImplementation::ConstReverseIterator MapImplementation::crbegin() const noexcept {
+  return last_leaf ? ConstReverseIterator(last_leaf->elements[last_leaf->element_count - 1], last_leaf->element_count - 1) : ConstReverseIterator();
+}
 
+MapImplementation::ConstReverseIterator MapImplementation::crend() const noexcept {return ConstReverseIterator();}
 
 
 
-MapImplementation::Iterator::Iterator(VariableMap::iterator map_it) : VariableMap::iterator(map_it) {}
 
-MapImplementation::Iterator::Iterator(const Iterator& other) : VariableMap::iterator(dynamic_cast<const VariableMap::iterator&>(other)) {}
+MapImplementation::Iterator& MapImplementation::Iterator::operator++() noexcept {stepForward(element, index); return self;}
 
-MapImplementation::Iterator::Iterator(Iterator&& other) : VariableMap::iterator(dynamic_cast<VariableMap::iterator&&>(other)) {}
+MapImplementation::Iterator MapImplementation::Iterator::operator++(int) noexcept {Iterator tmp = self; stepForward(element, index); return tmp;}
 
-MapImplementation::NamedVariable MapImplementation::Iterator::operator*() {return NamedVariable(*dynamic_cast<VariableMap::iterator&>(self));}
+MapImplementation::NamedVariable MapImplementation::Iterator::operator*() {return getNamedVariable(element);}
 
 pseudo_ptr::PseudoPointer<MapImplementation::NamedVariable> MapImplementation::Iterator::operator->() {return *self;}
 
-const MapImplementation::NamedVariable MapImplementation::Iterator::operator*() const {return *dynamic_cast<const VariableMap::iterator&>(self);}
+const MapImplementation::NamedVariable MapImplementation::Iterator::operator*() const {return getNamedVariable(element);}
 
 pseudo_ptr::PseudoPointer<const MapImplementation::NamedVariable> MapImplementation::Iterator::operator->() const {return *self;}
 
 
 
 
-MapImplementation::ReverseIterator::ReverseIterator(VariableMap::reverse_iterator map_rit) : VariableMap::reverse_iterator(map_rit) {}
-
-MapImplementation::ReverseIterator::ReverseIterator(const ReverseIterator& other) : VariableMap::reverse_iterator(dynamic_cast<const VariableMap::reverse_iterator&>(other)) {}
+MapImplementation::ReverseIterator& MapImplementation::ReverseIterator::operator++() noexcept {stepBackward(element, index); return self;}
 
-MapImplementation::ReverseIterator::ReverseIterator(ReverseIterator&& other) : VariableMap::reverse_iterator(dynamic_cast<VariableMap::reverse_iterator&&>(other)) {}
+MapImplementation::ReverseIterator MapImplementation::ReverseIterator::operator++(int) noexcept {ReverseIterator tmp = self; stepBackward(element, index); return tmp;}
 
-MapImplementation::NamedVariable MapImplementation::ReverseIterator::operator*() {return *dynamic_cast<VariableMap::reverse_iterator&>(self);}
+MapImplementation::NamedVariable MapImplementation::ReverseIterator::operator*() {return getNamedVariable(element);}
 
 pseudo_ptr::PseudoPointer<MapImplementation::NamedVariable> MapImplementation::ReverseIterator::operator->() {return *self;}
 
-const MapImplementation::NamedVariable MapImplementation::ReverseIterator::operator*() const {return *dynamic_cast<const VariableMap::reverse_iterator&>(self);}
+const MapImplementation::NamedVariable MapImplementation::ReverseIterator::operator*() const {return getNamedVariable(element);}
 
 pseudo_ptr::PseudoPointer<const MapImplementation::NamedVariable> MapImplementation::ReverseIterator::operator->() const {return *self;}
 
 
 
 
-MapImplementation::ConstIterator::ConstIterator(VariableMap::const_iterator map_it) : VariableMap::const_iterator(map_it) {}
+MapImplementation::ConstIterator& MapImplementation::ConstIterator::operator++() noexcept {stepForward(element, index); return self;}
 
-MapImplementation::ConstIterator::ConstIterator(const ConstIterator& other) : VariableMap::const_iterator(dynamic_cast<const VariableMap::const_iterator&>(other)) {}
+MapImplementation::ConstIterator MapImplementation::ConstIterator::operator++(int) noexcept {ConstIterator tmp = self; stepForward(element, index); return tmp;}
 
-MapImplementation::ConstIterator::ConstIterator(ConstIterator&& other) : VariableMap::const_iterator(dynamic_cast<VariableMap::const_iterator&&>(other)) {}
-
-const MapImplementation::NamedVariable MapImplementation::ConstIterator::operator*() const {return *dynamic_cast<const VariableMap::const_iterator&>(self);}
+const MapImplementation::NamedVariable MapImplementation::ConstIterator::operator*() const {return getNamedVariable(element);}
 
 pseudo_ptr::PseudoPointer<const MapImplementation::NamedVariable> MapImplementation::ConstIterator::operator->() const {return *self;}
 
+const KeyValue& MapImplementation::ConstIterator::getKey() const noexcept {return element->key;}
+
+const Variable& MapImplementation::ConstIterator::getVariable() const noexcept {return element->variable;}
 
 
 
-MapImplementation::ConstReverseIterator::ConstReverseIterator(VariableMap::const_reverse_iterator map_rit) : VariableMap::const_reverse_iterator(map_rit) {}
 
-MapImplementation::ConstReverseIterator::ConstReverseIterator(const ConstReverseIterator& other) : VariableMap::const_reverse_iterator(dynamic_cast<const VariableMap::const_reverse_iterator&>(other)) {}
+MapImplementation::ConstReverseIterator& MapImplementation::ConstReverseIterator::operator++() noexcept {stepBackward(element, index); return self;}
 
-MapImplementation::ConstReverseIterator::ConstReverseIterator(ConstReverseIterator&& other) : VariableMap::const_reverse_iterator(dynamic_cast<VariableMap::const_reverse_iterator&&>(other)) {}
+MapImplementation::ConstReverseIterator MapImplementation::ConstReverseIterator::operator++(int) noexcept {ConstReverseIterator tmp = self; stepBackward(element, index); return tmp;}
 
-const MapImplementation::NamedVariable MapImplementation::ConstReverseIterator::operator*() const {return *dynamic_cast<const VariableMap::const_reverse_iterator&>(self);}
+const MapImplementation::NamedVariable MapImplementation::ConstReverseIterator::operator*() const {return getNamedVariable(element);}
 
-pseudo_ptr::PseudoPointer<const MapImplementation::NamedVariable> MapImplementation::ConstReverseIterator::operator->() const {return *self;}
\ No newline at end of file
+pseudo_ptr::PseudoPointer<const MapImplementation::NamedVariable> MapImplementation::ConstReverseIterator::operator->() const {return *self;}
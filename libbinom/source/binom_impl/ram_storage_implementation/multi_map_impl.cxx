@@ -6,144 +6,248 @@ using namespace binom;
 using namespace binom::priv;
 using namespace binom::literals;
 
-MultiMapImplementation::Iterator::Iterator(VariableMultiMap::iterator map_it) : VariableMultiMap::iterator(map_it) {}
+MultiMapImplementation::NamedVariable MultiMapImplementation::getNamedVariable(const MultiAVLTree::Iterator& it) noexcept {
+  return NamedVariable(it.getKey(), const_cast<Element&>(static_cast<const Element&>(*it)).variable);
+}
+
+MultiMapImplementation::NamedVariable MultiMapImplementation::getNamedVariable(const MultiAVLTree::ReverseIterator& it) noexcept {
+  return NamedVariable(it.getKey(), const_cast<Element&>(static_cast<const Element&>(*it)).variable);
+}
+
+MultiMapImplementation::Iterator& MultiMapImplementation::Iterator::operator++() {++iterator; return self;}
+
+MultiMapImplementation::Iterator MultiMapImplementation::Iterator::operator++(int) {Iterator tmp(self); ++self; return tmp;}
 
-MultiMapImplementation::Iterator::Iterator(const Iterator& other) : VariableMultiMap::iterator(other) {}
+MultiMapImplementation::Iterator& MultiMapImplementation::Iterator::operator--() {--iterator; return self;}
 
-MultiMapImplementation::Iterator::Iterator(Iterator&& other) : VariableMultiMap::iterator(std::move(other)) {}
+MultiMapImplementation::Iterator MultiMapImplementation::Iterator::operator--(int) {Iterator tmp(self); --self; return tmp;}
 
-MultiMapImplementation::NamedVariable MultiMapImplementation::Iterator::operator*() {return NamedVariable(*dynamic_cast<VariableMultiMap::iterator&>(self));}
+MultiMapImplementation::NamedVariable MultiMapImplementation::Iterator::operator*() {return getNamedVariable(iterator);}
 
 pseudo_ptr::PseudoPointer<MultiMapImplementation::NamedVariable> MultiMapImplementation::Iterator::operator->() {return *self;}
 
-const MultiMapImplementation::NamedVariable MultiMapImplementation::Iterator::operator*() const {return NamedVariable(*dynamic_cast<const VariableMultiMap::iterator&>(self));}
+const MultiMapImplementation::NamedVariable MultiMapImplementation::Iterator::operator*() const {return getNamedVariable(iterator);}
 
 pseudo_ptr::PseudoPointer<const MultiMapImplementation::NamedVariable> MultiMapImplementation::Iterator::operator->() const {return *self;}
 
-MultiMapImplementation::Iterator MultiMapImplementation::Iterator::nullit() noexcept {return  VariableMultiMap::iterator(nullptr);}
+MultiMapImplementation::Iterator MultiMapImplementation::Iterator::nullit() noexcept {return MultiAVLTree::Iterator(nullptr);}
 
 
 
-MultiMapImplementation::ReverseIterator::ReverseIterator(VariableMultiMap::reverse_iterator map_it) : VariableMultiMap::reverse_iterator(map_it) {}
+MultiMapImplementation::ReverseIterator& MultiMapImplementation::ReverseIterator::operator++() {++iterator; return self;}
 
-MultiMapImplementation::ReverseIterator::ReverseIterator(const ReverseIterator& other) : VariableMultiMap::reverse_iterator(other) {}
+MultiMapImplementation::ReverseIterator MultiMapImplementation::ReverseIterator::operator++(int) {ReverseIterator tmp(self); ++self; return tmp;}
 
-MultiMapImplementation::ReverseIterator::ReverseIterator(ReverseIterator&& other) : VariableMultiMap::reverse_iterator(std::move(other)) {}
+MultiMapImplementation::ReverseIterator& MultiMapImplementation::ReverseIterator::operator--() {--iterator; return self;}
 
-MultiMapImplementation::NamedVariable MultiMapImplementation::ReverseIterator::operator*() {return NamedVariable(*dynamic_cast<VariableMultiMap::reverse_iterator&>(self));}
+MultiMapImplementation::ReverseIterator MultiMapImplementation::ReverseIterator::operator--(int) {ReverseIterator tmp(self); --self; return tmp;}
+
+MultiMapImplementation::NamedVariable MultiMapImplementation::ReverseIterator::operator*() {return getNamedVariable(iterator);}
 
 pseudo_ptr::PseudoPointer<MultiMapImplementation::NamedVariable> MultiMapImplementation::ReverseIterator::operator->() {return *self;}
 
-const MultiMapImplementation::NamedVariable MultiMapImplementation::ReverseIterator::operator*() const {return NamedVariable(*dynamic_cast<const VariableMultiMap::reverse_iterator&>(self));}
+const MultiMapImplementation::NamedVariable MultiMapImplementation::ReverseIterator::operator*() const {return getNamedVariable(iterator);}
 
 pseudo_ptr::PseudoPointer<const MultiMapImplementation::NamedVariable> MultiMapImplementation::ReverseIterator::operator->() const {return *self;}
 
-MultiMapImplementation::ReverseIterator MultiMapImplementation::ReverseIterator::nullit() noexcept {return  VariableMultiMap::reverse_iterator(Iterator::nullit());}
+MultiMapImplementation::ReverseIterator MultiMapImplementation::ReverseIterator::nullit() noexcept {return MultiAVLTree::ReverseIterator(nullptr);}
+
 
 
+MultiMapImplementation::ConstIterator& MultiMapImplementation::ConstIterator::operator++() {++iterator; return self;}
 
-MultiMapImplementation::ConstIterator::ConstIterator(VariableMultiMap::const_iterator map_it) : VariableMultiMap::const_iterator(map_it) {}
+MultiMapImplementation::ConstIterator MultiMapImplementation::ConstIterator::operator++(int) {ConstIterator tmp(self); ++self; return tmp;}
 
-MultiMapImplementation::ConstIterator::ConstIterator(const ConstIterator& other) : VariableMultiMap::const_iterator(other) {}
+MultiMapImplementation::ConstIterator& MultiMapImplementation::ConstIterator::operator--() {--iterator; return self;}
 
-MultiMapImplementation::ConstIterator::ConstIterator(ConstIterator&& other) : VariableMultiMap::const_iterator(std::move(other)) {}
+MultiMapImplementation::ConstIterator MultiMapImplementation::ConstIterator::operator--(int) {ConstIterator tmp(self); --self; return tmp;}
 
-const MultiMapImplementation::NamedVariable MultiMapImplementation::ConstIterator::operator*() const {return NamedVariable(*dynamic_cast<const VariableMultiMap::const_iterator&>(self));}
+const MultiMapImplementation::NamedVariable MultiMapImplementation::ConstIterator::operator*() const {return getNamedVariable(iterator);}
 
 pseudo_ptr::PseudoPointer<const MultiMapImplementation::NamedVariable> MultiMapImplementation::ConstIterator::operator->() const {return *self;}
 
-MultiMapImplementation::ConstIterator MultiMapImplementation::ConstIterator::nullit() noexcept {return  VariableMultiMap::const_iterator(nullptr);}
+const KeyValue& MultiMapImplementation::ConstIterator::getKey() const noexcept {return iterator.getKey();}
+
+const Variable& MultiMapImplementation::ConstIterator::getVariable() const noexcept {return static_cast<const Element&>(*iterator).variable;}
+
+MultiMapImplementation::ConstIterator MultiMapImplementation::ConstIterator::nullit() noexcept {return MultiAVLTree::Iterator(nullptr);}
 
 
 
-MultiMapImplementation::ConstReverseIterator::ConstReverseIterator(VariableMultiMap::const_reverse_iterator map_it) : VariableMultiMap::const_reverse_iterator(map_it) {}
+MultiMapImplementation::ConstReverseIterator& MultiMapImplementation::ConstReverseIterator::operator++() {++iterator; return self;}
 
-MultiMapImplementation::ConstReverseIterator::ConstReverseIterator(const ConstReverseIterator& other) : VariableMultiMap::const_reverse_iterator(other) {}
+MultiMapImplementation::ConstReverseIterator MultiMapImplementation::ConstReverseIterator::operator++(int) {ConstReverseIterator tmp(self); ++self; return tmp;}
 
-MultiMapImplementation::ConstReverseIterator::ConstReverseIterator(ConstReverseIterator&& other) : VariableMultiMap::const_reverse_iterator(std::move(other)) {}
+MultiMapImplementation::ConstReverseIterator& MultiMapImplementation::ConstReverseIterator::operator--() {--iterator; return self;}
 
-const MultiMapImplementation::NamedVariable MultiMapImplementation::ConstReverseIterator::operator*() const {return NamedVariable(*dynamic_cast<const VariableMultiMap::const_reverse_iterator&>(self));}
+MultiMapImplementation::ConstReverseIterator MultiMapImplementation::ConstReverseIterator::operator--(int) {ConstReverseIterator tmp(self); --self; return tmp;}
+
+const MultiMapImplementation::NamedVariable MultiMapImplementation::ConstReverseIterator::operator*() const {return getNamedVariable(iterator);}
 
 pseudo_ptr::PseudoPointer<const MultiMapImplementation::NamedVariable> MultiMapImplementation::ConstReverseIterator::operator->() const {return *self;}
 
-MultiMapImplementation::ConstReverseIterator MultiMapImplementation::ConstReverseIterator::nullit() noexcept {return  VariableMultiMap::const_reverse_iterator(ConstIterator::nullit());}
+MultiMapImplementation::ConstReverseIterator MultiMapImplementation::ConstReverseIterator::nullit() noexcept {return MultiAVLTree::ReverseIterator(nullptr);}
+
+
+
+MultiMapImplementation::Element* MultiMapImplementation::createElement(Variable& variable) {
+  return new(element_pool.allocate()) Element(variable);
+}
 
+void MultiMapImplementation::destroyElement(MultiAVLTree::AVLNode* node) noexcept {
+  Element* element = static_cast<Element*>(node);
+  element->~Element();
+  element_pool.deallocate(element);
+}
 
+void MultiMapImplementation::abortBulkLoad(std::vector<MultiAVLTree::KeyNodePair>& elements) noexcept {
+  for(MultiAVLTree::KeyNodePair& element : elements)
+    if(element.node) destroyElement(element.node);
+}
 
 MultiMapImplementation::MultiMapImplementation(const literals::multimap& map, NewNodePosition pos) {
   for(auto& element : map) insert(std::move(element.getKeyRef()), element.getVariableRef().move(), pos);
 }
 
-MultiMapImplementation::MultiMapImplementation(const MultiMapImplementation& other) : storage(other.storage) {}
+MultiMapImplementation::MultiMapImplementation(const MultiMapImplementation& other) {
+  ConstIterator it = other.cbegin();
+  // Elements of other multimap are already in key order
+  bulkLoadChecked(other.getSize(), [&it]() {
+    std::pair<KeyValue, Variable> element(it.getKey(), it.getVariable());
+    ++it;
+    return element;
+  });
+}
+
+MultiMapImplementation::MultiMapImplementation(MultiMapImplementation&& other)
+  : storage(std::move(other.storage)), element_pool(std::move(other.element_pool)) {}
 
-MultiMapImplementation::MultiMapImplementation(MultiMapImplementation&& other) : storage(std::move(other.storage)) {}
+MultiMapImplementation::~MultiMapImplementation() {clear();}
 
-bool MultiMapImplementation::isEmpty() const noexcept {return storage.empty();}
+bool MultiMapImplementation::isEmpty() const noexcept {return storage.isEmpty();}
 
-size_t MultiMapImplementation::getSize() const noexcept {return storage.size();}
+size_t MultiMapImplementation::getSize() const noexcept {return storage.getSize();}
 
-bool MultiMapImplementation::contains(KeyValue key) const {return storage.contains(std::move(key));}
+bool MultiMapImplementation::contains(KeyValue key) const {return storage.find(std::move(key));}
 
 MultiMapImplementation::NamedVariable MultiMapImplementation::insert(KeyValue key, Variable variable, NewNodePosition position) {
-  switch (position) {
-  case binom::priv::MultiAVLTree::NewNodePosition::front: return *storage.emplace_hint(storage.lower_bound(key), key, variable);
-  default:
-  case binom::priv::MultiAVLTree::NewNodePosition::back: return *storage.emplace(key, variable);
-  }
+  Element* element = createElement(variable);
+  MultiAVLTree::NodePair node_pair = storage.insert(std::move(key), element, position);
+  return NamedVariable(MultiAVLTree::Iterator(node_pair.key_node).getKey(), element->variable);
 }
 
-void MultiMapImplementation::remove(Iterator it) {storage.erase(it);}
+void MultiMapImplementation::remove(Iterator it) {destroyElement(storage.extract(it.iterator));}
 
-void MultiMapImplementation::remove(ReverseIterator it) {storage.erase(VariableMultiMap::reverse_iterator(it).base());}
+void MultiMapImplementation::remove(ReverseIterator it) {destroyElement(storage.extract(it.iterator));}
 
-size_t MultiMapImplementation::removeAll(KeyValue key) {return storage.erase(std::move(key));}
+size_t MultiMapImplementation::removeAll(KeyValue key) {
+  MultiAVLTree::Iterator it = storage.find(key);
+  if(!it) return 0;
+  const size_t count = it.getElementCount();
+  storage.removeKey(std::move(key), [this](MultiAVLTree::AVLNode* node) {destroyElement(node);});
+  return count;
+}
 
 err::ProgressReport<MultiMapImplementation::NamedVariable> MultiMapImplementation::rename(Iterator it, KeyValue new_key) {
-
-  if(auto element = storage.extract(it); !element.empty()) {
-    element.key() = new_key;
-    return NamedVariable(*storage.insert(std::move(element)));
-  } else return ErrorType::binom_out_of_range;
-
+  if(it == end()) return ErrorType::binom_out_of_range;
+  // Element node is relinked to key node of new key, so its variable stays in place
+  Element* element = static_cast<Element*>(storage.extract(it.iterator));
+  MultiAVLTree::NodePair node_pair = storage.insert(std::move(new_key), element);
+  return NamedVariable(MultiAVLTree::Iterator(node_pair.key_node).getKey(), element->variable);
 }
 
 std::pair<MultiMapImplementation::Iterator, MultiMapImplementation::Iterator> MultiMapImplementation::getRange(KeyValue key) {
-  auto [first, second] = storage.equal_range(std::move(key));
-  return {first, second};
+  MultiAVLTree::Iterator first = storage.find(std::move(key));
+  MultiAVLTree::Iterator last = first;
+  return {first, last.goToNextKey()};
 }
 
 std::pair<MultiMapImplementation::ReverseIterator, MultiMapImplementation::ReverseIterator> MultiMapImplementation::getReverseRange(KeyValue key) {
-  auto [first, second] = storage.equal_range(std::move(key));
-  return {VariableMultiMap::reverse_iterator(--first), VariableMultiMap::reverse_iterator(--second)};
+  MultiAVLTree::ReverseIterator first = storage.rfindLast(std::move(key));
+  MultiAVLTree::ReverseIterator last = first;
+  return {first, last.goToNextKey()};
 }
 
 MultiMapImplementation::Iterator MultiMapImplementation::find(KeyValue key) {return storage.find(std::move(key));}
 
-MultiMapImplementation::ReverseIterator MultiMapImplementation::rfind(KeyValue key) {return VariableMultiMap::reverse_iterator(storage.find(std::move(key)));}
+MultiMapImplementation::ReverseIterator MultiMapImplementation::rfind(KeyValue key) {return storage.rfind(std::move(key));}
 
-MultiMapImplementation::Iterator MultiMapImplementation::findLast(KeyValue key) {return --storage.upper_bound(std::move(key));}
+MultiMapImplementation::Iterator MultiMapImplementation::findLast(KeyValue key) {return storage.findLast(std::move(key));}
 
-MultiMapImplementation::ReverseIterator MultiMapImplementation::rfindLast(KeyValue key) {return VariableMultiMap::reverse_iterator(--storage.upper_bound(std::move(key)));}
+MultiMapImplementation::ReverseIterator MultiMapImplementation::rfindLast(KeyValue key) {return storage.rfindLast(std::move(key));}
 
 std::pair<MultiMapImplementation::ConstIterator, MultiMapImplementation::ConstIterator> MultiMapImplementation::getRange(KeyValue key) const {
-  auto [first, second] = storage.equal_range(std::move(key));
-  return {first, second};
+  MultiAVLTree::Iterator first = storage.find(std::move(key));
+  MultiAVLTree::Iterator last = first;
+  return {first, last.goToNextKey()};
 }
 
 std::pair<MultiMapImplementation::ConstReverseIterator, MultiMapImplementation::ConstReverseIterator> MultiMapImplementation::getReverseRange(KeyValue key) const {
-  auto [first, second] = storage.equal_range(std::move(key));
-  return {VariableMultiMap::const_reverse_iterator(--first), VariableMultiMap::const_reverse_iterator(--second)};
+  MultiAVLTree::ReverseIterator first = storage.rfindLast(std::move(key));
+  MultiAVLTree::ReverseIterator last = first;
+  return {first, last.goToNextKey()};
 }
 
-MultiMapImplementation::ConstIterator MultiMapImplementation::find(KeyValue key) const  {return storage.find(std::move(key));}
+MultiMapImplementation::ConstIterator MultiMapImplementation::find(KeyValue key) const {return storage.find(std::move(key));}
+
+MultiMapImplementation::ConstReverseIterator MultiMapImplementation::rfind(KeyValue key) const {return storage.rfind(std::move(key));}
 
-MultiMapImplementation::ConstReverseIterator MultiMapImplementation::rfind(KeyValue key) const {return VariableMultiMap::const_reverse_iterator(storage.find(std::move(key)));}
+MultiMapImplementation::ConstIterator MultiMapImplementation::findLast(KeyValue key) const {return storage.findLast(std::move(key));}
 
-MultiMapImplementation::ConstIterator MultiMapImplementation::findLast(KeyValue key) const {return --storage.upper_bound(std::move(key));}
+MultiMapImplementation::ConstReverseIterator MultiMapImplementation::rfindLast(KeyValue key) const {return storage.rfindLast(std::move(key));}
 
-MultiMapImplementation::ConstReverseIterator MultiMapImplementation::rfindLast(KeyValue key) const {return VariableMultiMap::const_reverse_iterator(--storage.upper_bound(std::move(key)));}
+MultiMapImplementation::Iterator MultiMapImplementation::select(size_t index) {return storage.select(index);}
 
-void MultiMapImplementation::clear() {storage.clear();}
+MultiMapImplementation::ConstIterator MultiMapImplementation::select(size_t index) const {return storage.select(index);}
+
+size_t MultiMapImplementation::rank(KeyValue key) const {return storage.rank(std::move(key));}
+
+size_t MultiMapImplementation::countRange(KeyValue first, KeyValue last) const {return storage.countRange(std::move(first), std::move(last));}
+
+void MultiMapImplementation::split(KeyValue key, MultiMapImplementation& upper) {
+  if(&upper == this) return;
+  upper.clear();
+  MultiAVLTree upper_tree = storage.split(std::move(key));
+  upper.storage.join(upper_tree);
+  // Elements of both parts stay in slabs of this multimap, which are shared with upper one
+  element_pool.share(upper.element_pool);
+  shrinkToFit();
+}
+
+binom::err::Error MultiMapImplementation::join(MultiMapImplementation& other) {
+  if(&other == this) return isEmpty() ? ErrorType::no_error : ErrorType::invalid_data;
+  element_pool.reserveMerge(other.element_pool);
+  if(!storage.join(other.storage)) return ErrorType::invalid_data;
+  element_pool.merge(other.element_pool);
+  shrinkToFit();
+  return ErrorType::no_error;
+}
+
+size_t MultiMapImplementation::eraseRange(KeyValue first, KeyValue last) {
+  return storage.eraseRange(std::move(first), std::move(last), [this](MultiAVLTree::AVLNode* node) {destroyElement(node);});
+}
+
+void MultiMapImplementation::shrinkToFit() {
+  if(!element_pool.hasReleasedShares() || getSize() * 4 >= element_pool.getBlockCount()) return;
+  MultiMapImplementation compacted;
+  ConstIterator it = cbegin();
+  // Keys are copied and variables are linked, so multimap is unchanged if rebuild throws
+  compacted.bulkLoadChecked(getSize(), [&it]() {
+    std::pair<KeyValue, Variable> element(it.getKey(), const_cast<Variable&>(it.getVariable()).move());
+    ++it;
+    return element;
+  });
+  // Key nodes of rebuilt tree are in its own slabs too
+  clear();
+  storage.join(compacted.storage);
+  element_pool.swap(compacted.element_pool);
+}
+
+void MultiMapImplementation::clear() {
+  storage.clear([](MultiAVLTree::AVLNode* node) {static_cast<Element*>(node)->~Element();});
+  // All elements are destroyed, so their slabs are freed at once
+  element_pool.release();
+}
 
 MultiMapImplementation::Iterator MultiMapImplementation::begin() noexcept {return storage.begin();}
 
@@ -1,15 +1,165 @@
 #include "libbinom/include/binom_impl/resource_control.hxx"
 #include "libbinom/include/binom_impl/ram_storage_implementation.hxx"
+#include "libbinom/include/binom_impl/file_storage_implementation/mapped_file.hxx"
+
+#include <cstdint>
+#include <iterator>
+#include <mutex>
 
 using namespace binom;
 using namespace binom::priv;
 
+namespace {
+
+//! Serializes materialization of lazy resources, striped by resource address
+std::mutex& getMaterializationMutex(const SharedResource* resource) noexcept {
+  static std::mutex mutexes[64];
+  return mutexes[reinterpret_cast<std::uintptr_t>(resource) / alignof(SharedResource) % std::size(mutexes)];
+}
+
+//! Attempts of lock-free read before falling back to shared lock
+constexpr size_t optimistic_read_attempt_count = 64;
+
+//! Resource data is loaded by optimistic readers without lock, so writers store it atomically.
+//! Release publishes implementation to readers of clone source, see isReadableInPlace
+void storeData(ResourceData& resource_data, ResourceData::Data data) noexcept {
+  std::atomic_ref(resource_data.data.ui64_val).store(data.ui64_val, std::memory_order_release);
+}
+
+void storeResourceData(ResourceData& resource_data, ResourceData new_resource_data) noexcept {
+  std::atomic_ref(resource_data.type).store(new_resource_data.type, std::memory_order_relaxed);
+  storeData(resource_data, new_resource_data.data);
+}
+
+//! Buffers smaller than this are copied right away instead of lazy clone
+constexpr size_t lazy_clone_min_byte_size = 256;
+
+//! Set while implementation of clone is copied, its elements were already checked by Link::isExclusiveSubtree
+thread_local bool is_subtree_verified = false;
+
+class VerifiedSubtreeScope {
+  bool previous_state = is_subtree_verified;
+public:
+  VerifiedSubtreeScope() noexcept {is_subtree_verified = true;}
+  ~VerifiedSubtreeScope() {is_subtree_verified = previous_state;}
+};
+
+//! Clone source which mutex is held by this thread, copied level may contain pending clone of it
+thread_local const CloneSource* locked_clone_source = nullptr;
+
+class LockedCloneSourceScope {
+  const CloneSource* previous_source = locked_clone_source;
+public:
+  LockedCloneSourceScope(const CloneSource* clone_source) noexcept {locked_clone_source = clone_source;}
+  ~LockedCloneSourceScope() {locked_clone_source = previous_source;}
+};
+
+//! Copy of container implementation, elements are copied by Link::cloneResource
+ResourceData::Data copyImplementation(const ResourceData& resource_data) {
+  switch (toTypeClass(resource_data.type)) {
+  case VarTypeClass::null:
+  case VarTypeClass::number: return resource_data.data;
+  case VarTypeClass::bit_array: return {.bit_array_implementation = BitArrayImplementation::copy(resource_data.data.bit_array_implementation)};
+  case VarTypeClass::buffer_array: return {.buffer_array_storage = BufferArrayImplementation::copy(resource_data.data.buffer_array_storage)};
+  case VarTypeClass::array: return {.array_implementation = ArrayImplementation::copy(resource_data.data.array_implementation)};
+  case VarTypeClass::list: return {.list_implementation = new ListImplementation(*resource_data.data.list_implementation)};
+  case VarTypeClass::map: return {.map_implementation = new MapImplementation(*resource_data.data.map_implementation)};
+  case VarTypeClass::multimap: return {.multi_map_implementation = new MultiMapImplementation(*resource_data.data.multi_map_implementation)};
+  case VarTypeClass::hash_map: return {.hash_map_implementation = new HashMapImplementation(*resource_data.data.hash_map_implementation)};
+  // Tables can't be copied, as they can't be serialized
+  case VarTypeClass::table: throw err::Error(err::ErrorType::binom_invalid_type);
+  case VarTypeClass::invalid_type:
+  default: return {.pointer = nullptr};
+  }
+}
+
+//! Copying of small or empty containers is cheaper than lazy clone
+bool isCheapToCopy(const ResourceData& resource_data) noexcept {
+  switch (toTypeClass(resource_data.type)) {
+  case VarTypeClass::bit_array: return resource_data.data.bit_array_implementation->getByteSize() < lazy_clone_min_byte_size;
+  case VarTypeClass::buffer_array: return BufferArrayImplementation::getSize(resource_data.data.buffer_array_storage) < lazy_clone_min_byte_size;
+  case VarTypeClass::array: return !resource_data.data.array_implementation->getElementCount();
+  case VarTypeClass::list: return resource_data.data.list_implementation->isEmpty();
+  case VarTypeClass::map: return resource_data.data.map_implementation->isEmpty();
+  case VarTypeClass::multimap: return resource_data.data.multi_map_implementation->isEmpty();
+  case VarTypeClass::hash_map: return resource_data.data.hash_map_implementation->isEmpty();
+  default: return true;
+  }
+}
+
+//! Source of clones keeps its implementation until it's changed, clone without implementation has null data
+bool isReadableInPlace(SharedResource& resource) noexcept {
+  return !resource.clone_source.load(std::memory_order_acquire) ||
+         std::atomic_ref(resource.resource_data.data.ui64_val).load(std::memory_order_acquire);
+}
+
+//! Counts access which may change elements of container, see Link::isExclusiveSubtree
+void countElementAccess([[maybe_unused]] SharedResource& resource) noexcept {
+#ifndef BINOM_SINGLE_THREAD
+  resource.access_count.fetch_add(1, std::memory_order_acq_rel);
+#endif
+}
+
+void retireCloneSource(CloneSource* clone_source) {
+#ifdef BINOM_SINGLE_THREAD
+  delete clone_source;
+#else
+  // Other threads may still check clone source of resource while holding its lock
+  epoch_reclamation::retire(clone_source);
+#endif
+}
+
+}
+
+//////////////////////////////////////////////////////////// CloneSource ////////////////////////////////////////////////////////
+
+CloneSource::~CloneSource() {
+  // Snapshot which wasn't taken by last pending clone
+  if(snapshot.data.pointer) SharedResource{snapshot};
+}
+
 //////////////////////////////////////////////////////////// SharedResource ////////////////////////////////////////////////////////
 
 
 bool SharedResource::isExist() noexcept {return link_counter;}
 
 void SharedResource::destroy() {
+  if(MappedFile* file = mapped_file.exchange(nullptr)) {
+    resource_data.data.pointer = nullptr;
+    file->release();
+    return;
+  }
+
+  if(clone_source.load(std::memory_order_acquire)) {
+#ifndef BINOM_SINGLE_THREAD
+    epoch_reclamation::Guard guard;
+#endif
+    forever {
+      CloneSource* source = clone_source.load(std::memory_order_acquire);
+      if(!source) break;
+      std::unique_lock lk(source->mtx);
+      if(clone_source.load(std::memory_order_relaxed) != source) continue;
+      if(source->source == this) {
+        // Pending clones take implementation of destroyed source instead of its copy
+        if(source->pending_count) {
+          source->snapshot = resource_data;
+          resource_data.data.pointer = nullptr;
+        }
+        source->source = nullptr;
+      } else --source->pending_count;
+      clone_source.store(nullptr, std::memory_order_release);
+
+      const bool is_unused = !source->pending_count;
+      if(is_unused && source->source) {
+        source->source->clone_source.store(nullptr, std::memory_order_release);
+        source->source = nullptr;
+      }
+      lk.unlock();
+      if(is_unused) retireCloneSource(source);
+      break;
+    }
+  }
+
   switch (toTypeClass(resource_data.type)) {
   case VarTypeClass::null:
   case VarTypeClass::number: return;
@@ -22,7 +172,7 @@ void SharedResource::destroy() {
 
   case VarTypeClass::buffer_array:
     if(resource_data.data.pointer)
-      delete resource_data.data.buffer_array_implementation;
+      BufferArrayImplementation::destroy(resource_data.data.buffer_array_storage);
     resource_data.data.pointer = nullptr;
   return;
 
@@ -50,6 +200,12 @@ void SharedResource::destroy() {
     resource_data.data.pointer = nullptr;
   return;
 
+  case VarTypeClass::hash_map:
+    if(resource_data.data.pointer)
+      delete resource_data.data.hash_map_implementation;
+    resource_data.data.pointer = nullptr;
+  return;
+
   case VarTypeClass::table: return; // TODO
   case VarTypeClass::invalid_type: default:
   return;
@@ -58,6 +214,12 @@ void SharedResource::destroy() {
 
 SharedResource::SharedResource(ResourceData resource_data) : resource_data(resource_data) {}
 
+SharedResource::SharedResource(MappedFile* mapped_file, FileResourceIndex index)
+  : resource_data{index.type, {.ui64_val = index.index.offset}}, mapped_file(mapped_file) {mapped_file->acquire();}
+
+SharedResource::SharedResource(CloneSource* clone_source, VarType type)
+  : resource_data{type, {.pointer = nullptr}}, clone_source(clone_source) {}
+
 SharedResource::~SharedResource() {destroy();}
 
 
@@ -67,99 +229,250 @@ SharedResource::~SharedResource() {destroy();}
 
 Link::Link(ResourceData resource_data) noexcept : resource(new SharedResource(resource_data)) {}
 
+Link::Link(MappedFile* mapped_file, FileResourceIndex index) noexcept {
+  switch (toTypeClass(index.type)) {
+  case VarTypeClass::null:
+  case VarTypeClass::number:
+    resource = new SharedResource(ResourceData{index.type, {.ui64_val = index.index.ui64_val}});
+  return;
+  default:
+    resource = new SharedResource(mapped_file, index);
+  return;
+  }
+}
+
 Link::Link(Link&& other) noexcept : resource(other.resource) {other.resource = nullptr;}
 
-Link::Link(const Link& other) noexcept {
-  if(!other.resource) return;
-  if(auto lk = other.getLock(MtxLockType::shared_locked); lk) {
-    ++other.resource->link_counter;
-    resource = other.resource;
-  } else return;
+Link::Link(const Link& other) noexcept : resource(other.resource) {
+  // Resource is kept alive by other link
+  if(resource) resource->link_counter.fetch_add(1, std::memory_order_relaxed);
 }
 
 Link::~Link() {
   SharedResource* old_resource = resource;
   resource = nullptr;
-  if(old_resource) {
-    if(!--old_resource->link_counter) {
-      old_resource->mtx.lock();
-      old_resource->mtx.unlock();
-      delete old_resource;
-    }
+#ifdef BINOM_SINGLE_THREAD
+  if(old_resource && old_resource->link_counter.fetch_sub(1, std::memory_order_relaxed) == 1)
+    delete old_resource;
+#else
+  // Threads still holding lock of resource are pinned, so deletion is deferred until they unlock it
+  if(old_resource && old_resource->link_counter.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    epoch_reclamation::retire(old_resource);
+#endif
+}
+
+void Link::materialize() const {
+  // Source of clones is copied only before change, see getLock and getElementAccessLock
+  if(!isReadableInPlace(*resource)) materializeClone();
+  if(!resource->mapped_file.load(std::memory_order_acquire)) return;
+  MappedFile* file;
+  {
+    std::lock_guard lk(getMaterializationMutex(resource));
+    file = resource->mapped_file.load(std::memory_order_acquire);
+    if(!file) return;
+    Link materialized = file->materialize(FileResourceIndex{resource->resource_data.type, {.offset = resource->resource_data.data.ui64_val}});
+    storeData(resource->resource_data, materialized.resource->resource_data.data);
+    materialized.resource->resource_data.type = VarType::null; // Implementation is owned by this resource now
+    resource->mapped_file.store(nullptr, std::memory_order_release);
   }
+  file->release();
 }
 
-void Link::overwriteWithResourceCopy(ResourceData& resource_data) {
-  resource->destroy();
-  resource->resource_data.type = resource_data.type;
-  switch (toTypeClass(resource_data.type)) {
-  case VarTypeClass::null: return;
-  case VarTypeClass::number:
-    resource->resource_data.data.ui64_val = resource_data.data.ui64_val;
-  return;
+void Link::materializeClone() const {
+  if(!resource->clone_source.load(std::memory_order_seq_cst)) return;
+#ifndef BINOM_SINGLE_THREAD
+  epoch_reclamation::Guard guard;
+#endif
+  forever {
+    CloneSource* clone_source = resource->clone_source.load(std::memory_order_acquire);
+    if(!clone_source) return;
+    std::unique_lock lk(clone_source->mtx);
+    if(resource->clone_source.load(std::memory_order_relaxed) != clone_source) continue;
+    // Elements of copied level become lazy clones too, so only accessed path is copied
+    VerifiedSubtreeScope verified_scope;
+    LockedCloneSourceScope locked_scope(clone_source);
+
+    if(clone_source->source == resource) {
+      // Source is accessed and may be changed, pending clones keep its current state
+      if(clone_source->pending_count)
+        clone_source->snapshot = ResourceData{resource->resource_data.type, copyImplementation(resource->resource_data)};
+      clone_source->source = nullptr;
+    } else {
+      if(clone_source->source)
+        storeData(resource->resource_data, copyImplementation(clone_source->source->resource_data));
+      elif(clone_source->pending_count == 1) {
+        storeData(resource->resource_data, clone_source->snapshot.data);
+        clone_source->snapshot.data.pointer = nullptr;
+      } else storeData(resource->resource_data, copyImplementation(clone_source->snapshot));
+      --clone_source->pending_count;
+    }
+    resource->clone_source.store(nullptr, std::memory_order_release);
 
-  case VarTypeClass::bit_array:
-    resource->resource_data.data.bit_array_implementation = BitArrayImplementation::copy(resource_data.data.bit_array_implementation);
-  return;
+    const bool is_unused = !clone_source->pending_count;
+    if(is_unused && clone_source->source) {
+      clone_source->source->clone_source.store(nullptr, std::memory_order_release);
+      clone_source->source = nullptr;
+    }
+    lk.unlock();
+    if(is_unused) retireCloneSource(clone_source);
+    return;
+  }
+}
 
-  case VarTypeClass::buffer_array:
-    resource->resource_data.data.buffer_array_implementation = BufferArrayImplementation::copy(resource_data.data.buffer_array_implementation);
-  return;
+Link Link::cloneLazy() const {
+  const VarType type = resource->resource_data.type;
+#ifndef BINOM_SINGLE_THREAD
+  epoch_reclamation::Guard guard;
+#endif
+  forever {
+    CloneSource* clone_source = resource->clone_source.load(std::memory_order_acquire);
+    if(!clone_source) {
+      CloneSource* new_clone_source = new CloneSource(resource);
+      new_clone_source->pending_count = 1;
+      // Ordered with setting of SharedResource::has_element_references, see Link::getElementAccessLock
+      if(resource->clone_source.compare_exchange_strong(clone_source, new_clone_source, std::memory_order_seq_cst))
+        return Link(new SharedResource(new_clone_source, type));
+      delete new_clone_source;
+    }
+    // Container which contains its own pending clone is copied under lock already
+    if(clone_source == locked_clone_source) {
+      ++clone_source->pending_count;
+      return Link(new SharedResource(clone_source, type));
+    }
+    // Resource is source or pending clone itself, new clone shares its implementation
+    std::lock_guard lk(clone_source->mtx);
+    if(resource->clone_source.load(std::memory_order_relaxed) != clone_source) continue;
+    ++clone_source->pending_count;
+    return Link(new SharedResource(clone_source, type));
+  }
+}
+
+bool Link::isExclusiveSubtree(const ResourceData& resource_data) noexcept {
+  auto isExclusive = [](const Variable& element) {
+    SharedResource* element_resource = element.resource_link.resource;
+    if(!element_resource) return true;
+    if(element_resource->link_counter.load(std::memory_order_acquire) != 1) return false;
+    if(element_resource->has_element_references.load(std::memory_order_acquire)) return false;
+    // Not materialized elements don't need check of their own elements
+    if(element_resource->mapped_file.load(std::memory_order_acquire) ||
+       element_resource->clone_source.load(std::memory_order_acquire)) return true;
+#ifdef BINOM_SINGLE_THREAD
+    return isExclusiveSubtree(element_resource->resource_data);
+#else
+    // Elements of container which wasn't changed and didn't give out elements since its check couldn't get new links
+    const ui64 access_count = element_resource->access_count.load(std::memory_order_acquire);
+    if(element_resource->exclusive_access_count.load(std::memory_order_acquire) == access_count) return true;
+    if(!isExclusiveSubtree(element_resource->resource_data)) return false;
+    element_resource->exclusive_access_count.store(access_count, std::memory_order_release);
+    return true;
+#endif
+  };
 
+  switch (toTypeClass(resource_data.type)) {
   case VarTypeClass::array:
-    resource->resource_data.data.array_implementation = ArrayImplementation::copy(resource_data.data.array_implementation);
-  return;
+    for(const Variable& element : *resource_data.data.array_implementation)
+      if(!isExclusive(element)) return false;
+  return true;
 
   case VarTypeClass::list:
-    resource->resource_data.data.list_implementation = new ListImplementation(*resource_data.data.list_implementation);
-  return;
+    for(const Variable& element : *resource_data.data.list_implementation)
+      if(!isExclusive(element)) return false;
+  return true;
 
   case VarTypeClass::map:
-    resource->resource_data.data.map_implementation = new MapImplementation(*resource_data.data.map_implementation);
-  return;
+    for(MapImplementation::ConstIterator it = resource_data.data.map_implementation->cbegin(),
+        end = resource_data.data.map_implementation->cend(); it != end; ++it)
+      if(!isExclusive(it.getVariable())) return false;
+  return true;
 
   case VarTypeClass::multimap:
-    resource->resource_data.data.multi_map_implementation = new MultiMapImplementation(*resource_data.data.multi_map_implementation);
-  return;
-
-  case VarTypeClass::table: // TODO
-  case VarTypeClass::invalid_type:
-  default:
-  break;
+    for(MultiMapImplementation::ConstIterator it = resource_data.data.multi_map_implementation->cbegin(),
+        end = resource_data.data.multi_map_implementation->cend(); it != end; ++it)
+      if(!isExclusive(it.getVariable())) return false;
+  return true;
+
+  case VarTypeClass::hash_map:
+    for(HashMapImplementation::ConstIterator it = resource_data.data.hash_map_implementation->cbegin(),
+        end = resource_data.data.hash_map_implementation->cend(); it != end; ++it)
+      if(!isExclusive(it.getVariable())) return false;
+  return true;
+
+  default: return true;
   }
-  resource->resource_data.type = VarType::null;
+}
+
+void Link::overwriteWithResourceCopy(const Link& other) {
+  Link copy = cloneResource(other);
+  resource->destroy();
+  // Resource of this link is referenced by other links, so it takes over state of copy
+  storeResourceData(resource->resource_data, copy.resource->resource_data);
+  copy.resource->resource_data = ResourceData{VarType::null, {.pointer = nullptr}};
+  resource->mapped_file.store(copy.resource->mapped_file.exchange(nullptr), std::memory_order_release);
+  resource->clone_source.store(copy.resource->clone_source.exchange(nullptr), std::memory_order_release);
 }
 
 Link Link::cloneResource(Link resource_link) noexcept {
+  if(resource_link.resource && resource_link.resource->mapped_file.load(std::memory_order_acquire)) {
+    // Clone of not materialized node is another lazy link to it
+    std::lock_guard lk(getMaterializationMutex(resource_link.resource));
+    if(MappedFile* file = resource_link.resource->mapped_file.load(std::memory_order_acquire))
+      return Link(file, FileResourceIndex{resource_link.resource->resource_data.type, {.offset = resource_link.resource->resource_data.data.ui64_val}});
+  }
+
   switch (toTypeClass(resource_link.getType())) {
   case VarTypeClass::null:
   case VarTypeClass::number:
   return **resource_link;
 
   case VarTypeClass::bit_array:
-  return ResourceData{VarType::bit_array, {.bit_array_implementation = BitArrayImplementation::copy(resource_link->data.bit_array_implementation)}};
-
   case VarTypeClass::buffer_array:
-  return ResourceData{resource_link.getType(), {.buffer_array_implementation = BufferArrayImplementation::copy(resource_link->data.buffer_array_implementation)}};
-
   case VarTypeClass::array:
-  return ResourceData{VarType::array, {.array_implementation = ArrayImplementation::copy(resource_link->data.array_implementation)}};
-
   case VarTypeClass::list:
-  return ResourceData{VarType::list, {.list_implementation = new ListImplementation(*resource_link->data.list_implementation)}};
-
   case VarTypeClass::map:
-  return ResourceData{VarType::map, {.map_implementation = new MapImplementation(*resource_link->data.map_implementation)}};
-
   case VarTypeClass::multimap:
-  return ResourceData{VarType::map, {.multi_map_implementation = new MultiMapImplementation(*resource_link->data.multi_map_implementation)}};
+  case VarTypeClass::hash_map:
+  break;
 
   case VarTypeClass::table: // TODO
   case VarTypeClass::invalid_type:
   default:
-  break;
-  }
   return ResourceData{VarType::null, {.pointer = nullptr}};
+  }
+
+  // Element of container copied for clone, container was checked when clone was created
+  if(is_subtree_verified) return resource_link.cloneLazy();
+
+  auto lk = resource_link.getLock(MtxLockType::shared_locked);
+  if(!lk) return ResourceData{VarType::null, {.pointer = nullptr}};
+  SharedResource& resource = *resource_link.resource;
+  auto cloneLazy = [&resource_link, &resource]() {
+    Link clone = resource_link.cloneLazy();
+    // References to elements may be given out meanwhile under shared lock of container,
+    // then clone takes its copy before they change it
+    if(resource.has_element_references.load(std::memory_order_seq_cst)) clone.materializeClone();
+    return clone;
+  };
+  // Source and pending clones share implementation which isn't changed until they are accessed
+  if(resource.clone_source.load(std::memory_order_acquire)) return cloneLazy();
+
+  // Elements referenced by other variables or by references and iterators may be changed bypassing container,
+  // such change must not appear in clone, so container is copied right away
+  if(isCheapToCopy(resource.resource_data) || resource.has_element_references.load(std::memory_order_seq_cst))
+    return ResourceData{resource.resource_data.type, copyImplementation(resource.resource_data)};
+#ifdef BINOM_SINGLE_THREAD
+  if(!isExclusiveSubtree(resource.resource_data))
+    return ResourceData{resource.resource_data.type, copyImplementation(resource.resource_data)};
+#else
+  // Container which wasn't changed and didn't give out elements since its last check keeps exclusive elements,
+  // so clones of untouched template don't walk it again
+  const ui64 access_count = resource.access_count.load(std::memory_order_acquire);
+  if(resource.exclusive_access_count.load(std::memory_order_acquire) != access_count) {
+    if(!isExclusiveSubtree(resource.resource_data))
+      return ResourceData{resource.resource_data.type, copyImplementation(resource.resource_data)};
+    resource.exclusive_access_count.store(access_count, std::memory_order_release);
+  }
+#endif
+  return cloneLazy();
 }
 
 ui64 Link::getLinkCount() const noexcept {
@@ -168,26 +481,89 @@ ui64 Link::getLinkCount() const noexcept {
   else return 0;
 }
 
+bool Link::isCloneShared() const noexcept {
+  return resource && resource->clone_source.load(std::memory_order_acquire);
+}
+
 OptionalSharedRecursiveLock Link::getLock(MtxLockType lock_type) const noexcept {
   if(!resource) return OptionalSharedRecursiveLock();
   if(!resource->isExist()) return OptionalSharedRecursiveLock();
-  return OptionalSharedRecursiveLock(SharedRecursiveLock(&resource->mtx, lock_type));
+#ifdef BINOM_SINGLE_THREAD
+  OptionalSharedRecursiveLock lk(nullptr, lock_type);
+#else
+  OptionalSharedRecursiveLock lk(SharedRecursiveLock(&resource->mtx, &resource->version, lock_type));
+#endif
+  // Corrupted node is reported unavailable rather than read as empty container
+  if(resource->mapped_file.load(std::memory_order_acquire))
+    try { materialize(); } catch(...) { return OptionalSharedRecursiveLock(); }
+  if(lock_type == MtxLockType::unique_locked) {
+    // References and iterators given out before are invalidated by change
+    resource->has_element_references.store(false, std::memory_order_relaxed);
+    countElementAccess(*resource);
+    // Copy for pending clones may fail to allocate, then resource is reported unavailable
+    try { materializeClone(); } catch(...) { return OptionalSharedRecursiveLock(); }
+  }
+  return lk;
+}
+
+OptionalSharedRecursiveLock Link::getElementLinkLock() const noexcept {
+  auto lk = getLock(MtxLockType::shared_locked);
+  if(!lk) return lk;
+  countElementAccess(*resource);
+  try { materializeClone(); } catch(...) { return OptionalSharedRecursiveLock(); }
+  return lk;
+}
+
+OptionalSharedRecursiveLock Link::getElementAccessLock() const noexcept {
+  auto lk = getLock(MtxLockType::shared_locked);
+  if(!lk) return lk;
+  // Set before pending clones are detached, clone created concurrently checks it after attach, see cloneResource
+  resource->has_element_references.store(true, std::memory_order_seq_cst);
+  countElementAccess(*resource);
+  try { materializeClone(); } catch(...) { return OptionalSharedRecursiveLock(); }
+  return lk;
 }
 
 ResourceData* Link::operator*() const noexcept {
-  if(auto lk = getLock(MtxLockType::shared_locked); lk)
+  if(auto lk = getLock(MtxLockType::shared_locked); lk) {
+    // Resource which can't be materialized is reported unavailable like destroyed one
+    try { materialize(); } catch(...) { return nullptr; }
     return &resource->resource_data;
-  else return nullptr;
+  } else return nullptr;
 }
 
 ResourceData* Link::operator->() const noexcept {
-  if(auto lk = getLock(MtxLockType::shared_locked); lk)
+  if(auto lk = getLock(MtxLockType::shared_locked); lk) {
+    // Resource which can't be materialized is reported unavailable like destroyed one
+    try { materialize(); } catch(...) { return nullptr; }
     return &resource->resource_data;
-  else return nullptr;
+  } else return nullptr;
 }
 
 VarType Link::getType() const noexcept {
+  // Type is single byte and can't be torn, so it doesn't need lock
+  if(!resource || !resource->isExist()) return VarType::invalid_type;
+  return std::atomic_ref(resource->resource_data.type).load(std::memory_order_acquire);
+}
+
+ResourceData Link::readOptimistic() const noexcept {
+  if(!resource || !resource->isExist()) return ResourceData{VarType::invalid_type, {.pointer = nullptr}};
+#ifdef BINOM_SINGLE_THREAD
+  return resource->resource_data;
+#else
+  for(size_t attempt = 0; attempt < optimistic_read_attempt_count; ++attempt) {
+    const ui64 version = resource->version.load(std::memory_order_acquire);
+    if(version & 1) continue; // Resource is written now
+    const ResourceData resource_data{
+      std::atomic_ref(resource->resource_data.type).load(std::memory_order_relaxed),
+      {.ui64_val = std::atomic_ref(resource->resource_data.data.ui64_val).load(std::memory_order_relaxed)}
+    };
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if(resource->version.load(std::memory_order_relaxed) == version) return resource_data;
+  }
+  // Resource is written too long, wait for writer on lock
   if(auto lk = getLock(MtxLockType::shared_locked); lk)
-    return resource->resource_data.type;
-  else return VarType::invalid_type;
+    return resource->resource_data;
+  else return ResourceData{VarType::invalid_type, {.pointer = nullptr}};
+#endif
 }
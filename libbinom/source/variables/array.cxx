@@ -3,6 +3,19 @@
 using namespace binom;
 using namespace binom::priv;
 
+namespace {
+
+//! Elements are cloned before array is locked for change, so list may contain array itself
+//! and lazy clone of array is detached from it by the lock like any other clone
+std::vector<Variable> cloneElements(const literals::arr& variable_list) {
+  std::vector<Variable> clones;
+  clones.reserve(variable_list.getSize());
+  for(const auto& variable : variable_list) clones.emplace_back(variable);
+  return clones;
+}
+
+}
+
 ArrayImplementation*& Array::getData() const noexcept {return resource_link->data.array_implementation;}
 
 Array::Array(priv::Link&& link) : Variable(std::move(link)) {}
@@ -16,6 +29,10 @@ Array::Array(const literals::arr array)
 Array::Array(const Array& other) noexcept : Variable(dynamic_cast<const Variable&>(other)) {}
 Array::Array(const Array&& other) noexcept : Variable(dynamic_cast<const Variable&&>(other)) {}
 
+Array Array::nulls(size_t count) {
+  return Link(ResourceData{VarType::array, {.array_implementation = priv::ArrayImplementation::create(count, []() { return Variable(); })}});
+}
+
 Array Array::move() noexcept {return Link(resource_link);}
 
 const Array Array::move() const noexcept {return Link(resource_link);}
@@ -32,19 +49,34 @@ size_t Array::getCapacity() const noexcept {
   return getData()->getCapacity();
 }
 
+size_t Array::getElementCapacity() const noexcept {
+  auto lk = getLock(MtxLockType::shared_locked);
+  if(!lk) return 0;
+  return getData()->getElementCapacity();
+}
+
 size_t Array::getSize() const noexcept {
   auto lk = getLock(MtxLockType::shared_locked);
   if(!lk) return 0;
   return getData()->getSize();
 }
 
+void Array::reserve(size_t count) {
+  if(auto lk = getLock(MtxLockType::unique_locked); lk) priv::ArrayImplementation::reserve(getData(), count);
+}
+
+void Array::shrinkToFit() {
+  if(auto lk = getLock(MtxLockType::unique_locked); lk) priv::ArrayImplementation::shrinkToFit(getData());
+}
+
 Variable Array::pushBack(Variable variable) {
   if(auto lk = getLock(MtxLockType::unique_locked);lk) return priv::ArrayImplementation::pushBack(getData(), variable.move());
   else return nullptr;
 }
 
 Array::Iterator Array::pushBack(const literals::arr variable_list) {
-  if(auto lk = getLock(MtxLockType::unique_locked);lk) return priv::ArrayImplementation::pushBack(getData(), variable_list);
+  std::vector<Variable> clones = cloneElements(variable_list);
+  if(auto lk = getLock(MtxLockType::unique_locked);lk) return priv::ArrayImplementation::pushBack(getData(), std::move(clones));
   else return nullptr;
 }
 
@@ -54,7 +86,8 @@ Variable Array::pushFront(Variable variable) {
 }
 
 Array::Iterator Array::pushFront(const literals::arr variable_list) {
-  if(auto lk = getLock(MtxLockType::unique_locked);lk) return priv::ArrayImplementation::pushFront(getData(), variable_list);
+  std::vector<Variable> clones = cloneElements(variable_list);
+  if(auto lk = getLock(MtxLockType::unique_locked);lk) return priv::ArrayImplementation::pushFront(getData(), std::move(clones));
   else return nullptr;
 }
 
@@ -64,7 +97,8 @@ Variable Array::insert(size_t at, Variable variable) {
 }
 
 Array::Iterator Array::insert(size_t at, literals::arr variable_list) {
-  if(auto lk = getLock(MtxLockType::unique_locked);lk) return priv::ArrayImplementation::insert(getData(), at, variable_list);
+  std::vector<Variable> clones = cloneElements(variable_list);
+  if(auto lk = getLock(MtxLockType::unique_locked);lk) return priv::ArrayImplementation::insert(getData(), at, std::move(clones));
   else return nullptr;
 }
 
@@ -97,13 +131,13 @@ void Array::clear() {
 }
 
 Variable Array::operator[](size_t index) noexcept {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementLinkLock();
   if(!lk) return nullptr;
   return (*getData())[index];
 }
 
 const Variable Array::operator[](size_t index) const noexcept {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementLinkLock();
   if(!lk) return nullptr;
   return (*getData())[index];
 }
@@ -112,27 +146,27 @@ Array& Array::operator+=(Variable variable) {pushBack(std::move(variable)); retu
 Array& Array::operator+=(literals::arr variable_list) {pushBack(std::move(variable_list)); return self;}
 Array& Array::operator+=(const Array variable_array) {pushBack(std::move(variable_array)); return self;}
 
-Array::Iterator Array::begin() {return getData()->begin();}
+Array::Iterator Array::begin() {auto lk = getElementAccessLock(); return getData()->begin();}
 
-Array::Iterator Array::end() {return getData()->end();}
+Array::Iterator Array::end() {auto lk = getElementAccessLock(); return getData()->end();}
 
-Array::ReverseIterator Array::rbegin() {return getData()->rbegin();}
+Array::ReverseIterator Array::rbegin() {auto lk = getElementAccessLock(); return getData()->rbegin();}
 
-Array::ReverseIterator Array::rend() {return getData()->rend();}
+Array::ReverseIterator Array::rend() {auto lk = getElementAccessLock(); return getData()->rend();}
 
-Array::ConstIterator Array::cbegin() const {return getData()->cbegin();}
+Array::ConstIterator Array::cbegin() const {auto lk = getElementLinkLock(); return getData()->cbegin();}
 
-Array::ConstIterator Array::cend() const {return getData()->cend();}
+Array::ConstIterator Array::cend() const {auto lk = getElementLinkLock(); return getData()->cend();}
 
-Array::ConstReverseIterator Array::crbegin() const {return getData()->crbegin();}
+Array::ConstReverseIterator Array::crbegin() const {auto lk = getElementLinkLock(); return getData()->crbegin();}
 
-Array::ConstReverseIterator Array::crend() const {return getData()->crend();}
+Array::ConstReverseIterator Array::crend() const {auto lk = getElementLinkLock(); return getData()->crend();}
 
 Array& Array::operator=(const Array& other) {
   if(this == &other) return self;
   auto lk = getLock(MtxLockType::unique_locked);
   if(!lk) return self;
-  resource_link.overwriteWithResourceCopy(**other.resource_link);
+  resource_link.overwriteWithResourceCopy(other.resource_link);
   return self;
 }
 
@@ -140,7 +174,7 @@ Array& Array::operator=(Array&& other) {
   if(this == &other) return self;
   auto lk = getLock(MtxLockType::unique_locked);
   if(!lk) return self;
-  resource_link.overwriteWithResourceCopy(**other.resource_link);
+  resource_link.overwriteWithResourceCopy(other.resource_link);
   return self;
 }
 
@@ -18,6 +18,10 @@ BitArray::BitArray(const literals::bitarr bit_array) : Variable(bit_array) {}
 BitArray::BitArray(const BitArray& other) noexcept : Variable(dynamic_cast<const Variable&>(other)) {}
 BitArray::BitArray(const BitArray&& other) noexcept : Variable(dynamic_cast<const Variable&&>(other)) {}
 
+BitArray BitArray::zeroed(size_t bit_count) {
+  return Link(ResourceData{VarType::bit_array, {.bit_array_implementation = BitArrayImplementation::createZeroed(bit_count)}});
+}
+
 BitArray BitArray::move() noexcept {return Link(resource_link);}
 const BitArray BitArray::move() const noexcept {return Link(resource_link);}
 
@@ -39,14 +43,28 @@ size_t BitArray::getCapacity() const noexcept {
   return getData()->getCapacity();
 }
 
-BitArray::ValueRef BitArray::operator [](size_t index) {
+size_t BitArray::getElementCapacity() const noexcept {
   auto lk = getLock(MtxLockType::shared_locked);
+  if(!lk) return 0;
+  return getData()->getBitCapacity();
+}
+
+void BitArray::reserve(size_t bit_count) {
+  if(auto lk = getLock(MtxLockType::unique_locked); lk) BitArrayImplementation::reserve(getData(), bit_count);
+}
+
+void BitArray::shrinkToFit() {
+  if(auto lk = getLock(MtxLockType::unique_locked); lk) BitArrayImplementation::shrinkToFit(getData());
+}
+
+BitArray::ValueRef BitArray::operator [](size_t index) {
+  auto lk = getElementAccessLock();
   if(!lk) return priv::Bits::getNullValue();
   return (*getData())[index];
 }
 
 const BitArray::ValueRef BitArray::operator [](size_t index) const {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementLinkLock();
   if(!lk) return priv::Bits::getNullValue();
   return (*getData())[index];
 }
@@ -167,7 +185,7 @@ BitArray& BitArray::operator=(const BitArray& other) {
   if(this == &other) return self;
   auto lk = getLock(MtxLockType::unique_locked);
   if(!lk) return self;
-  resource_link.overwriteWithResourceCopy(**other.resource_link);
+  resource_link.overwriteWithResourceCopy(other.resource_link);
   return self;
 }
 
@@ -175,7 +193,7 @@ BitArray& BitArray::operator=(BitArray&& other) {
   if(this == &other) return self;
   auto lk = getLock(MtxLockType::unique_locked);
   if(!lk) return self;
-  resource_link.overwriteWithResourceCopy(**other.resource_link);
+  resource_link.overwriteWithResourceCopy(other.resource_link);
   return self;
 }
 
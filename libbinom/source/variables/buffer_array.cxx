@@ -3,7 +3,7 @@
 using namespace binom;
 using namespace binom::priv;
 
-BufferArrayImplementation*& BufferArray::getData() const noexcept {return resource_link->data.buffer_array_implementation;}
+BufferArrayStorage& BufferArray::getData() const noexcept {return resource_link->data.buffer_array_storage;}
 
 BufferArray::BufferArray(Link&& link) : Variable(std::move(link)) {}
 
@@ -11,31 +11,52 @@ BufferArray::BufferArray() noexcept : Variable(literals::ui8arr{}) {}
 BufferArray::BufferArray(const BufferArray& other) noexcept : Variable(dynamic_cast<const Variable&>(other)) {}
 BufferArray::BufferArray(const BufferArray&& other) noexcept : Variable(dynamic_cast<const Variable&&>(other)) {}
 
+BufferArray BufferArray::zeroed(VarType type, size_t count) {
+  if(toTypeClass(type) != VarTypeClass::buffer_array) throw err::Error(err::ErrorType::binom_invalid_type);
+  return Link(ResourceData{type, {.buffer_array_storage = BufferArrayImplementation::createZeroed(toBitWidth(type), count)}});
+}
+
 BufferArray BufferArray::move() noexcept {return Link(resource_link);}
 const BufferArray BufferArray::move() const noexcept {return Link(resource_link);}
 
 size_t BufferArray::getElementCount() const noexcept {
   if(auto lk = getLock(MtxLockType::shared_locked); lk)
-    return getData()->getElementCount(getBitWidth());
+    return BufferArrayImplementation::getElementCount(getData(), getBitWidth());
   else return 0;
 }
 
 size_t BufferArray::getSize() const noexcept {
   auto lk = getLock(MtxLockType::shared_locked);
   if(!lk) return 0;
-  return getData()->getSize();
+  return BufferArrayImplementation::getSize(getData());
 }
 
 size_t BufferArray::getCapacity() const noexcept {
   auto lk = getLock(MtxLockType::shared_locked);
   if(!lk) return 0;
-  return getData()->getCapacity();
+  return BufferArrayImplementation::getCapacity(getData());
 }
 
-BufferArray::ValueRef BufferArray::operator[](size_t index) noexcept {
+size_t BufferArray::getElementCapacity() const noexcept {
   auto lk = getLock(MtxLockType::shared_locked);
+  if(!lk) return 0;
+  return BufferArrayImplementation::getElementCapacity(getData(), getBitWidth());
+}
+
+void BufferArray::reserve(size_t count) {
+  if(auto lk = getLock(MtxLockType::unique_locked); lk)
+    BufferArrayImplementation::reserve(getData(), getBitWidth(), count);
+}
+
+void BufferArray::shrinkToFit() {
+  if(auto lk = getLock(MtxLockType::unique_locked); lk)
+    BufferArrayImplementation::shrinkToFit(getData());
+}
+
+BufferArray::ValueRef BufferArray::operator[](size_t index) noexcept {
+  auto lk = getElementAccessLock();
   if(!lk) return ValueRef(ValType::invalid_type, nullptr);
-  return getData()->get(getValType(), index);
+  return BufferArrayImplementation::get(getData(), getValType(), index);
 }
 
 void BufferArray::remove(size_t at, size_t count) {
@@ -59,64 +80,64 @@ void BufferArray::clear() {
 }
 
 const BufferArray::ValueRef BufferArray::operator[](size_t index) const noexcept {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementLinkLock();
   if(!lk) return ValueRef(ValType::invalid_type, nullptr);
-  return getData()->get(getValType(), index);
+  return BufferArrayImplementation::get(getData(), getValType(), index);
 }
 
 BufferArray::Iterator BufferArray::begin() {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementAccessLock();
   if(!lk) return Iterator(ValType::invalid_type, nullptr);
-  return getData()->begin(getValType());
+  return BufferArrayImplementation::begin(getData(), getValType());
 }
 
 BufferArray::Iterator BufferArray::end() {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementAccessLock();
   if(!lk) return Iterator(ValType::invalid_type, nullptr);
-  return getData()->end(getValType());
+  return BufferArrayImplementation::end(getData(), getValType());
 }
 
 BufferArray::ReverseIterator BufferArray::rbegin() {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementAccessLock();
   if(!lk) return ReverseIterator(ValType::invalid_type, nullptr);
-  return getData()->rbegin(getValType());
+  return BufferArrayImplementation::rbegin(getData(), getValType());
 }
 
 BufferArray::ReverseIterator BufferArray::rend() {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementAccessLock();
   if(!lk) return ReverseIterator(ValType::invalid_type, nullptr);
-  return getData()->rend(getValType());
+  return BufferArrayImplementation::rend(getData(), getValType());
 }
 
 const BufferArray::Iterator BufferArray::cbegin() const {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementLinkLock();
   if(!lk) return Iterator(ValType::invalid_type, nullptr);
-  return getData()->begin(getValType());
+  return BufferArrayImplementation::begin(getData(), getValType());
 }
 
 const BufferArray::Iterator BufferArray::cend() const {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementLinkLock();
   if(!lk) return Iterator(ValType::invalid_type, nullptr);
-  return getData()->end(getValType());
+  return BufferArrayImplementation::end(getData(), getValType());
 }
 
 const BufferArray::ReverseIterator BufferArray::crbegin() const {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementLinkLock();
   if(!lk) return ReverseIterator(ValType::invalid_type, nullptr);
-  return getData()->rbegin(getValType());
+  return BufferArrayImplementation::rbegin(getData(), getValType());
 }
 
 const BufferArray::ReverseIterator BufferArray::crend() const {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementLinkLock();
   if(!lk) return ReverseIterator(ValType::invalid_type, nullptr);
-  return getData()->rend(getValType());
+  return BufferArrayImplementation::rend(getData(), getValType());
 }
 
 BufferArray& BufferArray::operator=(const BufferArray& other) {
   if(this == &other) return self;
   auto lk = getLock(MtxLockType::unique_locked);
   if(!lk) return self;
-  resource_link.overwriteWithResourceCopy(**other.resource_link);
+  resource_link.overwriteWithResourceCopy(other.resource_link);
   return self;
 }
 
@@ -124,7 +145,7 @@ BufferArray& BufferArray::operator=(BufferArray&& other) {
   if(this == &other) return self;
   auto lk = getLock(MtxLockType::unique_locked);
   if(!lk) return self;
-  resource_link.overwriteWithResourceCopy(**other.resource_link);
+  resource_link.overwriteWithResourceCopy(other.resource_link);
   return self;
 }
 
@@ -146,7 +167,7 @@ BufferArray::operator std::basic_string<CharT>() {
   auto lk = getLock(MtxLockType::shared_locked);
   if(!lk) return std::basic_string<CharT>();
 
-  std::basic_string<CharT> str(getData()->getSize(), '\0');
+  std::basic_string<CharT> str(BufferArrayImplementation::getSize(getData()), '\0');
 
   auto str_it = str.begin(), str_end = str.end();
   auto buffer_array_it = cbegin(), buffer_array_end = cend();
@@ -0,0 +1,234 @@
+#include "libbinom/include/variables/file_storage.hxx"
+
+using namespace binom;
+using namespace binom::priv;
+
+// FileVariable
+
+FileVariable::FileVariable(std::shared_ptr<FileStorageImplementation> storage, FileResourceIndex index)
+  : storage(std::move(storage)), index(index), generation(self.storage->getGeneration(index)) {}
+
+SharedRecursiveLock FileVariable::getLock(MtxLockType lock_type) const {
+  if(!storage) throw err::Error(err::ErrorType::binom_resource_not_available);
+  SharedRecursiveLock lk = storage->getLock(lock_type);
+  if(!storage->isAlive(index, generation)) throw err::Error(err::ErrorType::binom_resource_not_available);
+  return lk;
+}
+
+bool FileVariable::isValid() const noexcept {
+  if(!storage) return false;
+  try {
+    auto lk = storage->getLock(MtxLockType::shared_locked);
+    return storage->isAlive(index, generation);
+  } catch(...) {return false;}
+}
+
+size_t FileVariable::getElementCount() const {
+  if(!storage) return 0;
+  auto lk = getLock(MtxLockType::shared_locked);
+  return storage->getElementCount(index);
+}
+
+GenericValue FileVariable::toNumber() const {
+  if(getTypeClass() != VarTypeClass::number) throw err::Error(err::ErrorType::binom_invalid_type);
+  return GenericValue(getValType(), arithmetic::ArithmeticData{.ui64_val = index.index.ui64_val});
+}
+
+FileBufferArray FileVariable::toBufferArray() const {return FileBufferArray(self);}
+FileArray FileVariable::toArray() const {return FileArray(self);}
+FileMap FileVariable::toMap() const {return FileMap(self);}
+
+Variable FileVariable::toVariable() const {
+  if(!storage) return nullptr;
+  auto lk = getLock(MtxLockType::shared_locked);
+  return storage->load(index);
+}
+
+// FileBufferArray
+
+FileBufferArray::FileBufferArray(const FileVariable& variable) : FileVariable(variable) {
+  if(getTypeClass() != VarTypeClass::buffer_array) throw err::Error(err::ErrorType::binom_invalid_type);
+}
+
+void FileBufferArray::read(size_t at, void* to, size_t count) const {
+  auto lk = getLock(MtxLockType::shared_locked);
+  storage->readBuffer(index, at, to, count);
+}
+
+GenericValue FileBufferArray::operator[](size_t index) const {
+  arithmetic::ArithmeticData data{.ui64_val = 0};
+  read(index, &data, 1);
+  return GenericValue(getValType(), data);
+}
+
+void FileBufferArray::insert(size_t at, const void* data, size_t count) {
+  {
+    auto lk = getLock(MtxLockType::unique_locked);
+    storage->insertBuffer(index, at, data, count);
+  }
+  storage->commit();
+}
+
+void FileBufferArray::pushBack(const void* data, size_t count) {
+  {
+    auto lk = getLock(MtxLockType::unique_locked);
+    storage->insertBuffer(index, storage->getElementCount(index), data, count);
+  }
+  storage->commit();
+}
+
+void FileBufferArray::remove(size_t at, size_t count) {
+  {
+    auto lk = getLock(MtxLockType::unique_locked);
+    storage->removeBuffer(index, at, count);
+  }
+  storage->commit();
+}
+
+// FileArray
+
+FileArray::FileArray(const FileVariable& variable) : FileVariable(variable) {
+  if(getTypeClass() != VarTypeClass::array && getTypeClass() != VarTypeClass::list)
+    throw err::Error(err::ErrorType::binom_invalid_type);
+}
+
+FileVariable FileArray::operator[](size_t index) const {
+  auto lk = getLock(MtxLockType::shared_locked);
+  if(index >= storage->getElementCount(self.index)) return FileVariable();
+  return FileVariable(storage, storage->getElement(self.index, index));
+}
+
+void FileArray::insert(size_t at, const Variable& variable) {
+  const std::vector<byte> data = variable.serialize();
+  {
+    auto lk = getLock(MtxLockType::unique_locked);
+    storage->insertElement(index, at, View(data));
+  }
+  storage->commit();
+}
+
+void FileArray::pushBack(const Variable& variable) {
+  const std::vector<byte> data = variable.serialize();
+  {
+    auto lk = getLock(MtxLockType::unique_locked);
+    storage->insertElement(index, storage->getElementCount(index), View(data));
+  }
+  storage->commit();
+}
+
+void FileArray::remove(size_t at, size_t count) {
+  {
+    auto lk = getLock(MtxLockType::unique_locked);
+    storage->removeElements(index, at, count);
+  }
+  storage->commit();
+}
+
+// FileMap
+
+FileMap::FileMap(const FileVariable& variable) : FileVariable(variable) {
+  if(getTypeClass() != VarTypeClass::map && getTypeClass() != VarTypeClass::multimap && getTypeClass() != VarTypeClass::hash_map)
+    throw err::Error(err::ErrorType::binom_invalid_type);
+}
+
+KeyValue FileMap::getKey(size_t index) const {
+  auto lk = getLock(MtxLockType::shared_locked);
+  return storage->getMapKey(self.index, index);
+}
+
+FileVariable FileMap::getValue(size_t index) const {
+  auto lk = getLock(MtxLockType::shared_locked);
+  return FileVariable(storage, storage->getMapEntry(self.index, index).value);
+}
+
+size_t FileMap::find(const KeyValue& key) const {
+  auto lk = getLock(MtxLockType::shared_locked);
+  return storage->findKey(index, key);
+}
+
+bool FileMap::contains(const KeyValue& key) const {
+  auto lk = getLock(MtxLockType::shared_locked);
+  return storage->findKey(index, key) != storage->getElementCount(index);
+}
+
+FileVariable FileMap::operator[](const KeyValue& key) const {
+  auto lk = getLock(MtxLockType::shared_locked);
+  const size_t position = storage->findKey(index, key);
+  if(position == storage->getElementCount(index)) return FileVariable();
+  return FileVariable(storage, storage->getMapEntry(index, position).value);
+}
+
+FileVariable FileMap::insert(const KeyValue& key, const Variable& variable) {
+  const std::vector<byte> data = variable.serialize();
+  FileVariable value;
+  {
+    auto lk = getLock(MtxLockType::unique_locked);
+    const size_t position = storage->insertMapElement(index, key, View(data));
+    value = FileVariable(storage, storage->getMapEntry(index, position).value);
+  }
+  storage->commit();
+  return value;
+}
+
+size_t FileMap::remove(const KeyValue& key) {
+  size_t count;
+  {
+    auto lk = getLock(MtxLockType::unique_locked);
+    const auto [first, last] = storage->findKeyRange(index, key);
+    if(first != last) storage->removeMapElements(index, first, last - first);
+    count = last - first;
+  }
+  storage->commit();
+  return count;
+}
+
+size_t FileMap::rename(const KeyValue& old_key, const KeyValue& new_key) {
+  size_t count;
+  {
+    auto lk = getLock(MtxLockType::unique_locked);
+    count = storage->renameMapElements(index, old_key, new_key);
+  }
+  storage->commit();
+  return count;
+}
+
+// FileStorage
+
+FileStorage::FileStorage(const std::string& path, ui32 page_size, size_t cache_size, CacheEvictionPolicy policy, JournalConfig journal_config)
+  : storage(std::make_shared<FileStorageImplementation>(path, page_size, cache_size, policy, journal_config)) {}
+
+FileVariable FileStorage::getRoot() const {
+  auto lk = storage->getLock(MtxLockType::shared_locked);
+  return FileVariable(storage, storage->getRoot());
+}
+
+FileVariable FileStorage::setRoot(const Variable& variable) {
+  const std::vector<byte> data = variable.serialize();
+  FileVariable root;
+  {
+    auto lk = storage->getLock(MtxLockType::unique_locked);
+    storage->setRoot(View(data));
+    root = FileVariable(storage, storage->getRoot());
+  }
+  storage->commit();
+  return root;
+}
+
+void FileStorage::commit() {storage->getJournal().flush();}
+
+void FileStorage::sync() {
+  auto lk = storage->getLock(MtxLockType::unique_locked);
+  storage->checkpoint();
+}
+
+size_t FileStorage::getPageSize() const noexcept {return storage->getFile().getPageSize();}
+size_t FileStorage::getPageCount() const noexcept {return storage->getFile().getPageCount();}
+
+size_t FileStorage::getUsedPageCount() const {
+  auto lk = storage->getLock(MtxLockType::shared_locked);
+  return storage->getFile().getUsedPageCount();
+}
+
+CacheStatistics FileStorage::getCacheStatistics() const {return storage->getFile().getCacheStatistics();}
+void FileStorage::resetCacheStatistics() {storage->getFile().resetCacheStatistics();}
+size_t FileStorage::getJournalSyncCount() const {return storage->getJournal().getSyncCount();}
@@ -0,0 +1,167 @@
+#include "libbinom/include/variables/hash_map.hxx"
+
+using namespace binom;
+using namespace binom::priv;
+
+HashMapImplementation* HashMap::getData() { return resource_link->data.hash_map_implementation; }
+
+const HashMapImplementation* HashMap::getData() const { return resource_link->data.hash_map_implementation; }
+
+HashMap::HashMap(priv::Link&& link) : Variable(std::move(link)) {}
+
+HashMap::HashMap() : Variable(literals::hashmap{}) {}
+
+HashMap::HashMap(literals::hashmap element_list)
+  : Variable(std::move(element_list)) {}
+
+HashMap::HashMap(const HashMap& other)
+  : Variable(other) {}
+
+HashMap::HashMap(HashMap&& other)
+  : Variable(std::move(other)) {}
+
+HashMap HashMap::move() noexcept {return Link(resource_link);}
+const HashMap HashMap::move() const noexcept {return Link(resource_link);}
+
+bool HashMap::isEmpty() const noexcept {
+  auto lk = getLock(MtxLockType::shared_locked);
+  if(!lk) return 0;
+  return getData()->isEmpty();
+}
+
+size_t HashMap::getElementCount() const noexcept {
+  auto lk = getLock(MtxLockType::shared_locked);
+  if(!lk) return 0;
+  return getData()->getSize();
+}
+
+bool HashMap::contains(KeyValue value) const noexcept {
+  auto lk = getLock(MtxLockType::shared_locked);
+  if(!lk) return false;
+  return getData()->contains(std::move(value));
+}
+
+void HashMap::clear() {
+  auto lk = getLock(MtxLockType::unique_locked);
+  if(!lk) return;
+  return getData()->clear();
+}
+
+void HashMap::reserve(size_t count) {
+  auto lk = getLock(MtxLockType::unique_locked);
+  if(!lk) return;
+  return getData()->reserve(count);
+}
+
+err::ProgressReport<HashMap::NamedVariable> HashMap::insert(KeyValue key, Variable variable) {
+  auto lk = getLock(MtxLockType::unique_locked);
+  if(!lk) return err::ErrorType::binom_resource_not_available;
+  return getData()->insert(std::move(key), variable.move());
+}
+
+Error HashMap::remove(KeyValue key) {
+  auto lk = getLock(MtxLockType::unique_locked);
+  if(!lk) return err::ErrorType::binom_resource_not_available;
+  return getData()->remove(std::move(key));
+}
+
+Variable HashMap::getVariable(KeyValue key) {
+  auto lk = getElementLinkLock();
+  if(!lk) return nullptr;
+  return getData()->getVariable(std::move(key));
+}
+
+Variable HashMap::operator[](KeyValue key) {
+  auto lk = getLock(MtxLockType::unique_locked);
+  if(!lk) return nullptr;
+  return getData()->getOrInsertNamedVariable(std::move(key)).getVariable().move();
+}
+
+HashMap::Iterator HashMap::find(KeyValue key) {
+  auto lk = getElementAccessLock();
+  if(!lk) return Iterator::nullit();
+  return getData()->find(std::move(key));
+}
+
+HashMap::ConstIterator HashMap::find(KeyValue key) const {
+  auto lk = getElementLinkLock();
+  if(!lk) return ConstIterator::nullit();
+  return getData()->find(std::move(key));
+}
+
+const Variable HashMap::getVariable(KeyValue key) const {
+  auto lk = getElementLinkLock();
+  if(!lk) return nullptr;
+  return getData()->getVariable(std::move(key));
+}
+
+const Variable HashMap::operator[](KeyValue key) const {
+  auto lk = getElementLinkLock();
+  if(!lk) return nullptr;
+  return getData()->getVariable(std::move(key));
+}
+
+HashMap::Iterator HashMap::begin() {
+  auto lk = getElementAccessLock();
+  if(!lk) return Iterator::nullit();
+  return getData()->begin();
+}
+
+HashMap::Iterator HashMap::end() {
+  auto lk = getElementAccessLock();
+  if(!lk) return Iterator::nullit();
+  return getData()->end();
+}
+
+HashMap::ConstIterator HashMap::begin() const noexcept {
+  auto lk = getElementLinkLock();
+  if(!lk) return ConstIterator::nullit();
+  return getData()->cbegin();
+}
+
+HashMap::ConstIterator HashMap::end() const noexcept {
+  auto lk = getElementLinkLock();
+  if(!lk) return ConstIterator::nullit();
+  return getData()->cend();
+}
+
+HashMap::ConstIterator HashMap::cbegin() const noexcept {
+  auto lk = getElementLinkLock();
+  if(!lk) return ConstIterator::nullit();
+  return getData()->cbegin();
+}
+
+HashMap::ConstIterator HashMap::cend() const noexcept {
+  auto lk = getElementLinkLock();
+  if(!lk) return ConstIterator::nullit();
+  return getData()->cend();
+}
+
+
+HashMap& HashMap::operator=(const HashMap& other) {
+  if(this == &other) return self;
+  auto lk = getLock(MtxLockType::unique_locked);
+  if(!lk) return self;
+  resource_link.overwriteWithResourceCopy(other.resource_link);
+  return self;
+}
+
+HashMap& HashMap::operator=(HashMap&& other) {
+  if(this == &other) return self;
+  auto lk = getLock(MtxLockType::unique_locked);
+  if(!lk) return self;
+  resource_link.overwriteWithResourceCopy(other.resource_link);
+  return self;
+}
+
+HashMap& HashMap::changeLink(const HashMap& other) {
+  if(this == &other) return self;
+  this->~HashMap();
+  return *new(this) HashMap(other);
+}
+
+HashMap& HashMap::changeLink(HashMap&& other) {
+  if(this == &other) return self;
+  this->~HashMap();
+  return *new(this) HashMap(std::move(other));
+}
@@ -4,9 +4,319 @@
 #include "libbinom/include/variables/bit_array.hxx"
 #include "libbinom/include/variables/buffer_array.hxx"
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <string_view>
+#include <unordered_map>
+
+namespace binom::priv {
+
+//! Immutable buffer array data shared by all interned keys with equal data, data follows header
+struct InternedKey {
+  std::atomic<size_t> link_counter;
+  size_t size;
+
+  byte* getData() noexcept {return reinterpret_cast<byte*>(this + 1);}
+  std::string_view getView() noexcept {return std::string_view(reinterpret_cast<const char*>(getData()), size);}
+};
+
+}
+
 using namespace binom;
 using namespace binom::priv;
 
+namespace {
+
+//! Table is global, so it is shared by threads even if each of them owns its variables in single thread mode
+struct InterningTable {
+  std::unordered_map<std::string_view, InternedKey*> keys;
+  std::mutex mtx;
+};
+
+//! Never destroyed, since keys with static storage duration may outlive it
+InterningTable& getInterningTable() {
+  static InterningTable* table = new InterningTable;
+  return *table;
+}
+
+InternedKey* acquireInternedKey(const byte* data, size_t size) {
+  InterningTable& table = getInterningTable();
+  std::scoped_lock lk(table.mtx);
+  auto it = table.keys.find(std::string_view(reinterpret_cast<const char*>(data), size));
+  if(it != table.keys.end()) {
+    InternedKey* key = it->second;
+    // Key released to zero links is being destroyed by other thread and can't be taken
+    size_t link_count = key->link_counter.load(std::memory_order_relaxed);
+    while(link_count)
+      if(key->link_counter.compare_exchange_weak(link_count, link_count + 1, std::memory_order_relaxed)) return key;
+    table.keys.erase(it);
+  }
+  void* memory = std::malloc(sizeof(InternedKey) + size);
+  if(!memory) throw std::bad_alloc();
+  InternedKey* key = new(memory) InternedKey{1, size};
+  std::memcpy(key->getData(), data, size);
+  table.keys.emplace(key->getView(), key);
+  return key;
+}
+
+void releaseInternedKey(InternedKey* key) {
+  if(key->link_counter.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+  {
+    InterningTable& table = getInterningTable();
+    std::scoped_lock lk(table.mtx);
+    // Table may already point to new key with same data
+    auto it = table.keys.find(key->getView());
+    if(it != table.keys.end() && it->second == key) table.keys.erase(it);
+  }
+  key->~InternedKey();
+  std::free(key);
+}
+
+constexpr ui64 golden_ratio = 0x9E3779B97F4A7C15ull;
+
+//! Finalizer of MurmurHash3, each bit of value affects all bits of result
+constexpr ui64 mixHash(ui64 value) noexcept {
+  value ^= value >> 33;
+  value *= 0xFF51AFD7ED558CCDull;
+  value ^= value >> 33;
+  value *= 0xC4CEB9FE1A85EC53ull;
+  value ^= value >> 33;
+  return value;
+}
+
+//! Data is read by 8 bytes
+ui64 hashBytes(const void* data, size_t size, ui64 seed) noexcept {
+  const byte* it = static_cast<const byte*>(data);
+  ui64 hash = seed ^ (size * golden_ratio);
+  for(; size >= sizeof(ui64); it += sizeof(ui64), size -= sizeof(ui64)) {
+    ui64 word;
+    std::memcpy(&word, it, sizeof(ui64));
+    hash = (hash ^ mixHash(word)) * golden_ratio;
+  }
+  if(size) {
+    ui64 word = 0;
+    std::memcpy(&word, it, size);
+    hash = (hash ^ mixHash(word)) * golden_ratio;
+  }
+  return mixHash(hash);
+}
+
+//! +0.0 and -0.0 are equal keys, as are all NaNs
+template<typename T>
+ui64 getComparedBits(T value) noexcept {
+  if(value == 0) return 0;
+  elif(std::isnan(value)) value = std::numeric_limits<T>::quiet_NaN();
+  ui64 bits = 0;
+  std::memcpy(&bits, &value, sizeof(T));
+  return bits;
+}
+
+int compareFloats(f64 first, f64 second) noexcept {
+  // NaN follows all other numbers and equals itself, so keys have total order
+  if(std::isnan(first) || std::isnan(second)) return int(std::isnan(first)) - int(std::isnan(second));
+  return first > second ? 1 : first < second ? -1 : 0;
+}
+
+//! Integer is compared with whole part of float first, since conversion of either to other type may round
+int compareWithFloat(ui64 value, f64 float_value) noexcept {
+  if(std::isnan(float_value) || float_value >= 0x1p64) return -1;
+  elif(float_value < 0) return 1;
+  const ui64 whole = ui64(std::trunc(float_value));
+  if(value != whole) return value > whole ? 1 : -1;
+  return f64(whole) < float_value ? -1 : 0;
+}
+
+int compareWithFloat(i64 value, f64 float_value) noexcept {
+  if(value >= 0) return compareWithFloat(ui64(value), float_value);
+  elif(std::isnan(float_value) || float_value >= 0) return -1;
+  elif(float_value < -0x1p63) return 1;
+  const i64 whole = i64(std::trunc(float_value));
+  if(value != whole) return value > whole ? 1 : -1;
+  return f64(whole) > float_value ? 1 : 0;
+}
+
+//! Numbers of all types are ordered by exact value as by getComparableEncoding
+template<typename First, typename Second>
+int compareNumbers(const First& first, const Second& second) noexcept {
+  const VarNumberType first_type = first.getNumberType(), second_type = second.getNumberType();
+  if(first_type == VarNumberType::float_point) {
+    if(second_type == VarNumberType::float_point) return compareFloats(f64(first), f64(second));
+    return second_type == VarNumberType::signed_integer ? -compareWithFloat(i64(second), f64(first))
+                                                        : -compareWithFloat(ui64(second), f64(first));
+  } elif(second_type == VarNumberType::float_point)
+    return first_type == VarNumberType::signed_integer ? compareWithFloat(i64(first), f64(second))
+                                                       : compareWithFloat(ui64(first), f64(second));
+  const bool is_first_negative = first_type == VarNumberType::signed_integer && i64(first) < 0,
+             is_second_negative = second_type == VarNumberType::signed_integer && i64(second) < 0;
+  if(is_first_negative != is_second_negative) return is_first_negative ? -1 : 1;
+  elif(is_first_negative) return i64(first) > i64(second) ? 1 : i64(first) < i64(second) ? -1 : 0;
+  else return ui64(first) > ui64(second) ? 1 : ui64(first) < ui64(second) ? -1 : 0;
+}
+
+//! Elements of same type are compared directly instead of through GenericValue
+template<typename T>
+KeyValue::CompareResult compareElements(const byte* this_data, size_t this_size, const byte* other_data, size_t other_size) noexcept {
+  const size_t common_size = std::min(this_size, other_size);
+  if constexpr (std::is_same_v<T, ui8>) {
+    if(const int result = std::memcmp(this_data, other_data, common_size))
+      return result > 0 ? KeyValue::CompareResult::highter : KeyValue::CompareResult::lower;
+  } else {
+    for(size_t offset = 0; offset < common_size; offset += sizeof(T)) {
+      T this_value, other_value;
+      std::memcpy(&this_value, this_data + offset, sizeof(T));
+      std::memcpy(&other_value, other_data + offset, sizeof(T));
+      if constexpr (std::is_floating_point_v<T>) {
+        if(const int result = compareFloats(this_value, other_value))
+          return result > 0 ? KeyValue::CompareResult::highter : KeyValue::CompareResult::lower;
+      } elif(this_value > other_value) return KeyValue::CompareResult::highter;
+      elif(this_value < other_value) return KeyValue::CompareResult::lower;
+    }
+  }
+  if(this_size > other_size) return KeyValue::CompareResult::highter;
+  elif(this_size < other_size) return KeyValue::CompareResult::lower;
+  else return KeyValue::CompareResult::equal;
+}
+
+void writeBigEndian(std::vector<byte>& encoding, ui64 value, size_t size) {
+  for(size_t shift = size * 8; shift;) {
+    shift -= 8;
+    encoding.push_back(byte(value >> shift));
+  }
+}
+
+//! Sign bit is set for positive values and all bits are inverted for negative ones,
+//! so bits are ordered as unsigned integers like values
+ui64 toComparableBits(f64 value) noexcept {
+  if(value == 0) value = 0;
+  elif(std::isnan(value)) value = std::numeric_limits<f64>::quiet_NaN();
+  ui64 bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits >> 63 ? ~bits : bits | (1ull << 63);
+}
+
+void writeFloat(std::vector<byte>& encoding, f64 value, ui64 remainder) {
+  writeBigEndian(encoding, toComparableBits(value), sizeof(ui64));
+  writeBigEndian(encoding, remainder, 2);
+}
+
+//! Largest f64 not greater than value
+f64 approximateUnsigned(ui64 value) noexcept {
+  f64 approximation = f64(value);
+  // 2^64 can't be converted back
+  if(approximation >= 0x1p64 || ui64(approximation) > value) approximation = std::nextafter(approximation, 0.0);
+  return approximation;
+}
+
+f64 approximateSigned(i64 value) noexcept {
+  if(value >= 0) return approximateUnsigned(ui64(value));
+  f64 approximation = f64(value);
+  if(i64(approximation) > value) approximation = std::nextafter(approximation, -std::numeric_limits<f64>::infinity());
+  return approximation;
+}
+
+//! Integer is written as largest f64 not greater than it and remainder below 2^11
+void writeUnsigned(std::vector<byte>& encoding, ui64 value) {
+  const f64 approximation = approximateUnsigned(value);
+  writeFloat(encoding, approximation, value - ui64(approximation));
+}
+
+void writeSigned(std::vector<byte>& encoding, i64 value) {
+  if(value >= 0) return writeUnsigned(encoding, ui64(value));
+  const f64 approximation = approximateSigned(value);
+  writeFloat(encoding, approximation, ui64(value - i64(approximation)));
+}
+
+template<typename T>
+void writeNumber(std::vector<byte>& encoding, const T& value) {
+  switch (value.getNumberType()) {
+  case VarNumberType::unsigned_integer: return writeUnsigned(encoding, ui64(value));
+  case VarNumberType::signed_integer: return writeSigned(encoding, i64(value));
+  case VarNumberType::float_point: return writeFloat(encoding, f64(value), 0);
+  case VarNumberType::invalid_type: default: return;
+  }
+}
+
+//! Bits of f64 and remainder written by writeFloat
+constexpr size_t encoded_number_size = sizeof(ui64) + 2;
+
+//! Bits of approximation written by writeNumber
+template<typename T>
+ui64 getComparableNumberBits(const T& value) noexcept {
+  switch (value.getNumberType()) {
+  case VarNumberType::unsigned_integer: return toComparableBits(approximateUnsigned(ui64(value)));
+  case VarNumberType::signed_integer: return toComparableBits(approximateSigned(i64(value)));
+  case VarNumberType::float_point: return toComparableBits(f64(value));
+  case VarNumberType::invalid_type: default: return 0;
+  }
+}
+
+//! Byte of buffer array element in key prefix, integers up to 126 get even codes of their own,
+//! other values share odd codes of ranges between them, so prefix ends after such element
+byte getPrefixElementCode(GenericValueRef value, bool& is_exact) noexcept {
+  constexpr f64 max_exact_value = 126;
+  f64 number;
+  switch (value.getNumberType()) {
+  case VarNumberType::unsigned_integer: number = ui64(value) > ui64(max_exact_value) ? max_exact_value + 1 : f64(ui64(value)); break;
+  case VarNumberType::signed_integer: number = i64(value) > i64(max_exact_value) ? max_exact_value + 1 : f64(i64(value)); break;
+  case VarNumberType::float_point: number = f64(value); break;
+  case VarNumberType::invalid_type: default: number = 0; break;
+  }
+  is_exact = false;
+  // NaN follows all numbers
+  if(!(number <= max_exact_value)) return 255;
+  if(number < 0) return 1;
+  const f64 integer = std::floor(number);
+  is_exact = integer == number;
+  return byte(2 + 2 * ui64(integer) + !is_exact);
+}
+
+ui64 readBigEndian(const byte* data, size_t size) noexcept {
+  ui64 value = 0;
+  for(size_t i = 0; i < size; ++i) value = value << 8 | data[i];
+  return value;
+}
+
+//! Inverse of writeNumber, value is converted to type of reference
+//! Damaged encodings of values the type can't hold are rejected, since their conversion is undefined
+void readNumber(const byte* data, GenericValueRef value) {
+  const ui64 bits = readBigEndian(data, sizeof(ui64));
+  const ui64 float_bits = bits >> 63 ? bits & ~(1ull << 63) : ~bits;
+  f64 approximation;
+  std::memcpy(&approximation, &float_bits, sizeof(approximation));
+  const ui64 remainder = readBigEndian(data + sizeof(ui64), 2);
+  const int value_bits = int(value.getBitWidth()) * 8;
+  switch (value.getNumberType()) {
+  case VarNumberType::unsigned_integer: {
+    if(!(approximation >= 0 && approximation < std::ldexp(1.0, value_bits)))
+      throw err::Error(err::ErrorType::invalid_data);
+    const ui64 integer = ui64(approximation), max = ~0ull >> (64 - value_bits);
+    if(remainder > max - integer) throw err::Error(err::ErrorType::invalid_data);
+    value = integer + remainder;
+  } return;
+  case VarNumberType::signed_integer: {
+    const f64 limit = std::ldexp(1.0, value_bits - 1);
+    if(!(approximation >= -limit && approximation < limit)) throw err::Error(err::ErrorType::invalid_data);
+    const i64 integer = i64(approximation), max = i64(~0ull >> (65 - value_bits));
+    if(remainder > ui64(max) - ui64(integer)) throw err::Error(err::ErrorType::invalid_data);
+    value = integer + i64(remainder);
+  } return;
+  case VarNumberType::float_point:
+    if(remainder || (value_bits == 32 && std::isfinite(approximation) && std::abs(approximation) > std::numeric_limits<f32>::max()))
+      throw err::Error(err::ErrorType::invalid_data);
+    value = approximation;
+  return;
+  case VarNumberType::invalid_type: default: throw err::Error(err::ErrorType::invalid_data);
+  }
+}
+
+}
+
 KeyValue::KeyValue(bool value) noexcept : type(VarKeyType::boolean), data{.bool_val = value} {}
 KeyValue::KeyValue(ui8 value) noexcept  : type(VarKeyType::ui8), data{.ui8_val = value} {}
 KeyValue::KeyValue(i8 value) noexcept   : type(VarKeyType::si8), data{.i8_val = value} {}
@@ -31,15 +341,24 @@ KeyValue::KeyValue(const literals::bitarr bit_array)
   : type(VarKeyType::bit_array), data{.bit_array_implementation = priv::BitArrayImplementation::create(bit_array)} {}
 KeyValue::KeyValue(const BitArray& value) noexcept
   : type(VarKeyType::bit_array), data{.bit_array_implementation = priv::BitArrayImplementation::copy(value.getData())} {}
-KeyValue::KeyValue(BitArray&& value) noexcept
-  : type(VarKeyType::bit_array), data{.bit_array_implementation = value.resource_link->data.bit_array_implementation} {
+KeyValue::KeyValue(BitArray&& value) noexcept {
+  // Unique lock gives pending clones of value their own copy, so its implementation can be taken over
+  auto lk = value.getLock(MtxLockType::unique_locked);
+  if(!lk) return;
+  type = VarKeyType::bit_array;
+  if(value.resource_link.isCloneShared()) {
+    data.bit_array_implementation = priv::BitArrayImplementation::copy(value.getData());
+    return;
+  }
+  data.bit_array_implementation = value.resource_link->data.bit_array_implementation;
   value.resource_link->data.pointer = nullptr;
 }
 
 template<typename CharT>
 requires extended_type_traits::is_char_v<CharT>
-KeyValue::KeyValue(const std::basic_string_view<CharT> string_view)
-  : type(toKeyType(to_buffer_array_type<CharT>)), data{.buffer_array_implementation = priv::BufferArrayImplementation::create(string_view)} {}
+KeyValue::KeyValue(const std::basic_string_view<CharT> string_view) : type(toKeyType(to_buffer_array_type<CharT>)) {
+  std::memcpy(allocateBuffer(string_view.size() * sizeof(CharT)), string_view.data(), string_view.size() * sizeof(CharT));
+}
 
 template KeyValue::KeyValue(const std::basic_string_view<char>);
 template KeyValue::KeyValue(const std::basic_string_view<signed char>);
@@ -49,31 +368,55 @@ template KeyValue::KeyValue(const std::basic_string_view<char8_t>);
 template KeyValue::KeyValue(const std::basic_string_view<char16_t>);
 template KeyValue::KeyValue(const std::basic_string_view<char32_t>);
 
-KeyValue::KeyValue(const literals::ui8arr ui8_array)
-  : type(VarKeyType::ui8_array), data{.buffer_array_implementation = priv::BufferArrayImplementation::create(ui8_array)} {}
-KeyValue::KeyValue(const literals::i8arr i8_array)
-  : type(VarKeyType::si8_array), data{.buffer_array_implementation = priv::BufferArrayImplementation::create(i8_array)} {}
-KeyValue::KeyValue(const literals::ui16arr ui16_array)
-  : type(VarKeyType::ui16_array), data{.buffer_array_implementation = priv::BufferArrayImplementation::create(ui16_array)} {}
-KeyValue::KeyValue(const literals::i16arr i16_array)
-  : type(VarKeyType::si16_array), data{.buffer_array_implementation = priv::BufferArrayImplementation::create(i16_array)} {}
-KeyValue::KeyValue(const literals::ui32arr ui32_array)
-  : type(VarKeyType::ui32_array), data{.buffer_array_implementation = priv::BufferArrayImplementation::create(ui32_array)} {}
-KeyValue::KeyValue(const literals::i32arr i32_array)
-  : type(VarKeyType::si32_array), data{.buffer_array_implementation = priv::BufferArrayImplementation::create(i32_array)} {}
-KeyValue::KeyValue(const literals::f32arr f32_array)
-  : type(VarKeyType::f32_array), data{.buffer_array_implementation = priv::BufferArrayImplementation::create(f32_array)} {}
-KeyValue::KeyValue(const literals::ui64arr ui64_array)
-  : type(VarKeyType::ui64_array), data{.buffer_array_implementation = priv::BufferArrayImplementation::create(ui64_array)} {}
-KeyValue::KeyValue(const literals::i64arr i64_array)
-  : type(VarKeyType::si64_array), data{.buffer_array_implementation = priv::BufferArrayImplementation::create(i64_array)} {}
-KeyValue::KeyValue(const literals::f64arr f64_array)
-  : type(VarKeyType::f64_array), data{.buffer_array_implementation = priv::BufferArrayImplementation::create(f64_array)} {}
-KeyValue::KeyValue(const BufferArray& value) noexcept
-  : type(toKeyType(value.getValType())), data{.buffer_array_implementation = priv::BufferArrayImplementation::copy(value.getData())} {}
-KeyValue::KeyValue(BufferArray&& value) noexcept
-  : type(toKeyType(value.getValType())), data{.buffer_array_implementation = value.resource_link->data.buffer_array_implementation} {
-  value.resource_link->data.pointer = nullptr;
+KeyValue::KeyValue(const literals::ui8arr ui8_array) : type(VarKeyType::ui8_array) {
+  std::memcpy(allocateBuffer(ui8_array.size() * sizeof(*ui8_array.begin())), ui8_array.begin(), ui8_array.size() * sizeof(*ui8_array.begin()));
+}
+KeyValue::KeyValue(const literals::i8arr i8_array) : type(VarKeyType::si8_array) {
+  std::memcpy(allocateBuffer(i8_array.size() * sizeof(*i8_array.begin())), i8_array.begin(), i8_array.size() * sizeof(*i8_array.begin()));
+}
+KeyValue::KeyValue(const literals::ui16arr ui16_array) : type(VarKeyType::ui16_array) {
+  std::memcpy(allocateBuffer(ui16_array.size() * sizeof(*ui16_array.begin())), ui16_array.begin(), ui16_array.size() * sizeof(*ui16_array.begin()));
+}
+KeyValue::KeyValue(const literals::i16arr i16_array) : type(VarKeyType::si16_array) {
+  std::memcpy(allocateBuffer(i16_array.size() * sizeof(*i16_array.begin())), i16_array.begin(), i16_array.size() * sizeof(*i16_array.begin()));
+}
+KeyValue::KeyValue(const literals::ui32arr ui32_array) : type(VarKeyType::ui32_array) {
+  std::memcpy(allocateBuffer(ui32_array.size() * sizeof(*ui32_array.begin())), ui32_array.begin(), ui32_array.size() * sizeof(*ui32_array.begin()));
+}
+KeyValue::KeyValue(const literals::i32arr i32_array) : type(VarKeyType::si32_array) {
+  std::memcpy(allocateBuffer(i32_array.size() * sizeof(*i32_array.begin())), i32_array.begin(), i32_array.size() * sizeof(*i32_array.begin()));
+}
+KeyValue::KeyValue(const literals::f32arr f32_array) : type(VarKeyType::f32_array) {
+  std::memcpy(allocateBuffer(f32_array.size() * sizeof(*f32_array.begin())), f32_array.begin(), f32_array.size() * sizeof(*f32_array.begin()));
+}
+KeyValue::KeyValue(const literals::ui64arr ui64_array) : type(VarKeyType::ui64_array) {
+  std::memcpy(allocateBuffer(ui64_array.size() * sizeof(*ui64_array.begin())), ui64_array.begin(), ui64_array.size() * sizeof(*ui64_array.begin()));
+}
+KeyValue::KeyValue(const literals::i64arr i64_array) : type(VarKeyType::si64_array) {
+  std::memcpy(allocateBuffer(i64_array.size() * sizeof(*i64_array.begin())), i64_array.begin(), i64_array.size() * sizeof(*i64_array.begin()));
+}
+KeyValue::KeyValue(const literals::f64arr f64_array) : type(VarKeyType::f64_array) {
+  std::memcpy(allocateBuffer(f64_array.size() * sizeof(*f64_array.begin())), f64_array.begin(), f64_array.size() * sizeof(*f64_array.begin()));
+}
+KeyValue::KeyValue(const BufferArray& value) noexcept : type(toKeyType(value.getType())) {
+  const BufferArrayStorage& storage = value.getData();
+  const size_t size = BufferArrayImplementation::getSize(storage);
+  std::memcpy(allocateBuffer(size), BufferArrayImplementation::getData(storage), size);
+}
+KeyValue::KeyValue(BufferArray&& value) noexcept {
+  // Unique lock gives pending clones of value their own copy, so its implementation can be taken over
+  auto lk = value.getLock(MtxLockType::unique_locked);
+  if(!lk) return;
+  type = toKeyType(value.getType());
+  BufferArrayStorage& storage = value.resource_link->data.buffer_array_storage;
+  // Short data is copied inline, so allocated block is only taken over for long data not shared with clones
+  if(const size_t size = BufferArrayImplementation::getSize(storage);
+     size <= inline_capacity || value.resource_link.isCloneShared()) {
+    std::memcpy(allocateBuffer(size), BufferArrayImplementation::getData(storage), size);
+    return;
+  }
+  data.buffer_array_storage = storage;
+  storage = BufferArrayImplementation::create(VarBitWidth::byte, 0);
 }
 
 KeyValue::KeyValue(Variable variable) noexcept {
@@ -102,7 +445,13 @@ KeyValue::KeyValue(const KeyValue& value) noexcept : type(value.type) {
     data.bit_array_implementation = priv::BitArrayImplementation::copy(value.data.bit_array_implementation);
   return;
   case binom::VarTypeClass::buffer_array:
-    data.buffer_array_implementation = priv::BufferArrayImplementation::copy(value.data.buffer_array_implementation);
+    if(value.is_interned) {
+      is_interned = true;
+      data.interned_key = value.data.interned_key;
+      data.interned_key->link_counter.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    std::memcpy(allocateBuffer(value.getBufferSize()), value.getBufferData(), value.getBufferSize());
   return;
   case binom::VarTypeClass::invalid_type: default:  return;
   }
@@ -122,9 +471,14 @@ KeyValue::KeyValue(KeyValue&& value) noexcept : type(value.type) {
     value.type = VarKeyType::null;
   return;
   case binom::VarTypeClass::buffer_array:
-    data.buffer_array_implementation = value.data.buffer_array_implementation;
+    is_inline = value.is_inline;
+    is_interned = value.is_interned;
+    inline_size = value.inline_size;
+    data = value.data;
     value.data.pointer = nullptr;
     value.type = VarKeyType::null;
+    value.is_inline = false;
+    value.is_interned = false;
   return;
   case binom::VarTypeClass::invalid_type: default:  return;
   }
@@ -143,14 +497,57 @@ KeyValue::~KeyValue() {
     type = VarKeyType::null;
   return;
   case binom::VarTypeClass::buffer_array:
-    delete data.buffer_array_implementation;
+    if(is_interned) releaseInternedKey(data.interned_key);
+    elif(!is_inline) BufferArrayImplementation::destroy(data.buffer_array_storage);
     data.pointer = nullptr;
     type = VarKeyType::null;
+    is_inline = false;
+    is_interned = false;
   return;
   default: return;
   }
 }
 
+void* KeyValue::allocateBuffer(size_t size) {
+  if(size <= inline_capacity) {
+    is_inline = true;
+    inline_size = ui8(size);
+    return data.inline_data;
+  }
+  is_inline = false;
+  data.buffer_array_storage = BufferArrayImplementation::create(VarBitWidth::byte, size);
+  return BufferArrayImplementation::getData(data.buffer_array_storage);
+}
+
+const byte* KeyValue::getBufferData() const noexcept {
+  if(is_inline) return data.inline_data;
+  elif(is_interned) return data.interned_key->getData();
+  else return BufferArrayImplementation::getData(data.buffer_array_storage);
+}
+
+size_t KeyValue::getBufferSize() const noexcept {
+  if(is_inline) return inline_size;
+  elif(is_interned) return data.interned_key->size;
+  else return BufferArrayImplementation::getSize(data.buffer_array_storage);
+}
+
+KeyValue& KeyValue::intern() {
+  if(getTypeClass() != VarTypeClass::buffer_array || is_inline || is_interned) return self;
+  InternedKey* key = acquireInternedKey(getBufferData(), getBufferSize());
+  BufferArrayImplementation::destroy(data.buffer_array_storage);
+  data.interned_key = key;
+  is_interned = true;
+  return self;
+}
+
+bool KeyValue::isInterned() const noexcept {return is_interned;}
+
+size_t KeyValue::getInternedCount() {
+  InterningTable& table = getInterningTable();
+  std::scoped_lock lk(table.mtx);
+  return table.keys.size();
+}
+
 VarKeyType KeyValue::getType() const noexcept {return type;}
 VarTypeClass KeyValue::getTypeClass() const noexcept {return toTypeClass(type);}
 VarType KeyValue::getVarType() const noexcept {return toVarType(type);}
@@ -164,7 +561,7 @@ size_t KeyValue::getElementCount() const noexcept {
   case binom::VarTypeClass::null: return 0;
   case binom::VarTypeClass::number: return 1;
   case binom::VarTypeClass::bit_array: return data.bit_array_implementation->getBitSize();
-  case binom::VarTypeClass::buffer_array: return data.buffer_array_implementation->getSize();
+  case binom::VarTypeClass::buffer_array: return getBufferSize();
   }
 }
 
@@ -187,8 +584,8 @@ KeyValue::CompareResult KeyValue::getCompare(KeyValue& other) const {
   case binom::VarTypeClass::number: {
     GenericValue this_value(getValType(), arithmetic::ArithmeticData{.ui64_val = data.ui64_val}),
                  other_value(other.getValType(), arithmetic::ArithmeticData{.ui64_val = other.data.ui64_val});
-    if(this_value > other_value) return CompareResult::highter;
-    elif(this_value < other_value) return CompareResult::lower;
+    if(const int result = compareNumbers(this_value, other_value))
+      return result > 0 ? CompareResult::highter : CompareResult::lower;
     elif(type > other.type) return CompareResult::highter;
     elif(type < other.type) return CompareResult::lower;
     else return CompareResult::equal;
@@ -206,7 +603,7 @@ KeyValue::CompareResult KeyValue::getCompare(KeyValue& other) const {
         else return CompareResult::equal;
       }
       elif(other_it == other_end) return CompareResult::highter;
-      elif(this_it == other_end) return CompareResult::lower;
+      elif(this_it == this_end) return CompareResult::lower;
 
       if(bool(*this_it) > bool(*other_it)) return CompareResult::highter;
       elif(bool(*this_it) < bool(*other_it)) return CompareResult::lower;
@@ -217,10 +614,33 @@ KeyValue::CompareResult KeyValue::getCompare(KeyValue& other) const {
   }
 
   case binom::VarTypeClass::buffer_array:{
-    auto this_it = data.buffer_array_implementation->begin(getValType()),
-         this_end = data.buffer_array_implementation->end(getValType()),
-         other_it = other.data.buffer_array_implementation->begin(other.getValType()),
-         other_end = other.data.buffer_array_implementation->end(other.getValType());
+    // Same bytes of other element type can be ordered differently, so only equal types are short-circuited
+    if(is_interned && other.is_interned && data.interned_key == other.data.interned_key && type == other.type)
+      return CompareResult::equal;
+    if(type == other.type) {
+      const byte* this_buffer = getBufferData();
+      const byte* other_buffer = other.getBufferData();
+      const size_t this_size = getBufferSize(), other_size = other.getBufferSize();
+      switch (getValType()) {
+      case ValType::ui8: return compareElements<ui8>(this_buffer, this_size, other_buffer, other_size);
+      case ValType::si8: return compareElements<i8>(this_buffer, this_size, other_buffer, other_size);
+      case ValType::ui16: return compareElements<ui16>(this_buffer, this_size, other_buffer, other_size);
+      case ValType::si16: return compareElements<i16>(this_buffer, this_size, other_buffer, other_size);
+      case ValType::ui32: return compareElements<ui32>(this_buffer, this_size, other_buffer, other_size);
+      case ValType::si32: return compareElements<i32>(this_buffer, this_size, other_buffer, other_size);
+      case ValType::f32: return compareElements<f32>(this_buffer, this_size, other_buffer, other_size);
+      case ValType::ui64: return compareElements<ui64>(this_buffer, this_size, other_buffer, other_size);
+      case ValType::si64: return compareElements<i64>(this_buffer, this_size, other_buffer, other_size);
+      case ValType::f64: return compareElements<f64>(this_buffer, this_size, other_buffer, other_size);
+      default: break;
+      }
+    }
+    byte* this_data = const_cast<byte*>(getBufferData());
+    byte* other_data = const_cast<byte*>(other.getBufferData());
+    auto this_it = GenericValueIterator(getValType(), this_data),
+         this_end = GenericValueIterator(getValType(), this_data + getBufferSize()),
+         other_it = GenericValueIterator(other.getValType(), other_data),
+         other_end = GenericValueIterator(other.getValType(), other_data + other.getBufferSize());
     forever {
       if(this_it == this_end && other_it == other_end) {
         if(type > other.type) return CompareResult::highter;
@@ -228,10 +648,10 @@ KeyValue::CompareResult KeyValue::getCompare(KeyValue& other) const {
         else return CompareResult::equal;
       }
       elif(other_it == other_end) return CompareResult::highter;
-      elif(this_it == other_end) return CompareResult::lower;
+      elif(this_it == this_end) return CompareResult::lower;
 
-      if(*this_it > *other_it) return CompareResult::highter;
-      elif(*this_it < *other_it) return CompareResult::lower;
+      if(const int result = compareNumbers(*this_it, *other_it))
+        return result > 0 ? CompareResult::highter : CompareResult::lower;
 
       ++this_it;
       ++other_it;
@@ -245,6 +665,167 @@ KeyValue::CompareResult KeyValue::getCompare(KeyValue& other) const {
   }
 }
 
+std::vector<byte> KeyValue::getComparableEncoding() const {
+  std::vector<byte> encoding;
+  appendComparableEncoding(encoding);
+  return encoding;
+}
+
+void KeyValue::appendComparableEncoding(std::vector<byte>& encoding) const {
+  encoding.push_back(byte(getTypeClass()));
+  switch (getTypeClass()) {
+
+  case binom::VarTypeClass::number:
+    encoding.reserve(encoding.size() + encoded_number_size + 1);
+    writeNumber(encoding, GenericValue(getValType(), arithmetic::ArithmeticData{.ui64_val = data.ui64_val}));
+  break;
+
+  // Each element is preceded by 1 and sequence is ended by 0, so prefix goes before longer sequence
+  case binom::VarTypeClass::bit_array:
+    encoding.reserve(encoding.size() + getElementCount() + 2);
+    for(auto it = data.bit_array_implementation->begin(), end = data.bit_array_implementation->end(); it != end; ++it)
+      encoding.push_back(bool(*it) ? 2 : 1);
+    encoding.push_back(0);
+  break;
+
+  case binom::VarTypeClass::buffer_array: {
+    byte* buffer_data = const_cast<byte*>(getBufferData());
+    encoding.reserve(encoding.size() + getBufferSize() / size_t(getBitWidth()) * (encoded_number_size + 1) + 2);
+    for(auto it = GenericValueIterator(getValType(), buffer_data), end = GenericValueIterator(getValType(), buffer_data + getBufferSize());
+        it != end; ++it) {
+      encoding.push_back(1);
+      writeNumber(encoding, *it);
+    }
+    encoding.push_back(0);
+  } break;
+
+  case binom::VarTypeClass::null:
+  case binom::VarTypeClass::invalid_type: default:
+  return;
+  }
+  // Keys with equal values are ordered by type
+  encoding.push_back(byte(type));
+}
+
+ui64 KeyValue::getComparablePrefix() const noexcept {
+  ui64 prefix = ui64(getTypeClass()) << 56;
+  switch (getTypeClass()) {
+
+  case binom::VarTypeClass::number:
+    return prefix | getComparableNumberBits(GenericValue(getValType(), arithmetic::ArithmeticData{.ui64_val = data.ui64_val})) >> 8;
+
+  // The same bytes as in comparable encoding
+  case binom::VarTypeClass::bit_array: {
+    int shift = 48;
+    for(auto it = data.bit_array_implementation->begin(), end = data.bit_array_implementation->end(); it != end && shift >= 0; ++it, shift -= 8)
+      prefix |= ui64(bool(*it) ? 2 : 1) << shift;
+  } return prefix;
+
+  case binom::VarTypeClass::buffer_array: {
+    byte* buffer_data = const_cast<byte*>(getBufferData());
+    int shift = 48;
+    bool is_exact = true;
+    for(auto it = GenericValueIterator(getValType(), buffer_data), end = GenericValueIterator(getValType(), buffer_data + getBufferSize());
+        it != end && shift >= 0 && is_exact; ++it, shift -= 8)
+      prefix |= ui64(getPrefixElementCode(*it, is_exact)) << shift;
+  } return prefix;
+
+  case binom::VarTypeClass::null:
+  case binom::VarTypeClass::invalid_type: default:
+  return prefix;
+  }
+}
+
+KeyValue KeyValue::fromComparableEncoding(const byte* encoding, size_t size) {
+  if(!size) throw err::Error(err::ErrorType::invalid_data);
+  const VarTypeClass type_class = VarTypeClass(encoding[0]);
+  if(type_class == VarTypeClass::null) {
+    if(size != 1) throw err::Error(err::ErrorType::invalid_data);
+    return KeyValue();
+  }
+  const VarKeyType key_type = VarKeyType(encoding[size - 1]);
+  if(size < 2 || toTypeClass(key_type) != type_class) throw err::Error(err::ErrorType::invalid_data);
+  const byte* it = encoding + 1;
+  const byte* const end = encoding + size - 1;
+  KeyValue key;
+
+  switch (type_class) {
+
+  case binom::VarTypeClass::number:
+    if(size_t(end - it) != encoded_number_size) throw err::Error(err::ErrorType::invalid_data);
+    key.type = key_type;
+    readNumber(it, *GenericValueIterator(key.getValType(), reinterpret_cast<byte*>(&key.data.ui64_val)));
+  return key;
+
+  case binom::VarTypeClass::bit_array: {
+    const byte* const bits_end = std::find(it, end, 0);
+    if(end - bits_end != 1) throw err::Error(err::ErrorType::invalid_data);
+    key.type = key_type;
+    // Zeroed padding of last byte keeps serialization of decoded key equal to original
+    key.data.bit_array_implementation = priv::BitArrayImplementation::createZeroed(size_t(bits_end - it));
+    for(size_t i = 0; it != bits_end; ++it, ++i) (*key.data.bit_array_implementation)[i] = *it == 2;
+  } return key;
+
+  case binom::VarTypeClass::buffer_array: {
+    if((end - it - 1) % (encoded_number_size + 1) || end[-1]) throw err::Error(err::ErrorType::invalid_data);
+    key.type = key_type;
+    const size_t count = size_t(end - it - 1) / (encoded_number_size + 1), element_size = size_t(key.getBitWidth());
+    byte* buffer_data = static_cast<byte*>(key.allocateBuffer(count * element_size));
+    for(size_t i = 0; i < count; ++i, it += encoded_number_size + 1) {
+      if(*it != 1) throw err::Error(err::ErrorType::invalid_data);
+      readNumber(it + 1, *GenericValueIterator(key.getValType(), buffer_data + i * element_size));
+    }
+  } return key;
+
+  case binom::VarTypeClass::null:
+  case binom::VarTypeClass::invalid_type: default:
+  throw err::Error(err::ErrorType::invalid_data);
+  }
+}
+
+size_t KeyValue::getHash() const noexcept {
+  const ui64 seed = ui64(type) * golden_ratio;
+  switch (getTypeClass()) {
+
+  case binom::VarTypeClass::number:
+    switch (type) {
+    case VarKeyType::boolean: case VarKeyType::ui8: case VarKeyType::si8: return mixHash(seed + data.ui8_val);
+    case VarKeyType::ui16: case VarKeyType::si16: return mixHash(seed + data.ui16_val);
+    case VarKeyType::ui32: case VarKeyType::si32: return mixHash(seed + data.ui32_val);
+    case VarKeyType::f32: return mixHash(seed + getComparedBits(data.f32_val));
+    case VarKeyType::f64: return mixHash(seed + getComparedBits(data.f64_val));
+    default: return mixHash(seed + data.ui64_val);
+    }
+
+  case binom::VarTypeClass::bit_array: {
+    const size_t bit_size = data.bit_array_implementation->getBitSize();
+    const byte* bytes = static_cast<const byte*>(data.bit_array_implementation->getDataPointer());
+    const ui64 hash = hashBytes(bytes, bit_size / 8, seed ^ bit_size);
+    // Unused bits of last byte aren't compared
+    if(!(bit_size % 8)) return hash;
+    return mixHash(hash ^ (bytes[bit_size / 8] & ((1 << (bit_size % 8)) - 1)));
+  }
+
+  case binom::VarTypeClass::buffer_array: {
+    byte* buffer_data = const_cast<byte*>(getBufferData());
+    switch (type) {
+    case VarKeyType::f32_array: case VarKeyType::f64_array: {
+      ui64 hash = seed;
+      for(auto it = GenericValueIterator(getValType(), buffer_data), end = GenericValueIterator(getValType(), buffer_data + getBufferSize());
+          it != end; ++it)
+        hash = (hash ^ mixHash(type == VarKeyType::f32_array ? getComparedBits(f32(*it)) : getComparedBits(f64(*it)))) * golden_ratio;
+      return mixHash(hash);
+    }
+    default: return hashBytes(buffer_data, getBufferSize(), seed);
+    }
+  }
+
+  case binom::VarTypeClass::null:
+  case binom::VarTypeClass::invalid_type: default:
+  return 0;
+  }
+}
+
 Variable KeyValue::toVariable() const {
   switch (getTypeClass()) {
   default:
@@ -268,9 +849,10 @@ BitArray KeyValue::toBitArray() const {
 }
 
 BufferArray KeyValue::toBufferArray() const {
-  if(getTypeClass() == VarTypeClass::buffer_array)
-    return BufferArray(priv::Link(ResourceData{getVarType(), {.buffer_array_implementation = priv::BufferArrayImplementation::copy(data.buffer_array_implementation)}}));
-  else return BufferArray();
+  if(getTypeClass() != VarTypeClass::buffer_array) return BufferArray();
+  ResourceData resource_data{getVarType(), {.buffer_array_storage = BufferArrayImplementation::create(getBitWidth(), getBufferSize() / size_t(getBitWidth()))}};
+  std::memcpy(BufferArrayImplementation::getData(resource_data.data.buffer_array_storage), getBufferData(), getBufferSize());
+  return BufferArray(priv::Link(resource_data));
 }
 
 KeyValue::operator Variable() const {return toVariable();}
@@ -70,73 +70,73 @@ void List::clear() {
 }
 
 List::Iterator List::begin() {
-  if(auto lk = getLock(MtxLockType::shared_locked); lk)
+  if(auto lk = getElementAccessLock(); lk)
     return getData()->begin();
   else return Iterator(nullptr);
 }
 
 List::Iterator List::end() {
-  if(auto lk = getLock(MtxLockType::shared_locked); lk)
+  if(auto lk = getElementAccessLock(); lk)
     return getData()->end();
   else return Iterator(nullptr);
 }
 
 List::ConstIterator List::begin() const {
-  if(auto lk = getLock(MtxLockType::shared_locked); lk)
+  if(auto lk = getElementLinkLock(); lk)
     return getData()->begin();
   else return Iterator(nullptr);
 }
 
 List::ConstIterator List::end() const {
-  if(auto lk = getLock(MtxLockType::shared_locked); lk)
+  if(auto lk = getElementLinkLock(); lk)
     return getData()->end();
   else return Iterator(nullptr);
 }
 
 List::ReverseIterator List::rbegin() {
-  if(auto lk = getLock(MtxLockType::shared_locked); lk)
+  if(auto lk = getElementAccessLock(); lk)
     return getData()->rbegin();
   else return ReverseIterator(Iterator(nullptr));
 }
 
 List::ReverseIterator List::rend() {
-  if(auto lk = getLock(MtxLockType::shared_locked); lk)
+  if(auto lk = getElementAccessLock(); lk)
     return getData()->rend();
   else return ReverseIterator(Iterator(nullptr));
 }
 
 List::ConstReverseIterator List::rbegin() const {
-  if(auto lk = getLock(MtxLockType::shared_locked); lk)
+  if(auto lk = getElementLinkLock(); lk)
     return getData()->rbegin();
   else return ConstReverseIterator(Iterator(nullptr));
 }
 
 List::ConstReverseIterator List::rend() const {
-  if(auto lk = getLock(MtxLockType::shared_locked); lk)
+  if(auto lk = getElementLinkLock(); lk)
     return getData()->rend();
   else return ConstReverseIterator(Iterator(nullptr));
 }
 
 List::ConstIterator List::cbegin() const {
-  if(auto lk = getLock(MtxLockType::shared_locked); lk)
+  if(auto lk = getElementLinkLock(); lk)
     return getData()->begin();
   else return Iterator(nullptr);
 }
 
 List::ConstIterator List::cend() const {
-  if(auto lk = getLock(MtxLockType::shared_locked); lk)
+  if(auto lk = getElementLinkLock(); lk)
     return getData()->cend();
   else return Iterator(nullptr);
 }
 
 List::ConstReverseIterator List::crbegin() const {
-  if(auto lk = getLock(MtxLockType::shared_locked); lk)
+  if(auto lk = getElementLinkLock(); lk)
     return getData()->crbegin();
   else return ConstReverseIterator(Iterator(nullptr));
 }
 
 List::ConstReverseIterator List::crend() const {
-  if(auto lk = getLock(MtxLockType::shared_locked); lk)
+  if(auto lk = getElementLinkLock(); lk)
     return getData()->crend();
   else return ConstReverseIterator(Iterator(nullptr));
 }
@@ -66,97 +66,149 @@ err::ProgressReport<Map::NamedVariable> Map::rename(KeyValue old_key, KeyValue n
 }
 
 Variable Map::getVariable(KeyValue key) {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementLinkLock();
   if(!lk) return nullptr;
   return getData()->getVariable(std::move(key));
 }
 
 Variable Map::operator[](KeyValue key) {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getLock(MtxLockType::unique_locked);
   if(!lk) return nullptr;
   return getData()->getOrInsertNamedVariable(std::move(key)).getVariable().move();
 }
 
 Map::Iterator Map::find(KeyValue key) {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementAccessLock();
   if(!lk) return Iterator::nullit();
   return getData()->find(std::move(key));
 }
 
 Map::ReverseIterator Map::rfind(KeyValue key) {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementAccessLock();
   if(!lk) return ReverseIterator::nullit();
   return getData()->rfind(std::move(key));
 }
 
 Map::ConstIterator Map::find(KeyValue key) const {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementLinkLock();
   if(!lk) return ConstIterator::nullit();
   return getData()->find(std::move(key));
 }
 
 Map::ConstReverseIterator Map::rfind(KeyValue key) const {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementLinkLock();
   if(!lk) return ConstReverseIterator::nullit();
   return getData()->rfind(std::move(key));
 }
 
-const Variable Map::getVariable(KeyValue key) const {
+Map::Iterator Map::select(size_t index) {
+  auto lk = getElementAccessLock();
+  if(!lk) return Iterator::nullit();
+  return getData()->select(index);
+}
+
+Map::ConstIterator Map::select(size_t index) const {
+  auto lk = getElementLinkLock();
+  if(!lk) return ConstIterator::nullit();
+  return getData()->select(index);
+}
+
+size_t Map::rank(KeyValue key) const {
   auto lk = getLock(MtxLockType::shared_locked);
+  if(!lk) return 0;
+  return getData()->rank(std::move(key));
+}
+
+size_t Map::countRange(KeyValue first, KeyValue last) const {
+  auto lk = getLock(MtxLockType::shared_locked);
+  if(!lk) return 0;
+  return getData()->countRange(std::move(first), std::move(last));
+}
+
+Map Map::split(KeyValue key) {
+  Map upper;
+  auto lk = getLock(MtxLockType::unique_locked);
+  if(!lk) return upper;
+  getData()->split(std::move(key), *upper.getData());
+  return upper;
+}
+
+Error Map::join(Map& other) {
+  if(this == &other) return isEmpty() ? err::ErrorType::no_error : err::ErrorType::invalid_data;
+  // Both maps are locked at once, so joins of the same maps in opposite directions don't deadlock
+  auto transaction = makeTransaction({self, other});
+  auto lk = getLock(MtxLockType::unique_locked);
+  auto other_lk = other.getLock(MtxLockType::unique_locked);
+  if(!lk || !other_lk) return err::ErrorType::binom_resource_not_available;
+  return getData()->join(*other.getData());
+}
+
+size_t Map::eraseRange(KeyValue first, KeyValue last) {
+  auto lk = getLock(MtxLockType::unique_locked);
+  if(!lk) return 0;
+  return getData()->eraseRange(std::move(first), std::move(last));
+}
+
+void Map::shrinkToFit() {
+  if(auto lk = getLock(MtxLockType::unique_locked); lk) getData()->shrinkToFit();
+}
+
+const Variable Map::getVariable(KeyValue key) const {
+  auto lk = getElementLinkLock();
   if(!lk) return nullptr;
   return getData()->getVariable(std::move(key));
 }
 
 const Variable Map::operator[](KeyValue key) const {
-  auto lk = getLock(MtxLockType::unique_locked);
+  auto lk = getElementLinkLock();
   if(!lk) return nullptr;
   return getData()->getVariable(std::move(key));
 }
 
 Map::Iterator Map::begin() {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementAccessLock();
   if(!lk) return Iterator::nullit();
   return getData()->begin();
 }
 
 Map::Iterator Map::end() {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementAccessLock();
   if(!lk) return Iterator::nullit();
   return getData()->end();
 }
 
 Map::ReverseIterator Map::rbegin() {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementAccessLock();
   if(!lk) return ReverseIterator::nullit();
   return getData()->rbegin();
 }
 
 Map::ReverseIterator Map::rend() {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementAccessLock();
   if(!lk) return ReverseIterator::nullit();
   return getData()->rend();
 }
 
 Map::ConstIterator Map::begin() const noexcept {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementLinkLock();
   if(!lk) return ConstIterator::nullit();
   return getData()->cbegin();
 }
 
 Map::ConstIterator Map::end() const noexcept {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementLinkLock();
   if(!lk) return ConstIterator::nullit();
   return getData()->cend();
 }
 
 Map::ConstReverseIterator Map::rbegin() const noexcept {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementLinkLock();
   if(!lk) return ConstReverseIterator::nullit();
   return getData()->crbegin();
 }
 
 Map::ConstReverseIterator Map::rend() const noexcept {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementLinkLock();
   if(!lk) return ConstReverseIterator::nullit();
   return getData()->crend();
 }
@@ -166,7 +218,7 @@ Map& Map::operator=(const Map& other) {
   if(this == &other) return self;
   auto lk = getLock(MtxLockType::unique_locked);
   if(!lk) return self;
-  resource_link.overwriteWithResourceCopy(**other.resource_link);
+  resource_link.overwriteWithResourceCopy(other.resource_link);
   return self;
 }
 
@@ -174,7 +226,7 @@ Map& Map::operator=(Map&& other) {
   if(this == &other) return self;
   auto lk = getLock(MtxLockType::unique_locked);
   if(!lk) return self;
-  resource_link.overwriteWithResourceCopy(**other.resource_link);
+  resource_link.overwriteWithResourceCopy(other.resource_link);
   return self;
 }
 
@@ -0,0 +1,67 @@
+#include "libbinom/include/variables/mapped_storage.hxx"
+
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace binom;
+using namespace binom::priv;
+
+MappedStorage::MappedStorage(const std::string& path)
+  : file(MappedFile::open(path)), root(Link(file, file->getIndex(file->getRootView()))) {}
+
+MappedStorage::MappedStorage(const MappedStorage& other) noexcept
+  : file(other.file), root(other.root.move()) {
+  if(file) file->acquire();
+}
+
+MappedStorage::MappedStorage(MappedStorage&& other) noexcept
+  : file(other.file), root(std::move(other.root)) {
+  other.file = nullptr;
+}
+
+MappedStorage::~MappedStorage() {
+  if(file) file->release();
+}
+
+Variable MappedStorage::getRoot() noexcept {return root.move();}
+
+View MappedStorage::getView() const {
+  if(!file) throw err::Error(err::ErrorType::binom_resource_not_available);
+  return file->getRootView();
+}
+
+size_t MappedStorage::getFileSize() const noexcept {return file ? file->getSize() : 0;}
+size_t MappedStorage::getMaterializedNodeCount() const noexcept {return file ? file->getMaterializedCount() : 0;}
+size_t MappedStorage::getErrorCount() const noexcept {return file ? file->getErrorCount() : 0;}
+bool MappedStorage::verify() const {return file && file->verify();}
+void MappedStorage::materialize(const Variable& node) {node.resource_link.materialize();}
+
+void MappedStorage::write(const std::string& path, const Variable& variable) {
+  const std::vector<byte> data = variable.serialize();
+  // Existing mappings of path keep old file
+  const std::string temp_path = path + ".tmp";
+  const int file_descriptor = ::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if(file_descriptor < 0) throw err::Error(err::ErrorType::file_open_error);
+
+  const byte* it = data.data();
+  size_t size = data.size();
+  while(size) {
+    const ssize_t written = ::write(file_descriptor, it, size);
+    if(written < 0) {
+      if(errno == EINTR) continue;
+      ::close(file_descriptor);
+      ::unlink(temp_path.c_str());
+      throw err::Error(err::ErrorType::file_write_error);
+    }
+    it += written;
+    size -= written;
+  }
+
+  const bool is_synced = !::fsync(file_descriptor);
+  if(::close(file_descriptor) || !is_synced || std::rename(temp_path.c_str(), path.c_str())) {
+    ::unlink(temp_path.c_str());
+    throw err::Error(err::ErrorType::file_write_error);
+  }
+}
@@ -105,133 +105,185 @@ std::pair<MultiMap::ConstReverseIterator, MultiMap::ConstReverseIterator> MultiM
 }
 
 MultiMap::Iterator MultiMap::find(KeyValue key) {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementAccessLock();
   if(!lk) return Iterator::nullit();
   return getData()->find(std::move(key));
 }
 
 MultiMap::ReverseIterator MultiMap::rfind(KeyValue key) {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementAccessLock();
   if(!lk) return ReverseIterator::nullit();
   return getData()->rfind(std::move(key));
 }
 
 MultiMap::Iterator MultiMap::findLast(KeyValue key) {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementAccessLock();
   if(!lk) return Iterator::nullit();
   return getData()->findLast(std::move(key));
 }
 
 MultiMap::ReverseIterator MultiMap::rfindLast(KeyValue key) {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementAccessLock();
   if(!lk) return ReverseIterator::nullit();
   return getData()->rfindLast(std::move(key));
 }
 
 MultiMap::ConstIterator MultiMap::find(KeyValue key) const {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementLinkLock();
   if(!lk) return ConstIterator::nullit();
   return getData()->find(std::move(key));
 }
 
 MultiMap::ConstReverseIterator MultiMap::rfind(KeyValue key) const {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementLinkLock();
   if(!lk) return ConstReverseIterator::nullit();
   return getData()->rfind(std::move(key));
 }
 
 MultiMap::ConstIterator MultiMap::findLast(KeyValue key) const {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementLinkLock();
   if(!lk) return ConstIterator::nullit();
   return getData()->findLast(std::move(key));
 }
 
 MultiMap::ConstReverseIterator MultiMap::rfindLast(KeyValue key) const {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementLinkLock();
   if(!lk) return ConstReverseIterator::nullit();
   return getData()->rfindLast(std::move(key));
 }
 
-MultiMap::Iterator MultiMap::operator[](KeyValue key) noexcept {
+MultiMap::Iterator MultiMap::select(size_t index) {
+  auto lk = getElementAccessLock();
+  if(!lk) return Iterator::nullit();
+  return getData()->select(index);
+}
+
+MultiMap::ConstIterator MultiMap::select(size_t index) const {
+  auto lk = getElementLinkLock();
+  if(!lk) return ConstIterator::nullit();
+  return getData()->select(index);
+}
+
+size_t MultiMap::rank(KeyValue key) const {
+  auto lk = getLock(MtxLockType::shared_locked);
+  if(!lk) return 0;
+  return getData()->rank(std::move(key));
+}
+
+size_t MultiMap::countRange(KeyValue first, KeyValue last) const {
   auto lk = getLock(MtxLockType::shared_locked);
+  if(!lk) return 0;
+  return getData()->countRange(std::move(first), std::move(last));
+}
+
+MultiMap MultiMap::split(KeyValue key) {
+  MultiMap upper;
+  auto lk = getLock(MtxLockType::unique_locked);
+  if(!lk) return upper;
+  getData()->split(std::move(key), *upper.getData());
+  return upper;
+}
+
+Error MultiMap::join(MultiMap& other) {
+  if(this == &other) return isEmpty() ? err::ErrorType::no_error : err::ErrorType::invalid_data;
+  // Both multimaps are locked at once, so joins of the same multimaps in opposite directions don't deadlock
+  auto transaction = makeTransaction({self, other});
+  auto lk = getLock(MtxLockType::unique_locked);
+  auto other_lk = other.getLock(MtxLockType::unique_locked);
+  if(!lk || !other_lk) return err::ErrorType::binom_resource_not_available;
+  return getData()->join(*other.getData());
+}
+
+size_t MultiMap::eraseRange(KeyValue first, KeyValue last) {
+  auto lk = getLock(MtxLockType::unique_locked);
+  if(!lk) return 0;
+  return getData()->eraseRange(std::move(first), std::move(last));
+}
+
+void MultiMap::shrinkToFit() {
+  if(auto lk = getLock(MtxLockType::unique_locked); lk) getData()->shrinkToFit();
+}
+
+MultiMap::Iterator MultiMap::operator[](KeyValue key) noexcept {
+  auto lk = getElementAccessLock();
   if(!lk) return Iterator::nullit();
   return getData()->find(std::move(key));
 }
 
 MultiMap::ConstIterator MultiMap::operator[](KeyValue key) const noexcept {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementLinkLock();
   if(!lk) return ConstIterator::nullit();
   return getData()->find(std::move(key));
 }
 
 MultiMap::Iterator MultiMap::begin() {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementAccessLock();
   if(!lk) return Iterator::nullit();
   return getData()->begin();
 }
 
 MultiMap::Iterator MultiMap::end() {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementAccessLock();
   if(!lk) return Iterator::nullit();
   return getData()->end();
 }
 
 MultiMap::ReverseIterator MultiMap::rbegin() {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementAccessLock();
   if(!lk) return ReverseIterator::nullit();
   return getData()->rbegin();
 }
 
 MultiMap::ReverseIterator MultiMap::rend() {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementAccessLock();
   if(!lk) return ReverseIterator::nullit();
   return getData()->rend();
 }
 
 MultiMap::ConstIterator MultiMap::begin() const noexcept {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementLinkLock();
   if(!lk) return ConstIterator::nullit();
   return getData()->cbegin();
 }
 
 MultiMap::ConstIterator MultiMap::end() const noexcept {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementLinkLock();
   if(!lk) return ConstIterator::nullit();
   return getData()->cend();
 }
 
 MultiMap::ConstIterator MultiMap::cbegin() const noexcept {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementLinkLock();
   if(!lk) return ConstIterator::nullit();
   return getData()->cbegin();
 }
 
 MultiMap::ConstIterator MultiMap::cend() const noexcept {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementLinkLock();
   if(!lk) return ConstIterator::nullit();
   return getData()->cend();
 }
 
 MultiMap::ConstReverseIterator MultiMap::rbegin() const noexcept {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementLinkLock();
   if(!lk) return ConstReverseIterator::nullit();
   return getData()->crbegin();
 }
 
 MultiMap::ConstReverseIterator MultiMap::rend() const noexcept {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementLinkLock();
   if(!lk) return ConstReverseIterator::nullit();
   return getData()->crend();
 }
 
 MultiMap::ConstReverseIterator MultiMap::crbegin() const noexcept {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementLinkLock();
   if(!lk) return ConstReverseIterator::nullit();
   return getData()->crbegin();
 }
 
 MultiMap::ConstReverseIterator MultiMap::crend() const noexcept {
-  auto lk = getLock(MtxLockType::shared_locked);
+  auto lk = getElementLinkLock();
   if(!lk) return ConstReverseIterator::nullit();
   return getData()->crend();
 }
@@ -240,7 +292,7 @@ MultiMap& MultiMap::operator=(const MultiMap& other) {
   if(this == &other) return self;
   auto lk = getLock(MtxLockType::unique_locked);
   if(!lk) return self;
-  resource_link.overwriteWithResourceCopy(**other.resource_link);
+  resource_link.overwriteWithResourceCopy(other.resource_link);
   return self;
 }
 
@@ -248,7 +300,7 @@ MultiMap& MultiMap::operator=(MultiMap&& other) {
   if(this == &other) return self;
   auto lk = getLock(MtxLockType::unique_locked);
   if(!lk) return self;
-  resource_link.overwriteWithResourceCopy(**other.resource_link);
+  resource_link.overwriteWithResourceCopy(other.resource_link);
   return self;
 }
 
@@ -4,13 +4,24 @@ using namespace binom;
 using namespace binom::priv;
 
 arithmetic::ArithmeticData& Number::getArithmeticDataImpl() const {return *reinterpret_cast<arithmetic::ArithmeticData*>(&resource_link->data);}
+Number::DataWriter Number::getArithmeticDataWriterImpl() const {return DataWriter(resource_link->data.ui64_val);}
 ValType Number::getValTypeImpl() const {return getValType();}
+
+GenericValue Number::getValueImpl() const noexcept {
+  const ResourceData resource_data = resource_link.readOptimistic();
+  if(toTypeClass(resource_data.type) != VarTypeClass::number) return GenericValue(ValType::invalid_type, {.ui64_val = 0});
+  return GenericValue(toValueType(resource_data.type), {.ui64_val = resource_data.data.ui64_val});
+}
 bool Number::checkLock(const OptionalSharedRecursiveLock& lock) noexcept {return lock.has_value();}
 
 void Number::setTypeImpl(ValType new_type) noexcept {
-  resource_link->type = toVarType(new_type);
+  std::atomic_ref(resource_link->type).store(toVarType(new_type), std::memory_order_relaxed);
 }
 
+Number::DataWriter::DataWriter(ui64& value) noexcept : value(value), data{.ui64_val = value} {}
+
+Number::DataWriter::~DataWriter() {std::atomic_ref(value).store(data.ui64_val, std::memory_order_relaxed);}
+
 Number::Number(priv::Link&& link) noexcept :          Variable(std::move(link)) {}
 Number::Number()           noexcept :                 Variable(FNaN) {}
 Number::Number(bool value) noexcept :                 Variable(value) {}
@@ -0,0 +1,247 @@
+#include "libbinom/include/variables/persistent_array.hxx"
+#include "libbinom/include/variables/array.hxx"
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+using namespace binom;
+using namespace binom::priv;
+
+//! Node is immutable after creation, it's shared by all versions containing it
+struct binom::priv::PersistentArrayNode {
+  mutable std::atomic_size_t link_counter = 1;
+  std::vector<PersistentArrayNode*> children; ///< Nodes of next level, empty in leaf
+  std::vector<Variable> values;               ///< Elements of leaf
+
+  ~PersistentArrayNode();
+};
+
+namespace {
+
+typedef PersistentArrayNode Node;
+constexpr size_t node_bit_count = PersistentArray::node_bit_count;
+constexpr size_t node_capacity = PersistentArray::node_capacity;
+constexpr size_t index_mask = node_capacity - 1;
+
+Node* acquire(Node* node) noexcept {
+  if(node) node->link_counter.fetch_add(1, std::memory_order_relaxed);
+  return node;
+}
+
+void release(Node* node) noexcept {
+  if(node && node->link_counter.fetch_sub(1, std::memory_order_acq_rel) == 1) delete node;
+}
+
+// Functions below return owned node, elements of nodes are shared between versions by reference
+
+//! Nodes from level of shift down to leaf with single element
+Node* createPath(size_t shift, Variable& value) {
+  Node* node = new Node();
+  if(!shift) node->values.push_back(value.move());
+  else node->children.push_back(createPath(shift - node_bit_count, value));
+  return node;
+}
+
+//! Builds levels over nodes until single root is left
+Node* buildRoot(std::vector<Node*> level, size_t& shift) {
+  shift = 0;
+  if(level.empty()) return nullptr;
+  while(level.size() > 1) {
+    std::vector<Node*> parent_level;
+    parent_level.reserve((level.size() + index_mask) / node_capacity);
+    for(size_t i = 0; i < level.size(); i += node_capacity) {
+      Node* parent = new Node();
+      parent->children.assign(level.begin() + i, level.begin() + std::min(i + node_capacity, level.size()));
+      parent_level.push_back(parent);
+    }
+    level = std::move(parent_level);
+    shift += node_bit_count;
+  }
+  return level.front();
+}
+
+Node* pushNode(Node* node, size_t shift, size_t index, Variable& value) {
+  Node* copy = new Node();
+  if(!shift) {
+    copy->values.reserve(node->values.size() + 1);
+    for(Variable& element : node->values) copy->values.push_back(element.move());
+    copy->values.push_back(value.move());
+    return copy;
+  }
+  const size_t child_index = (index >> shift) & index_mask;
+  copy->children.reserve(child_index + 1);
+  for(size_t i = 0; i < child_index; ++i) copy->children.push_back(acquire(node->children[i]));
+  if(child_index < node->children.size())
+    copy->children.push_back(pushNode(node->children[child_index], shift - node_bit_count, index, value));
+  else copy->children.push_back(createPath(shift - node_bit_count, value));
+  return copy;
+}
+
+//! Removes element of last index, returns nullptr if node becomes empty
+Node* popNode(Node* node, size_t shift, size_t index) {
+  if(!shift) {
+    if(node->values.size() == 1) return nullptr;
+    Node* copy = new Node();
+    copy->values.reserve(node->values.size() - 1);
+    for(size_t i = 0; i < node->values.size() - 1; ++i) copy->values.push_back(node->values[i].move());
+    return copy;
+  }
+  const size_t child_index = (index >> shift) & index_mask;
+  Node* child = popNode(node->children[child_index], shift - node_bit_count, index);
+  if(!child && !child_index) return nullptr;
+  Node* copy = new Node();
+  copy->children.reserve(child_index + 1);
+  for(size_t i = 0; i < child_index; ++i) copy->children.push_back(acquire(node->children[i]));
+  if(child) copy->children.push_back(child);
+  return copy;
+}
+
+Node* setNode(Node* node, size_t shift, size_t index, Variable& value) {
+  Node* copy = new Node();
+  if(!shift) {
+    const size_t value_index = index & index_mask;
+    copy->values.reserve(node->values.size());
+    for(size_t i = 0; i < node->values.size(); ++i)
+      copy->values.push_back(i == value_index ? value.move() : node->values[i].move());
+    return copy;
+  }
+  const size_t child_index = (index >> shift) & index_mask;
+  copy->children.reserve(node->children.size());
+  for(size_t i = 0; i < node->children.size(); ++i)
+    copy->children.push_back(i == child_index
+                             ? setNode(node->children[i], shift - node_bit_count, index, value)
+                             : acquire(node->children[i]));
+  return copy;
+}
+
+}
+
+PersistentArrayNode::~PersistentArrayNode() {
+  for(Node* child : children) release(child);
+}
+
+//////////////////////////////////////////////////////////// ConstIterator ////////////////////////////////////////////////////////
+
+PersistentArray::ConstIterator::ConstIterator(const PersistentArray* array, size_t index) noexcept
+  : array(array), leaf(index < array->element_count ? array->getLeaf(index) : nullptr), index(index) {}
+
+PersistentArray::ConstIterator& PersistentArray::ConstIterator::operator++() noexcept {
+  if(!(++index & index_mask) && index < array->element_count) leaf = array->getLeaf(index);
+  return self;
+}
+
+const Variable& PersistentArray::ConstIterator::operator*() const noexcept {return leaf[index & index_mask];}
+
+const Variable* PersistentArray::ConstIterator::operator->() const noexcept {return leaf + (index & index_mask);}
+
+bool PersistentArray::ConstIterator::operator==(const ConstIterator& other) const noexcept {return index == other.index;}
+
+bool PersistentArray::ConstIterator::operator!=(const ConstIterator& other) const noexcept {return index != other.index;}
+
+//////////////////////////////////////////////////////////// PersistentArray ////////////////////////////////////////////////////////
+
+const Variable* PersistentArray::getLeaf(size_t index) const noexcept {
+  const Node* node = root;
+  for(size_t level = shift; level; level -= node_bit_count) node = node->children[(index >> level) & index_mask];
+  return node->values.data();
+}
+
+PersistentArray::PersistentArray(const literals::arr& array) : element_count(array.end() - array.begin()) {
+  // Levels are built bottom-up instead of copying path for each element
+  std::vector<Node*> leaves;
+  leaves.reserve((element_count + index_mask) / node_capacity);
+  for(const Variable& element : array) {
+    if(leaves.empty() || leaves.back()->values.size() == node_capacity) {
+      leaves.push_back(new Node());
+      leaves.back()->values.reserve(node_capacity);
+    }
+    Variable reference = element.move();
+    leaves.back()->values.push_back(std::move(reference));
+  }
+  root = buildRoot(std::move(leaves), shift);
+}
+
+PersistentArray::PersistentArray(const PersistentArray& other) noexcept
+  : root(acquire(other.root)), element_count(other.element_count), shift(other.shift) {}
+
+PersistentArray::PersistentArray(PersistentArray&& other) noexcept
+  : root(other.root), element_count(other.element_count), shift(other.shift) {
+  other.root = nullptr;
+  other.element_count = 0;
+  other.shift = 0;
+}
+
+PersistentArray::~PersistentArray() {release(root);}
+
+PersistentArray& PersistentArray::operator=(const PersistentArray& other) noexcept {
+  if(this == &other) return self;
+  Node* old_root = root;
+  root = acquire(other.root);
+  element_count = other.element_count;
+  shift = other.shift;
+  release(old_root);
+  return self;
+}
+
+PersistentArray& PersistentArray::operator=(PersistentArray&& other) noexcept {
+  if(this == &other) return self;
+  std::swap(root, other.root);
+  std::swap(element_count, other.element_count);
+  std::swap(shift, other.shift);
+  return self;
+}
+
+bool PersistentArray::isEmpty() const noexcept {return !element_count;}
+
+size_t PersistentArray::getElementCount() const noexcept {return element_count;}
+
+const Variable& PersistentArray::operator[](size_t index) const {
+  if(index >= element_count) throw err::Error(err::ErrorType::out_of_range);
+  return getLeaf(index)[index & index_mask];
+}
+
+PersistentArray PersistentArray::pushBack(const Variable& value) const {
+  // Value is cloned, so changes of passed variable don't appear in versions
+  Variable clone = value;
+  if(!root) return PersistentArray(createPath(0, clone), 1, 0);
+  if(element_count == node_capacity << shift) {
+    // Trie is full, it grows by one level
+    Node* new_root = new Node();
+    new_root->children.push_back(acquire(root));
+    new_root->children.push_back(createPath(shift, clone));
+    return PersistentArray(new_root, element_count + 1, shift + node_bit_count);
+  }
+  return PersistentArray(pushNode(root, shift, element_count, clone), element_count + 1, shift);
+}
+
+PersistentArray PersistentArray::popBack() const {
+  if(element_count <= 1) return PersistentArray();
+  Node* new_root = popNode(root, shift, element_count - 1);
+  size_t new_shift = shift;
+  if(new_shift && new_root->children.size() == 1) {
+    // Root with single child is replaced by it
+    Node* child = acquire(new_root->children.front());
+    release(new_root);
+    new_root = child;
+    new_shift -= node_bit_count;
+  }
+  return PersistentArray(new_root, element_count - 1, new_shift);
+}
+
+PersistentArray PersistentArray::set(size_t index, const Variable& value) const {
+  if(index >= element_count) throw err::Error(err::ErrorType::out_of_range);
+  Variable clone = value;
+  return PersistentArray(setNode(root, shift, index, clone), element_count, shift);
+}
+
+PersistentArray::ConstIterator PersistentArray::begin() const noexcept {return ConstIterator(this, 0);}
+
+PersistentArray::ConstIterator PersistentArray::end() const noexcept {return ConstIterator(this, element_count);}
+
+Variable PersistentArray::toVariable() const {
+  Variable result = literals::arr{};
+  Array& array = result.toArray();
+  for(const Variable& element : self) array.pushBack(element);
+  return result;
+}
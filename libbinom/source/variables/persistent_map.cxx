@@ -0,0 +1,216 @@
+#include "libbinom/include/variables/persistent_map.hxx"
+#include "libbinom/include/variables/map.hxx"
+
+#include <algorithm>
+#include <atomic>
+
+using namespace binom;
+using namespace binom::priv;
+
+//! Node is immutable after creation, it's shared by all versions containing it
+struct binom::priv::PersistentMapNode {
+  mutable std::atomic_size_t link_counter = 1;
+  PersistentMapNode* left;
+  PersistentMapNode* right;
+  size_t height;
+  size_t size;
+  KeyValue key;
+  Variable value;
+
+  PersistentMapNode(const KeyValue& node_key, Variable node_value, PersistentMapNode* left, PersistentMapNode* right) noexcept;
+};
+
+namespace {
+
+typedef PersistentMapNode Node;
+
+size_t getHeight(const Node* node) noexcept {return node ? node->height : 0;}
+size_t getSize(const Node* node) noexcept {return node ? node->size : 0;}
+
+Node* acquire(const Node* node) noexcept {
+  if(node) node->link_counter.fetch_add(1, std::memory_order_relaxed);
+  return const_cast<Node*>(node);
+}
+
+void release(Node* node) noexcept {
+  while(node && node->link_counter.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    release(node->left);
+    Node* right = node->right;
+    delete node;
+    node = right;
+  }
+}
+
+// Functions below take ownership of passed left/right subtrees and return owned node,
+// values of nodes are shared between versions by reference
+
+//! Node with subtrees which heights differ at most by 2, rebalanced by rotation
+Node* balance(const KeyValue& key, Variable value, Node* left, Node* right) {
+  const size_t left_height = getHeight(left), right_height = getHeight(right);
+  if(left_height > right_height + 1) {
+    Node* result;
+    if(getHeight(left->left) >= getHeight(left->right))
+      result = new Node(left->key, left->value.move(), acquire(left->left), new Node(key, value.move(), acquire(left->right), right));
+    else {
+      const Node* middle = left->right;
+      result = new Node(middle->key, middle->value.move(),
+                        new Node(left->key, left->value.move(), acquire(left->left), acquire(middle->left)),
+                        new Node(key, value.move(), acquire(middle->right), right));
+    }
+    release(left);
+    return result;
+  } elif(right_height > left_height + 1) {
+    Node* result;
+    if(getHeight(right->right) >= getHeight(right->left))
+      result = new Node(right->key, right->value.move(), new Node(key, value.move(), left, acquire(right->left)), acquire(right->right));
+    else {
+      const Node* middle = right->left;
+      result = new Node(middle->key, middle->value.move(),
+                        new Node(key, value.move(), left, acquire(middle->left)),
+                        new Node(right->key, right->value.move(), acquire(middle->right), acquire(right->right)));
+    }
+    release(right);
+    return result;
+  }
+  return new Node(key, value.move(), left, right);
+}
+
+Node* setNode(const Node* node, KeyValue& key, Variable& value) {
+  if(!node) return new Node(key, value.move(), nullptr, nullptr);
+  switch (node->key.getCompare(key)) {
+  case KeyValue::equal: return new Node(node->key, value.move(), acquire(node->left), acquire(node->right));
+  case KeyValue::highter: return balance(node->key, node->value.move(), setNode(node->left, key, value), acquire(node->right));
+  case KeyValue::lower: default: return balance(node->key, node->value.move(), acquire(node->left), setNode(node->right, key, value));
+  }
+}
+
+Node* removeMinNode(const Node* node) {
+  if(!node->left) return acquire(node->right);
+  return balance(node->key, node->value.move(), removeMinNode(node->left), acquire(node->right));
+}
+
+//! Key must be in subtree
+Node* removeNode(const Node* node, KeyValue& key) {
+  switch (node->key.getCompare(key)) {
+  case KeyValue::highter: return balance(node->key, node->value.move(), removeNode(node->left, key), acquire(node->right));
+  case KeyValue::lower: return balance(node->key, node->value.move(), acquire(node->left), removeNode(node->right, key));
+  case KeyValue::equal: default: break;
+  }
+  if(!node->left) return acquire(node->right);
+  if(!node->right) return acquire(node->left);
+  // Removed node is replaced with minimal node of right subtree
+  const Node* min = node->right;
+  while(min->left) min = min->left;
+  return balance(min->key, min->value.move(), acquire(node->left), removeMinNode(node->right));
+}
+
+const Node* findNode(const Node* node, KeyValue& key) {
+  while(node) {
+    switch (node->key.getCompare(key)) {
+    case KeyValue::equal: return node;
+    case KeyValue::highter: node = node->left; continue;
+    case KeyValue::lower: default: node = node->right; continue;
+    }
+  }
+  return nullptr;
+}
+
+}
+
+PersistentMapNode::PersistentMapNode(const KeyValue& node_key, Variable node_value, PersistentMapNode* left, PersistentMapNode* right) noexcept
+  : left(left), right(right),
+    height(1 + std::max(getHeight(left), getHeight(right))),
+    size(1 + getSize(left) + getSize(right)),
+    key(node_key), value(node_value.move()) {}
+
+//////////////////////////////////////////////////////////// ConstIterator ////////////////////////////////////////////////////////
+
+PersistentMap::ConstIterator::ConstIterator(const Node* root) {
+  for(; root; root = root->left) path.push_back(root);
+}
+
+PersistentMap::ConstIterator& PersistentMap::ConstIterator::operator++() {
+  const Node* node = path.back()->right;
+  path.pop_back();
+  for(; node; node = node->left) path.push_back(node);
+  return self;
+}
+
+PersistentMap::ElementRef PersistentMap::ConstIterator::operator*() const {return ElementRef(path.back()->key, path.back()->value);}
+
+const KeyValue& PersistentMap::ConstIterator::getKey() const {return path.back()->key;}
+
+const Variable& PersistentMap::ConstIterator::getVariable() const {return path.back()->value;}
+
+bool PersistentMap::ConstIterator::operator==(const ConstIterator& other) const noexcept {
+  if(path.empty() || other.path.empty()) return path.empty() == other.path.empty();
+  return path.back() == other.path.back();
+}
+
+bool PersistentMap::ConstIterator::operator!=(const ConstIterator& other) const noexcept {return !(self == other);}
+
+//////////////////////////////////////////////////////////// PersistentMap ////////////////////////////////////////////////////////
+
+PersistentMap::PersistentMap(const literals::map& map) {
+  for(auto& element : map) {
+    KeyValue key = element.getKey();
+    Variable value = element.getVariable();
+    Node* new_root = setNode(root, key, value);
+    release(root);
+    root = new_root;
+  }
+}
+
+PersistentMap::PersistentMap(const PersistentMap& other) noexcept : root(acquire(other.root)) {}
+
+PersistentMap::PersistentMap(PersistentMap&& other) noexcept : root(other.root) {other.root = nullptr;}
+
+PersistentMap::~PersistentMap() {release(root);}
+
+PersistentMap& PersistentMap::operator=(const PersistentMap& other) noexcept {
+  if(this == &other) return self;
+  Node* old_root = root;
+  root = acquire(other.root);
+  release(old_root);
+  return self;
+}
+
+PersistentMap& PersistentMap::operator=(PersistentMap&& other) noexcept {
+  if(this == &other) return self;
+  std::swap(root, other.root);
+  return self;
+}
+
+bool PersistentMap::isEmpty() const noexcept {return !root;}
+
+size_t PersistentMap::getElementCount() const noexcept {return getSize(root);}
+
+bool PersistentMap::contains(KeyValue key) const {return findNode(root, key);}
+
+const Variable* PersistentMap::find(KeyValue key) const {
+  if(const Node* node = findNode(root, key)) return &node->value;
+  return nullptr;
+}
+
+PersistentMap PersistentMap::set(KeyValue key, const Variable& value) const {
+  // Value is cloned, so changes of passed variable don't appear in versions
+  Variable clone = value;
+  return setNode(root, key, clone);
+}
+
+PersistentMap PersistentMap::remove(KeyValue key) const {
+  if(!findNode(root, key)) return self;
+  return removeNode(root, key);
+}
+
+PersistentMap::ConstIterator PersistentMap::begin() const {return ConstIterator(root);}
+
+PersistentMap::ConstIterator PersistentMap::end() const noexcept {return ConstIterator();}
+
+Variable PersistentMap::toVariable() const {
+  Variable result = literals::map{};
+  Map& map = result.toMap();
+  for(auto it = begin(), end_it = end(); it != end_it; ++it)
+    map.insert(it.getKey(), it.getVariable());
+  return result;
+}
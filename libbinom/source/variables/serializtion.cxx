@@ -5,134 +5,485 @@
 #include "libbinom/include/variables/array.hxx"
 #include "libbinom/include/variables/list.hxx"
 #include "libbinom/include/variables/map.hxx"
+#include "libbinom/include/variables/multi_map.hxx"
+#include "libbinom/include/variables/hash_map.hxx"
+#include "libbinom/include/binom_impl/serialization.hxx"
+
+#include <cerrno>
+#include <unistd.h>
 
 using namespace binom;
 using namespace binom::priv;
-
-std::vector<byte> Variable::serialize() const {
-  std::vector<byte> buffer;
-//  serializeImpl(self, buffer);
-  return buffer;
+using namespace binom::priv::serialization;
+
+namespace {
+
+template<typename Writer, typename Iterator, typename ElementWriter>
+void serializeContainerBody(Writer& writer, size_t element_count, Iterator it, Iterator end, ElementWriter write_element) {
+  if constexpr (Writer::is_indexed) {
+    const size_t index_position = writer.allocate(getContainerIndexSize(element_count));
+    const size_t body_position = writer.getPosition();
+    size_t offset_position = index_position + sizeof(ui64);
+    for(; it != end; ++it, offset_position += sizeof(ui64)) {
+      writer.patch(offset_position, ui64(writer.getPosition() - body_position));
+      write_element(it);
+    }
+    writer.patch(index_position, ui64(writer.getPosition() - body_position));
+  } else for(; it != end; ++it) write_element(it);
 }
 
-void Variable::serializeToStraem(std::ostream& os) const {
-
+class OStreamSink {
+  std::ostream& os;
+public:
+  OStreamSink(std::ostream& os) : os(os) {}
+  void write(const byte* data, size_t size) {
+    if(!os.write(reinterpret_cast<const char*>(data), size)) throw err::Error(err::ErrorType::file_write_error);
+  }
+};
+
+class FileDescriptorSink {
+  int file_descriptor;
+public:
+  FileDescriptorSink(int file_descriptor) : file_descriptor(file_descriptor) {}
+  void write(const byte* data, size_t size) {
+    while(size) {
+      const ssize_t written = ::write(file_descriptor, data, size);
+      if(written < 0) {
+        if(errno == EINTR) continue;
+        throw err::Error(err::ErrorType::file_write_error);
+      }
+      data += written;
+      size -= written;
+    }
+  }
+};
+
+Header readHeader(auto& reader) {
+  const Header header = reader.template read<Header>();
+  if(std::memcmp(header.magic, format_magic, sizeof(format_magic)) || header.version != format_version)
+    throw err::Error(err::ErrorType::invalid_data);
+  return header;
 }
 
-//void Variable::serializeImpl(const Variable& variable, std::vector<byte>& buffer) {
-//  auto lk = variable.getLock(MtxLockType::shared_locked);
-//  if(!lk) return;
-
-//  switch (variable.getTypeClass()) {
-
-//  case binom::VarTypeClass::null:
-//    buffer.pushBack(VarType::null);
-//  return;
-
-//  case binom::VarTypeClass::number:
-//    serializeImpl(variable.toNumber(), buffer);
-//  return;
-
-//  case binom::VarTypeClass::bit_array:
-//    serializeImpl(variable.toBitArray(), buffer);
-//  return;
-
-//  case binom::VarTypeClass::buffer_array:
-//    serializeImpl(variable.toBufferArray(), buffer);
-//  return;
-
-//  case binom::VarTypeClass::array:
-//    serializeImpl(variable.toArray(), buffer);
-//  return;
-
-//  case binom::VarTypeClass::singly_linked_list:
-//    serializeImpl(variable.toSinglyLinkedList(), buffer);
-//  return;
-
-//  case binom::VarTypeClass::doubly_linked_list:
-//    serializeImpl(variable.toDoublyLinkedList(), buffer);
-//  return;
-
-//  case binom::VarTypeClass::map:
-//    serializeImpl(variable.toMap(), buffer);
-//  return;
-
-//  case binom::VarTypeClass::table:
-////    TODO: serializeImpl(variable.toTable(), buffer);
-//  return;
-
-//  default:
-//  case binom::VarTypeClass::invalid_type:
-//    buffer.push_back(VarType::invalid_type);
-//  break;
-
-//  }
-//}
+template<typename Reader>
+void checkElementCount(Reader& reader, ui64 element_count, size_t element_size = 1) {
+  if(element_count > reader.getRemaining() / element_size) throw err::Error(err::ErrorType::invalid_data);
+}
 
+//! Count of elements which may be allocated before they are read, stream can't vouch for its length fields
+template<typename Reader>
+size_t getReserveCount(Reader& reader, ui64 element_count, size_t element_size = 1) {
+  return std::min<ui64>(element_count, std::max<size_t>(reader.getAvailable() / element_size, 1));
+}
 
-//void Variable::serializeImpl(const Number& number, std::vector<byte>& buffer) {
-//  auto lk = number.getLock(MtxLockType::shared_locked);
-//  if(!lk) return;
+//! Bit array grows by pieces after previous piece is read, so truncated data fails before large allocation
+template<typename Reader>
+void readBitArray(Reader& reader, BitArrayImplementation*& implementation, ui64 bit_count) {
+  const size_t byte_count = BitArrayImplementation::calculateByteSize(bit_count);
+  checkElementCount(reader, byte_count);
+  implementation = BitArrayImplementation::create(std::min<ui64>(bit_count, getReserveCount(reader, byte_count) * 8));
+  for(size_t offset = 0;;) {
+    reader.read(implementation->getDataAs<byte>() + offset, implementation->getByteSize() - offset);
+    if(implementation->getBitSize() == bit_count) return;
+    offset = implementation->getByteSize();
+    BitArrayImplementation::increaseSize(implementation, std::min<ui64>(
+      bit_count - implementation->getBitSize(), getReserveCount(reader, byte_count - offset) * 8
+    ));
+  }
+}
 
-//  buffer.push_back(number.getType());
-//  switch (number.getValType()) {
-//  case binom::ValType::boolean: buffer.push_back(bool(number)); return;
-//  case binom::ValType::ui8:  buffer.push_back(ui8(number)); return;
-//  case binom::ValType::si8:  buffer.push_back(i8(number)); return;
-//  case binom::ValType::ui16: buffer.push_back(ui16(number)); return;
-//  case binom::ValType::si16: buffer.push_back(i16(number)); return;
-//  case binom::ValType::ui32: buffer.push_back(ui32(number)); return;
-//  case binom::ValType::si32: buffer.push_back(i32(number)); return;
-//  case binom::ValType::f32:  buffer.push_back(f32(number)); return;
-//  case binom::ValType::ui64: buffer.push_back(ui64(number)); return;
-//  case binom::ValType::si64: buffer.push_back(i64(number)); return;
-//  case binom::ValType::f64:  buffer.push_back(f64(number)); return;
-//  default:
-//  case binom::ValType::invalid_type: return;
-//  }
-//}
+template<typename Reader>
+void readBufferArray(Reader& reader, BufferArrayStorage& storage, VarBitWidth bit_width, ui64 element_count) {
+  checkElementCount(reader, element_count, size_t(bit_width));
+  size_t count = getReserveCount(reader, element_count, size_t(bit_width));
+  storage = BufferArrayImplementation::create(bit_width, count);
+  reader.read(BufferArrayImplementation::getData(storage), count * size_t(bit_width));
+  for(ui64 left = element_count - count; left; left -= count) {
+    count = getReserveCount(reader, left, size_t(bit_width));
+    reader.read(BufferArrayImplementation::increaseSize(storage, bit_width, count), count * size_t(bit_width));
+  }
+}
 
-//void Variable::serializeImpl(const BitArray& bit_array, std::vector<byte>& buffer) {
-//  auto lk = bit_array.getLock(MtxLockType::shared_locked);
-//  if(!lk) return;
+}
 
-//  buffer.pushBack(bit_array.getType());
-//  size_t element_count = bit_array.getElementCount();
-//  buffer.pushBack(element_count);
-//  buffer.reserve(buffer.getCapacity() + element_count);
-//  buffer.pushBack(bit_array.getDataPointer(), bit_array.getSize());
-//}
+std::vector<byte> Variable::serialize() const {
+  std::vector<byte> buffer;
+  buffer.reserve(sizeof(Header) + getSerializedSizeImpl(self));
+  MemoryWriter writer(buffer);
+  writer.write(Header{.flags = FormatFlags::indexed});
+  serializeImpl(self, writer);
+  return buffer;
+}
 
-//void Variable::serializeImpl(const BufferArray& buffer_array, std::vector<byte>& buffer) {
-//  auto lk = buffer_array.getLock(MtxLockType::shared_locked);
-//  if(!lk) return;
+StreamStatistics Variable::serializeToStraem(std::ostream& os, size_t chunk_size) const {
+  OStreamSink sink(os);
+  StreamWriter writer(sink, chunk_size);
+  writer.write(Header{.flags = FormatFlags::none});
+  serializeImpl(self, writer);
+  return writer.finish();
+}
 
-//}
+StreamStatistics Variable::serializeToFile(int file_descriptor, size_t chunk_size) const {
+  FileDescriptorSink sink(file_descriptor);
+  StreamWriter writer(sink, chunk_size);
+  writer.write(Header{.flags = FormatFlags::none});
+  serializeImpl(self, writer);
+  return writer.finish();
+}
 
-//void Variable::serializeImpl(const Array& array, std::vector<byte>& buffer) {
-//  auto lk = array.getLock(MtxLockType::shared_locked);
-//  if(!lk) return;
+Variable Variable::deserialize(const std::vector<byte>& buffer) {return deserialize(buffer.data(), buffer.size());}
 
-//}
+Variable Variable::deserialize(const byte* data, size_t size) {
+  MemoryReader reader(data, size);
+  const Header header = readHeader(reader);
+  return deserializeImpl(reader, ui8(header.flags) & ui8(FormatFlags::indexed));
+}
 
-//void Variable::serializeImpl(const SinglyLinkedList& sl_list, std::vector<byte>& buffer) {
-//  auto lk = sl_list.getLock(MtxLockType::shared_locked);
-//  if(!lk) return;
+Variable Variable::deserializeFromStream(std::istream& is, StreamStatistics* statistics, size_t chunk_size) {
+  StreamReader reader(is, chunk_size);
+  const Header header = readHeader(reader);
+  Variable variable = deserializeImpl(reader, ui8(header.flags) & ui8(FormatFlags::indexed));
+  const StreamStatistics reader_statistics = reader.finish();
+  if(statistics) *statistics = reader_statistics;
+  return variable;
+}
 
-//}
+size_t Variable::getSerializedSizeImpl(const Variable& variable) {
+  auto lk = variable.getLock(MtxLockType::shared_locked);
+  if(!lk) return sizeof(VarType);
+  const ResourceData& resource = **variable.resource_link;
+
+  switch (toTypeClass(resource.type)) {
+  case VarTypeClass::null: return sizeof(VarType);
+  case VarTypeClass::number: return sizeof(VarType) + size_t(toBitWidth(resource.type));
+  case VarTypeClass::bit_array: return container_header_size + resource.data.bit_array_implementation->getByteSize();
+  case VarTypeClass::buffer_array: return container_header_size + BufferArrayImplementation::getSize(resource.data.buffer_array_storage);
+
+  case VarTypeClass::array: {
+    size_t size = container_header_size + getContainerIndexSize(resource.data.array_implementation->getElementCount());
+    for(const Variable& element : *resource.data.array_implementation)
+      size += getSerializedSizeImpl(element);
+    return size;
+  }
+
+  case VarTypeClass::list: {
+    size_t size = container_header_size + getContainerIndexSize(resource.data.list_implementation->getElementCount());
+    for(const Variable& element : *resource.data.list_implementation)
+      size += getSerializedSizeImpl(element);
+    return size;
+  }
+
+  case VarTypeClass::map: {
+    size_t size = container_header_size + getContainerIndexSize(resource.data.map_implementation->getSize());
+    for(MapImplementation::ConstIterator it = resource.data.map_implementation->cbegin(),
+        end = resource.data.map_implementation->cend(); it != end; ++it)
+      size += getSerializedSizeImpl(it.getKey()) + getSerializedSizeImpl(it.getVariable());
+    return size;
+  }
+
+  case VarTypeClass::multimap: {
+    size_t size = container_header_size + getContainerIndexSize(resource.data.multi_map_implementation->getSize());
+    for(MultiMapImplementation::ConstIterator it = resource.data.multi_map_implementation->cbegin(),
+        end = resource.data.multi_map_implementation->cend(); it != end; ++it)
+      size += getSerializedSizeImpl(it.getKey()) + getSerializedSizeImpl(it.getVariable());
+    return size;
+  }
+
+  case VarTypeClass::hash_map: {
+    size_t size = container_header_size + getContainerIndexSize(resource.data.hash_map_implementation->getSize());
+    for(HashMapImplementation::ConstIterator it = resource.data.hash_map_implementation->cbegin(),
+        end = resource.data.hash_map_implementation->cend(); it != end; ++it)
+      size += getSerializedSizeImpl(it.getKey()) + getSerializedSizeImpl(it.getVariable());
+    return size;
+  }
+
+  case VarTypeClass::table:
+  case VarTypeClass::invalid_type:
+  default:
+  throw err::Error(err::ErrorType::binom_invalid_type);
+  }
+}
 
-//void Variable::serializeImpl(const DoublyLinkedList& dl_list, std::vector<byte>& buffer) {
-//  auto lk = dl_list.getLock(MtxLockType::shared_locked);
-//  if(!lk) return;
+size_t Variable::getSerializedSizeImpl(const KeyValue& key) {
+  switch (key.getTypeClass()) {
+  case VarTypeClass::null: return sizeof(VarType);
+  case VarTypeClass::number: return sizeof(VarType) + size_t(key.getBitWidth());
+  case VarTypeClass::bit_array: return container_header_size + key.data.bit_array_implementation->getByteSize();
+  case VarTypeClass::buffer_array: return container_header_size + key.getBufferSize();
+  default: throw err::Error(err::ErrorType::binom_invalid_type);
+  }
+}
 
-//}
+template<typename Writer>
+void Variable::serializeImpl(const Variable& variable, Writer& writer) {
+  auto lk = variable.getLock(MtxLockType::shared_locked);
+  if(!lk) return writer.write(VarType::null);
+  const ResourceData& resource = **variable.resource_link;
+
+  switch (toTypeClass(resource.type)) {
+  case VarTypeClass::null:
+    writer.write(VarType::null);
+  return;
+
+  case VarTypeClass::number:
+    writer.write(resource.type);
+    writer.write(&resource.data, size_t(toBitWidth(resource.type)));
+  return;
+
+  case VarTypeClass::bit_array: {
+    const BitArrayImplementation* implementation = resource.data.bit_array_implementation;
+    writer.write(resource.type);
+    writer.write(ui64(implementation->getBitSize()));
+    writer.write(implementation->getDataPointer(), implementation->getByteSize());
+  } return;
+
+  case VarTypeClass::buffer_array: {
+    const BufferArrayStorage& storage = resource.data.buffer_array_storage;
+    const VarBitWidth bit_width = toBitWidth(resource.type);
+    const size_t element_count = BufferArrayImplementation::getElementCount(storage, bit_width);
+    writer.write(resource.type);
+    writer.write(ui64(element_count));
+    writer.write(BufferArrayImplementation::getData(storage), element_count * size_t(bit_width));
+  } return;
+
+  case VarTypeClass::array: {
+    const ArrayImplementation* implementation = resource.data.array_implementation;
+    writer.write(resource.type);
+    writer.write(ui64(implementation->getElementCount()));
+    serializeContainerBody(writer, implementation->getElementCount(), implementation->cbegin(), implementation->cend(),
+                           [&writer](auto it) { serializeImpl(*it, writer); });
+  } return;
+
+  case VarTypeClass::list: {
+    const ListImplementation* implementation = resource.data.list_implementation;
+    writer.write(resource.type);
+    writer.write(ui64(implementation->getElementCount()));
+    serializeContainerBody(writer, implementation->getElementCount(), implementation->cbegin(), implementation->cend(),
+                           [&writer](auto it) { serializeImpl(*it, writer); });
+  } return;
+
+  case VarTypeClass::map: {
+    const MapImplementation* implementation = resource.data.map_implementation;
+    writer.write(resource.type);
+    writer.write(ui64(implementation->getSize()));
+    serializeContainerBody(writer, implementation->getSize(),
+                           implementation->cbegin(), implementation->cend(),
+                           [&writer](const MapImplementation::ConstIterator& it) {
+                             serializeImpl(it.getKey(), writer);
+                             serializeImpl(it.getVariable(), writer);
+                           });
+  } return;
+
+  case VarTypeClass::multimap: {
+    const MultiMapImplementation* implementation = resource.data.multi_map_implementation;
+    writer.write(resource.type);
+    writer.write(ui64(implementation->getSize()));
+    serializeContainerBody(writer, implementation->getSize(),
+                           implementation->cbegin(), implementation->cend(),
+                           [&writer](const MultiMapImplementation::ConstIterator& it) {
+                             serializeImpl(it.getKey(), writer);
+                             serializeImpl(it.getVariable(), writer);
+                           });
+  } return;
+
+  case VarTypeClass::hash_map: {
+    // Elements are written in key order, so body is the same as body of map with these elements
+    const HashMapImplementation* implementation = resource.data.hash_map_implementation;
+    const std::vector<HashMapImplementation::ConstIterator> key_order = implementation->getKeyOrder();
+    writer.write(resource.type);
+    writer.write(ui64(implementation->getSize()));
+    serializeContainerBody(writer, implementation->getSize(), key_order.cbegin(), key_order.cend(),
+                           [&writer](const auto& it) {
+                             serializeImpl(it->getKey(), writer);
+                             serializeImpl(it->getVariable(), writer);
+                           });
+  } return;
+
+  case VarTypeClass::table:
+  case VarTypeClass::invalid_type:
+  default:
+  throw err::Error(err::ErrorType::binom_invalid_type);
+  }
+}
 
-//void Variable::serializeImpl(const Map& map, std::vector<byte>& buffer) {
-//  auto lk = map.getLock(MtxLockType::shared_locked);
-//  if(!lk) return;
+template<typename Writer>
+void Variable::serializeImpl(const KeyValue& key, Writer& writer) {
+  switch (key.getTypeClass()) {
+  case VarTypeClass::null:
+    writer.write(VarType::null);
+  return;
+
+  case VarTypeClass::number:
+    writer.write(key.getVarType());
+    writer.write(&key.data, size_t(key.getBitWidth()));
+  return;
+
+  case VarTypeClass::bit_array:
+    writer.write(key.getVarType());
+    writer.write(ui64(key.data.bit_array_implementation->getBitSize()));
+    writer.write(key.data.bit_array_implementation->getDataPointer(), key.data.bit_array_implementation->getByteSize());
+  return;
+
+  case VarTypeClass::buffer_array: {
+    const size_t element_count = key.getBufferSize() / size_t(key.getBitWidth());
+    writer.write(key.getVarType());
+    writer.write(ui64(element_count));
+    writer.write(key.getBufferData(), element_count * size_t(key.getBitWidth()));
+  } return;
+
+  default:
+  throw err::Error(err::ErrorType::binom_invalid_type);
+  }
+}
 
-//}
+template<typename Reader>
+Variable Variable::deserializeImpl(Reader& reader, bool is_indexed, size_t depth) {
+  if(depth > max_nesting_depth) throw err::Error(err::ErrorType::invalid_data);
+  const VarType type = reader.template read<VarType>();
+
+  switch (toTypeClass(type)) {
+  case VarTypeClass::null: return nullptr;
+
+  case VarTypeClass::number: {
+    ResourceData resource{type, {.ui64_val = 0}};
+    reader.read(&resource.data, size_t(toBitWidth(type)));
+    return Variable(resource);
+  }
+
+  case VarTypeClass::bit_array: {
+    const ui64 bit_count = reader.template read<ui64>();
+    Variable variable(ResourceData{type, {.bit_array_implementation = nullptr}});
+    readBitArray(reader, variable.resource_link->data.bit_array_implementation, bit_count);
+    return variable;
+  }
+
+  case VarTypeClass::buffer_array: {
+    const ui64 element_count = reader.template read<ui64>();
+    Variable variable(ResourceData{type, {.pointer = nullptr}});
+    readBufferArray(reader, variable.resource_link->data.buffer_array_storage, toBitWidth(type), element_count);
+    return variable;
+  }
+
+  case VarTypeClass::array: {
+    const ui64 element_count = reader.template read<ui64>();
+    checkElementCount(reader, element_count);
+    if(is_indexed) reader.skip(getContainerIndexSize(element_count));
+    const size_t reserve_count = getReserveCount(reader, element_count);
+    Variable variable(ResourceData{type, {.array_implementation =
+      ArrayImplementation::create(reserve_count, [&reader, is_indexed, depth]() { return deserializeImpl(reader, is_indexed, depth + 1); })
+    }});
+    for(ui64 i = reserve_count; i < element_count; ++i)
+      ArrayImplementation::pushBack(variable.resource_link->data.array_implementation, deserializeImpl(reader, is_indexed, depth + 1));
+    return variable;
+  }
+
+  case VarTypeClass::list: {
+    const ui64 element_count = reader.template read<ui64>();
+    checkElementCount(reader, element_count);
+    if(is_indexed) reader.skip(getContainerIndexSize(element_count));
+    ListImplementation* implementation = new ListImplementation();
+    Variable variable(ResourceData{type, {.list_implementation = implementation}});
+    for(ui64 i = 0; i < element_count; ++i)
+      implementation->insert(implementation->end(), deserializeImpl(reader, is_indexed, depth + 1));
+    return variable;
+  }
+
+  case VarTypeClass::map: {
+    const ui64 element_count = reader.template read<ui64>();
+    checkElementCount(reader, element_count);
+    if(is_indexed) reader.skip(getContainerIndexSize(element_count));
+    MapImplementation* implementation = new MapImplementation();
+    Variable variable(ResourceData{type, {.map_implementation = implementation}});
+    // Elements are written in key order, so tree is built from them directly
+    if(implementation->bulkLoadChecked(element_count, [&reader, is_indexed, depth]() {
+         KeyValue key = deserializeKeyImpl(reader);
+         return std::pair<KeyValue, Variable>(std::move(key), deserializeImpl(reader, is_indexed, depth + 1));
+       }))
+      throw err::Error(err::ErrorType::invalid_data);
+    return variable;
+  }
+
+  case VarTypeClass::multimap: {
+    const ui64 element_count = reader.template read<ui64>();
+    checkElementCount(reader, element_count);
+    if(is_indexed) reader.skip(getContainerIndexSize(element_count));
+    MultiMapImplementation* implementation = new MultiMapImplementation();
+    Variable variable(ResourceData{type, {.multi_map_implementation = implementation}});
+    // Elements are written in key order, so tree is built from them directly
+    if(implementation->bulkLoadChecked(element_count, [&reader, is_indexed, depth]() {
+         KeyValue key = deserializeKeyImpl(reader);
+         return std::pair<KeyValue, Variable>(std::move(key), deserializeImpl(reader, is_indexed, depth + 1));
+       }))
+      throw err::Error(err::ErrorType::invalid_data);
+    return variable;
+  }
+
+  case VarTypeClass::hash_map: {
+    const ui64 element_count = reader.template read<ui64>();
+    checkElementCount(reader, element_count);
+    if(is_indexed) reader.skip(getContainerIndexSize(element_count));
+    HashMapImplementation* implementation = new HashMapImplementation();
+    Variable variable(ResourceData{type, {.hash_map_implementation = implementation}});
+    implementation->reserve(getReserveCount(reader, element_count));
+    for(ui64 i = 0; i < element_count; ++i) {
+      KeyValue key = deserializeKeyImpl(reader);
+      if(implementation->insert(std::move(key), deserializeImpl(reader, is_indexed, depth + 1)))
+        throw err::Error(err::ErrorType::invalid_data);
+    }
+    return variable;
+  }
+
+  // Tables have no serialized form yet
+  case VarTypeClass::table: throw err::Error(err::ErrorType::binom_invalid_type);
+  case VarTypeClass::invalid_type:
+  default:
+  throw err::Error(err::ErrorType::invalid_data);
+  }
+}
 
-//void Variable::serializeImpl(const Table& bit_array, BufferController& buffer) {
+template<typename Reader>
+KeyValue Variable::deserializeKeyImpl(Reader& reader) {
+  const VarType type = reader.template read<VarType>();
+  KeyValue key;
+
+  switch (toTypeClass(type)) {
+  case VarTypeClass::null: return key;
+
+  case VarTypeClass::number:
+    key.type = toKeyType(type);
+    reader.read(&key.data, size_t(toBitWidth(type)));
+  return key;
+
+  case VarTypeClass::bit_array: {
+    const ui64 bit_count = reader.template read<ui64>();
+    key.type = toKeyType(type);
+    key.data.bit_array_implementation = nullptr;
+    readBitArray(reader, key.data.bit_array_implementation, bit_count);
+  } return key;
+
+  case VarTypeClass::buffer_array: {
+    const ui64 element_count = reader.template read<ui64>();
+    const VarBitWidth bit_width = toBitWidth(type);
+    checkElementCount(reader, element_count, size_t(bit_width));
+    key.type = toKeyType(type);
+    if(getReserveCount(reader, element_count, size_t(bit_width)) == element_count) {
+      reader.read(key.allocateBuffer(element_count * size_t(bit_width)), element_count * size_t(bit_width));
+      return key;
+    }
+    // Long key of stream is collected by pieces before its buffer is allocated
+    std::vector<byte> data;
+    for(size_t size = element_count * size_t(bit_width); data.size() < size;) {
+      const size_t offset = data.size();
+      data.resize(offset + getReserveCount(reader, size - offset));
+      reader.read(data.data() + offset, data.size() - offset);
+    }
+    std::memcpy(key.allocateBuffer(data.size()), data.data(), data.size());
+  } return key;
+
+  default:
+  throw err::Error(err::ErrorType::invalid_data);
+  }
+}
 
-//}
+template Variable Variable::deserializeImpl<MemoryReader>(MemoryReader& reader, bool is_indexed, size_t depth);
+template KeyValue Variable::deserializeKeyImpl<MemoryReader>(MemoryReader& reader);
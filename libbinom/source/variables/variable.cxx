@@ -6,6 +6,7 @@
 #include "libbinom/include/variables/list.hxx"
 #include "libbinom/include/variables/map.hxx"
 #include "libbinom/include/variables/multi_map.hxx"
+#include "libbinom/include/variables/hash_map.hxx"
 #include "libbinom/include/binom_impl/ram_storage_implementation.hxx"
 
 using namespace binom;
@@ -37,7 +38,7 @@ template<typename CharT>
 requires extended_type_traits::is_char_v<CharT>
 Variable::Variable(const std::basic_string_view<CharT> string_view)
   : Variable(ResourceData{to_buffer_array_type<CharT>,
-{.buffer_array_implementation = priv::BufferArrayImplementation::create(string_view)}}) {}
+{.buffer_array_storage = priv::BufferArrayImplementation::create(string_view)}}) {}
 
 template Variable::Variable(const std::basic_string_view<char>);
 template Variable::Variable(const std::basic_string_view<signed char>);
@@ -48,25 +49,25 @@ template Variable::Variable(const std::basic_string_view<char16_t>);
 template Variable::Variable(const std::basic_string_view<char32_t>);
 
 Variable::Variable(const literals::ui8arr ui8_array)
-  : Variable(ResourceData{VarType::ui8_array, {.buffer_array_implementation = priv::BufferArrayImplementation::create(ui8_array)}}) {}
+  : Variable(ResourceData{VarType::ui8_array, {.buffer_array_storage = priv::BufferArrayImplementation::create(ui8_array)}}) {}
 Variable::Variable(const literals::i8arr i8_array)
-  : Variable(ResourceData{VarType::si8_array, {.buffer_array_implementation = priv::BufferArrayImplementation::create(i8_array)}}) {}
+  : Variable(ResourceData{VarType::si8_array, {.buffer_array_storage = priv::BufferArrayImplementation::create(i8_array)}}) {}
 Variable::Variable(const literals::ui16arr ui16_array)
-  : Variable(ResourceData{VarType::ui16_array, {.buffer_array_implementation = priv::BufferArrayImplementation::create(ui16_array)}}) {}
+  : Variable(ResourceData{VarType::ui16_array, {.buffer_array_storage = priv::BufferArrayImplementation::create(ui16_array)}}) {}
 Variable::Variable(const literals::i16arr i16_array)
-  : Variable(ResourceData{VarType::si16_array, {.buffer_array_implementation = priv::BufferArrayImplementation::create(i16_array)}}) {}
+  : Variable(ResourceData{VarType::si16_array, {.buffer_array_storage = priv::BufferArrayImplementation::create(i16_array)}}) {}
 Variable::Variable(const literals::ui32arr ui32_array)
-  : Variable(ResourceData{VarType::ui32_array, {.buffer_array_implementation = priv::BufferArrayImplementation::create(ui32_array)}}) {}
+  : Variable(ResourceData{VarType::ui32_array, {.buffer_array_storage = priv::BufferArrayImplementation::create(ui32_array)}}) {}
 Variable::Variable(const literals::i32arr i32_array)
-  : Variable(ResourceData{VarType::si32_array, {.buffer_array_implementation = priv::BufferArrayImplementation::create(i32_array)}}) {}
+  : Variable(ResourceData{VarType::si32_array, {.buffer_array_storage = priv::BufferArrayImplementation::create(i32_array)}}) {}
 Variable::Variable(const literals::f32arr f32_array)
-  : Variable(ResourceData{VarType::f32_array, {.buffer_array_implementation = priv::BufferArrayImplementation::create(f32_array)}}) {}
+  : Variable(ResourceData{VarType::f32_array, {.buffer_array_storage = priv::BufferArrayImplementation::create(f32_array)}}) {}
 Variable::Variable(const literals::ui64arr ui64_array)
-  : Variable(ResourceData{VarType::ui64_array, {.buffer_array_implementation = priv::BufferArrayImplementation::create(ui64_array)}}) {}
+  : Variable(ResourceData{VarType::ui64_array, {.buffer_array_storage = priv::BufferArrayImplementation::create(ui64_array)}}) {}
 Variable::Variable(const literals::i64arr i64_array)
-  : Variable(ResourceData{VarType::si64_array, {.buffer_array_implementation = priv::BufferArrayImplementation::create(i64_array)}}) {}
+  : Variable(ResourceData{VarType::si64_array, {.buffer_array_storage = priv::BufferArrayImplementation::create(i64_array)}}) {}
 Variable::Variable(const literals::f64arr f64_array)
-  : Variable(ResourceData{VarType::f64_array, {.buffer_array_implementation = priv::BufferArrayImplementation::create(f64_array)}}) {}
+  : Variable(ResourceData{VarType::f64_array, {.buffer_array_storage = priv::BufferArrayImplementation::create(f64_array)}}) {}
 
 Variable::Variable(const literals::arr array)
   : Variable(ResourceData{VarType::array, {.array_implementation = priv::ArrayImplementation::create(array)}}) {}
@@ -80,6 +81,9 @@ Variable::Variable(const literals::map map)
 Variable::Variable(const literals::multimap multimap, NewNodePosition pos)
   : Variable(ResourceData{VarType::multimap, {.multi_map_implementation = new priv::MultiMapImplementation(multimap, pos)}}) {}
 
+Variable::Variable(const literals::hashmap hashmap)
+  : Variable(ResourceData{VarType::hash_map, {.hash_map_implementation = new priv::HashMapImplementation(hashmap)}}) {}
+
 Variable::Variable(Variable&& other) noexcept : resource_link(std::move(other.resource_link)) {}
 Variable::Variable(const Variable& other) noexcept : resource_link(Link::cloneResource(other.resource_link)) {}
 
@@ -90,6 +94,25 @@ OptionalSharedRecursiveLock Variable::getLock(MtxLockType lock_type) const noexc
   return resource_link.getLock(lock_type);
 }
 
+OptionalSharedRecursiveLock Variable::getElementLinkLock() const noexcept {
+  return resource_link.getElementLinkLock();
+}
+
+OptionalSharedRecursiveLock Variable::getElementAccessLock() const noexcept {
+  return resource_link.getElementAccessLock();
+}
+
+Variable::TransactionLock Variable::makeTransaction(std::initializer_list<std::reference_wrapper<const Variable>> variables,
+                                                   MtxLockType lock_type) {
+  TransactionLock::MutexSet mtx_set;
+#ifndef BINOM_SINGLE_THREAD
+  for(const Variable& variable : variables)
+    if(variable.resource_link.getType() != VarType::invalid_type)
+      mtx_set.emplace(&variable.resource_link.getMutex(), &variable.resource_link.getVersion());
+#endif
+  return TransactionLock(mtx_set, lock_type);
+}
+
 bool Variable::isResourceExist() const noexcept {
   if(auto lk = getLock(MtxLockType::shared_locked); lk)
     return true;
@@ -97,40 +120,19 @@ bool Variable::isResourceExist() const noexcept {
     return false;
 }
 
+// Type is read without lock, see Link::getType
 VarType Variable::getType() const noexcept {
-  if(auto lk = getLock(MtxLockType::shared_locked); lk)
-    return resource_link.getType();
-  else
-    return VarType::null;
+  const VarType type = resource_link.getType();
+  return type == VarType::invalid_type ? VarType::null : type;
 }
 
-VarTypeClass Variable::getTypeClass() const noexcept {
-  if(auto lk = getLock(MtxLockType::shared_locked); lk)
-    return toTypeClass(resource_link.getType());
-  else
-    return VarTypeClass::null;
-}
+VarTypeClass Variable::getTypeClass() const noexcept {return toTypeClass(getType());}
 
-ValType Variable::getValType() const noexcept {
-  if(auto lk = getLock(MtxLockType::shared_locked); lk)
-    return toValueType(resource_link.getType());
-  else
-    return ValType::invalid_type;
-}
+ValType Variable::getValType() const noexcept {return toValueType(resource_link.getType());}
 
-VarBitWidth Variable::getBitWidth() const noexcept {
-  if(auto lk = getLock(MtxLockType::shared_locked); lk)
-    return toBitWidth(resource_link.getType());
-  else
-    return VarBitWidth::invalid_type;
-}
+VarBitWidth Variable::getBitWidth() const noexcept {return toBitWidth(resource_link.getType());}
 
-VarNumberType Variable::getNumberType() const noexcept {
-  if(auto lk = getLock(MtxLockType::shared_locked); lk)
-    return toNumberType(resource_link.getType());
-  else
-    return VarNumberType::invalid_type;
-}
+VarNumberType Variable::getNumberType() const noexcept {return toNumberType(resource_link.getType());}
 
 size_t Variable::getElementCount() const noexcept {
   auto lk = getLock(MtxLockType::shared_locked);
@@ -143,9 +145,8 @@ size_t Variable::getElementCount() const noexcept {
   case VarTypeClass::array: return toArray().getElementCount();
   case VarTypeClass::list: return toList().getElementCount();
   case VarTypeClass::map: return toMap().getElementCount();
-  case VarTypeClass::multimap:
-    // TODO
-  break;
+  case VarTypeClass::multimap: return toMultiMap().getElementCount();
+  case VarTypeClass::hash_map: return toHashMap().getElementCount();
   case VarTypeClass::table:
     // TODO
   break;
@@ -165,7 +166,8 @@ size_t Variable::getElementSize() const noexcept {
   case binom::VarTypeClass::buffer_array: return size_t(getBitWidth());
   case binom::VarTypeClass::array:
   case binom::VarTypeClass::list: return sizeof (Link);
-  case binom::VarTypeClass::map: return sizeof (KeyValue) + sizeof (Link);
+  case binom::VarTypeClass::map:
+  case binom::VarTypeClass::hash_map: return sizeof (KeyValue) + sizeof (Link);
   default:
   case binom::VarTypeClass::invalid_type: return 0;
   }
@@ -178,103 +180,117 @@ ui64 Variable::getLinkCount() const noexcept {
 }
 
 Variable::operator Number&() {
-  auto lk = getLock(MtxLockType::shared_locked);
-  if(!lk) throw Error(ErrorType::binom_resource_not_available);
-  if(getTypeClass() != VarTypeClass::number) throw Error(ErrorType::binom_invalid_type);
+  const VarType type = resource_link.getType();
+  if(type == VarType::invalid_type) throw Error(ErrorType::binom_resource_not_available);
+  if(toTypeClass(type) != VarTypeClass::number) throw Error(ErrorType::binom_invalid_type);
   return reinterpret_cast<Number&>(self);
 }
 
 Variable::operator BitArray&() {
-  auto lk = getLock(MtxLockType::shared_locked);
-  if(!lk) throw Error(ErrorType::binom_resource_not_available);
-  if(getTypeClass() != VarTypeClass::bit_array) throw Error(ErrorType::binom_invalid_type);
+  const VarType type = resource_link.getType();
+  if(type == VarType::invalid_type) throw Error(ErrorType::binom_resource_not_available);
+  if(toTypeClass(type) != VarTypeClass::bit_array) throw Error(ErrorType::binom_invalid_type);
   return reinterpret_cast<BitArray&>(self);
 }
 
 Variable::operator BufferArray&() {
-  auto lk = getLock(MtxLockType::shared_locked);
-  if(!lk) throw Error(ErrorType::binom_resource_not_available);
-  if(getTypeClass() != VarTypeClass::buffer_array) throw Error(ErrorType::binom_invalid_type);
+  const VarType type = resource_link.getType();
+  if(type == VarType::invalid_type) throw Error(ErrorType::binom_resource_not_available);
+  if(toTypeClass(type) != VarTypeClass::buffer_array) throw Error(ErrorType::binom_invalid_type);
   return reinterpret_cast<BufferArray&>(self);
 }
 
 Variable::operator Array&() {
-  auto lk = getLock(MtxLockType::shared_locked);
-  if(!lk) throw Error(ErrorType::binom_resource_not_available);
-  if(getTypeClass() != VarTypeClass::array) throw Error(ErrorType::binom_invalid_type);
+  const VarType type = resource_link.getType();
+  if(type == VarType::invalid_type) throw Error(ErrorType::binom_resource_not_available);
+  if(toTypeClass(type) != VarTypeClass::array) throw Error(ErrorType::binom_invalid_type);
   return reinterpret_cast<Array&>(self);
 }
 
 Variable::operator List&() {
-  auto lk = getLock(MtxLockType::shared_locked);
-  if(!lk) throw Error(ErrorType::binom_resource_not_available);
-  if(getTypeClass() != VarTypeClass::list) throw Error(ErrorType::binom_invalid_type);
+  const VarType type = resource_link.getType();
+  if(type == VarType::invalid_type) throw Error(ErrorType::binom_resource_not_available);
+  if(toTypeClass(type) != VarTypeClass::list) throw Error(ErrorType::binom_invalid_type);
   return reinterpret_cast<List&>(self);
 }
 
 Variable::operator Map&() {
-  auto lk = getLock(MtxLockType::shared_locked);
-  if(!lk) throw Error(ErrorType::binom_resource_not_available);
-  if(getTypeClass() != VarTypeClass::map) throw Error(ErrorType::binom_invalid_type);
+  const VarType type = resource_link.getType();
+  if(type == VarType::invalid_type) throw Error(ErrorType::binom_resource_not_available);
+  if(toTypeClass(type) != VarTypeClass::map) throw Error(ErrorType::binom_invalid_type);
   return reinterpret_cast<Map&>(self);
 }
 
 Variable::operator MultiMap&() {
-  auto lk = getLock(MtxLockType::shared_locked);
-  if(!lk) throw Error(ErrorType::binom_resource_not_available);
-  if(getTypeClass() != VarTypeClass::multimap) throw Error(ErrorType::binom_invalid_type);
+  const VarType type = resource_link.getType();
+  if(type == VarType::invalid_type) throw Error(ErrorType::binom_resource_not_available);
+  if(toTypeClass(type) != VarTypeClass::multimap) throw Error(ErrorType::binom_invalid_type);
   return reinterpret_cast<MultiMap&>(self);
 }
 
+Variable::operator HashMap&() {
+  const VarType type = resource_link.getType();
+  if(type == VarType::invalid_type) throw Error(ErrorType::binom_resource_not_available);
+  if(toTypeClass(type) != VarTypeClass::hash_map) throw Error(ErrorType::binom_invalid_type);
+  return reinterpret_cast<HashMap&>(self);
+}
+
 Variable::operator const Number&() const {
-  auto lk = getLock(MtxLockType::shared_locked);
-  if(!lk) throw Error(ErrorType::binom_resource_not_available);
-  if(getTypeClass() != VarTypeClass::number) throw Error(ErrorType::binom_invalid_type);
+  const VarType type = resource_link.getType();
+  if(type == VarType::invalid_type) throw Error(ErrorType::binom_resource_not_available);
+  if(toTypeClass(type) != VarTypeClass::number) throw Error(ErrorType::binom_invalid_type);
   return reinterpret_cast<const Number&>(self);
 }
 
 Variable::operator const BitArray&() const {
-  auto lk = getLock(MtxLockType::shared_locked);
-  if(!lk) throw Error(ErrorType::binom_resource_not_available);
-  if(getTypeClass() != VarTypeClass::bit_array) throw Error(ErrorType::binom_invalid_type);
+  const VarType type = resource_link.getType();
+  if(type == VarType::invalid_type) throw Error(ErrorType::binom_resource_not_available);
+  if(toTypeClass(type) != VarTypeClass::bit_array) throw Error(ErrorType::binom_invalid_type);
   return reinterpret_cast<const BitArray&>(self);
 }
 
 Variable::operator const BufferArray&() const {
-  auto lk = getLock(MtxLockType::shared_locked);
-  if(!lk) throw Error(ErrorType::binom_resource_not_available);
-  if(getTypeClass() != VarTypeClass::buffer_array) throw Error(ErrorType::binom_invalid_type);
+  const VarType type = resource_link.getType();
+  if(type == VarType::invalid_type) throw Error(ErrorType::binom_resource_not_available);
+  if(toTypeClass(type) != VarTypeClass::buffer_array) throw Error(ErrorType::binom_invalid_type);
   return reinterpret_cast<const BufferArray&>(self);
 }
 
 Variable::operator const Array&() const {
-  auto lk = getLock(MtxLockType::shared_locked);
-  if(!lk) throw Error(ErrorType::binom_resource_not_available);
-  if(getTypeClass() != VarTypeClass::array) throw Error(ErrorType::binom_invalid_type);
+  const VarType type = resource_link.getType();
+  if(type == VarType::invalid_type) throw Error(ErrorType::binom_resource_not_available);
+  if(toTypeClass(type) != VarTypeClass::array) throw Error(ErrorType::binom_invalid_type);
   return reinterpret_cast<const Array&>(self);
 }
 
 Variable::operator const List&() const {
-  auto lk = getLock(MtxLockType::shared_locked);
-  if(!lk) throw Error(ErrorType::binom_resource_not_available);
-  if(getTypeClass() != VarTypeClass::list) throw Error(ErrorType::binom_invalid_type);
+  const VarType type = resource_link.getType();
+  if(type == VarType::invalid_type) throw Error(ErrorType::binom_resource_not_available);
+  if(toTypeClass(type) != VarTypeClass::list) throw Error(ErrorType::binom_invalid_type);
   return reinterpret_cast<const List&>(self);
 }
 
 Variable::operator const Map&() const {
-  auto lk = getLock(MtxLockType::shared_locked);
-  if(!lk) throw Error(ErrorType::binom_resource_not_available);
-  if(getTypeClass() != VarTypeClass::map) throw Error(ErrorType::binom_invalid_type);
+  const VarType type = resource_link.getType();
+  if(type == VarType::invalid_type) throw Error(ErrorType::binom_resource_not_available);
+  if(toTypeClass(type) != VarTypeClass::map) throw Error(ErrorType::binom_invalid_type);
   return reinterpret_cast<const Map&>(self);
 }
 
 Variable::operator const MultiMap&() const {
-  auto lk = getLock(MtxLockType::shared_locked);
-  if(!lk) throw Error(ErrorType::binom_resource_not_available);
-  if(getTypeClass() != VarTypeClass::multimap) throw Error(ErrorType::binom_invalid_type);
+  const VarType type = resource_link.getType();
+  if(type == VarType::invalid_type) throw Error(ErrorType::binom_resource_not_available);
+  if(toTypeClass(type) != VarTypeClass::multimap) throw Error(ErrorType::binom_invalid_type);
   return reinterpret_cast<const MultiMap&>(self);
 }
 
+Variable::operator const HashMap&() const {
+  const VarType type = resource_link.getType();
+  if(type == VarType::invalid_type) throw Error(ErrorType::binom_resource_not_available);
+  if(toTypeClass(type) != VarTypeClass::hash_map) throw Error(ErrorType::binom_invalid_type);
+  return reinterpret_cast<const HashMap&>(self);
+}
+
 Number& Variable::toNumber() {return self;}
 BitArray& Variable::toBitArray() {return self;}
 BufferArray& Variable::toBufferArray() {return self;}
@@ -282,6 +298,7 @@ Array& Variable::toArray() {return self;}
 List& Variable::toList() {return self;}
 Map& Variable::toMap() {return self;}
 MultiMap& Variable::toMultiMap() {return self;}
+HashMap& Variable::toHashMap() {return self;}
 
 const Number& Variable::toNumber() const {return self;}
 const BitArray& Variable::toBitArray() const {return self;}
@@ -290,12 +307,13 @@ const Array& Variable::toArray() const {return self;}
 const List& Variable::toList() const {return self;}
 const Map& Variable::toMap() const {return self;}
 const MultiMap& Variable::toMultiMap() const {return self;}
+const HashMap& Variable::toHashMap() const {return self;}
 
 Variable& Variable::operator=(const Variable& other) {
   if(this == &other) return self;
   auto lk = getLock(MtxLockType::unique_locked);
   if(!lk) return self;
-  resource_link.overwriteWithResourceCopy(**other.resource_link);
+  resource_link.overwriteWithResourceCopy(other.resource_link);
   return self;
 }
 
@@ -303,7 +321,7 @@ Variable& Variable::operator=(Variable&& other) {
   if(this == &other) return self;
   auto lk = getLock(MtxLockType::unique_locked);
   if(!lk) return self;
-  resource_link.overwriteWithResourceCopy(**other.resource_link);
+  resource_link.overwriteWithResourceCopy(other.resource_link);
   return self;
 }
 
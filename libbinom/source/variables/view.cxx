@@ -0,0 +1,221 @@
+#include "libbinom/include/variables/view.hxx"
+#include "libbinom/include/binom_impl/serialization.hxx"
+#include "libbinom/include/binom_impl/ram_storage_implementation/bit_array_impl.hxx"
+#include "libbinom/include/binom_impl/ram_storage_implementation/buffer_array_impl.hxx"
+
+#include <algorithm>
+
+using namespace binom;
+using namespace binom::priv::serialization;
+
+namespace {
+
+inline void checkRange(const byte* it, size_t size, const byte* end) {
+  if(!it || it > end || size > size_t(end - it)) throw err::Error(err::ErrorType::invalid_data);
+}
+
+inline arithmetic::ArithmeticData readNumber(const byte* data, VarBitWidth bit_width) noexcept {
+  arithmetic::ArithmeticData number{.ui64_val = 0};
+  std::memcpy(&number, data, size_t(bit_width));
+  return number;
+}
+
+inline bool getBit(const byte* data, size_t index) noexcept {return (data[index / 8] >> (index % 8)) & 1;}
+
+}
+
+// View
+
+View::View(const byte* node, const byte* buffer_end) : node(node), buffer_end(buffer_end) {checkRange(node, sizeof(VarType), buffer_end);}
+
+View::View(const std::vector<byte>& buffer) : View(buffer.data(), buffer.size()) {}
+
+View::View(const byte* data, size_t size) {
+  checkRange(data, sizeof(Header), data + size);
+  Header header;
+  std::memcpy(&header, data, sizeof(Header));
+  if(std::memcmp(header.magic, format_magic, sizeof(format_magic)) || header.version != format_version ||
+     !(ui8(header.flags) & ui8(FormatFlags::indexed)))
+    throw err::Error(err::ErrorType::invalid_data);
+  node = data + sizeof(Header);
+  buffer_end = data + size;
+  checkRange(node, sizeof(VarType), buffer_end);
+  checkRange(node, getNodeSize(), buffer_end);
+}
+
+ui64 View::readUi64(size_t offset) const {
+  checkRange(node + offset, sizeof(ui64), buffer_end);
+  ui64 value;
+  std::memcpy(&value, node + offset, sizeof(ui64));
+  return value;
+}
+
+size_t View::getNodeSize() const {
+  const VarType type = getType();
+  switch (toTypeClass(type)) {
+  case VarTypeClass::null: return sizeof(VarType);
+  case VarTypeClass::number: return sizeof(VarType) + size_t(toBitWidth(type));
+
+  case VarTypeClass::bit_array: {
+    const ui64 bit_count = readUi64(sizeof(VarType));
+    return container_header_size + bit_count / 8 + (bit_count % 8 ? 1 : 0);
+  }
+
+  case VarTypeClass::buffer_array: {
+    const ui64 element_count = readUi64(sizeof(VarType));
+    if(element_count > size_t(buffer_end - node) / size_t(toBitWidth(type))) throw err::Error(err::ErrorType::invalid_data);
+    return container_header_size + element_count * size_t(toBitWidth(type));
+  }
+
+  case VarTypeClass::array:
+  case VarTypeClass::list:
+  case VarTypeClass::map:
+  case VarTypeClass::multimap:
+  case VarTypeClass::hash_map: {
+    const ui64 element_count = readUi64(sizeof(VarType));
+    if(element_count > size_t(buffer_end - node) / sizeof(ui64)) throw err::Error(err::ErrorType::invalid_data);
+    const ui64 body_size = readUi64(container_header_size);
+    if(body_size > size_t(buffer_end - node)) throw err::Error(err::ErrorType::invalid_data);
+    return container_header_size + getContainerIndexSize(element_count) + body_size;
+  }
+
+  default: throw err::Error(err::ErrorType::invalid_data);
+  }
+}
+
+const byte* View::getContainerBody() const {
+  return node + container_header_size + getContainerIndexSize(readUi64(sizeof(VarType)));
+}
+
+View View::getContainerElement(size_t index) const {
+  if(index >= readUi64(sizeof(VarType))) return View();
+  const ui64 body_size = readUi64(container_header_size);
+  const ui64 offset = readUi64(container_header_size + sizeof(ui64) + index * sizeof(ui64));
+  if(offset >= body_size) throw err::Error(err::ErrorType::invalid_data);
+  const byte* body = getContainerBody();
+  checkRange(body, body_size, buffer_end);
+  return View(body + offset, body + body_size);
+}
+
+VarType View::getType() const noexcept {return node ? VarType(*node) : VarType::invalid_type;}
+VarTypeClass View::getTypeClass() const noexcept {return toTypeClass(getType());}
+ValType View::getValType() const noexcept {return toValueType(getType());}
+VarBitWidth View::getBitWidth() const noexcept {return toBitWidth(getType());}
+
+size_t View::getElementCount() const {
+  switch (getTypeClass()) {
+  case VarTypeClass::number: return 1;
+  case VarTypeClass::bit_array:
+  case VarTypeClass::buffer_array:
+  case VarTypeClass::array:
+  case VarTypeClass::list:
+  case VarTypeClass::map:
+  case VarTypeClass::multimap:
+  case VarTypeClass::hash_map: return readUi64(sizeof(VarType));
+  default: return 0;
+  }
+}
+
+GenericValue View::toNumber() const {
+  if(getTypeClass() != VarTypeClass::number) throw err::Error(err::ErrorType::binom_invalid_type);
+  checkRange(node + sizeof(VarType), size_t(getBitWidth()), buffer_end);
+  return GenericValue(getValType(), readNumber(node + sizeof(VarType), getBitWidth()));
+}
+
+ViewBufferArray View::toBufferArray() const {
+  if(getTypeClass() != VarTypeClass::buffer_array) throw err::Error(err::ErrorType::binom_invalid_type);
+  return self;
+}
+
+ViewArray View::toArray() const {
+  if(getTypeClass() != VarTypeClass::array && getTypeClass() != VarTypeClass::list)
+    throw err::Error(err::ErrorType::binom_invalid_type);
+  return self;
+}
+
+ViewMap View::toMap() const {
+  if(getTypeClass() != VarTypeClass::map && getTypeClass() != VarTypeClass::multimap && getTypeClass() != VarTypeClass::hash_map)
+    throw err::Error(err::ErrorType::binom_invalid_type);
+  return self;
+}
+
+Variable View::toVariable() const {
+  if(!node) return nullptr;
+  MemoryReader reader(node, getNodeSize());
+  checkRange(node, reader.getRemaining(), buffer_end);
+  return Variable::deserializeImpl(reader, true);
+}
+
+// ViewBufferArray
+
+ViewBufferArray::ViewBufferArray(View view) : View(view) {checkRange(node, getNodeSize(), buffer_end);}
+
+size_t ViewBufferArray::getElementCount() const {return readUi64(sizeof(VarType));}
+
+const void* ViewBufferArray::getData() const {return node + container_header_size;}
+
+const GenericValueRef ViewBufferArray::operator[](size_t index) const {
+  if(index >= getElementCount()) return GenericValueRef(ValType::invalid_type, nullptr);
+  return GenericValueRef(getValType(), const_cast<byte*>(node + container_header_size + index * size_t(getBitWidth())));
+}
+
+ViewBufferArray::ConstIterator ViewBufferArray::begin() const {
+  return GenericValueIterator(getValType(), const_cast<byte*>(node + container_header_size));
+}
+
+ViewBufferArray::ConstIterator ViewBufferArray::end() const {
+  return GenericValueIterator(getValType(), const_cast<byte*>(node + container_header_size + getElementCount() * size_t(getBitWidth())));
+}
+
+// ViewArray
+
+ViewArray::ViewArray(View view) : View(view) {checkRange(node, getNodeSize(), buffer_end);}
+
+size_t ViewArray::getElementCount() const {return readUi64(sizeof(VarType));}
+
+View ViewArray::operator[](size_t index) const {return getContainerElement(index);}
+
+ViewArray::Iterator ViewArray::begin() const {return Iterator(this, 0);}
+ViewArray::Iterator ViewArray::end() const {return Iterator(this, getElementCount());}
+
+// ViewMap
+
+ViewMap::ViewMap(View view) : View(view) {checkRange(node, getNodeSize(), buffer_end);}
+
+size_t ViewMap::getElementCount() const {return readUi64(sizeof(VarType));}
+
+View ViewMap::getKey(size_t index) const {return getContainerElement(index);}
+
+View ViewMap::getValue(size_t index) const {
+  View key = getContainerElement(index);
+  if(!key) return View();
+  return View(key.node + key.getNodeSize(), key.buffer_end);
+}
+
+KeyValue::CompareResult ViewMap::compareKey(const View& encoded_key, const KeyValue& key) {
+  // Key is decoded to be ordered by KeyValue::getCompare exactly as in Map,
+  // numbers and short buffers are decoded without allocation
+  checkRange(encoded_key.node, encoded_key.getNodeSize(), encoded_key.buffer_end);
+  MemoryReader reader(encoded_key.node, encoded_key.getNodeSize());
+  return Variable::deserializeKeyImpl(reader).getCompare(const_cast<KeyValue&>(key));
+}
+
+size_t ViewMap::lowerBound(const KeyValue& key) const {
+  size_t first = 0, last = getElementCount();
+  while(first < last) {
+    const size_t middle = first + (last - first) / 2;
+    if(compareKey(getKey(middle), key) == KeyValue::CompareResult::lower) first = middle + 1;
+    else last = middle;
+  }
+  return first;
+}
+
+size_t ViewMap::find(const KeyValue& key) const {
+  const size_t index = lowerBound(key);
+  if(index < getElementCount() && compareKey(getKey(index), key) == KeyValue::CompareResult::equal) return index;
+  return getElementCount();
+}
+
+bool ViewMap::contains(const KeyValue& key) const {return find(key) != getElementCount();}
+
+View ViewMap::operator[](const KeyValue& key) const {return getValue(find(key));}
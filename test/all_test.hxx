@@ -10,7 +10,14 @@
 #include "avl_tree_test.hxx"
 #include "map_test.hxx"
 #include "multi_map_test.hxx"
+#include "hash_map_test.hxx"
 #include "variable_test.hxx"
+#include "serialization_test.hxx"
+#include "link_test.hxx"
+#include "view_test.hxx"
+#include "file_storage_test.hxx"
+#include "mapped_storage_test.hxx"
+#include "persistent_test.hxx"
 
 #include "bugs.hxx"
 
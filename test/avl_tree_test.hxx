@@ -3,10 +3,14 @@
 
 #include "tester.hxx"
 #include "libbinom/include/binom_impl/avl_tree.hxx"
+#include "libbinom/include/binom_impl/multi_avl_tree.hxx"
 #include "libbinom/include/variables/key_value.hxx"
 #include "libbinom/include/utils/reverse_iterator.hxx"
 #include "print_variable.hxx"
 
+#include <random>
+#include <set>
+
 void printAVLTree(binom::priv::AVLTree& avl_tree) {
   TEST_ANNOUNCE(AVL Tree print:)
   GRP_PUSH
@@ -19,6 +23,7 @@ void printAVLTree(binom::priv::AVLTree& avl_tree) {
 void testAVLTree() {
   using namespace binom;
   using namespace binom::priv;
+  using namespace binom::literals;
   using AVLNode = AVLTree::AVLNode;
 
   RAIIPerfomanceTest test_perf("AVLTree test: ");
@@ -75,6 +80,250 @@ void testAVLTree() {
     printAVLTree(avl_tree);
 
   GRP_POP
+
+  TEST_ANNOUNCE(ValueStoringAVLTree nodes allocation...)
+  GRP_PUSH
+  {
+    ValueStoringAVLTree<i64> slab_tree;
+    ValueStoringAVLTree<i64, std::allocator> heap_tree;
+    for(int round = 0; round < 2; ++round) {
+      for(i64 i = 0; i < 1000; ++i) {
+        slab_tree.insert((i * 7919) % 1000, i);
+        heap_tree.insert((i * 7919) % 1000, i);
+      }
+      TEST(slab_tree.insert(5_i64, 0) == nullptr);
+      size_t slab_count = 0, heap_count = 0;
+      for(auto& node : slab_tree) slab_count += node.getValue() >= 0;
+      for(auto& node : heap_tree) heap_count += node.getValue() >= 0;
+      TEST(slab_count == 1000 && heap_count == 1000);
+      // Slabs are freed by clear and allocated again in next round
+      slab_tree.clear();
+      heap_tree.clear();
+      TEST(slab_tree.isEmpty() && heap_tree.isEmpty());
+    }
+  }
+  GRP_POP
+
+  TEST_ANNOUNCE(Bulk load of sorted nodes...)
+  GRP_PUSH
+  {
+    std::vector<AVLNode*> nodes;
+    for(i64 i = 0; i < 1000; ++i) nodes.push_back(new AVLNode(KeyValue(i)));
+    AVLTree avl_tree;
+    std::swap(nodes[10], nodes[11]);
+    TEST(avl_tree.bulkLoadChecked(nodes.data(), nodes.size()) == err::ErrorType::invalid_data);
+    TEST(avl_tree.isEmpty());
+    std::swap(nodes[10], nodes[11]);
+    TEST(!avl_tree.bulkLoadChecked(nodes.data(), nodes.size()));
+    i64 expected = 0;
+    bool is_sorted = true;
+    for(auto& node : avl_tree) is_sorted &= node.getKey() == KeyValue(expected++);
+    TEST(is_sorted && expected == 1000);
+    TEST(avl_tree.get(500_i64) != nullptr);
+    // Perfectly balanced tree keeps AVL invariants for later changes
+    PRINT_RUN(delete avl_tree.extract(500_i64));
+    TEST(avl_tree.insert(new AVLNode(KeyValue(500_i64))) != nullptr);
+    avl_tree.clear();
+
+    ValueStoringAVLTree<i64> value_tree;
+    i64 key = 0;
+    value_tree.bulkLoad(100, [&key]() { ++key; return std::pair<KeyValue, i64>(key, key * 10); });
+    i64 sum = 0;
+    for(auto& node : value_tree) sum += node.getValue();
+    TEST(sum == 50500);
+    key = 0;
+    TEST(value_tree.bulkLoadChecked(100, [&key]() { ++key; return std::pair<KeyValue, i64>(key % 50, key); }) == err::ErrorType::invalid_data);
+    TEST(value_tree.bulkLoadChecked(2, [&key]() { return std::pair<KeyValue, i64>(key, key); }) == err::ErrorType::binom_key_unique_error);
+    TEST(value_tree.isEmpty());
+
+    std::vector<MultiAVLTree::KeyNodePair> elements;
+    for(i64 i = 0; i < 300; ++i) elements.push_back({KeyValue(i / 3), new MultiAVLTree::AVLNode()});
+    MultiAVLTree multi_tree;
+    std::swap(elements[0], elements[299]);
+    TEST(multi_tree.bulkLoadChecked(elements.data(), elements.size()) == err::ErrorType::invalid_data);
+    std::swap(elements[0], elements[299]);
+    TEST(!multi_tree.bulkLoadChecked(elements.data(), elements.size()));
+    size_t key_count = 0, node_count = 0;
+    bool is_grouped = true;
+    for(auto it = multi_tree.begin(); it != multi_tree.end(); it.goToNextKey())
+      is_grouped &= it.getKey() == KeyValue(i64(key_count++)) && it.getElementCount() == 3;
+    for(auto it = multi_tree.begin(); it != multi_tree.end(); ++it) is_grouped &= &*it == elements[node_count++].node;
+    TEST(is_grouped && key_count == 100 && node_count == 300);
+    multi_tree.clear();
+  }
+  GRP_POP
+
+  TEST_ANNOUNCE(Order statistics...)
+  GRP_PUSH
+  {
+    std::mt19937_64 random(42);
+    std::set<i64> expected;
+    ValueStoringAVLTree<i64> tree;
+    std::multiset<i64> expected_multi;
+    MultiAVLTree multi_tree;
+    for(size_t i = 0; i < 20000; ++i) {
+      const i64 key = i64(random() % 5000);
+      if(random() % 3) {
+        if(expected.insert(key).second) tree.insert(key, key);
+        expected_multi.insert(key);
+        multi_tree.insert(key, new MultiAVLTree::AVLNode());
+      } else {
+        if(expected.erase(key)) tree.destroyNode(tree.extract(key));
+        if(auto it = multi_tree.find(key); it) {
+          expected_multi.erase(expected_multi.find(key));
+          delete multi_tree.extract(it);
+        }
+      }
+    }
+    size_t index = 0;
+    bool is_matched = true;
+    for(i64 key : expected) {
+      is_matched &= tree.select(index)->getKey() == KeyValue(key) && tree.rank(key) == index && tree.rank(key + 1) == index + 1;
+      ++index;
+    }
+    TEST(is_matched);
+    TEST(tree.select(expected.size()) == nullptr);
+    TEST(tree.countRange(1000_i64, 2000_i64) == size_t(std::distance(expected.lower_bound(1000), expected.lower_bound(2000))));
+
+    index = 0;
+    size_t key_index = 0;
+    for(auto it = expected_multi.begin(); it != expected_multi.end(); ++it, ++index) {
+      if(it == expected_multi.begin() || *std::prev(it) != *it) key_index = index;
+      is_matched &= multi_tree.select(index).getKey() == KeyValue(*it) && multi_tree.rank(*it) == key_index;
+    }
+    TEST(is_matched);
+    TEST(!multi_tree.select(expected_multi.size()));
+    TEST(multi_tree.countRange(1000_i64, 2000_i64) == size_t(std::distance(expected_multi.lower_bound(1000), expected_multi.lower_bound(2000))));
+    multi_tree.clear();
+  }
+  GRP_POP
+
+  TEST_ANNOUNCE(Split join and range erasing...)
+  GRP_PUSH
+  {
+    // Trees are checked by iteration, which follows parent links, and by select, which follows subtree sizes
+    auto is_tree_matched = [](const auto& tree, const auto& expected) {
+      size_t index = 0;
+      auto it = tree.begin();
+      for(i64 key : expected) {
+        if(it == tree.end() || it->getKey() != KeyValue(key) || tree.select(index++)->getKey() != KeyValue(key)) return false;
+        ++it;
+      }
+      return it == tree.end();
+    };
+    auto is_multi_tree_matched = [](const MultiAVLTree& tree, const std::multiset<i64>& expected) {
+      size_t index = 0;
+      auto it = tree.begin();
+      for(i64 key : expected) {
+        if(!it || it.getKey() != KeyValue(key) || tree.select(index++).getKey() != KeyValue(key)) return false;
+        ++it;
+      }
+      return !it;
+    };
+
+    std::mt19937_64 random(7);
+    std::set<i64> expected;
+    AVLTree avl_tree;
+    for(size_t i = 0; i < 10000; ++i) {
+      const i64 key = i64(random() % 20000);
+      if(expected.insert(key).second) avl_tree.insert(new AVLNode(KeyValue(key)));
+    }
+    bool is_erased = true;
+    for(size_t i = 0; i < 100; ++i) {
+      const i64 first = i64(random() % 20000), last = first + i64(random() % 300);
+      const size_t count = std::distance(expected.lower_bound(first), expected.lower_bound(last));
+      expected.erase(expected.lower_bound(first), expected.lower_bound(last));
+      is_erased &= avl_tree.eraseRange(first, last) == count;
+    }
+    TEST(is_erased);
+    TEST(is_tree_matched(avl_tree, expected));
+
+    AVLTree upper = avl_tree.split(10000_i64);
+    const std::set<i64> expected_lower(expected.begin(), expected.lower_bound(10000)), expected_upper(expected.lower_bound(10000), expected.end());
+    TEST(is_tree_matched(avl_tree, expected_lower));
+    TEST(is_tree_matched(upper, expected_upper));
+    upper.insert(new AVLNode(KeyValue(5000_i64)));
+    TEST(!avl_tree.join(upper));
+    delete upper.extract(5000_i64);
+    // Lower tree is joined to higher one
+    TEST(upper.join(avl_tree));
+    TEST(avl_tree.isEmpty());
+    TEST(is_tree_matched(upper, expected));
+    upper.clear();
+
+    ValueStoringAVLTree<i64> tree, higher_tree;
+    for(i64 i = 0; i < 1000; ++i) tree.insert(i, i);
+    for(i64 i = 1000; i < 3000; ++i) higher_tree.insert(i, i);
+    // Slabs of joined tree are taken with its nodes
+    TEST(tree.join(higher_tree));
+    TEST(higher_tree.isEmpty());
+    higher_tree.insert(-1_i64, -1);
+    TEST(!higher_tree.join(higher_tree));
+    TEST(tree.eraseRange(500_i64, 2500_i64) == 2000);
+    TEST(tree.join(higher_tree));
+    std::set<i64> expected_values{-1};
+    for(i64 i = 0; i < 500; ++i) expected_values.insert(i);
+    for(i64 i = 2500; i < 3000; ++i) expected_values.insert(i);
+    TEST(is_tree_matched(tree, expected_values));
+
+    std::multiset<i64> expected_multi;
+    MultiAVLTree multi_tree;
+    for(size_t i = 0; i < 10000; ++i) {
+      const i64 key = i64(random() % 2000);
+      expected_multi.insert(key);
+      multi_tree.insert(key, new MultiAVLTree::AVLNode());
+    }
+    is_erased = true;
+    for(size_t i = 0; i < 50; ++i) {
+      const i64 first = i64(random() % 2000), last = first + i64(random() % 30);
+      const size_t count = std::distance(expected_multi.lower_bound(first), expected_multi.lower_bound(last));
+      expected_multi.erase(expected_multi.lower_bound(first), expected_multi.lower_bound(last));
+      is_erased &= multi_tree.eraseRange(first, last) == count;
+    }
+    TEST(is_erased);
+    TEST(is_multi_tree_matched(multi_tree, expected_multi));
+
+    // Key nodes of smaller part are moved to pool of new tree in both directions
+    for(i64 split_key : {200_i64, 1800_i64}) {
+      MultiAVLTree multi_upper = multi_tree.split(split_key);
+      TEST(is_multi_tree_matched(multi_tree, std::multiset<i64>(expected_multi.begin(), expected_multi.lower_bound(split_key))));
+      TEST(is_multi_tree_matched(multi_upper, std::multiset<i64>(expected_multi.lower_bound(split_key), expected_multi.end())));
+      TEST(multi_upper.join(multi_tree));
+      TEST(multi_tree.join(multi_upper));
+      TEST(is_multi_tree_matched(multi_tree, expected_multi));
+    }
+
+    // Elements of key present in both trees go to key node of lower tree
+    for(i64 boundary_key : {*expected_multi.rbegin(), *expected_multi.begin()}) {
+      MultiAVLTree boundary_tree;
+      for(size_t i = 0; i < 3; ++i) {
+        boundary_tree.insert(boundary_key, new MultiAVLTree::AVLNode());
+        expected_multi.insert(boundary_key);
+      }
+      TEST(multi_tree.join(boundary_tree));
+      TEST(boundary_tree.isEmpty());
+      TEST(is_multi_tree_matched(multi_tree, expected_multi));
+      TEST(multi_tree.getSize() == expected_multi.size());
+      TEST(multi_tree.countRange(boundary_key, boundary_key + 1) == expected_multi.count(boundary_key));
+    }
+    multi_tree.clear();
+
+    // Pools count blocks of shared slabs, which are kept whole until all sharing pools are released
+    slab_allocator::SlabPool pool(sizeof(i64), alignof(i64)), shared_pool, merged_pool;
+    for(size_t i = 0; i < 100; ++i) pool.allocate();
+    const size_t block_count = pool.getBlockCount();
+    TEST(block_count >= 100 && !pool.isShared());
+    pool.share(shared_pool);
+    TEST(pool.isShared() && pool.getBlockCount() == block_count && shared_pool.getBlockCount() == block_count);
+    TEST(!shared_pool.hasReleasedShares());
+    pool.release();
+    TEST(!pool.getBlockCount() && shared_pool.getBlockCount() == block_count && shared_pool.hasReleasedShares());
+    shared_pool.allocate();
+    merged_pool.reserveMerge(shared_pool);
+    merged_pool.merge(shared_pool);
+    TEST(merged_pool.getBlockCount() > block_count && !shared_pool.getBlockCount() && !shared_pool.isShared());
+  }
+  GRP_POP
   GRP_POP
 }
 
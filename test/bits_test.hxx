@@ -5,6 +5,7 @@
 #include "libbinom/include/variables/bit_array.hxx"
 #include <assert.h>
 #include <array>
+#include <chrono>
 
 
 void printBist(const binom::BitArray& bit_array) {
@@ -56,6 +57,50 @@ void testBits() {
     PRINT_RUN(test.popBack(3));
     printBist(test);
   );
+
+#ifdef PERFOMANCE_TEST
+  constexpr size_t append_count = 10000000;
+#else
+  constexpr size_t append_count = 1000000;
+#endif
+  TEST_ANNOUNCE(Test BitArray append); GRP_PUSH;
+  {
+    BitArray bit_array;
+    const auto start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < append_count; ++i) bit_array.pushBack(i % 3 == 0);
+    const double duration = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    LOG("BitArray::pushBack of " << append_count << " bits: " << duration << " ms");
+    TEST(bit_array.getElementCount() == append_count);
+    TEST(bool(bit_array[0]) && bool(bit_array[append_count - 1]) == ((append_count - 1) % 3 == 0));
+
+    LOG("Capacity at least doubles on each growth, so append is amortized O(1)");
+    BitArray grown;
+    bool is_doubled = true;
+    for(size_t i = 0; i < 100000; ++i) {
+      const size_t capacity = grown.getElementCapacity();
+      grown.pushBack(true);
+      if(grown.getElementCapacity() != capacity) is_doubled &= grown.getElementCapacity() >= capacity * 2;
+    }
+    TEST(is_doubled);
+  } GRP_POP;
+
+  TEST_ANNOUNCE(Test BitArray capacity control);
+  GRP(
+    BitArray bit_array = BitArray::zeroed(1000);
+    TEST(bit_array.getElementCount() == 1000);
+    bool is_zeroed = true;
+    for(size_t i = 0; i < 1000; ++i) is_zeroed &= !bool(bit_array[i]);
+    TEST(is_zeroed);
+    bit_array.reserve(8000);
+    TEST(bit_array.getElementCapacity() == 8000);
+    for(size_t i = 0; i < 7000; ++i) bit_array.pushBack(i % 2);
+    TEST(bit_array.getElementCapacity() == 8000);
+    TEST(bool(bit_array[7999]) && !bool(bit_array[7998]));
+    bit_array.popBack(4000);
+    bit_array.shrinkToFit();
+    TEST(bit_array.getElementCapacity() == 4000);
+    TEST(bool(bit_array[3999]));
+  );
 }
 
 #endif // BITS_TEST_H
@@ -5,6 +5,8 @@
 #include "libbinom/include/variables/buffer_array.hxx"
 #include "print_variable.hxx"
 
+#include <chrono>
+#include <string>
 
 void testBufferArray() {
   RAIIPerfomanceTest test_perf("Bits test: ");
@@ -50,6 +52,105 @@ void testBufferArray() {
   BufferArray f64_array = f64arr{0,1.7E-308,-1.7E-308};
   PRINT_RUN(printVariable(f64_array));
 
+#ifdef PERFOMANCE_TEST
+  constexpr ui64 append_count = 10000000;
+#else
+  constexpr ui64 append_count = 100000;
+#endif
+  LOG("Append of " << append_count << " elements:");
+  {
+    BufferArray buffer = ui64arr{};
+    const auto start = std::chrono::steady_clock::now();
+    for(ui64 i = 0; i < append_count; ++i) buffer.pushBack(i);
+    const double duration = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    LOG("BufferArray::pushBack: " << duration << " ms");
+    TEST(buffer.getElementCount() == append_count);
+    TEST(ui64(buffer[0]) == 0 && ui64(buffer[append_count - 1]) == append_count - 1);
+
+    LOG("Capacity at least doubles on each growth, so append is amortized O(1)");
+    BufferArray grown = ui64arr{};
+    bool is_doubled = true;
+    for(ui64 i = 0; i < 100000; ++i) {
+      const size_t capacity = grown.getElementCapacity();
+      grown.pushBack(i);
+      if(grown.getElementCapacity() != capacity) is_doubled &= grown.getElementCapacity() >= capacity * 2;
+    }
+    TEST(is_doubled);
+
+    // Capacity left by popped elements is reused
+    buffer.popBack(append_count / 2);
+    for(ui64 i = 0; i < append_count / 2; ++i) buffer.pushBack(i);
+    TEST(buffer.getElementCount() == append_count);
+    TEST(ui64(buffer[append_count / 2]) == 0);
+  }
+
+  LOG("Capacity control:");
+  {
+    BufferArray buffer = BufferArray::zeroed(VarType::ui32_array, 1000);
+    TEST(buffer.getElementCount() == 1000);
+    bool is_zeroed = true;
+    for(size_t i = 0; i < 1000; ++i) is_zeroed &= ui32(buffer[i]) == 0;
+    TEST(is_zeroed);
+    buffer.reserve(100000);
+    TEST(buffer.getElementCapacity() == 100000);
+    for(ui32 i = 0; i < 99000; ++i) buffer.pushBack(i);
+    TEST(buffer.getElementCapacity() == 100000);
+    buffer.popBack(50000);
+    buffer.shrinkToFit();
+    TEST(buffer.getElementCapacity() == 50000);
+    TEST(ui32(buffer[49999]) == 48999);
+
+    bool is_thrown = false;
+    try { buffer.reserve(std::numeric_limits<size_t>::max()); } catch(const std::bad_alloc&) { is_thrown = true; }
+    TEST(is_thrown);
+    TEST(buffer.getElementCapacity() == 50000);
+
+    is_thrown = false;
+    try { BufferArray::zeroed(VarType::array, 1); } catch(const err::Error&) { is_thrown = true; }
+    TEST(is_thrown);
+  }
+
+  LOG("Short byte buffer is stored inline:");
+  {
+    // Data of short buffer is kept in storage of variable, so it takes no heap block
+    using binom::priv::BufferArrayImplementation;
+    binom::priv::BufferArrayStorage storage = BufferArrayImplementation::create(std::string_view("abc"));
+    const byte* storage_begin = reinterpret_cast<const byte*>(&storage);
+    TEST(BufferArrayImplementation::isInline(storage));
+    TEST(BufferArrayImplementation::getData(storage) >= storage_begin &&
+         BufferArrayImplementation::getData(storage) + 3 <= storage_begin + sizeof(storage));
+    BufferArrayImplementation::destroy(storage);
+    storage = BufferArrayImplementation::create(std::string_view("abcdefgh"));
+    TEST(!BufferArrayImplementation::isInline(storage));
+    TEST(BufferArrayImplementation::getData(storage) >= storage_begin + sizeof(storage) ||
+         BufferArrayImplementation::getData(storage) + 8 <= storage_begin);
+    BufferArrayImplementation::destroy(storage);
+    TEST(BufferArrayImplementation::isInline(storage) && BufferArrayImplementation::getSize(storage) == 0);
+
+    BufferArray buffer = "abc";
+    TEST(buffer.getCapacity() == sizeof(void*));
+    BufferArray copy = buffer;
+    PRINT_RUN(copy.pushBack('d');)
+    TEST(std::string(copy) == "abcd");
+    TEST(std::string(buffer) == "abc");
+
+    // Buffer is moved to heap when it outgrows pointer
+    for(char symbol : {'d', 'e', 'f', 'g', 'h'}) buffer.pushBack(symbol);
+    TEST(std::string(buffer) == "abcdefgh");
+    TEST(buffer.getCapacity() > sizeof(void*));
+    PRINT_RUN(copy.popFront(2);)
+    TEST(std::string(copy) == "cd");
+    PRINT_RUN(copy[0] = 'x';)
+    TEST(std::string(copy) == "xd");
+
+    const auto data = Variable(copy).serialize();
+    TEST(std::string(Variable::deserialize(data).toBufferArray()) == "xd");
+    TEST(KeyValue(copy) == KeyValue("xd"));
+    TEST(KeyValue("xd").toBufferArray().getCapacity() == sizeof(void*));
+    TEST(BufferArray(ui16arr{}).getElementCount() == 0);
+    TEST(BufferArray::zeroed(VarType::ui16_array, 2).getCapacity() > sizeof(void*));
+  }
+
   GRP_POP;
 }
 
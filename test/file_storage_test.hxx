@@ -0,0 +1,362 @@
+#ifndef FILE_STORAGE_TEST_HXX
+#define FILE_STORAGE_TEST_HXX
+
+#include "tester.hxx"
+#include "libbinom/include/binom.hxx"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <sys/wait.h>
+#include <unistd.h>
+
+void testFileStorage() {
+  using namespace binom;
+  using namespace binom::literals;
+
+  RAIIPerfomanceTest test_perf("File storage test: ");
+  SEPARATOR
+  TEST_ANNOUNCE(File storage test)
+  GRP_PUSH
+
+  const std::string path = "/tmp/binom_file_storage_test_" + std::to_string(::getpid()) + ".bdb";
+  std::remove(path.c_str());
+
+  Variable variable = map{
+    {"name", "BinOM"},
+    {"version", 2_ui16},
+    {"flags", bitarr{1, 0, 1, 1, 0, 0, 1, 0, 1}},
+    {"values", i32arr{-1, 0, 1}},
+    {"array", arr{1, "two", map{{"three", 3}}}},
+    {"tags", multimap{{"a", 1}, {"a", 2}, {"b", 3}}},
+    {-7, 4}
+  };
+
+  {
+    PRINT_RUN(FileStorage storage(path, 512);)
+    TEST(storage.getPageSize() == 512);
+    TEST(storage.getRoot().getType() == VarType::null);
+    const size_t empty_page_count = storage.getUsedPageCount();
+
+    PRINT_RUN(FileVariable root = storage.setRoot(variable);)
+    const size_t stored_page_count = storage.getUsedPageCount();
+    TEST(root.getType() == VarType::map);
+    TEST(root.getElementCount() == variable.getElementCount());
+    TEST(root.toVariable().serialize() == variable.serialize());
+
+    LOG("Lookup:");
+    FileMap root_map = root.toMap();
+    TEST(ui16(root_map["version"].toNumber()) == 2);
+    TEST(i32(root_map[-7].toNumber()) == 4);
+    TEST(!root_map["missing"].isValid());
+    TEST(root_map.contains("tags"));
+    TEST(root_map["flags"].getElementCount() == 9);
+    TEST(root_map["tags"].toMap().find("b") == 2);
+
+    LOG("Array modification:");
+    FileArray array = root_map["array"].toArray();
+    PRINT_RUN(array.pushBack("four");)
+    PRINT_RUN(array.insert(0, 0);)
+    TEST(array.getElementCount() == 5);
+    TEST(i32(array[0].toNumber()) == 0);
+    TEST(i32(array[3].toMap()["three"].toNumber()) == 3);
+    PRINT_RUN(array.remove(1, 2);)
+    TEST(array.toVariable().serialize() == Variable(arr{0, map{{"three", 3}}, "four"}).serialize());
+    TEST(!array[3].isValid());
+
+    LOG("Buffer array modification:");
+    FileBufferArray values = root_map["values"].toBufferArray();
+    std::vector<i32> data(1000);
+    for(size_t i = 0; i < data.size(); ++i) data[i] = i32(i);
+    PRINT_RUN(values.insert(1, data.data(), data.size());)
+    TEST(values.getElementCount() == 1003);
+    TEST(i32(values[0]) == -1);
+    TEST(i32(values[500]) == 499);
+    TEST(i32(values[1002]) == 1);
+    PRINT_RUN(values.remove(1, data.size());)
+    TEST(values.toVariable().serialize() == Variable(i32arr{-1, 0, 1}).serialize());
+
+    LOG("Map modification:");
+    for(i32 i = 0; i < 100; ++i) root_map.insert(i32(1000 + i), Variable(std::string_view("value " + std::to_string(i))));
+    TEST(root_map.getElementCount() == 107);
+    TEST(root_map[i32(1050)].toVariable().serialize() == Variable("value 50").serialize());
+    bool is_thrown = false;
+    try { root_map.insert("name", 0); } catch(const err::Error& error) { is_thrown = error.code() == err::ErrorType::binom_key_unique_error; }
+    TEST(is_thrown);
+    for(i32 i = 0; i < 100; ++i) root_map.remove(i32(1000 + i));
+    TEST(root_map.getElementCount() == 7);
+    TEST(root_map.rename("name", "title") == 1);
+    TEST(!root_map.contains("name"));
+    TEST(root_map["title"].toBufferArray().getElementCount() == 5);
+
+    FileMap tags = root_map["tags"].toMap();
+    PRINT_RUN(tags.insert("a", 0);)
+    TEST(tags.rename("a", "c") == 3);
+    TEST(tags.getKey(0) == "b");
+    TEST(tags.remove("c") == 3);
+    TEST(tags.getElementCount() == 1);
+
+    LOG("Keys of all types are ordered as in RAM map:");
+    {
+      Variable expected = map{};
+      PRINT_RUN(root_map.insert("keys", map{});)
+      FileMap keys = root_map["keys"].toMap();
+      i32 value = 0;
+      for(KeyValue key : {KeyValue("ab"), KeyValue(""), KeyValue("a"), KeyValue(bitarr{1, 0, 1}), KeyValue(bitarr{1, 0}),
+                          KeyValue(i32arr{-1, 0}), KeyValue(f64arr{0.5}), KeyValue(3.5), KeyValue(-1), KeyValue(2_ui8),
+                          KeyValue(1000_ui64), KeyValue()}) {
+        keys.insert(key, value);
+        expected.toMap().insert(key, value++);
+      }
+      bool is_ordered = keys.getElementCount() == expected.getElementCount();
+      size_t position = 0;
+      for(auto it = expected.toMap().begin(); is_ordered && it != expected.toMap().end(); ++it, ++position) {
+        const KeyValue key = keys.getKey(position);
+        is_ordered = key.getType() == it->getKey().getType() && key == it->getKey();
+      }
+      TEST(is_ordered);
+      TEST(keys.getKey(keys.find("a")) == "a");
+      TEST(keys.contains(bitarr{1, 0}));
+      TEST(!keys.contains(bitarr{1, 0, 1, 0}));
+      TEST(!keys.contains("abc"));
+      PRINT_RUN(root_map.remove("keys");)
+    }
+
+    LOG("Map is B+tree of pages:");
+    {
+      PRINT_RUN(root_map.insert("large", map{});)
+      FileMap large = root_map["large"].toMap();
+      const i32 element_count = 20000;
+      size_t max_page_access_count = 0;
+      // Insertion at front is the worst case for sorted array encoding
+      for(i32 i = element_count - 1; i >= 0; --i) {
+        storage.resetCacheStatistics();
+        large.insert(i, i);
+        const CacheStatistics statistics = storage.getCacheStatistics();
+        max_page_access_count = std::max<size_t>(max_page_access_count, statistics.hit_count + statistics.miss_count);
+      }
+      LOG("Max page accesses per insert into map of " << element_count << " elements: " << max_page_access_count);
+      TEST(max_page_access_count < 300);
+      TEST(large.getElementCount() == element_count);
+
+      for(i32 i = 0; i < element_count; i += 2) large.remove(i);
+      TEST(large.rename(1, element_count) == 1);
+      Variable expected = map{};
+      for(i32 i = 3; i < element_count; i += 2) expected.toMap().insert(i, i);
+      expected.toMap().insert(element_count, 1);
+      bool is_ordered = large.getElementCount() == expected.getElementCount();
+      for(size_t position = 0; is_ordered && position < size_t(element_count / 2 - 1); ++position)
+        is_ordered = large.getKey(position) == KeyValue(i32(2 * position + 3)) &&
+                     i32(large.getValue(position).toNumber()) == i32(2 * position + 3);
+      TEST(is_ordered);
+      TEST(large.find(element_count) == size_t(element_count / 2 - 1));
+      TEST(!large.contains(1));
+      TEST(large.toVariable().serialize() == expected.serialize());
+
+      LOG("Handle of removed node is detected:");
+      PRINT_RUN(large.insert("child", arr{1, 2});)
+      FileVariable child = large["child"];
+      TEST(child.isValid());
+      const size_t used_page_count = storage.getUsedPageCount();
+      PRINT_RUN(large.remove("child");)
+      PRINT_RUN(large.insert("other", arr{3, 4});)
+      // Pages of removed node are reused by new one
+      TEST(storage.getUsedPageCount() == used_page_count);
+      TEST(!child.isValid());
+      bool is_thrown = false;
+      try { child.getElementCount(); } catch(const err::Error& error) { is_thrown = error.code() == err::ErrorType::binom_resource_not_available; }
+      TEST(is_thrown);
+      TEST(large["other"].toVariable().serialize() == Variable(arr{3, 4}).serialize());
+
+      PRINT_RUN(root_map.remove("large");)
+      TEST(!large.isValid());
+      is_thrown = false;
+      try { large.find(3); } catch(const err::Error& error) { is_thrown = error.code() == err::ErrorType::binom_resource_not_available; }
+      TEST(is_thrown);
+    }
+
+    LOG("Pages of removed nodes are reused:");
+    PRINT_RUN(storage.setRoot(nullptr);)
+    TEST(storage.getUsedPageCount() == empty_page_count);
+    PRINT_RUN(storage.setRoot(variable);)
+    TEST(storage.getUsedPageCount() == stored_page_count);
+    PRINT_RUN(storage.sync();)
+  }
+
+  {
+    LOG("Reopen:");
+    PRINT_RUN(FileStorage storage(path);)
+    TEST(storage.getPageSize() == 512);
+    TEST(storage.getRoot().toVariable().serialize() == variable.serialize());
+  }
+
+  for(CacheEvictionPolicy policy : {CacheEvictionPolicy::clock, CacheEvictionPolicy::lru_k}) {
+    const char* policy_name = policy == CacheEvictionPolicy::clock ? "CLOCK" : "LRU-K";
+    LOG("Page cache (" << policy_name << "):");
+    std::remove(path.c_str());
+    std::vector<ui64> data(4096);
+    for(size_t i = 0; i < data.size(); ++i) data[i] = i * i;
+    {
+      PRINT_RUN(FileStorage storage(path, 512, 8 * 512, policy);)
+      FileBufferArray values = storage.setRoot(ui64arr{data[0]}).toBufferArray();
+      PRINT_RUN(values.pushBack(data.data() + 1, data.size() - 1);)
+      CacheStatistics statistics = storage.getCacheStatistics();
+      TEST(statistics.eviction_count > 0);
+      TEST(statistics.write_back_count > 0);
+
+      storage.resetCacheStatistics();
+      bool is_equal = true;
+      for(size_t i = 0; i < data.size(); i += 97) is_equal &= ui64(values[i]) == data[i];
+      TEST(is_equal);
+      TEST(storage.getCacheStatistics().miss_count > 0);
+
+      LOG("Hot page is served from cache:");
+      storage.resetCacheStatistics();
+      for(size_t i = 0; i < 100; ++i) is_equal &= ui64(values[i % 8]) == data[i % 8];
+      TEST(is_equal);
+      statistics = storage.getCacheStatistics();
+      TEST(statistics.hit_count > statistics.miss_count);
+      TEST(statistics.getHitRatio() > 0.9);
+    }
+    {
+      LOG("Dirty pages are written back on close:");
+      PRINT_RUN(FileStorage storage(path);)
+      std::vector<ui64> stored_data(data.size());
+      PRINT_RUN(storage.getRoot().toBufferArray().read(0, stored_data.data(), stored_data.size());)
+      TEST(stored_data == data);
+    }
+  }
+
+  LOG("Dirty pages of journaled storage are kept within cache budget:");
+  {
+    std::remove(path.c_str());
+    std::vector<ui64> data(4096);
+    for(size_t i = 0; i < data.size(); ++i) data[i] = i * 3;
+    {
+      FileStorage storage(path, 512, 8 * 512, CacheEvictionPolicy::clock, JournalConfig{.mode = JournalMode::synchronous});
+      FileBufferArray values = storage.setRoot(ui64arr{data[0]}).toBufferArray();
+      storage.resetCacheStatistics();
+      PRINT_RUN(values.pushBack(data.data() + 1, data.size() - 1);)
+      CacheStatistics statistics = storage.getCacheStatistics();
+      TEST(statistics.spill_count > 0);
+      TEST(statistics.peak_frame_count <= 8);
+      std::vector<ui64> stored_data(data.size());
+      PRINT_RUN(values.read(0, stored_data.data(), stored_data.size());)
+      TEST(stored_data == data);
+    }
+    PRINT_RUN(FileStorage storage(path);)
+    std::vector<ui64> stored_data(data.size());
+    PRINT_RUN(storage.getRoot().toBufferArray().read(0, stored_data.data(), stored_data.size());)
+    TEST(stored_data == data);
+  }
+
+  LOG("Write-ahead log:");
+  const std::string journal_path = path + ".wal";
+  const Variable journal_expected = map{{"counter", 9_ui64}, {"log", arr{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}}, {"text", "head tail"}};
+  for(JournalMode mode : {JournalMode::synchronous, JournalMode::batched}) {
+    std::remove(path.c_str());
+    std::remove(journal_path.c_str());
+    const JournalConfig config{.mode = mode, .batch_size = 4, .checkpoint_size = 4096};
+
+    LOG((mode == JournalMode::synchronous ? "Synchronous" : "Batched") << " journal, process crash:");
+    const pid_t pid = ::fork();
+    if(!pid) {
+      FileStorage storage(path, 512, 8 * 512, CacheEvictionPolicy::clock, config);
+      FileMap root = storage.setRoot(map{{"counter", 0_ui64}, {"log", arr{}}, {"text", "head"}}).toMap();
+      FileArray log = root["log"].toArray();
+      for(ui64 i = 0; i < 10; ++i) {
+        root.remove("counter");
+        root.insert("counter", i);
+        log.pushBack(i32(i));
+      }
+      root["text"].toBufferArray().pushBack(" tail", 5);
+      root.insert("removed", "value");
+      root.rename("removed", "renamed");
+      root.remove("renamed");
+      // Tail of batched journal is synced by background flush after batch_delay without further commit
+      if(mode == JournalMode::batched) std::this_thread::sleep_for(config.batch_delay * 20);
+      ::_exit(0);
+    }
+    int status = 0;
+    ::waitpid(pid, &status, 0);
+    TEST(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    {
+      PRINT_RUN(FileStorage storage(path, 512, 8 * 512, CacheEvictionPolicy::clock, config);)
+      TEST(storage.getRoot().toVariable().serialize() == journal_expected.serialize());
+    }
+
+    LOG("Torn journal tail is ignored:");
+    {
+      FileStorage storage(path, 512, 8 * 512, CacheEvictionPolicy::clock, config);
+      storage.getRoot().toMap().insert("lost", 1);
+    }
+    {
+      std::ofstream journal(journal_path, std::ios::binary | std::ios::app);
+      journal << "torn record";
+    }
+    {
+      PRINT_RUN(FileStorage storage(path);)
+      TEST(storage.getRoot().toMap().contains("lost"));
+      TEST(::access(journal_path.c_str(), F_OK) != 0);
+    }
+  }
+
+  LOG("Group commit:");
+  size_t sync_counts[2] = {};
+  for(JournalMode mode : {JournalMode::synchronous, JournalMode::batched}) {
+    std::remove(path.c_str());
+    FileStorage storage(path, 4096, default_cache_size, CacheEvictionPolicy::clock,
+                        JournalConfig{.mode = mode, .batch_size = 100, .batch_delay = std::chrono::seconds(10)});
+    FileArray array = storage.setRoot(arr{}).toArray();
+    const size_t initial_sync_count = storage.getJournalSyncCount();
+    for(i32 i = 0; i < 1000; ++i) array.pushBack(i);
+    sync_counts[mode == JournalMode::batched] = storage.getJournalSyncCount() - initial_sync_count;
+  }
+  LOG("Journal syncs per 1000 modifications, synchronous: " << sync_counts[0] << ", batched: " << sync_counts[1]);
+  TEST(sync_counts[0] >= 1000);
+  TEST(sync_counts[1] <= 10);
+
+  LOG("Background flush of batched journal:");
+  {
+    std::remove(path.c_str());
+    FileStorage storage(path, 4096, default_cache_size, CacheEvictionPolicy::clock,
+                        JournalConfig{.mode = JournalMode::batched, .batch_delay = std::chrono::milliseconds(5)});
+    FileArray array = storage.setRoot(arr{}).toArray();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    const size_t initial_sync_count = storage.getJournalSyncCount();
+    array.pushBack(1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    TEST(storage.getJournalSyncCount() > initial_sync_count);
+  }
+
+  LOG("Recovery by storage opened without journal:");
+  {
+    const pid_t pid = ::fork();
+    if(!pid) {
+      FileStorage storage(path, 512, default_cache_size, CacheEvictionPolicy::clock, JournalConfig{.mode = JournalMode::synchronous});
+      storage.setRoot(journal_expected);
+      ::_exit(0);
+    }
+    ::waitpid(pid, nullptr, 0);
+    PRINT_RUN(FileStorage storage(path);)
+    TEST(storage.getRoot().toVariable().serialize() == journal_expected.serialize());
+    TEST(::access(journal_path.c_str(), F_OK) != 0);
+  }
+
+  LOG("Invalid file:");
+  {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << "Not a BinOM file, definitely not a BinOM file";
+  }
+  bool is_thrown = false;
+  try { FileStorage storage(path); } catch(const err::Error& error) { is_thrown = error.code() == err::ErrorType::invalid_data; }
+  TEST(is_thrown);
+
+  std::remove(path.c_str());
+  std::remove(journal_path.c_str());
+  GRP_POP
+}
+
+#endif // FILE_STORAGE_TEST_HXX
@@ -0,0 +1,135 @@
+#ifndef HASH_MAP_TEST_HXX
+#define HASH_MAP_TEST_HXX
+
+#include "tester.hxx"
+
+#include "libbinom/include/variables/hash_map.hxx"
+#include "libbinom/include/variables/map.hxx"
+#include "print_variable.hxx"
+
+#include <chrono>
+#include <random>
+#include <unordered_map>
+
+void testHashMap() {
+  using namespace binom::literals;
+  using namespace binom;
+
+  RAIIPerfomanceTest test_perf("HashMap test: ");
+  SEPARATOR
+  TEST_ANNOUNCE(HashMap test)
+  GRP_PUSH
+
+  HashMap _map = hashmap{{1, 2},{3, 4}, {"Hello", "World"}};
+  utils::printVariable(_map);
+  TEST(_map.getElementCount() == 3);
+  TEST(_map.contains("Hello"));
+  TEST(!_map.contains("World"));
+  TEST(_map.insert(1, 5).getErrorCode() == err::ErrorType::binom_key_unique_error);
+  _map[6] = i32arr{7,8,9,10};
+  TEST(_map[6].getType() == VarType::si32_array);
+  TEST(_map[KeyValue(nullptr)].getType() == VarType::null);
+  TEST(_map.getElementCount() == 5);
+  SEPARATOR
+
+  LOG("Hash table against std::unordered_map:");
+  {
+    std::mt19937_64 random(42);
+    std::unordered_map<i64, i64> expected;
+    HashMap map;
+    bool is_matched = true;
+    // Removals leave deleted slots, so table is cleaned up by rehash without growth
+    for(size_t i = 0; i < 200000; ++i) {
+      const i64 key = i64(random() % 20000);
+      if(random() % 2) {
+        const bool is_inserted = expected.emplace(key, i64(i)).second;
+        is_matched &= bool(map.insert(key, i64(i))) != is_inserted;
+      } else {
+        const bool is_removed = expected.erase(key);
+        is_matched &= (map.remove(key) == err::ErrorType::no_error) == is_removed;
+      }
+    }
+    TEST(is_matched);
+    TEST(map.getElementCount() == expected.size());
+
+    size_t count = 0;
+    for(auto element : std::as_const(map)) {
+      const auto expected_it = expected.find(i64(element.getKey().toNumber()));
+      is_matched &= expected_it != expected.cend() && i64(element.getVariable().toNumber()) == expected_it->second;
+      ++count;
+    }
+    TEST(is_matched && count == expected.size());
+    for(const auto& [key, value] : expected) is_matched &= i64(map.getVariable(key).toNumber()) == value;
+    TEST(is_matched);
+
+    HashMap copy = map;
+    for(const auto& [key, value] : expected) map.remove(key);
+    TEST(map.isEmpty());
+    TEST(map.begin() == map.end());
+    TEST(copy.getElementCount() == expected.size());
+    TEST(i64(copy.find(expected.cbegin()->first)->getVariable().toNumber()) == expected.cbegin()->second);
+  }
+
+  LOG("Key hashing:");
+  {
+    HashMap map;
+    map.insert(0.0, "zero");
+    TEST(map.contains(-0.0));
+    TEST(!map.contains(0_i64));
+    TEST(!map.contains(0.0f));
+    map.insert(ui8arr{1, 2, 3}, 1);
+    map.insert("abcdefghijklmnopq", 2);
+    TEST(map.contains(ui8arr{1, 2, 3}));
+    TEST(!map.contains(ui8arr{1, 2, 3, 0}));
+    TEST(!map.contains(i8arr{1, 2, 3}));
+    TEST(map.contains("abcdefghijklmnopq"));
+    TEST(!map.contains("abcdefghijklmnopr"));
+    map.insert(bitarr{1, 0, 1}, 3);
+    TEST(map.contains(bitarr{1, 0, 1}));
+    TEST(!map.contains(bitarr{1, 0, 1, 0}));
+  }
+
+  LOG("Serialization:");
+  {
+    HashMap map = hashmap{{"b", 2}, {"a", 1}, {3, arr{3}}, {"c", hashmap{{1, 1}}}};
+    const std::vector<byte> data = map.serialize();
+    const std::vector<byte> map_data = Variable(literals::map{{"b", 2}, {"a", 1}, {3, arr{3}}, {"c", hashmap{{1, 1}}}}).serialize();
+    // Elements are written in key order, so only type of root node differs
+    size_t difference_count = 0;
+    for(size_t i = 0; i < data.size() && i < map_data.size(); ++i) difference_count += data[i] != map_data[i];
+    TEST(data.size() == map_data.size() && difference_count == 1);
+    Variable deserialized = Variable::deserialize(data);
+    TEST(deserialized.getType() == VarType::hash_map);
+    TEST(deserialized.toHashMap()["c"].getType() == VarType::hash_map);
+    TEST(deserialized.serialize() == data);
+  }
+
+  LOG("Lookup in 100000 elements:");
+  {
+    constexpr i64 element_count = 100000;
+    Map map;
+    HashMap hash_map;
+    hash_map.reserve(element_count);
+    for(i64 i = 0; i < element_count; ++i) {
+      map.insert((i * 7919) % element_count, i);
+      hash_map.insert((i * 7919) % element_count, i);
+    }
+    std::mt19937_64 random(42);
+    std::vector<i64> keys(1000000);
+    for(i64& key : keys) key = i64(random() % element_count);
+    i64 map_sum = 0, hash_map_sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for(i64 key : keys) map_sum += i64(map.getVariable(key).toNumber());
+    const double map_duration = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    for(i64 key : keys) hash_map_sum += i64(hash_map.getVariable(key).toNumber());
+    const double hash_map_duration = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    LOG("Map::getVariable: " << map_duration / keys.size() << " ns");
+    LOG("HashMap::getVariable: " << hash_map_duration / keys.size() << " ns");
+    TEST(map_sum == hash_map_sum);
+  }
+
+  GRP_POP
+}
+
+#endif // HASH_MAP_TEST_HXX
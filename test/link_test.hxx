@@ -0,0 +1,417 @@
+#ifndef LINK_TEST_HXX
+#define LINK_TEST_HXX
+
+#include "tester.hxx"
+#include "libbinom/include/binom.hxx"
+#include "libbinom/include/utils/epoch_reclamation.hxx"
+
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <string>
+#include <thread>
+#include <utility>
+
+void testLink() {
+  using namespace binom;
+  using namespace binom::literals;
+
+  RAIIPerfomanceTest test_perf("Link test: ");
+  SEPARATOR
+  TEST_ANNOUNCE(Link test)
+  GRP_PUSH
+
+  const size_t thread_count = std::max(2u, std::thread::hardware_concurrency());
+  constexpr size_t iteration_count = 1000000;
+
+  LOG("Reference copy/destroy of one hot node:");
+  {
+    Variable hot_node = map{{"value", 1}};
+    auto measure = [&hot_node](size_t thread_count) {
+      std::list<std::thread> threads;
+      const auto start = std::chrono::steady_clock::now();
+      for(size_t i = 0; i < thread_count; ++i)
+        threads.emplace_back([&hot_node]() {
+          for(size_t i = 0; i < iteration_count; ++i) Variable reference = hot_node.move();
+        });
+      for(auto& thread : threads) thread.join();
+      return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iteration_count;
+    };
+    LOG("1 thread: " << measure(1) << " ns");
+    LOG(thread_count << " threads: " << measure(thread_count) << " ns");
+    TEST(hot_node.getLinkCount() == 1);
+  }
+
+#ifndef BINOM_SINGLE_THREAD
+  LOG("Resource locked by thread isn't freed until it's unlocked:");
+  {
+    Variable* node = new Variable(map{{"value", 1}});
+    // Objects retired while threads of previous tests were pinned
+    epoch_reclamation::collect();
+    TEST(epoch_reclamation::getRetiredCount() == 0);
+    {
+      auto lk = node->getLock(MtxLockType::shared_locked);
+      delete node;
+      epoch_reclamation::collect();
+      TEST(epoch_reclamation::getRetiredCount() == 1);
+    }
+    epoch_reclamation::collect();
+    TEST(epoch_reclamation::getRetiredCount() == 0);
+  }
+
+  LOG("Destroyed container is freed without pinned threads:");
+  {
+    {
+      Variable large = map{};
+      for(i64 i = 0; i < 100000; ++i) large.toMap().insert(i, map{{"value", arr{i}}});
+    }
+    // Elements and their nested containers are deleted right away instead of waiting in retired list
+    TEST(epoch_reclamation::getRetiredCount() == 0);
+  }
+
+  LOG("Objects retired by pinned thread:");
+  {
+    // Pinned thread can't delete its own objects, so collections are spaced by growing list instead of fixed count
+    static size_t deleted_count = 0;
+    constexpr size_t object_count = 200000;
+    {
+      epoch_reclamation::Guard guard;
+      const auto start = std::chrono::steady_clock::now();
+      for(size_t i = 0; i < object_count; ++i)
+        epoch_reclamation::retire(new size_t(i), [](void* pointer) { delete static_cast<size_t*>(pointer); ++deleted_count; });
+      const double duration = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+      LOG("Retire of " << object_count << " objects: " << duration << " ms");
+      TEST(deleted_count == 0);
+    }
+    epoch_reclamation::collect();
+    TEST(deleted_count == object_count);
+  }
+
+  LOG("Concurrent readers and writer of shared node:");
+  {
+    Variable root = map{{"node", arr{1, 2, 3}}};
+    std::atomic_bool is_running = true;
+    std::atomic_size_t read_count = 0, error_count = 0;
+    std::list<std::thread> threads;
+    for(size_t i = 0; i < thread_count; ++i)
+      threads.emplace_back([&]() {
+        while(is_running) {
+          const Variable node = std::as_const(root).toMap()["node"];
+          if(node.getType() == VarType::array && node.getElementCount() != 3) ++error_count;
+          ++read_count;
+        }
+      });
+    for(size_t i = 0; i < 10000; ++i) {
+      root.toMap().remove("node");
+      root.toMap().insert("node", arr{1, 2, 3});
+    }
+    is_running = false;
+    for(auto& thread : threads) thread.join();
+    LOG("Reads: " << read_count);
+    TEST(error_count == 0);
+  }
+
+#endif
+
+  LOG("Number read without lock:");
+  {
+    const Variable counter = 42_i64;
+    auto measure = [](size_t thread_count, auto read) {
+      std::list<std::thread> threads;
+      const auto start = std::chrono::steady_clock::now();
+      for(size_t i = 0; i < thread_count; ++i)
+        threads.emplace_back([&read]() {
+          for(size_t i = 0; i < iteration_count; ++i) read();
+        });
+      for(auto& thread : threads) thread.join();
+      return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iteration_count;
+    };
+    auto locked_read = [&counter]() {
+      auto lk = counter.getLock(MtxLockType::shared_locked);
+      (void)lk;
+      volatile i64 value = i64(counter.toNumber());
+      (void)value;
+    };
+    auto optimistic_read = [&counter]() {
+      volatile i64 value = i64(counter.toNumber());
+      (void)value;
+    };
+    LOG("Read under shared lock, 1 thread: " << measure(1, locked_read) << " ns");
+    LOG("Read under shared lock, " << thread_count << " threads: " << measure(thread_count, locked_read) << " ns");
+    LOG("Optimistic read, 1 thread: " << measure(1, optimistic_read) << " ns");
+    LOG("Optimistic read, " << thread_count << " threads: " << measure(thread_count, optimistic_read) << " ns");
+  }
+
+#ifndef BINOM_SINGLE_THREAD
+  LOG("Optimistic readers and writer changing type and value of number:");
+  {
+    Variable number = 1_ui8;
+    std::atomic_bool is_running = true;
+    std::atomic_size_t read_count = 0, error_count = 0;
+    std::list<std::thread> threads;
+    for(size_t i = 0; i < thread_count; ++i)
+      threads.emplace_back([&]() {
+        while(is_running) {
+          // Torn read would mix 0xFF... of i64 with ui8 type or 1 with i64 type
+          const i64 value = i64(std::as_const(number).toNumber());
+          const VarType type = number.getType();
+          if(value != 1 && value != -1) ++error_count;
+          if(type != VarType::ui8 && type != VarType::si64) ++error_count;
+          ++read_count;
+        }
+      });
+    for(size_t i = 0; i < 100000; ++i) {
+      number = (i % 2) ? Variable(1_ui8) : Variable(-1_i64);
+      number.toNumber() += 0; // Write through arithmetic operator
+    }
+    is_running = false;
+    for(auto& thread : threads) thread.join();
+    LOG("Reads: " << read_count);
+    TEST(error_count == 0);
+    TEST(i64(number.toNumber()) == 1);
+  }
+#endif
+
+  LOG("Copy-on-write clone:");
+  {
+    auto makeTemplate = []() -> Variable {
+      return map{
+        {"id", 0},
+        {"name", "template"},
+        {"payload", std::string_view(std::string(1024, 'x'))},
+        {"items", arr{1, 2, map{{"value", 3}}, list{4, 5}}},
+        {"tags", multimap{{"a", 1}, {"a", 2}}}
+      };
+    };
+    Variable source = makeTemplate();
+    const std::vector<byte> expected = source.serialize();
+
+    {
+      Variable clone = source;
+      clone.toMap()["items"].toArray()[2].toMap()["value"].toNumber() = 30;
+      TEST(source.serialize() == expected);
+      TEST(clone.toMap()["items"].toArray()[2].toMap()["value"].toNumber() == 30);
+    }
+
+    {
+      Variable clone = source;
+      source.toMap()["id"].toNumber() = 1;
+      TEST(clone.serialize() == expected);
+      source.toMap()["id"].toNumber() = 0;
+      TEST(source.serialize() == expected);
+    }
+
+    LOG("Source read after clone:");
+    {
+      Variable clone = source;
+      // Source is read in place, it's copied for clone only before change
+      TEST(source.serialize() == expected);
+      TEST(source.getElementCount() == 5);
+      source.toMap()["id"].toNumber() = 1;
+      TEST(clone.serialize() == expected);
+      source.toMap()["id"].toNumber() = 0;
+      TEST(source.serialize() == expected);
+    }
+
+    LOG("Element referenced before clone is changed:");
+    {
+      Variable reference = source.toMap()["items"].toArray()[2].toMap()["value"];
+      Variable clone = source;
+      reference.toNumber() = 10;
+      TEST(clone.serialize() == expected);
+      TEST(source.toMap()["items"].toArray()[2].toMap()["value"].toNumber() == 10);
+      reference.toNumber() = 3;
+      TEST(source.serialize() == expected);
+    }
+
+    LOG("Element referenced after clone is changed:");
+    {
+      Variable clone = source;
+      Variable reference = source.toMap()["items"].toArray()[0];
+      reference.toNumber() = 10;
+      TEST(clone.serialize() == expected);
+      reference.toNumber() = 1;
+      TEST(source.serialize() == expected);
+    }
+
+    LOG("Element changed through iterator taken before clone:");
+    {
+      Array array = arr{1, 2, 3};
+      auto it = array.begin();
+      Array clone = array;
+      *it = 42;
+      TEST(clone[0].toNumber() == 1);
+      TEST(array[0].toNumber() == 42);
+
+      Map map_source = map{{"a", 1}, {"b", 2}};
+      auto map_it = map_source.find("a");
+      Map map_clone = map_source;
+      map_it->getVariable() = 42;
+      TEST(map_clone.getVariable("a").toNumber() == 1);
+      TEST(map_source.getVariable("a").toNumber() == 42);
+    }
+
+    LOG("Clone after iteration over container:");
+    {
+      struct CloneState : Variable {
+        static bool isShared(const Variable& variable) {return (variable.*&CloneState::resource_link).isCloneShared();}
+      };
+
+      Array array = arr{1, 2, 3};
+      i64 sum = 0;
+      for(auto it = array.cbegin(), end = array.cend(); it != end; ++it) sum += i64(it->toNumber());
+      TEST(sum == 6);
+      // Read-only iteration doesn't make later clones eager
+      Array clone = array;
+      TEST(CloneState::isShared(clone));
+      clone[0].toNumber() = 10;
+      TEST(array[0].toNumber() == 1);
+      TEST(clone[0].toNumber() == 10);
+
+      Array second_clone = array;
+      TEST(CloneState::isShared(second_clone));
+      array[1].toNumber() = 20;
+      TEST(second_clone[1].toNumber() == 2);
+      TEST(array[1].toNumber() == 20);
+
+      // Mutable iterators make clones eager until next change of container invalidates them
+      for(Variable& element : array) element.toNumber() += 1;
+      Array eager_clone = array;
+      TEST(!CloneState::isShared(eager_clone));
+      array.pushBack(5);
+      Array lazy_clone = array;
+      TEST(CloneState::isShared(lazy_clone));
+      array[0].toNumber() = 0;
+      TEST(lazy_clone.serialize() == Variable(arr{2, 21, 4, 5}).serialize());
+
+      Map map_source = map{{"a", 1}, {"b", 2}};
+      sum = 0;
+      for(const auto& named : std::as_const(map_source)) sum += i64(named.getVariable().toNumber());
+      TEST(sum == 3);
+      Map map_clone = map_source;
+      TEST(CloneState::isShared(map_clone));
+      map_source.getVariable("a").toNumber() = 10;
+      TEST(map_clone.getVariable("a").toNumber() == 1);
+      map_clone.getVariable("b").toNumber() = 20;
+      TEST(map_source.getVariable("b").toNumber() == 2);
+    }
+
+    LOG("Array appended with its own clone:");
+    {
+      Variable array = arr{1, 2};
+      array.toArray() += arr{3, array.move()};
+      // Clone keeps state of array before append and doesn't contain itself
+      TEST(array.getElementCount() == 4);
+      TEST(array.toArray()[3].serialize() == Variable(arr{1, 2}).serialize());
+      array.toArray().popBack();
+      TEST(array.serialize() == Variable(arr{1, 2, 3}).serialize());
+    }
+
+    LOG("Key taken from moved source of clone:");
+    {
+      BufferArray big = std::string_view(std::string(300, 'a'));
+      Variable clone = big;
+      KeyValue key(big.move());
+      TEST(clone.toBufferArray().getElementCount() == 300);
+      TEST(key == KeyValue(std::string_view(std::string(300, 'a'))));
+
+      BitArray bits = bitarr{};
+      for(size_t i = 0; i < 4096; ++i) bits.pushBack(i % 3 == 0);
+      Variable bits_clone = bits;
+      KeyValue bits_key(bits.move());
+      TEST(bits_clone.getElementCount() == 4096);
+      TEST(bits_clone.toBitArray()[3]);
+    }
+
+    LOG("Clone of clone and destroyed source:");
+    {
+      Variable* temporary = new Variable(makeTemplate());
+      Variable clone = *temporary;
+      Variable second_clone = clone;
+      delete temporary;
+      second_clone.toMap()["name"] = "second";
+      TEST(clone.serialize() == expected);
+      TEST(second_clone.toMap()["name"].serialize() == Variable("second").serialize());
+    }
+
+    {
+      Variable clone = source;
+      TEST(clone.getType() == VarType::map);
+      TEST(clone.toMap()["tags"].getType() == VarType::multimap);
+      TEST(Variable(source.toMap()["tags"]).getType() == VarType::multimap);
+    }
+
+    LOG("Assignment:");
+    {
+      Variable target = arr{1, 2, 3};
+      Variable reference = target.move();
+      target = source;
+      TEST(reference.serialize() == expected);
+      target = target;
+      Variable alias = target.move();
+      target = alias;
+      TEST(target.serialize() == expected);
+      target.toMap()["id"].toNumber() = 2;
+      TEST(alias.toMap()["id"].toNumber() == 2);
+      TEST(source.serialize() == expected);
+    }
+
+#ifndef BINOM_SINGLE_THREAD
+    LOG("Concurrent clones of one source:");
+    {
+      std::atomic_size_t error_count = 0;
+      std::list<std::thread> threads;
+      for(size_t i = 0; i < thread_count; ++i)
+        threads.emplace_back([&, i]() {
+          for(size_t j = 0; j < 1000; ++j) {
+            Variable clone = std::as_const(source);
+            clone.toMap()["id"].toNumber() = i64(i + 1);
+            clone.toMap()["items"].toArray().pushBack(j);
+            if(clone.toMap()["id"].toNumber() != i64(i + 1) || clone.toMap()["items"].getElementCount() != 5) ++error_count;
+          }
+        });
+      for(size_t j = 0; j < 100; ++j)
+        if(source.serialize() != expected) ++error_count;
+      for(auto& thread : threads) thread.join();
+      TEST(error_count == 0);
+      TEST(source.serialize() == expected);
+    }
+#endif
+
+    LOG("Clone of large template with one changed field:");
+    {
+      Variable large = arr{};
+      for(i32 i = 0; i < 1000; ++i) large.toArray().pushBack(Variable(map{{"id", i}, {"values", arr{i, i + 1, i + 2}}}));
+      constexpr size_t clone_count = 1000;
+      const auto start = std::chrono::steady_clock::now();
+      for(size_t i = 0; i < clone_count; ++i) {
+        Variable clone = large;
+        clone.toArray()[500].toMap()["id"].toNumber() = 0;
+      }
+      const double duration = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+      LOG("Clone and change: " << duration / clone_count << " ns");
+      TEST(large.toArray()[500].toMap()["id"].toNumber() == 500);
+
+      // Template is only read between clones, so its elements aren't walked again (single-threaded build walks them)
+      size_t element_count = 0;
+      const auto clone_start = std::chrono::steady_clock::now();
+      for(size_t i = 0; i < clone_count; ++i) {
+        Variable clone = large;
+        element_count += large.getElementCount();
+      }
+      const double clone_duration = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - clone_start).count();
+      LOG("Clone and read of untouched template: " << clone_duration / clone_count << " ns");
+      TEST(element_count == 1000 * clone_count);
+
+      Variable reference = large.toArray()[10].toMap()["values"];
+      Variable clone = large;
+      reference.toArray()[0].toNumber() = -1;
+      TEST(clone.toArray()[10].toMap()["values"].toArray()[0].toNumber() == 10);
+      TEST(large.toArray()[10].toMap()["values"].toArray()[0].toNumber() == -1);
+    }
+  }
+
+  GRP_POP
+}
+
+#endif // LINK_TEST_HXX
@@ -4,8 +4,18 @@
 #include "tester.hxx"
 
 #include "libbinom/include/variables/map.hxx"
+#include "libbinom/include/binom_impl/ram_storage_implementation/map_impl.hxx"
 #include "print_variable.hxx"
 
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
 void testMap() {
   using namespace binom::literals;
   using namespace binom;
@@ -28,6 +38,510 @@ void testMap() {
   _map[6] = i32arr{7,8,9,10};
 
   utils::printVariable(_map.move());
+  SEPARATOR
+
+  LOG("B+-tree storage against std::map:");
+  {
+    std::mt19937_64 random(42);
+    std::map<i64, i64> expected;
+    Map map;
+    bool is_matched = true;
+    for(size_t i = 0; i < 50000; ++i) {
+      const i64 key = i64(random() % 20000);
+      if(random() % 3) {
+        const bool is_inserted = expected.emplace(key, i64(i)).second;
+        is_matched &= bool(map.insert(key, i64(i))) != is_inserted;
+      } else {
+        const bool is_removed = expected.erase(key);
+        is_matched &= (map.remove(key) == err::ErrorType::no_error) == is_removed;
+      }
+    }
+    TEST(is_matched);
+    TEST(map.getElementCount() == expected.size());
+
+    auto expected_it = expected.cbegin();
+    for(auto element : std::as_const(map)) {
+      is_matched &= i64(element.getKey().toNumber()) == expected_it->first && i64(element.getVariable().toNumber()) == expected_it->second;
+      ++expected_it;
+    }
+    TEST(is_matched && expected_it == expected.cend());
+
+    auto expected_rit = expected.crbegin();
+    for(auto it = map.rbegin(), end = map.rend(); it != end; ++it, ++expected_rit)
+      is_matched &= i64(it->getKey().toNumber()) == expected_rit->first;
+    TEST(is_matched && expected_rit == expected.crend());
+
+    // Subtree counts of inner nodes stay exact through splits, merges and evening of nodes
+    size_t index = 0;
+    for(const auto& [key, value] : expected) {
+      is_matched &= i64(map.select(index)->getKey().toNumber()) == key && map.rank(key) == index && map.rank(key + 1) == index + 1;
+      ++index;
+    }
+    TEST(is_matched);
+    TEST(map.select(expected.size()) == map.end());
+    TEST(map.countRange(5000_i64, 15000_i64) == size_t(std::distance(expected.lower_bound(5000), expected.lower_bound(15000))));
+    TEST(map.countRange(15000_i64, 5000_i64) == 0);
+
+    const i64 last_key = expected.crbegin()->first;
+    TEST(!map.rename(last_key, -1_i64));
+    TEST(i64(map.begin()->getKey().toNumber()) == -1);
+    TEST(!map.contains(last_key));
+    TEST(map.rename(-1_i64, expected.cbegin()->first));
+    TEST(map.contains(-1_i64));
+
+    Map copy = map;
+    for(const auto& [key, value] : expected) map.remove(key);
+    TEST(map.getElementCount() == 1);
+    TEST(copy.getElementCount() == expected.size());
+    TEST(i64(copy.find(expected.cbegin()->first)->getVariable().toNumber()) == expected.cbegin()->second);
+    // Copy has key -1 before keys of expected and lacks last key
+    TEST(i64(copy.select(expected.size() / 2)->getKey().toNumber()) == std::next(expected.cbegin(), expected.size() / 2 - 1)->first);
+    map.remove(-1_i64);
+    TEST(map.isEmpty());
+    TEST(map.begin() == map.end());
+  }
+
+  LOG("Elements after change of map:");
+  {
+    // Elements aren't relocated by changes of other elements, so iterators and named variables stay valid
+    Map map;
+    for(i64 i = 0; i < 32; ++i) map.insert(i, i * 10);
+    auto named_variable = *map.insert(100000_i64, 5_i64);
+    auto it = map.find(10_i64);
+    auto renamed_it = map.find(20_i64);
+    for(i64 i = 32; i < 10000; ++i) map.insert(i, i * 10);
+    for(i64 i = 0; i < 10; ++i) map.remove(i);
+    TEST(it == map.begin() && i64(it->getVariable().toNumber()) == 100);
+    TEST(i64((++it)->getKey().toNumber()) == 11);
+    TEST(i64(named_variable.getKey().toNumber()) == 100000 && i64(named_variable.getVariable().toNumber()) == 5);
+    TEST(map.rfind(100000_i64) == map.rbegin());
+    TEST(!map.rename(20_i64, -1_i64));
+    TEST(renamed_it == map.begin() && i64(renamed_it->getVariable().toNumber()) == 200);
+    for(i64 i = 10; i < 5000; ++i) map.remove(i);
+    TEST(i64(renamed_it->getKey().toNumber()) == -1 && i64((++renamed_it)->getKey().toNumber()) == 5000);
+    TEST(i64(named_variable.getVariable().toNumber()) == 5);
+  }
+
+  LOG("Split, join and range erasing:");
+  {
+    auto is_map_matched = [](Map& map, const std::map<i64, i64>& expected) {
+      if(map.getElementCount() != expected.size()) return false;
+      bool is_matched = true;
+      size_t index = 0;
+      auto it = map.begin();
+      for(const auto& [key, value] : expected) {
+        is_matched &= i64(it->getKey().toNumber()) == key && i64(it->getVariable().toNumber()) == value;
+        is_matched &= i64(map.select(index++)->getKey().toNumber()) == key;
+        ++it;
+      }
+      auto rit = map.rbegin();
+      for(auto expected_rit = expected.crbegin(); expected_rit != expected.crend(); ++expected_rit, ++rit)
+        is_matched &= i64(rit->getKey().toNumber()) == expected_rit->first;
+      return is_matched && it == map.end() && rit == map.rend();
+    };
+
+    std::mt19937_64 random(7);
+    std::map<i64, i64> expected;
+    Map map;
+    for(i64 i = 0; i < 50000; ++i) {
+      const i64 key = i64(random() % 100000);
+      if(expected.emplace(key, i).second) map.insert(key, i);
+    }
+
+    // Ranges from a part of one leaf up to most of the tree
+    bool is_erased = true;
+    for(const i64 width : {10, 100, 1000, 10000, 60000}) for(size_t i = 0; i < 4; ++i) {
+      const i64 first = i64(random() % 100000);
+      const auto expected_first = expected.lower_bound(first), expected_last = expected.lower_bound(first + width);
+      const size_t count = std::distance(expected_first, expected_last);
+      expected.erase(expected_first, expected_last);
+      is_erased &= map.eraseRange(first, first + width) == count;
+    }
+    TEST(is_erased);
+    TEST(map.eraseRange(1000_i64, 0_i64) == 0);
+    TEST(is_map_matched(map, expected));
+
+    // Parts of different heights are joined back in both directions
+    bool is_matched = true;
+    for(const i64 split_key : {-1, 50, 50000, 99950, 200000}) {
+      Map upper = map.split(split_key);
+      std::map<i64, i64> expected_upper(expected.lower_bound(split_key), expected.end());
+      std::map<i64, i64> expected_lower(expected.begin(), expected.lower_bound(split_key));
+      is_matched &= is_map_matched(map, expected_lower) && is_map_matched(upper, expected_upper);
+      if(split_key % 2) {
+        is_matched &= !upper.join(map);
+        is_matched &= map.isEmpty();
+        is_matched &= !map.join(upper);
+      } else is_matched &= !map.join(upper);
+      is_matched &= upper.isEmpty() && is_map_matched(map, expected);
+    }
+    TEST(is_matched);
+
+    Map overlapped;
+    overlapped.insert(expected.cbegin()->first + 1, 0_i64);
+    TEST(map.join(overlapped) == err::ErrorType::invalid_data);
+    TEST(overlapped.getElementCount() == 1);
+    TEST(map.join(map) == err::ErrorType::invalid_data);
+
+    // Joined trees keep invariants for later changes
+    for(size_t i = 0; i < 50000; ++i) {
+      const i64 key = i64(random() % 100000);
+      if(random() % 2) {
+        if(expected.emplace(key, i64(i)).second) map.insert(key, i64(i));
+      } elif(expected.erase(key)) map.remove(key);
+    }
+    TEST(is_map_matched(map, expected));
+
+    const auto start = std::chrono::steady_clock::now();
+    const size_t erased_count = map.eraseRange(25000_i64, 75000_i64);
+    const double duration = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    LOG("Range erase of " << erased_count << " elements: " << duration << " us");
+
+    // Split leaves elements in slabs shared by both maps, so iterators of both parts stay valid
+    Map shared;
+    for(i64 i = 0; i < 100000; ++i) shared.insert(i, i);
+    auto lower_it = shared.find(10_i64), upper_it = shared.find(90000_i64);
+    const auto split_start = std::chrono::steady_clock::now();
+    Map shared_upper = shared.split(50000_i64);
+    const double split_duration = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - split_start).count();
+    LOG("Split of map of 100000 elements in half: " << split_duration << " us");
+    TEST(i64(lower_it->getVariable().toNumber()) == 10 && i64(upper_it->getVariable().toNumber()) == 90000);
+    shared.clear();
+    TEST(i64(upper_it->getVariable().toNumber()) == 90000);
+    // Repeated splits and joins don't multiply shared slabs
+    for(i64 i = 0; i < 100; ++i) {
+      Map part = shared_upper.split(60000 + i * 100);
+      shared_upper.insert(-i - 1, i);
+      TEST(!shared_upper.join(part));
+    }
+    TEST(shared_upper.getElementCount() == 50100 && i64(upper_it->getVariable().toNumber()) == 90000);
+    // Small part moves to own slabs after large part is released
+    Map small_part = shared_upper.split(99990_i64);
+    shared_upper.clear();
+    small_part.shrinkToFit();
+    small_part.insert(100000_i64, 100000_i64);
+    bool is_compacted_matched = small_part.getElementCount() == 11;
+    i64 expected_value = 99990;
+    for(auto element : small_part) is_compacted_matched &= i64(element.getVariable().toNumber()) == expected_value++;
+    TEST(is_compacted_matched);
+  }
+
+  LOG("Keys around inline size of short strings:");
+  {
+    Map map;
+    std::map<std::string, i64> expected;
+    for(i64 length = 0; length <= 40; ++length)
+      for(const char symbol : {'b', 'a'}) {
+        const std::string key(length, symbol);
+        expected.emplace(key, length);
+        map.insert(std::string_view(key), length);
+      }
+    bool is_matched = map.getElementCount() == expected.size();
+    auto expected_it = expected.cbegin();
+    for(auto element : map) {
+      is_matched &= element.getKey() == KeyValue(std::string_view(expected_it->first));
+      is_matched &= i64(element.getVariable().toNumber()) == expected_it->second;
+      ++expected_it;
+    }
+    TEST(is_matched);
+    TEST(map.contains(std::string_view(std::string(16, 'a'))) && map.contains(std::string_view(std::string(17, 'a'))));
+    TEST(KeyValue(ui16arr{1, 1, 1, 1, 1, 1, 1, 1}) < KeyValue(ui16arr{1, 1, 1, 1, 1, 1, 1, 1, 0}));
+    TEST(KeyValue(ui16arr{1, 1, 1, 1, 1, 1, 1, 2}) > KeyValue(ui16arr{1, 1, 1, 1, 1, 1, 1, 1, 0}));
+
+    Map copy = map;
+    const auto data = Variable(map).serialize();
+    TEST(Variable(copy).serialize() == data);
+    TEST(Variable::deserialize(data).serialize() == data);
+    TEST(map.begin()->getKey().toBufferArray().getElementCount() == 0);
+    TEST(map.rbegin()->getKey().toBufferArray().getElementCount() == 40);
+
+    Map named_map;
+    std::vector<std::string> names;
+    for(i64 i = 0; i < 100000; ++i) {
+      names.push_back("name_" + std::to_string(i));
+      named_map.insert(std::string_view(names.back()), i);
+    }
+    std::mt19937_64 random(42);
+    i64 sum = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < 100000; ++i) sum += i64(named_map.getVariable(std::string_view(names[random() % names.size()])).toNumber());
+    const double duration = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    LOG("Map::getVariable by short string key: " << duration / 100000 << " ns");
+    TEST(sum != 0);
+  }
+
+  LOG("Interned keys:");
+  {
+    const size_t interned_count = KeyValue::getInternedCount();
+    std::vector<std::string> field_names;
+    std::vector<KeyValue> fields;
+    for(size_t i = 0; i < 10; ++i) {
+      field_names.push_back("long_field_name_number_" + std::to_string(i));
+      fields.push_back(KeyValue(std::string_view(field_names.back())).intern());
+    }
+    TEST(KeyValue::getInternedCount() == interned_count + 10);
+    TEST(KeyValue(std::string_view(field_names[0])).intern() == fields[0]);
+    TEST(KeyValue(std::string_view(field_names[0])) == fields[0]);
+    TEST(fields[0] < fields[1] && fields[9] > fields[8]);
+    TEST(KeyValue::getInternedCount() == interned_count + 10);
+    TEST(!KeyValue("short").intern().isInterned());
+    TEST(!KeyValue(1_i64).intern().isInterned());
+
+    {
+      std::vector<Map> records;
+      for(i64 i = 0; i < 100; ++i) {
+        Map& record = records.emplace_back();
+        for(const KeyValue& field : fields) record.insert(field, i);
+      }
+      // Maps hold the only links to interned data now
+      fields.clear();
+      TEST(KeyValue::getInternedCount() == interned_count + 10);
+      TEST(i64(records[42].getVariable(std::string_view(field_names[5])).toNumber()) == 42);
+      const auto data = Variable(records[7]).serialize();
+      TEST(Variable::deserialize(data).serialize() == data);
+    }
+    TEST(KeyValue::getInternedCount() == interned_count);
+
+    KeyValue unsigned_key = ui8arr{255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255};
+    KeyValue signed_key = i8arr{-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1};
+    const KeyValue::CompareResult expected_compare = unsigned_key.getCompare(signed_key);
+    unsigned_key.intern();
+    signed_key.intern();
+    TEST(KeyValue::getInternedCount() == interned_count + 1);
+    TEST(unsigned_key.getCompare(signed_key) == expected_compare && unsigned_key != signed_key);
+
+    unsigned_key = KeyValue();
+    signed_key = KeyValue();
+    TEST(KeyValue::getInternedCount() == interned_count);
+
+    // Interning table is global, so threads owning their own keys share it in any thread policy
+    {
+      const std::string shared_name = "long_shared_field_name";
+      const KeyValue shared_key = KeyValue(std::string_view(shared_name)).intern();
+      std::atomic<size_t> mismatch_count = 0;
+      std::vector<std::thread> threads;
+      for(size_t i = 0; i < 2; ++i)
+        threads.emplace_back([&shared_name, &shared_key, &mismatch_count]() {
+          for(size_t j = 0; j < 20000; ++j) {
+            KeyValue key = KeyValue(std::string_view(shared_name)).intern();
+            KeyValue other_key = KeyValue(std::string_view("long_field_name_number_" + std::to_string(j % 100))).intern();
+            if(key != shared_key || !other_key.isInterned() || !KeyValue::getInternedCount()) ++mismatch_count;
+          }
+        });
+      for(auto& thread : threads) thread.join();
+      TEST(mismatch_count == 0);
+      TEST(KeyValue::getInternedCount() == interned_count + 1);
+    }
+    TEST(KeyValue::getInternedCount() == interned_count);
+  }
+
+  LOG("Comparable key encoding:");
+  {
+    const f64 nan = std::numeric_limits<f64>::quiet_NaN();
+    std::vector<KeyValue> keys{
+      false, true, ui8(5), i8(-5), i16(-300), ui32(70000), -1_i64, 0_i64, 5_i64,
+      std::numeric_limits<ui64>::max(), std::numeric_limits<i64>::min(),
+      0.0, -0.0, 1.5, 1.5f, -1e300, std::numeric_limits<f64>::infinity(), -std::numeric_limits<f64>::infinity(),
+      ui64((1ull << 53) + 1), i64((1ll << 53) + 1), -i64((1ll << 53) + 1), 0x1p53, -0x1p53, 0x1p64, -0x1p63, 2.5, -2.5, 2_i64, -2_i64,
+      nan, -nan, f32(nan), f64arr{nan}, f64arr{nan, 1}, f64arr{1, nan}, f32arr{nan}, f64arr{0x1p53}, ui64arr{(1ull << 53) + 1},
+      bitarr{1, 0, 1}, bitarr{1, 0}, bitarr{0, 1},
+      "", "a", "ab", "b", "abcdefghijklmnopqrstuvwxyz", ui8arr{1, 2, 3}, i8arr{1, 2, 3}, i8arr{-1}, ui8arr{255},
+      ui16arr{1, 2}, i32arr{-1, 2}, f32arr{1.5f}, f64arr{1.5, 2}, f64arr{-0.0}, f64arr{0.0},
+      ui64arr{std::numeric_limits<ui64>::max()}, i64arr{std::numeric_limits<i64>::min()}
+    };
+    bool is_matched = true;
+    for(KeyValue& first : keys)
+      for(KeyValue& second : keys) {
+        const auto first_encoding = first.getComparableEncoding(), second_encoding = second.getComparableEncoding();
+        const KeyValue::CompareResult encoding_compare =
+            first_encoding < second_encoding ? KeyValue::lower : first_encoding > second_encoding ? KeyValue::highter : KeyValue::equal;
+        is_matched &= first.getCompare(second) == encoding_compare;
+      }
+    TEST(is_matched);
+
+    // Lower prefix means lower key, equal keys have equal prefixes
+    std::vector<KeyValue> prefixed_keys = keys;
+    for(const char* string : {"abcdefg", "abcdefgh", "abcdefgi", "abc\x7F", "abc\x7E", "ab~"}) prefixed_keys.emplace_back(string);
+    for(KeyValue key : {KeyValue(f64arr{1.5, 1}), KeyValue(f64arr{1, 5}), KeyValue(i16arr{-1, 5}), KeyValue(ui16arr{300, 1}), KeyValue(f64arr{nan, 1})})
+      prefixed_keys.push_back(key);
+    bool is_prefix_matched = true;
+    for(KeyValue& first : prefixed_keys)
+      for(KeyValue& second : prefixed_keys) {
+        const ui64 first_prefix = first.getComparablePrefix(), second_prefix = second.getComparablePrefix();
+        const KeyValue::CompareResult compare = first.getCompare(second);
+        if(first_prefix < second_prefix) is_prefix_matched &= compare == KeyValue::lower;
+        elif(first_prefix > second_prefix) is_prefix_matched &= compare == KeyValue::highter;
+        if(compare == KeyValue::equal) is_prefix_matched &= first_prefix == second_prefix;
+      }
+    TEST(is_prefix_matched);
+    TEST(KeyValue("abcdefg").getComparablePrefix() != KeyValue("abcdefh").getComparablePrefix());
+
+    // Decoded key has the same value and type, so its encoding is the same
+    std::vector<byte> encoding;
+    for(KeyValue& key : keys) {
+      encoding.clear();
+      key.appendComparableEncoding(encoding);
+      KeyValue decoded = KeyValue::fromComparableEncoding(encoding.data(), encoding.size());
+      is_matched &= decoded.getCompare(key) == KeyValue::equal && decoded.getType() == key.getType() &&
+                    decoded.getComparableEncoding() == encoding;
+    }
+    TEST(is_matched);
+    bool is_thrown = false;
+    try { KeyValue::fromComparableEncoding(encoding.data(), encoding.size() - 1); } catch(const err::Error&) { is_thrown = true; }
+    TEST(is_thrown);
+    // Unused bits of decoded bit array are zero
+    const std::vector<byte> bits_encoding = KeyValue(bitarr{1, 0, 1}).getComparableEncoding();
+    TEST(KeyValue::fromComparableEncoding(bits_encoding.data(), bits_encoding.size()).toVariable().serialize().back() == 0b101);
+    // Damaged number encodings that don't fit the key type are rejected
+    auto isRejected = [](std::vector<byte> malformed) {
+      try { KeyValue::fromComparableEncoding(malformed.data(), malformed.size()); } catch(const err::Error& error) {
+        return error.code() == err::ErrorType::invalid_data;
+      }
+      return false;
+    };
+    auto retyped = [](KeyValue value, KeyValue type) {
+      std::vector<byte> malformed = value.getComparableEncoding();
+      malformed.back() = byte(type.getType());
+      return malformed;
+    };
+    std::vector<byte> overflowed_remainder = KeyValue(std::numeric_limits<ui64>::max()).getComparableEncoding();
+    overflowed_remainder[overflowed_remainder.size() - 3] = 0xFF;
+    TEST(isRejected(retyped(1e10, ui8(0))));
+    TEST(isRejected(retyped(-1.0, ui64(0))));
+    TEST(isRejected(retyped(nan, i64(0))));
+    TEST(isRejected(retyped(std::numeric_limits<f64>::infinity(), ui64(0))));
+    TEST(isRejected(retyped(0x1p63, i64(0))));
+    TEST(isRejected(retyped(1e300, f32(0))));
+    TEST(isRejected(retyped(ui16(300), ui8(0))));
+    TEST(isRejected(overflowed_remainder));
+    TEST(!isRejected(retyped(ui16(200), ui8(0))));
+
+    // Exact value of mixed number types and total order of NaN
+    KeyValue big_integer = ui64((1ull << 53) + 1), big_float = 0x1p53, one = 1.0, nan_key = nan, other_nan_key = -nan;
+    TEST(big_integer.getCompare(big_float) == KeyValue::highter);
+    TEST(nan_key.getCompare(one) == KeyValue::highter && one.getCompare(nan_key) == KeyValue::lower);
+    TEST(nan_key.getCompare(other_nan_key) == KeyValue::equal && nan_key.getHash() == other_nan_key.getHash());
+    KeyValue nan_array = f64arr{nan, 1}, other_nan_array = f64arr{-nan, 1};
+    TEST(nan_array.getCompare(other_nan_array) == KeyValue::equal);
+  }
+
+  LOG("Bulk load of sorted elements:");
+  {
+    using binom::priv::MapImplementation;
+    bool is_matched = true;
+    for(const i64 count : {0, 1, 32, 33, 1000, 100000}) {
+      MapImplementation map;
+      i64 next_key = 0;
+      map.bulkLoad(count, [&next_key]() { const i64 key = next_key++ * 2; return std::pair<KeyValue, Variable>(key, key); });
+      is_matched &= map.getSize() == size_t(count);
+      i64 expected_key = 0;
+      for(auto element : map) {
+        is_matched &= i64(element.getKey().toNumber()) == expected_key && i64(element.getVariable().toNumber()) == expected_key;
+        expected_key += 2;
+      }
+      is_matched &= expected_key == count * 2;
+      // Loaded tree keeps invariants for later changes
+      for(i64 i = 0; i < count; ++i) is_matched &= map.contains(i * 2) && !map.contains(i * 2 + 1);
+      for(i64 i = 0; i < count; ++i) is_matched &= map.select(i)->getKey() == KeyValue(i * 2) && map.rank(i * 2 + 1) == size_t(i + 1);
+      for(i64 i = 0; i < count; ++i) is_matched &= !map.insert(i * 2 + 1, i);
+      for(i64 i = 0; i < count; ++i) is_matched &= map.remove(i * 2) == err::ErrorType::no_error;
+      is_matched &= map.getSize() == size_t(count);
+      for(i64 i = 0; i < count; ++i) is_matched &= map.contains(i * 2 + 1) && !map.contains(i * 2);
+      for(i64 i = 0; i < count; ++i) is_matched &= map.select(i)->getKey() == KeyValue(i * 2 + 1);
+    }
+    TEST(is_matched);
+
+    MapImplementation map;
+    const i64 unordered_keys[] = {1, 2, 4, 3};
+    const i64 duplicate_keys[] = {1, 2, 2, 3};
+    size_t index = 0;
+    TEST(map.bulkLoadChecked(4, [&]() { return std::pair<KeyValue, Variable>(unordered_keys[index++], nullptr); }) == err::ErrorType::invalid_data);
+    TEST(map.isEmpty());
+    index = 0;
+    TEST(map.bulkLoadChecked(4, [&]() { return std::pair<KeyValue, Variable>(duplicate_keys[index++], nullptr); }) == err::ErrorType::binom_key_unique_error);
+    TEST(map.isEmpty());
+    index = 0;
+    TEST(!map.bulkLoadChecked(3, [&]() { return std::pair<KeyValue, Variable>(unordered_keys[index++], nullptr); }));
+    TEST(map.getSize() == 3);
+
+    Map source;
+    for(i64 i = 0; i < 100000; ++i) source.insert(i, i);
+    const auto data = Variable(source).serialize();
+    const auto start = std::chrono::steady_clock::now();
+    Variable deserialized = Variable::deserialize(data);
+    const double duration = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    LOG("Deserialization of map of 100000 elements: " << duration << " ms");
+    TEST(deserialized.serialize() == data);
+  }
+
+  LOG("Lookup in map of 100000 elements:");
+  {
+    constexpr i64 element_count = 100000;
+    Map map;
+    for(i64 i = 0; i < element_count; ++i) map.insert((i * 7919) % element_count, i);
+
+    // Page in the middle of map is reached without scan from its start
+    const auto select_start = std::chrono::steady_clock::now();
+    auto it = map.select(element_count / 2);
+    const double select_duration = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - select_start).count();
+    LOG("Select of middle element: " << select_duration << " us");
+    i64 page_sum = 0;
+    for(size_t i = 0; i < 100 && it != map.end(); ++i, ++it) page_sum += i64(it->getKey().toNumber());
+    TEST(page_sum == (element_count / 2) * 100 + 4950);
+
+    std::mt19937_64 random(42);
+    std::vector<i64> keys(1000000);
+    for(i64& key : keys) key = i64(random() % element_count);
+    i64 sum = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for(i64 key : keys) sum += i64(map.getVariable(key).toNumber());
+    const double duration = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    LOG("Map::getVariable: " << duration / keys.size() << " ns");
+    TEST(sum != 0);
+  }
+
+  LOG("Storage of 100000 elements against std::map:");
+  {
+    using binom::priv::MapImplementation;
+    constexpr i64 element_count = 100000;
+    auto measure = [](size_t count, auto function) {
+      const auto start = std::chrono::steady_clock::now();
+      function();
+      return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / count;
+    };
+    auto compare = [&measure](const char* key_kind, const std::vector<KeyValue>& keys) {
+      MapImplementation map;
+      std::map<KeyValue, Variable> expected;
+      for(size_t i = 0; i < keys.size(); ++i) {
+        map.insert(keys[(i * 7919) % keys.size()], i64(i));
+        expected.emplace(keys[(i * 7919) % keys.size()], i64(i));
+      }
+      std::mt19937_64 random(42);
+      std::vector<KeyValue> lookup_keys;
+      for(size_t i = 0; i < 1000000; ++i) lookup_keys.push_back(keys[random() % keys.size()]);
+
+      size_t map_count = 0, expected_count = 0;
+      LOG(key_kind << " lookup: B+-tree " << measure(lookup_keys.size(), [&]() { for(auto& key : lookup_keys) map_count += map.contains(key); })
+          << " ns, std::map " << measure(lookup_keys.size(), [&]() { for(auto& key : lookup_keys) expected_count += expected.count(key); }) << " ns");
+      TEST(map_count == lookup_keys.size() && expected_count == lookup_keys.size());
+
+      bool is_matched = true;
+      auto expected_it = expected.cbegin();
+      for(auto it = map.cbegin(); it != map.cend(); ++it, ++expected_it) is_matched &= it.getKey() == expected_it->first;
+      TEST(is_matched && expected_it == expected.cend());
+      map_count = expected_count = 0;
+      LOG(key_kind << " iteration: B+-tree " << measure(keys.size(), [&]() { for(auto it = map.cbegin(); it != map.cend(); ++it) map_count += it.getKey().getElementCount(); })
+          << " ns, std::map " << measure(keys.size(), [&]() { for(auto& element : expected) expected_count += element.first.getElementCount(); }) << " ns");
+      TEST(map_count == expected_count);
+    };
+
+    std::vector<KeyValue> keys;
+    for(i64 i = 0; i < element_count; ++i) keys.emplace_back(i);
+    compare("Number key", keys);
+    keys.clear();
+    for(i64 i = 0; i < element_count; ++i) keys.emplace_back(std::string_view("key_of_element_" + std::to_string(i)));
+    compare("String key", keys);
+  }
 
   GRP_POP
 }
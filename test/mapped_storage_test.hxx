@@ -0,0 +1,129 @@
+#ifndef MAPPED_STORAGE_TEST_HXX
+#define MAPPED_STORAGE_TEST_HXX
+
+#include "tester.hxx"
+#include "libbinom/include/binom.hxx"
+
+#include <cstdio>
+#include <fstream>
+#include <unistd.h>
+
+void testMappedStorage() {
+  using namespace binom;
+  using namespace binom::literals;
+
+  RAIIPerfomanceTest test_perf("Mapped storage test: ");
+  SEPARATOR
+  TEST_ANNOUNCE(Mapped storage test)
+  GRP_PUSH
+
+  const std::string path = "/tmp/binom_mapped_storage_test_" + std::to_string(::getpid()) + ".bom";
+
+  Variable variable = map{
+    {"name", "BinOM"},
+    {"version", 2_ui16},
+    {"flags", bitarr{1, 0, 1, 1, 0, 0, 1, 0, 1}},
+    {"values", i32arr{-1, 0, 1}},
+    {"array", arr{1, "two", map{{"three", 3}}}},
+    {"list", list{1, 2, 3}},
+    {"tags", multimap{{"a", 1}, {"a", 2}, {"b", 3}}},
+    {ui8arr{200, 1}, 1},
+    {-7, 4}
+  };
+  const std::vector<byte> expected = variable.serialize();
+  PRINT_RUN(MappedStorage::write(path, variable);)
+
+  LOG("Lazy materialization:");
+  {
+    PRINT_RUN(MappedStorage storage(path);)
+    TEST(storage.getFileSize() == expected.size());
+    TEST(storage.verify());
+    PRINT_RUN(Variable root = storage.getRoot();)
+    TEST(root.getType() == VarType::map);
+    TEST(storage.getMaterializedNodeCount() == 0);
+
+    PRINT_RUN(Variable array = root.toMap()["array"];)
+    TEST(storage.getMaterializedNodeCount() == 1);
+    TEST(array.getType() == VarType::array);
+    TEST(array.getElementCount() == 3);
+    TEST(storage.getMaterializedNodeCount() == 2);
+    TEST(array.toArray()[0].toNumber() == 1);
+    TEST(storage.getMaterializedNodeCount() == 2);
+
+    PRINT_RUN(Variable copy = root;)
+    TEST(storage.getMaterializedNodeCount() == 2);
+    TEST(copy.serialize() == expected);
+    TEST(root.serialize() == expected);
+    TEST(storage.getErrorCount() == 0);
+    TEST(storage.getView().getDataSize() == expected.size() - sizeof(binom::priv::serialization::Header));
+  }
+
+  LOG("Changes aren't written to file:");
+  {
+    MappedStorage storage(path);
+    Variable root = storage.getRoot();
+    root.toMap()["array"].toArray().pushBack(4);
+    root.toMap().remove("tags");
+    TEST(root.serialize() != expected);
+    TEST(MappedStorage(path).getRoot().serialize() == expected);
+  }
+
+  LOG("Not materialized nodes keep mapping:");
+  {
+    Variable root = MappedStorage(path).getRoot();
+    TEST(root.serialize() == expected);
+  }
+
+  LOG("Large store, touching one path:");
+  {
+    Variable large = arr{};
+    for(i32 i = 0; i < 10000; ++i) large.toArray().pushBack(Variable(arr{i, map{{"value", i}}}));
+    PRINT_RUN(MappedStorage::write(path, large);)
+    MappedStorage storage(path);
+    Variable element = storage.getRoot().toArray()[5000];
+    TEST(element.toArray()[1].toMap()["value"].toNumber() == 5000);
+    LOG("Materialized nodes: " << storage.getMaterializedNodeCount());
+    TEST(storage.getMaterializedNodeCount() == 3);
+  }
+
+  LOG("Corrupted file:");
+  {
+    std::vector<byte> data = variable.serialize();
+    View nested_map_view = View(data).toMap()["array"].toArray()[2];
+    // Element count of map nested in array exceeds file, so array can't be decoded
+    const ui64 element_count = 1ull << 40;
+    std::memcpy(const_cast<byte*>(nested_map_view.getDataPointer()) + 1, &element_count, sizeof(element_count));
+    {
+      std::ofstream file(path, std::ios::binary | std::ios::trunc);
+      file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    }
+    MappedStorage storage(path);
+    TEST(!storage.verify());
+    PRINT_RUN(Variable root = storage.getRoot();)
+    TEST(root.getElementCount() == variable.getElementCount());
+    TEST(storage.getErrorCount() == 0);
+
+    PRINT_RUN(Variable array = root.toMap()["array"];)
+    TEST(array.getType() == VarType::array);
+    bool is_thrown = false;
+    try { MappedStorage::materialize(array); } catch(const err::Error& error) { is_thrown = error.code() == err::ErrorType::invalid_data; }
+    TEST(is_thrown);
+    TEST(storage.getErrorCount() == 1);
+    // Corrupted node is unavailable, not empty container
+    TEST(!array.getLock(MtxLockType::shared_locked));
+    TEST(std::string(root.toMap()["name"].toBufferArray()) == "BinOM");
+
+    {
+      std::ofstream file(path, std::ios::binary | std::ios::trunc);
+      file << "Not a BinOM file";
+    }
+    is_thrown = false;
+    try { MappedStorage storage(path); } catch(const err::Error& error) { is_thrown = error.code() == err::ErrorType::invalid_data; }
+    TEST(is_thrown);
+  }
+
+  std::remove(path.c_str());
+  GRP_POP
+}
+
+#endif // MAPPED_STORAGE_TEST_HXX
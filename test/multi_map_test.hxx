@@ -6,6 +6,8 @@
 #include "libbinom/include/variables/multi_map.hxx"
 #include "print_variable.hxx"
 
+#include <chrono>
+
 template <class IteratorType>
 struct IteratorRange : public std::pair<IteratorType, IteratorType> {
   IteratorType begin() {return self.first;}
@@ -65,6 +67,139 @@ void testMultiMap() {
 
   utils::printVariable(_map.move());
 
+  LOG("Insert of variable and of reference to it:");
+  {
+    Variable value = 5_i64;
+    MultiMap map;
+    map.insert(1_i64, value);
+    map.insert(2_i64, value.move());
+    Number number = value.toNumber().move();
+    PRINT_RUN(number = 6;)
+    TEST(i64(map.find(1_i64)->getVariable().toNumber()) == 5);
+    TEST(i64(map.find(2_i64)->getVariable().toNumber()) == 6);
+  }
+
+  LOG("Teardown of multimap with 200000 elements:");
+  {
+    MultiMap copy;
+    {
+      MultiMap map;
+      for(i64 i = 0; i < 200000; ++i) map.insert(i % 1000, i);
+      copy = map;
+      const auto start = std::chrono::steady_clock::now();
+      map.clear();
+      const double duration = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+      LOG("MultiMap::clear: " << duration << " ms");
+      TEST(map.isEmpty());
+      for(i64 i = 0; i < 1000; ++i) map.insert(i, i);
+      TEST(map.getElementCount() == 1000);
+    }
+    // Copy has its own slabs, so it outlives original
+    TEST(copy.getElementCount() == 200000);
+    TEST(i64(copy.find(999_i64)->getVariable().toNumber()) == 999);
+  }
+
+  LOG("Order statistics:");
+  {
+    MultiMap map;
+    for(i64 i = 0; i < 300; ++i) map.insert(i / 3, i);
+    TEST(i64(map.select(0)->getVariable().toNumber()) == 0);
+    TEST(i64(map.select(200)->getVariable().toNumber()) == 200);
+    TEST(i64(map.select(299)->getKey().toNumber()) == 99);
+    TEST(map.select(300) == map.end());
+    TEST(map.rank(50_i64) == 150);
+    TEST(map.rank(-1_i64) == 0 && map.rank(1000_i64) == 300);
+    TEST(map.countRange(10_i64, 20_i64) == 30);
+    TEST(map.countRange(20_i64, 10_i64) == 0);
+
+    // Element counts of subtrees follow removal and renaming of elements
+    map.removeAll(10_i64);
+    map.rename(map.find(20_i64), 1000_i64);
+    TEST(map.getElementCount() == 297);
+    TEST(map.countRange(10_i64, 21_i64) == 29);
+    TEST(map.rank(1000_i64) == 296);
+    TEST(i64(map.select(296)->getVariable().toNumber()) == 60);
+    TEST(i64(map.select(30)->getVariable().toNumber()) == 33);
+
+    MultiMap copy = map;
+    copy.eraseRange(0_i64, 50_i64);
+    TEST(copy.getElementCount() == 151 && map.getElementCount() == 297);
+    TEST(i64(copy.select(0)->getKey().toNumber()) == 50);
+
+    std::vector<i64> reverse_range;
+    for(auto named_variable : IteratorRange<MultiMap::ReverseIterator>{map.getReverseRange(20_i64)})
+      reverse_range.push_back(i64(named_variable.getVariable().toNumber()));
+    TEST((reverse_range == std::vector<i64>{62, 61}));
+  }
+
+  LOG("Split, join and range erasing:");
+  {
+    MultiMap map;
+    for(i64 i = 0; i < 300; ++i) map.insert(i / 3, i);
+    TEST(map.eraseRange(10_i64, 20_i64) == 30);
+    TEST(map.getElementCount() == 270);
+    TEST(map.countRange(10_i64, 20_i64) == 0);
+    TEST(map.eraseRange(20_i64, 10_i64) == 0);
+
+    MultiMap upper = map.split(50_i64);
+    TEST(map.getElementCount() == 120 && upper.getElementCount() == 150);
+    TEST(i64(map.rbegin()->getKey().toNumber()) == 49);
+    TEST(i64(upper.begin()->getKey().toNumber()) == 50);
+
+    MultiMap overlapped;
+    overlapped.insert(30_i64, 0_i64);
+    TEST(map.join(overlapped) == ErrorType::invalid_data);
+    TEST(overlapped.getElementCount() == 1);
+
+    TEST(!upper.join(map));
+    TEST(upper.getElementCount() == 270 && map.getElementCount() == 0);
+    TEST(i64(upper.select(0)->getVariable().toNumber()) == 0);
+    TEST(i64(upper.select(269)->getVariable().toNumber()) == 299);
+    TEST(upper.rank(50_i64) == 120);
+
+    // Elements of key present in both multimaps keep order of lower multimap first
+    MultiMap higher;
+    higher.insert(99_i64, 1000_i64);
+    higher.insert(100_i64, 1001_i64);
+    TEST(!upper.join(higher));
+    MultiMap lower;
+    lower.insert(0_i64, -1_i64);
+    TEST(!lower.join(upper));
+    TEST(lower.getElementCount() == 273 && upper.isEmpty());
+    std::vector<i64> boundary_values;
+    for(auto named_variable : IteratorRange<MultiMap::Iterator>{lower.getRange(0_i64)})
+      boundary_values.push_back(i64(named_variable.getVariable().toNumber()));
+    TEST((boundary_values == std::vector<i64>{-1, 0, 1, 2}));
+    TEST(i64(lower.select(271)->getVariable().toNumber()) == 1000);
+    TEST(lower.countRange(99_i64, 101_i64) == 5);
+
+    // Both parts share slabs after split, so either of them can outlive the other
+    for(i64 split_key : {5_i64, 95_i64}) {
+      MultiMap part = lower.split(split_key);
+      MultiMap rest = lower;
+      lower.clear();
+      rest.insert(-10_i64, 0_i64);
+      part.insert(1000_i64, 0_i64);
+      TEST(rest.getElementCount() + part.getElementCount() == 275);
+      TEST(!rest.join(part));
+      rest.eraseRange(-10_i64, -9_i64);
+      rest.eraseRange(1000_i64, 1001_i64);
+      TEST(!lower.join(rest));
+    }
+    TEST(lower.getElementCount() == 273);
+    TEST(i64(lower.select(0)->getVariable().toNumber()) == -1);
+    TEST(i64(lower.select(272)->getVariable().toNumber()) == 1001);
+
+    // Small part moves to own slabs with its key nodes after large part is released
+    MultiMap small_part = lower.split(99_i64);
+    lower.clear();
+    small_part.shrinkToFit();
+    small_part.insert(99_i64, 2000_i64);
+    std::vector<i64> small_values;
+    for(auto named_variable : small_part) small_values.push_back(i64(named_variable.getVariable().toNumber()));
+    TEST((small_values == std::vector<i64>{297, 298, 299, 1000, 2000, 1001}));
+  }
+
   GRP_POP
 }
 
@@ -0,0 +1,143 @@
+#ifndef PERSISTENT_TEST_HXX
+#define PERSISTENT_TEST_HXX
+
+#include "tester.hxx"
+#include "libbinom/include/binom.hxx"
+
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <thread>
+
+void testPersistent() {
+  using namespace binom;
+  using namespace binom::literals;
+
+  RAIIPerfomanceTest test_perf("Persistent containers test: ");
+  SEPARATOR
+  TEST_ANNOUNCE(Persistent containers test)
+  GRP_PUSH
+
+  LOG("PersistentArray:");
+  {
+    PersistentArray array;
+    std::vector<PersistentArray> versions;
+    for(i64 i = 0; i < 2000; ++i) {
+      versions.push_back(array);
+      array = array.pushBack(i);
+    }
+    TEST(array.getElementCount() == 2000);
+    bool is_equal = true;
+    i64 expected = 0;
+    for(const Variable& element : array) is_equal &= element.toNumber() == expected++;
+    TEST(is_equal);
+    TEST(versions[1000].getElementCount() == 1000);
+    TEST(versions[1000][999].toNumber() == 999);
+    versions.clear();
+
+    PersistentArray changed = array.set(1500, "changed");
+    TEST(changed[1500].getType() != VarType::si64);
+    TEST(array[1500].toNumber() == 1500);
+    TEST(&changed[0] == &array[0]); // Leaf isn't copied
+    TEST(&changed[1501] != &array[1501]);
+    TEST(changed[1501].getLinkCount() == 2); // Element of copied leaf is shared by both versions
+
+    PersistentArray popped = array;
+    for(size_t i = 0; i < 1990; ++i) popped = popped.popBack();
+    TEST(popped.getElementCount() == 10);
+    TEST(popped[9].toNumber() == 9);
+    TEST(array.getElementCount() == 2000);
+    TEST(popped.popBack().popBack().pushBack(42)[8].toNumber() == 42);
+
+    bool is_thrown = false;
+    try { popped[10]; } catch(const err::Error& error) { is_thrown = error.code() == err::ErrorType::out_of_range; }
+    TEST(is_thrown);
+
+    Variable mutable_element = 1;
+    PersistentArray with_element = PersistentArray().pushBack(mutable_element);
+    mutable_element.toNumber() = 2;
+    TEST(with_element[0].toNumber() == 1);
+
+    PersistentArray from_literal = arr{1, "two", map{{"three", 3}}};
+    TEST(from_literal.getElementCount() == 3);
+    TEST(from_literal.toVariable().serialize() == Variable(arr{1, "two", map{{"three", 3}}}).serialize());
+  }
+
+  LOG("PersistentMap:");
+  {
+    PersistentMap map;
+    for(i64 i = 0; i < 1000; ++i) map = map.set((i * 7919) % 1000, i);
+    TEST(map.getElementCount() == 1000);
+    bool is_sorted = true;
+    i64 expected_key = 0;
+    for(auto element : map) is_sorted &= element.first == KeyValue(expected_key++);
+    TEST(is_sorted);
+
+    PersistentMap changed = map.set(500_i64, "changed").remove(0_i64);
+    TEST(changed.getElementCount() == 999);
+    TEST(!changed.contains(0_i64));
+    TEST(map.contains(0_i64));
+    TEST(map.find(500_i64)->getType() == VarType::si64);
+    TEST(changed.find(500_i64)->getType() != VarType::si64);
+    TEST(map.find(1000_i64) == nullptr);
+    TEST(map.remove(1000_i64).getElementCount() == 1000);
+
+    PersistentMap removed = map;
+    for(i64 i = 0; i < 1000; i += 2) removed = removed.remove(i);
+    TEST(removed.getElementCount() == 500);
+    bool is_odd = true;
+    for(auto it = removed.begin(); it != removed.end(); ++it) is_odd &= (i64(it.getKey().toNumber()) % 2) == 1;
+    TEST(is_odd);
+
+    PersistentMap from_literal = literals::map{{"b", 2}, {"a", 1}, {"c", arr{3}}};
+    TEST(from_literal.toVariable().serialize() == Variable(literals::map{{"a", 1}, {"b", 2}, {"c", arr{3}}}).serialize());
+  }
+
+#ifndef BINOM_SINGLE_THREAD
+  LOG("Readers of published versions and single writer:");
+  {
+    constexpr i64 key_count = 1000;
+    PersistentMap initial;
+    for(i64 i = 0; i < key_count; ++i) initial = initial.set(i, 0_i64);
+    atomic_version::AtomicVersion<PersistentMap> state(initial);
+
+    const size_t thread_count = std::max(2u, std::thread::hardware_concurrency());
+    std::atomic_bool is_running = true;
+    std::atomic_size_t read_count = 0, error_count = 0;
+    std::list<std::thread> threads;
+    for(size_t i = 0; i < thread_count; ++i)
+      threads.emplace_back([&]() {
+        while(is_running) {
+          // Each published version has all values equal
+          const PersistentMap snapshot = state.load();
+          const i64 version = i64(snapshot.begin().getVariable().toNumber());
+          size_t count = 0;
+          for(auto element : snapshot) {
+            if(i64(element.second.toNumber()) != version) ++error_count;
+            ++count;
+          }
+          if(count != key_count) ++error_count;
+          ++read_count;
+        }
+      });
+    const auto start = std::chrono::steady_clock::now();
+    for(i64 version = 1; version <= 200; ++version)
+      state.update([version](const PersistentMap& current) {
+        PersistentMap next = current;
+        for(i64 i = 0; i < key_count; ++i) next = next.set(i, version);
+        return next;
+      });
+    const double duration = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    LOG("Version publishing: " << duration / 200 << " us");
+    is_running = false;
+    for(auto& thread : threads) thread.join();
+    LOG("Snapshot reads: " << read_count);
+    TEST(error_count == 0);
+    TEST(i64(state.load().find(key_count - 1)->toNumber()) == 200);
+  }
+#endif
+
+  GRP_POP
+}
+
+#endif // PERSISTENT_TEST_HXX
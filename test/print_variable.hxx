@@ -184,6 +184,17 @@ class {
         print(named_var.getVariable(), shift + 1);
       }
     break;
+    case binom::VarType::hash_map:
+      std::cout << std::string(shift, '|') << "[hash_map]\n\r";
+      if(shift >= 100) {
+        std::cout << std::string(shift, '|') << "Error: The maximum stack size for the printVariable function has been reached!\n\r";
+        return;
+      }
+      for(const auto& named_var : variable.toHashMap()) {
+        std::cout << std::string(shift, '|'); printKey(named_var.getKey()); std::cout << ":" << std::endl;
+        print(named_var.getVariable(), shift + 1);
+      }
+    break;
     default:
     case binom::VarType::invalid_type: std::cout << std::string(shift, '|') << "<unexpected type>\n\r"; break;
     }
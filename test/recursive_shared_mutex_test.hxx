@@ -2,8 +2,11 @@
 #define RECURSIVE_SHARED_MUTEX_TEST_HXX
 
 #include "libbinom/include/utils/shared_recursive_mutex_wrapper.hxx"
+#include "libbinom/include/binom.hxx"
 #include "test/tester.hxx"
+#include <chrono>
 #include <list>
+#include <map>
 #include <thread>
 
 std::shared_mutex shared_mtx;
@@ -51,4 +54,197 @@ void testRecursiveSharedMutex() {
   for(auto& thread : threads) thread.join();
 }
 
+void testRecursiveSharedMutexPerfomance() {
+  using namespace shared_recursive_mtx;
+  using namespace binom::literals;
+
+  RAIIPerfomanceTest test_perf("Recursive shared mutex perfomance test: ");
+  SEPARATOR
+  TEST_ANNOUNCE(RecursiveSharedMutex perfomance test);
+  GRP_PUSH
+
+  constexpr size_t iteration_count = 1000000;
+  auto measure = [](auto function) {
+    const auto start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < iteration_count; ++i) function();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iteration_count;
+  };
+
+  std::shared_mutex mtx;
+
+  // Baseline: lock states were kept in thread_local std::map before LockStateTable
+  static thread_local std::map<std::shared_mutex*, Counters> map_states;
+  auto lockThroughMap = [&mtx](MtxLockType lock_type) {
+    auto [it, is_created] = map_states.emplace(&mtx, Counters{});
+    if(!is_created) ++it->second.wrapper_count;
+    if(it->second.shared_lock_counter || it->second.unique_lock_counter) {
+      if(!--it->second.wrapper_count) map_states.erase(it);
+      return;
+    }
+    if(lock_type == MtxLockType::unique_locked) {mtx.lock(); mtx.unlock();}
+    else {mtx.lock_shared(); mtx.unlock_shared();}
+    map_states.erase(it);
+  };
+  auto compare = [](const char* name, double before, double after) {
+    LOG(name << ": " << before << " ns with std::map, " << after << " ns with lock state table (x" << before / after << ")");
+  };
+
+  compare("Shared lock/unlock",
+          measure([&]() {lockThroughMap(MtxLockType::shared_locked);}),
+          measure([&mtx]() {SharedRecursiveLock lock(&mtx, MtxLockType::shared_locked);}));
+  compare("Unique lock/unlock",
+          measure([&]() {lockThroughMap(MtxLockType::unique_locked);}),
+          measure([&mtx]() {SharedRecursiveLock lock(&mtx, MtxLockType::unique_locked);}));
+  {
+    map_states.emplace(&mtx, Counters{.shared_lock_counter = 1});
+    SharedRecursiveLock outer_lock(&mtx, MtxLockType::shared_locked);
+    compare("Recursive shared lock/unlock",
+            measure([&]() {lockThroughMap(MtxLockType::shared_locked);}),
+            measure([&mtx]() {SharedRecursiveLock lock(&mtx, MtxLockType::shared_locked);}));
+    map_states.clear();
+  }
+  TEST(SharedRecursiveMutexWrapper::getWrappedMutexCount() == 0);
+
+  binom::Variable map = binom::literals::map{{"a", 1}, {"b", 2}};
+  size_t element_count = 0;
+  LOG("Map::getElementCount: " << measure([&map, &element_count]() {element_count += map.toMap().getElementCount();}) << " ns");
+  TEST(element_count == 2 * iteration_count);
+
+  LOG("Nested locks of more mutexes than fit thread lock table:");
+  {
+    std::vector<std::shared_mutex> mutexes(100);
+    std::list<SharedRecursiveLock> locks;
+    for(auto& nested_mtx : mutexes) locks.emplace_back(&nested_mtx, MtxLockType::unique_locked);
+    TEST(SharedRecursiveMutexWrapper::getWrappedMutexCount() == mutexes.size());
+    // Would deadlock if lock state of mutex is lost
+    for(auto& nested_mtx : mutexes) SharedRecursiveLock lock(&nested_mtx, MtxLockType::shared_locked);
+    for(size_t i = 0; i < mutexes.size(); i += 2) locks.pop_front();
+    TEST(SharedRecursiveMutexWrapper::getWrappedMutexCount() == mutexes.size() / 2);
+    locks.clear();
+    for(auto& nested_mtx : mutexes) {
+      if(!nested_mtx.try_lock()) {TEST(false); break;}
+      nested_mtx.unlock();
+    }
+  }
+  TEST(SharedRecursiveMutexWrapper::getWrappedMutexCount() == 0);
+
+  GRP_POP
+}
+
+void testTransactionLock() {
+  using namespace shared_recursive_mtx;
+  using namespace binom;
+  using namespace binom::literals;
+
+  RAIIPerfomanceTest test_perf("Transaction lock test: ");
+  SEPARATOR
+  TEST_ANNOUNCE(TransactionLock test);
+  GRP_PUSH
+
+  LOG("Mutex set lock:");
+  {
+    std::shared_mutex first, second;
+    {
+      TransactionLock transaction({{&second, nullptr}, {&first, nullptr}});
+      TEST(transaction.getMutexCount() == 2);
+      TEST(SharedRecursiveMutexWrapper::getWrappedMutexCount() == 2);
+      // Nested locks are recursive
+      SharedRecursiveLock lock(&first, MtxLockType::unique_locked);
+      bool is_locked_by_other = false;
+      std::thread([&second, &is_locked_by_other]() {
+        if((is_locked_by_other = second.try_lock_shared())) second.unlock_shared();
+      }).join();
+      TEST(!is_locked_by_other);
+    }
+    TEST(SharedRecursiveMutexWrapper::getWrappedMutexCount() == 0);
+    TEST(first.try_lock());
+    first.unlock();
+  }
+
+  LOG("Nested locks of versioned mutex:");
+  {
+    std::shared_mutex mtx;
+    std::atomic_uint64_t version = 0;
+    {
+      SharedRecursiveLock outer_lock(&mtx, &version, MtxLockType::shared_locked);
+      TEST(version == 0);
+      {
+        // Version is bound by outer lock, nested lock may omit it
+        SharedRecursiveLock inner_lock(&mtx, MtxLockType::unique_locked);
+        TEST(version == 1);
+        SharedRecursiveLock same_version_lock(&mtx, &version, MtxLockType::unique_locked);
+        TEST(version == 1);
+      }
+    }
+    TEST(version == 2);
+    TEST(SharedRecursiveMutexWrapper::getWrappedMutexCount() == 0);
+  }
+
+  const size_t element_count = 100;
+  Variable first = map{}, second = map{};
+  for(ui64 i = 0; i < element_count; ++i) first.toMap().insert(i, i);
+
+  auto moveElement = [](Variable& from, Variable& to, ui64 key) {
+    if(!from.toMap().contains(key)) return;
+    Variable element = from.toMap().getVariable(key);
+    to.toMap().insert(key, element.move());
+    from.toMap().remove(key);
+  };
+
+  LOG("Element move between maps:");
+  {
+    constexpr size_t iteration_count = 100000;
+    auto measure = [&](bool is_transaction) {
+      const auto start = std::chrono::steady_clock::now();
+      for(size_t i = 0; i < iteration_count; ++i) {
+        auto transaction = Variable::makeTransaction({first, second}, is_transaction ? MtxLockType::unique_locked : MtxLockType::unlocked);
+        if(i % 2) moveElement(second, first, 0);
+        else moveElement(first, second, 0);
+      }
+      return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iteration_count;
+    };
+    LOG("Lock per call: " << measure(false) << " ns");
+    LOG("One transaction: " << measure(true) << " ns");
+    TEST(first.toMap().contains(0_ui64));
+  }
+
+#ifndef BINOM_SINGLE_THREAD
+  LOG("Concurrent moves in opposite directions:");
+  {
+    std::atomic_bool is_running = true;
+    std::atomic_size_t check_count = 0, error_count = 0;
+    std::list<std::thread> threads;
+    // Would deadlock if maps were locked in order of arguments
+    for(size_t direction = 0; direction < 2; ++direction)
+      threads.emplace_back([&, direction]() {
+        Variable& from = direction ? second : first;
+        Variable& to = direction ? first : second;
+        for(ui64 i = 0; i < 10000; ++i) {
+          auto transaction = Variable::makeTransaction({from, to});
+          moveElement(from, to, i % element_count);
+        }
+      });
+    threads.emplace_back([&]() {
+      while(is_running) {
+        auto transaction = Variable::makeTransaction({first, second}, MtxLockType::shared_locked);
+        if(first.getElementCount() + second.getElementCount() != element_count) ++error_count;
+        ++check_count;
+      }
+    });
+    while(threads.size() > 1) {
+      threads.front().join();
+      threads.pop_front();
+    }
+    is_running = false;
+    threads.front().join();
+    LOG("Checks: " << check_count);
+    TEST(error_count == 0);
+    TEST(first.getElementCount() + second.getElementCount() == element_count);
+  }
+#endif
+
+  TEST(SharedRecursiveMutexWrapper::getWrappedMutexCount() == 0);
+  GRP_POP
+}
+
 #endif // RECURSIVE_SHARED_MUTEX_TEST_HXX
@@ -0,0 +1,153 @@
+#ifndef SERIALIZATION_TEST_HXX
+#define SERIALIZATION_TEST_HXX
+
+#include "tester.hxx"
+#include "libbinom/include/binom.hxx"
+#include "print_variable.hxx"
+
+#include <cstdio>
+#include <sstream>
+
+void testSerialization() {
+  using namespace binom;
+  using namespace binom::literals;
+
+  RAIIPerfomanceTest test_perf("Serialization test: ");
+  SEPARATOR
+  TEST_ANNOUNCE(Serialization test)
+  GRP_PUSH
+
+  Variable variable = map{
+    {"number", 42},
+    {"float", 3.5},
+    {"bits", bitarr{1,0,1,1,0,0,1,0,1}},
+    {"string", "Hello world"},
+    {"i32 array", i32arr{-1, 0, 1, 2147483647}},
+    {"array", arr{nullptr, 1_ui8, "text", arr{1, 2, 3}}},
+    {"list", literals::list{1, 2_i16, "three"}},
+    {"multimap", multimap{{1, "a"}, {1, "b"}, {"key", 2}}},
+    {ui16arr{1, 2, 3}, bitarr{0, 1}},
+    {-5, nullptr}
+  };
+
+  PRINT_RUN(std::vector<byte> data = variable.serialize();)
+  LOG("Serialized size: " << data.size() << " byte(s)");
+
+  PRINT_RUN(Variable restored = Variable::deserialize(data);)
+  utils::printVariable(restored);
+
+  TEST(restored.getType() == VarType::map);
+  TEST(restored.getElementCount() == variable.getElementCount());
+  TEST(restored.serialize() == data);
+
+  const Map& restored_map = restored.toMap();
+  TEST(i32(restored_map["number"].toNumber()) == 42);
+  TEST(f64(restored_map["float"].toNumber()) == 3.5);
+  TEST(restored_map["bits"].getElementCount() == 9);
+  TEST(restored_map["string"].getElementCount() == 11);
+  TEST(restored_map["i32 array"].getType() == VarType::si32_array);
+  TEST(restored_map["array"].getElementCount() == 4);
+  TEST(restored_map["list"].getType() == VarType::list);
+  TEST(restored_map["multimap"].getElementCount() == 3);
+  TEST((restored_map[ui16arr{1, 2, 3}].getType() == VarType::bit_array));
+  TEST(restored_map[-5].getType() == VarType::null);
+
+  LOG("Stream serialization:");
+  std::stringstream stream;
+  PRINT_RUN(StreamStatistics write_statistics = variable.serializeToStraem(stream, 16);)
+  LOG("Written: " << write_statistics.byte_count << " byte(s), " << write_statistics.getBytesPerSecond() << " byte/s");
+  TEST(write_statistics.byte_count == stream.str().size());
+  TEST(write_statistics.peak_buffer_size <= 16);
+  TEST(stream.str().size() < data.size()); // Without index
+
+  PRINT_RUN(variable.toMap()["string"].serializeToStraem(stream, 16);)
+
+  StreamStatistics read_statistics;
+  PRINT_RUN(Variable stream_restored = Variable::deserializeFromStream(stream, &read_statistics, 16);)
+  TEST(read_statistics.byte_count == write_statistics.byte_count);
+  TEST(read_statistics.peak_buffer_size <= 16);
+  TEST(stream_restored.serialize() == data);
+  PRINT_RUN(Variable next = Variable::deserializeFromStream(stream);)
+  TEST(next.getType() == variable.toMap()["string"].getType());
+  TEST(next.getElementCount() == 11);
+
+  LOG("Indexed data from stream:");
+  std::stringstream indexed_stream(std::string(reinterpret_cast<const char*>(data.data()), data.size()));
+  TEST(Variable::deserializeFromStream(indexed_stream).serialize() == data);
+
+  LOG("File descriptor stream:");
+  if(std::FILE* file = std::tmpfile(); file) {
+    PRINT_RUN(write_statistics = variable.serializeToFile(fileno(file));)
+    std::rewind(file);
+    std::string file_data(write_statistics.byte_count, '\0');
+    TEST(std::fread(file_data.data(), 1, file_data.size(), file) == file_data.size());
+    std::fclose(file);
+    std::istringstream file_stream(file_data);
+    TEST(Variable::deserializeFromStream(file_stream).serialize() == data);
+  }
+
+  LOG("Invalid data:");
+  bool is_thrown = false;
+  try { Variable::deserialize(data.data(), data.size() / 2); } catch(const err::Error& error) { is_thrown = error.code() == err::ErrorType::invalid_data; }
+  TEST(is_thrown);
+
+  is_thrown = false;
+  std::istringstream truncated_stream(stream.str().substr(0, stream.str().size() / 2));
+  try { Variable::deserializeFromStream(truncated_stream); } catch(const err::Error& error) { is_thrown = error.code() == err::ErrorType::invalid_data; }
+  TEST(is_thrown);
+
+  // Length field of stream can't be checked, so it mustn't size allocations
+  for(VarType type : {VarType::bit_array, VarType::ui64_array, VarType::array, VarType::list,
+                      VarType::map, VarType::multimap, VarType::hash_map}) {
+    std::string malformed_data = {'B', 'O', 'M', 1, 0, char(type)};
+    malformed_data.append(8, char(0xFF));
+    is_thrown = false;
+    std::istringstream malformed_stream(malformed_data);
+    try { Variable::deserializeFromStream(malformed_stream); } catch(const err::Error& error) { is_thrown = error.code() == err::ErrorType::invalid_data; }
+    TEST(is_thrown);
+    is_thrown = false;
+    try { Variable::deserialize(reinterpret_cast<const byte*>(malformed_data.data()), malformed_data.size()); }
+    catch(const err::Error& error) { is_thrown = error.code() == err::ErrorType::invalid_data; }
+    TEST(is_thrown);
+  }
+
+  { // Nesting is limited, so hostile input can't overflow the stack
+    auto makeNested = [](size_t depth) {
+      std::string nested_data = {'B', 'O', 'M', 1, 0};
+      for(size_t i = 0; i < depth; ++i) {
+        nested_data.push_back(char(VarType::array));
+        nested_data.append({1, 0, 0, 0, 0, 0, 0, 0});
+      }
+      nested_data.push_back(char(VarType::null));
+      return nested_data;
+    };
+    const std::string max_nested_data = makeNested(binom::priv::serialization::max_nesting_depth);
+    Variable max_nested = Variable::deserialize(reinterpret_cast<const byte*>(max_nested_data.data()), max_nested_data.size());
+    TEST(max_nested.getType() == VarType::array);
+    TEST(max_nested.getElementCount() == 1);
+    std::istringstream max_nested_stream(max_nested_data);
+    TEST(Variable::deserializeFromStream(max_nested_stream).serialize() == max_nested.serialize());
+
+    for(size_t depth : {binom::priv::serialization::max_nesting_depth + 1, size_t(2000000)}) {
+      const std::string nested_data = makeNested(depth);
+      is_thrown = false;
+      try { Variable::deserialize(reinterpret_cast<const byte*>(nested_data.data()), nested_data.size()); }
+      catch(const err::Error& error) { is_thrown = error.code() == err::ErrorType::invalid_data; }
+      TEST(is_thrown);
+      is_thrown = false;
+      std::istringstream nested_stream(nested_data);
+      try { Variable::deserializeFromStream(nested_stream); }
+      catch(const err::Error& error) { is_thrown = error.code() == err::ErrorType::invalid_data; }
+      TEST(is_thrown);
+    }
+  }
+
+  is_thrown = false;
+  data[0] = 0;
+  try { Variable::deserialize(data); } catch(const err::Error& error) { is_thrown = error.code() == err::ErrorType::invalid_data; }
+  TEST(is_thrown);
+
+  GRP_POP
+}
+
+#endif // SERIALIZATION_TEST_HXX
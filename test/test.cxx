@@ -1,6 +1,7 @@
 // TEST FLAGS:
 //#define FULL_TEST
 //#define TEST_FULL_INFO
+//#define PERFOMANCE_TEST // Long benchmarks
 
 #include "test/all_test.hxx"
 
@@ -17,11 +18,20 @@ int main() {
   testAVLTree();
   testMap();
   testMultiMap();
+  testHashMap();
 
 #ifdef FULL_TEST // Questionable or incompletely implemented tests
   testRecursiveSharedMutex();
 #endif
+  testRecursiveSharedMutexPerfomance();
+  testTransactionLock();
+  testLink();
   testVariable(); // Not ended!
+  testSerialization();
+  testView();
+  testFileStorage();
+  testMappedStorage();
+  testPersistent();
 
   testAllBugs();
 
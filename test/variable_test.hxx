@@ -4,6 +4,8 @@
 #include "tester.hxx"
 #include "print_variable.hxx"
 
+#include <chrono>
+
 using namespace binom;
 
 void testVariable() {
@@ -45,6 +47,83 @@ void testVariable() {
     PRINT_RUN(array.toArray().popBack());
   } GRP_POP;
 
+  TEST_ANNOUNCE(Array append test); GRP_PUSH;
+  {
+#ifdef PERFOMANCE_TEST
+    constexpr i64 append_count = 10000000;
+#else
+    constexpr i64 append_count = 1000000;
+#endif
+    Array array;
+    Variable first = array.pushBack(0_i64);
+    const auto start = std::chrono::steady_clock::now();
+    for(i64 i = 1; i < append_count; ++i) array.pushBack(i);
+    const double duration = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    LOG("Array::pushBack of " << append_count << " elements: " << duration << " ms");
+    TEST(array.getElementCount() == size_t(append_count));
+    TEST(i64(array[append_count - 1].toNumber()) == append_count - 1);
+
+    LOG("Capacity at least doubles on each growth, so append is amortized O(1)");
+    Array grown;
+    bool is_doubled = true;
+    for(i64 i = 0; i < 100000; ++i) {
+      const size_t capacity = grown.getElementCapacity();
+      grown.pushBack(i);
+      if(grown.getElementCapacity() != capacity) is_doubled &= grown.getElementCapacity() >= capacity * 2;
+    }
+    TEST(is_doubled);
+
+    LOG("Elements are relocated with their resources, so links to them stay valid");
+    first.toNumber() = 5_i64;
+    TEST(i64(array[0].toNumber()) == 5);
+
+    array.popBack(append_count / 2);
+    TEST(array.getElementCount() == size_t(append_count / 2));
+    array.clear();
+    TEST(array.getElementCount() == 0);
+    TEST(i64(first.toNumber()) == 5);
+  } GRP_POP;
+
+  TEST_ANNOUNCE(Array literal copy test); GRP_PUSH;
+  {
+    Variable value = 1_i64;
+    Array array;
+    array.pushBack(arr{value, value});
+    array.pushFront(arr{value});
+    array.insert(1, arr{value});
+    LOG("Elements of literal are copied, so changes of array don't affect source");
+    array[0].toNumber() = 2_i64;
+    array[3].toNumber() = 3_i64;
+    TEST(i64(value.toNumber()) == 1);
+    TEST(value.getLinkCount() == 1);
+
+    LOG("Literal may contain array itself");
+    Variable same_array = array.move();
+    array += arr{same_array};
+    TEST(array.getElementCount() == 5);
+    TEST(array[4].toArray().getElementCount() == 4);
+  } GRP_POP;
+
+  TEST_ANNOUNCE(Array capacity test); GRP_PUSH;
+  {
+    Array array = Array::nulls(100);
+    TEST(array.getElementCount() == 100);
+    TEST(array[99].getType() == VarType::null);
+    array.reserve(1000);
+    TEST(array.getElementCapacity() == 1000);
+    for(i64 i = 0; i < 900; ++i) array.pushBack(i);
+    TEST(array.getElementCapacity() == 1000);
+    array.popBack(500);
+    array.shrinkToFit();
+    TEST(array.getElementCapacity() == 500);
+    TEST(i64(array[499].toNumber()) == 399);
+
+    bool is_thrown = false;
+    try { array.reserve(std::numeric_limits<size_t>::max()); } catch(const std::bad_alloc&) { is_thrown = true; }
+    TEST(is_thrown);
+    TEST(array.getElementCapacity() == 500);
+  } GRP_POP;
+
   TEST_ANNOUNCE(List test); GRP_PUSH;
   {
     LOG("(bug in [r]): Variable list_var = list{true, false, i8(-8), 8_ui8, i16(-16), 16_ui16, i32(-32), 32_ui32, .32_f32, i64(-64), 64_ui64, .64_f64};")
@@ -0,0 +1,121 @@
+#ifndef VIEW_TEST_HXX
+#define VIEW_TEST_HXX
+
+#include "tester.hxx"
+#include "libbinom/include/binom.hxx"
+
+#include <limits>
+
+void testView() {
+  using namespace binom;
+  using namespace binom::literals;
+
+  RAIIPerfomanceTest test_perf("View test: ");
+  SEPARATOR
+  TEST_ANNOUNCE(View test)
+  GRP_PUSH
+
+  Variable variable = map{
+    {"name", "BinOM"},
+    {"version", 2_ui16},
+    {"ratio", 0.5},
+    {"flags", bitarr{1, 0, 1}},
+    {"values", i32arr{-1, 0, 1}},
+    {"array", arr{1, "two", map{{"three", 3}}}},
+    {"tags", multimap{{"a", 1}, {"a", 2}, {"b", 3}}},
+    {ui8arr{200, 1}, 1},
+    {i8arr{-56, 1}, 2},
+    {bitarr{1, 1}, 3},
+    {-7, 4},
+    {10_ui64, 5}
+  };
+
+  const std::vector<byte> data = variable.serialize();
+  PRINT_RUN(View view(data);)
+  TEST(view.getType() == VarType::map);
+  TEST(view.getElementCount() == variable.getElementCount());
+  TEST(view.getDataSize() == data.size() - sizeof(binom::priv::serialization::Header));
+
+  PRINT_RUN(ViewMap view_map = view.toMap();)
+  LOG("Lookup by each key of source map:");
+  for(auto element : variable.toMap()) {
+    size_t index = view_map.find(element.getKey());
+    TEST(index != view_map.getElementCount());
+    TEST(view_map.getValue(index).toVariable().serialize() == element.getVariable().serialize());
+  }
+
+  TEST(!view_map.contains("missing"));
+  TEST(!view_map["missing"].isValid());
+  TEST(!view_map[11].isValid());
+
+  TEST(view_map["name"].getType() == variable.toMap()["name"].getType());
+  PRINT_RUN(ViewBufferArray name = view_map["name"].toBufferArray();)
+  TEST((std::string_view(name.getDataAs<char>(), name.getElementCount()) == "BinOM"));
+  TEST(ui16(view_map["version"].toNumber()) == 2);
+  TEST(f64(view_map["ratio"].toNumber()) == 0.5);
+  TEST(view_map["flags"].getElementCount() == 3);
+
+  ViewBufferArray values = view_map["values"].toBufferArray();
+  TEST(values.getElementCount() == 3);
+  TEST(i32(values[0]) == -1);
+  i32 sum = 0;
+  for(auto value : values) sum += i32(value);
+  TEST(sum == 0);
+
+  ViewArray array = view_map["array"].toArray();
+  TEST(array.getElementCount() == 3);
+  TEST(i32(array[0].toNumber()) == 1);
+  TEST(array[1].toBufferArray().getElementCount() == 3);
+  TEST(i32(array[2].toMap()["three"].toNumber()) == 3);
+  TEST(!array[3].isValid());
+  size_t count = 0;
+  for(View element : array) count += element.isValid();
+  TEST(count == 3);
+
+  ViewMap tags = view_map["tags"].toMap();
+  TEST(tags.getType() == VarType::multimap);
+  TEST(tags.getElementCount() == 3);
+  TEST(tags.lowerBound("a") == 0);
+  TEST(tags.lowerBound("b") == 2);
+
+  TEST(i32(view_map[ui8arr{200, 1}].toNumber()) == 1);
+  TEST(i32(view_map[i8arr{-56, 1}].toNumber()) == 2);
+  TEST(i32(view_map[bitarr{1, 1}].toNumber()) == 3);
+  TEST(i32(view_map[-7].toNumber()) == 4);
+  TEST(i32(view_map[10_ui64].toNumber()) == 5);
+  TEST(!view_map[10_i32].isValid());
+
+  LOG("Keys ordered by exact value as in Map:");
+  {
+    const f64 nan = std::numeric_limits<f64>::quiet_NaN();
+    Variable numbers = map{
+      {nan, 1},
+      {9007199254740992.0, 2},
+      {i64(9007199254740993), 3},
+      {1.5, 4},
+      {-1, 5},
+      {f64arr{nan, 1.0}, 6},
+      {f64arr{1.0, 2.0}, 7}
+    };
+    const std::vector<byte> number_data = numbers.serialize();
+    ViewMap number_map = View(number_data).toMap();
+    for(auto element : numbers.toMap()) TEST(number_map.contains(element.getKey()));
+    TEST(i32(number_map[nan].toNumber()) == 1);
+    TEST(i32(number_map[9007199254740992.0].toNumber()) == 2);
+    TEST(i32(number_map[i64(9007199254740993)].toNumber()) == 3);
+    TEST(i32(number_map[f64arr{nan, 1.0}].toNumber()) == 6);
+  }
+
+  LOG("Invalid data:");
+  bool is_thrown = false;
+  try { View(data.data(), data.size() / 2); } catch(const err::Error& error) { is_thrown = error.code() == err::ErrorType::invalid_data; }
+  TEST(is_thrown);
+
+  is_thrown = false;
+  try { view_map["version"].toMap(); } catch(const err::Error& error) { is_thrown = error.code() == err::ErrorType::binom_invalid_type; }
+  TEST(is_thrown);
+
+  GRP_POP
+}
+
+#endif // VIEW_TEST_HXX